@@ -1344,6 +1344,16 @@ void LLVMSetOperand(LLVMValueRef User, unsigned Index, LLVMValueRef Val);
  */
 int LLVMGetNumOperands(LLVMValueRef Val);
 
+/**
+ * Obtain all the operands of a llvm::User value at once.
+ *
+ * Operands must point to an array of at least LLVMGetNumOperands(Val)
+ * values, which is filled in operand order.
+ *
+ * @see llvm::User::op_begin()
+ */
+void LLVMGetOperands(LLVMValueRef Val, LLVMValueRef *Operands);
+
 /**
  * @}
  */
@@ -2235,6 +2245,29 @@ LLVMValueRef LLVMGetFirstInstruction(LLVMBasicBlockRef BB);
  */
 LLVMValueRef LLVMGetLastInstruction(LLVMBasicBlockRef BB);
 
+/**
+ * Obtain the number of instructions in a basic block.
+ *
+ * @see llvm::BasicBlock::size()
+ */
+unsigned LLVMCountInstructions(LLVMBasicBlockRef BB);
+
+/**
+ * Obtain all the instructions in a basic block at once.
+ *
+ * Instructions must point to an array of at least
+ * LLVMCountInstructions(BB) values, which is filled in order.
+ */
+void LLVMGetInstructions(LLVMBasicBlockRef BB, LLVMValueRef *Instructions);
+
+/**
+ * Obtain the opcodes of all the instructions in a basic block at once.
+ *
+ * Opcodes must point to an array of at least LLVMCountInstructions(BB)
+ * elements, which is filled in instruction order.
+ */
+void LLVMGetInstructionOpcodes(LLVMBasicBlockRef BB, LLVMOpcode *Opcodes);
+
 /**
  * @}
  */
@@ -2671,6 +2704,65 @@ LLVMValueRef LLVMBuildAtomicRMW(LLVMBuilderRef B, LLVMAtomicRMWBinOp op,
                                 LLVMAtomicOrdering ordering,
                                 LLVMBool singleThread);
 
+/* Bulk construction */
+
+/**
+ * The flags of an LLVMInstructionDesc, for the instructions they apply to.
+ */
+typedef enum {
+  LLVMInstNoSignedWrap   = 1 << 0, /**< nsw add, sub, mul or shl */
+  LLVMInstNoUnsignedWrap = 1 << 1, /**< nuw add, sub, mul or shl */
+  LLVMInstExact          = 1 << 2, /**< exact udiv, sdiv, lshr or ashr */
+  LLVMInstInBounds       = 1 << 3, /**< inbounds getelementptr */
+  LLVMInstVolatile       = 1 << 4  /**< volatile load or store */
+} LLVMInstructionFlags;
+
+/**
+ * An instruction for LLVMBuildInstructions to build.
+ *
+ * The operands are indices into the value table given to
+ * LLVMBuildInstructions.  They are the same, in the same order, as the
+ * arguments of the corresponding LLVMBuild* function: the callee then the
+ * arguments of a call, the pointer then the indices of a getelementptr, the
+ * value then the pointer of a store.  Basic blocks, such as the targets of
+ * a br and the incoming blocks of a phi, are given as LLVMBasicBlockAsValue.
+ * The operands of a phi are pairs of an incoming value and its block.
+ */
+typedef struct {
+  LLVMOpcode Opcode;
+  /** The LLVMIntPredicate of an icmp or the LLVMRealPredicate of an fcmp. */
+  int Predicate;
+  /** The destination type of a cast, or the type of an alloca or phi. */
+  LLVMTypeRef Type;
+  /** A combination of LLVMInstructionFlags. */
+  unsigned Flags;
+  const unsigned *Operands;
+  unsigned NumOperands;
+  /** The name of the result, or NULL. */
+  const char *Name;
+} LLVMInstructionDesc;
+
+/**
+ * Build NumInsts instructions at the position of the builder in one call,
+ * as the corresponding LLVMBuild* functions would.
+ *
+ * Values is the table that operands index.  Its first NumValues entries are
+ * provided by the caller, and it must have room for NumInsts more: the
+ * result of Insts[i] is stored in Values[NumValues + i], where the
+ * instructions after it can use it.
+ *
+ * The binary operators, casts, icmp, fcmp, alloca, load, store,
+ * getelementptr, select, call, phi, br, ret and unreachable can be built.
+ * Returns the number of instructions built; if that is less than NumInsts,
+ * the next one has an unknown or unsupported opcode, the wrong number of
+ * operands, or an operand index out of range, and the instructions before it
+ * are kept.
+ */
+unsigned LLVMBuildInstructions(LLVMBuilderRef B,
+                               const LLVMInstructionDesc *Insts,
+                               unsigned NumInsts, LLVMValueRef *Values,
+                               unsigned NumValues);
+
 /**
  * @}
  */
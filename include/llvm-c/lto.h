@@ -40,7 +40,7 @@ typedef bool lto_bool_t;
  * @{
  */
 
-#define LTO_API_VERSION 5
+#define LTO_API_VERSION 7
 
 typedef enum {
     LTO_SYMBOL_ALIGNMENT_MASK              = 0x0000001F, /* log2 of alignment */
@@ -73,6 +73,22 @@ typedef enum {
     LTO_CODEGEN_PIC_MODEL_DYNAMIC_NO_PIC = 2
 } lto_codegen_model;
 
+/**
+ * How the linker resolved a symbol defined by the modules given to a code
+ * generator.
+ *
+ * \since LTO_API_VERSION=7
+ */
+typedef enum {
+    /* The definition is used, but only by the modules being optimized. */
+    LTO_SYMBOL_RESOLUTION_PREVAILING_DEF_IRONLY = 0,
+    /* The definition is used by native objects, shared libraries or the
+       dynamic symbol table as well. */
+    LTO_SYMBOL_RESOLUTION_PREVAILING_DEF        = 1,
+    /* A definition in a native object or shared library is used instead. */
+    LTO_SYMBOL_RESOLUTION_PREEMPTED             = 2
+} lto_symbol_resolution;
+
 
 /** opaque reference to a loaded object module */
 typedef struct LTOModule*         lto_module_t;
@@ -249,6 +265,18 @@ extern void
 lto_codegen_set_cpu(lto_code_gen_t cg, const char *cpu);
 
 
+/**
+ * Sets a directory in which to keep the generated native objects, keyed by
+ * a hash of the merged modules and the code generation options, so that a
+ * later link with the same inputs can reuse them.  Pass NULL or an empty
+ * string to disable the cache.
+ *
+ * \since LTO_API_VERSION=6
+ */
+extern void
+lto_codegen_set_cache_dir(lto_code_gen_t cg, const char *dir);
+
+
 /**
  * Sets the location of the assembler tool to run. If not set, libLTO
  * will use gcc to invoke the assembler.
@@ -270,6 +298,20 @@ lto_codegen_set_assembler_args(lto_code_gen_t cg, const char **args,
 extern void
 lto_codegen_add_must_preserve_symbol(lto_code_gen_t cg, const char* symbol);
 
+/**
+ * Tells the code generator how the linker resolved a symbol that the added
+ * modules define.  The resolution takes precedence over
+ * lto_codegen_add_must_preserve_symbol: definitions only the optimized
+ * modules use are internalized, and preempted ones are discarded so that
+ * references go to the definition the linker chose.  Give the resolution
+ * of the definition in use, not of every module's copy.
+ *
+ * \since LTO_API_VERSION=7
+ */
+extern void
+lto_codegen_set_symbol_resolution(lto_code_gen_t cg, const char *symbol,
+                                  lto_symbol_resolution resolution);
+
 /**
  * Writes a new object file at the specified path that contains the
  * merged contents of all modules added so far.
@@ -296,6 +338,19 @@ lto_codegen_compile(lto_code_gen_t cg, size_t* length);
 extern lto_bool_t
 lto_codegen_compile_to_file(lto_code_gen_t cg, const char** name);
 
+/**
+ * Generates code for all added modules into at most parallelism native
+ * object files, running the code generator for them in parallel.  The
+ * names of the files are written to names, an array of count strings owned
+ * by the lto_code_gen_t that stays valid until the next compile call.  All
+ * of the files must be passed to the native linker.  Returns true on error.
+ *
+ * \since LTO_API_VERSION=6
+ */
+extern lto_bool_t
+lto_codegen_compile_to_files(lto_code_gen_t cg, unsigned parallelism,
+                             const char*** names, unsigned* count);
+
 
 /**
  * Sets options to help debug codegen bugs.
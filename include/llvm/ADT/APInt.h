@@ -88,14 +88,47 @@ class APInt {
     APINT_BITS_PER_WORD =
         static_cast<unsigned int>(sizeof(uint64_t)) * CHAR_BIT,
     /// Byte size of a word
-    APINT_WORD_SIZE = static_cast<unsigned int>(sizeof(uint64_t))
+    APINT_WORD_SIZE = static_cast<unsigned int>(sizeof(uint64_t)),
+    /// Words of the widest value stored without a heap allocation
+    NumInlineWords = 2
   };
 
+  /// Values of more than one word and at most NumInlineWords words are kept
+  /// here, pVal pointing to them, so that i128 arithmetic does not allocate.
+  uint64_t InlineWords[NumInlineWords];
+
+  /// Selects the constructor which leaves the value uninitialized.
+  enum UninitializedTag { Uninitialized };
+
   /// \brief Fast internal constructor
   ///
   /// This constructor is used only internally for speed of construction of
-  /// temporaries. It is unsafe for general use so it is not public.
-  APInt(uint64_t *val, unsigned bits) : BitWidth(bits), pVal(val) {}
+  /// temporaries whose every word is about to be written. It is unsafe for
+  /// general use so it is not public.
+  APInt(unsigned bits, UninitializedTag) : BitWidth(bits), VAL(0) {
+    if (!isSingleWord())
+      allocateWords();
+  }
+
+  /// \brief Point pVal at uninitialized storage for a multiword value: the
+  /// inline words if they are enough, otherwise a new heap array.
+  void allocateWords() {
+    unsigned NumWords = getNumWords();
+    pVal = NumWords <= NumInlineWords ? InlineWords : new uint64_t[NumWords];
+  }
+
+  /// \brief Take over the value of \p that, leaving it without one.
+  void moveFrom(APInt &that) {
+    BitWidth = that.BitWidth;
+    if (!that.isSingleWord() && that.pVal == that.InlineWords) {
+      memcpy(InlineWords, that.InlineWords, sizeof(InlineWords));
+      pVal = InlineWords;
+    } else if (that.isSingleWord())
+      VAL = that.VAL;
+    else
+      pVal = that.pVal;
+    that.BitWidth = 0;
+  }
 
   /// \brief Determine if this APInt just has one word to store value.
   ///
@@ -219,6 +252,36 @@ class APInt {
   /// out-of-line slow case for countPopulation
   unsigned countPopulationSlowCase() const;
 
+  /// out-of-line slow case for countTrailingZeros
+  unsigned countTrailingZerosSlowCase() const;
+
+  /// out-of-line slow case for operator++
+  APInt &IncrementSlowCase();
+
+  /// out-of-line slow case for operator--
+  APInt &DecrementSlowCase();
+
+  /// out-of-line slow case for operator+=
+  APInt &AddAssignSlowCase(const APInt &RHS);
+
+  /// out-of-line slow case for operator-=
+  APInt &SubAssignSlowCase(const APInt &RHS);
+
+  /// out-of-line slow case for operator+
+  APInt AddSlowCase(const APInt &RHS) const;
+
+  /// out-of-line slow case for operator-
+  APInt SubSlowCase(const APInt &RHS) const;
+
+  /// out-of-line slow case for operator*
+  APInt MulSlowCase(const APInt &RHS) const;
+
+  /// out-of-line slow case for ult
+  bool ultSlowCase(const APInt &RHS) const;
+
+  /// out-of-line slow case for slt
+  bool sltSlowCase(const APInt &RHS) const;
+
 public:
   /// \name Constructors
   /// @{
@@ -286,9 +349,7 @@ public:
 
 #if LLVM_HAS_RVALUE_REFERENCES
   /// \brief Move Constructor.
-  APInt(APInt &&that) : BitWidth(that.BitWidth), VAL(that.VAL) {
-    that.BitWidth = 0;
-  }
+  APInt(APInt &&that) { moveFrom(that); }
 #endif
 
   /// \brief Destructor.
@@ -297,14 +358,16 @@ public:
       delete[] pVal;
   }
 
-  /// \brief Default constructor that creates an uninitialized APInt.
+  /// \brief Default constructor that creates an APInt with a 1-bit zero value.
   ///
   /// This is useful for object deserialization (pair this with the static
   ///  method Read).
-  explicit APInt() : BitWidth(1) {}
+  explicit APInt() : BitWidth(1), VAL(0) {}
 
   /// \brief Returns whether this instance allocated memory.
-  bool needsCleanup() const { return !isSingleWord(); }
+  bool needsCleanup() const {
+    return !isSingleWord() && pVal != InlineWords;
+  }
 
   /// Used to insert APInt objects, or objects that contain APInt objects, into
   ///  FoldingSets.
@@ -589,7 +652,13 @@ public:
   /// \brief Prefix increment operator.
   ///
   /// \returns *this incremented by one
-  APInt &operator++();
+  APInt &operator++() {
+    if (isSingleWord()) {
+      ++VAL;
+      return clearUnusedBits();
+    }
+    return IncrementSlowCase();
+  }
 
   /// \brief Postfix decrement operator.
   ///
@@ -603,7 +672,13 @@ public:
   /// \brief Prefix decrement operator.
   ///
   /// \returns *this decremented by one.
-  APInt &operator--();
+  APInt &operator--() {
+    if (isSingleWord()) {
+      --VAL;
+      return clearUnusedBits();
+    }
+    return DecrementSlowCase();
+  }
 
   /// \brief Unary bitwise complement operator.
   ///
@@ -659,14 +734,13 @@ public:
 #if LLVM_HAS_RVALUE_REFERENCES
   /// @brief Move assignment operator.
   APInt &operator=(APInt &&that) {
-    if (!isSingleWord())
-      delete[] pVal;
-
-    BitWidth = that.BitWidth;
-    VAL = that.VAL;
+    if (this == &that)
+      return *this;
 
-    that.BitWidth = 0;
+    if (needsCleanup())
+      delete[] pVal;
 
+    moveFrom(that);
     return *this;
   }
 #endif
@@ -731,14 +805,28 @@ public:
   /// Adds RHS to *this and assigns the result to *this.
   ///
   /// \returns *this
-  APInt &operator+=(const APInt &RHS);
+  APInt &operator+=(const APInt &RHS) {
+    assert(BitWidth == RHS.BitWidth && "Bit widths must be the same");
+    if (isSingleWord()) {
+      VAL += RHS.VAL;
+      return clearUnusedBits();
+    }
+    return AddAssignSlowCase(RHS);
+  }
 
   /// \brief Subtraction assignment operator.
   ///
   /// Subtracts RHS from *this and assigns the result to *this.
   ///
   /// \returns *this
-  APInt &operator-=(const APInt &RHS);
+  APInt &operator-=(const APInt &RHS) {
+    assert(BitWidth == RHS.BitWidth && "Bit widths must be the same");
+    if (isSingleWord()) {
+      VAL -= RHS.VAL;
+      return clearUnusedBits();
+    }
+    return SubAssignSlowCase(RHS);
+  }
 
   /// \brief Left-shift assignment function.
   ///
@@ -816,18 +904,33 @@ public:
   /// \brief Multiplication operator.
   ///
   /// Multiplies this APInt by RHS and returns the result.
-  APInt operator*(const APInt &RHS) const;
+  APInt operator*(const APInt &RHS) const {
+    assert(BitWidth == RHS.BitWidth && "Bit widths must be the same");
+    if (isSingleWord())
+      return APInt(BitWidth, VAL * RHS.VAL);
+    return MulSlowCase(RHS);
+  }
 
   /// \brief Addition operator.
   ///
   /// Adds RHS to this APInt and returns the result.
-  APInt operator+(const APInt &RHS) const;
+  APInt operator+(const APInt &RHS) const {
+    assert(BitWidth == RHS.BitWidth && "Bit widths must be the same");
+    if (isSingleWord())
+      return APInt(BitWidth, VAL + RHS.VAL);
+    return AddSlowCase(RHS);
+  }
   APInt operator+(uint64_t RHS) const { return (*this) + APInt(BitWidth, RHS); }
 
   /// \brief Subtraction operator.
   ///
   /// Subtracts RHS from this APInt and returns the result.
-  APInt operator-(const APInt &RHS) const;
+  APInt operator-(const APInt &RHS) const {
+    assert(BitWidth == RHS.BitWidth && "Bit widths must be the same");
+    if (isSingleWord())
+      return APInt(BitWidth, VAL - RHS.VAL);
+    return SubSlowCase(RHS);
+  }
   APInt operator-(uint64_t RHS) const { return (*this) - APInt(BitWidth, RHS); }
 
   /// \brief Left logical shift operator.
@@ -1017,7 +1120,13 @@ public:
   /// the validity of the less-than relationship.
   ///
   /// \returns true if *this < RHS when both are considered unsigned.
-  bool ult(const APInt &RHS) const;
+  bool ult(const APInt &RHS) const {
+    assert(BitWidth == RHS.BitWidth &&
+           "Bit widths must be same for comparison");
+    if (isSingleWord())
+      return VAL < RHS.VAL;
+    return ultSlowCase(RHS);
+  }
 
   /// \brief Unsigned less than comparison
   ///
@@ -1033,7 +1142,16 @@ public:
   /// validity of the less-than relationship.
   ///
   /// \returns true if *this < RHS when both are considered signed.
-  bool slt(const APInt &RHS) const;
+  bool slt(const APInt &RHS) const {
+    assert(BitWidth == RHS.BitWidth &&
+           "Bit widths must be same for comparison");
+    if (isSingleWord()) {
+      int64_t lhsSext = (int64_t(VAL) << (64-BitWidth)) >> (64-BitWidth);
+      int64_t rhsSext = (int64_t(RHS.VAL) << (64-BitWidth)) >> (64-BitWidth);
+      return lhsSext < rhsSext;
+    }
+    return sltSlowCase(RHS);
+  }
 
   /// \brief Signed less than comparison
   ///
@@ -1212,7 +1330,12 @@ public:
   /// \brief Set a given bit to 1.
   ///
   /// Set the given bit to 1 whose position is given as "bitPosition".
-  void setBit(unsigned bitPosition);
+  void setBit(unsigned bitPosition) {
+    if (isSingleWord())
+      VAL |= maskBit(bitPosition);
+    else
+      pVal[whichWord(bitPosition)] |= maskBit(bitPosition);
+  }
 
   /// \brief Set every bit to 0.
   void clearAllBits() {
@@ -1225,7 +1348,12 @@ public:
   /// \brief Set a given bit to 0.
   ///
   /// Set the given bit to 0 whose position is given as "bitPosition".
-  void clearBit(unsigned bitPosition);
+  void clearBit(unsigned bitPosition) {
+    if (isSingleWord())
+      VAL &= ~maskBit(bitPosition);
+    else
+      pVal[whichWord(bitPosition)] &= ~maskBit(bitPosition);
+  }
 
   /// \brief Toggle every bit to its opposite value.
   void flipAllBits() {
@@ -1369,7 +1497,11 @@ public:
   ///
   /// \returns BitWidth if the value is zero, otherwise returns the number of
   /// zeros from the least significant bit to the first one bit.
-  unsigned countTrailingZeros() const;
+  unsigned countTrailingZeros() const {
+    if (isSingleWord())
+      return std::min(unsigned(llvm::countTrailingZeros(VAL)), BitWidth);
+    return countTrailingZerosSlowCase();
+  }
 
   /// \brief Count the number of trailing one bits.
   ///
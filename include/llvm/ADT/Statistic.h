@@ -38,15 +38,18 @@ public:
   const char *Desc;
   volatile llvm::sys::cas_flag Value;
   bool Initialized;
+  // The name of the variable defined by STATISTIC, for the JSON output.
+  const char *VarName;
 
   llvm::sys::cas_flag getValue() const { return Value; }
   const char *getName() const { return Name; }
   const char *getDesc() const { return Desc; }
+  const char *getVarName() const { return VarName; }
 
   /// construct - This should only be called for non-global statistics.
   void construct(const char *name, const char *desc) {
     Name = name; Desc = desc;
-    Value = 0; Initialized = 0;
+    Value = 0; Initialized = 0; VarName = 0;
   }
 
   // Allow use of this class as the value itself.
@@ -162,7 +165,7 @@ protected:
 // STATISTIC - A macro to make definition of statistics really simple.  This
 // automatically passes the DEBUG_TYPE of the file into the statistic.
 #define STATISTIC(VARNAME, DESC) \
-  static llvm::Statistic VARNAME = { DEBUG_TYPE, DESC, 0, 0 }
+  static llvm::Statistic VARNAME = { DEBUG_TYPE, DESC, 0, 0, #VARNAME }
 
 /// \brief Enable the collection and printing of statistics.
 void EnableStatistics();
@@ -173,9 +176,14 @@ bool AreStatisticsEnabled();
 /// \brief Print statistics to the file returned by CreateInfoOutputFile().
 void PrintStatistics();
 
-/// \brief Print statistics to the given output stream.
+/// \brief Print statistics to the given output stream, as JSON if
+/// -stats-json was given.
 void PrintStatistics(raw_ostream &OS);
 
+/// \brief Print statistics to the given output stream as a JSON object
+/// mapping "<debug type>.<variable name>" to the statistic's value.
+void PrintStatisticsJSON(raw_ostream &OS);
+
 } // End llvm namespace
 
 #endif
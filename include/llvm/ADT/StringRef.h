@@ -231,9 +231,10 @@ namespace llvm {
     /// \returns The index of the first occurrence of \p C, or npos if not
     /// found.
     size_t find(char C, size_t From = 0) const {
-      for (size_t i = min(From, Length), e = Length; i != e; ++i)
-        if (Data[i] == C)
-          return i;
+      // memchr is vectorized by the C library.
+      if (From < Length)
+        if (const void *P = ::memchr(Data + From, C, Length - From))
+          return static_cast<const char *>(P) - Data;
       return npos;
     }
 
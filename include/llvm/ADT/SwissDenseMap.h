@@ -0,0 +1,530 @@
+//===- llvm/ADT/SwissDenseMap.h - Group-probed hash table -------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the SwissDenseMap class, a drop-in replacement for
+// DenseMap with a different probing scheme.
+//
+// DenseMap finds a key by comparing it against the key of every bucket on its
+// probe sequence, and recognizes free buckets by comparing them against the
+// empty and tombstone keys, so every probe touches a whole bucket.
+// SwissDenseMap keeps one control byte per bucket in a separate array: the
+// byte says whether the bucket is empty or deleted, or holds 7 bits of the
+// hash of its key.  Lookups compare the control bytes of 16 buckets at once,
+// with SSE2 where it is available, and only look at the buckets whose control
+// byte matches.
+//
+// The map uses KeyInfoT for hashing and comparing keys like DenseMap, but
+// never needs the empty or tombstone keys.  Iterators and pointers to entries
+// are invalidated by insertions, as with DenseMap.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_ADT_SWISSDENSEMAP_H
+#define LLVM_ADT_SWISSDENSEMAP_H
+
+#include "llvm/ADT/DenseMapInfo.h"
+#include "llvm/Support/Compiler.h"
+#include "llvm/Support/DataTypes.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/type_traits.h"
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <new>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define LLVM_SWISSDENSEMAP_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace llvm {
+
+namespace swiss_detail {
+
+/// A control byte is Empty, Deleted or, for a full bucket, the top 7 bits of
+/// the hash of its key.  Only full buckets have a clear sign bit.
+typedef signed char ControlT;
+const ControlT Empty = -128;
+const ControlT Deleted = -2;
+
+/// The number of buckets whose control bytes are probed at once.
+const unsigned GroupWidth = 16;
+
+/// ProbeGroup - The control bytes of GroupWidth consecutive buckets, with
+/// queries returning a bitmask with bit i set for the i-th bucket.
+class ProbeGroup {
+#ifdef LLVM_SWISSDENSEMAP_SSE2
+  __m128i Ctrl;
+
+public:
+  explicit ProbeGroup(const ControlT *Pos)
+    : Ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i *>(Pos))) {}
+
+  unsigned match(ControlT H2) const {
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(H2), Ctrl));
+  }
+  unsigned matchEmptyOrDeleted() const { return _mm_movemask_epi8(Ctrl); }
+#else
+  const ControlT *Ctrl;
+
+public:
+  explicit ProbeGroup(const ControlT *Pos) : Ctrl(Pos) {}
+
+  unsigned match(ControlT H2) const {
+    unsigned Mask = 0;
+    for (unsigned i = 0; i != GroupWidth; ++i)
+      if (Ctrl[i] == H2)
+        Mask |= 1U << i;
+    return Mask;
+  }
+  unsigned matchEmptyOrDeleted() const {
+    unsigned Mask = 0;
+    for (unsigned i = 0; i != GroupWidth; ++i)
+      if (Ctrl[i] < 0)
+        Mask |= 1U << i;
+    return Mask;
+  }
+#endif
+
+  unsigned matchEmpty() const { return match(Empty); }
+};
+
+} // end namespace swiss_detail
+
+template<typename KeyT, typename ValueT, bool IsConst = false>
+class SwissDenseMapIterator;
+
+template<typename KeyT, typename ValueT,
+         typename KeyInfoT = DenseMapInfo<KeyT> >
+class SwissDenseMap {
+  typedef std::pair<KeyT, ValueT> BucketT;
+  typedef swiss_detail::ControlT ControlT;
+
+  // NumBuckets control bytes followed by copies of the first GroupWidth, so
+  // that a group can be loaded at any bucket without wrapping around.
+  ControlT *Ctrl;
+  BucketT *Buckets;
+  // Zero, or a power of two no smaller than GroupWidth.
+  unsigned NumBuckets;
+  unsigned NumEntries;
+  // The number of empty buckets that can still be filled before the table
+  // must be rehashed.  Deleted buckets still count as filled.
+  unsigned GrowthLeft;
+
+public:
+  typedef KeyT key_type;
+  typedef ValueT mapped_type;
+  typedef BucketT value_type;
+
+  typedef SwissDenseMapIterator<KeyT, ValueT> iterator;
+  typedef SwissDenseMapIterator<KeyT, ValueT, true> const_iterator;
+
+  explicit SwissDenseMap(unsigned NumInitEntries = 0)
+    : Ctrl(0), Buckets(0), NumBuckets(0), NumEntries(0), GrowthLeft(0) {
+    if (NumInitEntries)
+      rehash(getMinBucketsFor(NumInitEntries));
+  }
+
+  SwissDenseMap(const SwissDenseMap &Other)
+    : Ctrl(0), Buckets(0), NumBuckets(0), NumEntries(0), GrowthLeft(0) {
+    copyFrom(Other);
+  }
+
+  template<typename InputIt>
+  SwissDenseMap(const InputIt &I, const InputIt &E)
+    : Ctrl(0), Buckets(0), NumBuckets(0), NumEntries(0), GrowthLeft(0) {
+    rehash(getMinBucketsFor(std::distance(I, E)));
+    insert(I, E);
+  }
+
+  ~SwissDenseMap() {
+    destroyAll();
+    deallocate();
+  }
+
+  SwissDenseMap &operator=(const SwissDenseMap &Other) {
+    if (&Other != this) {
+      destroyAll();
+      deallocate();
+      Ctrl = 0;
+      Buckets = 0;
+      NumBuckets = NumEntries = GrowthLeft = 0;
+      copyFrom(Other);
+    }
+    return *this;
+  }
+
+  void swap(SwissDenseMap &RHS) {
+    std::swap(Ctrl, RHS.Ctrl);
+    std::swap(Buckets, RHS.Buckets);
+    std::swap(NumBuckets, RHS.NumBuckets);
+    std::swap(NumEntries, RHS.NumEntries);
+    std::swap(GrowthLeft, RHS.GrowthLeft);
+  }
+
+  iterator begin() {
+    return empty() ? end() : iterator(Ctrl, Buckets, Buckets + NumBuckets);
+  }
+  iterator end() {
+    return iterator(Ctrl + NumBuckets, Buckets + NumBuckets,
+                    Buckets + NumBuckets);
+  }
+  const_iterator begin() const {
+    return empty() ? end()
+                   : const_iterator(Ctrl, Buckets, Buckets + NumBuckets);
+  }
+  const_iterator end() const {
+    return const_iterator(Ctrl + NumBuckets, Buckets + NumBuckets,
+                          Buckets + NumBuckets);
+  }
+
+  bool LLVM_ATTRIBUTE_UNUSED_RESULT empty() const { return NumEntries == 0; }
+  unsigned size() const { return NumEntries; }
+
+  /// Grow the map so that it can hold Size entries without rehashing.
+  void resize(size_t Size) {
+    unsigned MinBuckets = getMinBucketsFor(Size);
+    if (MinBuckets > NumBuckets)
+      rehash(MinBuckets);
+  }
+
+  void clear() {
+    if (NumEntries == 0 && GrowthLeft == getMaxLoad(NumBuckets))
+      return;
+    destroyAll();
+    if (NumBuckets)
+      memset(Ctrl, swiss_detail::Empty,
+             NumBuckets + swiss_detail::GroupWidth);
+    NumEntries = 0;
+    GrowthLeft = getMaxLoad(NumBuckets);
+  }
+
+  /// count - Return true if the specified key is in the map.
+  bool count(const KeyT &Val) const {
+    unsigned Index;
+    return LookupBucketFor(Val, Index);
+  }
+
+  iterator find(const KeyT &Val) {
+    unsigned Index;
+    if (LookupBucketFor(Val, Index))
+      return iterator(Ctrl + Index, Buckets + Index, Buckets + NumBuckets,
+                      true);
+    return end();
+  }
+  const_iterator find(const KeyT &Val) const {
+    unsigned Index;
+    if (LookupBucketFor(Val, Index))
+      return const_iterator(Ctrl + Index, Buckets + Index,
+                            Buckets + NumBuckets, true);
+    return end();
+  }
+
+  /// lookup - Return the entry for the specified key, or a default
+  /// constructed value if no such entry exists.
+  ValueT lookup(const KeyT &Val) const {
+    unsigned Index;
+    if (LookupBucketFor(Val, Index))
+      return Buckets[Index].second;
+    return ValueT();
+  }
+
+  // Inserts key,value pair into the map if the key isn't already in the map.
+  // If the key is already in the map, it returns false and doesn't update the
+  // value.
+  std::pair<iterator, bool> insert(const std::pair<KeyT, ValueT> &KV) {
+    unsigned Index;
+    bool Inserted = false;
+    if (!LookupBucketFor(KV.first, Index)) {
+      Index = InsertIntoBucket(KV.first, KV.second);
+      Inserted = true;
+    }
+    return std::make_pair(iterator(Ctrl + Index, Buckets + Index,
+                                   Buckets + NumBuckets, true),
+                          Inserted);
+  }
+
+  /// insert - Range insertion of pairs.
+  template<typename InputIt>
+  void insert(InputIt I, InputIt E) {
+    for (; I != E; ++I)
+      insert(*I);
+  }
+
+  bool erase(const KeyT &Val) {
+    unsigned Index;
+    if (!LookupBucketFor(Val, Index))
+      return false; // not in map.
+    eraseBucket(Index);
+    return true;
+  }
+  void erase(iterator I) {
+    eraseBucket(&*I - Buckets);
+  }
+
+  value_type &FindAndConstruct(const KeyT &Key) {
+    unsigned Index;
+    if (!LookupBucketFor(Key, Index))
+      Index = InsertIntoBucket(Key, ValueT());
+    return Buckets[Index];
+  }
+
+  ValueT &operator[](const KeyT &Key) {
+    return FindAndConstruct(Key).second;
+  }
+
+  /// isPointerIntoBucketsArray - Return true if the specified pointer points
+  /// somewhere into the map's array of buckets (i.e. either to a key or value
+  /// in the map).
+  bool isPointerIntoBucketsArray(const void *Ptr) const {
+    return Ptr >= Buckets && Ptr < Buckets + NumBuckets;
+  }
+
+  /// Return the approximate size (in bytes) of the actual map.
+  /// This is just the raw memory used by the map.
+  size_t getMemorySize() const {
+    if (!NumBuckets)
+      return 0;
+    return NumBuckets * (sizeof(BucketT) + 1) + swiss_detail::GroupWidth;
+  }
+
+private:
+  /// The highest number of filled buckets for a table of NumBuckets: 7/8 of
+  /// the buckets, which leaves an empty bucket in most groups.
+  static unsigned getMaxLoad(unsigned NumBuckets) {
+    return NumBuckets - NumBuckets / 8;
+  }
+
+  static unsigned getMinBucketsFor(size_t NumEntries) {
+    unsigned Num = swiss_detail::GroupWidth;
+    while (getMaxLoad(Num) < NumEntries)
+      Num *= 2;
+    return Num;
+  }
+
+  /// Spread the bits of the key's hash, which is often weak in its low bits
+  /// (e.g. for pointers), over all 64 bits.  The bucket index and the
+  /// control byte are then taken from the high bits.
+  static uint64_t getHash(const KeyT &Val) {
+    return uint64_t(KeyInfoT::getHashValue(Val)) * 0x9E3779B97F4A7C15ULL;
+  }
+  static ControlT getH2(uint64_t Hash) { return ControlT(Hash >> 57); }
+  unsigned getProbeStart(uint64_t Hash) const {
+    return unsigned(Hash >> 25) & (NumBuckets - 1);
+  }
+
+  void setCtrl(unsigned Index, ControlT C) {
+    Ctrl[Index] = C;
+    if (Index < swiss_detail::GroupWidth)
+      Ctrl[NumBuckets + Index] = C;
+  }
+
+  /// Find the bucket holding Val.  The probe sequence visits groups at
+  /// triangular offsets from the start, which reaches every group when the
+  /// number of groups is a power of two, and stops at the first group with an
+  /// empty bucket.
+  bool LookupBucketFor(const KeyT &Val, unsigned &Index) const {
+    if (NumBuckets == 0)
+      return false;
+
+    uint64_t Hash = getHash(Val);
+    ControlT H2 = getH2(Hash);
+    unsigned Mask = NumBuckets - 1;
+    unsigned Pos = getProbeStart(Hash);
+    for (unsigned Step = swiss_detail::GroupWidth; ;
+         Step += swiss_detail::GroupWidth) {
+      swiss_detail::ProbeGroup Group(Ctrl + Pos);
+      for (unsigned Match = Group.match(H2); Match; Match &= Match - 1) {
+        unsigned I = (Pos + countTrailingZeros(Match)) & Mask;
+        if (KeyInfoT::isEqual(Val, Buckets[I].first)) {
+          Index = I;
+          return true;
+        }
+      }
+      if (Group.matchEmpty())
+        return false;
+      Pos = (Pos + Step) & Mask;
+    }
+  }
+
+  /// Find the first empty or deleted bucket on the probe sequence for Hash.
+  unsigned findInsertSlot(uint64_t Hash) const {
+    unsigned Mask = NumBuckets - 1;
+    unsigned Pos = getProbeStart(Hash);
+    for (unsigned Step = swiss_detail::GroupWidth; ;
+         Step += swiss_detail::GroupWidth) {
+      swiss_detail::ProbeGroup Group(Ctrl + Pos);
+      if (unsigned Match = Group.matchEmptyOrDeleted())
+        return (Pos + countTrailingZeros(Match)) & Mask;
+      Pos = (Pos + Step) & Mask;
+    }
+  }
+
+  /// Insert a new entry for Key, which must not be in the map, and return
+  /// its bucket.
+  unsigned InsertIntoBucket(const KeyT &Key, const ValueT &Value) {
+    if (NumBuckets == 0)
+      rehash(swiss_detail::GroupWidth);
+
+    uint64_t Hash = getHash(Key);
+    unsigned Index = findInsertSlot(Hash);
+    if (GrowthLeft == 0 && Ctrl[Index] == swiss_detail::Empty) {
+      // Rehash in place if deleted buckets are most of the load; otherwise
+      // double the table.
+      if (NumEntries < getMaxLoad(NumBuckets) / 2)
+        rehash(NumBuckets);
+      else
+        rehash(NumBuckets * 2);
+      Index = findInsertSlot(Hash);
+    }
+
+    if (Ctrl[Index] == swiss_detail::Empty)
+      --GrowthLeft;
+    setCtrl(Index, getH2(Hash));
+    new (&Buckets[Index]) BucketT(Key, Value);
+    ++NumEntries;
+    return Index;
+  }
+
+  void eraseBucket(unsigned Index) {
+    Buckets[Index].~BucketT();
+    setCtrl(Index, swiss_detail::Deleted);
+    --NumEntries;
+  }
+
+  /// Move every entry into a new table of NewNumBuckets buckets.
+  void rehash(unsigned NewNumBuckets) {
+    ControlT *OldCtrl = Ctrl;
+    BucketT *OldBuckets = Buckets;
+    unsigned OldNumBuckets = NumBuckets;
+
+    allocate(NewNumBuckets);
+    for (unsigned i = 0; i != OldNumBuckets; ++i) {
+      if (OldCtrl[i] < 0)
+        continue;
+      uint64_t Hash = getHash(OldBuckets[i].first);
+      unsigned Index = findInsertSlot(Hash);
+      setCtrl(Index, getH2(Hash));
+      new (&Buckets[Index]) BucketT(OldBuckets[i]);
+      OldBuckets[i].~BucketT();
+    }
+    GrowthLeft = getMaxLoad(NumBuckets) - NumEntries;
+
+    delete[] OldCtrl;
+    operator delete(OldBuckets);
+  }
+
+  void allocate(unsigned Num) {
+    NumBuckets = Num;
+    Ctrl = new ControlT[Num + swiss_detail::GroupWidth];
+    memset(Ctrl, swiss_detail::Empty, Num + swiss_detail::GroupWidth);
+    Buckets = static_cast<BucketT *>(operator new(sizeof(BucketT) * Num));
+  }
+
+  void deallocate() {
+    delete[] Ctrl;
+    operator delete(Buckets);
+  }
+
+  void destroyAll() {
+    if (isPodLike<KeyT>::value && isPodLike<ValueT>::value)
+      return;
+    for (unsigned i = 0; i != NumBuckets; ++i)
+      if (Ctrl[i] >= 0)
+        Buckets[i].~BucketT();
+  }
+
+  void copyFrom(const SwissDenseMap &Other) {
+    if (Other.NumBuckets == 0)
+      return;
+    allocate(Other.NumBuckets);
+    memcpy(Ctrl, Other.Ctrl, NumBuckets + swiss_detail::GroupWidth);
+    for (unsigned i = 0; i != NumBuckets; ++i)
+      if (Ctrl[i] >= 0)
+        new (&Buckets[i]) BucketT(Other.Buckets[i]);
+    NumEntries = Other.NumEntries;
+    GrowthLeft = Other.GrowthLeft;
+  }
+};
+
+template<typename KeyT, typename ValueT, bool IsConst>
+class SwissDenseMapIterator {
+  typedef std::pair<KeyT, ValueT> Bucket;
+  typedef SwissDenseMapIterator<KeyT, ValueT, true> ConstIterator;
+  friend class SwissDenseMapIterator<KeyT, ValueT, true>;
+public:
+  typedef ptrdiff_t difference_type;
+  typedef typename conditional<IsConst, const Bucket, Bucket>::type value_type;
+  typedef value_type *pointer;
+  typedef value_type &reference;
+  typedef std::forward_iterator_tag iterator_category;
+private:
+  const swiss_detail::ControlT *Ctrl;
+  pointer Ptr, End;
+public:
+  SwissDenseMapIterator() : Ctrl(0), Ptr(0), End(0) {}
+
+  SwissDenseMapIterator(const swiss_detail::ControlT *C, pointer Pos,
+                        pointer E, bool NoAdvance = false)
+    : Ctrl(C), Ptr(Pos), End(E) {
+    if (!NoAdvance) AdvancePastEmptyBuckets();
+  }
+
+  // If IsConst is true this is a converting constructor from iterator to
+  // const_iterator and the default copy constructor is used.
+  // Otherwise this is a copy constructor for iterator.
+  SwissDenseMapIterator(const SwissDenseMapIterator<KeyT, ValueT, false> &I)
+    : Ctrl(I.Ctrl), Ptr(I.Ptr), End(I.End) {}
+
+  reference operator*() const {
+    return *Ptr;
+  }
+  pointer operator->() const {
+    return Ptr;
+  }
+
+  bool operator==(const ConstIterator &RHS) const {
+    return Ptr == RHS.operator->();
+  }
+  bool operator!=(const ConstIterator &RHS) const {
+    return Ptr != RHS.operator->();
+  }
+
+  inline SwissDenseMapIterator& operator++() {  // Preincrement
+    ++Ptr;
+    ++Ctrl;
+    AdvancePastEmptyBuckets();
+    return *this;
+  }
+  SwissDenseMapIterator operator++(int) {  // Postincrement
+    SwissDenseMapIterator tmp = *this; ++*this; return tmp;
+  }
+
+private:
+  void AdvancePastEmptyBuckets() {
+    while (Ptr != End && *Ctrl < 0) {
+      ++Ptr;
+      ++Ctrl;
+    }
+  }
+};
+
+template<typename KeyT, typename ValueT, typename KeyInfoT>
+static inline size_t
+capacity_in_bytes(const SwissDenseMap<KeyT, ValueT, KeyInfoT> &X) {
+  return X.getMemorySize();
+}
+
+} // end namespace llvm
+
+#endif
@@ -37,7 +37,9 @@
 #ifndef LLVM_ANALYSIS_ALIASANALYSIS_H
 #define LLVM_ANALYSIS_ALIASANALYSIS_H
 
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/CallSite.h"
 
 namespace llvm {
@@ -171,6 +173,13 @@ public:
   /// alias analysis implementations.
   virtual AliasResult alias(const Location &LocA, const Location &LocB);
 
+  /// aliasMany - Compute alias(LocA, LocBs[i]) for every element of LocBs,
+  /// appending the results to Results in the same order.  Implementations
+  /// which can share work between queries against the same location override
+  /// this; the default simply issues each query in turn.
+  virtual void aliasMany(const Location &LocA, ArrayRef<Location> LocBs,
+                         SmallVectorImpl<AliasResult> &Results);
+
   /// alias - A convenience wrapper.
   AliasResult alias(const Value *V1, uint64_t V1Size,
                     const Value *V2, uint64_t V2Size) {
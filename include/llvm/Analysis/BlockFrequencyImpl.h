@@ -108,14 +108,11 @@ class BlockFrequencyImpl {
   rpot_iterator rpot_begin() { return POT.rbegin(); }
   rpot_iterator rpot_end() { return POT.rend(); }
 
-  rpot_iterator rpot_at(BlockT *BB) {
-    rpot_iterator I = rpot_begin();
-    unsigned idx = RPO.lookup(BB);
-    assert(idx);
-    std::advance(I, idx - 1);
-
-    assert(*I == BB);
-    return I;
+  /// getRPOBlock - Return the block at (one-based) reverse-postorder index
+  /// Idx.
+  BlockT *getRPOBlock(unsigned Idx) const {
+    assert(Idx && Idx <= POT.size() && "RPO index out of range");
+    return POT[POT.size() - Idx];
   }
 
   /// isBackedge - Return if edge Src -> Dst is a reachable backedge.
@@ -129,6 +126,13 @@ class BlockFrequencyImpl {
     return a >= b;
   }
 
+  /// isVisitedInLoop - Return true if BB was visited by the current doLoop
+  /// walk before the block at RPO index BBIdx.  See doBlock.
+  bool isVisitedInLoop(BlockT *BB, unsigned HeadIdx, unsigned BBIdx) const {
+    unsigned Idx = RPO.lookup(BB);
+    return Idx >= HeadIdx && Idx < BBIdx;
+  }
+
   /// getSingleBlockPred - return single BB block predecessor or NULL if
   /// BB has none or more predecessors.
   BlockT *getSingleBlockPred(BlockT *BB) {
@@ -148,8 +152,13 @@ class BlockFrequencyImpl {
     return Pred;
   }
 
-  void doBlock(BlockT *BB, BlockT *LoopHead,
-               SmallPtrSet<BlockT *, 8> &BlocksInLoop) {
+  /// doBlock - Compute the frequency of BB, the block at RPO index BBIdx,
+  /// within the loop headed by LoopHead.  doLoop visits a loop's blocks in RPO
+  /// order, so the blocks of the loop handled so far are exactly those whose
+  /// RPO index lies in [HeadIdx, BBIdx).  Testing that range is much cheaper
+  /// than building a set of the visited blocks for every loop.
+  void doBlock(BlockT *BB, BlockT *LoopHead, unsigned HeadIdx,
+               unsigned BBIdx) {
 
     DEBUG(dbgs() << "doBlock(" << getBlockName(BB) << ")\n");
     setBlockFreq(BB, 0);
@@ -160,7 +169,7 @@ class BlockFrequencyImpl {
     }
 
     if(BlockT *Pred = getSingleBlockPred(BB)) {
-      if (BlocksInLoop.count(Pred))
+      if (isVisitedInLoop(Pred, HeadIdx, BBIdx))
         setBlockFreq(BB, getEdgeFreq(Pred, BB));
       // TODO: else? irreducible, ignore it for now.
       return;
@@ -177,7 +186,7 @@ class BlockFrequencyImpl {
 
       if (isBackedge(Pred, BB)) {
         isLoopHead = true;
-      } else if (BlocksInLoop.count(Pred)) {
+      } else if (isVisitedInLoop(Pred, HeadIdx, BBIdx)) {
         incBlockFreq(BB, getEdgeFreq(Pred, BB));
         isInLoop = true;
       }
@@ -205,16 +214,12 @@ class BlockFrequencyImpl {
     DEBUG(dbgs() << "doLoop(" << getBlockName(Head) << ", "
                  << getBlockName(Tail) << ")\n");
 
-    SmallPtrSet<BlockT *, 8> BlocksInLoop;
+    unsigned HeadIdx = RPO.lookup(Head);
+    unsigned TailIdx = RPO.lookup(Tail);
+    assert(HeadIdx && HeadIdx <= TailIdx && "Loop tail precedes its header");
 
-    for (rpot_iterator I = rpot_at(Head), E = rpot_at(Tail); ; ++I) {
-      BlockT *BB = *I;
-      doBlock(BB, Head, BlocksInLoop);
-
-      BlocksInLoop.insert(BB);
-      if (I == E)
-        break;
-    }
+    for (unsigned Idx = HeadIdx; Idx <= TailIdx; ++Idx)
+      doBlock(getRPOBlock(Idx), Head, HeadIdx, Idx);
 
     // Compute loop's cyclic probability using backedges probabilities.
     BlockFrequency BackFreq;
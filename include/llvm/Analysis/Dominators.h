@@ -186,14 +186,17 @@ void Calculate(DominatorTreeBase<typename GraphTraits<N>::NodeType>& DT,
 template<class NodeT>
 class DominatorTreeBase : public DominatorBase<NodeT> {
   bool dominatedBySlowTreeWalk(const DomTreeNodeBase<NodeT> *A,
-                               const DomTreeNodeBase<NodeT> *B) const {
+                               const DomTreeNodeBase<NodeT> *B,
+                               unsigned &Steps) const {
     assert(A != B);
     assert(isReachableFromEntry(B));
     assert(isReachableFromEntry(A));
 
     const DomTreeNodeBase<NodeT> *IDom;
-    while ((IDom = B->getIDom()) != 0 && IDom != A && IDom != B)
+    while ((IDom = B->getIDom()) != 0 && IDom != A && IDom != B) {
       B = IDom;   // Walk up the tree
+      ++Steps;
+    }
     return IDom != 0;
   }
 
@@ -203,7 +206,7 @@ protected:
   DomTreeNodeBase<NodeT> *RootNode;
 
   bool DFSInfoValid;
-  unsigned int SlowQueries;
+  unsigned int SlowWalkSteps;
   // Information record used during immediate dominators computation.
   struct InfoRec {
     unsigned DFSNum;
@@ -298,7 +301,7 @@ protected:
 
 public:
   explicit DominatorTreeBase(bool isPostDom)
-    : DominatorBase<NodeT>(isPostDom), DFSInfoValid(false), SlowQueries(0) {}
+    : DominatorBase<NodeT>(isPostDom), DFSInfoValid(false), SlowWalkSteps(0) {}
   virtual ~DominatorTreeBase() { reset(); }
 
   /// compare - Return false if the other dominator tree base matches this
@@ -408,23 +411,27 @@ public:
     // Compare the result of the tree walk and the dfs numbers, if expensive
     // checks are enabled.
 #ifdef XDEBUG
+    unsigned IgnoredSteps = 0;
     assert((!DFSInfoValid ||
-            (dominatedBySlowTreeWalk(A, B) == B->DominatedBy(A))) &&
+            (dominatedBySlowTreeWalk(A, B, IgnoredSteps) ==
+             B->DominatedBy(A))) &&
            "Tree walk disagrees with dfs numbers!");
 #endif
 
     if (DFSInfoValid)
       return B->DominatedBy(A);
 
-    // If we end up with too many slow queries, just update the
-    // DFS numbers on the theory that we are going to keep querying.
-    SlowQueries++;
-    if (SlowQueries > 32) {
+    // If the slow queries since the tree was last changed have walked more
+    // nodes than renumbering would visit, just update the DFS numbers on the
+    // theory that we are going to keep querying.  Counting walked nodes rather
+    // than queries keeps a long run of cheap queries on a wide, shallow tree
+    // from renumbering the whole tree after every small update.
+    if (SlowWalkSteps > DomTreeNodes.size()) {
       updateDFSNumbers();
       return B->DominatedBy(A);
     }
 
-    return dominatedBySlowTreeWalk(A, B);
+    return dominatedBySlowTreeWalk(A, B, SlowWalkSteps);
   }
 
   bool dominates(const NodeT *A, const NodeT *B);
@@ -517,6 +524,82 @@ public:
     changeImmediateDominator(getNode(BB), getNode(NewBB));
   }
 
+  /// reparentChildren - Make NewIDom the immediate dominator of every node
+  /// immediately dominated by N.  NewIDom may itself be a child of N, in which
+  /// case it stays one.  Unlike calling changeImmediateDominator on each child
+  /// this is linear in the number of children.
+  void reparentChildren(DomTreeNodeBase<NodeT> *N,
+                        DomTreeNodeBase<NodeT> *NewIDom) {
+    assert(N && NewIDom && N != NewIDom && "Cannot reparent onto itself!");
+    DFSInfoValid = false;
+    bool NewIDomIsChild = false;
+    for (typename DomTreeNodeBase<NodeT>::iterator I = N->begin(),
+           E = N->end(); I != E; ++I) {
+      if (*I == NewIDom) {
+        NewIDomIsChild = true;
+        continue;
+      }
+      (*I)->IDom = NewIDom;
+      NewIDom->Children.push_back(*I);
+    }
+    N->clearAllChildren();
+    if (NewIDomIsChild)
+      N->addChild(NewIDom);
+  }
+
+  /// insertEdge - Update the tree after the edge From->To has been added to
+  /// the CFG.  Only the blocks dominated by the nearest common dominator of
+  /// From and To are recomputed.  This is not implemented for post dominators.
+  void insertEdge(NodeT *From, NodeT *To) {
+    assert(!this->isPostDominator() &&
+           "Incremental updates are not implemented for post dominators");
+    DomTreeNodeBase<NodeT> *FromNode = getNode(From);
+    // An edge out of unreachable code changes nothing.
+    if (!FromNode)
+      return;
+
+    // The edge makes To reachable, and To may lead anywhere in the function.
+    DomTreeNodeBase<NodeT> *ToNode = getNode(To);
+    if (!ToNode) {
+      recalculateSubtree(RootNode);
+      return;
+    }
+
+    // If To dominates From this is a back edge, and if the nearest common
+    // dominator is already To's immediate dominator then no block gained a
+    // path that avoids any of its dominators.
+    DomTreeNodeBase<NodeT> *NCD = getNode(findNearestCommonDominator(From, To));
+    if (NCD == ToNode || NCD == ToNode->getIDom())
+      return;
+    recalculateSubtree(NCD);
+  }
+
+  /// deleteEdge - Update the tree after the edge From->To has been removed
+  /// from the CFG.  Only the blocks dominated by the nearest common dominator
+  /// of From and To are recomputed, and blocks which became unreachable are
+  /// removed from the tree.  This is not implemented for post dominators.
+  void deleteEdge(NodeT *From, NodeT *To) {
+    assert(!this->isPostDominator() &&
+           "Incremental updates are not implemented for post dominators");
+    DomTreeNodeBase<NodeT> *FromNode = getNode(From);
+    DomTreeNodeBase<NodeT> *ToNode = getNode(To);
+    if (!FromNode || !ToNode)
+      return;
+
+    // From may still reach To along another edge, e.g. from a switch.
+    typedef GraphTraits<NodeT*> GraphT;
+    for (typename GraphT::ChildIteratorType SI = GraphT::child_begin(From),
+           SE = GraphT::child_end(From); SI != SE; ++SI)
+      if (*SI == To)
+        return;
+
+    // Removing a back edge cannot change dominance.
+    DomTreeNodeBase<NodeT> *NCD = getNode(findNearestCommonDominator(From, To));
+    if (NCD == ToNode)
+      return;
+    recalculateSubtree(NCD);
+  }
+
   /// eraseNode - Removes a node from the dominator tree. Block must not
   /// dominate any other blocks. Removes node from its immediate dominator's
   /// children list. Deletes dominator node associated with basic block BB.
@@ -566,7 +649,7 @@ public:
     else
       o << "Inorder Dominator Tree: ";
     if (!this->DFSInfoValid)
-      o << "DFSNumbers invalid: " << SlowQueries << " slow queries.";
+      o << "DFSNumbers invalid: " << SlowWalkSteps << " slow walk steps.";
     o << "\n";
 
     // The postdom tree can have a null root if there are no returns.
@@ -630,7 +713,7 @@ protected:
       }
     }
 
-    SlowQueries = 0;
+    SlowWalkSteps = 0;
     DFSInfoValid = true;
   }
 
@@ -655,6 +738,109 @@ protected:
     return IDoms.lookup(BB);
   }
 
+  /// recalculateSubtree - Recompute the immediate dominators of the blocks
+  /// dominated by SubRoot, whose own immediate dominator must be unchanged.
+  /// Every path into the subtree enters through SubRoot, so only edges between
+  /// its blocks (and blocks not yet in the tree) are considered.  Blocks which
+  /// are no longer reachable are removed from the tree.
+  void recalculateSubtree(DomTreeNodeBase<NodeT> *SubRoot) {
+    typedef GraphTraits<NodeT*> GraphT;
+    typedef GraphTraits<Inverse<NodeT*> > InvGraphT;
+    const unsigned Unnumbered = ~0U;
+
+    // Collect the nodes currently dominated by SubRoot.
+    SmallVector<DomTreeNodeBase<NodeT>*, 32> OldNodes;
+    SmallPtrSet<NodeT*, 32> InSubtree;
+    OldNodes.push_back(SubRoot);
+    for (unsigned i = 0; i != OldNodes.size(); ++i) {
+      DomTreeNodeBase<NodeT> *N = OldNodes[i];
+      InSubtree.insert(N->getBlock());
+      OldNodes.append(N->begin(), N->end());
+    }
+
+    // Number the blocks reachable from SubRoot in post order.
+    std::vector<NodeT*> PostOrder;
+    DenseMap<NodeT*, unsigned> PONum;
+    SmallVector<std::pair<NodeT*, typename GraphT::ChildIteratorType>, 32>
+      Stack;
+    NodeT *RootBB = SubRoot->getBlock();
+    PONum[RootBB] = Unnumbered;
+    Stack.push_back(std::make_pair(RootBB, GraphT::child_begin(RootBB)));
+    while (!Stack.empty()) {
+      NodeT *BB = Stack.back().first;
+      if (Stack.back().second == GraphT::child_end(BB)) {
+        PONum[BB] = PostOrder.size();
+        PostOrder.push_back(BB);
+        Stack.pop_back();
+        continue;
+      }
+      NodeT *Succ = *Stack.back().second++;
+      if (!InSubtree.count(Succ) && getNode(Succ))
+        continue;
+      if (PONum.insert(std::make_pair(Succ, Unnumbered)).second)
+        Stack.push_back(std::make_pair(Succ, GraphT::child_begin(Succ)));
+    }
+
+    // Iterate to a fixed point over the blocks in reverse post order, using
+    // the algorithm from "A Simple, Fast Dominance Algorithm" by Cooper,
+    // Harvey and Kennedy.  SubRoot finished last, so it is numbered highest.
+    unsigned RootNum = PostOrder.size() - 1;
+    std::vector<unsigned> IDom(PostOrder.size(), Unnumbered);
+    IDom[RootNum] = RootNum;
+    bool Changed = true;
+    while (Changed) {
+      Changed = false;
+      for (unsigned i = RootNum; i-- != 0;) {
+        NodeT *BB = PostOrder[i];
+        unsigned NewIDom = Unnumbered;
+        for (typename InvGraphT::ChildIteratorType
+               PI = InvGraphT::child_begin(BB),
+               PE = InvGraphT::child_end(BB); PI != PE; ++PI) {
+          typename DenseMap<NodeT*, unsigned>::iterator PN = PONum.find(*PI);
+          if (PN == PONum.end() || IDom[PN->second] == Unnumbered)
+            continue;
+          unsigned P = PN->second;
+          if (NewIDom == Unnumbered) {
+            NewIDom = P;
+            continue;
+          }
+          while (P != NewIDom) {
+            while (P < NewIDom)
+              P = IDom[P];
+            while (NewIDom < P)
+              NewIDom = IDom[NewIDom];
+          }
+        }
+        if (IDom[i] != NewIDom) {
+          IDom[i] = NewIDom;
+          Changed = true;
+        }
+      }
+    }
+
+    // Detach the old subtree, dropping blocks which are no longer reachable,
+    // and then attach each reachable block to its new immediate dominator.
+    for (unsigned i = 0, e = OldNodes.size(); i != e; ++i) {
+      DomTreeNodeBase<NodeT> *N = OldNodes[i];
+      N->clearAllChildren();
+      if (N != SubRoot && !PONum.count(N->getBlock())) {
+        DomTreeNodes.erase(N->getBlock());
+        delete N;
+      }
+    }
+    for (unsigned i = RootNum; i-- != 0;) {
+      NodeT *BB = PostOrder[i];
+      DomTreeNodeBase<NodeT> *IDomNode = getNode(PostOrder[IDom[i]]);
+      DomTreeNodeBase<NodeT> *&Node = DomTreeNodes[BB];
+      if (!Node)
+        Node = new DomTreeNodeBase<NodeT>(BB, IDomNode);
+      else
+        Node->IDom = IDomNode;
+      IDomNode->addChild(Node);
+    }
+    DFSInfoValid = false;
+  }
+
   inline void addRoot(NodeT* BB) {
     this->Roots.push_back(BB);
   }
@@ -865,6 +1051,24 @@ public:
     DT->changeImmediateDominator(N, NewIDom);
   }
 
+  /// reparentChildren - Make NewIDom the immediate dominator of every node
+  /// immediately dominated by N, in time linear in the number of children.
+  inline void reparentChildren(DomTreeNode *N, DomTreeNode *NewIDom) {
+    DT->reparentChildren(N, NewIDom);
+  }
+
+  /// insertEdge - Update the tree after the edge From->To has been added to
+  /// the CFG.
+  inline void insertEdge(BasicBlock *From, BasicBlock *To) {
+    DT->insertEdge(From, To);
+  }
+
+  /// deleteEdge - Update the tree after the edge From->To has been removed
+  /// from the CFG.
+  inline void deleteEdge(BasicBlock *From, BasicBlock *To) {
+    DT->deleteEdge(From, To);
+  }
+
   /// eraseNode - Removes a node from the dominator tree. Block must not
   /// dominate any other blocks. Removes node from its immediate dominator's
   /// children list. Deletes dominator node associated with basic block BB.
@@ -32,6 +32,8 @@
 #ifndef LLVM_ANALYSIS_INSTRUCTIONSIMPLIFY_H
 #define LLVM_ANALYSIS_INSTRUCTIONSIMPLIFY_H
 
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/ValueMap.h"
 #include "llvm/IR/User.h"
 
 namespace llvm {
@@ -238,11 +240,53 @@ namespace llvm {
                       const TargetLibraryInfo *TLI = 0,
                       const DominatorTree *DT = 0);
 
+  /// SimplifyInstructionCache - Remembers the instructions SimplifyInstruction
+  /// failed to simplify, so that passes asking again about an instruction
+  /// whose operands have not changed get an answer without redoing the
+  /// analysis.  Only failures are recorded: a cached result can then at worst
+  /// miss a simplification made possible by a change further up the operand
+  /// tree, never return a value that is no longer equivalent.  Entries are
+  /// dropped when their instruction is deleted, and ignored once any of its
+  /// operands has been replaced.
+  ///
+  /// A cache is meant to live for one pass run over one function, with the
+  /// same DataLayout, TargetLibraryInfo and DominatorTree passed to every
+  /// query.
+  class SimplifyInstructionCache {
+    struct Config : ValueMapConfig<const Instruction *> {
+      // An instruction being replaced will be deleted, or at least is not
+      // interesting anymore; keep the entry keyed on it so that it goes away.
+      enum { FollowRAUW = false };
+    };
+    typedef ValueMap<const Instruction *, SmallVector<Value *, 4>, Config>
+      MapTy;
+
+    /// Unsimplified - The operands each cached instruction had when it failed
+    /// to simplify.
+    MapTy Unsimplified;
+
+  public:
+    /// isKnownUnsimplified - Return true if I failed to simplify before and
+    /// still has the same operands.
+    bool isKnownUnsimplified(const Instruction *I);
+
+    /// setUnsimplified - Record that I, with its current operands, does not
+    /// simplify.
+    void setUnsimplified(const Instruction *I);
+
+    /// clear - Forget every cached result, e.g. when the analyses used by
+    /// the queries change.
+    void clear() { Unsimplified.clear(); }
+  };
+
   /// SimplifyInstruction - See if we can compute a simplified version of this
-  /// instruction.  If not, this returns null.
+  /// instruction.  If not, this returns null.  If Cache is given, a previous
+  /// failure on I with the same operands is returned right away, and a new
+  /// failure is recorded in it.
   Value *SimplifyInstruction(Instruction *I, const DataLayout *TD = 0,
                              const TargetLibraryInfo *TLI = 0,
-                             const DominatorTree *DT = 0);
+                             const DominatorTree *DT = 0,
+                             SimplifyInstructionCache *Cache = 0);
 
 
   /// \brief Replace all uses of 'I' with 'SimpleV' and simplify the uses
@@ -408,6 +408,12 @@ namespace llvm {
     /// Analyze the expression.
     const SCEV *createSCEV(Value *V);
 
+    /// isOverMemoryBudget - Return true if expressions for the current function
+    /// have used up the memory allowed by -scalar-evolution-max-memory, in
+    /// which case new values are treated as unknown and new backedge-taken
+    /// counts are not computed.
+    bool isOverMemoryBudget() const;
+
     /// createNodeForPHI - Provide the special handling we need to analyze PHI
     /// SCEVs.
     const SCEV *createNodeForPHI(PHINode *PN);
@@ -368,6 +368,16 @@ public:
                                    unsigned Alignment,
                                    unsigned AddressSpace) const;
 
+  /// \return The cost of an interleaved group of loads or stores.
+  ///
+  /// \p VecTy is the type of the single wide access covering every member,
+  /// e.g. <8 x i32> for four pairs of i32 accessed by two members. Member I
+  /// reads or writes lanes I, I + Factor, I + 2 * Factor, ... of it.
+  virtual unsigned getInterleavedMemoryOpCost(unsigned Opcode, Type *VecTy,
+                                              unsigned Factor,
+                                              unsigned Alignment,
+                                              unsigned AddressSpace) const;
+
   /// \brief Calculate the cost of performing a vector reduction.
   ///
   /// This is the cost of reducing the vector value of type \p Ty to a scalar
@@ -18,11 +18,28 @@
 
 namespace llvm {
 
+class Function;
 class Module;
 class MemoryBuffer;
 class SMDiagnostic;
 class LLVMContext;
 
+/// ParsedFunctionListener - Clients of ParseAssembly that want to start
+/// working on function bodies before the whole file has been parsed implement
+/// this interface.
+class ParsedFunctionListener {
+public:
+  virtual ~ParsedFunctionListener();
+
+  /// functionParsed - Called for each function definition, in the order the
+  /// definitions appear, once its body has been parsed and nothing the parser
+  /// has seen so far is still a forward reference.  The listener may inspect
+  /// or transform the body, but must not delete the function or any of its
+  /// named basic blocks.  Functions reported before the end of the file have
+  /// not been through the intrinsic and debug info auto-upgrade yet.
+  virtual void functionParsed(Function &F) = 0;
+};
+
 /// This function is the main interface to the LLVM Assembly Parser. It parses
 /// an ASCII file that (presumably) contains LLVM Assembly code. It returns a
 /// Module (intermediate representation) with the corresponding features. Note
@@ -51,12 +68,14 @@ Module *ParseAssemblyString(
 /// This function is the low-level interface to the LLVM Assembly Parser.
 /// ParseAssemblyFile and ParseAssemblyString are wrappers around this function.
 /// @brief Parse LLVM Assembly from a MemoryBuffer. This function *always*
-/// takes ownership of the MemoryBuffer.
+/// takes ownership of the MemoryBuffer.  If Listener is non-null, it is told
+/// about each function definition as soon as the body can no longer change.
 Module *ParseAssembly(
     MemoryBuffer *F,     ///< The MemoryBuffer containing assembly
     Module *M,           ///< A module to add the assembly too.
     SMDiagnostic &Err,   ///< Error result info.
-    LLVMContext &Context
+    LLVMContext &Context,
+    ParsedFunctionListener *Listener = 0 ///< Optional function callback.
 );
 
 } // End llvm namespace
@@ -17,9 +17,14 @@
 #ifndef LLVM_ASSEMBLY_WRITER_H
 #define LLVM_ASSEMBLY_WRITER_H
 
+#include "llvm/ADT/OwningPtr.h"
+
 namespace llvm {
 
+class Function;
 class Module;
+class SlotTracker;
+class TypePrinting;
 class Value;
 class raw_ostream;
 
@@ -32,6 +37,34 @@ class raw_ostream;
 void WriteAsOperand(raw_ostream &, const Value *, bool PrintTy = true,
                     const Module *Context = 0);
 
+/// ModuleSlotTracker - Cache the slot numbers and type names of a module, so
+/// that printing many values from it with Value::print does not number the
+/// whole module again for every value.  Local slot numbers are kept for one
+/// function at a time.  The module must not be changed while a tracker for it
+/// is in use, except that a function may be incorporated again after its body
+/// has been changed.
+class ModuleSlotTracker {
+  OwningPtr<SlotTracker> Machine;
+  OwningPtr<TypePrinting> TypePrinter;
+  const Module *M;
+
+  ModuleSlotTracker(const ModuleSlotTracker &) LLVM_DELETED_FUNCTION;
+  void operator=(const ModuleSlotTracker &) LLVM_DELETED_FUNCTION;
+public:
+  explicit ModuleSlotTracker(const Module *M);
+  ~ModuleSlotTracker();
+
+  const Module *getModule() const { return M; }
+
+  /// incorporateFunction - Number the local values of F, dropping the numbers
+  /// of the previously incorporated function.  Value::print does this on its
+  /// own when it gets a value from a function other than the current one.
+  void incorporateFunction(const Function &F);
+
+  SlotTracker &getMachine() { return *Machine; }
+  TypePrinting &getTypePrinter() { return *TypePrinter; }
+};
+
 } // End llvm namespace
 
 #endif
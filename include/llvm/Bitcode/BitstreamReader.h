@@ -46,6 +46,12 @@ public:
 private:
   OwningPtr<StreamableMemoryObject> BitcodeBytes;
 
+  /// BufferStart/BufferSize - If the bitcode is a contiguous, non-streamed
+  /// range of memory, this is that range.  Cursors read words straight out of
+  /// it instead of copying them through the StreamableMemoryObject interface.
+  const unsigned char *BufferStart;
+  size_t BufferSize;
+
   std::vector<BlockInfo> BlockInfoRecords;
 
   /// IgnoreBlockInfoNames - This is set to true if we don't care about the
@@ -56,7 +62,8 @@ private:
   BitstreamReader(const BitstreamReader&) LLVM_DELETED_FUNCTION;
   void operator=(const BitstreamReader&) LLVM_DELETED_FUNCTION;
 public:
-  BitstreamReader() : IgnoreBlockInfoNames(true) {
+  BitstreamReader()
+    : BufferStart(0), BufferSize(0), IgnoreBlockInfoNames(true) {
   }
 
   BitstreamReader(const unsigned char *Start, const unsigned char *End) {
@@ -64,17 +71,27 @@ public:
     init(Start, End);
   }
 
-  BitstreamReader(StreamableMemoryObject *bytes) {
+  BitstreamReader(StreamableMemoryObject *bytes)
+    : BufferStart(0), BufferSize(0) {
     BitcodeBytes.reset(bytes);
   }
 
   void init(const unsigned char *Start, const unsigned char *End) {
     assert(((End-Start) & 3) == 0 &&"Bitcode stream not a multiple of 4 bytes");
     BitcodeBytes.reset(getNonStreamedMemoryObject(Start, End));
+    BufferStart = Start;
+    BufferSize = End-Start;
   }
 
   StreamableMemoryObject &getBitcodeBytes() { return *BitcodeBytes; }
 
+  /// getBufferStart - If the bitcode is contiguous in memory, return a pointer
+  /// to its first byte, otherwise return null.
+  const unsigned char *getBufferStart() const { return BufferStart; }
+
+  /// getBufferSize - The size of the contiguous buffer, if there is one.
+  size_t getBufferSize() const { return BufferSize; }
+
   ~BitstreamReader() {
     // Free the BlockInfoRecords.
     while (!BlockInfoRecords.empty()) {
@@ -233,16 +250,25 @@ public:
   void freeState();
 
   bool isEndPos(size_t pos) {
+    if (BitStream->getBufferStart())
+      return pos == BitStream->getBufferSize();
     return BitStream->getBitcodeBytes().isObjectEnd(static_cast<uint64_t>(pos));
   }
 
   bool canSkipToPos(size_t pos) const {
+    if (BitStream->getBufferStart())
+      return pos <= BitStream->getBufferSize();
     // pos can be skipped to if it is a valid address or one byte past the end.
     return pos == 0 || BitStream->getBitcodeBytes().isValidAddress(
         static_cast<uint64_t>(pos - 1));
   }
 
   uint32_t getWord(size_t pos) {
+    if (const unsigned char *Buf = BitStream->getBufferStart()) {
+      if (pos + 4 <= BitStream->getBufferSize())
+        return *reinterpret_cast<const support::ulittle32_t *>(Buf + pos);
+      return ~0U;
+    }
     uint8_t buf[4] = { 0xFF, 0xFF, 0xFF, 0xFF };
     BitStream->getBitcodeBytes().readBytes(pos, sizeof(buf), buf);
     return *reinterpret_cast<support::ulittle32_t *>(buf);
@@ -354,26 +380,40 @@ public:
       return R;
     }
 
-    // If we run out of data, stop at the end of the stream.
-    if (isEndPos(NextChar)) {
-      CurWord = 0;
-      BitsInCurWord = 0;
-      return 0;
-    }
+    typedef support::detail::packed_endian_specific_integral
+      <word_t, support::little, support::unaligned> EndianWord;
 
     uint32_t R = uint32_t(CurWord);
 
-    // Read the next word from the stream.
-    uint8_t Array[sizeof(word_t)] = {0};
+    if (const unsigned char *Buf = BitStream->getBufferStart()) {
+      // Fast path: the whole stream is in memory, so load the word directly.
+      // NextChar is always word aligned and the buffer size is a multiple of
+      // the word size, so this never reads past the end.
+      if (NextChar >= BitStream->getBufferSize()) {
+        CurWord = 0;
+        BitsInCurWord = 0;
+        return 0;
+      }
+      CurWord = *reinterpret_cast<const EndianWord *>(Buf + NextChar);
+    } else {
+      // If we run out of data, stop at the end of the stream.
+      if (isEndPos(NextChar)) {
+        CurWord = 0;
+        BitsInCurWord = 0;
+        return 0;
+      }
 
-    BitStream->getBitcodeBytes().readBytes(NextChar, sizeof(Array), Array);
+      // Read the next word from the stream.
+      uint8_t Array[sizeof(word_t)] = {0};
 
-    // Handle big-endian byte-swapping if necessary.
-    support::detail::packed_endian_specific_integral
-      <word_t, support::little, support::unaligned> EndianValue;
-    memcpy(&EndianValue, Array, sizeof(Array));
+      BitStream->getBitcodeBytes().readBytes(NextChar, sizeof(Array), Array);
 
-    CurWord = EndianValue;
+      // Handle big-endian byte-swapping if necessary.
+      EndianWord EndianValue;
+      memcpy(&EndianValue, Array, sizeof(Array));
+
+      CurWord = EndianValue;
+    }
 
     NextChar += sizeof(word_t);
 
@@ -42,7 +42,9 @@ namespace bitc {
 
     TYPE_BLOCK_ID_NEW,
 
-    USELIST_BLOCK_ID
+    USELIST_BLOCK_ID,
+
+    MODULE_SUMMARY_BLOCK_ID
   };
 
 
@@ -71,7 +73,20 @@ namespace bitc {
     // MODULE_CODE_PURGEVALS: [numvals]
     MODULE_CODE_PURGEVALS   = 10,
 
-    MODULE_CODE_GCNAME      = 11   // GCNAME: [strchr x N]
+    MODULE_CODE_GCNAME      = 11,  // GCNAME: [strchr x N]
+
+    // FNINDEX: [blob of 64-bit bit offsets, one per function with a body]
+    MODULE_CODE_FNINDEX     = 12
+  };
+
+  /// MODULE_SUMMARY blocks describe the global values of a module so that
+  /// tools can query them without reading the IR.
+  enum ModuleSummaryCodes {
+    // SYMBOL: [kind, aliaseekind, isdefinition, linkage, visibility,
+    //          instcount, namechar x N]
+    SUMMARY_CODE_SYMBOL = 1,
+    // CALLS:  [symbol# x N], the direct callees of the preceding symbol.
+    SUMMARY_CODE_CALLS  = 2
   };
 
   /// PARAMATTR blocks have code for defining a parameter attribute set.
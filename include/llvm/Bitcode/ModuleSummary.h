@@ -0,0 +1,70 @@
+//===-- llvm/Bitcode/ModuleSummary.h - Bitcode module summaries -*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares the interface for reading the optional module summary
+// block that the bitcode writer emits when -bitcode-module-summary is given.
+// The summary describes the global values of a module without requiring a
+// Module to be constructed.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_BITCODE_MODULESUMMARY_H
+#define LLVM_BITCODE_MODULESUMMARY_H
+
+#include "llvm/IR/GlobalValue.h"
+#include <string>
+#include <vector>
+
+namespace llvm {
+  class MemoryBuffer;
+
+  /// BitcodeSummarySymbol - One global value described by a module summary.
+  struct BitcodeSummarySymbol {
+    enum SymbolKind {
+      Variable,
+      Function,
+      Alias,
+      Unknown
+    };
+
+    std::string Name;
+    SymbolKind Kind;
+
+    /// AliaseeKind - For aliases, the kind of the aliased global, or Unknown
+    /// if it could not be determined.  Unknown for everything else.
+    SymbolKind AliaseeKind;
+
+    bool IsDefinition;
+    GlobalValue::LinkageTypes Linkage;
+    GlobalValue::VisibilityTypes Visibility;
+
+    /// InstCount - The number of instructions in a function definition.
+    unsigned InstCount;
+
+    /// Callees - The symbols called directly from a function definition,
+    /// as indices into the summary's symbol list.
+    std::vector<unsigned> Callees;
+
+    BitcodeSummarySymbol()
+      : Kind(Unknown), AliaseeKind(Unknown), IsDefinition(false),
+        Linkage(GlobalValue::ExternalLinkage),
+        Visibility(GlobalValue::DefaultVisibility), InstCount(0) {}
+  };
+
+  /// readBitcodeModuleSummary - Read the module summary block of the specified
+  /// bitcode buffer into Symbols, without constructing any IR.  This returns
+  /// true and fills in *ErrMsg if the buffer is malformed or has no summary, in
+  /// which case clients should fall back to loading the module.  This never
+  /// takes ownership of Buffer.
+  bool readBitcodeModuleSummary(MemoryBuffer *Buffer,
+                                std::vector<BitcodeSummarySymbol> &Symbols,
+                                std::string *ErrMsg = 0);
+} // End llvm namespace
+
+#endif
@@ -25,6 +25,7 @@
 #include "llvm/Support/DebugLoc.h"
 #include "llvm/Support/ValueHandle.h"
 #include <utility>
+#include <vector>
 namespace llvm {
 
 class MachineInstr;
@@ -120,6 +121,13 @@ private:
   /// getOrCreateAbstractScope - Find or create an abstract lexical scope.
   LexicalScope *getOrCreateAbstractScope(const MDNode *N);
 
+  /// getCachedScope - Return the scope found for the scope index of DL, or
+  /// NULL if there is none yet.
+  LexicalScope *getCachedScope(DebugLoc DL) const;
+
+  /// setCachedScope - Remember the scope of the scope index of DL.
+  void setCachedScope(DebugLoc DL, LexicalScope *Scope);
+
   /// extractLexicalScopes - Extract instruction ranges for each lexical scopes
   /// for the given machine function.
   void extractLexicalScopes(SmallVectorImpl<InsnRange> &MIRanges,
@@ -148,6 +156,16 @@ private:
   /// a function.
   SmallVector<LexicalScope *, 4> AbstractScopesList;
 
+  /// ScopeCache, InlinedScopeCache - The scope of each DebugLoc scope index
+  /// used in the current function, indexed by the scope index of locations
+  /// without and with an InlinedAt respectively.  Locations can be mapped to
+  /// their scope with an array access instead of map lookups.
+  std::vector<LexicalScope *> ScopeCache, InlinedScopeCache;
+
+  /// CachedScopeIdxs - The scope indices set in the caches, so that only
+  /// these need clearing between functions.
+  SmallVector<int, 32> CachedScopeIdxs;
+
   /// CurrentFnLexicalScope - Top level scope for the current function.
   ///
   LexicalScope *CurrentFnLexicalScope;
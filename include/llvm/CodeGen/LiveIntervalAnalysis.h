@@ -58,6 +58,10 @@ namespace llvm {
     MachineDominatorTree *DomTree;
     LiveRangeCalc *LRCalc;
 
+    /// LazyVirtRegs - True if virtual register intervals are computed on the
+    /// first getInterval() query instead of up front.
+    bool LazyVirtRegs;
+
     /// Special pool allocator for VNInfo's (LiveInterval val#).
     ///
     VNInfo::Allocator VNInfoAllocator;
@@ -116,10 +120,17 @@ namespace llvm {
       return const_cast<LiveIntervals*>(this)->getInterval(Reg);
     }
 
+    /// hasInterval - Return true if the interval of virtual register Reg has
+    /// been computed.  When intervals are computed lazily, a register with
+    /// defs or uses may not have one yet; getInterval() computes it.
     bool hasInterval(unsigned Reg) const {
       return VirtRegIntervals.inBounds(Reg) && VirtRegIntervals[Reg];
     }
 
+    /// computesVirtRegsLazily - Return true if virtual register intervals are
+    /// computed on demand rather than all at once in runOnMachineFunction.
+    bool computesVirtRegsLazily() const { return LazyVirtRegs; }
+
     // Interval creation.
     LiveInterval &createEmptyInterval(unsigned Reg) {
       assert(!hasInterval(Reg) && "Interval already exists!");
@@ -58,6 +58,14 @@ class LiveRegMatrix : public MachineFunctionPass {
   unsigned RegMaskVirtReg;
   BitVector RegMaskUsable;
 
+  // Cached register unit interference info, indexed by PhysReg.  The fixed
+  // register unit live ranges don't change during allocation, so the answer
+  // for a PhysReg stays valid until VirtReg is modified.
+  unsigned RegUnitTag;
+  unsigned RegUnitVirtReg;
+  BitVector RegUnitChecked;
+  BitVector RegUnitInterferes;
+
   // MachineFunctionPass boilerplate.
   virtual void getAnalysisUsage(AnalysisUsage&) const;
   virtual bool runOnMachineFunction(MachineFunction&);
@@ -100,7 +100,8 @@ class MachineFunction {
   // numbered and this vector keeps track of the mapping from ID's to MBB's.
   std::vector<MachineBasicBlock*> MBBNumbering;
 
-  // Pool-allocate MachineFunction-lifetime and IR objects.
+  // Pool-allocate MachineFunction-lifetime and IR objects.  The slabs are
+  // recycled by the MachineModuleInfo for the next function.
   BumpPtrAllocator Allocator;
 
   // Allocation management for instructions in function.
@@ -134,6 +135,10 @@ class MachineFunction {
   /// True if the function includes any inline assembly.
   bool HasInlineAsm;
 
+  /// VerifiedFingerprint - The fingerprint of the function the last time the
+  /// machine verifier found no errors in it, or 0.
+  size_t VerifiedFingerprint;
+
   MachineFunction(const MachineFunction &) LLVM_DELETED_FUNCTION;
   void operator=(const MachineFunction&) LLVM_DELETED_FUNCTION;
 public:
@@ -227,6 +232,16 @@ public:
   void setHasInlineAsm(bool B) {
     HasInlineAsm = B;
   }
+
+  /// getVerifiedFingerprint - Return the fingerprint the machine verifier
+  /// recorded for -verify-machineinstrs-incremental, or 0 if it has none.
+  size_t getVerifiedFingerprint() const {
+    return VerifiedFingerprint;
+  }
+
+  void setVerifiedFingerprint(size_t F) {
+    VerifiedFingerprint = F;
+  }
   
   /// getInfo - Keep track of various per-function pieces of information for
   /// backends that would like to do so.
@@ -118,6 +118,10 @@ public:
     return LI.isLoopHeader(BB);
   }
 
+  /// getInnermostLoops - Append the loops without sub-loops to Loops, in
+  /// loop tree order.
+  void getInnermostLoops(SmallVectorImpl<MachineLoop*> &Loops) const;
+
   /// runOnFunction - Calculate the natural loop information.
   ///
   virtual bool runOnMachineFunction(MachineFunction &F);
@@ -42,6 +42,7 @@
 #include "llvm/Support/DataTypes.h"
 #include "llvm/Support/DebugLoc.h"
 #include "llvm/Support/Dwarf.h"
+#include "llvm/Support/ThreadLocalAllocator.h"
 #include "llvm/Support/ValueHandle.h"
 
 namespace llvm {
@@ -98,6 +99,10 @@ class MachineModuleInfo : public ImmutablePass {
   /// Context - This is the MCContext used for the entire code generator.
   MCContext Context;
 
+  /// FunctionSlabs - The slabs of the allocators of this module's
+  /// MachineFunctions, kept from one function to the next.
+  RecyclingSlabAllocator FunctionSlabs;
+
   /// TheModule - This is the LLVM Module being worked on.
   const Module *TheModule;
 
@@ -190,6 +195,8 @@ public:
   const MCContext &getContext() const { return Context; }
   MCContext &getContext() { return Context; }
 
+  RecyclingSlabAllocator &getFunctionSlabAllocator() { return FunctionSlabs; }
+
   void setModule(const Module *M) { TheModule = M; }
   const Module *getModule() const { return TheModule; }
 
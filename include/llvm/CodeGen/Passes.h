@@ -438,6 +438,12 @@ namespace llvm {
   ///
   FunctionPass *createBasicRegisterAllocator();
 
+  /// LinearScanRegisterAllocation Pass - This pass implements a global
+  /// register allocator that assigns live ranges in order of their start
+  /// points, for code that must be compiled quickly.
+  ///
+  FunctionPass *createLinearScanRegisterAllocator();
+
   /// Greedy register allocation pass - This pass implements a global register
   /// allocator for optimized builds.
   ///
@@ -477,6 +483,10 @@ namespace llvm {
   /// usage in an ensemble of traces.
   extern char &MachineTraceMetricsID;
 
+  /// MachineLoopTraceReport - This pass prints the critical path and resource
+  /// usage of each innermost loop.
+  extern char &MachineLoopTraceReportID;
+
   /// EarlyIfConverter - This pass performs if-conversion on SSA form by
   /// inserting cmov instructions.
   extern char &EarlyIfConverterID;
@@ -20,6 +20,7 @@
 #include "llvm/ADT/ilist.h"
 #include "llvm/CodeGen/DAGCombine.h"
 #include "llvm/CodeGen/SelectionDAGNodes.h"
+#include "llvm/Support/ArrayRecycler.h"
 #include "llvm/Support/RecyclingAllocator.h"
 #include "llvm/Target/TargetMachine.h"
 #include <cassert>
@@ -200,6 +201,12 @@ class SelectionDAG {
   /// OperandAllocator - Pool allocation for machine-opcode SDNode operands.
   BumpPtrAllocator OperandAllocator;
 
+  /// OperandRecycler - Recycling of the operand lists of nodes that have more
+  /// operands than they can hold inline.  The lists are allocated from
+  /// OperandAllocator, so deleting or morphing such a node never touches the
+  /// heap.
+  ArrayRecycler<SDUse> OperandRecycler;
+
   /// Allocator - Pool allocation for misc. objects that are created once per
   /// SelectionDAG.
   BumpPtrAllocator Allocator;
@@ -1167,6 +1174,15 @@ private:
   void DeleteNodeNotInCSEMaps(SDNode *N);
   void DeallocateNode(SDNode *N);
 
+  /// createOperands - Set the operands of Node to Ops, in a list drawn from
+  /// OperandRecycler.  A recycled list Node already has is reused if it has
+  /// the right capacity and released otherwise.
+  void createOperands(SDNode *Node, const SDValue *Ops, unsigned NumOps);
+
+  /// removeOperands - Return the operand list of Node to OperandRecycler if
+  /// it came from there.
+  void removeOperands(SDNode *Node);
+
   unsigned getEVTAlignment(EVT MemoryVT) const;
 
   void allnodes_clear();
@@ -367,7 +367,10 @@ namespace llvm {
       return entry;
     }
 
-    /// Renumber locally after inserting curItr.
+    /// Renumber locally after inserting curItr.  The smallest window of
+    /// entries around curItr, grown by doubling, that can be spread out to at
+    /// least half the default spacing is renumbered evenly, so repeated
+    /// insertions at one point cost amortized logarithmic time.
     void renumberIndexes(IndexList::iterator curItr);
 
   public:
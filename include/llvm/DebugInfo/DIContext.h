@@ -139,12 +139,22 @@ public:
 
   virtual void dump(raw_ostream &OS, DIDumpType DumpType = DIDT_All) = 0;
 
+  /// dumpStatistics - print a summary of where the bytes of the debug info
+  /// go, without printing the entries themselves.
+  virtual void dumpStatistics(raw_ostream &OS) = 0;
+
   virtual DILineInfo getLineInfoForAddress(uint64_t Address,
       DILineInfoSpecifier Specifier = DILineInfoSpecifier()) = 0;
   virtual DILineInfoTable getLineInfoForAddressRange(uint64_t Address,
       uint64_t Size, DILineInfoSpecifier Specifier = DILineInfoSpecifier()) = 0;
   virtual DIInliningInfo getInliningInfoForAddress(uint64_t Address,
       DILineInfoSpecifier Specifier = DILineInfoSpecifier()) = 0;
+
+  /// getCFARuleForAddress - find the rule for the canonical frame address at
+  /// Address: the CFA is the value of register Register plus Offset.  Returns
+  /// false if the frame information doesn't describe Address that way.
+  virtual bool getCFARuleForAddress(uint64_t Address, uint64_t &Register,
+                                    int64_t &Offset) = 0;
 private:
   const DIContextKind Kind;
 };
@@ -0,0 +1,60 @@
+//===-- DirectoryObjectCache.h - On-disk cache of MCJIT objects -*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares DirectoryObjectCache, an ObjectCache that keeps compiled
+// objects in a directory so that they survive across runs of the embedder.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_EXECUTIONENGINE_DIRECTORYOBJECTCACHE_H
+#define LLVM_EXECUTIONENGINE_DIRECTORYOBJECTCACHE_H
+
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ExecutionEngine/ObjectCache.h"
+#include <string>
+
+namespace llvm {
+
+/// DirectoryObjectCache - An ObjectCache that stores one file per compiled
+/// module in a cache directory.  Objects are keyed by an MD5 hash of the
+/// module's bitcode, its target triple and a configuration string supplied
+/// by the client, so a module whose IR is unchanged is found again even if
+/// its identifier is not.
+///
+/// The configuration string must describe everything else that affects the
+/// generated code and that the module does not record: the CPU, the feature
+/// string, the code model, the optimization level and the TargetOptions in
+/// use.  Objects compiled under a different configuration are never returned.
+///
+/// Files are written to a temporary name and renamed into place, so
+/// concurrent processes sharing a directory never see a partial object.
+/// When MaxSize is nonzero, the least recently used objects are deleted
+/// after each store until the directory holds at most MaxSize bytes.
+class DirectoryObjectCache : public ObjectCache {
+  std::string CacheDir;
+  std::string Configuration;
+  uint64_t MaxSize;
+
+  void getCachePath(const Module *M, SmallVectorImpl<char> &Path) const;
+  void pruneCache();
+
+public:
+  DirectoryObjectCache(StringRef CacheDir, StringRef Configuration,
+                       uint64_t MaxSize = 0);
+
+  virtual ~DirectoryObjectCache();
+
+  virtual void notifyObjectCompiled(const Module *M, const MemoryBuffer *Obj);
+
+  virtual MemoryBuffer *getObject(const Module *M);
+};
+
+}
+
+#endif
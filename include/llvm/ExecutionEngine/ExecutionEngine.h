@@ -274,6 +274,15 @@ public:
   /// interpeter.
   virtual void finalizeObject() {}
 
+  /// getStackMapSection - Return the contents of the stack map section of the
+  /// object code generated for M, or an empty string if M has not been
+  /// compiled or has no llvm.experimental.stackmap or patchpoint calls.  Read
+  /// it with object::StackMapParser.  The instruction offsets it records are
+  /// relative to the start of the function containing each call.  The string
+  /// stays valid until M is removed from the engine.  This method only
+  /// returns stack maps for MCJIT.
+  virtual StringRef getStackMapSection(Module *M) { return StringRef(); }
+
   /// runStaticConstructorsDestructors - This method is used to execute all of
   /// the static constructors or destructors for a program.
   ///
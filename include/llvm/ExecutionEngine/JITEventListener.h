@@ -90,6 +90,10 @@ public:
   /// a previously emitted object is released.
   virtual void NotifyFreeingObject(const ObjectImage &Obj) {}
 
+  // Construct a listener that writes the /tmp/perf-<pid>.map symbol file
+  // read by the Linux perf tool.
+  static JITEventListener *createPerfJITEventListener();
+
 #if LLVM_USE_INTEL_JITEVENTS
   // Construct an IntelJITEventListener
   static JITEventListener *createIntelJITEventListener();
@@ -35,12 +35,18 @@ namespace llvm {
 /// in the JITed object.  Permissions can be applied either by calling
 /// MCJIT::finalizeObject or by calling SectionMemoryManager::finalizeMemory
 /// directly.  Clients of MCJIT should call MCJIT::finalizeObject.
+///
+/// Memory is requested from the system in blocks of at least SlabSize bytes
+/// and sections are carved out of them.  Clients that load many small objects
+/// into one memory manager should pass a slab size of several pages so that
+/// each module does not cost its own mappings and protection changes.
 class SectionMemoryManager : public RTDyldMemoryManager {
   SectionMemoryManager(const SectionMemoryManager&) LLVM_DELETED_FUNCTION;
   void operator=(const SectionMemoryManager&) LLVM_DELETED_FUNCTION;
 
 public:
-  SectionMemoryManager() { }
+  explicit SectionMemoryManager(uintptr_t SlabSize = 0)
+    : SlabSize(SlabSize) { }
   virtual ~SectionMemoryManager();
 
   /// \brief Allocates a memory block of (at least) the given size suitable for
@@ -88,6 +94,9 @@ private:
   struct MemoryGroup {
       SmallVector<sys::MemoryBlock, 16> AllocatedMem;
       SmallVector<sys::MemoryBlock, 16> FreeMem;
+      /// PendingMem - The sections handed out since the last finalizeMemory,
+      /// whose final permissions have not been applied yet.
+      SmallVector<sys::MemoryBlock, 16> PendingMem;
       sys::MemoryBlock Near;
   };
 
@@ -97,6 +106,9 @@ private:
   error_code applyMemoryGroupPermissions(MemoryGroup &MemGroup,
                                          unsigned Permissions);
 
+  /// SlabSize - The minimum size of each block requested from the system.
+  uintptr_t SlabSize;
+
   MemoryGroup CodeMem;
   MemoryGroup RWDataMem;
   MemoryGroup RODataMem;
@@ -125,6 +125,16 @@ public:
   void emitError(const Instruction *I, const Twine &ErrorStr);
   void emitError(const Twine &ErrorStr);
 
+  /// removeDeadConstantExprs - Delete the constant expressions of this
+  /// context that have no uses left, along with the ones only they used, and
+  /// return how many were deleted.  Constant expressions live as long as
+  /// their context, so long-lived contexts such as a JIT's keep every
+  /// expression ever folded unless this is called once in a while.
+  /// Expressions tracked by a value handle, for example the operands of
+  /// metadata, are kept.  Clients must not keep plain pointers to unused
+  /// constant expressions across this call.
+  unsigned removeDeadConstantExprs();
+
 private:
   LLVMContext(LLVMContext&) LLVM_DELETED_FUNCTION;
   void operator=(LLVMContext&) LLVM_DELETED_FUNCTION;
@@ -70,19 +70,18 @@ class MDNodeOperand;
 
 //===----------------------------------------------------------------------===//
 /// MDNode - a tuple of other values.
-class MDNode : public Value, public FoldingSetNode {
+class MDNode : public Value {
   MDNode(const MDNode &) LLVM_DELETED_FUNCTION;
   void operator=(const MDNode &) LLVM_DELETED_FUNCTION;
   friend class MDNodeOperand;
   friend class LLVMContextImpl;
-  friend struct FoldingSetTrait<MDNode>;
+  friend struct MDNodeKeyInfo;
 
   /// Hash - If the MDNode is uniqued cache the hash to speed up lookup.
   unsigned Hash;
 
-  /// NumOperands - This many 'MDNodeOperand' items are co-allocated onto the
-  /// end of this MDNode.
-  unsigned NumOperands;
+  // Value::NumOperands 'MDNodeOperand' items are co-allocated onto the end of
+  // this MDNode.
 
   // Subclass data enums.
   enum {
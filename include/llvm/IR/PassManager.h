@@ -37,7 +37,10 @@
 
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/polymorphic_ptr.h"
+#include "llvm/Support/Timer.h"
 #include "llvm/Support/type_traits.h"
 #include "llvm/IR/Function.h"
 #include "llvm/IR/Module.h"
@@ -48,6 +51,7 @@ namespace llvm {
 
 class Module;
 class Function;
+class raw_ostream;
 
 /// \brief An abstract set of preserved analyses following a transformation pass
 /// run.
@@ -149,6 +153,82 @@ inline void swap(PreservedAnalyses &LHS, PreservedAnalyses &RHS) {
   LHS.swap(RHS);
 }
 
+/// \brief Records the execution of passes run by the pass managers.
+///
+/// A pass manager given an instrumentation object records one entry for each
+/// pass it runs over each unit of IR: the wall time spent in the pass, the
+/// change in the amount of memory allocated by the process, and how many of
+/// the analysis results the pass requested were already cached. An analysis
+/// manager given the same object attributes its queries to the innermost pass
+/// currently being run.
+///
+/// Time, memory and analysis counts are inclusive of any nested passes, so
+/// the entry for a \c ModuleToFunctionPassAdaptor covers every function pass
+/// it ran. Entries are recorded in the order the passes finish.
+class PassInstrumentation {
+public:
+  struct Record {
+    /// \brief The name of the pass, or "<unnamed pass>" if the pass type
+    /// provides no static \c name method.
+    std::string PassName;
+
+    /// \brief The name of the function or module identifier that was run on.
+    std::string IRName;
+
+    /// \brief How many other passes were being run when this one started.
+    unsigned Depth;
+
+    /// \brief Wall time spent in the pass, in seconds.
+    double WallTime;
+
+    /// \brief Net change in bytes allocated while the pass ran. This is
+    /// process wide, and may be zero if the host cannot report it.
+    ssize_t MemUsed;
+
+    /// \brief Analysis results which were found in the cache.
+    unsigned AnalysisHits;
+
+    /// \brief Analysis results which had to be computed.
+    unsigned AnalysisMisses;
+  };
+
+  /// \brief Note that a pass is about to be run.
+  void startPass();
+
+  /// \brief Note that the most recently started pass has finished.
+  void endPass(StringRef PassName, StringRef IRName);
+
+  /// \brief Note that an analysis result was requested from an analysis
+  /// manager, and whether an existing result was reused.
+  void recordAnalysisQuery(bool CacheHit) {
+    if (Active.empty())
+      return;
+    if (CacheHit)
+      ++Active.back().AnalysisHits;
+    else
+      ++Active.back().AnalysisMisses;
+  }
+
+  const std::vector<Record> &records() const { return Records; }
+
+  /// \brief Discard all recorded entries.
+  void clear() { Records.clear(); }
+
+  /// \brief Print the recorded entries as a JSON object holding a single
+  /// "passes" array.
+  void printJSON(raw_ostream &OS) const;
+
+private:
+  struct ActivePass {
+    TimeRecord Start;
+    unsigned AnalysisHits;
+    unsigned AnalysisMisses;
+  };
+
+  SmallVector<ActivePass, 4> Active;
+  std::vector<Record> Records;
+};
+
 /// \brief Implementation details of the pass manager interfaces.
 namespace detail {
 
@@ -165,6 +245,35 @@ template <typename IRUnitT, typename AnalysisManagerT> struct PassConcept {
   /// desired. Also that the analysis manager may be null if there is no
   /// analysis manager in the pass pipeline.
   virtual PreservedAnalyses run(IRUnitT IR, AnalysisManagerT *AM) = 0;
+
+  /// \brief The name of the pass, used when instrumenting a pass manager.
+  virtual StringRef name() = 0;
+};
+
+/// \brief SFINAE metafunction for computing whether \c PassT provides a static
+/// \c name method.
+template <typename PassT> class PassHasName {
+  typedef char SmallType;
+  struct BigType { char a, b; };
+
+  template <typename T, StringRef (*)()> struct Checker;
+
+  template <typename T> static SmallType f(Checker<T, &T::name> *);
+  template <typename T> static BigType f(...);
+
+public:
+  enum { Value = sizeof(f<PassT>(0)) == sizeof(SmallType) };
+};
+
+/// \brief Wrapper to get the name of a pass, falling back to a placeholder for
+/// passes which do not provide one.
+template <typename PassT, bool HasName = PassHasName<PassT>::Value>
+struct PassName {
+  static StringRef get() { return PassT::name(); }
+};
+
+template <typename PassT> struct PassName<PassT, false> {
+  static StringRef get() { return "<unnamed pass>"; }
 };
 
 /// \brief SFINAE metafunction for computing whether \c PassT has a run method
@@ -205,6 +314,7 @@ struct PassModel<IRUnitT, AnalysisManagerT, PassT,
   virtual PreservedAnalyses run(IRUnitT IR, AnalysisManagerT *AM) {
     return Pass.run(IR, AM);
   }
+  virtual StringRef name() { return PassName<PassT>::get(); }
   PassT Pass;
 };
 
@@ -218,6 +328,7 @@ struct PassModel<IRUnitT, AnalysisManagerT, PassT,
   virtual PreservedAnalyses run(IRUnitT IR, AnalysisManagerT *AM) {
     return Pass.run(IR);
   }
+  virtual StringRef name() { return PassName<PassT>::get(); }
   PassT Pass;
 };
 
@@ -387,7 +498,7 @@ class ModuleAnalysisManager;
 
 class ModulePassManager {
 public:
-  explicit ModulePassManager() {}
+  explicit ModulePassManager() : Instrumentation(0) {}
 
   /// \brief Run all of the module passes in this module pass manager over
   /// a module.
@@ -400,6 +511,12 @@ public:
     Passes.push_back(new ModulePassModel<ModulePassT>(llvm_move(Pass)));
   }
 
+  /// \brief Record the execution of each pass into \p PI, or stop recording
+  /// if it is null. The instrumentation object must outlive any run.
+  void setInstrumentation(PassInstrumentation *PI) { Instrumentation = PI; }
+
+  static StringRef name() { return "ModulePassManager"; }
+
 private:
   // Pull in the concept type and model template specialized for modules.
   typedef detail::PassConcept<Module *, ModuleAnalysisManager> ModulePassConcept;
@@ -411,13 +528,14 @@ private:
   };
 
   std::vector<polymorphic_ptr<ModulePassConcept> > Passes;
+  PassInstrumentation *Instrumentation;
 };
 
 class FunctionAnalysisManager;
 
 class FunctionPassManager {
 public:
-  explicit FunctionPassManager() {}
+  explicit FunctionPassManager() : Instrumentation(0) {}
 
   template <typename FunctionPassT> void addPass(FunctionPassT Pass) {
     Passes.push_back(new FunctionPassModel<FunctionPassT>(llvm_move(Pass)));
@@ -425,6 +543,12 @@ public:
 
   PreservedAnalyses run(Function *F, FunctionAnalysisManager *AM = 0);
 
+  /// \brief Record the execution of each pass into \p PI, or stop recording
+  /// if it is null. The instrumentation object must outlive any run.
+  void setInstrumentation(PassInstrumentation *PI) { Instrumentation = PI; }
+
+  static StringRef name() { return "FunctionPassManager"; }
+
 private:
   // Pull in the concept type and model template specialized for functions.
   typedef detail::PassConcept<Function *, FunctionAnalysisManager>
@@ -437,6 +561,7 @@ private:
   };
 
   std::vector<polymorphic_ptr<FunctionPassConcept> > Passes;
+  PassInstrumentation *Instrumentation;
 };
 
 namespace detail {
@@ -464,6 +589,8 @@ protected:
   // FIXME: Provide template aliases for the models when we're using C++11 in
   // a mode supporting them.
 
+  AnalysisManagerBase() : Instrumentation(0) {}
+
 public:
   /// \brief Get the result of an analysis pass for this module.
   ///
@@ -529,7 +656,14 @@ public:
     derived_this()->invalidateImpl(IR, PA);
   }
 
+  /// \brief Count each \c getResult query as a cache hit or miss against the
+  /// pass currently being run under \p PI, or stop counting if it is null.
+  void setInstrumentation(PassInstrumentation *PI) { Instrumentation = PI; }
+
 protected:
+  /// \brief The instrumentation to report analysis queries to, if any.
+  PassInstrumentation *Instrumentation;
+
   /// \brief Lookup a registered analysis pass.
   PassConceptT &lookupPass(void *PassID) {
     typename AnalysisPassMapT::iterator PI = AnalysisPasses.find(PassID);
@@ -769,12 +903,20 @@ private:
 /// \c FunctionAnalysisManagerModuleProxy analysis prior to running the function
 /// pass over the module to enable a \c FunctionAnalysisManager to be used
 /// within this run safely.
+///
+/// Functions are visited strictly in module order. Although function passes
+/// may not touch other functions' analyses, they do mutate state shared across
+/// the whole module: the use lists of globals and constants, and the uniquing
+/// tables of the \c LLVMContext. Running them concurrently would require those
+/// to be made thread safe first.
 template <typename FunctionPassT>
 class ModuleToFunctionPassAdaptor {
 public:
   explicit ModuleToFunctionPassAdaptor(FunctionPassT Pass)
       : Pass(llvm_move(Pass)) {}
 
+  static StringRef name() { return "ModuleToFunctionPassAdaptor"; }
+
   /// \brief Runs the function pass across every function in the module.
   PreservedAnalyses run(Module *M, ModuleAnalysisManager *AM) {
     FunctionAnalysisManager *FAM = 0;
@@ -36,6 +36,7 @@ class InlineAsm;
 class Instruction;
 class LLVMContext;
 class MDNode;
+class ModuleSlotTracker;
 class StringRef;
 class Twine;
 class Type;
@@ -79,6 +80,13 @@ private:
   /// This field is initialized to zero by the ctor.
   unsigned short SubclassData;
 
+protected:
+  /// NumOperands - The number of operands of a User or MDNode.  It is kept
+  /// here rather than in those classes so that on 64-bit hosts it fills the
+  /// padding in front of VTy instead of making every User a word larger.
+  unsigned NumOperands;
+
+private:
   Type *VTy;
   Use *UseList;
 
@@ -106,6 +114,12 @@ public:
   ///
   void print(raw_ostream &O, AssemblyAnnotationWriter *AAW = 0) const;
 
+  /// print - Print this value using the slot numbers cached in MST instead of
+  /// numbering its module again.  Use this when printing many values of one
+  /// module.
+  void print(raw_ostream &O, ModuleSlotTracker &MST,
+             AssemblyAnnotationWriter *AAW = 0) const;
+
   /// All values are typed, get the type of this value.
   ///
   Type *getType() const { return VTy; }
@@ -75,6 +75,18 @@ struct LTOCodeGenerator {
 
   void addMustPreserveSymbol(const char *sym) { MustPreserveSymbols[sym] = 1; }
 
+  // Record the linker's resolution of sym, which overrides
+  // addMustPreserveSymbol when the scope of sym is restricted.
+  void setSymbolResolution(const char *sym, lto_symbol_resolution Res) {
+    SymbolResolutions[sym] = Res;
+  }
+
+  // Keep the objects produced by compile_to_file() and compile_to_files() in
+  // Dir, keyed by a hash of the merged module and of every option that
+  // affects code generation, and reuse them when a later link has the same
+  // inputs.  An empty Dir disables the cache.
+  void setCacheDir(const char *Dir) { CacheDir = Dir; }
+
   // To pass options to the driver and optimization passes. These options are
   // not necessarily for debugging purpose (The function name is misleading).
   // This function should be called before LTOCodeGenerator::compilexxx(),
@@ -117,6 +129,22 @@ struct LTOCodeGenerator {
                       bool disableGVNLoadPRE,
                       std::string &errMsg);
 
+  // Optimize the merged module as compile_to_file() does, then split it into
+  // at most Partitions pieces and generate one object file for each, running
+  // the code generator for the pieces in parallel.  Functions are grouped by
+  // call-graph order and balanced by size; internal symbols referenced from
+  // another piece are renamed and given hidden visibility.  The paths of the
+  // object files are returned in Names, an array of Count strings that stays
+  // valid until the next compile call.  As with compile_to_file(), the linker
+  // must remove the files.  Return true on success.
+  bool compile_to_files(const char ***Names,
+                        unsigned *Count,
+                        unsigned Partitions,
+                        bool disableOpt,
+                        bool disableInline,
+                        bool disableGVNLoadPRE,
+                        std::string &errMsg);
+
 private:
   void initializeLTOPasses();
 
@@ -125,6 +153,9 @@ private:
                           bool disableInline,
                           bool disableGVNLoadPRE,
                           std::string &errMsg);
+  void optimizeMergedModule(bool disableOpt,
+                            bool disableInline,
+                            bool disableGVNLoadPRE);
   void applyScopeRestrictions();
   void applyRestriction(llvm::GlobalValue &GV,
                         const llvm::ArrayRef<llvm::StringRef> &Libcalls,
@@ -132,6 +163,8 @@ private:
                         llvm::SmallPtrSet<llvm::GlobalValue*, 8> &AsmUsed,
                         llvm::Mangler &Mangler);
   bool determineTarget(std::string &errMsg);
+  std::string getCacheKey(bool disableOpt, bool disableInline,
+                          bool disableGVNLoadPRE, unsigned Partitions);
 
   typedef llvm::StringMap<uint8_t> StringSet;
 
@@ -142,11 +175,15 @@ private:
   bool ScopeRestrictionsDone;
   lto_codegen_model CodeModel;
   StringSet MustPreserveSymbols;
+  llvm::StringMap<lto_symbol_resolution> SymbolResolutions;
   StringSet AsmUndefinedRefs;
   llvm::MemoryBuffer *NativeObjectFile;
   std::vector<char *> CodegenOptions;
   std::string MCpu;
+  std::string CacheDir;
   std::string NativeObjectPath;
+  std::vector<std::string> NativeObjectPaths;
+  std::vector<const char *> NativeObjectNames;
   llvm::TargetOptions Options;
 };
 
@@ -49,6 +49,8 @@ private:
   };
 
   llvm::OwningPtr<llvm::Module>           _module;
+  // The target triple of _module, kept once the module has been released.
+  std::string                             _triple;
   llvm::OwningPtr<llvm::TargetMachine>    _target;
   llvm::MCObjectFileInfo ObjFileInfo;
   std::vector<NameAndAttributes>          _symbols;
@@ -101,12 +103,25 @@ public:
 
   /// getTargetTriple - Return the Module's target triple.
   const char *getTargetTriple() {
-    return _module->getTargetTriple().c_str();
+    return _module ? _module->getTargetTriple().c_str() : _triple.c_str();
   }
 
   /// setTargetTriple - Set the Module's target triple.
   void setTargetTriple(const char *triple) {
-    _module->setTargetTriple(triple);
+    if (_module)
+      _module->setTargetTriple(triple);
+    else
+      _triple = triple;
+  }
+
+  /// releaseModule - Free the IR, and the bitcode it is lazily read from,
+  /// once it has been linked into a code generator.  The symbol table stays
+  /// available, but the module can be linked no more.
+  void releaseModule() {
+    if (!_module)
+      return;
+    _triple = _module->getTargetTriple();
+    _module.reset();
   }
 
   /// getSymbolCount - Get the number of symbols
@@ -129,7 +144,7 @@ public:
     return NULL;
   }
 
-  /// getLLVVMModule - Return the Module.
+  /// getLLVVMModule - Return the Module, or null once it has been released.
   llvm::Module *getLLVVMModule() { return _module.get(); }
 
   /// getAsmUndefinedRefs -
@@ -0,0 +1,63 @@
+//===-LTOObjectCache.h - Cache of LTO native objects ----------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares the LTOObjectCache class, which lets the LTO code
+// generators reuse the native objects of an earlier link when their inputs
+// have not changed.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LTO_OBJECT_CACHE_H
+#define LTO_OBJECT_CACHE_H
+
+#include "llvm/ADT/StringRef.h"
+#include <string>
+
+namespace llvm {
+  class MD5;
+  class TargetOptions;
+}
+
+//===----------------------------------------------------------------------===//
+/// LTOObjectCache - A directory of native objects named by the hash of
+/// everything that went into them.  The caller computes the key; the cache
+/// only stores and retrieves files.
+///
+/// Objects are written to a temporary name and renamed into place, so links
+/// sharing a directory never see a partial object.  Each hit refreshes the
+/// object's modification time, so the directory can be pruned by age.
+///
+struct LTOObjectCache {
+  explicit LTOObjectCache(llvm::StringRef CacheDir) : CacheDir(CacheDir) {}
+
+  /// addTargetOptions - Add the TargetOptions that affect code generation to
+  /// a key being computed.
+  static void addTargetOptions(llvm::MD5 &Hash,
+                               const llvm::TargetOptions &Options);
+
+  /// getKey - Add the version of LLVM to Hash, finish it and return it as a
+  /// key.
+  static std::string getKey(llvm::MD5 &Hash);
+
+  /// lookup - If an object is cached under Key, copy it to a new temporary
+  /// file, set ObjPath to its name and return true.  The caller owns the
+  /// copy, as it does the output of a compile.
+  bool lookup(llvm::StringRef Key, std::string &ObjPath) const;
+
+  /// store - Add a copy of the object file at ObjPath to the cache under Key.
+  /// Failures are ignored: they only cost a later link its cache hit.
+  void store(llvm::StringRef Key, llvm::StringRef ObjPath) const;
+
+private:
+  std::string getPath(llvm::StringRef Key) const;
+
+  std::string CacheDir;
+};
+
+#endif // LTO_OBJECT_CACHE_H
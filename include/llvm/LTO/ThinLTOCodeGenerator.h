@@ -0,0 +1,124 @@
+//===-ThinLTOCodeGenerator.h - Summary-based LTO --------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares the ThinLTOCodeGenerator class.
+//
+//   LTOCodeGenerator links every module into one before optimizing, so its
+// memory use grows with the whole program.  ThinLTOCodeGenerator instead
+// keeps each module's bitcode as it was given and reads it once to build a
+// small summary: the module's externally visible definitions, the symbols it
+// references, and for each function its size and callees.
+//
+//   A global analysis over the summaries then decides, for each module,
+// which small functions from other modules to import for inlining and which
+// of its own definitions no other module can see.  Finally every module is
+// loaded on its own, the imported functions are read lazily from the bitcode
+// of the modules defining them and linked in as available_externally, and
+// the module is optimized and compiled to its own object file.  The modules
+// are compiled in parallel.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef THIN_LTO_CODE_GENERATOR_H
+#define THIN_LTO_CODE_GENERATOR_H
+
+#include "llvm-c/lto.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringSet.h"
+#include "llvm/Target/TargetOptions.h"
+#include <string>
+#include <vector>
+
+//===----------------------------------------------------------------------===//
+/// ThinLTOCodeGenerator - Optimize and compile a set of bitcode modules one
+/// module at a time, importing functions across modules as directed by
+/// per-module summaries.
+///
+struct ThinLTOCodeGenerator {
+  /// FunctionSummary - What the global analysis needs to know about one
+  /// externally visible function definition.
+  struct FunctionSummary {
+    unsigned Module;
+    unsigned InstCount;
+    // The function can be copied into another module: it has a unique strong
+    // definition and refers to no local symbols.
+    bool Importable;
+    std::vector<std::string> Callees;
+    std::vector<std::string> Refs;
+  };
+
+  /// ModuleSummary - One input module and what it defines and references.
+  struct ModuleSummary {
+    std::string Identifier;
+    std::string Bitcode;
+    std::vector<std::string> Defined;
+    std::vector<std::string> Referenced;
+    std::vector<std::string> Callees;
+    bool HasInlineAsm;
+  };
+
+  ThinLTOCodeGenerator();
+  ~ThinLTOCodeGenerator();
+
+  // Summarize the bitcode in Mem and keep a copy of it for code generation.
+  // Return true on success.
+  bool addModule(const char *Identifier, const void *Mem, size_t Length,
+                 std::string &errMsg);
+
+  void setTargetOptions(llvm::TargetOptions options) { Options = options; }
+  void setCodePICModel(lto_codegen_model model) { CodeModel = model; }
+  void setCpu(const char *mCpu) { MCpu = mCpu; }
+
+  // Functions of at most Limit instructions are imported into their callers'
+  // modules; the limit shrinks for functions imported on their behalf.
+  void setImportInstrLimit(unsigned Limit) { ImportInstrLimit = Limit; }
+
+  void addMustPreserveSymbol(const char *sym) { MustPreserveSymbols[sym] = 1; }
+
+  // Keep each module's object in Dir, keyed by a hash of the module, of the
+  // modules it imports from and of the options that affect it, so that a
+  // relink only recompiles the modules whose inputs changed.  An empty Dir
+  // disables the cache.
+  void setCacheDir(const char *Dir) { CacheDir = Dir; }
+
+  // Optimize and compile every module to its own object file.  The paths of
+  // the object files, one per module in the order they were added, are
+  // returned in Names, an array of Count strings that stays valid until the
+  // next compile call.  The caller must remove the files.  Return true on
+  // success.
+  bool compile_to_files(const char ***Names, unsigned *Count,
+                        bool disableOpt, std::string &errMsg);
+
+  const std::vector<ModuleSummary> &getModuleSummaries() const {
+    return Modules;
+  }
+  const llvm::StringMap<FunctionSummary> &getFunctionSummaries() const {
+    return Functions;
+  }
+
+private:
+  void computeImports(unsigned ModuleIdx,
+                      llvm::StringMap<unsigned> &Imports,
+                      llvm::StringSet<> &ImportedRefs) const;
+
+  std::vector<ModuleSummary> Modules;
+  llvm::StringMap<FunctionSummary> Functions;
+  // Number of modules that define each externally visible symbol.
+  llvm::StringMap<unsigned> Definitions;
+  llvm::StringMap<char> MustPreserveSymbols;
+  llvm::TargetOptions Options;
+  lto_codegen_model CodeModel;
+  std::string MCpu;
+  std::string CacheDir;
+  unsigned ImportInstrLimit;
+  std::vector<std::string> NativeObjectPaths;
+  std::vector<const char *> NativeObjectNames;
+};
+
+#endif // THIN_LTO_CODE_GENERATOR_H
@@ -10,7 +10,9 @@
 #ifndef LLVM_LINKER_H
 #define LLVM_LINKER_H
 
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
 #include <string>
 
 namespace llvm {
@@ -52,6 +54,9 @@ class Linker {
   private:
     Module *Composite;
     SmallPtrSet<StructType*, 32> IdentifiedStructTypes;
+    // The structs in IdentifiedStructTypes that have a body, bucketed by a
+    // hash of the shape of the body.
+    DenseMap<unsigned, SmallVector<StructType*, 1> > StructTypesByShape;
 };
 
 } // End llvm namespace
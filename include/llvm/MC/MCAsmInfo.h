@@ -300,6 +300,10 @@ namespace llvm {
     /// symbol variant instead of @. For example, foo(plt) instead of foo@plt.
     bool UseParensForSymbolVariant; // Defaults to false;
 
+    /// CompressDebugSections - True if the object writer should compress
+    /// DWARF sections with zlib and emit them as .zdebug_* sections.
+    bool CompressDebugSections; // Defaults to false;
+
     //===--- Prologue State ----------------------------------------------===//
 
     std::vector<MCCFIInstruction> InitialFrameState;
@@ -520,6 +524,11 @@ namespace llvm {
       return UseParensForSymbolVariant;
     }
 
+    bool compressDebugSections() const { return CompressDebugSections; }
+    void setCompressDebugSections(bool Value) {
+      CompressDebugSections = Value;
+    }
+
     void addInitialFrameState(const MCCFIInstruction &Inst) {
       InitialFrameState.push_back(Inst);
     }
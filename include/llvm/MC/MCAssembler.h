@@ -190,6 +190,11 @@ public:
   virtual fixup_iterator fixup_end() = 0;
   virtual const_fixup_iterator fixup_end() const = 0;
 
+  /// Free the fixup storage. Used once the fixups have been applied and none
+  /// of them needed a relocation, which may point back at its fixup, so that
+  /// it isn't kept alive while the object file is written.
+  virtual void releaseFixups() = 0;
+
   static bool classof(const MCFragment *F) {
     MCFragment::FragmentType Kind = F->getKind();
     return Kind == MCFragment::FT_Relaxable || Kind == MCFragment::FT_Data;
@@ -241,6 +246,8 @@ public:
   fixup_iterator fixup_end() {return Fixups.end();}
   const_fixup_iterator fixup_end() const {return Fixups.end();}
 
+  virtual void releaseFixups() { SmallVector<MCFixup, 4>().swap(Fixups); }
+
   static bool classof(const MCFragment *F) {
     return F->getKind() == MCFragment::FT_Data;
   }
@@ -321,6 +328,8 @@ public:
   fixup_iterator fixup_end() {return Fixups.end();}
   const_fixup_iterator fixup_end() const {return Fixups.end();}
 
+  virtual void releaseFixups() { SmallVector<MCFixup, 1>().swap(Fixups); }
+
   static bool classof(const MCFragment *F) {
     return F->getKind() == MCFragment::FT_Relaxable;
   }
@@ -917,13 +926,24 @@ private:
   bool fragmentNeedsRelaxation(const MCRelaxableFragment *IF,
                                const MCAsmLayout &Layout) const;
 
+  /// The fragments of one section that may still change size during
+  /// relaxation, in layout order.
+  typedef SmallVector<MCFragment*, 16> RelaxWorklist;
+
+  /// \brief Return true if \p F may change size during relaxation.
+  bool isRelaxationCandidate(const MCFragment &F) const;
+
   /// \brief Perform one layout iteration and return true if any offsets
-  /// were adjusted.
-  bool layoutOnce(MCAsmLayout &Layout);
+  /// were adjusted. \p Worklists holds the relaxation candidates of each
+  /// section, indexed by section layout order.
+  bool layoutOnce(MCAsmLayout &Layout,
+                  std::vector<RelaxWorklist> &Worklists);
 
   /// \brief Perform one layout iteration of the given section and return true
-  /// if any offsets were adjusted.
-  bool layoutSectionOnce(MCAsmLayout &Layout, MCSectionData &SD);
+  /// if any offsets were adjusted. Only the fragments in \p Worklist are
+  /// revisited; fragments that can no longer grow are dropped from it.
+  bool layoutSectionOnce(MCAsmLayout &Layout, MCSectionData &SD,
+                         RelaxWorklist &Worklist);
 
   bool relaxInstruction(MCAsmLayout &Layout, MCRelaxableFragment &IF);
 
@@ -936,8 +956,15 @@ private:
   /// finishLayout - Finalize a layout, including fragment lowering.
   void finishLayout(MCAsmLayout &Layout);
 
+  /// handleFixup - Evaluate \p Fixup, recording a relocation for it if it
+  /// can't be resolved, and return the value to apply. \p Recorded is set
+  /// if a relocation was recorded.
   uint64_t handleFixup(const MCAsmLayout &Layout,
-                       MCFragment &F, const MCFixup &Fixup);
+                       MCFragment &F, const MCFixup &Fixup, bool &Recorded);
+
+  /// applySectionFixups - Evaluate and apply the fixups of every fragment in
+  /// \p SD, recording relocations for the unresolved ones.
+  void applySectionFixups(const MCAsmLayout &Layout, MCSectionData &SD);
 
 public:
   /// Compute the effective fragment size assuming it is laid out at the given
@@ -146,6 +146,11 @@ namespace llvm {
     /// Darwin).
     bool AllowTemporaryLabels;
 
+    /// Give the symbols made by CreateTempSymbol a name. Object writers that
+    /// never emit temporary labels by name don't need one, and skipping it
+    /// saves formatting and uniquing a string per label.
+    bool UseNamesForTempLabels;
+
     /// The dwarf line information from the .loc directives for the sections
     /// with assembled machine instructions have after seeing .loc directives.
     DenseMap<const MCSection *, MCLineSection *> MCLineSections;
@@ -179,6 +184,7 @@ namespace llvm {
     const MCObjectFileInfo *getObjectFileInfo() const { return MOFI; }
 
     void setAllowTemporaryLabels(bool Value) { AllowTemporaryLabels = Value; }
+    void setUseNamesForTempLabels(bool Value) { UseNamesForTempLabels = Value; }
 
     /// @name Module Lifetime Management
     /// @{
@@ -193,7 +199,8 @@ namespace llvm {
     /// @{
 
     /// CreateTempSymbol - Create and return a new assembler temporary symbol
-    /// with a unique but unspecified name.
+    /// with a unique but unspecified name, or no name at all if names for
+    /// temporary labels are turned off.
     MCSymbol *CreateTempSymbol();
 
     /// getUniqueSymbolID() - Return a unique identifier for use in constructing
@@ -254,6 +261,11 @@ namespace llvm {
                                       unsigned Flags, SectionKind Kind,
                                       unsigned EntrySize, StringRef Group);
 
+    /// renameELFSection - Give an existing section a new name, keeping it
+    /// uniqued under that name. Used by the object writer to emit
+    /// compressed debug sections.
+    void renameELFSection(const MCSectionELF *Section, StringRef Name);
+
     const MCSectionELF *CreateELFGroupSection();
 
     const MCSectionCOFF *getCOFFSection(StringRef Section,
@@ -15,6 +15,7 @@
 #ifndef LLVM_MC_MCMODULE_H
 #define LLVM_MC_MCMODULE_H
 
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Compiler.h"
 #include "llvm/Support/DataTypes.h"
@@ -75,6 +76,16 @@ class MCModule {
   /// @{
   typedef std::vector<MCFunction*> FunctionListTy;
   FunctionListTy Functions;
+
+  /// \brief Functions by the begin address of their entry block.
+  typedef DenseMap<uint64_t, MCFunction*> FunctionsByEntryTy;
+  FunctionsByEntryTy FunctionsByEntry;
+
+  // For access to function entry tracking.
+  friend class MCFunction;
+
+  /// \brief Record that the entry block of \p MCFN begins at \p EntryAddr.
+  void trackFunctionEntry(MCFunction *MCFN, uint64_t EntryAddr);
   /// @}
 
   /// The address of the entrypoint function.
@@ -114,6 +125,12 @@ public:
   /// \brief Create a new MCFunction.
   MCFunction *createFunction(StringRef Name);
 
+  /// \brief Get the function whose entry block begins at \p BeginAddr, or 0
+  /// if there is none.
+  MCFunction *findFunctionAt(uint64_t BeginAddr) const {
+    return FunctionsByEntry.lookup(BeginAddr);
+  }
+
   /// \name Access to the owned function list.
   /// @{
   typedef FunctionListTy::const_iterator const_func_iterator;
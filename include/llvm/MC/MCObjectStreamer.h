@@ -68,6 +68,10 @@ protected:
   /// fragment is not a data fragment.
   MCDataFragment *getOrCreateDataFragment() const;
 
+  /// Encode Inst at the end of DF and add its fixups to DF. The encoding is
+  /// written straight into the fragment contents, without a temporary buffer.
+  void EncodeInstToFragment(const MCInst &Inst, MCDataFragment *DF);
+
   const MCExpr *AddValueSymbols(const MCExpr *Value);
 
 public:
@@ -14,6 +14,7 @@
 #ifndef LLVM_OBJECT_ARCHIVE_H
 #define LLVM_OBJECT_ARCHIVE_H
 
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Object/Binary.h"
 #include "llvm/Support/ErrorHandling.h"
@@ -191,10 +192,20 @@ public:
   bool hasSymbolTable() const;
 
 private:
+  /// \brief Builds SymbolMap from the symbol table. Returns false if the
+  /// table is malformed.
+  bool buildSymbolMap() const;
+
   child_iterator SymbolTable;
   child_iterator StringTable;
   child_iterator FirstRegular;
   Kind Format;
+
+  /// \brief The member defining each symbol, or end_children() if the table
+  /// entry for that member is invalid. Built by the first call to findSym.
+  mutable StringMap<child_iterator> SymbolMap;
+  mutable bool SymbolMapBuilt;
+  mutable bool SymbolMapValid;
 };
 
 }
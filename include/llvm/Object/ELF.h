@@ -241,7 +241,6 @@ private:
   const Elf_Shdr *dot_symtab_sec;   // Symbol table section.
 
   const Elf_Shdr *SymbolTableSectionHeaderIndex;
-  DenseMap<const Elf_Sym *, ELF::Elf64_Word> ExtendedSymbolTable;
 
   const Elf_Shdr *dot_gnu_version_sec;   // .gnu.version
   const Elf_Shdr *dot_gnu_version_r_sec; // .gnu.version_r
@@ -293,6 +292,10 @@ private:
   void LoadVersionNeeds(const Elf_Shdr *ec) const;
   void LoadVersionMap() const;
 
+  /// \brief Get the section index of a symbol with st_shndx == SHN_XINDEX
+  /// from .symtab_shndx, or 0 if it has none.
+  ELF::Elf64_Word getExtendedSymbolTableIndex(const Elf_Sym *symb) const;
+
 public:
   template<typename T>
   const T        *getEntry(uint32_t Section, uint32_t Entry) const;
@@ -497,10 +500,30 @@ void ELFFile<ELFT>::LoadVersionMap() const {
     LoadVersionNeeds(dot_gnu_version_r_sec);
 }
 
+template <class ELFT>
+ELF::Elf64_Word
+ELFFile<ELFT>::getExtendedSymbolTableIndex(const Elf_Sym *symb) const {
+  if (!SymbolTableSectionHeaderIndex || !dot_symtab_sec)
+    return 0;
+  // .symtab_shndx has one entry for each entry of .symtab, so index it
+  // directly rather than building a map up front.
+  const char *SymTabStart = (const char *)base() + dot_symtab_sec->sh_offset;
+  const char *Sym = reinterpret_cast<const char *>(symb);
+  if (Sym < SymTabStart ||
+      Sym >= SymTabStart + dot_symtab_sec->sh_size)
+    return 0;
+  uint64_t Index = (Sym - SymTabStart) / dot_symtab_sec->sh_entsize;
+  if ((Index + 1) * sizeof(Elf_Word) > SymbolTableSectionHeaderIndex->sh_size)
+    return 0;
+  const Elf_Word *ShndxTable = reinterpret_cast<const Elf_Word *>(
+      base() + SymbolTableSectionHeaderIndex->sh_offset);
+  return ShndxTable[Index];
+}
+
 template <class ELFT>
 ELF::Elf64_Word ELFFile<ELFT>::getSymbolTableIndex(const Elf_Sym *symb) const {
   if (symb->st_shndx == ELF::SHN_XINDEX)
-    return ExtendedSymbolTable.lookup(symb);
+    return getExtendedSymbolTableIndex(symb);
   return symb->st_shndx;
 }
 
@@ -508,7 +531,7 @@ template <class ELFT>
 const typename ELFFile<ELFT>::Elf_Shdr *
 ELFFile<ELFT>::getSection(const Elf_Sym *symb) const {
   if (symb->st_shndx == ELF::SHN_XINDEX)
-    return getSection(ExtendedSymbolTable.lookup(symb));
+    return getSection(getExtendedSymbolTableIndex(symb));
   if (symb->st_shndx >= ELF::SHN_LORESERVE)
     return 0;
   return getSection(symb->st_shndx);
@@ -706,18 +729,6 @@ ELFFile<ELFT>::ELFFile(MemoryBuffer *Object, error_code &ec)
     VerifyStrTab(dot_shstrtab_sec);
   }
 
-  // Build symbol name side-mapping if there is one.
-  if (SymbolTableSectionHeaderIndex) {
-    const Elf_Word *ShndxTable = reinterpret_cast<const Elf_Word*>(base() +
-                                      SymbolTableSectionHeaderIndex->sh_offset);
-    for (Elf_Sym_Iter SI = begin_symbols(), SE = end_symbols(); SI != SE;
-         ++SI) {
-      if (*ShndxTable != ELF::SHN_UNDEF)
-        ExtendedSymbolTable[&*SI] = *ShndxTable;
-      ++ShndxTable;
-    }
-  }
-
   // Scan program headers.
   for (Elf_Phdr_Iter PhdrI = begin_program_headers(),
                      PhdrE = end_program_headers();
@@ -0,0 +1,105 @@
+//===- StackMapParser.h - Parse the stack map section -----------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares StackMapParser, which reads the stack map section that
+// code generation emits for llvm.experimental.stackmap and
+// llvm.experimental.patchpoint calls.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_OBJECT_STACKMAPPARSER_H
+#define LLVM_OBJECT_STACKMAPPARSER_H
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/DataTypes.h"
+#include "llvm/Support/system_error.h"
+#include <vector>
+
+namespace llvm {
+namespace object {
+
+class ObjectFile;
+
+/// StackMapParser - The contents of a stack map section, in the layout
+/// documented with StackMaps::serializeToStackMapSection.
+///
+/// The instruction offset of a record is relative to the start of the
+/// function containing the stack map or patch point.  The section does not
+/// say which function that is, so clients find it from the record ID, which
+/// they chose when emitting the intrinsic call.
+class StackMapParser {
+public:
+  /// Location - Where a value recorded by a stack map lives.
+  struct Location {
+    enum LocationKind {
+      Register = 1,     ///< In DwarfRegNum.
+      Direct = 2,       ///< The address DwarfRegNum + Offset.
+      Indirect = 3,     ///< In memory at DwarfRegNum + Offset.
+      Constant = 4,     ///< The constant Offset.
+      ConstantIndex = 5 ///< The constant getConstants()[Offset].
+    };
+    LocationKind Kind;
+    uint8_t Size;
+    uint16_t DwarfRegNum;
+    int32_t Offset;
+  };
+
+  /// LiveOut - A register live across a patch point.
+  struct LiveOut {
+    uint16_t DwarfRegNum;
+    uint8_t Size;
+  };
+
+  struct Record {
+    uint64_t ID;
+    uint32_t InstructionOffset;
+    uint16_t Flags;
+    SmallVector<Location, 8> Locations;
+    SmallVector<LiveOut, 4> LiveOuts;
+
+    /// isValid - Code generation emits records that overflow the format with
+    /// an invalid ID and no locations.
+    bool isValid() const { return ID != UINT64_MAX; }
+  };
+
+private:
+  std::vector<int64_t> Constants;
+  std::vector<Record> Records;
+
+public:
+  /// parse - Read the stack map section contents in Data, replacing anything
+  /// read before.  Returns object_error::parse_failed if Data is truncated or
+  /// malformed, in which case nothing is kept.
+  error_code parse(StringRef Data, bool IsLittleEndian);
+
+  /// findStackMapSection - Set Data to the contents of the stack map section
+  /// of Obj, or to an empty string if it has none.
+  static error_code findStackMapSection(const ObjectFile &Obj, StringRef &Data);
+
+  ArrayRef<int64_t> getConstants() const { return Constants; }
+  ArrayRef<Record> getRecords() const { return Records; }
+
+  /// findRecord - Return the first record with the specified ID, or null.
+  const Record *findRecord(uint64_t ID) const;
+
+  /// getConstantValue - Return the value of a Constant or ConstantIndex
+  /// location.
+  int64_t getConstantValue(const Location &Loc) const {
+    if (Loc.Kind == Location::ConstantIndex)
+      return Constants[Loc.Offset];
+    return Loc.Offset;
+  }
+};
+
+} // end namespace object
+} // end namespace llvm
+
+#endif
@@ -14,7 +14,7 @@
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Option/OptSpecifier.h"
 #include "llvm/Option/Option.h"
-#include <list>
+#include "llvm/Support/Allocator.h"
 #include <string>
 #include <vector>
 
@@ -293,12 +293,12 @@ private:
   /// convenient place to store the memory) via MakeIndex.
   mutable ArgStringList ArgStrings;
 
-  /// Strings for synthesized arguments.
+  /// Storage for the strings of synthesized arguments.
   ///
   /// This is mutable since we treat the ArgList as being the list
   /// of Args, and allow routines to add new strings (to have a
   /// convenient place to store the memory) via MakeIndex.
-  mutable std::list<std::string> SynthesizedStrings;
+  mutable BumpPtrAllocator SynthesizedStrings;
 
   /// The number of original input argument strings.
   unsigned NumInputArgStrings;
@@ -12,6 +12,7 @@
 
 #include "llvm/ADT/StringSet.h"
 #include "llvm/Option/OptSpecifier.h"
+#include <vector>
 
 namespace llvm {
 class raw_ostream;
@@ -65,6 +66,20 @@ private:
   StringSet<> PrefixesUnion;
   std::string PrefixChars;
 
+  /// \brief A node of the trie over the lowercased names of the searchable
+  /// options.
+  struct NameTrieNode {
+    char Char;
+    /// The first child and the next sibling of this node, or 0 for none.
+    unsigned FirstChild, NextSibling;
+    /// The range of OptionInfos whose name ends at this node.
+    unsigned OptBegin, OptEnd;
+  };
+
+  /// NameTrie - Used to find the options whose name is a prefix of an
+  /// argument without scanning the table. Node 0 is the root.
+  std::vector<NameTrieNode> NameTrie;
+
 private:
   const Info &getInfo(OptSpecifier Opt) const {
     unsigned id = Opt.getID();
@@ -181,6 +181,9 @@ public:
   
   /// Compute the total physical memory allocated by this allocator.
   size_t getTotalMemory() const;
+
+  /// Return the number of bytes requested since the last Reset.
+  size_t getBytesAllocated() const { return BytesAllocated; }
 };
 
 /// SpecificBumpPtrAllocator - Same as BumpPtrAllocator but allows only
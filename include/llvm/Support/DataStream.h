@@ -17,6 +17,7 @@
 #ifndef LLVM_SUPPORT_DATASTREAM_H
 #define LLVM_SUPPORT_DATASTREAM_H
 
+#include <cstddef>
 #include <string>
 
 namespace llvm {
@@ -33,6 +34,15 @@ public:
 DataStreamer *getDataFileStreamer(const std::string &Filename,
                                   std::string *Err);
 
+/// getReadAheadDataStreamer - Return a streamer that takes ownership of Source
+/// and reads from it on a background thread, up to BufferSize bytes ahead of
+/// its own reader, so that slow sources such as pipes and network connections
+/// are read while the bytes already received are being parsed.  GetBytes on
+/// the result only returns fewer bytes than requested at the end of Source.
+/// Without thread support, Source is returned unchanged.
+DataStreamer *getReadAheadDataStreamer(DataStreamer *Source,
+                                       size_t BufferSize = 1 << 20);
+
 }
 
 #endif  // LLVM_SUPPORT_DATASTREAM_H_
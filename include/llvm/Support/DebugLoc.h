@@ -69,6 +69,11 @@ namespace llvm {
     /// isUnknown - Return true if this is an unknown location.
     bool isUnknown() const { return ScopeIdx == 0; }
 
+    /// getScopeIdx - Return the ID# of the Scope/InlinedAt pair, which stays
+    /// small and dense within a context.  It is positive if there is no
+    /// InlinedAt, negative if there is one, and 0 for an unknown location.
+    int getScopeIdx() const { return ScopeIdx; }
+
     unsigned getLine() const {
       return (LineCol << 8) >> 8;  // Mask out column.
     }
@@ -71,6 +71,10 @@ public:
   /// initially requested.
   error_code commit(int64_t NewSmallerSize = -1);
 
+  /// Grows the file and the buffer to \p NewSize bytes, keeping their
+  /// contents.  The buffer may move, so pointers into it are invalidated.
+  error_code extend(size_t NewSize);
+
   /// If this object was previously committed, the destructor just deletes
   /// this object.  If this object was not committed, the destructor
   /// deallocates the buffer and the target file is never written.
@@ -23,6 +23,7 @@
 #ifndef LLVM_SUPPORT_FORMAT_H
 #define LLVM_SUPPORT_FORMAT_H
 
+#include "llvm/Support/DataTypes.h"
 #include <cassert>
 #include <cstdio>
 #ifdef _MSC_VER
@@ -231,6 +232,48 @@ inline format_object5<T1, T2, T3, T4, T5> format(const char *Fmt,const T1 &Val1,
   return format_object5<T1, T2, T3, T4, T5>(Fmt, Val1, Val2, Val3, Val4, Val5);
 }
 
+/// FormattedNumber - An integer to be printed at a fixed width, as made by
+/// format_hex, format_hex_no_prefix and format_decimal.  Unlike format(),
+/// printing one does not go through snprintf.
+class FormattedNumber {
+  uint64_t HexValue;
+  int64_t DecValue;
+  unsigned Width;
+  bool Hex;
+  bool Upper;
+  bool HexPrefix;
+  friend class raw_ostream;
+
+public:
+  FormattedNumber(uint64_t HV, int64_t DV, unsigned W, bool H, bool U,
+                  bool Prefix)
+    : HexValue(HV), DecValue(DV), Width(W), Hex(H), Upper(U),
+      HexPrefix(Prefix) {}
+};
+
+/// format_hex - Output \p N in hexadecimal with a "0x" prefix, padded with
+/// zeros to \p Width characters including the prefix, so that
+/// format_hex(255, 6) is "0x00ff", like format("0x%04x", 255).
+inline FormattedNumber format_hex(uint64_t N, unsigned Width,
+                                  bool Upper = false) {
+  return FormattedNumber(N, 0, Width, true, Upper, true);
+}
+
+/// format_hex_no_prefix - Output \p N in hexadecimal padded with zeros to
+/// \p Width digits, so that format_hex_no_prefix(255, 4) is "00ff", like
+/// format("%04x", 255).
+inline FormattedNumber format_hex_no_prefix(uint64_t N, unsigned Width,
+                                            bool Upper = false) {
+  return FormattedNumber(N, 0, Width, true, Upper, false);
+}
+
+/// format_decimal - Output \p N in decimal, right-justified with spaces to
+/// \p Width characters, so that format_decimal(-42, 5) is "  -42", like
+/// format("%5" PRId64, -42).
+inline FormattedNumber format_decimal(int64_t N, unsigned Width) {
+  return FormattedNumber(0, N, Width, false, false, false);
+}
+
 } // end namespace llvm
 
 #endif
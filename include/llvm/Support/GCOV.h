@@ -15,10 +15,12 @@
 #ifndef LLVM_SUPPORT_GCOV_H
 #define LLVM_SUPPORT_GCOV_H
 
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/MapVector.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringMap.h"
+#include "llvm/Support/GCOVFormat.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/raw_ostream.h"
 
@@ -28,13 +30,6 @@ class GCOVFunction;
 class GCOVBlock;
 class FileInfo;
 
-namespace GCOV {
-  enum GCOVVersion {
-    V402,
-    V404
-  };
-} // end GCOV namespace
-
 /// GCOVOptions - A struct for passing gcov options between functions.
 struct GCOVOptions {
   GCOVOptions(bool A, bool B, bool C, bool F, bool U) :
@@ -52,13 +47,15 @@ struct GCOVOptions {
 /// read operations.
 class GCOVBuffer {
 public:
-  GCOVBuffer(MemoryBuffer *B) : Buffer(B), Cursor(0) {}
+  /// Errors in the buffer are reported to ErrOS.
+  GCOVBuffer(MemoryBuffer *B, raw_ostream &ErrOS = errs())
+    : Buffer(B), Cursor(0), ErrOS(ErrOS) {}
   
   /// readGCNOFormat - Check GCNO signature is valid at the beginning of buffer.
   bool readGCNOFormat() {
     StringRef File = Buffer->getBuffer().slice(0, 4);
     if (File != "oncg") {
-      errs() << "Unexpected file type: " << File << ".\n";
+      ErrOS << "Unexpected file type: " << File << ".\n";
       return false;
     }
     Cursor = 4;
@@ -69,7 +66,7 @@ public:
   bool readGCDAFormat() {
     StringRef File = Buffer->getBuffer().slice(0, 4);
     if (File != "adcg") {
-      errs() << "Unexpected file type: " << File << ".\n";
+      ErrOS << "Unexpected file type: " << File << ".\n";
       return false;
     }
     Cursor = 4;
@@ -89,7 +86,7 @@ public:
       Version = GCOV::V404;
       return true;
     }
-    errs() << "Unexpected version: " << VersionStr << ".\n";
+    ErrOS << "Unexpected version: " << VersionStr << ".\n";
     return false;
   }
 
@@ -186,7 +183,7 @@ public:
 
   bool readInt(uint32_t &Val) {
     if (Buffer->getBuffer().size() < Cursor+4) {
-      errs() << "Unexpected end of memory buffer: " << Cursor+4 << ".\n";
+      ErrOS << "Unexpected end of memory buffer: " << Cursor+4 << ".\n";
       return false;
     }
     StringRef Str = Buffer->getBuffer().slice(Cursor, Cursor+4);
@@ -207,7 +204,7 @@ public:
     if (!readInt(Len)) return false;
     Len *= 4;
     if (Buffer->getBuffer().size() < Cursor+Len) {
-      errs() << "Unexpected end of memory buffer: " << Cursor+Len << ".\n";
+      ErrOS << "Unexpected end of memory buffer: " << Cursor+Len << ".\n";
       return false;
     }
     Str = Buffer->getBuffer().slice(Cursor, Cursor+Len).split('\0').first;
@@ -217,9 +214,55 @@ public:
 
   uint64_t getCursor() const { return Cursor; }
   void advanceCursor(uint32_t n) { Cursor += n*4; }
+  raw_ostream &getErrorStream() const { return ErrOS; }
 private:
   MemoryBuffer *Buffer;
   uint64_t Cursor;
+  raw_ostream &ErrOS;
+};
+
+/// GCDAProfile - The counters of one or more .gcda files of the same
+/// compilation unit, summed function by function.  This is used to merge the
+/// data of many runs without needing their .gcno file.
+class GCDAProfile {
+public:
+  GCDAProfile() : Initialized(false), Version(GCOV::V402), Checksum(0),
+                  ProgramCount(0) {}
+
+  /// read - Add the counters of a .gcda file.  Return false if the file is
+  /// malformed or doesn't match the data already added.  Errors are reported
+  /// to the error stream of Buffer.
+  bool read(GCOVBuffer &Buffer);
+
+  /// merge - Add the counters of another profile.  Return false if it
+  /// doesn't match the data already added, which is reported to ErrOS.
+  bool merge(const GCDAProfile &Other, raw_ostream &ErrOS = errs());
+
+  /// write - Output the summed counters as a .gcda file.
+  void write(raw_ostream &OS) const;
+
+  bool empty() const { return !Initialized; }
+private:
+  struct FunctionData {
+    /// Header - The words of the function record, which identify it.
+    std::string Header;
+    SmallVector<uint64_t, 16> Counters;
+  };
+
+  bool setFile(GCOV::GCOVVersion V, uint32_t C, raw_ostream &ErrOS);
+  bool addFunction(StringRef Header, ArrayRef<uint64_t> Counters,
+                   raw_ostream &ErrOS);
+  void addSummary(ArrayRef<uint32_t> Summary);
+
+  bool Initialized;
+  GCOV::GCOVVersion Version;
+  uint32_t Checksum;
+  uint32_t ProgramCount;
+  SmallVector<FunctionData, 16> Functions;
+  StringMap<unsigned> FunctionIndex;
+  /// ObjectSummary - The object summary records of the files added,
+  /// combined by addSummary.
+  SmallVector<uint32_t, 9> ObjectSummary;
 };
 
 /// GCOVFile - Collects coverage information for one pair of coverage file
@@ -245,11 +288,13 @@ private:
 
 /// GCOVEdge - Collects edge information.
 struct GCOVEdge {
-  GCOVEdge(GCOVBlock *S, GCOVBlock *D): Src(S), Dst(D), Count(0) {}
+  GCOVEdge(GCOVBlock *S, GCOVBlock *D): Src(S), Dst(D), Count(0),
+    OnTree(false) {}
 
   GCOVBlock *Src;
   GCOVBlock *Dst;
   uint64_t Count;
+  bool OnTree;
 };
 
 /// GCOVFunction - Collects function information.
@@ -273,6 +318,8 @@ public:
   void dump() const;
   void collectLineCounts(FileInfo &FI);
 private:
+  void countTreeEdges();
+
   GCOVFile &Parent;
   uint32_t Ident;
   uint32_t Checksum;
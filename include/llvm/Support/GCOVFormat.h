@@ -0,0 +1,34 @@
+//===- GCOVFormat.h - Constants of the gcov file format ---------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This header defines the constants shared by the writer of 'gcov' format
+// files in the GCOV profiler and their reader in GCOV.h.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_SUPPORT_GCOVFORMAT_H
+#define LLVM_SUPPORT_GCOVFORMAT_H
+
+namespace llvm {
+
+namespace GCOV {
+  enum GCOVVersion {
+    V402,
+    V404
+  };
+
+  /// Flags of the arcs in a .gcno file.
+  enum ArcFlags {
+    ArcOnTree = 1       ///< The arc has no counter; its count is derived.
+  };
+} // end GCOV namespace
+
+} // end llvm namespace
+
+#endif
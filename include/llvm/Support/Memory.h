@@ -108,6 +108,19 @@ namespace sys {
     static error_code protectMappedMemory(const MemoryBlock &Block,
                                           unsigned Flags);
 
+    /// This method overwrites \p Size bytes of mapped executable code at
+    /// \p Addr with \p Code, for instance to rewrite the shadow of a patch
+    /// point.  The pages involved stay executable while they are made
+    /// writable, so that other code on them can keep running, and are left
+    /// readable and executable.  No thread may be executing the bytes being
+    /// replaced.
+    ///
+    /// \r error_success if the function was successful, or an error_code
+    /// describing the failure if an error occurred.
+    ///
+    /// @brief Rewrite executable code.
+    static error_code patchCode(void *Addr, const void *Code, size_t Size);
+
     /// This method allocates a block of Read/Write/Execute memory that is
     /// suitable for executing dynamically generated code (e.g. JIT). An
     /// attempt to allocate \p NumBytes bytes of virtual memory is made.
@@ -0,0 +1,156 @@
+//===-- llvm/Support/Parallel.h - Parallel algorithms -----------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines parallel_for_each and parallel_sort, which split their
+// work into tasks run on the global ThreadPool.  Both fall back to the
+// sequential algorithm when the pool has a single thread or the range is too
+// small to be worth splitting.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_SUPPORT_PARALLEL_H
+#define LLVM_SUPPORT_PARALLEL_H
+
+#include "llvm/Support/ThreadPool.h"
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <vector>
+
+namespace llvm {
+
+namespace parallel_detail {
+
+/// Number of tasks made for each pool thread, so that threads finishing early
+/// can steal the work of slower ones.
+const unsigned TasksPerThread = 4;
+
+/// Ranges shorter than this are sorted without splitting them.
+const size_t MinParallelSortSize = 1024;
+
+template <typename IterTy, typename FuncTy>
+struct ForEachTask {
+  IterTy Begin, End;
+  FuncTy *Fn;
+
+  static void run(void *Arg) {
+    ForEachTask *T = static_cast<ForEachTask*>(Arg);
+    for (IterTy I = T->Begin; I != T->End; ++I)
+      (*T->Fn)(*I);
+  }
+};
+
+template <typename IterTy, typename CompareTy>
+struct SortTask {
+  IterTy Begin, Middle, End;
+  CompareTy *Comp;
+
+  static void sort(void *Arg) {
+    SortTask *T = static_cast<SortTask*>(Arg);
+    std::sort(T->Begin, T->End, *T->Comp);
+  }
+
+  static void merge(void *Arg) {
+    SortTask *T = static_cast<SortTask*>(Arg);
+    std::inplace_merge(T->Begin, T->Middle, T->End, *T->Comp);
+  }
+};
+
+} // end namespace parallel_detail
+
+/// parallel_for_each - Call \p Fn on every element of [Begin, End).  The
+/// calls are made concurrently, from several threads, in no particular order.
+template <typename IterTy, typename FuncTy>
+void parallel_for_each(IterTy Begin, IterTy End, FuncTy Fn) {
+  typedef parallel_detail::ForEachTask<IterTy, FuncTy> TaskTy;
+
+  ThreadPool &Pool = ThreadPool::getGlobal();
+  size_t Size = std::distance(Begin, End);
+  size_t NumTasks = std::min<size_t>(
+      Size, Pool.getThreadCount() * parallel_detail::TasksPerThread);
+  if (NumTasks <= 1) {
+    std::for_each(Begin, End, Fn);
+    return;
+  }
+
+  // Use contiguous chunks of the range so that each task walks its own.
+  std::vector<TaskTy> Tasks(NumTasks);
+  TaskGroup Group(Pool);
+  IterTy I = Begin;
+  for (size_t i = 0; i != NumTasks; ++i) {
+    Tasks[i].Begin = I;
+    std::advance(I, Size / NumTasks + (i < Size % NumTasks));
+    Tasks[i].End = I;
+    Tasks[i].Fn = &Fn;
+    Group.async(TaskTy::run, &Tasks[i]);
+  }
+  Group.wait();
+}
+
+/// parallel_sort - Sort [Begin, End) by \p Comp, like std::sort.  Chunks of
+/// the range are sorted concurrently and then merged pairwise, the merges of
+/// each round also running concurrently.
+template <typename RandomAccessIterTy, typename CompareTy>
+void parallel_sort(RandomAccessIterTy Begin, RandomAccessIterTy End,
+                   CompareTy Comp) {
+  typedef parallel_detail::SortTask<RandomAccessIterTy, CompareTy> TaskTy;
+
+  ThreadPool &Pool = ThreadPool::getGlobal();
+  size_t Size = End - Begin;
+  size_t NumChunks = std::min<size_t>(
+      Size / parallel_detail::MinParallelSortSize, Pool.getThreadCount());
+  if (NumChunks <= 1) {
+    std::sort(Begin, End, Comp);
+    return;
+  }
+
+  // Bounds[i] is where chunk i starts; Bounds[NumChunks] is End.
+  std::vector<RandomAccessIterTy> Bounds;
+  for (size_t i = 0; i != NumChunks; ++i)
+    Bounds.push_back(Begin + Size * i / NumChunks);
+  Bounds.push_back(End);
+
+  std::vector<TaskTy> Tasks(NumChunks);
+  {
+    TaskGroup Group(Pool);
+    for (size_t i = 0; i != NumChunks; ++i) {
+      Tasks[i].Begin = Bounds[i];
+      Tasks[i].End = Bounds[i + 1];
+      Tasks[i].Comp = &Comp;
+      Group.async(TaskTy::sort, &Tasks[i]);
+    }
+    Group.wait();
+  }
+
+  // Each round merges neighbouring runs of Width chunks.
+  for (size_t Width = 1; Width < NumChunks; Width *= 2) {
+    TaskGroup Group(Pool);
+    size_t NumMerges = 0;
+    for (size_t i = 0; i + Width < NumChunks; i += 2 * Width) {
+      TaskTy &T = Tasks[NumMerges++];
+      T.Begin = Bounds[i];
+      T.Middle = Bounds[i + Width];
+      T.End = Bounds[std::min(i + 2 * Width, NumChunks)];
+      T.Comp = &Comp;
+      Group.async(TaskTy::merge, &T);
+    }
+    Group.wait();
+  }
+}
+
+template <typename RandomAccessIterTy>
+void parallel_sort(RandomAccessIterTy Begin, RandomAccessIterTy End) {
+  typedef typename std::iterator_traits<RandomAccessIterTy>::value_type
+    ValueTy;
+  parallel_sort(Begin, End, std::less<ValueTy>());
+}
+
+} // end namespace llvm
+
+#endif
@@ -150,6 +150,12 @@ public:
   /// allocated space.
   static size_t GetMallocUsage();
 
+  /// This static function will set \p Current to the number of bytes of the
+  /// process that are resident in memory, and \p Peak to the largest number
+  /// that have been.  Either is set to zero where the operating system cannot
+  /// report it.
+  static void GetResidentSetSize(size_t &Current, size_t &Peak);
+
   /// This static function will set \p user_time to the amount of CPU time
   /// spent in user (non-kernel) mode and \p sys_time to the amount of CPU
   /// time spent in system (kernel) mode.  If the operating system does not
@@ -0,0 +1,111 @@
+//===- ThreadLocalAllocator.h - Allocators shared by threads ----*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the RecyclingSlabAllocator and
+// ThreadLocalBumpPtrAllocator interfaces.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_SUPPORT_THREADLOCALALLOCATOR_H
+#define LLVM_SUPPORT_THREADLOCALALLOCATOR_H
+
+#include "llvm/Support/Allocator.h"
+#include "llvm/Support/Mutex.h"
+#include "llvm/Support/ThreadLocal.h"
+#include <vector>
+
+namespace llvm {
+
+/// RecyclingSlabAllocator - A slab allocator that keeps the slabs given back
+/// to it and hands them out again, so that short-lived bump allocators, such
+/// as one per function, do not malloc and free their slabs each time.  It
+/// may be shared by bump allocators on different threads.
+class RecyclingSlabAllocator : public SlabAllocator {
+  RecyclingSlabAllocator(const RecyclingSlabAllocator &) LLVM_DELETED_FUNCTION;
+  void operator=(const RecyclingSlabAllocator &) LLVM_DELETED_FUNCTION;
+
+  MallocSlabAllocator Allocator;
+  sys::Mutex Lock;
+
+  /// FreeSlabs - The slabs waiting to be reused, linked through NextPtr.
+  MemSlab *FreeSlabs;
+  unsigned NumFreeSlabs;
+
+  /// MaxFreeSlabs - Slabs given back while this many are waiting are freed.
+  unsigned MaxFreeSlabs;
+
+public:
+  explicit RecyclingSlabAllocator(unsigned MaxFreeSlabs = 64);
+  virtual ~RecyclingSlabAllocator();
+  virtual MemSlab *Allocate(size_t Size) LLVM_OVERRIDE;
+  virtual void Deallocate(MemSlab *Slab) LLVM_OVERRIDE;
+
+  /// releaseMemory - Free the slabs waiting to be reused.
+  void releaseMemory();
+
+  unsigned getNumFreeSlabs() const { return NumFreeSlabs; }
+};
+
+/// ThreadLocalBumpPtrAllocator - A BumpPtrAllocator for each thread that
+/// allocates from this object, so that threads compiling in parallel can
+/// share an allocator without locking it.  The arenas take their slabs from
+/// a shared RecyclingSlabAllocator, so slabs freed by Reset are reused by
+/// whichever thread needs them next.  Reset and the destructor free the
+/// memory of every thread and must not run while any thread is allocating.
+class ThreadLocalBumpPtrAllocator {
+  ThreadLocalBumpPtrAllocator(const ThreadLocalBumpPtrAllocator &)
+    LLVM_DELETED_FUNCTION;
+  void operator=(const ThreadLocalBumpPtrAllocator &) LLVM_DELETED_FUNCTION;
+
+  size_t SlabSize;
+  size_t SizeThreshold;
+  RecyclingSlabAllocator Slabs;
+
+  /// Arenas - The allocator of every thread that allocated, under Lock.
+  sys::Mutex Lock;
+  std::vector<BumpPtrAllocator*> Arenas;
+
+  /// Current - The allocator of the calling thread, if it has one.
+  sys::ThreadLocal<const BumpPtrAllocator> Current;
+
+  BumpPtrAllocator &getArena();
+
+public:
+  ThreadLocalBumpPtrAllocator(size_t size = 4096, size_t threshold = 4096);
+  ~ThreadLocalBumpPtrAllocator();
+
+  /// Reset - Free the memory allocated by every thread.
+  void Reset();
+
+  void *Allocate(size_t Size, size_t Alignment) {
+    return getArena().Allocate(Size, Alignment);
+  }
+
+  template <typename T>
+  T *Allocate() {
+    return static_cast<T*>(Allocate(sizeof(T), AlignOf<T>::Alignment));
+  }
+
+  template <typename T>
+  T *Allocate(size_t Num) {
+    return static_cast<T*>(Allocate(Num * sizeof(T), AlignOf<T>::Alignment));
+  }
+
+  void Deallocate(const void * /*Ptr*/) {}
+
+  /// These sum over the allocators of all threads.
+  unsigned GetNumSlabs() const;
+  size_t getTotalMemory() const;
+  size_t getBytesAllocated() const;
+  void PrintStats() const;
+};
+
+} // end namespace llvm
+
+#endif // LLVM_SUPPORT_THREADLOCALALLOCATOR_H
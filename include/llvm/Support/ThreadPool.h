@@ -0,0 +1,105 @@
+//===-- llvm/Support/ThreadPool.h - A pool of worker threads ----*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the ThreadPool and TaskGroup classes.
+//
+// A ThreadPool owns a fixed set of worker threads, each with its own queue of
+// tasks.  A worker runs the most recently queued task of its own queue first
+// and, when its queue is empty, steals the oldest task of another worker's
+// queue.  A thread waiting for tasks to finish runs queued tasks itself in the
+// meantime, so tasks running on the pool may start and wait for more tasks
+// without deadlocking it.
+//
+// In builds without thread support, or with a pool of one thread, tasks are
+// run by the thread that starts them.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_SUPPORT_THREADPOOL_H
+#define LLVM_SUPPORT_THREADPOOL_H
+
+#include "llvm/Support/Atomic.h"
+#include "llvm/Support/Compiler.h"
+
+namespace llvm {
+
+class ThreadPool;
+class ThreadPoolImpl;
+
+/// TaskGroup - A set of tasks of one ThreadPool that can be waited for
+/// together.  The group waits for its tasks when it is destroyed.
+class TaskGroup {
+  TaskGroup(const TaskGroup &) LLVM_DELETED_FUNCTION;
+  void operator=(const TaskGroup &) LLVM_DELETED_FUNCTION;
+
+  ThreadPool &Pool;
+  volatile sys::cas_flag Pending;
+
+  friend class ThreadPoolImpl;
+
+public:
+  /// Create a group of tasks run on the global pool.
+  TaskGroup();
+  explicit TaskGroup(ThreadPool &Pool);
+  ~TaskGroup();
+
+  /// async - Queue a call of \p Fn with \p Arg as part of this group.
+  void async(void (*Fn)(void *), void *Arg);
+
+  /// wait - Return once every task of this group has finished, running
+  /// queued tasks on the calling thread until then.
+  void wait();
+};
+
+/// ThreadPool - A fixed set of threads running queued tasks.
+///
+/// Tasks that use LLVM APIs sharing state still need llvm_start_multithreaded
+/// to have been called, as for any other thread.
+class ThreadPool {
+  ThreadPool(const ThreadPool &) LLVM_DELETED_FUNCTION;
+  void operator=(const ThreadPool &) LLVM_DELETED_FUNCTION;
+
+  ThreadPoolImpl *Impl;
+  unsigned ThreadCount;
+
+  friend class TaskGroup;
+
+public:
+  /// Create a pool of \p NumThreads threads, or of getDefaultThreadCount()
+  /// threads if \p NumThreads is zero.
+  explicit ThreadPool(unsigned NumThreads = 0);
+
+  /// Wait for all tasks to finish and stop the threads.
+  ~ThreadPool();
+
+  /// async - Queue a call of \p Fn with \p Arg.  The call is only waited for
+  /// by wait() and the destructor.
+  void async(void (*Fn)(void *), void *Arg);
+
+  /// wait - Return once every task queued on the pool has finished.
+  void wait();
+
+  unsigned getThreadCount() const { return ThreadCount; }
+
+  /// getGlobal - The pool used by the parallel algorithms, created with
+  /// getDefaultThreadCount() threads on first use.
+  static ThreadPool &getGlobal();
+
+  /// getDefaultThreadCount - The value of -threads, or the number of
+  /// hardware threads if it was not given.
+  static unsigned getDefaultThreadCount();
+
+  /// getHardwareThreadCount - The number of threads the machine can run at
+  /// once, or 1 if that cannot be determined.
+  static unsigned getHardwareThreadCount();
+};
+
+} // end namespace llvm
+
+#endif
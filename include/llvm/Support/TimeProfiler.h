@@ -0,0 +1,77 @@
+//===- llvm/Support/TimeProfiler.h - Hierarchical time trace ----*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares a profiler recording when each phase of a compilation
+// begins and ends, to be viewed as a timeline in Chrome's about:tracing or a
+// compatible viewer.  Unlike Timer, which sums the time of each phase into a
+// table, the trace keeps every event with its nesting, so one slow pass on
+// one slow function stands out.
+//
+// Code marks the phases it wants on the timeline with TimeTraceScope:
+//
+//   TimeTraceScope Scope("Instruction Selection", F.getName());
+//
+// Each thread records its events in its own buffer.  Recording is enabled by
+// -time-trace-file=<path>, in which case the trace is written to the path at
+// llvm_shutdown, or by calling timeTraceProfilerInitialize.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_SUPPORT_TIMEPROFILER_H
+#define LLVM_SUPPORT_TIMEPROFILER_H
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Compiler.h"
+
+namespace llvm {
+
+class raw_ostream;
+
+/// timeTraceProfilerInitialize - Start recording events, whether or not
+/// -time-trace-file was given.
+void timeTraceProfilerInitialize();
+
+/// timeTraceProfilerEnabled - Whether events are being recorded.
+bool timeTraceProfilerEnabled();
+
+/// timeTraceProfilerWrite - Write every event recorded so far, by all
+/// threads, as Chrome trace JSON.  Events still open are not included.
+void timeTraceProfilerWrite(raw_ostream &OS);
+
+/// timeTraceProfilerBegin - Open an event named \p Name on the calling
+/// thread.  \p Detail, which may be empty, says what the event was working
+/// on, e.g. the name of a function.
+void timeTraceProfilerBegin(StringRef Name, StringRef Detail);
+
+/// timeTraceProfilerEnd - Close the event most recently opened on the calling
+/// thread.
+void timeTraceProfilerEnd();
+
+/// TimeTraceScope - Record an event lasting for the scope of this object.
+class TimeTraceScope {
+  TimeTraceScope(const TimeTraceScope &) LLVM_DELETED_FUNCTION;
+  void operator=(const TimeTraceScope &) LLVM_DELETED_FUNCTION;
+
+  bool Active;
+
+public:
+  explicit TimeTraceScope(StringRef Name, StringRef Detail = StringRef())
+    : Active(timeTraceProfilerEnabled()) {
+    if (Active)
+      timeTraceProfilerBegin(Name, Detail);
+  }
+  ~TimeTraceScope() {
+    if (Active)
+      timeTraceProfilerEnd();
+  }
+};
+
+} // end namespace llvm
+
+#endif
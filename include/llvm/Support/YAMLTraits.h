@@ -18,6 +18,7 @@
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/ADT/Twine.h"
+#include "llvm/Support/Allocator.h"
 #include "llvm/Support/Compiler.h"
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/YAMLParser.h"
@@ -810,9 +811,9 @@ private:
   };
 
   class MapHNode : public HNode {
+    virtual void anchor();
   public:
     MapHNode(Node *n) : HNode(n) { }
-    virtual ~MapHNode();
 
     static inline bool classof(const HNode *n) {
       return MappingNode::classof(n->_node);
@@ -828,9 +829,9 @@ private:
   };
 
   class SequenceHNode : public HNode {
+    virtual void anchor();
   public:
     SequenceHNode(Node *n) : HNode(n) { }
-    virtual ~SequenceHNode();
 
     static inline bool classof(const HNode *n) {
       return SequenceNode::classof(n->_node);
@@ -841,6 +842,7 @@ private:
   };
 
   Input::HNode *createHNodes(Node *node);
+  void releaseHNodes();
   void setError(HNode *hnode, const Twine &message);
   void setError(Node *node, const Twine &message);
 
@@ -854,7 +856,13 @@ public:
 private:
   llvm::SourceMgr                  SrcMgr; // must be before Strm
   OwningPtr<llvm::yaml::Stream>    Strm;
-  OwningPtr<HNode>                 TopNode;
+  HNode                           *TopNode;
+  // The HNodes of the current document, freed all at once when moving on to
+  // the next one.
+  llvm::SpecificBumpPtrAllocator<EmptyHNode>    EmptyHNodeAllocator;
+  llvm::SpecificBumpPtrAllocator<ScalarHNode>   ScalarHNodeAllocator;
+  llvm::SpecificBumpPtrAllocator<MapHNode>      MapHNodeAllocator;
+  llvm::SpecificBumpPtrAllocator<SequenceHNode> SequenceHNodeAllocator;
   llvm::error_code                 EC;
   llvm::BumpPtrAllocator           StringAllocator;
   llvm::yaml::document_iterator    DocIterator;
@@ -0,0 +1,92 @@
+//===- raw_mmap_ostream.h - raw_ostream over a mapped file ------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file defines the raw_mmap_ostream class.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_SUPPORT_RAW_MMAP_OSTREAM_H
+#define LLVM_SUPPORT_RAW_MMAP_OSTREAM_H
+
+#include "llvm/ADT/OwningPtr.h"
+#include "llvm/Support/FileOutputBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+#include <string>
+
+namespace llvm {
+
+/// raw_mmap_ostream - A raw_ostream that writes into a FileOutputBuffer, so
+/// that the output is stored through a memory mapping of the file rather
+/// than copied to it by a write call for every buffer.  The stream uses the
+/// mapping itself as its buffer and grows the file as needed.
+///
+/// Like tool_output_file, the file is created at its path only if keep() is
+/// called; otherwise it is discarded when the stream is destroyed.  The file
+/// is built under a temporary name, which is removed if the process is
+/// killed.
+class raw_mmap_ostream : public raw_ostream {
+  OwningPtr<FileOutputBuffer> Buffer;
+
+  /// Pos - The number of bytes written to the mapping.
+  uint64_t Pos;
+
+  /// Mapped - The position the stream's buffer was last pointed at within
+  /// the mapping, or 0 if the stream is buffered elsewhere.
+  const char *Mapped;
+
+  bool Error;
+  bool Keep;
+
+  /// write_impl - See raw_ostream::write_impl.
+  virtual void write_impl(const char *Ptr, size_t Size) LLVM_OVERRIDE;
+
+  /// current_pos - Return the current position within the stream, not
+  /// counting the bytes currently in the buffer.
+  virtual uint64_t current_pos() const LLVM_OVERRIDE { return Pos; }
+
+  /// reserve - Make room for at least \p Size more bytes after Pos.
+  bool reserve(uint64_t Size);
+
+  /// mapBuffer - Point the stream's buffer at the free part of the mapping.
+  void mapBuffer();
+
+public:
+  /// raw_mmap_ostream - Open the specified file for writing.  If an error
+  /// occurs, information about the error is put into ErrorInfo, and the
+  /// stream should be immediately destroyed.  \p Flags are those of
+  /// FileOutputBuffer::create.
+  raw_mmap_ostream(StringRef Filename, std::string &ErrorInfo,
+                   unsigned Flags = 0);
+
+  /// ~raw_mmap_ostream - Flush the stream and create the file if keep() was
+  /// called.
+  ~raw_mmap_ostream();
+
+  /// keep - Indicate that the output is complete and the file should be
+  /// created.
+  void keep() { Keep = true; }
+
+  /// has_error - Return the value of the flag in this raw_mmap_ostream
+  /// indicating whether an output error has been encountered.
+  bool has_error() const { return Error; }
+
+  /// clear_error - Set the flag indicating that an output error has been
+  /// encountered to false.
+  void clear_error() { Error = false; }
+
+  /// shouldUse - Whether output to \p Filename should go through a
+  /// raw_mmap_ostream: it must not be standard output or an existing file
+  /// other than a regular file, and -mmap-output must not have been turned
+  /// off.
+  static bool shouldUse(StringRef Filename);
+};
+
+} // end llvm namespace
+
+#endif
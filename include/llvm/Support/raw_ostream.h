@@ -21,6 +21,7 @@
 
 namespace llvm {
   class format_object_base;
+  class FormattedNumber;
   template <typename T>
   class SmallVectorImpl;
 
@@ -205,6 +206,9 @@ public:
   // Formatted output, see the format() function in Support/Format.h.
   raw_ostream &operator<<(const format_object_base &Fmt);
 
+  // Formatted output, see format_hex and format_decimal in Support/Format.h.
+  raw_ostream &operator<<(const FormattedNumber &FN);
+
   /// indent - Insert 'NumSpaces' spaces.
   raw_ostream &indent(unsigned NumSpaces);
 
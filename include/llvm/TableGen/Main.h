@@ -22,8 +22,19 @@ class raw_ostream;
 /// \returns true on error, false otherwise
 typedef bool TableGenMainFn(raw_ostream &OS, RecordKeeper &Records);
 
+/// \brief Perform action number Idx using Records, and write output to OS.
+/// \returns true on error, false otherwise
+typedef bool TableGenMultiMainFn(raw_ostream &OS, RecordKeeper &Records,
+                                 unsigned Idx);
+
 int TableGenMain(char *argv0, TableGenMainFn *MainFn);
 
+/// \brief Parse the input once and perform NumActions actions on it, writing
+/// the output of each action to the file named by the corresponding -o
+/// option. This saves re-parsing large inputs for every generated file.
+int TableGenMain(char *argv0, TableGenMultiMainFn *MainFn,
+                 unsigned NumActions);
+
 }
 
 #endif
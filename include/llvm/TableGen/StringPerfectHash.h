@@ -0,0 +1,77 @@
+//===- StringPerfectHash.h - Generate perfect hash tables -------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the StringPerfectHash class.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_TABLEGEN_STRINGPERFECTHASH_H
+#define LLVM_TABLEGEN_STRINGPERFECTHASH_H
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/DataTypes.h"
+#include <string>
+#include <vector>
+
+namespace llvm {
+  class raw_ostream;
+
+/// StringPerfectHash - Given a set of distinct, non-empty strings, build a
+/// minimal perfect hash function for them and output it as C++, so that the
+/// generated code can map a string to its slot with one pass over the string
+/// and a single string comparison instead of a switch tree or a binary
+/// search.
+///
+/// Each key ends up in its own slot in [0, getNumSlots()).  Clients emit their
+/// own tables indexed by slot alongside the code produced by emit().
+///
+class StringPerfectHash {
+  std::vector<std::string> Keys;
+
+  /// Seeds - The hash seed for each bucket of keys.
+  std::vector<uint32_t> Seeds;
+
+  /// SlotKeys - The index of the key in each slot, or -1 if it is empty.
+  std::vector<int> SlotKeys;
+
+  /// KeySlots - The slot of each key.
+  std::vector<unsigned> KeySlots;
+
+public:
+  explicit StringPerfectHash(const std::vector<std::string> &Keys);
+
+  /// hash - The string hash used by both the generator and the generated
+  /// code.  It is computed a character at a time, so the generated code can
+  /// hash all the prefixes of a string in one pass.
+  static uint64_t hash(StringRef S);
+
+  /// mix - Combine a string hash with a seed to select a bucket or a slot.
+  static uint32_t mix(uint64_t H, uint32_t Seed);
+
+  unsigned getNumSlots() const { return SlotKeys.size(); }
+
+  /// getSlot - Return the slot of the key with the specified index.
+  unsigned getSlot(unsigned KeyIdx) const { return KeySlots[KeyIdx]; }
+
+  /// getKeyInSlot - Return the index of the key in the specified slot, or -1
+  /// if the slot is empty.
+  int getKeyInSlot(unsigned Slot) const { return SlotKeys[Slot]; }
+
+  /// emit - Output the seed and key tables and a struct named Name with a
+  /// 'static int lookup(StringRef)' function that returns the slot of its
+  /// argument, or -1 if it is not one of the keys.  An overload taking the
+  /// hash computed with the hashInit() and hashStep() members is provided
+  /// too.  The output is valid both at namespace scope and inside a function
+  /// body.
+  void emit(raw_ostream &OS, StringRef Name, unsigned Indent = 0) const;
+};
+
+} // end llvm namespace.
+
+#endif
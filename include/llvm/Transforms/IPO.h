@@ -148,6 +148,13 @@ ModulePass *createIPConstantPropagationPass();
 ///
 ModulePass *createIPSCCPPass();
 
+//===----------------------------------------------------------------------===//
+/// createFunctionSpecializationPass - This pass clones functions for constant
+/// arguments passed by frequently executed call sites.  IPSCCP should be run
+/// afterwards to propagate the constants through the clones.
+///
+ModulePass *createFunctionSpecializationPass();
+
 //===----------------------------------------------------------------------===//
 //
 /// createLoopExtractorPass - This pass extracts all natural loops from the
@@ -179,9 +186,11 @@ Pass *createFunctionAttrsPass();
 
 //===----------------------------------------------------------------------===//
 /// createMergeFunctionsPass - This pass discovers identical functions and
-/// collapses them.
+/// collapses them.  With FoldIdentical, as used for LTO, local unnamed_addr
+/// functions are deleted in favour of their equivalents instead of being
+/// turned into thunks.
 ///
-ModulePass *createMergeFunctionsPass();
+ModulePass *createMergeFunctionsPass(bool FoldIdentical = false);
 
 //===----------------------------------------------------------------------===//
 /// createPartialInliningPass - This pass inlines parts of functions.
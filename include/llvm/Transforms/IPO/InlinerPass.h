@@ -17,12 +17,13 @@
 #ifndef LLVM_TRANSFORMS_IPO_INLINERPASS_H
 #define LLVM_TRANSFORMS_IPO_INLINERPASS_H
 
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/Analysis/CallGraphSCCPass.h"
+#include "llvm/Analysis/InlineCost.h"
 
 namespace llvm {
   class CallSite;
   class DataLayout;
-  class InlineCost;
   template<class PtrType, unsigned SmallSize>
   class SmallPtrSet;
 
@@ -81,6 +82,39 @@ private:
   // InsertLifetime - Insert @llvm.lifetime intrinsics.
   bool InsertLifetime;
 
+  /// CachedInlineCost - The cost of a call site that was analyzed in an
+  /// earlier iteration over the current SCC, along with enough of the state
+  /// it was computed in to tell whether it is still valid.
+  struct CachedInlineCost {
+    InlineCost IC;
+    Function *Callee;
+    unsigned CallerStamp, CalleeStamp;
+    bool CalleeHadOneUse;
+
+    CachedInlineCost(InlineCost IC, Function *Callee, unsigned CallerStamp,
+                     unsigned CalleeStamp, bool CalleeHadOneUse)
+      : IC(IC), Callee(Callee), CallerStamp(CallerStamp),
+        CalleeStamp(CalleeStamp), CalleeHadOneUse(CalleeHadOneUse) {}
+  };
+
+  /// CostCache - Costs computed during the current runOnSCC, keyed by call
+  /// instruction.
+  DenseMap<Instruction *, CachedInlineCost> CostCache;
+
+  /// ChangeStamps - For each function modified during the current runOnSCC,
+  /// a stamp that is bumped whenever its body changes.  Unmodified functions
+  /// have stamp zero.
+  DenseMap<Function *, unsigned> ChangeStamps;
+  unsigned LastChangeStamp;
+
+  /// markChanged - Record that the body of F has been modified, invalidating
+  /// any cached costs of inlining into or out of it.
+  void markChanged(Function *F) { ChangeStamps[F] = ++LastChangeStamp; }
+
+  /// getCachedInlineCost - Return getInlineCost(CS), reusing the result from
+  /// an earlier iteration if neither the caller nor the callee has changed.
+  InlineCost getCachedInlineCost(CallSite CS);
+
   /// shouldInline - Return true if the inliner should attempt to
   /// inline at the given CallSite.
   bool shouldInline(CallSite CS);
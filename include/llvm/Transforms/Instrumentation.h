@@ -92,6 +92,15 @@ inline ModulePass *createDataFlowSanitizerPassForJIT(StringRef ABIListFile =
 }
 #endif
 
+// ExecutionCounters - This pass gives each defined function a global array of
+// two i64 counters, named by getExecutionCounterName, and increments element 0
+// on entry and element 1 on every loop back-edge.  A JIT can read the counters
+// through ExecutionEngine::getGlobalValueAddress to find hot functions.
+ModulePass *createExecutionCountersPass();
+
+/// Return the name of the counter array created for the named function.
+std::string getExecutionCounterName(StringRef FunctionName);
+
 // BoundsChecking - This pass instruments the code to perform run-time bounds
 // checking on loads, stores, and other memory intrinsics.
 FunctionPass *createBoundsCheckingPass();
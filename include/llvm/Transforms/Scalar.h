@@ -160,6 +160,13 @@ Pass *createLoopRotatePass();
 // LoopIdiom - This pass recognizes and replaces idioms in loops.
 //
 Pass *createLoopIdiomPass();
+
+//===----------------------------------------------------------------------===//
+//
+// LoopInterchange - This pass interchanges the loops of perfect loop nests
+// whose inner loop would then access memory consecutively.
+//
+Pass *createLoopInterchangePass();
   
 //===----------------------------------------------------------------------===//
 //
@@ -54,6 +54,12 @@ AliasAnalysis::alias(const Location &LocA, const Location &LocB) {
   return AA->alias(LocA, LocB);
 }
 
+void AliasAnalysis::aliasMany(const Location &LocA, ArrayRef<Location> LocBs,
+                              SmallVectorImpl<AliasResult> &Results) {
+  for (unsigned i = 0, e = LocBs.size(); i != e; ++i)
+    Results.push_back(alias(LocA, LocBs[i]));
+}
+
 bool AliasAnalysis::pointsToConstantMemory(const Location &Loc,
                                            bool OrLocal) {
   assert(AA && "AA didn't call InitializeAliasAnalysis in its run method!");
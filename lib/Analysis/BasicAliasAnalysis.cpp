@@ -469,6 +469,37 @@ namespace {
       return Alias;
     }
 
+    virtual void aliasMany(const Location &LocA, ArrayRef<Location> LocBs,
+                           SmallVectorImpl<AliasResult> &Results) {
+      // Each query must still start from an empty AliasCache, because the
+      // entries made while recursing depend on the phis visited on the way.
+      // The final answers only depend on the memory each location covers,
+      // though.  Locations at the same constant offset from the same base
+      // share one answer, and the ones whose underlying object is an
+      // identified object other than LocA's need no query at all.
+      const Value *ObjA = GetUnderlyingObject(LocA.Ptr, TD);
+      bool IsIdentifiedA = isIdentifiedObject(ObjA);
+      typedef std::pair<Location, int64_t> BaseOffsetTy;
+      SmallDenseMap<BaseOffsetTy, AliasResult, 8> Answered;
+      for (unsigned i = 0, e = LocBs.size(); i != e; ++i) {
+        const Location &LocB = LocBs[i];
+        int64_t Offset = 0;
+        const Value *Base = GetPointerBaseWithConstantOffset(LocB.Ptr, Offset,
+                                                             TD);
+        BaseOffsetTy Key(Location(Base, LocB.Size, LocB.TBAATag), Offset);
+        std::pair<SmallDenseMap<BaseOffsetTy, AliasResult, 8>::iterator, bool>
+          Pair = Answered.insert(std::make_pair(Key, MayAlias));
+        if (Pair.second) {
+          const Value *ObjB = GetUnderlyingObject(Base, TD);
+          if (IsIdentifiedA && ObjA != ObjB && isIdentifiedObject(ObjB))
+            Pair.first->second = NoAlias;
+          else
+            Pair.first->second = alias(LocA, LocB);
+        }
+        Results.push_back(Pair.first->second);
+      }
+    }
+
     virtual ModRefResult getModRefInfo(ImmutableCallSite CS,
                                        const Location &Loc);
 
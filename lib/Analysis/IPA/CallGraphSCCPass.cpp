@@ -427,7 +427,12 @@ bool CGPassManager::runOnModule(Module &M) {
   CallGraph &CG = getAnalysis<CallGraphWrapperPass>().getCallGraph();
   bool Changed = doInitialization(CG);
   
-  // Walk the callgraph in bottom-up SCC order.
+  // Walk the callgraph in bottom-up SCC order.  The walk is inherently serial:
+  // scc_iterator discovers SCCs lazily, Tarjan-style, and the passes it drives
+  // (the inliner above all) rewrite the very call graph it is walking, so
+  // which SCC comes next is only known once the current one is finished.
+  // Running two SCCs at once would also race on their shared callees' use
+  // lists and on LLVMContext's uniquing tables, none of which are locked.
   scc_iterator<CallGraph*> CGI = scc_begin(&CG);
 
   CallGraphSCC CurSCC(&CGI);
@@ -28,6 +28,7 @@
 #include "llvm/IR/DataLayout.h"
 #include "llvm/IR/GlobalAlias.h"
 #include "llvm/IR/Operator.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/ConstantRange.h"
 #include "llvm/Support/GetElementPtrTypeIterator.h"
 #include "llvm/Support/PatternMatch.h"
@@ -40,6 +41,13 @@ enum { RecursionLimit = 3 };
 STATISTIC(NumExpand,  "Number of expansions");
 STATISTIC(NumFactor , "Number of factorizations");
 STATISTIC(NumReassoc, "Number of reassociations");
+STATISTIC(NumCacheQueries, "Number of queries to simplification caches");
+STATISTIC(NumCacheHits, "Number of queries answered by simplification caches");
+
+static cl::opt<bool>
+EnableSimplifyCache("instsimplify-cache", cl::init(false), cl::Hidden,
+                    cl::desc("Let passes remember the instructions that "
+                             "failed to simplify"));
 
 struct Query {
   const DataLayout *TD;
@@ -3031,11 +3039,41 @@ Value *llvm::SimplifyCall(Value *V, ArrayRef<Value *> Args,
                         RecursionLimit);
 }
 
+bool SimplifyInstructionCache::isKnownUnsimplified(const Instruction *I) {
+  ++NumCacheQueries;
+  MapTy::iterator It = Unsimplified.find(I);
+  if (It == Unsimplified.end())
+    return false;
+
+  const SmallVectorImpl<Value *> &Ops = It->second;
+  bool Unchanged = Ops.size() == I->getNumOperands();
+  for (unsigned i = 0, e = Ops.size(); i != e && Unchanged; ++i)
+    Unchanged = Ops[i] == I->getOperand(i);
+  if (!Unchanged) {
+    Unsimplified.erase(It);
+    return false;
+  }
+  ++NumCacheHits;
+  return true;
+}
+
+void SimplifyInstructionCache::setUnsimplified(const Instruction *I) {
+  SmallVector<Value *, 4> &Ops = Unsimplified[I];
+  Ops.clear();
+  Ops.append(I->op_begin(), I->op_end());
+}
+
 /// SimplifyInstruction - See if we can compute a simplified version of this
 /// instruction.  If not, this returns null.
 Value *llvm::SimplifyInstruction(Instruction *I, const DataLayout *TD,
                                  const TargetLibraryInfo *TLI,
-                                 const DominatorTree *DT) {
+                                 const DominatorTree *DT,
+                                 SimplifyInstructionCache *Cache) {
+  if (!EnableSimplifyCache)
+    Cache = 0;
+  if (Cache && Cache->isKnownUnsimplified(I))
+    return 0;
+
   Value *Result;
 
   switch (I->getOpcode()) {
@@ -3150,6 +3188,9 @@ Value *llvm::SimplifyInstruction(Instruction *I, const DataLayout *TD,
     break;
   }
 
+  if (!Result && Cache)
+    Cache->setUnsimplified(I);
+
   /// If called on unreachable code, the above logic may report that the
   /// instruction simplified to itself.  Make life easier for users by
   /// detecting that case here, returning a safe value instead.
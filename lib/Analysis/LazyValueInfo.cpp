@@ -14,8 +14,11 @@
 
 #define DEBUG_TYPE "lazy-value-info"
 #include "llvm/Analysis/LazyValueInfo.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/Analysis/ConstantFolding.h"
 #include "llvm/Analysis/ValueTracking.h"
 #include "llvm/IR/Constants.h"
@@ -23,6 +26,7 @@
 #include "llvm/IR/Instructions.h"
 #include "llvm/IR/IntrinsicInst.h"
 #include "llvm/Support/CFG.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/ConstantRange.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/PatternMatch.h"
@@ -34,6 +38,17 @@
 using namespace llvm;
 using namespace PatternMatch;
 
+STATISTIC(NumCacheFlushes, "Number of times the LVI cache was emptied");
+
+// Every (value, block) pair ever queried stays cached until the function is
+// done, which on large functions with heavy jump threading can grow without
+// bound.  Past this many solved block values, empty the cache between queries
+// and let it refill lazily.  Zero means no limit.
+static cl::opt<unsigned>
+MaxBlockValues("lvi-max-block-values", cl::Hidden, cl::init(500000),
+               cl::desc("Maximum number of block values LazyValueInfo "
+                        "caches before it starts over (0 = no limit)"));
+
 char LazyValueInfo::ID = 0;
 INITIALIZE_PASS_BEGIN(LazyValueInfo, "lazy-value-info",
                 "Lazy Value Information Analysis", false, true)
@@ -325,9 +340,16 @@ namespace {
     
     /// OverDefinedCache - This tracks, on a per-block basis, the set of 
     /// values that are over-defined at the end of that block.  This is required
-    /// for cache updating.
-    typedef std::pair<AssertingVH<BasicBlock>, Value*> OverDefinedPairTy;
-    DenseSet<OverDefinedPairTy> OverDefinedCache;
+    /// for cache updating.  Keying on the block lets eraseBlock and threadEdge
+    /// find a block's values without scanning every overdefined pair.
+    typedef SmallPtrSet<Value*, 4> ValueSetTy;
+    typedef DenseMap<AssertingVH<BasicBlock>, ValueSetTy> OverDefinedCacheTy;
+    OverDefinedCacheTy OverDefinedCache;
+
+    /// NumBlockValues - The number of block values solved since the cache was
+    /// last emptied.  Entries removed by the update interface are not
+    /// subtracted, so this is an upper bound on the size of ValueCache.
+    unsigned NumBlockValues;
 
     /// SeenBlocks - Keep track of all blocks that we have ever seen, so we
     /// don't spend time removing unused blocks from our caches.
@@ -354,7 +376,7 @@ namespace {
       
       bool markResult(bool changed) { 
         if (changed && BBLV.isOverdefined())
-          Parent->OverDefinedCache.insert(std::make_pair(BB, Val));
+          Parent->OverDefinedCache[BB].insert(Val);
         return changed;
       }
     };
@@ -378,12 +400,19 @@ namespace {
                                       Instruction *BBI, BasicBlock *BB);
 
     void solve();
+
+    /// enforceCacheLimit - Empty the cache if more block values have been
+    /// solved than -lvi-max-block-values allows.  This must only be called
+    /// between queries, when no references into the cache are live.
+    void enforceCacheLimit();
     
     ValueCacheEntryTy &lookup(Value *V) {
       return ValueCache[LVIValueHandle(V, this)];
     }
 
   public:
+    LazyValueInfoCache() : NumBlockValues(0) {}
+
     /// getValueInBlock - This is the query interface to determine the lattice
     /// value for the specified Value* at the end of the specified block.
     LVILatticeVal getValueInBlock(Value *V, BasicBlock *BB);
@@ -406,25 +435,16 @@ namespace {
       SeenBlocks.clear();
       ValueCache.clear();
       OverDefinedCache.clear();
+      NumBlockValues = 0;
     }
   };
 } // end anonymous namespace
 
 void LVIValueHandle::deleted() {
-  typedef std::pair<AssertingVH<BasicBlock>, Value*> OverDefinedPairTy;
-  
-  SmallVector<OverDefinedPairTy, 4> ToErase;
-  for (DenseSet<OverDefinedPairTy>::iterator 
+  for (LazyValueInfoCache::OverDefinedCacheTy::iterator
        I = Parent->OverDefinedCache.begin(),
-       E = Parent->OverDefinedCache.end();
-       I != E; ++I) {
-    if (I->second == getValPtr())
-      ToErase.push_back(*I);
-  }
-
-  for (SmallVectorImpl<OverDefinedPairTy>::iterator I = ToErase.begin(),
-       E = ToErase.end(); I != E; ++I)
-    Parent->OverDefinedCache.erase(*I);
+       E = Parent->OverDefinedCache.end(); I != E; ++I)
+    I->second.erase(getValPtr());
   
   // This erasure deallocates *this, so it MUST happen after we're done
   // using any and all members of *this.
@@ -438,22 +458,23 @@ void LazyValueInfoCache::eraseBlock(BasicBlock *BB) {
     return;
   SeenBlocks.erase(I);
 
-  SmallVector<OverDefinedPairTy, 4> ToErase;
-  for (DenseSet<OverDefinedPairTy>::iterator  I = OverDefinedCache.begin(),
-       E = OverDefinedCache.end(); I != E; ++I) {
-    if (I->first == BB)
-      ToErase.push_back(*I);
-  }
-
-  for (SmallVectorImpl<OverDefinedPairTy>::iterator I = ToErase.begin(),
-       E = ToErase.end(); I != E; ++I)
-    OverDefinedCache.erase(*I);
+  OverDefinedCache.erase(BB);
 
   for (std::map<LVIValueHandle, ValueCacheEntryTy>::iterator
        I = ValueCache.begin(), E = ValueCache.end(); I != E; ++I)
     I->second.erase(BB);
 }
 
+void LazyValueInfoCache::enforceCacheLimit() {
+  if (!MaxBlockValues || NumBlockValues <= MaxBlockValues)
+    return;
+
+  DEBUG(dbgs() << "LVI flushing cache after " << NumBlockValues
+               << " block values for " << ValueCache.size() << " values\n");
+  ++NumCacheFlushes;
+  clear();
+}
+
 void LazyValueInfoCache::solve() {
   while (!BlockValueStack.empty()) {
     std::pair<BasicBlock*, Value*> &e = BlockValueStack.top();
@@ -514,6 +535,7 @@ bool LazyValueInfoCache::solveBlockValue(Value *Val, BasicBlock *BB) {
   // lattice value to overdefined, so that cycles will terminate and be
   // conservatively correct.
   BBLV.markOverdefined();
+  ++NumBlockValues;
   
   Instruction *BBI = dyn_cast<Instruction>(Val);
   if (BBI == 0 || BBI->getParent() != BB) {
@@ -912,7 +934,8 @@ bool LazyValueInfoCache::getEdgeValue(Value *Val, BasicBlock *BBFrom,
 LVILatticeVal LazyValueInfoCache::getValueInBlock(Value *V, BasicBlock *BB) {
   DEBUG(dbgs() << "LVI Getting block end value " << *V << " at '"
         << BB->getName() << "'\n");
-  
+
+  enforceCacheLimit();
   BlockValueStack.push(std::make_pair(BB, V));
   solve();
   LVILatticeVal Result = getBlockValue(V, BB);
@@ -925,7 +948,8 @@ LVILatticeVal LazyValueInfoCache::
 getValueOnEdge(Value *V, BasicBlock *FromBB, BasicBlock *ToBB) {
   DEBUG(dbgs() << "LVI Getting edge value " << *V << " from '"
         << FromBB->getName() << "' to '" << ToBB->getName() << "'\n");
-  
+
+  enforceCacheLimit();
   LVILatticeVal Result;
   if (!getEdgeValue(V, FromBB, ToBB, Result)) {
     solve();
@@ -953,12 +977,10 @@ void LazyValueInfoCache::threadEdge(BasicBlock *PredBB, BasicBlock *OldSucc,
   std::vector<BasicBlock*> worklist;
   worklist.push_back(OldSucc);
   
-  DenseSet<Value*> ClearSet;
-  for (DenseSet<OverDefinedPairTy>::iterator I = OverDefinedCache.begin(),
-       E = OverDefinedCache.end(); I != E; ++I) {
-    if (I->first == OldSucc)
-      ClearSet.insert(I->second);
-  }
+  OverDefinedCacheTy::iterator OldI = OverDefinedCache.find(OldSucc);
+  if (OldI == OverDefinedCache.end())
+    return;
+  ValueSetTy ClearSet = OldI->second;
   
   // Use a worklist to perform a depth-first search of OldSucc's successors.
   // NOTE: We do not need a visited list since any blocks we have already
@@ -971,13 +993,15 @@ void LazyValueInfoCache::threadEdge(BasicBlock *PredBB, BasicBlock *OldSucc,
     // Skip blocks only accessible through NewSucc.
     if (ToUpdate == NewSucc) continue;
     
+    OverDefinedCacheTy::iterator OI = OverDefinedCache.find(ToUpdate);
+    if (OI == OverDefinedCache.end()) continue;
+    ValueSetTy &ValueSet = OI->second;
+
     bool changed = false;
-    for (DenseSet<Value*>::iterator I = ClearSet.begin(), E = ClearSet.end();
+    for (ValueSetTy::iterator I = ClearSet.begin(), E = ClearSet.end();
          I != E; ++I) {
       // If a value was marked overdefined in OldSucc, and is here too...
-      DenseSet<OverDefinedPairTy>::iterator OI =
-        OverDefinedCache.find(std::make_pair(ToUpdate, *I));
-      if (OI == OverDefinedCache.end()) continue;
+      if (!ValueSet.erase(*I)) continue;
 
       // Remove it from the caches.
       ValueCacheEntryTy &Entry = ValueCache[LVIValueHandle(*I, this)];
@@ -985,7 +1009,6 @@ void LazyValueInfoCache::threadEdge(BasicBlock *PredBB, BasicBlock *OldSucc,
 
       assert(CI != Entry.end() && "Couldn't find entry to update?");
       Entry.erase(CI);
-      OverDefinedCache.erase(OI);
 
       // If we removed anything, then we potentially need to update 
       // blocks successors too.
@@ -29,6 +29,7 @@
 #include "llvm/IR/Instructions.h"
 #include "llvm/IR/IntrinsicInst.h"
 #include "llvm/IR/LLVMContext.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/PredIteratorCache.h"
 using namespace llvm;
@@ -49,6 +50,13 @@ STATISTIC(NumCacheCompleteNonLocalPtr,
 // Limit for the number of instructions to scan in a block.
 static const int BlockScanLimit = 100;
 
+// Limit for the number of blocks a single non-local pointer query may add to
+// its worklist.  Past this, the query gives up and reports a clobber.
+static cl::opt<unsigned>
+BlockNumberLimit("memdep-block-number-limit", cl::Hidden, cl::init(1000),
+                 cl::desc("The number of blocks to scan during memory "
+                          "dependency analysis (default = 1000)"));
+
 char MemoryDependenceAnalysis::ID = 0;
 
 // Register this pass...
@@ -1036,6 +1044,7 @@ getNonLocalPointerDepFromBB(const PHITransAddr &Pointer,
   // won't get any reuse from currently inserted values, because we don't
   // revisit blocks after we insert info for them.
   unsigned NumSortedEntries = Cache->size();
+  unsigned WorklistEntries = BlockNumberLimit;
   DEBUG(AssertSorted(*Cache));
 
   while (!Worklist.empty()) {
@@ -1072,7 +1081,6 @@ getNonLocalPointerDepFromBB(const PHITransAddr &Pointer,
     // If not, we just add the predecessors to the worklist and scan them with
     // the same Pointer.
     if (!Pointer.NeedsPHITranslationFromBlock(BB)) {
-      SkipFirstBlock = false;
       SmallVector<BasicBlock*, 16> NewBlocks;
       for (BasicBlock **PI = PredCache->GetPreds(BB); *PI; ++PI) {
         // Verify that we haven't looked at this block yet.
@@ -1095,6 +1103,15 @@ getNonLocalPointerDepFromBB(const PHITransAddr &Pointer,
           goto PredTranslationFailure;
         }
       }
+
+      // On very large CFGs, give up rather than walking the whole function.
+      if (NewBlocks.size() > WorklistEntries) {
+        for (unsigned i = 0; i < NewBlocks.size(); i++)
+          Visited.erase(NewBlocks[i]);
+        goto PredTranslationFailure;
+      }
+      WorklistEntries -= NewBlocks.size();
+      SkipFirstBlock = false;
       Worklist.append(NewBlocks.begin(), NewBlocks.end());
       continue;
     }
@@ -98,6 +98,8 @@ STATISTIC(NumTripCountsNotComputed,
           "Number of loops without predictable loop counts");
 STATISTIC(NumBruteForceTripCountsComputed,
           "Number of loops with trip counts computed by force");
+STATISTIC(NumOverBudget,
+          "Number of values not analyzed because of the memory budget");
 
 static cl::opt<unsigned>
 MaxBruteForceIterations("scalar-evolution-max-iterations", cl::ReallyHidden,
@@ -106,6 +108,13 @@ MaxBruteForceIterations("scalar-evolution-max-iterations", cl::ReallyHidden,
                                  "derived loop"),
                         cl::init(100));
 
+static cl::opt<unsigned>
+MaxSCEVMemory("scalar-evolution-max-memory", cl::Hidden,
+              cl::desc("Maximum number of bytes of expressions ScalarEvolution "
+                       "will create for a function before giving up on "
+                       "analyzing new values (0 = no limit)"),
+              cl::init(0));
+
 // FIXME: Enable this with XDEBUG when the test suite is clean.
 static cl::opt<bool>
 VerifySCEV("verify-scev",
@@ -3600,10 +3609,21 @@ ScalarEvolution::getSignedRange(const SCEV *S) {
 /// createSCEV - We know that there is no SCEV for the specified value.
 /// Analyze the expression.
 ///
+bool ScalarEvolution::isOverMemoryBudget() const {
+  return MaxSCEVMemory && SCEVAllocator.getTotalMemory() > MaxSCEVMemory;
+}
+
 const SCEV *ScalarEvolution::createSCEV(Value *V) {
   if (!isSCEVable(V->getType()))
     return getUnknown(V);
 
+  // Once the budget is spent, stop building expressions. An unknown is always
+  // a correct, if conservative, answer.
+  if (isOverMemoryBudget()) {
+    ++NumOverBudget;
+    return getUnknown(V);
+  }
+
   unsigned Opcode = Instruction::UserOp1;
   if (Instruction *I = dyn_cast<Instruction>(V)) {
     Opcode = I->getOpcode();
@@ -4094,6 +4114,11 @@ ScalarEvolution::getBackedgeTakenInfo(const Loop *L) {
   if (!Pair.second)
     return Pair.first->second;
 
+  // Leave the CouldNotCompute entry in place if there is no memory left to
+  // compute the count with.
+  if (isOverMemoryBudget())
+    return Pair.first->second;
+
   // ComputeBackedgeTakenCount may allocate memory for its result. Inserting it
   // into the BackedgeTakenCounts map transfers ownership. Otherwise, the result
   // must be cleared in this scope.
@@ -39,8 +39,13 @@ bool LLParser::Run() {
   // Prime the lexer.
   Lex.Lex();
 
-  return ParseTopLevelEntities() ||
-         ValidateEndOfModule();
+  if (ParseTopLevelEntities() ||
+      ValidateEndOfModule())
+    return true;
+
+  // Everything is resolved now, report the functions that were still waiting.
+  NotifyParsedFunctions();
+  return false;
 }
 
 /// ValidateEndOfModule - Do final validity and sanity checks at the end of the
@@ -68,65 +73,14 @@ bool LLParser::ValidateEndOfModule() {
 
   for (unsigned I = 0, E = InstsWithTBAATag.size(); I < E; I++)
     UpgradeInstWithTBAATag(InstsWithTBAATag[I]);
+  InstsWithTBAATag.clear();
 
   // Handle any function attribute group forward references.
   for (std::map<Value*, std::vector<unsigned> >::iterator
          I = ForwardRefAttrGroups.begin(), E = ForwardRefAttrGroups.end();
-         I != E; ++I) {
-    Value *V = I->first;
-    std::vector<unsigned> &Vec = I->second;
-    AttrBuilder B;
-
-    for (std::vector<unsigned>::iterator VI = Vec.begin(), VE = Vec.end();
-         VI != VE; ++VI)
-      B.merge(NumberedAttrBuilders[*VI]);
-
-    if (Function *Fn = dyn_cast<Function>(V)) {
-      AttributeSet AS = Fn->getAttributes();
-      AttrBuilder FnAttrs(AS.getFnAttributes(), AttributeSet::FunctionIndex);
-      AS = AS.removeAttributes(Context, AttributeSet::FunctionIndex,
-                               AS.getFnAttributes());
-
-      FnAttrs.merge(B);
-
-      // If the alignment was parsed as an attribute, move to the alignment
-      // field.
-      if (FnAttrs.hasAlignmentAttr()) {
-        Fn->setAlignment(FnAttrs.getAlignment());
-        FnAttrs.removeAttribute(Attribute::Alignment);
-      }
-
-      AS = AS.addAttributes(Context, AttributeSet::FunctionIndex,
-                            AttributeSet::get(Context,
-                                              AttributeSet::FunctionIndex,
-                                              FnAttrs));
-      Fn->setAttributes(AS);
-    } else if (CallInst *CI = dyn_cast<CallInst>(V)) {
-      AttributeSet AS = CI->getAttributes();
-      AttrBuilder FnAttrs(AS.getFnAttributes(), AttributeSet::FunctionIndex);
-      AS = AS.removeAttributes(Context, AttributeSet::FunctionIndex,
-                               AS.getFnAttributes());
-      FnAttrs.merge(B);
-      AS = AS.addAttributes(Context, AttributeSet::FunctionIndex,
-                            AttributeSet::get(Context,
-                                              AttributeSet::FunctionIndex,
-                                              FnAttrs));
-      CI->setAttributes(AS);
-    } else if (InvokeInst *II = dyn_cast<InvokeInst>(V)) {
-      AttributeSet AS = II->getAttributes();
-      AttrBuilder FnAttrs(AS.getFnAttributes(), AttributeSet::FunctionIndex);
-      AS = AS.removeAttributes(Context, AttributeSet::FunctionIndex,
-                               AS.getFnAttributes());
-      FnAttrs.merge(B);
-      AS = AS.addAttributes(Context, AttributeSet::FunctionIndex,
-                            AttributeSet::get(Context,
-                                              AttributeSet::FunctionIndex,
-                                              FnAttrs));
-      II->setAttributes(AS);
-    } else {
-      llvm_unreachable("invalid object with forward attribute group reference");
-    }
-  }
+         I != E; ++I)
+    ResolveForwardRefAttrGroups(I->first, I->second);
+  ForwardRefAttrGroups.clear();
 
   // If there are entries in ForwardRefBlockAddresses at this point, they are
   // references after the function was defined.  Resolve those now.
@@ -187,6 +141,99 @@ bool LLParser::ValidateEndOfModule() {
   return false;
 }
 
+/// ResolveForwardRefAttrGroups - Merge the specified attribute groups into the
+/// function attributes of V, which is a function, call or invoke.
+void LLParser::ResolveForwardRefAttrGroups(Value *V,
+                                         const std::vector<unsigned> &Groups) {
+  AttrBuilder B;
+
+  for (std::vector<unsigned>::const_iterator VI = Groups.begin(),
+         VE = Groups.end(); VI != VE; ++VI)
+    B.merge(NumberedAttrBuilders[*VI]);
+
+  if (Function *Fn = dyn_cast<Function>(V)) {
+    AttributeSet AS = Fn->getAttributes();
+    AttrBuilder FnAttrs(AS.getFnAttributes(), AttributeSet::FunctionIndex);
+    AS = AS.removeAttributes(Context, AttributeSet::FunctionIndex,
+                             AS.getFnAttributes());
+
+    FnAttrs.merge(B);
+
+    // If the alignment was parsed as an attribute, move to the alignment
+    // field.
+    if (FnAttrs.hasAlignmentAttr()) {
+      Fn->setAlignment(FnAttrs.getAlignment());
+      FnAttrs.removeAttribute(Attribute::Alignment);
+    }
+
+    AS = AS.addAttributes(Context, AttributeSet::FunctionIndex,
+                          AttributeSet::get(Context,
+                                            AttributeSet::FunctionIndex,
+                                            FnAttrs));
+    Fn->setAttributes(AS);
+  } else if (CallInst *CI = dyn_cast<CallInst>(V)) {
+    AttributeSet AS = CI->getAttributes();
+    AttrBuilder FnAttrs(AS.getFnAttributes(), AttributeSet::FunctionIndex);
+    AS = AS.removeAttributes(Context, AttributeSet::FunctionIndex,
+                             AS.getFnAttributes());
+    FnAttrs.merge(B);
+    AS = AS.addAttributes(Context, AttributeSet::FunctionIndex,
+                          AttributeSet::get(Context,
+                                            AttributeSet::FunctionIndex,
+                                            FnAttrs));
+    CI->setAttributes(AS);
+  } else if (InvokeInst *II = dyn_cast<InvokeInst>(V)) {
+    AttributeSet AS = II->getAttributes();
+    AttrBuilder FnAttrs(AS.getFnAttributes(), AttributeSet::FunctionIndex);
+    AS = AS.removeAttributes(Context, AttributeSet::FunctionIndex,
+                             AS.getFnAttributes());
+    FnAttrs.merge(B);
+    AS = AS.addAttributes(Context, AttributeSet::FunctionIndex,
+                          AttributeSet::get(Context,
+                                            AttributeSet::FunctionIndex,
+                                            FnAttrs));
+    II->setAttributes(AS);
+  } else {
+    llvm_unreachable("invalid object with forward attribute group reference");
+  }
+}
+
+/// NotifyParsedFunctions - Hand the functions parsed so far to the listener,
+/// unless something parsed so far is still a forward reference that could
+/// change their bodies.
+void LLParser::NotifyParsedFunctions() {
+  if (PendingFunctions.empty())
+    return;
+
+  // Attribute groups are always recorded as forward references, apply the
+  // ones that have been defined already.  Stop at the first one that has not,
+  // the functions have to wait for it anyway.
+  for (std::map<Value*, std::vector<unsigned> >::iterator
+         I = ForwardRefAttrGroups.begin(), E = ForwardRefAttrGroups.end();
+         I != E; ) {
+    const std::vector<unsigned> &Vec = I->second;
+    for (unsigned i = 0, e = Vec.size(); i != e; ++i)
+      if (!NumberedAttrBuilders.count(Vec[i]))
+        return;
+    ResolveForwardRefAttrGroups(I->first, Vec);
+    ForwardRefAttrGroups.erase(I++);
+  }
+
+  if (!ForwardRefVals.empty() || !ForwardRefValIDs.empty() ||
+      !ForwardRefMDNodes.empty() || !ForwardRefInstMetadata.empty() ||
+      !ForwardRefBlockAddresses.empty())
+    return;
+
+  // Every TBAA tag refers to a complete node at this point.
+  for (unsigned I = 0, E = InstsWithTBAATag.size(); I < E; I++)
+    UpgradeInstWithTBAATag(InstsWithTBAATag[I]);
+  InstsWithTBAATag.clear();
+
+  for (unsigned i = 0, e = PendingFunctions.size(); i != e; ++i)
+    Listener->functionParsed(*PendingFunctions[i]);
+  PendingFunctions.clear();
+}
+
 bool LLParser::ResolveForwardRefBlockAddresses(Function *TheFn,
                              std::vector<std::pair<ValID, GlobalValue*> > &Refs,
                                                PerFunctionState *PFS) {
@@ -285,6 +332,8 @@ bool LLParser::ParseTopLevelEntities() {
 
     case lltok::kw_attributes: if (ParseUnnamedAttrGrp()) return true; break;
     }
+
+    NotifyParsedFunctions();
   }
 }
 
@@ -424,8 +473,13 @@ bool LLParser::ParseDefine() {
   Lex.Lex();
 
   Function *F;
-  return ParseFunctionHeader(F, true) ||
-         ParseFunctionBody(*F);
+  if (ParseFunctionHeader(F, true) ||
+      ParseFunctionBody(*F))
+    return true;
+
+  if (Listener)
+    PendingFunctions.push_back(F);
+  return false;
 }
 
 /// ParseGlobalType
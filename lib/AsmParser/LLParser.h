@@ -15,6 +15,7 @@
 #define LLVM_ASMPARSER_LLPARSER_H
 
 #include "LLLexer.h"
+#include "llvm/Assembly/Parser.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/IR/Attributes.h"
@@ -131,10 +132,16 @@ namespace llvm {
     std::map<Value*, std::vector<unsigned> > ForwardRefAttrGroups;
     std::map<unsigned, AttrBuilder> NumberedAttrBuilders;
 
+    // Functions that have been parsed but not yet reported to the listener
+    // because something parsed so far is still a forward reference.
+    ParsedFunctionListener *Listener;
+    std::vector<Function*> PendingFunctions;
+
   public:
-    LLParser(MemoryBuffer *F, SourceMgr &SM, SMDiagnostic &Err, Module *m) :
+    LLParser(MemoryBuffer *F, SourceMgr &SM, SMDiagnostic &Err, Module *m,
+             ParsedFunctionListener *listener = 0) :
       Context(m->getContext()), Lex(F, SM, Err, m->getContext()),
-      M(m) {}
+      M(m), Listener(listener) {}
     bool Run();
 
     LLVMContext &getContext() { return Context; }
@@ -222,6 +229,9 @@ namespace llvm {
     // Top-Level Entities
     bool ParseTopLevelEntities();
     bool ValidateEndOfModule();
+    void ResolveForwardRefAttrGroups(Value *V,
+                                     const std::vector<unsigned> &Groups);
+    void NotifyParsedFunctions();
     bool ParseTargetDefinition();
     bool ParseModuleAsm();
     bool ParseDepLibs();        // FIXME: Remove in 4.0.
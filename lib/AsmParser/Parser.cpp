@@ -22,20 +22,24 @@
 #include <cstring>
 using namespace llvm;
 
+// Out-of-line virtual method.
+ParsedFunctionListener::~ParsedFunctionListener() {}
+
 Module *llvm::ParseAssembly(MemoryBuffer *F,
                             Module *M,
                             SMDiagnostic &Err,
-                            LLVMContext &Context) {
+                            LLVMContext &Context,
+                            ParsedFunctionListener *Listener) {
   SourceMgr SM;
   SM.AddNewSourceBuffer(F, SMLoc());
 
   // If we are parsing into an existing module, do it.
   if (M)
-    return LLParser(F, SM, Err, M).Run() ? 0 : M;
+    return LLParser(F, SM, Err, M, Listener).Run() ? 0 : M;
 
   // Otherwise create a new module.
   OwningPtr<Module> M2(new Module(F->getBufferIdentifier(), Context));
-  if (LLParser(F, SM, Err, M2.get()).Run())
+  if (LLParser(F, SM, Err, M2.get(), Listener).Run())
     return 0;
   return M2.take();
 }
@@ -9,10 +9,12 @@
 
 #include "llvm/Bitcode/ReaderWriter.h"
 #include "BitcodeReader.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/AutoUpgrade.h"
 #include "llvm/Bitcode/LLVMBitCodes.h"
+#include "llvm/Bitcode/ModuleSummary.h"
 #include "llvm/IR/Constants.h"
 #include "llvm/IR/DerivedTypes.h"
 #include "llvm/IR/InlineAsm.h"
@@ -24,6 +26,7 @@
 #include "llvm/Support/DataStream.h"
 #include "llvm/Support/MathExtras.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/TimeProfiler.h"
 #include "llvm/Support/raw_ostream.h"
 using namespace llvm;
 
@@ -50,6 +53,7 @@ void BitcodeReader::FreeState() {
   std::vector<BasicBlock*>().swap(FunctionBBs);
   std::vector<Function*>().swap(FunctionsWithBodies);
   DeferredFunctionInfo.clear();
+  LastIndexedFunctionBit = 0;
   MDKindMap.clear();
 
   assert(BlockAddrFwdRefs.empty() && "Unresolved blockaddress fwd references");
@@ -990,7 +994,8 @@ error_code BitcodeReader::ParseMetadata() {
     bool IsFunctionLocal = false;
     // Read a record.
     Record.clear();
-    unsigned Code = Stream.readRecord(Entry.ID, Record);
+    StringRef Blob;
+    unsigned Code = Stream.readRecord(Entry.ID, Record, &Blob);
     switch (Code) {
     default:  // Default behavior: ignore.
       break;
@@ -1041,8 +1046,14 @@ error_code BitcodeReader::ParseMetadata() {
       break;
     }
     case bitc::METADATA_STRING: {
-      SmallString<8> String(Record.begin(), Record.end());
-      Value *V = MDString::get(Context, String);
+      // Current writers emit the characters as a blob, which points straight
+      // into the bitcode buffer.  Older ones used an array of characters.
+      Value *V;
+      if (Blob.data())
+        V = MDString::get(Context, Blob);
+      else
+        V = MDString::get(Context,
+                          SmallString<8>(Record.begin(), Record.end()).str());
       MDValueList.AssignValue(V, NextMDValueNo++);
       break;
     }
@@ -1640,6 +1651,7 @@ error_code BitcodeReader::GlobalCleanup() {
 }
 
 error_code BitcodeReader::ParseModule(bool Resume) {
+  TimeTraceScope TraceScope("Parse Bitcode Module");
   if (Resume)
     Stream.JumpToBit(NextUnreadBit);
   else if (Stream.EnterSubBlock(bitc::MODULE_BLOCK_ID))
@@ -1706,6 +1718,16 @@ error_code BitcodeReader::ParseModule(bool Resume) {
           SeenFirstFunctionBody = true;
         }
 
+        // If a function index told us where every body is, skip straight past
+        // the last one instead of walking each block.
+        if (LastIndexedFunctionBit) {
+          Stream.JumpToBit(LastIndexedFunctionBit);
+          LastIndexedFunctionBit = 0;
+          if (Stream.SkipBlock())
+            return Error(InvalidRecord);
+          break;
+        }
+
         if (error_code EC = RememberAndSkipFunctionBody())
           return EC;
         // For streaming bitcode, suspend parsing when we reach the function
@@ -1733,7 +1755,8 @@ error_code BitcodeReader::ParseModule(bool Resume) {
 
 
     // Read a record.
-    switch (Stream.readRecord(Entry.ID, Record)) {
+    StringRef Blob;
+    switch (Stream.readRecord(Entry.ID, Record, &Blob)) {
     default: break;  // Default behavior, ignore unknown content.
     case bitc::MODULE_CODE_VERSION: {  // VERSION: [version#]
       if (Record.size() < 1)
@@ -1928,11 +1951,49 @@ error_code BitcodeReader::ParseModule(bool Resume) {
         return Error(InvalidRecord);
       ValueList.shrinkTo(Record[0]);
       break;
+    // FNINDEX: [blob of 64-bit bit offsets]
+    case bitc::MODULE_CODE_FNINDEX:
+      if (error_code EC = ParseFunctionIndex(Blob))
+        return EC;
+      break;
     }
     Record.clear();
   }
 }
 
+/// ParseFunctionIndex - Record the body offsets listed in a MODULE_CODE_FNINDEX
+/// record, so that the function blocks themselves do not have to be scanned.
+/// The index is only an optimization: if it does not match the prototypes read
+/// so far, it is ignored and the bodies are discovered by scanning as usual.
+error_code BitcodeReader::ParseFunctionIndex(StringRef Blob) {
+  // Streamed bitcode cannot jump ahead of the bytes fetched so far.
+  if (LazyStreamer || SeenFirstFunctionBody)
+    return error_code::success();
+  if (Blob.size() != FunctionsWithBodies.size() * 8)
+    return error_code::success();
+
+  SmallVector<uint64_t, 64> Offsets;
+  const unsigned char *Data = (const unsigned char *)Blob.data();
+  for (unsigned i = 0, e = FunctionsWithBodies.size(); i != e; ++i) {
+    uint64_t Bit = 0;
+    for (unsigned Byte = 0; Byte != 8; ++Byte)
+      Bit |= uint64_t(Data[i * 8 + Byte]) << (Byte * 8);
+    // Bodies are written in order, after the index.  An index that says
+    // otherwise is ignored like any other mismatch.
+    if (Bit <= Stream.GetCurrentBitNo() ||
+        (!Offsets.empty() && Bit <= Offsets.back()) ||
+        !Stream.canSkipToPos(Bit / 8))
+      return error_code::success();
+    Offsets.push_back(Bit);
+  }
+
+  for (unsigned i = 0, e = Offsets.size(); i != e; ++i)
+    DeferredFunctionInfo[FunctionsWithBodies[i]] = Offsets[i];
+  LastIndexedFunctionBit = Offsets.empty() ? 0 : Offsets.back();
+  FunctionsWithBodies.clear();
+  return error_code::success();
+}
+
 error_code BitcodeReader::ParseBitcodeInto(Module *M) {
   TheModule = 0;
 
@@ -3065,6 +3126,7 @@ error_code BitcodeReader::Materialize(GlobalValue *GV) {
   if (!F || !F->isMaterializable())
     return error_code::success();
 
+  TimeTraceScope TraceScope("Materialize Function", F->getName());
   DenseMap<Function*, uint64_t>::iterator DFII = DeferredFunctionInfo.find(F);
   assert(DFII != DeferredFunctionInfo.end() && "Deferred function not found!");
   // If its position is recorded as 0, its body is somewhere in the stream
@@ -3080,6 +3142,14 @@ error_code BitcodeReader::Materialize(GlobalValue *GV) {
     return EC;
 
   // Upgrade any old intrinsic calls in the function.
+  UpgradeIntrinsicCalls();
+
+  return error_code::success();
+}
+
+/// UpgradeIntrinsicCalls - Rewrite every call to an old intrinsic that has
+/// been materialized so far to use its replacement.
+void BitcodeReader::UpgradeIntrinsicCalls() {
   for (UpgradedIntrinsicMap::iterator I = UpgradedIntrinsics.begin(),
        E = UpgradedIntrinsics.end(); I != E; ++I) {
     if (I->first != I->second) {
@@ -3090,8 +3160,6 @@ error_code BitcodeReader::Materialize(GlobalValue *GV) {
       }
     }
   }
-
-  return error_code::success();
 }
 
 bool BitcodeReader::isDematerializable(const GlobalValue *GV) const {
@@ -3117,14 +3185,31 @@ void BitcodeReader::Dematerialize(GlobalValue *GV) {
 error_code BitcodeReader::MaterializeModule(Module *M) {
   assert(M == TheModule &&
          "Can only Materialize the Module this BitcodeReader is attached to.");
-  // Iterate over the module, deserializing any functions that are still on
-  // disk.
+  TimeTraceScope TraceScope("Materialize Module", M->getModuleIdentifier());
+  // Collect the functions that are still on disk, along with the position of
+  // their bodies in the stream.
+  SmallVector<std::pair<uint64_t, Function*>, 64> Bodies;
   for (Module::iterator F = TheModule->begin(), E = TheModule->end();
        F != E; ++F) {
-    if (F->isMaterializable()) {
-      if (error_code EC = Materialize(F))
+    if (!F->isMaterializable())
+      continue;
+    DenseMap<Function*, uint64_t>::iterator DFII = DeferredFunctionInfo.find(F);
+    assert(DFII != DeferredFunctionInfo.end() && "Deferred function not found!");
+    if (DFII->second == 0 && LazyStreamer)
+      if (error_code EC = FindFunctionInStream(F, DFII))
         return EC;
-    }
+    Bodies.push_back(std::make_pair(DFII->second, (Function*)F));
+  }
+
+  // Deserialize the bodies in stream order so that the cursor only ever moves
+  // forward, even if the function list has been reordered since the module
+  // was written.  Calls to upgraded intrinsics are rewritten once, below,
+  // rather than rescanning every intrinsic's use list after each body.
+  array_pod_sort(Bodies.begin(), Bodies.end());
+  for (unsigned I = 0, E = Bodies.size(); I != E; ++I) {
+    Stream.JumpToBit(Bodies[I].first);
+    if (error_code EC = ParseFunctionBody(Bodies[I].second))
+      return EC;
   }
   // At this point, if there are any function bodies, the current bit is
   // pointing to the END_BLOCK record after them. Now make sure the rest
@@ -3351,3 +3436,131 @@ std::string llvm::getBitcodeTargetTriple(MemoryBuffer *Buffer,
   delete R;
   return Triple;
 }
+
+//===----------------------------------------------------------------------===//
+// Module summary reader
+//===----------------------------------------------------------------------===//
+
+static bool SummaryError(std::string *ErrMsg, const char *Message) {
+  if (ErrMsg)
+    *ErrMsg = Message;
+  return true;
+}
+
+/// ReadModuleSummaryBlock - Read the records of a MODULE_SUMMARY_BLOCK, which
+/// the cursor has just entered.  Returns true on error.
+static bool ReadModuleSummaryBlock(BitstreamCursor &Stream,
+                                   std::vector<BitcodeSummarySymbol> &Symbols,
+                                   std::string *ErrMsg) {
+  SmallVector<uint64_t, 64> Record;
+  while (1) {
+    BitstreamEntry Entry = Stream.advanceSkippingSubblocks();
+
+    switch (Entry.Kind) {
+    case BitstreamEntry::SubBlock: // Handled for us already.
+    case BitstreamEntry::Error:
+      return SummaryError(ErrMsg, "Malformed block");
+    case BitstreamEntry::EndBlock:
+      // Callees may refer to symbols that come later, so check them now.
+      for (unsigned i = 0, e = Symbols.size(); i != e; ++i)
+        for (unsigned j = 0, je = Symbols[i].Callees.size(); j != je; ++j)
+          if (Symbols[i].Callees[j] >= e)
+            return SummaryError(ErrMsg, "Invalid ID");
+      return false;
+    case BitstreamEntry::Record:
+      // The interesting case.
+      break;
+    }
+
+    Record.clear();
+    switch (Stream.readRecord(Entry.ID, Record)) {
+    default:  // Default behavior: ignore.
+      break;
+    case bitc::SUMMARY_CODE_SYMBOL: {
+      // SYMBOL: [kind, aliaseekind, isdefinition, linkage, visibility,
+      //          instcount, namechar x N]
+      if (Record.size() < 6 || Record[0] > BitcodeSummarySymbol::Unknown ||
+          Record[1] > BitcodeSummarySymbol::Unknown)
+        return SummaryError(ErrMsg, "Invalid record");
+      BitcodeSummarySymbol Sym;
+      Sym.Kind = BitcodeSummarySymbol::SymbolKind(Record[0]);
+      Sym.AliaseeKind = BitcodeSummarySymbol::SymbolKind(Record[1]);
+      Sym.IsDefinition = Record[2];
+      Sym.Linkage = GetDecodedLinkage(Record[3]);
+      Sym.Visibility = GetDecodedVisibility(Record[4]);
+      Sym.InstCount = Record[5];
+      if (ConvertToString(Record, 6, Sym.Name))
+        return SummaryError(ErrMsg, "Invalid record");
+      Symbols.push_back(Sym);
+      break;
+    }
+    case bitc::SUMMARY_CODE_CALLS:  // CALLS: [symbol# x N]
+      if (Symbols.empty())
+        return SummaryError(ErrMsg, "Invalid record");
+      Symbols.back().Callees.insert(Symbols.back().Callees.end(),
+                                    Record.begin(), Record.end());
+      break;
+    }
+  }
+}
+
+/// readBitcodeModuleSummary - Locate the module summary block and read it,
+/// skipping over everything else in the module without building any IR.
+bool llvm::readBitcodeModuleSummary(MemoryBuffer *Buffer,
+                                    std::vector<BitcodeSummarySymbol> &Symbols,
+                                    std::string *ErrMsg) {
+  Symbols.clear();
+  const unsigned char *BufPtr = (const unsigned char*)Buffer->getBufferStart();
+  const unsigned char *BufEnd = BufPtr+Buffer->getBufferSize();
+
+  if (isBitcodeWrapper(BufPtr, BufEnd))
+    if (SkipBitcodeWrapperHeader(BufPtr, BufEnd, true))
+      return SummaryError(ErrMsg, "Invalid bitcode wrapper header");
+  if (((BufEnd-BufPtr) & 3) || !isRawBitcode(BufPtr, BufEnd))
+    return SummaryError(ErrMsg, "Invalid bitcode signature");
+
+  BitstreamReader StreamFile(BufPtr, BufEnd);
+  BitstreamCursor Stream(StreamFile);
+
+  // Skip the magic number, which isRawBitcode has already checked.
+  Stream.JumpToBit(32);
+
+  // Find the module block.
+  while (1) {
+    if (Stream.AtEndOfStream())
+      return SummaryError(ErrMsg, "No module block");
+    BitstreamEntry Entry = Stream.advance();
+    if (Entry.Kind != BitstreamEntry::SubBlock)
+      return SummaryError(ErrMsg, "Malformed block");
+    if (Entry.ID == bitc::MODULE_BLOCK_ID)
+      break;
+    if (Stream.SkipBlock())
+      return SummaryError(ErrMsg, "Malformed block");
+  }
+  if (Stream.EnterSubBlock(bitc::MODULE_BLOCK_ID))
+    return SummaryError(ErrMsg, "Malformed block");
+
+  // The writer puts the summary at the start of the module block, but accept
+  // it anywhere at the top level of the module.
+  while (1) {
+    BitstreamEntry Entry = Stream.advance();
+    switch (Entry.Kind) {
+    case BitstreamEntry::Error:
+      return SummaryError(ErrMsg, "Malformed block");
+    case BitstreamEntry::EndBlock:
+      return SummaryError(ErrMsg, "No module summary");
+    case BitstreamEntry::SubBlock:
+      if (Entry.ID == bitc::MODULE_SUMMARY_BLOCK_ID) {
+        if (Stream.EnterSubBlock(bitc::MODULE_SUMMARY_BLOCK_ID))
+          return SummaryError(ErrMsg, "Malformed block");
+        return ReadModuleSummaryBlock(Stream, Symbols, ErrMsg);
+      }
+      if (Stream.SkipBlock())
+        return SummaryError(ErrMsg, "Malformed block");
+      break;
+    case BitstreamEntry::Record:
+      Stream.skipRecord(Entry.ID);
+      break;
+    }
+  }
+}
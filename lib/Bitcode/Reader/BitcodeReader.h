@@ -179,6 +179,12 @@ class BitcodeReader : public GVMaterializer {
   /// stream.
   DenseMap<Function*, uint64_t> DeferredFunctionInfo;
 
+  /// LastIndexedFunctionBit - If the module has a function index, this is the
+  /// position of the last function body it describes, and the index has been
+  /// used to populate DeferredFunctionInfo.  It is reset to zero once the
+  /// bodies have been skipped.
+  uint64_t LastIndexedFunctionBit;
+
   /// BlockAddrFwdRefs - These are blockaddr references to basic blocks.  These
   /// are resolved lazily when functions are loaded.
   typedef std::pair<unsigned, GlobalVariable*> BlockAddrRefTy;
@@ -227,13 +233,15 @@ public:
     : Context(C), TheModule(0), Buffer(buffer), BufferOwned(false),
       LazyStreamer(0), NextUnreadBit(0), SeenValueSymbolTable(false),
       ValueList(C), MDValueList(C),
-      SeenFirstFunctionBody(false), UseRelativeIDs(false) {
+      SeenFirstFunctionBody(false), LastIndexedFunctionBit(0),
+      UseRelativeIDs(false) {
   }
   explicit BitcodeReader(DataStreamer *streamer, LLVMContext &C)
     : Context(C), TheModule(0), Buffer(0), BufferOwned(false),
       LazyStreamer(streamer), NextUnreadBit(0), SeenValueSymbolTable(false),
       ValueList(C), MDValueList(C),
-      SeenFirstFunctionBody(false), UseRelativeIDs(false) {
+      SeenFirstFunctionBody(false), LastIndexedFunctionBit(0),
+      UseRelativeIDs(false) {
   }
   ~BitcodeReader() {
     FreeState();
@@ -355,6 +363,7 @@ private:
 
   error_code ParseValueSymbolTable();
   error_code ParseConstants();
+  error_code ParseFunctionIndex(StringRef Blob);
   error_code RememberAndSkipFunctionBody();
   error_code ParseFunctionBody(Function *F);
   error_code GlobalCleanup();
@@ -366,6 +375,7 @@ private:
   error_code InitStream();
   error_code InitStreamFromBuffer();
   error_code InitLazyStream();
+  void UpgradeIntrinsicCalls();
   error_code FindFunctionInStream(Function *F,
          DenseMap<Function*, uint64_t>::iterator DeferredFunctionInfoIterator);
 };
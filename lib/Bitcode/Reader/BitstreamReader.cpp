@@ -257,9 +257,19 @@ unsigned BitstreamCursor::readRecord(unsigned AbbrevID,
       break;
     }
 
-    // Otherwise, inform the streamer that we need these bytes in memory.
-    const char *Ptr = (const char*)
-      BitStream->getBitcodeBytes().getPointer(CurBitPos/8, NumElts);
+    // Streamed bytes can't be referenced in place, so copy them out.
+    if (!BitStream->getBufferStart()) {
+      for (uint64_t Pos = CurBitPos/8, End = Pos+NumElts; Pos != End; ++Pos) {
+        uint8_t Byte = 0;
+        BitStream->getBitcodeBytes().readByte(Pos, &Byte);
+        Vals.push_back(Byte);
+      }
+      JumpToBit(NewEnd);
+      continue;
+    }
+
+    // Otherwise, reference the data directly in the buffer.
+    const char *Ptr = (const char*)BitStream->getBufferStart() + CurBitPos/8;
 
     // If we can return a reference to the data, do so to avoid copying it.
     if (Blob) {
@@ -13,9 +13,11 @@
 
 #include "llvm/Bitcode/ReaderWriter.h"
 #include "ValueEnumerator.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/Triple.h"
 #include "llvm/Bitcode/BitstreamWriter.h"
 #include "llvm/Bitcode/LLVMBitCodes.h"
+#include "llvm/Bitcode/ModuleSummary.h"
 #include "llvm/IR/Constants.h"
 #include "llvm/IR/DerivedTypes.h"
 #include "llvm/IR/InlineAsm.h"
@@ -23,6 +25,7 @@
 #include "llvm/IR/Module.h"
 #include "llvm/IR/Operator.h"
 #include "llvm/IR/ValueSymbolTable.h"
+#include "llvm/Support/CallSite.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/MathExtras.h"
@@ -38,6 +41,18 @@ EnablePreserveUseListOrdering("enable-bc-uselist-preserve",
                                        "use-list order preservation."),
                               cl::init(false), cl::Hidden);
 
+static cl::opt<bool>
+EnableModuleSummary("bitcode-module-summary",
+                    cl::desc("Emit a summary of the module's global values "
+                             "that can be read without loading the IR."),
+                    cl::init(false), cl::Hidden);
+
+static cl::opt<bool>
+EnableFunctionIndex("bitcode-function-index",
+                    cl::desc("Emit an index of function body offsets so "
+                             "that lazy readers need not scan the module."),
+                    cl::init(false), cl::Hidden);
+
 /// These are manifest constants used by the bitcode writer. They do not need to
 /// be kept in sync with the reader, but need to be consistent within this file.
 enum {
@@ -735,21 +750,24 @@ static void WriteModuleMetadata(const Module *M,
     } else if (const MDString *MDS = dyn_cast<MDString>(Vals[i].first)) {
       if (!StartedMetadataBlock)  {
         Stream.EnterSubblock(bitc::METADATA_BLOCK_ID, 3);
+        StartedMetadataBlock = true;
+      }
 
-        // Abbrev for METADATA_STRING.
+      // Abbrev for METADATA_STRING, emitted before the first string even if
+      // nodes started the block.  The characters are emitted as a blob so
+      // that the reader can reference them in place.
+      if (!MDSAbbrev) {
         BitCodeAbbrev *Abbv = new BitCodeAbbrev();
         Abbv->Add(BitCodeAbbrevOp(bitc::METADATA_STRING));
-        Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Array));
-        Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed, 8));
+        Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Blob));
         MDSAbbrev = Stream.EmitAbbrev(Abbv);
-        StartedMetadataBlock = true;
       }
 
       // Code: [strchar x N]
-      Record.append(MDS->begin(), MDS->end());
+      Record.push_back(bitc::METADATA_STRING);
 
       // Emit the finished record.
-      Stream.EmitRecord(bitc::METADATA_STRING, Record, MDSAbbrev);
+      Stream.EmitRecordWithBlob(MDSAbbrev, Record, MDS->getString());
       Record.clear();
     }
   }
@@ -1880,8 +1898,111 @@ static void WriteModuleUseLists(const Module *M, ValueEnumerator &VE,
   Stream.ExitBlock();
 }
 
+/// WriteModuleSummarySymbol - Emit the SYMBOL record for GV, and for function
+/// definitions, the CALLS record listing its direct callees.
+static void WriteModuleSummarySymbol(const GlobalValue *GV,
+                          const DenseMap<const GlobalValue*, unsigned> &Index,
+                                     BitstreamWriter &Stream) {
+  typedef BitcodeSummarySymbol BSS;
+  SmallVector<unsigned, 64> Vals;
+  unsigned Kind = BSS::Unknown, AliaseeKind = BSS::Unknown;
+  if (isa<GlobalVariable>(GV))
+    Kind = BSS::Variable;
+  else if (isa<Function>(GV))
+    Kind = BSS::Function;
+  else if (const GlobalAlias *GA = dyn_cast<GlobalAlias>(GV)) {
+    Kind = BSS::Alias;
+    if (const GlobalValue *Aliasee = GA->getAliasedGlobal())
+      AliaseeKind = isa<Function>(Aliasee) ? BSS::Function : BSS::Variable;
+  }
+
+  const Function *F = dyn_cast<Function>(GV);
+  unsigned InstCount = 0;
+  SmallVector<unsigned, 16> Callees;
+  if (F && !F->isDeclaration()) {
+    SmallPtrSet<const GlobalValue*, 16> Seen;
+    for (Function::const_iterator BB = F->begin(), E = F->end(); BB != E; ++BB)
+      for (BasicBlock::const_iterator I = BB->begin(), IE = BB->end(); I != IE;
+           ++I) {
+        ++InstCount;
+        ImmutableCallSite CS(I);
+        if (!CS)
+          continue;
+        const GlobalValue *Callee =
+          dyn_cast<GlobalValue>(CS.getCalledValue()->stripPointerCasts());
+        if (Callee && Seen.insert(Callee))
+          Callees.push_back(Index.lookup(Callee));
+      }
+  }
+
+  // SYMBOL: [kind, aliaseekind, isdefinition, linkage, visibility, instcount,
+  //          namechar x N]
+  Vals.push_back(Kind);
+  Vals.push_back(AliaseeKind);
+  Vals.push_back(!GV->isDeclaration());
+  Vals.push_back(getEncodedLinkage(GV));
+  Vals.push_back(getEncodedVisibility(GV));
+  Vals.push_back(InstCount);
+  StringRef Name = GV->getName();
+  Vals.append(Name.begin(), Name.end());
+  Stream.EmitRecord(bitc::SUMMARY_CODE_SYMBOL, Vals);
+
+  // CALLS: [symbol# x N]
+  if (!Callees.empty())
+    Stream.EmitRecord(bitc::SUMMARY_CODE_CALLS, Callees);
+}
+
+/// WriteModuleSummary - Emit a MODULE_SUMMARY_BLOCK describing every global
+/// value in the module.  It is written at the very start of the module block
+/// so that readBitcodeModuleSummary finds it without skipping anything else.
+static void WriteModuleSummary(const Module *M, BitstreamWriter &Stream) {
+  // Number the symbols first so that calls can refer to any of them.
+  std::vector<const GlobalValue*> Symbols;
+  for (Module::const_global_iterator I = M->global_begin(),
+         E = M->global_end(); I != E; ++I)
+    Symbols.push_back(I);
+  for (Module::const_iterator I = M->begin(), E = M->end(); I != E; ++I)
+    Symbols.push_back(I);
+  for (Module::const_alias_iterator I = M->alias_begin(), E = M->alias_end();
+       I != E; ++I)
+    Symbols.push_back(I);
+
+  DenseMap<const GlobalValue*, unsigned> Index;
+  for (unsigned i = 0, e = Symbols.size(); i != e; ++i)
+    Index[Symbols[i]] = i;
+
+  Stream.EnterSubblock(bitc::MODULE_SUMMARY_BLOCK_ID, 3);
+  for (unsigned i = 0, e = Symbols.size(); i != e; ++i)
+    WriteModuleSummarySymbol(Symbols[i], Index, Stream);
+  Stream.ExitBlock();
+}
+
+/// WriteFunctionIndexPlaceholder - Emit a MODULE_CODE_FNINDEX record with room
+/// for one 64-bit offset per function body, and return the byte offset of the
+/// first entry so that it can be backpatched once the bodies are written.
+static uint64_t WriteFunctionIndexPlaceholder(unsigned NumBodies,
+                                              BitstreamWriter &Stream) {
+  BitCodeAbbrev *Abbv = new BitCodeAbbrev();
+  Abbv->Add(BitCodeAbbrevOp(bitc::MODULE_CODE_FNINDEX));
+  Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Blob));
+  unsigned FnIndexAbbrev = Stream.EmitAbbrev(Abbv);
+
+  SmallVector<uint64_t, 1> Vals;
+  Vals.push_back(bitc::MODULE_CODE_FNINDEX);
+  std::string Placeholder(NumBodies * 8, '\0');
+  Stream.EmitRecordWithBlob(FnIndexAbbrev, Vals, Placeholder);
+
+  // The blob is word aligned and a multiple of four bytes long, so it ends
+  // exactly at the current position.
+  return Stream.GetCurrentBitNo() / 8 - Placeholder.size();
+}
+
 /// WriteModule - Emit the specified module to the bitstream.
 static void WriteModule(const Module *M, BitstreamWriter &Stream) {
+  // Offsets in the function index are relative to the start of the bitcode,
+  // which is just before the magic number that precedes the module block.
+  uint64_t BitcodeStartBit = Stream.GetCurrentBitNo() - 32;
+
   Stream.EnterSubblock(bitc::MODULE_BLOCK_ID, 3);
 
   SmallVector<unsigned, 1> Vals;
@@ -1889,6 +2010,10 @@ static void WriteModule(const Module *M, BitstreamWriter &Stream) {
   Vals.push_back(CurVersion);
   Stream.EmitRecord(bitc::MODULE_CODE_VERSION, Vals);
 
+  // Emit the module summary, if requested.
+  if (EnableModuleSummary)
+    WriteModuleSummary(M, Stream);
+
   // Analyze the module, enumerating globals, functions, etc.
   ValueEnumerator VE(M);
 
@@ -1924,10 +2049,35 @@ static void WriteModule(const Module *M, BitstreamWriter &Stream) {
   if (EnablePreserveUseListOrdering)
     WriteModuleUseLists(M, VE, Stream);
 
-  // Emit function bodies.
+  // Emit the function index, if requested.  Its entries are filled in below,
+  // in the same order as the function bodies.
+  unsigned NumBodies = 0;
   for (Module::const_iterator F = M->begin(), E = M->end(); F != E; ++F)
     if (!F->isDeclaration())
-      WriteFunction(*F, VE, Stream);
+      ++NumBodies;
+  uint64_t FnIndexByte = 0;
+  if (EnableFunctionIndex && NumBodies)
+    FnIndexByte = WriteFunctionIndexPlaceholder(NumBodies, Stream);
+
+  // Emit function bodies.
+  for (Module::const_iterator F = M->begin(), E = M->end(); F != E; ++F) {
+    if (F->isDeclaration())
+      continue;
+    if (FnIndexByte) {
+      // Record the position the reader is at once it has read the
+      // ENTER_SUBBLOCK code and the block ID, which is where
+      // BitcodeReader::ParseFunctionBody expects to start.
+      assert(bitc::FUNCTION_BLOCK_ID < (1U << (bitc::BlockIDWidth - 1)) &&
+             "Block ID no longer fits in a single VBR chunk");
+      uint64_t BodyBit = Stream.GetCurrentBitNo() - BitcodeStartBit +
+                         Stream.getAbbrevIDWidth() + bitc::BlockIDWidth;
+      Stream.BackpatchWord((unsigned)FnIndexByte, (unsigned)BodyBit);
+      Stream.BackpatchWord((unsigned)FnIndexByte + 4,
+                           (unsigned)(BodyBit >> 32));
+      FnIndexByte += 8;
+    }
+    WriteFunction(*F, VE, Stream);
+  }
 
   Stream.ExitBlock();
 }
@@ -29,7 +29,8 @@ static bool isIntOrIntVectorValue(const std::pair<const Value*, unsigned> &V) {
 }
 
 /// ValueEnumerator - Enumerate module-level information.
-ValueEnumerator::ValueEnumerator(const Module *M) {
+ValueEnumerator::ValueEnumerator(const Module *M)
+  : IncorporatingFunction(false) {
   // Enumerate the global variables.
   for (Module::const_global_iterator I = M->global_begin(),
          E = M->global_end(); I != E; ++I)
@@ -125,22 +126,56 @@ void ValueEnumerator::setInstructionID(const Instruction *I) {
 }
 
 unsigned ValueEnumerator::getValueID(const Value *V) const {
-  if (isa<MDNode>(V) || isa<MDString>(V)) {
-    ValueMapType::const_iterator I = MDValueMap.find(V);
-    assert(I != MDValueMap.end() && "Value not in slotcalculator!");
-    return I->second-1;
+  bool IsMD = isa<MDNode>(V) || isa<MDString>(V);
+  const ValueMapType &Map = IsMD ? MDValueMap : ValueMap;
+
+  // Most operands inside a function are function-local, so look there first.
+  if (IncorporatingFunction) {
+    const ValueMapType &FnMap = IsMD ? FunctionMDValueMap : FunctionValueMap;
+    ValueMapType::const_iterator I = FnMap.find(V);
+    if (I != FnMap.end())
+      return I->second-1;
   }
 
-  ValueMapType::const_iterator I = ValueMap.find(V);
-  assert(I != ValueMap.end() && "Value not in slotcalculator!");
+  ValueMapType::const_iterator I = Map.find(V);
+  assert(I != Map.end() && "Value not in slotcalculator!");
   return I->second-1;
 }
 
+/// getValueSlot - Return a reference to the ID of V, which is zero if V has
+/// not been enumerated yet.  While a function is incorporated, values that are
+/// not already known at module level go in the function-local map.  The
+/// reference is invalidated by any later insertion.
+unsigned &ValueEnumerator::getValueSlot(const Value *V) {
+  if (!IncorporatingFunction)
+    return ValueMap[V];
+  ValueMapType::iterator I = ValueMap.find(V);
+  if (I != ValueMap.end())
+    return I->second;
+  return FunctionValueMap[V];
+}
+
+/// getMDValueSlot - Like getValueSlot, but for metadata.
+unsigned &ValueEnumerator::getMDValueSlot(const Value *MD) {
+  if (!IncorporatingFunction)
+    return MDValueMap[MD];
+  ValueMapType::iterator I = MDValueMap.find(MD);
+  if (I != MDValueMap.end())
+    return I->second;
+  return FunctionMDValueMap[MD];
+}
+
 void ValueEnumerator::dump() const {
   print(dbgs(), ValueMap, "Default");
   dbgs() << '\n';
   print(dbgs(), MDValueMap, "MetaData");
   dbgs() << '\n';
+  if (IncorporatingFunction) {
+    print(dbgs(), FunctionValueMap, "Function");
+    dbgs() << '\n';
+    print(dbgs(), FunctionMDValueMap, "FunctionMetaData");
+    dbgs() << '\n';
+  }
 }
 
 void ValueEnumerator::print(raw_ostream &OS, const ValueMapType &Map,
@@ -205,7 +240,7 @@ void ValueEnumerator::OptimizeConstants(unsigned CstStart, unsigned CstEnd) {
 
   // Rebuild the modified portion of ValueMap.
   for (; CstStart != CstEnd; ++CstStart)
-    ValueMap[Values[CstStart].first] = CstStart+1;
+    getValueSlot(Values[CstStart].first) = CstStart+1;
 }
 
 
@@ -260,7 +295,7 @@ void ValueEnumerator::EnumerateMetadata(const Value *MD) {
   }
 
   // Check to see if it's already in!
-  unsigned &MDValueID = MDValueMap[MD];
+  unsigned &MDValueID = getMDValueSlot(MD);
   if (MDValueID) {
     // Increment use count.
     MDValues[MDValueID-1].second++;
@@ -284,7 +319,7 @@ void ValueEnumerator::EnumerateFunctionLocalMetadata(const MDNode *N) {
   EnumerateType(N->getType());
 
   // Check to see if it's already in!
-  unsigned &MDValueID = MDValueMap[N];
+  unsigned &MDValueID = getMDValueSlot(N);
   if (MDValueID) {
     // Increment use count.
     MDValues[MDValueID-1].second++;
@@ -314,7 +349,7 @@ void ValueEnumerator::EnumerateValue(const Value *V) {
          "EnumerateValue doesn't handle Metadata!");
 
   // Check to see if it's already in!
-  unsigned &ValueID = ValueMap[V];
+  unsigned &ValueID = getValueSlot(V);
   if (ValueID) {
     // Increment use count.
     Values[ValueID-1].second++;
@@ -344,7 +379,7 @@ void ValueEnumerator::EnumerateValue(const Value *V) {
       // Finally, add the value.  Doing this could make the ValueID reference be
       // dangling, don't reuse it.
       Values.push_back(std::make_pair(V, 1U));
-      ValueMap[V] = Values.size();
+      getValueSlot(V) = Values.size();
       return;
     }
   }
@@ -446,6 +481,8 @@ void ValueEnumerator::EnumerateAttributes(AttributeSet PAL) {
 }
 
 void ValueEnumerator::incorporateFunction(const Function &F) {
+  assert(!IncorporatingFunction && "Function already incorporated!");
+  IncorporatingFunction = true;
   InstructionCount = 0;
   NumModuleValues = Values.size();
   NumModuleMDValues = MDValues.size();
@@ -467,7 +504,7 @@ void ValueEnumerator::incorporateFunction(const Function &F) {
           EnumerateValue(*OI);
       }
     BasicBlocks.push_back(BB);
-    ValueMap[BB] = BasicBlocks.size();
+    FunctionValueMap[BB] = BasicBlocks.size();
   }
 
   // Optimize the constant layout.
@@ -510,13 +547,11 @@ void ValueEnumerator::incorporateFunction(const Function &F) {
 }
 
 void ValueEnumerator::purgeFunction() {
-  /// Remove purged values from the ValueMap.
-  for (unsigned i = NumModuleValues, e = Values.size(); i != e; ++i)
-    ValueMap.erase(Values[i].first);
-  for (unsigned i = NumModuleMDValues, e = MDValues.size(); i != e; ++i)
-    MDValueMap.erase(MDValues[i].first);
-  for (unsigned i = 0, e = BasicBlocks.size(); i != e; ++i)
-    ValueMap.erase(BasicBlocks[i]);
+  /// Everything added since incorporateFunction lives in the function-local
+  /// maps, so the module-level maps need no cleanup.
+  FunctionValueMap.clear();
+  FunctionMDValueMap.clear();
+  IncorporatingFunction = false;
 
   Values.resize(NumModuleValues);
   MDValues.resize(NumModuleMDValues);
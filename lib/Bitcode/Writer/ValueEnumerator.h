@@ -52,6 +52,18 @@ private:
   SmallVector<const MDNode *, 8> FunctionLocalMDs;
   ValueMapType MDValueMap;
 
+  /// FunctionValueMap/FunctionMDValueMap - While a function is incorporated,
+  /// the IDs of its arguments, constants, instructions, basic blocks and
+  /// function-local metadata live here rather than in ValueMap/MDValueMap.
+  /// This leaves the module-level maps untouched while functions are written,
+  /// and lets purgeFunction drop the function's entries all at once.
+  ValueMapType FunctionValueMap;
+  ValueMapType FunctionMDValueMap;
+
+  /// IncorporatingFunction - True between incorporateFunction and
+  /// purgeFunction.
+  bool IncorporatingFunction;
+
   typedef DenseMap<AttributeSet, unsigned> AttributeGroupMapType;
   AttributeGroupMapType AttributeGroupMap;
   std::vector<AttributeSet> AttributeGroups;
@@ -153,6 +165,9 @@ public:
 private:
   void OptimizeConstants(unsigned CstStart, unsigned CstEnd);
 
+  unsigned &getValueSlot(const Value *V);
+  unsigned &getMDValueSlot(const Value *MD);
+
   void EnumerateMDNodeOperands(const MDNode *N);
   void EnumerateMetadata(const Value *MD);
   void EnumerateFunctionLocalMetadata(const MDNode *N);
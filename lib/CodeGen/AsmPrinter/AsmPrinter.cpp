@@ -40,6 +40,7 @@
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/Format.h"
 #include "llvm/Support/MathExtras.h"
+#include "llvm/Support/TimeProfiler.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Target/Mangler.h"
 #include "llvm/Target/TargetFrameLowering.h"
@@ -319,6 +320,7 @@ void AsmPrinter::EmitGlobalVariable(const GlobalVariable *GV) {
   for (unsigned I = 0, E = Handlers.size(); I != E; ++I) {
     const HandlerInfo &OI = Handlers[I];
     NamedRegionTimer T(OI.TimerName, OI.TimerGroupName, TimePassesIsEnabled);
+    TimeTraceScope TraceScope(OI.TimerName);
     OI.Handler->setSymbolSize(GVSym, Size);
   }
 
@@ -493,6 +495,7 @@ void AsmPrinter::EmitFunctionHeader() {
   for (unsigned I = 0, E = Handlers.size(); I != E; ++I) {
     const HandlerInfo &OI = Handlers[I];
     NamedRegionTimer T(OI.TimerName, OI.TimerGroupName, TimePassesIsEnabled);
+    TimeTraceScope TraceScope(OI.TimerName);
     OI.Handler->beginFunction(MF);
   }
 
@@ -690,6 +693,8 @@ void AsmPrinter::emitPrologLabel(const MachineInstr &MI) {
 /// EmitFunctionBody - This method emits the body and trailer for a
 /// function.
 void AsmPrinter::EmitFunctionBody() {
+  TimeTraceScope TraceScope("Emit Function Body", MF->getName());
+
   // Emit target-specific gunk before the function body.
   EmitFunctionBodyStart();
 
@@ -823,6 +828,7 @@ void AsmPrinter::EmitFunctionBody() {
   for (unsigned I = 0, E = Handlers.size(); I != E; ++I) {
     const HandlerInfo &OI = Handlers[I];
     NamedRegionTimer T(OI.TimerName, OI.TimerGroupName, TimePassesIsEnabled);
+    TimeTraceScope TraceScope(OI.TimerName);
     OI.Handler->endFunction(MF);
   }
   MMI->EndFunction();
@@ -884,6 +890,8 @@ void AsmPrinter::EmitDwarfRegOp(const MachineLocation &MLoc,
 }
 
 bool AsmPrinter::doFinalization(Module &M) {
+  TimeTraceScope TraceScope("AsmPrinter Finalization");
+
   // Emit global variables.
   for (Module::const_global_iterator I = M.global_begin(), E = M.global_end();
        I != E; ++I)
@@ -916,6 +924,7 @@ bool AsmPrinter::doFinalization(Module &M) {
     const HandlerInfo &OI = Handlers[I];
     NamedRegionTimer T(OI.TimerName, OI.TimerGroupName,
                        TimePassesIsEnabled);
+    TimeTraceScope TraceScope(OI.TimerName);
     OI.Handler->endModule();
     delete OI.Handler;
   }
@@ -2386,6 +2386,23 @@ static dwarf::PubIndexEntryDescriptor computeIndexValue(DwarfUnit *CU,
   }
 }
 
+typedef StringMapEntry<const DIE *> PubEntry;
+
+static bool comparePubEntries(const PubEntry *A, const PubEntry *B) {
+  return A->getKey() < B->getKey();
+}
+
+/// getSortedPubEntries - Return the entries of a public names or types table
+/// sorted by name, so the sections do not depend on StringMap's hash.
+static void getSortedPubEntries(const StringMap<const DIE *> &Globals,
+                                SmallVectorImpl<const PubEntry *> &Entries) {
+  for (StringMap<const DIE *>::const_iterator GI = Globals.begin(),
+                                              GE = Globals.end();
+       GI != GE; ++GI)
+    Entries.push_back(&*GI);
+  std::sort(Entries.begin(), Entries.end(), comparePubEntries);
+}
+
 /// emitDebugPubNames - Emit visible names into a debug pubnames section.
 ///
 void DwarfDebug::emitDebugPubNames(bool GnuStyle) {
@@ -2424,12 +2441,11 @@ void DwarfDebug::emitDebugPubNames(bool GnuStyle) {
     Asm->EmitLabelDifference(TheU->getLabelEnd(), TheU->getLabelBegin(), 4);
 
     // Emit the pubnames for this compilation unit.
-    const StringMap<const DIE *> &Globals = getUnits()[ID]->getGlobalNames();
-    for (StringMap<const DIE *>::const_iterator GI = Globals.begin(),
-                                                GE = Globals.end();
-         GI != GE; ++GI) {
-      const char *Name = GI->getKeyData();
-      const DIE *Entity = GI->second;
+    SmallVector<const PubEntry *, 64> Globals;
+    getSortedPubEntries(getUnits()[ID]->getGlobalNames(), Globals);
+    for (unsigned GI = 0, GE = Globals.size(); GI != GE; ++GI) {
+      const char *Name = Globals[GI]->getKeyData();
+      const DIE *Entity = Globals[GI]->second;
 
       Asm->OutStreamer.AddComment("DIE offset");
       Asm->EmitInt32(Entity->getOffset());
@@ -2443,7 +2459,8 @@ void DwarfDebug::emitDebugPubNames(bool GnuStyle) {
       }
 
       Asm->OutStreamer.AddComment("External Name");
-      Asm->OutStreamer.EmitBytes(StringRef(Name, GI->getKeyLength() + 1));
+      Asm->OutStreamer.EmitBytes(
+          StringRef(Name, Globals[GI]->getKeyLength() + 1));
     }
 
     Asm->OutStreamer.AddComment("End Mark");
@@ -2488,12 +2505,11 @@ void DwarfDebug::emitDebugPubTypes(bool GnuStyle) {
     Asm->EmitLabelDifference(TheU->getLabelEnd(), TheU->getLabelBegin(), 4);
 
     // Emit the pubtypes.
-    const StringMap<const DIE *> &Globals = getUnits()[ID]->getGlobalTypes();
-    for (StringMap<const DIE *>::const_iterator GI = Globals.begin(),
-                                                GE = Globals.end();
-         GI != GE; ++GI) {
-      const char *Name = GI->getKeyData();
-      const DIE *Entity = GI->second;
+    SmallVector<const PubEntry *, 64> Globals;
+    getSortedPubEntries(getUnits()[ID]->getGlobalTypes(), Globals);
+    for (unsigned GI = 0, GE = Globals.size(); GI != GE; ++GI) {
+      const char *Name = Globals[GI]->getKeyData();
+      const DIE *Entity = Globals[GI]->second;
 
       Asm->OutStreamer.AddComment("DIE offset");
       Asm->EmitInt32(Entity->getOffset());
@@ -2509,7 +2525,8 @@ void DwarfDebug::emitDebugPubTypes(bool GnuStyle) {
       Asm->OutStreamer.AddComment("External Name");
 
       // Emit the name with a terminating null byte.
-      Asm->OutStreamer.EmitBytes(StringRef(Name, GI->getKeyLength() + 1));
+      Asm->OutStreamer.EmitBytes(
+          StringRef(Name, Globals[GI]->getKeyLength() + 1));
     }
 
     Asm->OutStreamer.AddComment("End Mark");
@@ -109,6 +109,10 @@ public:
   virtual unsigned getMemoryOpCost(unsigned Opcode, Type *Src,
                                    unsigned Alignment,
                                    unsigned AddressSpace) const;
+  virtual unsigned getInterleavedMemoryOpCost(unsigned Opcode, Type *VecTy,
+                                              unsigned Factor,
+                                              unsigned Alignment,
+                                              unsigned AddressSpace) const;
   virtual unsigned getIntrinsicInstrCost(Intrinsic::ID, Type *RetTy,
                                          ArrayRef<Type*> Tys) const;
   virtual unsigned getNumberOfParts(Type *Tp) const;
@@ -422,6 +426,33 @@ unsigned BasicTTI::getMemoryOpCost(unsigned Opcode, Type *Src,
   return LT.first;
 }
 
+unsigned BasicTTI::getInterleavedMemoryOpCost(unsigned Opcode, Type *VecTy,
+                                              unsigned Factor,
+                                              unsigned Alignment,
+                                              unsigned AddressSpace) const {
+  VectorType *VT = cast<VectorType>(VecTy);
+  unsigned NumElts = VT->getNumElements();
+  assert(Factor > 1 && NumElts % Factor == 0 && "Invalid interleave factor");
+  VectorType *SubVT = VectorType::get(VT->getElementType(), NumElts / Factor);
+
+  // One wide access for the whole group.
+  unsigned Cost = TopTTI->getMemoryOpCost(Opcode, VecTy, Alignment,
+                                          AddressSpace);
+
+  // Without better knowledge, assume every element is moved individually
+  // between the wide vector and the vector of its member.
+  bool IsLoad = Opcode == Instruction::Load;
+  for (unsigned i = 0; i < NumElts; ++i) {
+    Cost += TopTTI->getVectorInstrCost(Instruction::ExtractElement,
+                                       IsLoad ? VT : SubVT,
+                                       IsLoad ? i : i / Factor);
+    Cost += TopTTI->getVectorInstrCost(Instruction::InsertElement,
+                                       IsLoad ? SubVT : VT,
+                                       IsLoad ? i / Factor : i);
+  }
+  return Cost;
+}
+
 unsigned BasicTTI::getIntrinsicInstrCost(Intrinsic::ID IID, Type *RetTy,
                                          ArrayRef<Type *> Tys) const {
   unsigned ISD = 0;
@@ -42,6 +42,7 @@ STATISTIC(NumDeadBlocks, "Number of dead blocks removed");
 STATISTIC(NumBranchOpts, "Number of branches optimized");
 STATISTIC(NumTailMerge , "Number of block tails merged");
 STATISTIC(NumHoist     , "Number of times common instructions are hoisted");
+STATISTIC(NumTailCompareSkips, "Number of tail comparisons ruled out by hash");
 
 static cl::opt<cl::boolOrDefault> FlagEnableTailMerge("enable-tail-merge",
                               cl::init(cl::BOU_UNSET), cl::Hidden);
@@ -252,6 +253,15 @@ bool BranchFolder::OptimizeFunction(MachineFunction &MF,
 //===----------------------------------------------------------------------===//
 //  Tail Merging of Blocks
 //===----------------------------------------------------------------------===//
+//
+// Tail merging is the only place where the code generator shares repeated
+// machine instruction sequences, and it only works within one function.
+// Outlining sequences that repeat across functions into new functions does
+// not fit the current pipeline. Each MachineFunction is created by
+// MachineFunctionAnalysis for an IR Function, one function at a time. A
+// machine-level outliner could neither see the whole module nor create the
+// functions it outlines to. Code that is flash bound should rely on
+// -tail-merge-size and on IR-level merging of identical functions.
 
 /// HashMachineInstr - Compute a hash value for MI and its operands.
 static unsigned HashMachineInstr(const MachineInstr *MI) {
@@ -303,6 +313,25 @@ static unsigned HashEndOfMBB(const MachineBasicBlock *MBB) {
   return HashMachineInstr(I);
 }
 
+/// HashTailOfMBB - Hash the last Len non-debug instructions in the MBB.  Return
+/// false if the MBB has fewer than Len of them.  Two blocks that end with Len
+/// identical instructions get the same hash.
+static bool HashTailOfMBB(const MachineBasicBlock *MBB, unsigned Len,
+                          unsigned &Hash) {
+  Hash = 0;
+  MachineBasicBlock::const_iterator I = MBB->end();
+  while (Len) {
+    if (I == MBB->begin())
+      return false;
+    --I;
+    if (I->isDebugValue())
+      continue;
+    Hash = Hash * 37 + HashMachineInstr(I);
+    --Len;
+  }
+  return true;
+}
+
 /// ComputeCommonTailLength - Given two machine basic blocks, compute the number
 /// of instructions they actually have in common together at their end.  Return
 /// iterators for the first shared instruction in each block.
@@ -599,6 +628,36 @@ unsigned BranchFolder::ComputeSameTails(unsigned CurHash,
                                         MachineBasicBlock *PredBB) {
   unsigned maxCommonTailLength = 0U;
   SameTails.clear();
+
+  // Blocks sharing only the last instruction can be numerous, for example all
+  // the returns of a large function, and comparing every pair of them is
+  // quadratic in the block sizes.  Unless a pair is one of the special cases
+  // in ProfitableToMerge, its common tail must be at least MinTail
+  // instructions long, so a cheap hash of that many instructions rules most
+  // pairs out without walking both blocks.
+  unsigned MinTail = minCommonTailLength;
+  if (MinTail > 2 && MergePotentials.back().getBlock()->getParent()->
+        getFunction()->getAttributes().
+          hasAttribute(AttributeSet::FunctionIndex, Attribute::OptimizeForSize))
+    MinTail = 2;
+  // An unconditional branch stripped from both blocks counts as common.
+  if (SuccBB && MinTail > 0)
+    --MinTail;
+
+  MPIterator GroupBegin = MergePotentials.end();
+  while (GroupBegin != MergePotentials.begin() &&
+         prior(GroupBegin)->getHash() == CurHash)
+    --GroupBegin;
+  SmallVector<unsigned, 16> TailHashes;
+  SmallVector<bool, 16> HasTail;
+  if (MinTail > 1) {
+    for (MPIterator I = GroupBegin, E = MergePotentials.end(); I != E; ++I) {
+      unsigned Hash;
+      HasTail.push_back(HashTailOfMBB(I->getBlock(), MinTail, Hash));
+      TailHashes.push_back(Hash);
+    }
+  }
+
   MachineBasicBlock::iterator TrialBBI1, TrialBBI2;
   MPIterator HighestMPIter = prior(MergePotentials.end());
   for (MPIterator CurMPIter = prior(MergePotentials.end()),
@@ -607,7 +666,19 @@ unsigned BranchFolder::ComputeSameTails(unsigned CurHash,
        --CurMPIter) {
     for (MPIterator I = prior(CurMPIter); I->getHash() == CurHash ; --I) {
       unsigned CommonTailLen;
-      if (ProfitableToMerge(CurMPIter->getBlock(), I->getBlock(),
+      MachineBasicBlock *MBB1 = CurMPIter->getBlock();
+      MachineBasicBlock *MBB2 = I->getBlock();
+      bool MayMerge = true;
+      if (!TailHashes.empty() && MBB1 != PredBB && MBB2 != PredBB &&
+          !MBB1->isLayoutSuccessor(MBB2) && !MBB2->isLayoutSuccessor(MBB1)) {
+        unsigned Idx1 = CurMPIter - GroupBegin, Idx2 = I - GroupBegin;
+        MayMerge = HasTail[Idx1] && HasTail[Idx2] &&
+                   TailHashes[Idx1] == TailHashes[Idx2];
+        if (!MayMerge)
+          ++NumTailCompareSkips;
+      }
+      if (MayMerge &&
+          ProfitableToMerge(CurMPIter->getBlock(), I->getBlock(),
                             minCommonTailLength,
                             CommonTailLen, TrialBBI1, TrialBBI2,
                             SuccBB, PredBB)) {
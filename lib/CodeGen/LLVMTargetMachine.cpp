@@ -13,6 +13,7 @@
 
 #include "llvm/Target/TargetMachine.h"
 #include "llvm/ADT/OwningPtr.h"
+#include "llvm/ADT/Triple.h"
 #include "llvm/Assembly/PrintModulePass.h"
 #include "llvm/CodeGen/AsmPrinter.h"
 #include "llvm/CodeGen/MachineFunctionAnalysis.h"
@@ -142,6 +143,16 @@ bool LLVMTargetMachine::addPassesToEmitFile(PassManagerBase &PM,
                                             bool DisableVerify,
                                             AnalysisID StartAfter,
                                             AnalysisID StopAfter) {
+  // The whole pipeline, from ISel through the AsmPrinter, runs one function at
+  // a time on the calling thread.  It cannot be split across threads per
+  // function.  The machine passes share one MCContext, which owns every
+  // symbol, section and temporary label.  They also share the TargetMachine's
+  // subtarget state and the LLVMContext, and none of these are thread-safe.
+  // MachineModuleInfo is module-wide mutable state too.  Codegen that runs in
+  // parallel has to partition the module, give each partition its own
+  // context and target machine, and link the resulting objects, which is what
+  // LTOCodeGenerator::compile_to_files does.
+  //
   // Add common CodeGen passes.
   MCContext *Context = addPassesToGenerateCode(this, PM, DisableVerify,
                                                StartAfter, StopAfter);
@@ -192,6 +203,10 @@ bool LLVMTargetMachine::addPassesToEmitFile(PassManagerBase &PM,
     break;
   }
   case CGFT_ObjectFile: {
+    // The ELF writer never needs the names of temporary labels.
+    if (Triple(getTargetTriple()).isOSBinFormatELF())
+      Context->setUseNamesForTempLabels(false);
+
     // Create the code emitter for the target if it exists.  If not, .o file
     // emission fails.
     MCCodeEmitter *MCE = getTarget().createMCCodeEmitter(MII, MRI, STI,
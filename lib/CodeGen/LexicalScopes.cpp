@@ -36,6 +36,37 @@ void LexicalScopes::reset() {
   DeleteContainerSeconds(AbstractScopeMap);
   InlinedLexicalScopeMap.clear();
   AbstractScopesList.clear();
+  for (unsigned i = 0, e = CachedScopeIdxs.size(); i != e; ++i) {
+    int Idx = CachedScopeIdxs[i];
+    if (Idx > 0)
+      ScopeCache[Idx] = NULL;
+    else
+      InlinedScopeCache[-Idx] = NULL;
+  }
+  CachedScopeIdxs.clear();
+}
+
+/// getCachedScope - Return the scope found for the scope index of DL, or NULL
+/// if there is none yet.
+LexicalScope *LexicalScopes::getCachedScope(DebugLoc DL) const {
+  int Idx = DL.getScopeIdx();
+  if (Idx > 0)
+    return unsigned(Idx) < ScopeCache.size() ? ScopeCache[Idx] : NULL;
+  return unsigned(-Idx) < InlinedScopeCache.size() ? InlinedScopeCache[-Idx]
+                                                   : NULL;
+}
+
+/// setCachedScope - Remember the scope of the scope index of DL.
+void LexicalScopes::setCachedScope(DebugLoc DL, LexicalScope *Scope) {
+  int Idx = DL.getScopeIdx();
+  assert(Idx != 0 && "Unknown locations have no scope!");
+  std::vector<LexicalScope *> &Cache = Idx > 0 ? ScopeCache : InlinedScopeCache;
+  unsigned Slot = Idx > 0 ? Idx : -Idx;
+  if (Slot >= Cache.size())
+    Cache.resize(Slot + 1);
+  if (!Cache[Slot])
+    CachedScopeIdxs.push_back(Idx);
+  Cache[Slot] = Scope;
 }
 
 /// initialize - Scan machine function and constuct lexical scope nest.
@@ -113,6 +144,10 @@ void LexicalScopes::extractLexicalScopes(
 /// findLexicalScope - Find lexical scope, either regular or inlined, for the
 /// given DebugLoc. Return NULL if not found.
 LexicalScope *LexicalScopes::findLexicalScope(DebugLoc DL) {
+  // All the locations with the same scope index share their lexical scope.
+  if (LexicalScope *Cached = getCachedScope(DL))
+    return Cached;
+
   MDNode *Scope = NULL;
   MDNode *IA = NULL;
   DL.getScopeAndInlinedAt(Scope, IA, MF->getFunction()->getContext());
@@ -125,26 +160,36 @@ LexicalScope *LexicalScopes::findLexicalScope(DebugLoc DL) {
   if (D.isLexicalBlockFile())
     Scope = DILexicalBlockFile(Scope).getScope();
 
-  if (IA)
-    return InlinedLexicalScopeMap.lookup(DebugLoc::getFromDILocation(IA));
-  return LexicalScopeMap.lookup(Scope);
+  LexicalScope *Result =
+      IA ? InlinedLexicalScopeMap.lookup(DebugLoc::getFromDILocation(IA))
+         : LexicalScopeMap.lookup(Scope);
+  if (Result)
+    setCachedScope(DL, Result);
+  return Result;
 }
 
 /// getOrCreateLexicalScope - Find lexical scope for the given DebugLoc. If
 /// not available then create new lexical scope.
 LexicalScope *LexicalScopes::getOrCreateLexicalScope(DebugLoc DL) {
+  if (LexicalScope *Cached = getCachedScope(DL))
+    return Cached;
+
   MDNode *Scope = NULL;
   MDNode *InlinedAt = NULL;
   DL.getScopeAndInlinedAt(Scope, InlinedAt, MF->getFunction()->getContext());
 
+  LexicalScope *Result;
   if (InlinedAt) {
     // Create an abstract scope for inlined function.
     getOrCreateAbstractScope(Scope);
     // Create an inlined scope for inlined function.
-    return getOrCreateInlinedScope(Scope, InlinedAt);
+    Result = getOrCreateInlinedScope(Scope, InlinedAt);
+  } else {
+    Result = getOrCreateRegularScope(Scope);
   }
-
-  return getOrCreateRegularScope(Scope);
+  if (!DL.isUnknown())
+    setCachedScope(DL, Result);
+  return Result;
 }
 
 /// getOrCreateRegularScope - Find or create a regular lexical scope.
@@ -47,7 +47,16 @@ static cl::opt<bool>
 EnableLDV("live-debug-variables", cl::init(true),
           cl::desc("Enable the live debug variables pass"), cl::Hidden);
 
+static cl::opt<unsigned>
+ExtendBlockLimit("live-debug-variables-block-limit", cl::init(10000),
+                 cl::desc("Maximum number of blocks the locations of a single "
+                          "variable are extended into (0 = unlimited)"),
+                 cl::Hidden);
+
 STATISTIC(NumInsertedDebugValues, "Number of DBG_VALUEs inserted");
+STATISTIC(NumCoalescedDebugValues, "Number of redundant DBG_VALUEs coalesced");
+STATISTIC(NumLimitedUserValues,
+          "Number of variables whose ranges hit the block limit");
 char LiveDebugVariables::ID = 0;
 
 INITIALIZE_PASS_BEGIN(LiveDebugVariables, "livedebugvars",
@@ -225,11 +234,19 @@ public:
   /// @param Kills Append end points of VNI's live range to Kills.
   /// @param LIS   Live intervals analysis.
   /// @param MDT   Dominator tree.
+  /// @param Budget Number of blocks the definition may still be extended
+  ///               into from other blocks, decremented per block visited.
   void extendDef(SlotIndex Idx, unsigned LocNo,
                  LiveRange *LR, const VNInfo *VNI,
                  SmallVectorImpl<SlotIndex> *Kills,
                  LiveIntervals &LIS, MachineDominatorTree &MDT,
-                 UserValueScopes &UVS);
+                 UserValueScopes &UVS, unsigned &Budget);
+
+  /// coalesceDefs - Erase the defs that repeat the location of the previous
+  /// def in the same block while that location still holds the same value.
+  /// Extending the previous def covers them.
+  void coalesceDefs(MachineRegisterInfo &MRI, const TargetRegisterInfo &TRI,
+                    LiveIntervals &LIS);
 
   /// addDefsFromCopies - The value in LI/LocNo may be copies to other
   /// registers. Determine if any of the copies are available at the kill
@@ -498,7 +515,7 @@ void UserValue::extendDef(SlotIndex Idx, unsigned LocNo,
                           LiveRange *LR, const VNInfo *VNI,
                           SmallVectorImpl<SlotIndex> *Kills,
                           LiveIntervals &LIS, MachineDominatorTree &MDT,
-                          UserValueScopes &UVS) {
+                          UserValueScopes &UVS, unsigned &Budget) {
   SmallVector<SlotIndex, 16> Todo;
   Todo.push_back(Idx);
   do {
@@ -542,19 +559,63 @@ void UserValue::extendDef(SlotIndex Idx, unsigned LocNo,
 
     I.insert(Start, Stop, LocNo);
 
-    // If we extended to the MBB end, propagate down the dominator tree.
-    if (!ToEnd)
+    // If we extended to the MBB end, propagate down the dominator tree, as
+    // long as the budget allows.
+    if (!ToEnd || Budget == 0)
       continue;
     const std::vector<MachineDomTreeNode*> &Children =
       MDT.getNode(MBB)->getChildren();
     for (unsigned i = 0, e = Children.size(); i != e; ++i) {
       MachineBasicBlock *MBB = Children[i]->getBlock();
-      if (UVS.dominates(MBB))
+      if (Budget && UVS.dominates(MBB)) {
         Todo.push_back(LIS.getMBBStartIdx(MBB));
+        --Budget;
+      }
     }
   } while (!Todo.empty());
 }
 
+/// getLocValue - Return the value that the register location Loc holds at
+/// Idx, or null if it is not a register or its value is unknown.
+static const VNInfo *getLocValue(const MachineOperand &Loc, SlotIndex Idx,
+                                 MachineRegisterInfo &MRI,
+                                 const TargetRegisterInfo &TRI,
+                                 LiveIntervals &LIS) {
+  if (!Loc.isReg() || !Loc.getReg())
+    return 0;
+  if (TargetRegisterInfo::isVirtualRegister(Loc.getReg())) {
+    if (!LIS.hasInterval(Loc.getReg()) &&
+        (!LIS.computesVirtRegsLazily() || MRI.reg_nodbg_empty(Loc.getReg())))
+      return 0;
+    return LIS.getInterval(Loc.getReg()).getVNInfoAt(Idx);
+  }
+  unsigned Unit = *MCRegUnitIterator(Loc.getReg(), &TRI);
+  return LIS.getRegUnit(Unit).getVNInfoAt(Idx);
+}
+
+void UserValue::coalesceDefs(MachineRegisterInfo &MRI,
+                             const TargetRegisterInfo &TRI,
+                             LiveIntervals &LIS) {
+  MachineBasicBlock *PrevMBB = 0;
+  unsigned PrevLocNo = ~0u;
+  const VNInfo *PrevVNI = 0;
+  for (LocMap::iterator I = locInts.begin(); I.valid();) {
+    MachineBasicBlock *MBB = LIS.getMBBFromIndex(I.start());
+    unsigned LocNo = I.value();
+    const VNInfo *VNI = LocNo == ~0u ? 0 :
+      getLocValue(locations[LocNo], I.start(), MRI, TRI, LIS);
+    if (MBB == PrevMBB && LocNo == PrevLocNo && VNI == PrevVNI) {
+      I.erase();
+      ++NumCoalescedDebugValues;
+      continue;
+    }
+    PrevMBB = MBB;
+    PrevLocNo = LocNo;
+    PrevVNI = VNI;
+    ++I;
+  }
+}
+
 void
 UserValue::addDefsFromCopies(LiveInterval *LI, unsigned LocNo,
                       const SmallVectorImpl<SlotIndex> &Kills,
@@ -591,7 +652,8 @@ UserValue::addDefsFromCopies(LiveInterval *LI, unsigned LocNo,
     if (!I.valid() || I.value() != LocNo)
       continue;
 
-    if (!LIS.hasInterval(DstReg))
+    if (!LIS.hasInterval(DstReg) &&
+        (!LIS.computesVirtRegsLazily() || MRI.reg_nodbg_empty(DstReg)))
       continue;
     LiveInterval *DstLI = &LIS.getInterval(DstReg);
     const VNInfo *DstVNI = DstLI->getVNInfoAt(Idx.getRegSlot());
@@ -636,6 +698,11 @@ UserValue::computeIntervals(MachineRegisterInfo &MRI,
                             UserValueScopes &UVS) {
   SmallVector<std::pair<SlotIndex, unsigned>, 16> Defs;
 
+  // Drop the defs that would not change the location before extending, large
+  // functions are full of them after inlining and unrolling.
+  coalesceDefs(MRI, TRI, LIS);
+  unsigned Budget = ExtendBlockLimit ? unsigned(ExtendBlockLimit) : ~0u;
+
   // Collect all defs to be extended (Skipping undefs).
   for (LocMap::const_iterator I = locInts.begin(); I.valid(); ++I)
     if (I.value() != ~0u)
@@ -648,7 +715,7 @@ UserValue::computeIntervals(MachineRegisterInfo &MRI,
     const MachineOperand &Loc = locations[LocNo];
 
     if (!Loc.isReg()) {
-      extendDef(Idx, LocNo, 0, 0, 0, LIS, MDT, UVS);
+      extendDef(Idx, LocNo, 0, 0, 0, LIS, MDT, UVS, Budget);
       continue;
     }
 
@@ -656,12 +723,14 @@ UserValue::computeIntervals(MachineRegisterInfo &MRI,
     if (TargetRegisterInfo::isVirtualRegister(Loc.getReg())) {
       LiveInterval *LI = 0;
       const VNInfo *VNI = 0;
-      if (LIS.hasInterval(Loc.getReg())) {
+      if (LIS.hasInterval(Loc.getReg()) ||
+          (LIS.computesVirtRegsLazily() &&
+           !MRI.reg_nodbg_empty(Loc.getReg()))) {
         LI = &LIS.getInterval(Loc.getReg());
         VNI = LI->getVNInfoAt(Idx);
       }
       SmallVector<SlotIndex, 16> Kills;
-      extendDef(Idx, LocNo, LI, VNI, &Kills, LIS, MDT, UVS);
+      extendDef(Idx, LocNo, LI, VNI, &Kills, LIS, MDT, UVS, Budget);
       if (LI)
         addDefsFromCopies(LI, LocNo, Kills, Defs, MRI, LIS);
       continue;
@@ -672,8 +741,10 @@ UserValue::computeIntervals(MachineRegisterInfo &MRI,
     LiveRange *LR = &LIS.getRegUnit(Unit);
     const VNInfo *VNI = LR->getVNInfoAt(Idx);
     // Don't track copies from physregs, it is too expensive.
-    extendDef(Idx, LocNo, LR, VNI, 0, LIS, MDT, UVS);
+    extendDef(Idx, LocNo, LR, VNI, 0, LIS, MDT, UVS, Budget);
   }
+  if (Budget == 0)
+    ++NumLimitedUserValues;
 
   // Finally, erase all the undefs.
   for (LocMap::iterator I = locInts.begin(); I.valid();)
@@ -20,6 +20,7 @@
 #include "LiveRangeCalc.h"
 #include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/Analysis/AliasAnalysis.h"
 #include "llvm/CodeGen/LiveVariables.h"
 #include "llvm/CodeGen/MachineBlockFrequencyInfo.h"
@@ -53,6 +54,13 @@ INITIALIZE_PASS_DEPENDENCY(SlotIndexes)
 INITIALIZE_PASS_END(LiveIntervals, "liveintervals",
                 "Live Interval Analysis", false, false)
 
+STATISTIC(NumVirtRegs, "Number of virtual registers with defs or uses");
+STATISTIC(NumVirtRegIntervals, "Number of virtual register intervals computed");
+
+static cl::opt<bool> LazyVirtRegIntervals(
+  "lazy-live-intervals", cl::Hidden, cl::init(false),
+  cl::desc("Compute virtual register live intervals on first use"));
+
 #ifndef NDEBUG
 static cl::opt<bool> EnablePrecomputePhysRegs(
   "precompute-phys-liveness", cl::Hidden,
@@ -79,7 +87,7 @@ void LiveIntervals::getAnalysisUsage(AnalysisUsage &AU) const {
 }
 
 LiveIntervals::LiveIntervals() : MachineFunctionPass(ID),
-  DomTree(0), LRCalc(0) {
+  DomTree(0), LRCalc(0), LazyVirtRegs(false) {
   initializeLiveIntervalsPass(*PassRegistry::getPassRegistry());
 }
 
@@ -121,7 +129,16 @@ bool LiveIntervals::runOnMachineFunction(MachineFunction &fn) {
   // Allocate space for all virtual registers.
   VirtRegIntervals.resize(MRI->getNumVirtRegs());
 
-  computeVirtRegs();
+  // Most virtual registers are local to a block and some are never queried
+  // before they are rewritten, so the lazy mode leaves each interval to its
+  // first getInterval() call.
+  LazyVirtRegs = LazyVirtRegIntervals;
+  if (!LazyVirtRegs)
+    computeVirtRegs();
+  else if (AreStatisticsEnabled())
+    for (unsigned i = 0, e = MRI->getNumVirtRegs(); i != e; ++i)
+      if (!MRI->reg_nodbg_empty(TargetRegisterInfo::index2VirtReg(i)))
+        ++NumVirtRegs;
   computeRegMasks();
   computeLiveInRegUnits();
 
@@ -182,6 +199,7 @@ LiveInterval* LiveIntervals::createInterval(unsigned reg) {
 void LiveIntervals::computeVirtRegInterval(LiveInterval &LI) {
   assert(LRCalc && "LRCalc not initialized.");
   assert(LI.empty() && "Should only compute empty intervals.");
+  ++NumVirtRegIntervals;
   LRCalc->reset(MF, getSlotIndexes(), DomTree, &getVNInfoAllocator());
   LRCalc->createDeadDefs(LI);
   LRCalc->extendToUses(LI);
@@ -192,6 +210,7 @@ void LiveIntervals::computeVirtRegs() {
     unsigned Reg = TargetRegisterInfo::index2VirtReg(i);
     if (MRI->reg_nodbg_empty(Reg))
       continue;
+    ++NumVirtRegs;
     createAndComputeVirtRegInterval(Reg);
   }
 }
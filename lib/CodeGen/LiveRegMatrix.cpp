@@ -27,6 +27,7 @@ using namespace llvm;
 
 STATISTIC(NumAssigned   , "Number of registers assigned");
 STATISTIC(NumUnassigned , "Number of registers unassigned");
+STATISTIC(NumRegUnitCached, "Number of regunit interference checks cached");
 
 char LiveRegMatrix::ID = 0;
 INITIALIZE_PASS_BEGIN(LiveRegMatrix, "liveregmatrix",
@@ -37,7 +38,8 @@ INITIALIZE_PASS_END(LiveRegMatrix, "liveregmatrix",
                     "Live Register Matrix", false, false)
 
 LiveRegMatrix::LiveRegMatrix() : MachineFunctionPass(ID),
-  UserTag(0), RegMaskTag(0), RegMaskVirtReg(0) {}
+  UserTag(0), RegMaskTag(0), RegMaskVirtReg(0), RegUnitTag(0),
+  RegUnitVirtReg(0) {}
 
 void LiveRegMatrix::getAnalysisUsage(AnalysisUsage &AU) const {
   AU.setPreservesAll();
@@ -118,11 +120,29 @@ bool LiveRegMatrix::checkRegUnitInterference(LiveInterval &VirtReg,
                                              unsigned PhysReg) {
   if (VirtReg.empty())
     return false;
+
+  // The allocators check each PhysReg more than once for the same VirtReg,
+  // e.g. when trying to assign and then to evict, so remember the answers.
+  if (RegUnitVirtReg != VirtReg.reg || RegUnitTag != UserTag) {
+    RegUnitVirtReg = VirtReg.reg;
+    RegUnitTag = UserTag;
+    RegUnitChecked.clear();
+    RegUnitChecked.resize(TRI->getNumRegs());
+    RegUnitInterferes.clear();
+    RegUnitInterferes.resize(TRI->getNumRegs());
+  } else if (RegUnitChecked.test(PhysReg)) {
+    ++NumRegUnitCached;
+    return RegUnitInterferes.test(PhysReg);
+  }
+  RegUnitChecked.set(PhysReg);
+
   CoalescerPair CP(VirtReg.reg, PhysReg, *TRI);
   for (MCRegUnitIterator Units(PhysReg, TRI); Units.isValid(); ++Units) {
     const LiveRange &UnitRange = LIS->getRegUnit(*Units);
-    if (VirtReg.overlaps(UnitRange, CP, *LIS->getSlotIndexes()))
+    if (VirtReg.overlaps(UnitRange, CP, *LIS->getSlotIndexes())) {
+      RegUnitInterferes.set(PhysReg);
       return true;
+    }
   }
   return false;
 }
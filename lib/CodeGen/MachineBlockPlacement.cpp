@@ -52,6 +52,7 @@ STATISTIC(CondBranchTakenFreq,
           "Potential frequency of taking conditional branches");
 STATISTIC(UncondBranchTakenFreq,
           "Potential frequency of taking unconditional branches");
+STATISTIC(NumColdBlocksSunk, "Number of cold blocks moved to the function end");
 
 static cl::opt<unsigned> AlignAllBlock("align-all-blocks",
                                        cl::desc("Force the alignment of all "
@@ -65,6 +66,16 @@ ExitBlockBias("block-placement-exit-block-bias",
                        "over the original exit to be considered the new exit."),
               cl::init(0), cl::Hidden);
 
+// Keeping cold blocks out of the hot path's cache lines and pages is worth an
+// extra branch on the way into them.  The MC layer cannot emit a function into
+// two sections, so the cold blocks are moved to the end of the function.
+static cl::opt<unsigned>
+ColdBlockPercent("block-placement-cold-percent",
+                 cl::desc("Move blocks executed less than this percentage of "
+                          "the entry block's frequency to the end of the "
+                          "function (0 = disabled)."),
+                 cl::init(0), cl::Hidden);
+
 namespace {
 class BlockChain;
 /// \brief Type for our function-wide basic block -> block chain mapping.
@@ -229,6 +240,7 @@ class MachineBlockPlacement : public MachineFunctionPass {
   void buildLoopChains(MachineFunction &F, MachineLoop &L);
   void rotateLoop(BlockChain &LoopChain, MachineBasicBlock *ExitingBB,
                   const BlockFilterSet &LoopBlockSet);
+  void sinkColdBlocks(MachineFunction &F, BlockChain &FunctionChain);
   void buildCFGChains(MachineFunction &F);
 
 public:
@@ -886,6 +898,49 @@ void MachineBlockPlacement::buildLoopChains(MachineFunction &F,
   });
 }
 
+namespace {
+/// \brief Predicate for blocks that stay in the hot part of the function.
+struct IsHotBlock {
+  const MachineBlockFrequencyInfo *MBFI;
+  BlockFrequency Threshold;
+  IsHotBlock(const MachineBlockFrequencyInfo *MBFI, BlockFrequency Threshold)
+    : MBFI(MBFI), Threshold(Threshold) {}
+  bool operator()(MachineBasicBlock *BB) const {
+    return !(MBFI->getBlockFreq(BB) < Threshold);
+  }
+};
+}
+
+/// \brief Move cold blocks after all the hot blocks of the function.
+///
+/// The relative order of the hot blocks, and of the cold blocks, is kept. This
+/// is only done when the terminator of every block with successors can be
+/// analyzed, as the blocks on either side of a moved block may need their
+/// branches rewritten.  Returns and other blocks that leave the function need
+/// no branches wherever they go.
+void MachineBlockPlacement::sinkColdBlocks(MachineFunction &F,
+                                           BlockChain &FunctionChain) {
+  SmallVector<MachineOperand, 4> Cond; // For AnalyzeBranch.
+  for (MachineFunction::iterator FI = F.begin(), FE = F.end(); FI != FE; ++FI) {
+    Cond.clear();
+    MachineBasicBlock *TBB = 0, *FBB = 0; // For AnalyzeBranch.
+    if (!FI->succ_empty() && TII->AnalyzeBranch(*FI, TBB, FBB, Cond))
+      return;
+  }
+
+  BlockFrequency Threshold =
+    MBFI->getBlockFreq(&F.front()) * BranchProbability(ColdBlockPercent, 100);
+  // The entry block always stays first.
+  BlockChain::iterator FirstCold =
+    std::stable_partition(llvm::next(FunctionChain.begin()),
+                          FunctionChain.end(), IsHotBlock(MBFI, Threshold));
+  for (BlockChain::iterator BI = FirstCold, BE = FunctionChain.end(); BI != BE;
+       ++BI) {
+    DEBUG(dbgs() << "Sinking cold block " << getBlockName(*BI) << "\n");
+    ++NumColdBlocksSunk;
+  }
+}
+
 void MachineBlockPlacement::buildCFGChains(MachineFunction &F) {
   // Ensure that every BB in the function has an associated chain to simplify
   // the assumptions of the remaining algorithm.
@@ -980,6 +1035,9 @@ void MachineBlockPlacement::buildCFGChains(MachineFunction &F) {
     assert(!BadFunc && "Detected problems with the block placement.");
   });
 
+  if (ColdBlockPercent)
+    sinkColdBlocks(F, FunctionChain);
+
   // Splice the blocks into place.
   MachineFunction::iterator InsertPos = F.begin();
   for (BlockChain::iterator BI = FunctionChain.begin(),
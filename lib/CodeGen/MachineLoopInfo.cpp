@@ -46,6 +46,22 @@ void MachineLoopInfo::getAnalysisUsage(AnalysisUsage &AU) const {
   MachineFunctionPass::getAnalysisUsage(AU);
 }
 
+static void collectInnermostLoops(MachineLoop *L,
+                                  SmallVectorImpl<MachineLoop*> &Loops) {
+  if (L->empty()) {
+    Loops.push_back(L);
+    return;
+  }
+  for (MachineLoop::iterator I = L->begin(), E = L->end(); I != E; ++I)
+    collectInnermostLoops(*I, Loops);
+}
+
+void MachineLoopInfo::
+getInnermostLoops(SmallVectorImpl<MachineLoop*> &Loops) const {
+  for (iterator I = begin(), E = end(); I != E; ++I)
+    collectInnermostLoops(*I, Loops);
+}
+
 MachineBasicBlock *MachineLoop::getTopBlock() {
   MachineBasicBlock *TopMBB = getHeader();
   MachineFunction::iterator Begin = TopMBB->getParent()->begin();
@@ -1300,3 +1300,92 @@ void MachineTraceMetrics::Trace::print(raw_ostream &OS) const {
   }
   OS << '\n';
 }
+
+//===----------------------------------------------------------------------===//
+//                            Loop Trace Report
+//===----------------------------------------------------------------------===//
+//
+// The loop trace report prints the trace metrics of every innermost loop, as
+// a quick way to tell whether a hot loop is bound by its critical path or by
+// the execution resources it uses.
+
+namespace {
+class MachineLoopTraceReport : public MachineFunctionPass {
+public:
+  static char ID; // Pass identification, replacement for typeid
+  MachineLoopTraceReport() : MachineFunctionPass(ID) {
+    initializeMachineLoopTraceReportPass(*PassRegistry::getPassRegistry());
+  }
+
+  bool runOnMachineFunction(MachineFunction &MF);
+
+  void getAnalysisUsage(AnalysisUsage &AU) const {
+    AU.addRequired<MachineLoopInfo>();
+    AU.addRequired<MachineTraceMetrics>();
+    AU.setPreservesAll();
+    MachineFunctionPass::getAnalysisUsage(AU);
+  }
+};
+}
+
+char MachineLoopTraceReport::ID = 0;
+char &llvm::MachineLoopTraceReportID = MachineLoopTraceReport::ID;
+INITIALIZE_PASS_BEGIN(MachineLoopTraceReport, "machine-loop-trace-report",
+                      "Machine Loop Trace Report", false, true)
+INITIALIZE_PASS_DEPENDENCY(MachineLoopInfo)
+INITIALIZE_PASS_DEPENDENCY(MachineTraceMetrics)
+INITIALIZE_PASS_END(MachineLoopTraceReport, "machine-loop-trace-report",
+                    "Machine Loop Trace Report", false, true)
+
+bool MachineLoopTraceReport::runOnMachineFunction(MachineFunction &MF) {
+  MachineLoopInfo &MLI = getAnalysis<MachineLoopInfo>();
+  MachineTraceMetrics &MTM = getAnalysis<MachineTraceMetrics>();
+  MachineTraceMetrics::Ensemble *MinInstr =
+    MTM.getEnsemble(MachineTraceMetrics::TS_MinInstrCount);
+
+  const TargetSubtargetInfo &ST =
+    MF.getTarget().getSubtarget<TargetSubtargetInfo>();
+  TargetSchedModel SchedModel;
+  SchedModel.init(*ST.getSchedModel(), &ST, MF.getTarget().getInstrInfo());
+  unsigned Kinds = SchedModel.getNumProcResourceKinds();
+  unsigned Factor = SchedModel.getLatencyFactor();
+
+  SmallVector<MachineLoop*, 8> Loops;
+  MLI.getInnermostLoops(Loops);
+
+  for (unsigned i = 0, e = Loops.size(); i != e; ++i) {
+    MachineLoop *L = Loops[i];
+    const MachineBasicBlock *Header = L->getHeader();
+    // The trace through the header stays inside the loop and does not follow
+    // the back-edge, so it covers one iteration.
+    MachineTraceMetrics::Trace T = MinInstr->getTrace(Header);
+    unsigned CritPath = T.getCriticalPath();
+    unsigned ResLength = T.getResourceLength();
+    dbgs() << "Loop trace report for BB#" << Header->getNumber()
+           << " in '" << MF.getName() << "' (depth " << L->getLoopDepth()
+           << ", " << L->getNumBlocks() << " blocks):\n"
+           << "  instructions: " << T.getInstrCount() << '\n'
+           << "  critical path: " << CritPath << " cycles\n"
+           << "  resource length: " << ResLength << " cycles\n"
+           << "  bound: " << (CritPath > ResLength ? "latency" : "resources")
+           << '\n';
+
+    if (!SchedModel.hasInstrSchedModel())
+      continue;
+
+    // Resource use by all blocks in the loop, not just those on the trace.
+    SmallVector<unsigned, 16> Cycles(Kinds, 0);
+    for (MachineLoop::block_iterator BI = L->block_begin(),
+         BE = L->block_end(); BI != BE; ++BI) {
+      MTM.getResources(*BI);
+      ArrayRef<unsigned> PRCycles = MTM.getProcResourceCycles((*BI)->getNumber());
+      for (unsigned K = 0; K != Kinds; ++K)
+        Cycles[K] += PRCycles[K];
+    }
+    for (unsigned K = 1; K != Kinds; ++K)
+      if (Cycles[K])
+        dbgs() << "  " << SchedModel.getProcResource(K)->Name << ": "
+               << (Cycles[K] + Factor - 1) / Factor << " cycles\n";
+  }
+  return false;
+}
@@ -23,11 +23,14 @@
 // the verifier errors.
 //===----------------------------------------------------------------------===//
 
+#define DEBUG_TYPE "machine-verifier"
 #include "llvm/CodeGen/Passes.h"
 #include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/DepthFirstIterator.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/SetOperations.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/CodeGen/LiveIntervalAnalysis.h"
 #include "llvm/CodeGen/LiveStackAnalysis.h"
 #include "llvm/CodeGen/LiveVariables.h"
@@ -40,6 +43,7 @@
 #include "llvm/IR/InlineAsm.h"
 #include "llvm/IR/Instructions.h"
 #include "llvm/MC/MCAsmInfo.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/raw_ostream.h"
@@ -48,6 +52,14 @@
 #include "llvm/Target/TargetRegisterInfo.h"
 using namespace llvm;
 
+STATISTIC(NumVerified, "Number of machine functions verified");
+STATISTIC(NumSkipped, "Number of unchanged machine functions not verified");
+
+static cl::opt<bool>
+VerifyIncremental("verify-machineinstrs-incremental", cl::Hidden,
+  cl::desc("Only verify machine functions that changed since they last "
+           "verified without errors"));
+
 namespace {
   struct MachineVerifier {
 
@@ -235,6 +247,8 @@ namespace {
     void verifyLiveRange(const LiveRange&, unsigned);
 
     void verifyStackFrame();
+
+    hash_code fingerprint() const;
   };
 
   struct MachineVerifierPass : public MachineFunctionPass {
@@ -272,6 +286,58 @@ void MachineFunction::verify(Pass *p, const char *Banner) const {
     .runOnMachineFunction(const_cast<MachineFunction&>(*this));
 }
 
+static hash_code hashLiveRange(hash_code H, const LiveRange &LR,
+                               SlotIndex Zero) {
+  for (LiveRange::const_iterator I = LR.begin(), E = LR.end(); I != E; ++I)
+    H = hash_combine(H, Zero.distance(I->start), Zero.distance(I->end),
+                     I->valno->id);
+  return hash_combine(H, LR.getNumValNums());
+}
+
+/// fingerprint - Hash everything the verifier looks at: the code, the CFG,
+/// the virtual register classes, and the live intervals and stack slot
+/// intervals if they are available.  Operand flags are included, as
+/// hash_value(MachineOperand) leaves them out.
+hash_code MachineVerifier::fingerprint() const {
+  hash_code H = hash_combine(LiveInts != 0, LiveStks != 0, Indexes != 0,
+                             MF->getFrameInfo()->getObjectIndexEnd());
+  // Live ranges can only be present together with the slot indexes.
+  SlotIndex Zero = Indexes ? Indexes->getZeroIndex() : SlotIndex();
+  for (MachineFunction::const_iterator MFI = MF->begin(), MFE = MF->end();
+       MFI != MFE; ++MFI) {
+    H = hash_combine(H, &*MFI, MFI->getNumber(), MFI->isLandingPad());
+    if (Indexes)
+      H = hash_combine(H, Zero.distance(Indexes->getMBBStartIdx(MFI)));
+    H = hash_combine(H, hash_combine_range(MFI->succ_begin(), MFI->succ_end()));
+    H = hash_combine(H, hash_combine_range(MFI->livein_begin(),
+                                           MFI->livein_end()));
+    for (MachineBasicBlock::const_instr_iterator MBBI = MFI->instr_begin(),
+           MBBE = MFI->instr_end(); MBBI != MBBE; ++MBBI) {
+      H = hash_combine(H, MBBI->getOpcode(), MBBI->getFlags(),
+                       MBBI->memoperands_end() - MBBI->memoperands_begin());
+      for (unsigned I = 0, E = MBBI->getNumOperands(); I != E; ++I) {
+        const MachineOperand &MO = MBBI->getOperand(I);
+        H = hash_combine(H, MO);
+        if (MO.isReg())
+          H = hash_combine(H, MO.isImplicit(), MO.isKill(), MO.isDead(),
+                           hash_combine(MO.isUndef(), MO.isEarlyClobber(),
+                                        MO.isInternalRead()));
+      }
+    }
+  }
+  for (unsigned I = 0, E = MRI->getNumVirtRegs(); I != E; ++I) {
+    unsigned Reg = TargetRegisterInfo::index2VirtReg(I);
+    H = hash_combine(H, MRI->getRegClass(Reg));
+    if (LiveInts && LiveInts->hasInterval(Reg))
+      H = hashLiveRange(hash_combine(H, Reg), LiveInts->getInterval(Reg), Zero);
+  }
+  if (LiveStks)
+    for (LiveStacks::const_iterator I = LiveStks->begin(),
+         E = LiveStks->end(); I != E; ++I)
+      H = hashLiveRange(hash_combine(H, I->first), I->second, Zero);
+  return H;
+}
+
 bool MachineVerifier::runOnMachineFunction(MachineFunction &MF) {
   raw_ostream *OutFile = 0;
   if (OutFileName) {
@@ -308,6 +374,20 @@ bool MachineVerifier::runOnMachineFunction(MachineFunction &MF) {
     Indexes = PASS->getAnalysisIfAvailable<SlotIndexes>();
   }
 
+  // With -verify-machineinstrs-incremental, skip functions that are exactly
+  // as they were when they last verified cleanly.  LiveVariables has no
+  // cheap fingerprint, so functions are always verified while it is live.
+  size_t Fingerprint = 0;
+  if (VerifyIncremental && !LiveVars) {
+    Fingerprint = fingerprint();
+    if (MF.getVerifiedFingerprint() == Fingerprint) {
+      ++NumSkipped;
+      delete OutFile;
+      return false;
+    }
+  }
+  ++NumVerified;
+
   visitMachineFunctionBefore();
   for (MachineFunction::const_iterator MFI = MF.begin(), MFE = MF.end();
        MFI!=MFE; ++MFI) {
@@ -362,6 +442,9 @@ bool MachineVerifier::runOnMachineFunction(MachineFunction &MF) {
   else if (foundErrors)
     report_fatal_error("Found "+Twine(foundErrors)+" machine code errors.");
 
+  if (VerifyIncremental && !LiveVars && !foundErrors)
+    MF.setVerifiedFingerprint(Fingerprint);
+
   // Clean up.
   regsLive.clear();
   regsDefined.clear();
@@ -1038,7 +1121,8 @@ void MachineVerifier::checkLiveness(const MachineOperand *MO, unsigned MONum) {
             report("Live range continues after kill flag", MO, MONum);
             *OS << "Live range: " << LI << '\n';
           }
-        } else {
+        } else if (!LiveInts->computesVirtRegsLazily()) {
+          // With lazy intervals, a register is only computed when queried.
           report("Virtual register has no live interval", MO, MONum);
         }
       }
@@ -1104,7 +1188,7 @@ void MachineVerifier::checkLiveness(const MachineOperand *MO, unsigned MONum) {
             *OS << "Live range: " << LI << '\n';
           }
         }
-      } else {
+      } else if (!LiveInts->computesVirtRegsLazily()) {
         report("Virtual register has no Live interval", MO, MONum);
       }
     }
@@ -1338,6 +1422,9 @@ void MachineVerifier::verifyLiveIntervals() {
       continue;
 
     if (!LiveInts->hasInterval(Reg)) {
+      // Not queried yet; it will be computed from the current code.
+      if (LiveInts->computesVirtRegsLazily())
+        continue;
       report("Missing live interval for virtual register", MF);
       *OS << PrintReg(Reg, TRI) << " still has defs or uses\n";
       continue;
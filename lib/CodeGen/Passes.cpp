@@ -47,6 +47,8 @@ static cl::opt<bool> DisableBlockPlacement("disable-block-placement",
     cl::Hidden, cl::desc("Disable probability-driven block placement"));
 static cl::opt<bool> EnableBlockPlacementStats("enable-block-placement-stats",
     cl::Hidden, cl::desc("Collect probability-driven block placement stats"));
+static cl::opt<bool> LoopTraceReport("loop-trace-report", cl::Hidden,
+    cl::desc("Print the critical path and resource use of innermost loops"));
 static cl::opt<bool> DisableSSC("disable-ssc", cl::Hidden,
     cl::desc("Disable Stack Slot Coloring"));
 static cl::opt<bool> DisableMachineDCE("disable-machine-dce", cl::Hidden,
@@ -595,6 +597,10 @@ void TargetPassConfig::addMachineSSAOptimization() {
 
   addPass(&PeepholeOptimizerID);
   printAndVerify("After codegen peephole optimization pass");
+
+  // Report on the loops as they are handed to the register allocator.
+  if (LoopTraceReport)
+    addPass(&MachineLoopTraceReportID);
 }
 
 //===---------------------------------------------------------------------===//
@@ -22,6 +22,7 @@
 #include "llvm/Analysis/AliasAnalysis.h"
 #include "llvm/CodeGen/LiveIntervalAnalysis.h"
 #include "llvm/CodeGen/LiveRangeEdit.h"
+#include "llvm/CodeGen/MachineBlockFrequencyInfo.h"
 #include "llvm/CodeGen/MachineFrameInfo.h"
 #include "llvm/CodeGen/MachineInstr.h"
 #include "llvm/CodeGen/MachineLoopInfo.h"
@@ -51,6 +52,7 @@ STATISTIC(NumReMats   , "Number of instructions re-materialized");
 STATISTIC(NumInflated , "Number of register classes inflated");
 STATISTIC(NumLaneConflicts, "Number of dead lane conflicts tested");
 STATISTIC(NumLaneResolves,  "Number of dead lane conflicts resolved");
+STATISTIC(NumJoinsSkipped,  "Number of copies skipped by the join budget");
 
 static cl::opt<bool>
 EnableJoining("join-liveintervals",
@@ -68,6 +70,19 @@ EnableGlobalCopies("join-globalcopies",
   cl::desc("Coalesce copies that span blocks (default=subtarget)"),
   cl::init(cl::BOU_UNSET), cl::Hidden);
 
+// Within a loop depth, visit hotter blocks first so their copies are joined
+// while the live ranges are still short.
+static cl::opt<bool>
+JoinByFrequency("join-by-frequency",
+  cl::desc("Coalesce copies in hotter blocks first"), cl::Hidden);
+
+// Bound the compile time spent on very large functions.  Copies are visited
+// hottest first, so the copies left alone are the cold ones.
+static cl::opt<unsigned>
+JoinBudget("join-budget",
+  cl::desc("Max copies to try joining per function (0 = no limit)"),
+  cl::init(0), cl::Hidden);
+
 static cl::opt<bool>
 VerifyCoalescing("verify-coalescing",
          cl::desc("Verify machine instrs before and after register coalescing"),
@@ -83,6 +98,7 @@ namespace {
     const TargetInstrInfo* TII;
     LiveIntervals *LIS;
     const MachineLoopInfo* Loops;
+    const MachineBlockFrequencyInfo *MBFI;
     AliasAnalysis *AA;
     RegisterClassInfo RegClassInfo;
 
@@ -94,6 +110,10 @@ namespace {
     /// blocks exclusively containing copies.
     bool JoinSplitEdges;
 
+    /// \brief Number of copies joinCopy() has been asked to join so far in
+    /// this function, checked against JoinBudget.
+    unsigned JoinAttempts;
+
     /// WorkList - Copy instructions yet to be coalesced.
     SmallVector<MachineInstr*, 8> WorkList;
     SmallVector<MachineInstr*, 8> LocalWorkList;
@@ -207,6 +227,7 @@ INITIALIZE_PASS_BEGIN(RegisterCoalescer, "simple-register-coalescing",
 INITIALIZE_PASS_DEPENDENCY(LiveIntervals)
 INITIALIZE_PASS_DEPENDENCY(SlotIndexes)
 INITIALIZE_PASS_DEPENDENCY(MachineLoopInfo)
+INITIALIZE_PASS_DEPENDENCY(MachineBlockFrequencyInfo)
 INITIALIZE_AG_DEPENDENCY(AliasAnalysis)
 INITIALIZE_PASS_END(RegisterCoalescer, "simple-register-coalescing",
                     "Simple Register Coalescing", false, false)
@@ -393,6 +414,10 @@ void RegisterCoalescer::getAnalysisUsage(AnalysisUsage &AU) const {
   AU.addPreserved<SlotIndexes>();
   AU.addRequired<MachineLoopInfo>();
   AU.addPreserved<MachineLoopInfo>();
+  if (JoinByFrequency) {
+    AU.addRequired<MachineBlockFrequencyInfo>();
+    AU.addPreserved<MachineBlockFrequencyInfo>();
+  }
   AU.addPreservedID(MachineDominatorsID);
   MachineFunctionPass::getAnalysisUsage(AU);
 }
@@ -2031,15 +2056,18 @@ namespace {
 struct MBBPriorityInfo {
   MachineBasicBlock *MBB;
   unsigned Depth;
+  uint64_t Freq;
   bool IsSplit;
 
-  MBBPriorityInfo(MachineBasicBlock *mbb, unsigned depth, bool issplit)
-    : MBB(mbb), Depth(depth), IsSplit(issplit) {}
+  MBBPriorityInfo(MachineBasicBlock *mbb, unsigned depth, uint64_t freq,
+                  bool issplit)
+    : MBB(mbb), Depth(depth), Freq(freq), IsSplit(issplit) {}
 };
 }
 
 // C-style comparator that sorts first based on the loop depth of the basic
-// block (the unsigned), and then on the MBB number.
+// block (the unsigned), then on the block frequency, and then on the MBB
+// number.  The frequency is zero unless JoinByFrequency is set.
 //
 // EnableGlobalCopies assumes that the primary sort key is loop depth.
 static int compareMBBPriority(const MBBPriorityInfo *LHS,
@@ -2048,6 +2076,10 @@ static int compareMBBPriority(const MBBPriorityInfo *LHS,
   if (LHS->Depth != RHS->Depth)
     return LHS->Depth > RHS->Depth ? -1 : 1;
 
+  // Hotter blocks first.
+  if (LHS->Freq != RHS->Freq)
+    return LHS->Freq > RHS->Freq ? -1 : 1;
+
   // Try to unsplit critical edges next.
   if (LHS->IsSplit != RHS->IsSplit)
     return LHS->IsSplit ? -1 : 1;
@@ -2095,6 +2127,12 @@ copyCoalesceWorkList(MutableArrayRef<MachineInstr*> CurrList) {
       CurrList[i] = 0;
       continue;
     }
+    if (JoinBudget && JoinAttempts >= JoinBudget) {
+      ++NumJoinsSkipped;
+      CurrList[i] = 0;
+      continue;
+    }
+    ++JoinAttempts;
     bool Again = false;
     bool Success = joinCopy(CurrList[i], Again);
     Progress |= Success;
@@ -2159,7 +2197,8 @@ void RegisterCoalescer::joinAllIntervals() {
   MBBs.reserve(MF->size());
   for (MachineFunction::iterator I = MF->begin(), E = MF->end();I != E;++I){
     MachineBasicBlock *MBB = I;
-    MBBs.push_back(MBBPriorityInfo(MBB, Loops->getLoopDepth(MBB),
+    uint64_t Freq = MBFI ? MBFI->getBlockFreq(MBB).getFrequency() : 0;
+    MBBs.push_back(MBBPriorityInfo(MBB, Loops->getLoopDepth(MBB), Freq,
                                    JoinSplitEdges && isSplitEdge(MBB)));
   }
   array_pod_sort(MBBs.begin(), MBBs.end(), compareMBBPriority);
@@ -2198,6 +2237,8 @@ bool RegisterCoalescer::runOnMachineFunction(MachineFunction &fn) {
   LIS = &getAnalysis<LiveIntervals>();
   AA = &getAnalysis<AliasAnalysis>();
   Loops = &getAnalysis<MachineLoopInfo>();
+  MBFI = JoinByFrequency ? &getAnalysis<MachineBlockFrequencyInfo>() : 0;
+  JoinAttempts = 0;
 
   const TargetSubtargetInfo &ST = TM->getSubtarget<TargetSubtargetInfo>();
   if (EnableGlobalCopies == cl::BOU_UNSET)
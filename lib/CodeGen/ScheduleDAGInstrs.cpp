@@ -45,6 +45,13 @@ static cl::opt<bool> EnableAASchedMI("enable-aa-sched-mi", cl::Hidden,
     cl::ZeroOrMore, cl::init(false),
     cl::desc("Enable use of AA during MI GAD construction"));
 
+// Bounds the work adjustChainDeps does for one memory operation.  Once the
+// budget is spent, a conservative chain edge is added instead of querying AA.
+static cl::opt<unsigned> ChainDepthBudget("misched-aa-chain-budget",
+    cl::Hidden, cl::init(200),
+    cl::desc("Maximum number of chain successors visited per memory "
+             "operation when pruning dependencies with AA"));
+
 ScheduleDAGInstrs::ScheduleDAGInstrs(MachineFunction &mf,
                                      const MachineLoopInfo &mli,
                                      const MachineDominatorTree &mdt,
@@ -592,7 +599,7 @@ iterateChainSucc(AliasAnalysis *AA, const MachineFrameInfo *MFI,
   // If we do need an edge, or we have exceeded depth budget,
   // add that edge to the predecessors chain of SUb,
   // and stop descending.
-  if (*Depth > 200 ||
+  if (*Depth > ChainDepthBudget ||
       MIsNeedChainEdge(AA, MFI, SUa->getInstr(), SUb->getInstr())) {
     SUb->addPred(SDep(SUa, SDep::MayAliasMem));
     return *Depth;
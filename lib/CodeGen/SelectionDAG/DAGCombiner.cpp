@@ -18,8 +18,10 @@
 
 #define DEBUG_TYPE "dagcombine"
 #include "llvm/CodeGen/SelectionDAG.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/Statistic.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/Analysis/AliasAnalysis.h"
 #include "llvm/CodeGen/MachineFrameInfo.h"
 #include "llvm/CodeGen/MachineFunction.h"
@@ -46,6 +48,8 @@ STATISTIC(PostIndexedNodes, "Number of post-indexed nodes created");
 STATISTIC(OpsNarrowed     , "Number of load/op/store narrowed");
 STATISTIC(LdStFP2Int      , "Number of fp load/store pairs transformed to int");
 STATISTIC(SlicedLoads, "Number of load sliced");
+STATISTIC(NodeVisitLimitHits, "Number of dag nodes not combined because they "
+                              "reached the visit limit");
 
 namespace {
   static cl::opt<bool>
@@ -64,6 +68,26 @@ namespace {
                              "slicing"),
                     cl::init(false));
 
+  /// Number of times a single node may be handed to the combine routines in
+  /// one run of the combiner.  Zero means no limit.
+  static cl::opt<unsigned>
+  MaxNodeVisits("combiner-max-node-visits", cl::Hidden, cl::init(0),
+                cl::desc("Maximum number of times the DAG combiner tries to "
+                         "combine a single node (0 = no limit)"));
+
+  /// Visit the initial worklist in topological order, operands before their
+  /// users, instead of in reverse order of creation.
+  static cl::opt<bool>
+  TopologicalWorkList("combiner-topological-worklist", cl::Hidden,
+                      cl::init(false),
+                      cl::desc("Combine the initial DAG nodes in topological "
+                               "order"));
+
+  static cl::opt<bool>
+  CombinerReport("combiner-report", cl::Hidden, cl::init(false),
+                 cl::desc("Print how often nodes of each opcode were "
+                          "combined, after each run of the DAG combiner"));
+
 //------------------------------ DAGCombiner ---------------------------------//
 
   class DAGCombiner {
@@ -82,18 +106,22 @@ namespace {
     // also only appear once. The naive approach to this takes
     // linear time.
     //
-    // To reduce the insert/remove time to logarithmic, we use
-    // a set and a vector to maintain our worklist.
-    //
-    // The set contains the items on the worklist, but does not
-    // maintain the order they should be visited.
-    //
-    // The vector maintains the order nodes should be visited, but may
-    // contain duplicate or removed nodes. When choosing a node to
-    // visit, we pop off the order stack until we find an item that is
-    // also in the contents set. All operations are O(log N).
-    SmallPtrSet<SDNode*, 64> WorkListContents;
-    SmallVector<SDNode*, 64> WorkListOrder;
+    // WorkList holds the nodes in the order they should be visited, from
+    // back to front.  WorkListMap maps each node on the worklist to its slot
+    // in WorkList.  Moving a node to the back or removing it clears its old
+    // slot, and the vector is compacted once more than half of it is
+    // cleared slots, so every operation is amortized O(1) and the vector
+    // stays proportional to the number of nodes on the worklist.
+    SmallVector<SDNode*, 64> WorkList;
+    DenseMap<SDNode*, unsigned> WorkListMap;
+
+    // NumVisits - How many times each node has been handed to combine() in
+    // this run, for -combiner-max-node-visits.
+    DenseMap<SDNode*, unsigned> NumVisits;
+
+    // CombineCounts - Number of successful combines per opcode name, for
+    // -combiner-report.
+    StringMap<unsigned> CombineCounts;
 
     // AA - Used for DAG load/store alias analysis.
     AliasAnalysis &AA;
@@ -116,14 +144,51 @@ namespace {
     /// AddToWorkList - Add to the work list making sure its instance is at the
     /// back (next to be processed.)
     void AddToWorkList(SDNode *N) {
-      WorkListContents.insert(N);
-      WorkListOrder.push_back(N);
+      std::pair<DenseMap<SDNode*, unsigned>::iterator, bool> Ins =
+        WorkListMap.insert(std::make_pair(N, WorkList.size()));
+      if (!Ins.second) {
+        if (Ins.first->second == WorkList.size() - 1)
+          return;
+        WorkList[Ins.first->second] = 0;
+        Ins.first->second = WorkList.size();
+      }
+      WorkList.push_back(N);
+      compactWorkList();
     }
 
     /// removeFromWorkList - remove all instances of N from the worklist.
     ///
     void removeFromWorkList(SDNode *N) {
-      WorkListContents.erase(N);
+      NumVisits.erase(N);
+      DenseMap<SDNode*, unsigned>::iterator I = WorkListMap.find(N);
+      if (I == WorkListMap.end())
+        return;
+      WorkList[I->second] = 0;
+      WorkListMap.erase(I);
+    }
+
+    /// getNextWorkListEntry - Pop the node to visit next off the worklist.
+    SDNode *getNextWorkListEntry() {
+      SDNode *N;
+      do
+        N = WorkList.pop_back_val();
+      while (!N);
+      WorkListMap.erase(N);
+      return N;
+    }
+
+    /// compactWorkList - Squeeze the cleared slots out of WorkList once they
+    /// make up more than half of it, preserving the visiting order.
+    void compactWorkList() {
+      if (WorkList.size() < 64 || WorkList.size() < 2 * WorkListMap.size())
+        return;
+      unsigned Idx = 0;
+      for (unsigned i = 0, e = WorkList.size(); i != e; ++i)
+        if (SDNode *N = WorkList[i]) {
+          WorkList[Idx] = N;
+          WorkListMap[N] = Idx++;
+        }
+      WorkList.resize(Idx);
     }
 
     SDValue CombineTo(SDNode *N, const SDValue *To, unsigned NumTo,
@@ -1016,10 +1081,18 @@ void DAGCombiner::Run(CombineLevel AtLevel) {
   LegalOperations = Level >= AfterLegalizeVectorOps;
   LegalTypes = Level >= AfterLegalizeTypes;
 
-  // Add all the dag nodes to the worklist.
-  for (SelectionDAG::allnodes_iterator I = DAG.allnodes_begin(),
-       E = DAG.allnodes_end(); I != E; ++I)
-    AddToWorkList(I);
+  // Add all the dag nodes to the worklist.  The worklist is visited from the
+  // back, so in topological mode the nodes are added users first.
+  if (TopologicalWorkList) {
+    DAG.AssignTopologicalOrder();
+    for (SelectionDAG::allnodes_iterator I = DAG.allnodes_end(),
+         E = DAG.allnodes_begin(); I != E; )
+      AddToWorkList(--I);
+  } else {
+    for (SelectionDAG::allnodes_iterator I = DAG.allnodes_begin(),
+         E = DAG.allnodes_end(); I != E; ++I)
+      AddToWorkList(I);
+  }
 
   // Create a dummy node (which is not added to allnodes), that adds a reference
   // to the root node, preventing it from being deleted, and tracking any
@@ -1032,16 +1105,8 @@ void DAGCombiner::Run(CombineLevel AtLevel) {
 
   // while the worklist isn't empty, find a node and
   // try and combine it.
-  while (!WorkListContents.empty()) {
-    SDNode *N;
-    // The WorkListOrder holds the SDNodes in order, but it may contain
-    // duplicates.
-    // In order to avoid a linear scan, we use a set (O(log N)) to hold what the
-    // worklist *should* contain, and check the node we want to visit is should
-    // actually be visited.
-    do {
-      N = WorkListOrder.pop_back_val();
-    } while (!WorkListContents.erase(N));
+  while (!WorkListMap.empty()) {
+    SDNode *N = getNextWorkListEntry();
 
     // If N has no uses, it is dead.  Make sure to revisit all N's operands once
     // N is deleted from the DAG, since they too may now be dead or may have a
@@ -1050,16 +1115,31 @@ void DAGCombiner::Run(CombineLevel AtLevel) {
       for (unsigned i = 0, e = N->getNumOperands(); i != e; ++i)
         AddToWorkList(N->getOperand(i).getNode());
 
+      NumVisits.erase(N);
       DAG.DeleteNode(N);
       continue;
     }
 
+    // Stop trying to combine a node that keeps coming back, e.g. because two
+    // combines undo each other.
+    if (MaxNodeVisits && ++NumVisits[N] > MaxNodeVisits) {
+      ++NodeVisitLimitHits;
+      continue;
+    }
+
+    // Take the name now; combine() may delete or morph N.
+    std::string OpName;
+    if (CombinerReport)
+      OpName = N->getOperationName(&DAG);
+
     SDValue RV = combine(N);
 
     if (RV.getNode() == 0)
       continue;
 
     ++NodesCombined;
+    if (CombinerReport)
+      ++CombineCounts[OpName];
 
     // If we get back the same node we passed in, rather than a new node or
     // zero, we know that the node must have defined multiple values and
@@ -1116,6 +1196,21 @@ void DAGCombiner::Run(CombineLevel AtLevel) {
   // If the root changed (e.g. it was a dead load, update the root).
   DAG.setRoot(Dummy.getValue());
   DAG.RemoveDeadNodes();
+  NumVisits.clear();
+
+  if (CombinerReport) {
+    dbgs() << "DAGCombine report for '"
+           << DAG.getMachineFunction().getName() << "' (level " << Level
+           << "):\n";
+    std::vector<std::pair<StringRef, unsigned> > Counts;
+    for (StringMap<unsigned>::const_iterator I = CombineCounts.begin(),
+         E = CombineCounts.end(); I != E; ++I)
+      Counts.push_back(std::make_pair(I->getKey(), I->getValue()));
+    std::sort(Counts.begin(), Counts.end());
+    for (unsigned i = 0, e = Counts.size(); i != e; ++i)
+      dbgs() << "  " << Counts[i].first << ": " << Counts[i].second << "\n";
+    CombineCounts.clear();
+  }
 }
 
 SDValue DAGCombiner::visit(SDNode *N) {
@@ -641,9 +641,38 @@ void SelectionDAG::DeleteNodeNotInCSEMaps(SDNode *N) {
   DeallocateNode(N);
 }
 
+void SelectionDAG::createOperands(SDNode *Node, const SDValue *Ops,
+                                  unsigned NumOps) {
+  typedef ArrayRecycler<SDUse>::Capacity Capacity;
+
+  SDUse *OpList = 0;
+  if (Node->OperandsNeedDelete) {
+    if (Capacity::get(Node->NumOperands).getBucket() ==
+        Capacity::get(NumOps).getBucket())
+      OpList = Node->OperandList;
+    else
+      removeOperands(Node);
+  }
+  if (!OpList && NumOps)
+    OpList = OperandRecycler.allocate(Capacity::get(NumOps), OperandAllocator);
+
+  Node->InitOperands(OpList, Ops, NumOps);
+  Node->OperandsNeedDelete = OpList != 0;
+}
+
+void SelectionDAG::removeOperands(SDNode *Node) {
+  if (!Node->OperandsNeedDelete)
+    return;
+  OperandRecycler.deallocate(
+      ArrayRecycler<SDUse>::Capacity::get(Node->NumOperands),
+      Node->OperandList);
+  Node->OperandList = 0;
+  Node->NumOperands = 0;
+  Node->OperandsNeedDelete = false;
+}
+
 void SelectionDAG::DeallocateNode(SDNode *N) {
-  if (N->OperandsNeedDelete)
-    delete[] N->OperandList;
+  removeOperands(N);
 
   // Set the opcode to DELETED_NODE to help catch bugs when node
   // memory is reallocated.
@@ -904,6 +933,7 @@ void SelectionDAG::init(MachineFunction &mf, const TargetTransformInfo *tti,
 SelectionDAG::~SelectionDAG() {
   assert(!UpdateListeners && "Dangling registered DAGUpdateListeners");
   allnodes_clear();
+  OperandRecycler.clear(OperandAllocator);
   delete DbgInfo;
 }
 
@@ -916,6 +946,7 @@ void SelectionDAG::allnodes_clear() {
 
 void SelectionDAG::clear() {
   allnodes_clear();
+  OperandRecycler.clear(OperandAllocator);
   OperandAllocator.Reset();
   CSEMap.clear();
 
@@ -1468,7 +1499,8 @@ SDValue SelectionDAG::getConvertRndSat(EVT VT, SDLoc dl,
 
   CvtRndSatSDNode *N = new (NodeAllocator) CvtRndSatSDNode(VT, dl.getIROrder(),
                                                            dl.getDebugLoc(),
-                                                           Ops, 5, Code);
+                                                           Code);
+  createOperands(N, Ops, 5);
   CSEMap.InsertNode(N, IP);
   AllNodes.push_back(N);
   return SDValue(N, 0);
@@ -4450,13 +4482,15 @@ SelectionDAG::getMemIntrinsicNode(unsigned Opcode, SDLoc dl, SDVTList VTList,
     }
 
     N = new (NodeAllocator) MemIntrinsicSDNode(Opcode, dl.getIROrder(),
-                                               dl.getDebugLoc(), VTList, Ops,
-                                               NumOps, MemVT, MMO);
+                                               dl.getDebugLoc(), VTList,
+                                               MemVT, MMO);
+    createOperands(N, Ops, NumOps);
     CSEMap.InsertNode(N, IP);
   } else {
     N = new (NodeAllocator) MemIntrinsicSDNode(Opcode, dl.getIROrder(),
-                                               dl.getDebugLoc(), VTList, Ops,
-                                               NumOps, MemVT, MMO);
+                                               dl.getDebugLoc(), VTList,
+                                               MemVT, MMO);
+    createOperands(N, Ops, NumOps);
   }
   AllNodes.push_back(N);
   return SDValue(N, 0);
@@ -4848,11 +4882,13 @@ SDValue SelectionDAG::getNode(unsigned Opcode, SDLoc DL, EVT VT,
       return SDValue(E, 0);
 
     N = new (NodeAllocator) SDNode(Opcode, DL.getIROrder(), DL.getDebugLoc(),
-                                   VTs, Ops, NumOps);
+                                   VTs);
+    createOperands(N, Ops, NumOps);
     CSEMap.InsertNode(N, IP);
   } else {
     N = new (NodeAllocator) SDNode(Opcode, DL.getIROrder(), DL.getDebugLoc(),
-                                   VTs, Ops, NumOps);
+                                   VTs);
+    createOperands(N, Ops, NumOps);
   }
 
   AllNodes.push_back(N);
@@ -4927,7 +4963,8 @@ SDValue SelectionDAG::getNode(unsigned Opcode, SDLoc DL, SDVTList VTList,
                                             Ops[1], Ops[2]);
     } else {
       N = new (NodeAllocator) SDNode(Opcode, DL.getIROrder(), DL.getDebugLoc(),
-                                     VTList, Ops, NumOps);
+                                     VTList);
+      createOperands(N, Ops, NumOps);
     }
     CSEMap.InsertNode(N, IP);
   } else {
@@ -4944,7 +4981,8 @@ SDValue SelectionDAG::getNode(unsigned Opcode, SDLoc DL, SDVTList VTList,
                                             Ops[1], Ops[2]);
     } else {
       N = new (NodeAllocator) SDNode(Opcode, DL.getIROrder(), DL.getDebugLoc(),
-                                     VTList, Ops, NumOps);
+                                     VTList);
+      createOperands(N, Ops, NumOps);
     }
   }
   AllNodes.push_back(N);
@@ -5372,31 +5410,23 @@ SDNode *SelectionDAG::MorphNodeTo(SDNode *N, unsigned Opc,
   if (MachineSDNode *MN = dyn_cast<MachineSDNode>(N)) {
     // Initialize the memory references information.
     MN->setMemRefs(0, 0);
-    // If NumOps is larger than the # of operands we can have in a
-    // MachineSDNode, reallocate the operand list.
-    if (NumOps > MN->NumOperands || !MN->OperandsNeedDelete) {
-      if (MN->OperandsNeedDelete)
-        delete[] MN->OperandList;
-      if (NumOps > array_lengthof(MN->LocalOperands))
-        // We're creating a final node that will live unmorphed for the
-        // remainder of the current SelectionDAG iteration, so we can allocate
-        // the operands directly out of a pool with no recycling metadata.
-        MN->InitOperands(OperandAllocator.Allocate<SDUse>(NumOps),
-                         Ops, NumOps);
-      else
-        MN->InitOperands(MN->LocalOperands, Ops, NumOps);
-      MN->OperandsNeedDelete = false;
-    } else
-      MN->InitOperands(MN->OperandList, Ops, NumOps);
+    // Give back any recycled operand list and reallocate the operands.
+    removeOperands(MN);
+    if (NumOps > array_lengthof(MN->LocalOperands))
+      // We're creating a final node that will live unmorphed for the
+      // remainder of the current SelectionDAG iteration, so we can allocate
+      // the operands directly out of a pool with no recycling metadata.
+      MN->InitOperands(OperandAllocator.Allocate<SDUse>(NumOps),
+                       Ops, NumOps);
+    else
+      MN->InitOperands(MN->LocalOperands, Ops, NumOps);
   } else {
     // If NumOps is larger than the # of operands we currently have, reallocate
-    // the operand list.
-    if (NumOps > N->NumOperands) {
-      if (N->OperandsNeedDelete)
-        delete[] N->OperandList;
-      N->InitOperands(new SDUse[NumOps], Ops, NumOps);
-      N->OperandsNeedDelete = true;
-    } else
+    // the operand list.  A recycled list must also be reallocated if it would
+    // end up in a different size class.
+    if (NumOps > N->NumOperands || N->OperandsNeedDelete)
+      createOperands(N, Ops, NumOps);
+    else
       N->InitOperands(N->OperandList, Ops, NumOps);
   }
 
@@ -6083,17 +6113,6 @@ MemSDNode::MemSDNode(unsigned Opc, unsigned Order, DebugLoc dl, SDVTList VTs,
   assert(memvt.getStoreSize() == MMO->getSize() && "Size mismatch!");
 }
 
-MemSDNode::MemSDNode(unsigned Opc, unsigned Order, DebugLoc dl, SDVTList VTs,
-                     const SDValue *Ops, unsigned NumOps, EVT memvt,
-                     MachineMemOperand *mmo)
-   : SDNode(Opc, Order, dl, VTs, Ops, NumOps),
-     MemoryVT(memvt), MMO(mmo) {
-  SubclassData = encodeMemSDNodeFlags(0, ISD::UNINDEXED, MMO->isVolatile(),
-                                      MMO->isNonTemporal(), MMO->isInvariant());
-  assert(isVolatile() == MMO->isVolatile() && "Volatile encoding error!");
-  assert(memvt.getStoreSize() == MMO->getSize() && "Size mismatch!");
-}
-
 /// Profile - Gather unique data for the node.
 ///
 void SDNode::Profile(FoldingSetNodeID &ID) const {
@@ -45,6 +45,7 @@
 #include "llvm/Support/Compiler.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/TimeProfiler.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Target/TargetInstrInfo.h"
@@ -64,6 +65,10 @@ STATISTIC(NumFastIselSuccess, "Number of instructions fast isel selected");
 STATISTIC(NumFastIselBlocks, "Number of blocks selected entirely by fast isel");
 STATISTIC(NumDAGBlocks, "Number of blocks selected using DAG");
 STATISTIC(NumDAGIselRetries,"Number of times dag isel has to try another path");
+STATISTIC(NumMatcherEntriesScanned,
+          "Number of matcher table entries scanned by dag isel");
+STATISTIC(NumMatcherNodesSelected,
+          "Number of nodes selected by the matcher table");
 STATISTIC(NumEntryBlocks, "Number of entry blocks encountered");
 STATISTIC(NumFastIselFailLowerArguments,
           "Number of entry blocks where fast isel failed to lower arguments");
@@ -155,6 +160,11 @@ static cl::opt<bool>
 EnableFastISelAbortArgs("fast-isel-abort-args", cl::Hidden,
           cl::desc("Enable abort calls when \"fast\" instruction selection "
                    "fails to lower a formal argument"));
+static cl::opt<bool>
+EnableFastISelReport("fast-isel-report", cl::Hidden,
+          cl::desc("Print, for each function, how many blocks the \"fast\" "
+                   "instruction selector handled and which instructions made "
+                   "it fall back to SelectionDAG"));
 
 static cl::opt<bool>
 UseMBPI("use-mbpi",
@@ -572,6 +582,15 @@ bool SelectionDAGISel::runOnMachineFunction(MachineFunction &mf) {
   return true;
 }
 
+// SelectBasicBlock - Build, combine and select one DAG for the instructions
+// in [Begin, End).  Each DAG covers a single basic block: values live across
+// blocks are copied through the virtual registers in FunctionLoweringInfo,
+// and the DAG combiner cannot look through those copies.  Selecting larger
+// regions (extended basic blocks or hammocks) would need the DAG to model
+// several control-flow edges and the scheduler to emit more than one
+// MachineBasicBlock per DAG, which neither does.  Instead, CodeGenPrepare
+// sinks compares, address computations and extensions into the blocks that
+// use them so they land in the same DAG as their users.
 void SelectionDAGISel::SelectBasicBlock(BasicBlock::const_iterator Begin,
                                         BasicBlock::const_iterator End,
                                         bool &HadTailCall) {
@@ -632,6 +651,8 @@ void SelectionDAGISel::ComputeLiveOutVRegInfo() {
 }
 
 void SelectionDAGISel::CodeGenAndEmitDAG() {
+  TimeTraceScope TraceScope("Select Basic Block",
+                            FuncInfo->MBB->getBasicBlock()->getName());
   std::string GroupName;
   if (TimePassesIsEnabled)
     GroupName = "Instruction Selection and Scheduling";
@@ -656,6 +677,7 @@ void SelectionDAGISel::CodeGenAndEmitDAG() {
   // Run the DAG combiner in pre-legalize mode.
   {
     NamedRegionTimer T("DAG Combining 1", GroupName, TimePassesIsEnabled);
+    TimeTraceScope TraceScope("DAG Combining 1");
     CurDAG->Combine(BeforeLegalizeTypes, *AA, OptLevel);
   }
 
@@ -670,6 +692,7 @@ void SelectionDAGISel::CodeGenAndEmitDAG() {
   bool Changed;
   {
     NamedRegionTimer T("Type Legalization", GroupName, TimePassesIsEnabled);
+    TimeTraceScope TraceScope("Type Legalization");
     Changed = CurDAG->LegalizeTypes();
   }
 
@@ -686,6 +709,7 @@ void SelectionDAGISel::CodeGenAndEmitDAG() {
     {
       NamedRegionTimer T("DAG Combining after legalize types", GroupName,
                          TimePassesIsEnabled);
+      TimeTraceScope TraceScope("DAG Combining after legalize types");
       CurDAG->Combine(AfterLegalizeTypes, *AA, OptLevel);
     }
 
@@ -696,12 +720,14 @@ void SelectionDAGISel::CodeGenAndEmitDAG() {
 
   {
     NamedRegionTimer T("Vector Legalization", GroupName, TimePassesIsEnabled);
+    TimeTraceScope TraceScope("Vector Legalization");
     Changed = CurDAG->LegalizeVectors();
   }
 
   if (Changed) {
     {
       NamedRegionTimer T("Type Legalization 2", GroupName, TimePassesIsEnabled);
+      TimeTraceScope TraceScope("Type Legalization 2");
       CurDAG->LegalizeTypes();
     }
 
@@ -712,6 +738,7 @@ void SelectionDAGISel::CodeGenAndEmitDAG() {
     {
       NamedRegionTimer T("DAG Combining after legalize vectors", GroupName,
                          TimePassesIsEnabled);
+      TimeTraceScope TraceScope("DAG Combining after legalize vectors");
       CurDAG->Combine(AfterLegalizeVectorOps, *AA, OptLevel);
     }
 
@@ -723,6 +750,7 @@ void SelectionDAGISel::CodeGenAndEmitDAG() {
 
   {
     NamedRegionTimer T("DAG Legalization", GroupName, TimePassesIsEnabled);
+    TimeTraceScope TraceScope("DAG Legalization");
     CurDAG->Legalize();
   }
 
@@ -734,6 +762,7 @@ void SelectionDAGISel::CodeGenAndEmitDAG() {
   // Run the DAG combiner in post-legalize mode.
   {
     NamedRegionTimer T("DAG Combining 2", GroupName, TimePassesIsEnabled);
+    TimeTraceScope TraceScope("DAG Combining 2");
     CurDAG->Combine(AfterLegalizeDAG, *AA, OptLevel);
   }
 
@@ -749,6 +778,7 @@ void SelectionDAGISel::CodeGenAndEmitDAG() {
   // code to the MachineBasicBlock.
   {
     NamedRegionTimer T("Instruction Selection", GroupName, TimePassesIsEnabled);
+    TimeTraceScope TraceScope("Instruction Selection");
     DoInstructionSelection();
   }
 
@@ -762,6 +792,7 @@ void SelectionDAGISel::CodeGenAndEmitDAG() {
   {
     NamedRegionTimer T("Instruction Scheduling", GroupName,
                        TimePassesIsEnabled);
+    TimeTraceScope TraceScope("Instruction Scheduling");
     Scheduler->Run(CurDAG, FuncInfo->MBB);
   }
 
@@ -772,6 +803,7 @@ void SelectionDAGISel::CodeGenAndEmitDAG() {
   MachineBasicBlock *FirstMBB = FuncInfo->MBB, *LastMBB;
   {
     NamedRegionTimer T("Instruction Creation", GroupName, TimePassesIsEnabled);
+    TimeTraceScope TraceScope("Instruction Creation");
 
     // FuncInfo->InsertPt is passed by reference and set to the end of the
     // scheduled instructions.
@@ -787,6 +819,7 @@ void SelectionDAGISel::CodeGenAndEmitDAG() {
   {
     NamedRegionTimer T("Instruction Scheduling Cleanup", GroupName,
                        TimePassesIsEnabled);
+    TimeTraceScope TraceScope("Instruction Scheduling Cleanup");
     delete Scheduler;
   }
 
@@ -1000,6 +1033,12 @@ void SelectionDAGISel::SelectAllBasicBlocks(const Function &Fn) {
   if (TM.Options.EnableFastISel)
     FastIS = getTargetLowering()->createFastISel(*FuncInfo, LibInfo);
 
+  // Per-function counts for -fast-isel-report: the opcodes of the
+  // instructions that made FastISel hand (part of) a block to SelectionDAG.
+  std::map<unsigned, unsigned> FastISelMisses;
+  unsigned NumFastISelArgMisses = 0;
+  unsigned NumBlocks = 0, NumFastISelOnlyBlocks = 0;
+
   // Iterate over all basic blocks in the function.
   ReversePostOrderTraversal<const Function*> RPOT(&Fn);
   for (ReversePostOrderTraversal<const Function*>::rpo_iterator
@@ -1055,6 +1094,7 @@ void SelectionDAGISel::SelectAllBasicBlocks(const Function &Fn) {
         if (!FastIS->LowerArguments()) {
           // Fast isel failed to lower these arguments
           ++NumFastIselFailLowerArguments;
+          ++NumFastISelArgMisses;
           if (EnableFastISelAbortArgs)
             llvm_unreachable("FastISel didn't lower all arguments");
 
@@ -1117,6 +1157,8 @@ void SelectionDAGISel::SelectAllBasicBlocks(const Function &Fn) {
         if (EnableFastISelVerbose2)
           collectFailStats(Inst);
 #endif
+        if (EnableFastISelReport)
+          ++FastISelMisses[Inst->getOpcode()];
 
         // Then handle certain instructions as single-LLVM-Instruction blocks.
         if (isa<CallInst>(Inst)) {
@@ -1182,10 +1224,13 @@ void SelectionDAGISel::SelectAllBasicBlocks(const Function &Fn) {
       }
     }
 
+    ++NumBlocks;
     if (Begin != BI)
       ++NumDAGBlocks;
-    else
+    else {
       ++NumFastIselBlocks;
+      ++NumFastISelOnlyBlocks;
+    }
 
     if (Begin != BI) {
       // Run SelectionDAG instruction selection on the remainder of the block
@@ -1199,6 +1244,18 @@ void SelectionDAGISel::SelectAllBasicBlocks(const Function &Fn) {
     FuncInfo->PHINodesToUpdate.clear();
   }
 
+  if (FastIS && EnableFastISelReport) {
+    dbgs() << "FastISel report for '" << Fn.getName() << "': "
+           << NumFastISelOnlyBlocks << " of " << NumBlocks
+           << " blocks selected entirely by fast isel\n";
+    if (NumFastISelArgMisses)
+      dbgs() << "  <arguments>: " << NumFastISelArgMisses << "\n";
+    for (std::map<unsigned, unsigned>::const_iterator
+         I = FastISelMisses.begin(), E = FastISelMisses.end(); I != E; ++I)
+      dbgs() << "  " << Instruction::getOpcodeName(I->first) << ": "
+             << I->second << "\n";
+  }
+
   delete FastIS;
   SDB->clearDanglingDebugInfo();
   SDB->SPDescriptor.resetPerFunctionState();
@@ -2350,6 +2407,15 @@ struct MatchScope {
   bool HasChainNodesMatched, HasGlueResultNodesMatched;
 };
 
+/// MatcherScanCounter - Count the matcher table entries (opcodes, scope
+/// children and switch cases) the interpreter looks at for one node, and add
+/// them to the statistic once the node is done.
+struct MatcherScanCounter {
+  unsigned NumEntries;
+  MatcherScanCounter() : NumEntries(0) {}
+  ~MatcherScanCounter() { NumMatcherEntriesScanned += NumEntries; }
+};
+
 }
 
 SDNode *SelectionDAGISel::
@@ -2425,6 +2491,9 @@ SelectCodeCommon(SDNode *NodeToMatch, const unsigned char *MatcherTable,
   SmallVector<SDNode*, 3> ChainNodesMatched;
   SmallVector<SDNode*, 3> GlueResultNodesMatched;
 
+  // Scanned - The amount of the table looked at while matching this node.
+  MatcherScanCounter Scanned;
+
   DEBUG(dbgs() << "ISEL: Starting pattern match on root node: ";
         NodeToMatch->dump(CurDAG);
         dbgs() << '\n');
@@ -2472,6 +2541,7 @@ SelectCodeCommon(SDNode *NodeToMatch, const unsigned char *MatcherTable,
 #ifndef NDEBUG
     unsigned CurrentOpcodeIndex = MatcherIndex;
 #endif
+    ++Scanned.NumEntries;
     BuiltinOpcodes Opcode = (BuiltinOpcodes)MatcherTable[MatcherIndex++];
     switch (Opcode) {
     case OPC_Scope: {
@@ -2493,6 +2563,7 @@ SelectCodeCommon(SDNode *NodeToMatch, const unsigned char *MatcherTable,
         }
 
         FailIndex = MatcherIndex+NumToSkip;
+        ++Scanned.NumEntries;
 
         unsigned MatcherIndexOfPredicate = MatcherIndex;
         (void)MatcherIndexOfPredicate; // silence warning.
@@ -2633,6 +2704,8 @@ SelectCodeCommon(SDNode *NodeToMatch, const unsigned char *MatcherTable,
         uint16_t Opc = MatcherTable[MatcherIndex++];
         Opc |= (unsigned short)MatcherTable[MatcherIndex++] << 8;
 
+        ++Scanned.NumEntries;
+
         // If the opcode matches, then we will execute this case.
         if (CurNodeOpcode == Opc)
           break;
@@ -2665,6 +2738,8 @@ SelectCodeCommon(SDNode *NodeToMatch, const unsigned char *MatcherTable,
         if (CaseVT == MVT::iPTR)
           CaseVT = getTargetLowering()->getPointerTy();
 
+        ++Scanned.NumEntries;
+
         // If the VT matches, then we will execute this case.
         if (CurNodeVT == CaseVT)
           break;
@@ -3031,6 +3106,7 @@ SelectCodeCommon(SDNode *NodeToMatch, const unsigned char *MatcherTable,
         // Update chain and glue uses.
         UpdateChainsAndGlue(NodeToMatch, InputChain, ChainNodesMatched,
                             InputGlue, GlueResultNodesMatched, true);
+        ++NumMatcherNodesSelected;
         return Res;
       }
 
@@ -3089,6 +3165,7 @@ SelectCodeCommon(SDNode *NodeToMatch, const unsigned char *MatcherTable,
 
       assert(NodeToMatch->use_empty() &&
              "Didn't replace all uses of the node?");
+      ++NumMatcherNodesSelected;
 
       // FIXME: We just return here, which interacts correctly with SelectRoot
       // above.  We should fix this to not return an SDNode* anymore.
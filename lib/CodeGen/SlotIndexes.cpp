@@ -24,6 +24,7 @@ INITIALIZE_PASS(SlotIndexes, "slotindexes",
 
 STATISTIC(NumLocalRenum,  "Number of local renumberings");
 STATISTIC(NumGlobalRenum, "Number of global renumberings");
+STATISTIC(NumRenumberedEntries, "Number of indexes moved by local renumbering");
 
 void SlotIndexes::getAnalysisUsage(AnalysisUsage &au) const {
   au.setPreservesAll();
@@ -125,21 +126,39 @@ void SlotIndexes::renumberIndexes() {
 // Renumber indexes locally after curItr was inserted, but failed to get a new
 // index.
 void SlotIndexes::renumberIndexes(IndexList::iterator curItr) {
-  // Number indexes with half the default spacing so we can catch up quickly.
-  const unsigned Space = SlotIndex::InstrDist/2;
-  assert((Space & 3) == 0 && "InstrDist must be a multiple of 2*NUM");
-
-  IndexList::iterator startItr = prior(curItr);
-  unsigned index = startItr->getIndex();
-  do {
-    curItr->setIndex(index += Space);
-    ++curItr;
-    // If the next index is bigger, we have caught up.
-  } while (curItr != indexList.end() && curItr->getIndex() <= index);
-
-  DEBUG(dbgs() << "\n*** Renumbered SlotIndexes " << startItr->getIndex() << '-'
+  // Spread the entries out to at least half the default spacing so we can
+  // catch up quickly.
+  const unsigned MinSpace = SlotIndex::InstrDist/2;
+  assert((MinSpace & 3) == 0 && "InstrDist must be a multiple of 2*NUM");
+
+  // Find a window (Lo, Hi) around curItr whose index range leaves at least
+  // MinSpace between its entries, doubling it on both sides until it does.
+  // The end of the list is unbounded.
+  IndexList::iterator Lo = prior(curItr), Hi = llvm::next(curItr);
+  unsigned NumEntries = 1;
+  unsigned Space;
+  for (unsigned Grow = 1; ; Grow *= 2) {
+    if (Hi == indexList.end()) {
+      Space = SlotIndex::InstrDist;
+      break;
+    }
+    Space = ((Hi->getIndex() - Lo->getIndex()) / (NumEntries + 1)) & ~3u;
+    if (Space >= MinSpace)
+      break;
+    for (unsigned i = 0; i != Grow && Lo != indexList.begin(); ++i, --Lo)
+      ++NumEntries;
+    for (unsigned i = 0; i != Grow && Hi != indexList.end(); ++i, ++Hi)
+      ++NumEntries;
+  }
+
+  unsigned index = Lo->getIndex();
+  for (IndexList::iterator I = llvm::next(Lo); I != Hi; ++I)
+    I->setIndex(index += Space);
+
+  DEBUG(dbgs() << "\n*** Renumbered SlotIndexes " << Lo->getIndex() << '-'
                << index << " ***\n");
   ++NumLocalRenum;
+  NumRenumberedEntries += NumEntries;
 }
 
 // Repair indexes after adding and removing instructions.
@@ -33,6 +33,7 @@
 #include "llvm/Analysis/Dominators.h"
 #include "llvm/Analysis/ValueTracking.h"
 #include "llvm/CodeGen/LiveInterval.h"
+#include "llvm/CodeGen/LiveIntervalUnion.h"
 #include "llvm/CodeGen/MachineBasicBlock.h"
 #include "llvm/CodeGen/MachineBranchProbabilityInfo.h"
 #include "llvm/CodeGen/MachineDominators.h"
@@ -733,56 +734,64 @@ bool StackColoring::runOnMachineFunction(MachineFunction &Func) {
   }
 
   // This is a simple greedy algorithm for merging allocas. First, sort the
-  // slots, placing the largest slots first. Next, perform an n^2 scan and look
-  // for disjoint slots. When you find disjoint slots, merge the samller one
-  // into the bigger one and update the live interval. Remove the small alloca
-  // and continue.
+  // slots, placing the largest slots first. Next, visit the slots in that
+  // order and merge each one into the first earlier slot whose interval it
+  // does not overlap, or keep it if there is none. Each kept slot has the
+  // union of the intervals merged into it in an interval map, so the overlap
+  // test is a lookup per segment of the smaller slot no matter how many
+  // slots were merged before.
 
   // Sort the slots according to their size. Place unused slots at the end.
   // Use stable sort to guarantee deterministic code generation.
   std::stable_sort(SortedSlots.begin(), SortedSlots.end(),
                    SlotSizeSorter(MFI));
 
-  bool Changed = true;
-  while (Changed) {
-    Changed = false;
-    for (unsigned I = 0; I < NumSlots; ++I) {
-      if (SortedSlots[I] == -1)
-        continue;
-
-      for (unsigned J=I+1; J < NumSlots; ++J) {
-        if (SortedSlots[J] == -1)
-          continue;
-
-        int FirstSlot = SortedSlots[I];
-        int SecondSlot = SortedSlots[J];
-        LiveInterval *First = Intervals[FirstSlot];
-        LiveInterval *Second = Intervals[SecondSlot];
-        assert (!First->empty() && !Second->empty() && "Found an empty range");
-
-        // Merge disjoint slots.
-        if (!First->overlaps(*Second)) {
-          Changed = true;
-          First->MergeSegmentsInAsValue(*Second, First->getValNumInfo(0));
-          SlotRemap[SecondSlot] = FirstSlot;
-          SortedSlots[J] = -1;
-          DEBUG(dbgs()<<"Merging #"<<FirstSlot<<" and slots #"<<
-                SecondSlot<<" together.\n");
-          unsigned MaxAlignment = std::max(MFI->getObjectAlignment(FirstSlot),
-                                           MFI->getObjectAlignment(SecondSlot));
-
-          assert(MFI->getObjectSize(FirstSlot) >=
-                 MFI->getObjectSize(SecondSlot) &&
-                 "Merging a small object into a larger one");
-
-          RemovedSlots+=1;
-          ReducedSize += MFI->getObjectSize(SecondSlot);
-          MFI->setObjectAlignment(FirstSlot, MaxAlignment);
-          MFI->RemoveStackObject(SecondSlot);
-        }
+  LiveIntervalUnion::Allocator UnionAllocator;
+  LiveIntervalUnion::Array Unions;
+  Unions.init(UnionAllocator, NumSlots);
+  SmallVector<int, 16> KeptSlots;
+  for (unsigned J = 0; J < NumSlots; ++J) {
+    int SecondSlot = SortedSlots[J];
+    if (SecondSlot == -1)
+      continue;
+    LiveInterval *Second = Intervals[SecondSlot];
+    assert(!Second->empty() && "Found an empty range");
+
+    // Find the first kept slot that is disjoint with this one.
+    int FirstSlot = -1;
+    for (unsigned I = 0, E = KeptSlots.size(); I != E; ++I) {
+      LiveIntervalUnion::Query Q(Second, &Unions[KeptSlots[I]]);
+      if (!Q.checkInterference()) {
+        FirstSlot = KeptSlots[I];
+        break;
       }
     }
-  }// While changed.
+
+    if (FirstSlot == -1) {
+      KeptSlots.push_back(SecondSlot);
+      Unions[SecondSlot].unify(*Second);
+      continue;
+    }
+
+    // Merge disjoint slots.
+    Unions[FirstSlot].unify(*Second);
+    SlotRemap[SecondSlot] = FirstSlot;
+    SortedSlots[J] = -1;
+    DEBUG(dbgs()<<"Merging #"<<FirstSlot<<" and slots #"<<
+          SecondSlot<<" together.\n");
+    unsigned MaxAlignment = std::max(MFI->getObjectAlignment(FirstSlot),
+                                     MFI->getObjectAlignment(SecondSlot));
+
+    assert(MFI->getObjectSize(FirstSlot) >=
+           MFI->getObjectSize(SecondSlot) &&
+           "Merging a small object into a larger one");
+
+    RemovedSlots+=1;
+    ReducedSize += MFI->getObjectSize(SecondSlot);
+    MFI->setObjectAlignment(FirstSlot, MaxAlignment);
+    MFI->RemoveStackObject(SecondSlot);
+  }
+  Unions.clear();
 
   // Record statistics.
   StackSpaceSaved += ReducedSize;
@@ -20,6 +20,7 @@
 #include "llvm/MC/MCSectionMachO.h"
 #include "llvm/MC/MCStreamer.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Target/TargetOpcodes.h"
 #include "llvm/Target/TargetMachine.h"
@@ -296,6 +297,8 @@ void StackMaps::serializeToStackMapSection() {
   // Create the section.
   const MCSection *StackMapSection =
     OutContext.getObjectFileInfo()->getStackMapSection();
+  if (!StackMapSection)
+    report_fatal_error("stack maps are not supported for this object format");
   AP.OutStreamer.SwitchSection(StackMapSection);
 
   // Emit a dummy symbol to force section inclusion.
@@ -17,6 +17,7 @@
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/CodeGen/LiveIntervalAnalysis.h"
+#include "llvm/CodeGen/LiveIntervalUnion.h"
 #include "llvm/CodeGen/LiveStackAnalysis.h"
 #include "llvm/CodeGen/MachineBlockFrequencyInfo.h"
 #include "llvm/CodeGen/MachineFrameInfo.h"
@@ -77,8 +78,12 @@ namespace {
     // UsedColors - "Colors" that have been assigned.
     BitVector UsedColors;
 
-    // Assignments - Color to intervals mapping.
-    SmallVector<SmallVector<LiveInterval*,4>, 16> Assignments;
+    // Assignments - Color to intervals mapping.  The union of the intervals
+    // of each color is kept in an interval map, so testing a slot against a
+    // color costs a lookup per segment rather than a walk over every
+    // interval already given that color.
+    LiveIntervalUnion::Allocator UnionAllocator;
+    LiveIntervalUnion::Array Assignments;
 
   public:
     static char ID; // Pass identification
@@ -103,7 +108,7 @@ namespace {
   private:
     void InitializeSlots();
     void ScanForSpillSlotRefs(MachineFunction &MF);
-    bool OverlapWithAssignments(LiveInterval *li, int Color) const;
+    bool OverlapWithAssignments(LiveInterval *li, int Color);
     int ColorSlot(LiveInterval *li);
     bool ColorSlots(MachineFunction &MF);
     void RewriteInstruction(MachineInstr *MI, SmallVectorImpl<int> &SlotMapping,
@@ -182,7 +187,7 @@ void StackSlotColoring::InitializeSlots() {
   OrigSizes.resize(LastFI);
   AllColors.resize(LastFI);
   UsedColors.resize(LastFI);
-  Assignments.resize(LastFI);
+  Assignments.init(UnionAllocator, LastFI);
 
   // Gather all spill slots into a list.
   DEBUG(dbgs() << "Spill slot intervals:\n");
@@ -208,15 +213,9 @@ void StackSlotColoring::InitializeSlots() {
 
 /// OverlapWithAssignments - Return true if LiveInterval overlaps with any
 /// LiveIntervals that have already been assigned to the specified color.
-bool
-StackSlotColoring::OverlapWithAssignments(LiveInterval *li, int Color) const {
-  const SmallVectorImpl<LiveInterval *> &OtherLIs = Assignments[Color];
-  for (unsigned i = 0, e = OtherLIs.size(); i != e; ++i) {
-    LiveInterval *OtherLI = OtherLIs[i];
-    if (OtherLI->overlaps(*li))
-      return true;
-  }
-  return false;
+bool StackSlotColoring::OverlapWithAssignments(LiveInterval *li, int Color) {
+  LiveIntervalUnion::Query Q(li, &Assignments[Color]);
+  return Q.checkInterference();
 }
 
 /// ColorSlot - Assign a "color" (stack slot) to the specified stack slot.
@@ -247,7 +246,7 @@ int StackSlotColoring::ColorSlot(LiveInterval *li) {
   }
 
   // Record the assignment.
-  Assignments[Color].push_back(li);
+  Assignments[Color].unify(*li);
   int FI = TargetRegisterInfo::stackSlot2Index(li->reg);
   DEBUG(dbgs() << "Assigning fi#" << FI << " to fi#" << Color << "\n");
 
@@ -454,8 +453,6 @@ bool StackSlotColoring::runOnMachineFunction(MachineFunction &MF) {
   OrigSizes.clear();
   AllColors.clear();
   UsedColors.clear();
-  for (unsigned i = 0, e = Assignments.size(); i != e; ++i)
-    Assignments[i].clear();
   Assignments.clear();
 
   return Changed;
@@ -15,6 +15,7 @@
 #include "llvm/CodeGen/TargetLoweringObjectFileImpl.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringSet.h"
 #include "llvm/ADT/Triple.h"
 #include "llvm/CodeGen/MachineModuleInfoImpls.h"
 #include "llvm/IR/Constants.h"
@@ -30,15 +31,29 @@
 #include "llvm/MC/MCSectionMachO.h"
 #include "llvm/MC/MCStreamer.h"
 #include "llvm/MC/MCSymbol.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Dwarf.h"
 #include "llvm/Support/ELF.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Target/Mangler.h"
 #include "llvm/Target/TargetMachine.h"
 using namespace llvm;
 using namespace dwarf;
 
+static cl::opt<bool>
+ColdFunctionSections("cold-function-sections",
+  cl::desc("Place functions marked cold in .text.unlikely (ELF only)"),
+  cl::Hidden);
+
+static cl::opt<std::string>
+FunctionOrderFile("function-order-file",
+  cl::desc("File of hot function symbol names, one per line, to be placed "
+           "in .text.hot sections (ELF only)"),
+  cl::value_desc("filename"), cl::Hidden);
+
 //===----------------------------------------------------------------------===//
 //                                  ELF
 //===----------------------------------------------------------------------===//
@@ -210,6 +225,77 @@ getExplicitSectionGlobal(const GlobalValue *GV, SectionKind Kind,
                                     getELFSectionFlags(Kind), Kind);
 }
 
+namespace {
+/// HotFunctionList - The symbol names read from -function-order-file.
+struct HotFunctionList {
+  bool Loaded;
+  StringSet<> Names;
+  HotFunctionList() : Loaded(false) {}
+};
+}
+
+static ManagedStatic<HotFunctionList> HotFunctions;
+
+/// isListedHot - Return true if Name appears in -function-order-file.  The
+/// file is read the first time this is called; a missing file reports an
+/// error and lists nothing.
+static bool isListedHot(StringRef Name) {
+  if (FunctionOrderFile.empty())
+    return false;
+  HotFunctionList &List = *HotFunctions;
+  if (!List.Loaded) {
+    List.Loaded = true;
+    OwningPtr<MemoryBuffer> Buf;
+    if (error_code EC = MemoryBuffer::getFile(FunctionOrderFile, Buf)) {
+      errs() << "warning: cannot read function order file '"
+             << FunctionOrderFile << "': " << EC.message() << '\n';
+      return false;
+    }
+    SmallVector<StringRef, 64> Lines;
+    Buf->getBuffer().split(Lines, "\n", -1, false);
+    for (unsigned i = 0, e = Lines.size(); i != e; ++i) {
+      StringRef Line = Lines[i].trim();
+      if (!Line.empty() && Line[0] != '#')
+        List.Names.insert(Line);
+    }
+  }
+  return List.Names.count(Name);
+}
+
+/// getTextSectionForFunction - Return the hot or cold text section for GV if
+/// -function-order-file or -cold-function-sections asks for one, or null.
+/// Listed functions each get a .text.hot.<name> section so the linker keeps
+/// them together and can order them with the same list (gold's
+/// --section-ordering-file).  Cold functions go into .text.unlikely, which
+/// linker scripts place away from the rest of the text.
+static const MCSection *getTextSectionForFunction(const GlobalValue *GV,
+                                                  SectionKind Kind,
+                                                  MCSymbol *Sym,
+                                                  bool UniqueSection,
+                                                  MCContext &Ctx) {
+  const Function *F = dyn_cast<Function>(GV);
+  if (!F || GV->isWeakForLinker())
+    return 0;
+
+  SmallString<128> Name;
+  if (isListedHot(Sym->getName())) {
+    Name = ".text.hot.";
+    Name += Sym->getName();
+  } else if (ColdFunctionSections &&
+             F->getAttributes().hasAttribute(AttributeSet::FunctionIndex,
+                                             llvm::Attribute::Cold)) {
+    Name = ".text.unlikely";
+    if (UniqueSection) {
+      Name += '.';
+      Name += Sym->getName();
+    }
+  } else {
+    return 0;
+  }
+  return Ctx.getELFSection(Name.str(), ELF::SHT_PROGBITS,
+                           ELF::SHF_ALLOC | ELF::SHF_EXECINSTR, Kind);
+}
+
 /// getSectionPrefixForGlobal - Return the section prefix name used by options
 /// FunctionsSections and DataSections.
 static const char *getSectionPrefixForGlobal(SectionKind Kind) {
@@ -241,6 +327,13 @@ SelectSectionForGlobal(const GlobalValue *GV, SectionKind Kind,
   else
     EmitUniquedSection = TM.getDataSections();
 
+  if (Kind.isText())
+    if (const MCSection *S = getTextSectionForFunction(GV, Kind,
+                                                       getSymbol(*Mang, GV),
+                                                       EmitUniquedSection,
+                                                       getContext()))
+      return S;
+
   // If this global is linkonce/weak and the target handles this by emitting it
   // into a 'uniqued' section name, create and return the section now.
   if ((GV->isWeakForLinker() || EmitUniquedSection) &&
@@ -19,6 +19,38 @@ void DWARFAbbreviationDeclaration::clear() {
   Tag = 0;
   HasChildren = false;
   Attributes.clear();
+  HasOnlyFixedForms = true;
+  NumAddrForms = 0;
+  NumRefAddrForms = 0;
+  FixedAttributeBytes = 0;
+}
+
+/// getUnitIndependentFormSize - Returns the size of values of the given form
+/// if it is the same in every unit, or -1 if it isn't or the size varies.
+static int getUnitIndependentFormSize(uint16_t Form) {
+  switch (Form) {
+  case DW_FORM_flag_present:
+    return 0;
+  case DW_FORM_data1:
+  case DW_FORM_ref1:
+  case DW_FORM_flag:
+    return 1;
+  case DW_FORM_data2:
+  case DW_FORM_ref2:
+    return 2;
+  case DW_FORM_data4:
+  case DW_FORM_ref4:
+  // FIXME: Support DWARF64.
+  case DW_FORM_strp:
+  case DW_FORM_sec_offset:
+    return 4;
+  case DW_FORM_data8:
+  case DW_FORM_ref8:
+  case DW_FORM_ref_sig8:
+    return 8;
+  default:
+    return -1;
+  }
 }
 
 DWARFAbbreviationDeclaration::DWARFAbbreviationDeclaration() {
@@ -52,6 +84,18 @@ DWARFAbbreviationDeclaration::extract(DataExtractor Data, uint32_t* OffsetPtr) {
     if (Attr == 0 && Form == 0)
       break;
     Attributes.push_back(AttributeSpec(Attr, Form));
+
+    if (Form == DW_FORM_addr)
+      ++NumAddrForms;
+    else if (Form == DW_FORM_ref_addr)
+      ++NumRefAddrForms;
+    else {
+      int Size = getUnitIndependentFormSize(Form);
+      if (Size < 0)
+        HasOnlyFixedForms = false;
+      else
+        FixedAttributeBytes += Size;
+    }
   }
 
   if (Tag == 0) {
@@ -10,8 +10,10 @@
 #ifndef LLVM_DEBUGINFO_DWARFABBREVIATIONDECLARATION_H
 #define LLVM_DEBUGINFO_DWARFABBREVIATIONDECLARATION_H
 
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/DataExtractor.h"
+#include "llvm/Support/Dwarf.h"
 
 namespace llvm {
 
@@ -28,6 +30,14 @@ class DWARFAbbreviationDeclaration {
     uint16_t Form;
   };
   SmallVector<AttributeSpec, 8> Attributes;
+
+  // If every attribute has a fixed-size form, the size of the attribute
+  // values is FixedAttributeBytes plus the size of NumAddrForms addresses and
+  // NumRefAddrForms DW_FORM_ref_addr values, which depend on the unit.
+  bool HasOnlyFixedForms;
+  uint16_t NumAddrForms;
+  uint16_t NumRefAddrForms;
+  uint32_t FixedAttributeBytes;
 public:
   DWARFAbbreviationDeclaration();
 
@@ -43,6 +53,19 @@ public:
   }
 
   uint32_t findAttributeIndex(uint16_t attr) const;
+  /// getFixedAttributesByteSize - If all attribute values of a DIE with this
+  /// abbreviation have fixed sizes, sets Size to their total and returns
+  /// true. FixedFormSizes is the table for the DIE's unit, as returned by
+  /// DWARFFormValue::getFixedFormSizes.
+  bool getFixedAttributesByteSize(ArrayRef<uint8_t> FixedFormSizes,
+                                  uint32_t &Size) const {
+    if (!HasOnlyFixedForms)
+      return false;
+    Size = FixedAttributeBytes +
+           NumAddrForms * FixedFormSizes[dwarf::DW_FORM_addr] +
+           NumRefAddrForms * FixedFormSizes[dwarf::DW_FORM_ref_addr];
+    return true;
+  }
   bool extract(DataExtractor Data, uint32_t* OffsetPtr);
   void dump(raw_ostream &OS) const;
 
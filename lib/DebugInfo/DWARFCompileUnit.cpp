@@ -14,12 +14,12 @@
 using namespace llvm;
 
 void DWARFCompileUnit::dump(raw_ostream &OS) {
-  OS << format("0x%08x", getOffset()) << ": Compile Unit:"
-     << " length = " << format("0x%08x", getLength())
-     << " version = " << format("0x%04x", getVersion())
-     << " abbr_offset = " << format("0x%04x", getAbbreviations()->getOffset())
-     << " addr_size = " << format("0x%02x", getAddressByteSize())
-     << " (next unit at " << format("0x%08x", getNextUnitOffset())
+  OS << format_hex(getOffset(), 10) << ": Compile Unit:"
+     << " length = " << format_hex(getLength(), 10)
+     << " version = " << format_hex(getVersion(), 6)
+     << " abbr_offset = " << format_hex(getAbbreviations()->getOffset(), 6)
+     << " addr_size = " << format_hex(getAddressByteSize(), 4)
+     << " (next unit at " << format_hex(getNextUnitOffset(), 10)
      << ")\n";
 
   const DWARFDebugInfoEntryMinimal *CU = getCompileUnitDIE(false);
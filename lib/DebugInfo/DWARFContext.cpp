@@ -9,14 +9,17 @@
 
 #include "DWARFContext.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/DebugInfo/DWARFFormValue.h"
 #include "llvm/Support/Compression.h"
 #include "llvm/Support/Dwarf.h"
 #include "llvm/Support/Format.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
+#include <map>
 using namespace llvm;
 using namespace dwarf;
 using namespace object;
@@ -35,10 +38,10 @@ static void dumpPubSection(raw_ostream &OS, StringRef Name, StringRef Data,
   DataExtractor pubNames(Data, LittleEndian, 0);
   uint32_t offset = 0;
   while (pubNames.isValidOffset(offset)) {
-    OS << "length = " << format("0x%08x", pubNames.getU32(&offset));
-    OS << " version = " << format("0x%04x", pubNames.getU16(&offset));
-    OS << " unit_offset = " << format("0x%08x", pubNames.getU32(&offset));
-    OS << " unit_size = " << format("0x%08x", pubNames.getU32(&offset)) << '\n';
+    OS << "length = " << format_hex(pubNames.getU32(&offset), 10);
+    OS << " version = " << format_hex(pubNames.getU16(&offset), 6);
+    OS << " unit_offset = " << format_hex(pubNames.getU32(&offset), 10);
+    OS << " unit_size = " << format_hex(pubNames.getU32(&offset), 10) << '\n';
     if (GnuStyle)
       OS << "Offset     Linkage  Kind     Name\n";
     else
@@ -196,6 +199,131 @@ void DWARFContext::dump(raw_ostream &OS, DIDumpType DumpType) {
     }
 }
 
+namespace {
+struct AttributeStats {
+  uint16_t Attr;
+  uint64_t Count;
+  uint64_t Bytes;
+  AttributeStats() : Attr(0), Count(0), Bytes(0) {}
+  bool operator<(const AttributeStats &RHS) const {
+    if (Bytes != RHS.Bytes)
+      return Bytes > RHS.Bytes;
+    return Attr < RHS.Attr;
+  }
+};
+}
+
+/// Walk the DIEs of a unit without building the DIE tree, and add the size of
+/// each attribute value to Attrs. Returns the number of DIEs.
+static uint32_t collectUnitStatistics(const DWARFUnit *U,
+                                      std::map<uint16_t, AttributeStats> &Attrs,
+                                      uint64_t &AbbrevCodeBytes) {
+  DataExtractor Data = U->getDebugInfoExtractor();
+  const DWARFAbbreviationDeclarationSet *Abbrevs = U->getAbbreviations();
+  uint32_t Offset = U->getFirstDIEOffset();
+  uint32_t End = U->getNextUnitOffset();
+  uint32_t NumDIEs = 0;
+  while (Offset < End && Data.isValidOffset(Offset)) {
+    uint32_t DIEOffset = Offset;
+    uint64_t AbbrCode = Data.getULEB128(&Offset);
+    AbbrevCodeBytes += Offset - DIEOffset;
+    if (AbbrCode == 0)
+      continue;
+    const DWARFAbbreviationDeclaration *AbbrevDecl =
+        Abbrevs ? Abbrevs->getAbbreviationDeclaration(AbbrCode) : 0;
+    if (!AbbrevDecl)
+      break;
+    ++NumDIEs;
+    for (uint32_t i = 0, n = AbbrevDecl->getNumAttributes(); i != n; ++i) {
+      uint32_t ValueOffset = Offset;
+      if (!DWARFFormValue::skipValue(AbbrevDecl->getFormByIndex(i), Data,
+                                     &Offset, U))
+        return NumDIEs;
+      AttributeStats &Stats = Attrs[AbbrevDecl->getAttrByIndex(i)];
+      Stats.Attr = AbbrevDecl->getAttrByIndex(i);
+      ++Stats.Count;
+      Stats.Bytes += Offset - ValueOffset;
+    }
+  }
+  return NumDIEs;
+}
+
+void DWARFContext::dumpStatistics(raw_ostream &OS) {
+  std::map<uint16_t, AttributeStats> Attrs;
+  uint64_t AbbrevCodeBytes = 0;
+
+  OS << ".debug_info: " << getInfoSection().Data.size() << " bytes, "
+     << getNumCompileUnits() << " compile units\n";
+  for (unsigned i = 0, e = getNumCompileUnits(); i != e; ++i) {
+    DWARFCompileUnit *CU = getCompileUnitAtIndex(i);
+    uint32_t NumDIEs = collectUnitStatistics(CU, Attrs, AbbrevCodeBytes);
+    const char *Name = "<unknown>";
+    if (const DWARFDebugInfoEntryMinimal *CUDie = CU->getCompileUnitDIE(true))
+      Name = CUDie->getAttributeValueAsString(CU, DW_AT_name, Name);
+    OS << format("  0x%08x: %8u bytes, %7u DIEs  ", CU->getOffset(),
+                 CU->getLength() + 4, NumDIEs)
+       << Name << '\n';
+  }
+
+  // Type units with the same signature describe the same type; all but one
+  // copy would be dropped by a linker that deduplicates COMDATs.
+  DenseMap<uint64_t, unsigned> TypeHashes;
+  uint64_t TypeUnitBytes = 0, DuplicateTypeUnits = 0, DuplicateTypeBytes = 0;
+  for (unsigned i = 0, e = getNumTypeUnits(); i != e; ++i) {
+    DWARFTypeUnit *TU = getTypeUnitAtIndex(i);
+    collectUnitStatistics(TU, Attrs, AbbrevCodeBytes);
+    uint32_t Size = TU->getLength() + 4;
+    TypeUnitBytes += Size;
+    if (TypeHashes[TU->getTypeHash()]++) {
+      ++DuplicateTypeUnits;
+      DuplicateTypeBytes += Size;
+    }
+  }
+  OS << ".debug_types: " << TypeUnitBytes << " bytes, " << getNumTypeUnits()
+     << " type units, " << DuplicateTypeUnits << " duplicates ("
+     << DuplicateTypeBytes << " bytes)\n";
+
+  std::vector<AttributeStats> SortedAttrs;
+  for (std::map<uint16_t, AttributeStats>::const_iterator I = Attrs.begin(),
+       E = Attrs.end(); I != E; ++I)
+    SortedAttrs.push_back(I->second);
+  std::sort(SortedAttrs.begin(), SortedAttrs.end());
+  OS << "Attribute bytes:\n";
+  OS << format("  %-32s %10" PRIu64 "\n",
+               static_cast<const char *>("<abbreviation codes>"),
+               AbbrevCodeBytes);
+  for (unsigned i = 0, e = SortedAttrs.size(); i != e; ++i) {
+    const AttributeStats &Stats = SortedAttrs[i];
+    std::string Name;
+    if (const char *AttrName = AttributeString(Stats.Attr))
+      Name = AttrName;
+    else
+      Name = (Twine("DW_AT_Unknown_0x") + Twine::utohexstr(Stats.Attr)).str();
+    OS << format("  %-32s %10" PRIu64 " in %" PRIu64 " values\n",
+                 Name.c_str(), Stats.Bytes, Stats.Count);
+  }
+
+  // Count strings that appear more than once in the string pool.
+  StringRef Strings = getStringSection();
+  StringMap<unsigned> Seen;
+  uint64_t NumStrings = 0, DuplicateStrings = 0, DuplicateStringBytes = 0;
+  for (size_t Pos = 0; Pos < Strings.size(); ) {
+    size_t Nul = Strings.find('\0', Pos);
+    if (Nul == StringRef::npos)
+      Nul = Strings.size();
+    StringRef Str = Strings.slice(Pos, Nul);
+    ++NumStrings;
+    if (Seen[Str]++) {
+      ++DuplicateStrings;
+      DuplicateStringBytes += Str.size() + 1;
+    }
+    Pos = Nul + 1;
+  }
+  OS << ".debug_str: " << Strings.size() << " bytes, " << NumStrings
+     << " strings, " << DuplicateStrings << " duplicates ("
+     << DuplicateStringBytes << " bytes)\n";
+}
+
 const DWARFDebugAbbrev *DWARFContext::getDebugAbbrev() {
   if (Abbrev)
     return Abbrev.get();
@@ -556,6 +684,11 @@ DIInliningInfo DWARFContext::getInliningInfoForAddress(uint64_t Address,
   return InliningInfo;
 }
 
+bool DWARFContext::getCFARuleForAddress(uint64_t Address, uint64_t &Register,
+                                        int64_t &Offset) {
+  return getDebugFrame()->getCFARuleAt(Address, Register, Offset);
+}
+
 static bool consumeCompressedDebugSectionHeader(StringRef &data,
                                                 uint64_t &OriginalSize) {
   // Consume "ZLIB" prefix.
@@ -68,6 +68,8 @@ public:
 
   virtual void dump(raw_ostream &OS, DIDumpType DumpType = DIDT_All);
 
+  virtual void dumpStatistics(raw_ostream &OS);
+
   /// Get the number of compile units in this context.
   unsigned getNumCompileUnits() {
     if (CUs.empty())
@@ -135,6 +137,8 @@ public:
       uint64_t Size, DILineInfoSpecifier Specifier = DILineInfoSpecifier());
   virtual DIInliningInfo getInliningInfoForAddress(uint64_t Address,
       DILineInfoSpecifier Specifier = DILineInfoSpecifier());
+  virtual bool getCFARuleForAddress(uint64_t Address, uint64_t &Register,
+                                    int64_t &Offset);
 
   virtual bool isLittleEndian() const = 0;
   virtual uint8_t getAddressSize() const = 0;
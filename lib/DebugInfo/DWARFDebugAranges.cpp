@@ -36,6 +36,8 @@ void DWARFDebugAranges::extract(DataExtractor DebugArangesData) {
   for (RangeSetColl::const_iterator I = Sets.begin(), E = Sets.end(); I != E;
        ++I) {
     uint32_t CUOffset = I->getCompileUnitDIEOffset();
+    // Units described here don't need their DIEs scanned in generate().
+    ParsedCUOffsets.insert(CUOffset);
 
     for (uint32_t i = 0, n = I->getNumDescriptors(); i < n; ++i) {
       const DWARFDebugArangeSet::Descriptor *ArangeDescPtr =
@@ -58,7 +60,9 @@ void DWARFDebugAranges::generate(DWARFContext *CTX) {
 
   // Generate aranges from DIEs: even if .debug_aranges section is present,
   // it may describe only a small subset of compilation units, so we need to
-  // manually build aranges for the rest of them.
+  // manually build aranges for the rest of them. Most units describe their
+  // own address ranges in the compile unit DIE, so this rarely needs to parse
+  // more than one DIE per unit.
   for (uint32_t i = 0, n = CTX->getNumCompileUnits(); i < n; ++i) {
     if (DWARFCompileUnit *CU = CTX->getCompileUnitAtIndex(i)) {
       uint32_t CUOffset = CU->getOffset();
@@ -14,6 +14,7 @@
 #include "llvm/Support/Dwarf.h"
 #include "llvm/Support/Format.h"
 #include "llvm/Support/raw_ostream.h"
+#include <algorithm>
 #include <string>
 #include <vector>
 
@@ -47,6 +48,22 @@ public:
   /// \brief Dump the entry's instructions to the given output stream.
   virtual void dumpInstructions(raw_ostream &OS) const;
 
+  /// \brief The CFA rule being computed by evaluateCFA.
+  struct CFARule {
+    uint64_t Register;
+    int64_t Offset;
+    bool IsRegisterPlusOffset;
+    CFARule() : Register(0), Offset(0), IsRegisterPlusOffset(false) {}
+  };
+
+  /// \brief Apply the entry's instructions to Rule, for code at Address.
+  /// Loc is the address the instructions start describing; it is updated by
+  /// the advance instructions. Returns false once Loc moves past Address,
+  /// after which no more instructions apply.
+  bool evaluateCFA(uint64_t Address, uint64_t &Loc, uint64_t CodeAlign,
+                   int64_t DataAlign, CFARule &Rule,
+                   std::vector<CFARule> &Stack) const;
+
 protected:
   const FrameKind Kind;
 
@@ -196,6 +213,69 @@ void FrameEntry::dumpInstructions(raw_ostream &OS) const {
 }
 
 
+bool FrameEntry::evaluateCFA(uint64_t Address, uint64_t &Loc,
+                             uint64_t CodeAlign, int64_t DataAlign,
+                             CFARule &Rule,
+                             std::vector<CFARule> &Stack) const {
+  for (std::vector<Instruction>::const_iterator I = Instructions.begin(),
+                                                E = Instructions.end();
+       I != E; ++I) {
+    switch (I->Opcode) {
+    case DW_CFA_set_loc:
+      Loc = I->Ops[0];
+      break;
+    case DW_CFA_advance_loc:
+    case DW_CFA_advance_loc1:
+    case DW_CFA_advance_loc2:
+    case DW_CFA_advance_loc4:
+      Loc += I->Ops[0] * CodeAlign;
+      break;
+    case DW_CFA_def_cfa:
+      Rule.Register = I->Ops[0];
+      Rule.Offset = I->Ops[1];
+      Rule.IsRegisterPlusOffset = true;
+      continue;
+    case DW_CFA_def_cfa_sf:
+      Rule.Register = I->Ops[0];
+      Rule.Offset = static_cast<int64_t>(I->Ops[1]) * DataAlign;
+      Rule.IsRegisterPlusOffset = true;
+      continue;
+    case DW_CFA_def_cfa_register:
+      Rule.Register = I->Ops[0];
+      continue;
+    case DW_CFA_def_cfa_offset:
+      Rule.Offset = I->Ops[0];
+      continue;
+    case DW_CFA_def_cfa_offset_sf:
+      Rule.Offset = static_cast<int64_t>(I->Ops[0]) * DataAlign;
+      continue;
+    case DW_CFA_remember_state:
+      Stack.push_back(Rule);
+      continue;
+    case DW_CFA_restore_state:
+      if (!Stack.empty()) {
+        Rule = Stack.back();
+        Stack.pop_back();
+      }
+      continue;
+    case DW_CFA_def_cfa_expression:
+      // The parser rejects expressions for now, but should it accept them
+      // the CFA stops being a register plus an offset.
+      Rule.IsRegisterPlusOffset = false;
+      continue;
+    default:
+      // Register rules don't affect the CFA.
+      continue;
+    }
+    // A location was changed; the rules so far are the ones at Address if
+    // the row now starts after it.
+    if (Loc > Address)
+      return false;
+  }
+  return true;
+}
+
+
 namespace {
 /// \brief DWARF Common Information Entry (CIE)
 class CIE : public FrameEntry {
@@ -232,6 +312,9 @@ public:
     return FE->getKind() == FK_CIE;
   } 
 
+  uint64_t getCodeAlignmentFactor() const { return CodeAlignmentFactor; }
+  int64_t getDataAlignmentFactor() const { return DataAlignmentFactor; }
+
 private:
   /// The following fields are defined in section 6.4.1 of the DWARF standard v3
   uint8_t Version;
@@ -272,6 +355,15 @@ public:
   static bool classof(const FrameEntry *FE) {
     return FE->getKind() == FK_FDE;
   } 
+
+  uint64_t getLinkedCIEOffset() const { return LinkedCIEOffset; }
+  uint64_t getInitialLocation() const { return InitialLocation; }
+  uint64_t getAddressRange() const { return AddressRange; }
+
+  static bool orderByInitialLocation(const FrameEntry *LHS,
+                                     const FrameEntry *RHS) {
+    return cast<FDE>(LHS)->InitialLocation < cast<FDE>(RHS)->InitialLocation;
+  }
 private:
 
   /// The following fields are defined in section 6.4.1 of the DWARF standard v3
@@ -367,6 +459,8 @@ void DWARFDebugFrame::parse(DataExtractor Data) {
     if (Offset == EndStructureOffset) {
       // Entry instrucitons parsed successfully.
       Entries.push_back(Entry);
+      if (isa<FDE>(Entry))
+        FDEsByAddress.push_back(Entry);
     } else {
       std::string Str;
       raw_string_ostream OS(Str);
@@ -375,6 +469,73 @@ void DWARFDebugFrame::parse(DataExtractor Data) {
       report_fatal_error(Str);
     }
   }
+
+  std::stable_sort(FDEsByAddress.begin(), FDEsByAddress.end(),
+                   FDE::orderByInitialLocation);
+}
+
+
+namespace {
+struct EntryOffsetLess {
+  bool operator()(const FrameEntry *LHS, uint64_t Offset) const {
+    return LHS->getOffset() < Offset;
+  }
+};
+struct FDEAddressLess {
+  bool operator()(uint64_t Address, const FrameEntry *RHS) const {
+    return Address < cast<FDE>(RHS)->getInitialLocation();
+  }
+};
+}
+
+const FrameEntry *DWARFDebugFrame::findFDE(uint64_t Address) const {
+  // Find the last FDE starting at or before Address.
+  EntryVector::const_iterator I =
+      std::upper_bound(FDEsByAddress.begin(), FDEsByAddress.end(), Address,
+                       FDEAddressLess());
+  if (I == FDEsByAddress.begin())
+    return 0;
+  const FDE *F = cast<FDE>(*--I);
+  if (Address - F->getInitialLocation() >= F->getAddressRange())
+    return 0;
+  return F;
+}
+
+const FrameEntry *DWARFDebugFrame::findEntryAtOffset(uint64_t Offset) const {
+  // Entries are stored in the order they appear in the section.
+  EntryVector::const_iterator I =
+      std::lower_bound(Entries.begin(), Entries.end(), Offset,
+                       EntryOffsetLess());
+  if (I == Entries.end() || (*I)->getOffset() != Offset)
+    return 0;
+  return *I;
+}
+
+bool DWARFDebugFrame::getCFARuleAt(uint64_t Address, uint64_t &Register,
+                                   int64_t &Offset) const {
+  const FDE *F = cast_or_null<FDE>(findFDE(Address));
+  if (!F)
+    return false;
+  const CIE *C = dyn_cast_or_null<CIE>(findEntryAtOffset(
+      F->getLinkedCIEOffset()));
+  if (!C)
+    return false;
+
+  FrameEntry::CFARule Rule;
+  std::vector<FrameEntry::CFARule> Stack;
+  uint64_t Loc = F->getInitialLocation();
+  // The CIE's initial instructions set up the rules at the start of every
+  // FDE; they don't advance the location.
+  C->evaluateCFA(Address, Loc, C->getCodeAlignmentFactor(),
+                 C->getDataAlignmentFactor(), Rule, Stack);
+  Loc = F->getInitialLocation();
+  F->evaluateCFA(Address, Loc, C->getCodeAlignmentFactor(),
+                 C->getDataAlignmentFactor(), Rule, Stack);
+  if (!Rule.IsRegisterPlusOffset)
+    return false;
+  Register = Rule.Register;
+  Offset = Rule.Offset;
+  return true;
 }
 
 
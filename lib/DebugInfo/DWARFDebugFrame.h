@@ -34,9 +34,23 @@ public:
   /// data is assumed to be pointing to the beginning of the section.
   void parse(DataExtractor Data);
 
+  /// \brief Find the rule for computing the canonical frame address at
+  /// Address: the CFA is the value of register Register plus Offset. Returns
+  /// false if no FDE covers Address or the CFA isn't defined by a register
+  /// and offset there.
+  bool getCFARuleAt(uint64_t Address, uint64_t &Register,
+                    int64_t &Offset) const;
+
 private:
+  /// \brief Returns the FDE whose address range contains Address, or null.
+  const FrameEntry *findFDE(uint64_t Address) const;
+  /// \brief Returns the entry starting at the given offset, or null.
+  const FrameEntry *findEntryAtOffset(uint64_t Offset) const;
+
   typedef std::vector<FrameEntry *> EntryVector;
   EntryVector Entries;
+  /// \brief The FDEs in Entries, sorted by initial location.
+  EntryVector FDEsByAddress;
 };
 
 
@@ -28,7 +28,7 @@ void DWARFDebugInfoEntryMinimal::dump(raw_ostream &OS, const DWARFUnit *u,
   if (debug_info_data.isValidOffset(offset)) {
     uint32_t abbrCode = debug_info_data.getULEB128(&offset);
 
-    OS << format("\n0x%8.8x: ", Offset);
+    OS << '\n' << format_hex(Offset, 10) << ": ";
     if (abbrCode) {
       if (AbbrevDecl) {
         const char *tagString = TagString(getTag());
@@ -115,6 +115,14 @@ bool DWARFDebugInfoEntryMinimal::extractFast(const DWARFUnit *U,
       U->getAddressByteSize(), U->getVersion());
   assert(FixedFormSizes.size() > 0);
 
+  // Skip the attributes in one step if none of them has a variable size.
+  uint32_t FixedAttributesSize;
+  if (AbbrevDecl->getFixedAttributesByteSize(FixedFormSizes,
+                                             FixedAttributesSize)) {
+    *OffsetPtr += FixedAttributesSize;
+    return true;
+  }
+
   // Skip all data in the .debug_info for the attributes
   for (uint32_t i = 0, n = AbbrevDecl->getNumAttributes(); i < n; ++i) {
     uint16_t Form = AbbrevDecl->getFormByIndex(i);
@@ -155,8 +155,13 @@ DWARFDebugLine::getOrParseLineTable(DataExtractor debug_line_data,
   if (pos.second) {
     // Parse and cache the line table for at this offset.
     State state;
-    if (!parseStatementTable(debug_line_data, RelocMap, &offset, state))
+    if (!parseStatementTable(debug_line_data, RelocMap, &offset, state)) {
+      // Don't leave an empty table behind for later lookups to find.
+      LineTableMap.erase(pos.first);
       return 0;
+    }
+    // Copying the rows out of the parse state, rather than swapping them,
+    // leaves the cached table without the spare capacity from growing it.
     pos.first->second = state;
   }
   return &pos.first->second;
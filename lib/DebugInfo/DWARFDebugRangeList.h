@@ -71,6 +71,12 @@ public:
   /// address. Has to be passed base address of the compile unit that
   /// references this range list.
   bool containsAddress(uint64_t BaseAddress, uint64_t Address) const;
+  /// getAbsoluteRanges - Appends the [LowPC, HighPC) address ranges in the
+  /// list to Ranges, resolving base address selection entries. Has to be
+  /// passed base address of the compile unit that references this range list.
+  void getAbsoluteRanges(
+      uint64_t BaseAddress,
+      std::vector<std::pair<uint64_t, uint64_t> > &Ranges) const;
 };
 
 }  // namespace llvm
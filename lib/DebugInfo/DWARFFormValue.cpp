@@ -366,23 +366,23 @@ DWARFFormValue::dump(raw_ostream &OS, const DWARFUnit *cu) const {
   bool cu_relative_offset = false;
 
   switch (Form) {
-  case DW_FORM_addr:      OS << format("0x%016" PRIx64, uvalue); break;
+  case DW_FORM_addr:      OS << format_hex(uvalue, 18); break;
   case DW_FORM_GNU_addr_index: {
     OS << format(" indexed (%8.8x) address = ", (uint32_t)uvalue);
     uint64_t Address;
     if (cu->getAddrOffsetSectionItem(uvalue, Address))
-      OS << format("0x%016" PRIx64, Address);
+      OS << format_hex(Address, 18);
     else
       OS << "<no .debug_addr section>";
     break;
   }
   case DW_FORM_flag_present: OS << "true"; break;
   case DW_FORM_flag:
-  case DW_FORM_data1:     OS << format("0x%02x", (uint8_t)uvalue); break;
-  case DW_FORM_data2:     OS << format("0x%04x", (uint16_t)uvalue); break;
-  case DW_FORM_data4:     OS << format("0x%08x", (uint32_t)uvalue); break;
+  case DW_FORM_data1:     OS << format_hex((uint8_t)uvalue, 4); break;
+  case DW_FORM_data2:     OS << format_hex((uint16_t)uvalue, 6); break;
+  case DW_FORM_data4:     OS << format_hex((uint32_t)uvalue, 10); break;
   case DW_FORM_ref_sig8:
-  case DW_FORM_data8:     OS << format("0x%016" PRIx64, uvalue); break;
+  case DW_FORM_data8:     OS << format_hex(uvalue, 18); break;
   case DW_FORM_string:
     OS << '"';
     OS.write_escaped(Value.cstr);
@@ -440,7 +440,7 @@ DWARFFormValue::dump(raw_ostream &OS, const DWARFUnit *cu) const {
     break;
   }
   case DW_FORM_ref_addr:
-    OS << format("0x%016" PRIx64, uvalue);
+    OS << format_hex(uvalue, 18);
     break;
   case DW_FORM_ref1:
     cu_relative_offset = true;
@@ -471,7 +471,7 @@ DWARFFormValue::dump(raw_ostream &OS, const DWARFUnit *cu) const {
 
     // Should be formatted to 64-bit for DWARF64.
   case DW_FORM_sec_offset:
-    OS << format("0x%08x", (uint32_t)uvalue);
+    OS << format_hex((uint32_t)uvalue, 10);
     break;
 
   default:
@@ -23,14 +23,14 @@ bool DWARFTypeUnit::extractImpl(DataExtractor debug_info,
 }
 
 void DWARFTypeUnit::dump(raw_ostream &OS) {
-  OS << format("0x%08x", getOffset()) << ": Type Unit:"
-     << " length = " << format("0x%08x", getLength())
-     << " version = " << format("0x%04x", getVersion())
-     << " abbr_offset = " << format("0x%04x", getAbbreviations()->getOffset())
-     << " addr_size = " << format("0x%02x", getAddressByteSize())
+  OS << format_hex(getOffset(), 10) << ": Type Unit:"
+     << " length = " << format_hex(getLength(), 10)
+     << " version = " << format_hex(getVersion(), 6)
+     << " abbr_offset = " << format_hex(getAbbreviations()->getOffset(), 6)
+     << " addr_size = " << format_hex(getAddressByteSize(), 4)
      << " type_signature = " << format("0x%16" PRIx64, TypeHash)
-     << " type_offset = " << format("0x%04x", TypeOffset)
-     << " (next unit at " << format("0x%08x", getNextUnitOffset())
+     << " type_offset = " << format_hex(TypeOffset, 6)
+     << " (next unit at " << format_hex(getNextUnitOffset(), 10)
      << ")\n";
 
   const DWARFDebugInfoEntryMinimal *CU = getCompileUnitDIE(false);
@@ -24,6 +24,7 @@ public:
                 const RelocAddrMap *M, bool LE)
       : DWARFUnit(DA, IS, AS, RS, SS, SOS, AOS, M, LE) {}
   uint32_t getSize() const LLVM_OVERRIDE { return DWARFUnit::getSize() + 12; }
+  uint64_t getTypeHash() const { return TypeHash; }
   void dump(raw_ostream &OS);
 protected:
   bool extractImpl(DataExtractor debug_info, uint32_t *offset_ptr) LLVM_OVERRIDE;
@@ -304,7 +304,13 @@ DWARFUnit::buildAddressRangeTable(DWARFDebugAranges *debug_aranges,
                                          uint32_t CUOffsetInAranges) {
   // This function is usually called if there in no .debug_aranges section
   // in order to produce a compile unit level set of address ranges that
-  // is accurate. If the DIEs weren't parsed, then we don't want all dies for
+  // is accurate. The compile unit DIE normally describes the unit's code with
+  // DW_AT_low_pc/DW_AT_high_pc or DW_AT_ranges, which is all we need, so try
+  // that before parsing the whole unit.
+  if (appendCompileUnitRanges(debug_aranges, CUOffsetInAranges))
+    return;
+
+  // If the DIEs weren't parsed, then we don't want all dies for
   // all compile units to stay loaded when they weren't needed. So we can end
   // up parsing the DWARF and then throwing them all away to keep memory usage
   // down.
@@ -328,6 +334,35 @@ DWARFUnit::buildAddressRangeTable(DWARFDebugAranges *debug_aranges,
     clearDIEs(true);
 }
 
+bool DWARFUnit::appendCompileUnitRanges(DWARFDebugAranges *debug_aranges,
+                                        uint32_t CUOffsetInAranges) {
+  const DWARFDebugInfoEntryMinimal *CUDie = getCompileUnitDIE(true);
+  if (!CUDie)
+    return false;
+
+  uint64_t LowPC, HighPC;
+  if (CUDie->getLowAndHighPC(this, LowPC, HighPC)) {
+    if (LowPC < HighPC)
+      debug_aranges->appendRange(CUOffsetInAranges, LowPC, HighPC);
+    return true;
+  }
+
+  uint32_t RangesOffset =
+      CUDie->getAttributeValueAsSectionOffset(this, DW_AT_ranges, -1U);
+  if (RangesOffset == -1U)
+    return false;
+  DWARFDebugRangeList RangeList;
+  if (!extractRangeList(RangesOffset, RangeList))
+    return false;
+  std::vector<std::pair<uint64_t, uint64_t> > Ranges;
+  RangeList.getAbsoluteRanges(getBaseAddress(), Ranges);
+  for (size_t i = 0, n = Ranges.size(); i != n; ++i)
+    if (Ranges[i].first < Ranges[i].second)
+      debug_aranges->appendRange(CUOffsetInAranges, Ranges[i].first,
+                                 Ranges[i].second);
+  return true;
+}
+
 const DWARFDebugInfoEntryMinimal *
 DWARFUnit::getSubprogramForAddress(uint64_t Address) {
   extractDIEsIfNeeded(false);
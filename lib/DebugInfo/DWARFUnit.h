@@ -153,6 +153,12 @@ private:
   /// clearDIEs - Clear parsed DIEs to keep memory usage low.
   void clearDIEs(bool KeepCUDie);
 
+  /// appendCompileUnitRanges - Appends the address ranges described by the
+  /// compile unit DIE itself. Returns false if the DIE doesn't describe them,
+  /// in which case the ranges of the subprogram DIEs must be used instead.
+  bool appendCompileUnitRanges(DWARFDebugAranges *debug_aranges,
+                               uint32_t CUOffsetInAranges);
+
   /// parseDWO - Parses .dwo file for current compile unit. Returns true if
   /// it was actually constructed.
   bool parseDWO();
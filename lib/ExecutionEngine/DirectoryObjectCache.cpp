@@ -0,0 +1,174 @@
+//===-- DirectoryObjectCache.cpp - On-disk cache of MCJIT objects ---------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements DirectoryObjectCache.  Every failure is treated as a
+// cache miss: a cache that cannot be read or written only costs compile time.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "object-cache"
+#include "llvm/ExecutionEngine/DirectoryObjectCache.h"
+#include "llvm/ADT/OwningPtr.h"
+#include "llvm/Bitcode/ReaderWriter.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/FileOutputBuffer.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/TimeValue.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#if !defined(_MSC_VER) && !defined(__MINGW32__)
+#include <unistd.h>
+#else
+#include <io.h>
+#endif
+
+using namespace llvm;
+
+DirectoryObjectCache::DirectoryObjectCache(StringRef CacheDir,
+                                           StringRef Configuration,
+                                           uint64_t MaxSize)
+  : CacheDir(CacheDir), Configuration(Configuration), MaxSize(MaxSize) {
+}
+
+DirectoryObjectCache::~DirectoryObjectCache() {
+}
+
+/// getCachePath - Compute the file that holds the object for M.
+void DirectoryObjectCache::getCachePath(const Module *M,
+                                        SmallVectorImpl<char> &Path) const {
+  SmallString<0> Bitcode;
+  raw_svector_ostream OS(Bitcode);
+  WriteBitcodeToFile(M, OS);
+  OS.flush();
+
+  // Separate the fields with a NUL so that moving characters between the
+  // triple and the configuration changes the key.
+  MD5 Hash;
+  Hash.update(Bitcode.str());
+  Hash.update(StringRef("\0", 1));
+  Hash.update(M->getTargetTriple());
+  Hash.update(StringRef("\0", 1));
+  Hash.update(Configuration);
+  MD5::MD5Result Result;
+  Hash.final(Result);
+  SmallString<32> Name;
+  MD5::stringifyResult(Result, Name);
+  Name += ".o";
+
+  Path.clear();
+  Path.append(CacheDir.begin(), CacheDir.end());
+  sys::path::append(Path, Name.str());
+}
+
+void DirectoryObjectCache::notifyObjectCompiled(const Module *M,
+                                                const MemoryBuffer *Obj) {
+  if (error_code EC = sys::fs::create_directories(CacheDir)) {
+    DEBUG(dbgs() << "object cache: cannot create " << CacheDir << ": "
+                 << EC.message() << '\n');
+    return;
+  }
+
+  SmallString<128> Path;
+  getCachePath(M, Path);
+
+  // FileOutputBuffer writes to a unique temporary file and renames it over
+  // Path on commit, so readers see either the old object or the new one.
+  OwningPtr<FileOutputBuffer> Out;
+  if (FileOutputBuffer::create(Path.str(), Obj->getBufferSize(), Out))
+    return;
+  std::memcpy(Out->getBufferStart(), Obj->getBufferStart(),
+              Obj->getBufferSize());
+  if (error_code EC = Out->commit()) {
+    DEBUG(dbgs() << "object cache: cannot write " << Path << ": "
+                 << EC.message() << '\n');
+    return;
+  }
+
+  if (MaxSize)
+    pruneCache();
+}
+
+MemoryBuffer *DirectoryObjectCache::getObject(const Module *M) {
+  SmallString<128> Path;
+  getCachePath(M, Path);
+
+  int FD;
+  if (sys::fs::openFileForRead(Path.str(), FD))
+    return 0;
+
+  OwningPtr<MemoryBuffer> Obj;
+  sys::fs::file_status Status;
+  if (!sys::fs::status(Path.str(), Status))
+    MemoryBuffer::getOpenFile(FD, Path.c_str(), Obj, Status.getSize(),
+                              /*RequiresNullTerminator=*/false);
+
+  // Mark the object as recently used so that pruning keeps it.
+  if (Obj)
+    sys::fs::setLastModificationAndAccessTime(FD, sys::TimeValue::now());
+  ::close(FD);
+
+  DEBUG(if (Obj)
+          dbgs() << "object cache: hit for " << M->getModuleIdentifier()
+                 << " in " << Path << '\n');
+  return Obj.take();
+}
+
+namespace {
+  struct CacheEntry {
+    std::string Path;
+    sys::TimeValue LastUse;
+    uint64_t Size;
+  };
+
+  struct OrderByLastUse {
+    bool operator()(const CacheEntry &A, const CacheEntry &B) const {
+      return A.LastUse < B.LastUse;
+    }
+  };
+}
+
+/// pruneCache - Delete the least recently used objects until the cache
+/// directory holds at most MaxSize bytes of objects.
+void DirectoryObjectCache::pruneCache() {
+  std::vector<CacheEntry> Entries;
+  uint64_t TotalSize = 0;
+
+  error_code EC;
+  for (sys::fs::directory_iterator I(CacheDir, EC), E; I != E && !EC;
+       I.increment(EC)) {
+    // Only consider finished objects; temporaries from concurrent writers
+    // do not have the extension yet.
+    if (sys::path::extension(I->path()) != ".o")
+      continue;
+    sys::fs::file_status Status;
+    if (I->status(Status) || !sys::fs::is_regular_file(Status))
+      continue;
+    CacheEntry Entry;
+    Entry.Path = I->path();
+    Entry.LastUse = Status.getLastModificationTime();
+    Entry.Size = Status.getSize();
+    TotalSize += Entry.Size;
+    Entries.push_back(Entry);
+  }
+
+  if (TotalSize <= MaxSize)
+    return;
+
+  std::sort(Entries.begin(), Entries.end(), OrderByLastUse());
+  for (unsigned i = 0, e = Entries.size(); i != e && TotalSize > MaxSize; ++i) {
+    DEBUG(dbgs() << "object cache: evicting " << Entries[i].Path << '\n');
+    if (!sys::fs::remove(Entries[i].Path))
+      TotalSize -= Entries[i].Size;
+  }
+}
@@ -37,7 +37,7 @@ static cl::opt<bool> PrintVolatile("interpreter-print-volatile", cl::Hidden,
 //                     Various Helper Functions
 //===----------------------------------------------------------------------===//
 
-static void SetValue(Value *V, GenericValue Val, ExecutionContext &SF) {
+static void SetValue(Value *V, const GenericValue &Val, ExecutionContext &SF) {
   SF.Values[V] = Val;
 }
 
@@ -2053,15 +2053,14 @@ GenericValue Interpreter::getConstantExprValue (ConstantExpr *CE,
 }
 
 GenericValue Interpreter::getOperandValue(Value *V, ExecutionContext &SF) {
-  if (ConstantExpr *CE = dyn_cast<ConstantExpr>(V)) {
-    return getConstantExprValue(CE, SF);
-  } else if (Constant *CPV = dyn_cast<Constant>(V)) {
-    return getConstantValue(CPV);
-  } else if (GlobalValue *GV = dyn_cast<GlobalValue>(V)) {
-    return PTOGV(getPointerToGlobal(GV));
-  } else {
+  // Most operands are instructions or arguments of the current frame, so
+  // check for those before the constant cases.
+  if (!isa<Constant>(V))
     return SF.Values[V];
-  }
+
+  if (ConstantExpr *CE = dyn_cast<ConstantExpr>(V))
+    return getConstantExprValue(CE, SF);
+  return getConstantValue(cast<Constant>(V));
 }
 
 //===----------------------------------------------------------------------===//
@@ -8,6 +8,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "MCJIT.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ExecutionEngine/GenericValue.h"
 #include "llvm/ExecutionEngine/JITEventListener.h"
 #include "llvm/ExecutionEngine/JITMemoryManager.h"
@@ -21,6 +22,7 @@
 #include "llvm/IR/Function.h"
 #include "llvm/IR/Module.h"
 #include "llvm/MC/MCAsmInfo.h"
+#include "llvm/Object/StackMapParser.h"
 #include "llvm/Support/DynamicLibrary.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/MemoryBuffer.h"
@@ -87,6 +89,7 @@ MCJIT::~MCJIT() {
     }
   }
   LoadedObjects.clear();
+  DeleteContainerPointers(UnresolvedRemovedObjects);
   delete TM;
 }
 
@@ -97,10 +100,53 @@ void MCJIT::addModule(Module *M) {
 
 bool MCJIT::removeModule(Module *M) {
   MutexGuard locked(lock);
-  return OwnedModules.removeModule(M);
-}
+  bool Finalized = OwnedModules.hasModuleBeenFinalized(M);
+  if (!OwnedModules.removeModule(M))
+    return false;
+
+  // Lookups of the module's symbols must not be answered from the cache
+  // once the module is gone.
+  {
+    sys::ScopedWriter WriteLock(FinalizedSymbolsLock);
+    for (Module::iterator I = M->begin(), E = M->end(); I != E; ++I) {
+      FinalizedFunctions.erase(I->getName());
+      FinalizedGlobalValues.erase(I->getName());
+    }
+    for (Module::global_iterator I = M->global_begin(), E = M->global_end();
+         I != E; ++I)
+      FinalizedGlobalValues.erase(I->getName());
+  }
 
+  // The sections of a loaded module stay mapped: other modules may have been
+  // linked against them, and the memory manager interface has no way to
+  // give memory back.  Once its relocations are resolved the object image is
+  // only kept for the event listeners, though, so tell them and release it.
+  // Until then RuntimeDyld reads the original section contents from it.
+  LoadedObjectMap::iterator I = LoadedObjects.find(M);
+  if (I != LoadedObjects.end()) {
+    if (ObjectImage *Obj = I->second) {
+      NotifyFreeingObject(*Obj);
+      if (Finalized)
+        delete Obj;
+      else
+        UnresolvedRemovedObjects.push_back(Obj);
+    }
+    LoadedObjects.erase(I);
+  }
+  return true;
+}
 
+StringRef MCJIT::getStackMapSection(Module *M) {
+  MutexGuard locked(lock);
+  LoadedObjectMap::iterator I = LoadedObjects.find(M);
+  if (I == LoadedObjects.end() || !I->second)
+    return StringRef();
+  StringRef Data;
+  if (object::StackMapParser::findStackMapSection(*I->second->getObjectFile(),
+                                                  Data))
+    return StringRef();
+  return Data;
+}
 
 void MCJIT::setObjectCache(ObjectCache* NewCache) {
   MutexGuard locked(lock);
@@ -191,6 +237,9 @@ void MCJIT::finalizeLoadedModules() {
   // Resolve any outstanding relocations.
   Dyld.resolveRelocations();
 
+  // The images of removed modules were only kept for their relocations.
+  DeleteContainerPointers(UnresolvedRemovedObjects);
+
   OwnedModules.markAllLoadedModulesAsFinalized();
 
   // Register EH frame data for any module we own which has been loaded
@@ -282,19 +331,49 @@ uint64_t MCJIT::getSymbolAddress(const std::string &Name,
   return getExistingSymbolAddress(Name);
 }
 
+uint64_t MCJIT::getFinalizedSymbolAddress(const std::string &Name,
+                                          bool FunctionsOnly) {
+  sys::ScopedReader ReadLock(FinalizedSymbolsLock);
+  const StringMap<uint64_t> &Cache =
+    FunctionsOnly ? FinalizedFunctions : FinalizedGlobalValues;
+  StringMap<uint64_t>::const_iterator I = Cache.find(Name);
+  return I == Cache.end() ? 0 : I->second;
+}
+
+void MCJIT::addFinalizedSymbol(const std::string &Name, uint64_t Addr,
+                               bool FunctionsOnly) {
+  sys::ScopedWriter WriteLock(FinalizedSymbolsLock);
+  if (FunctionsOnly)
+    FinalizedFunctions[Name] = Addr;
+  else
+    FinalizedGlobalValues[Name] = Addr;
+}
+
 uint64_t MCJIT::getGlobalValueAddress(const std::string &Name) {
+  // Threads looking up code that is already finalized do not need to
+  // serialize on the engine lock.
+  if (uint64_t Result = getFinalizedSymbolAddress(Name, false))
+    return Result;
+
   MutexGuard locked(lock);
   uint64_t Result = getSymbolAddress(Name, false);
-  if (Result != 0)
+  if (Result != 0) {
     finalizeLoadedModules();
+    addFinalizedSymbol(Name, Result, false);
+  }
   return Result;
 }
 
 uint64_t MCJIT::getFunctionAddress(const std::string &Name) {
+  if (uint64_t Result = getFinalizedSymbolAddress(Name, true))
+    return Result;
+
   MutexGuard locked(lock);
   uint64_t Result = getSymbolAddress(Name, true);
-  if (Result != 0)
+  if (Result != 0) {
     finalizeLoadedModules();
+    addFinalizedSymbol(Name, Result, true);
+  }
   return Result;
 }
 
@@ -13,11 +13,13 @@
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ExecutionEngine/ExecutionEngine.h"
 #include "llvm/ExecutionEngine/ObjectCache.h"
 #include "llvm/ExecutionEngine/ObjectImage.h"
 #include "llvm/ExecutionEngine/RuntimeDyld.h"
 #include "llvm/IR/Module.h"
+#include "llvm/Support/RWMutex.h"
 
 namespace llvm {
 class MCJIT;
@@ -209,10 +211,28 @@ class MCJIT : public ExecutionEngine {
   typedef DenseMap<Module *, ObjectImage *> LoadedObjectMap;
   LoadedObjectMap  LoadedObjects;
 
+  // The object images of modules removed before their relocations were
+  // resolved, freed by the next finalization.
+  SmallVector<ObjectImage *, 2> UnresolvedRemovedObjects;
+
   // An optional ObjectCache to be notified of compiled objects and used to
   // perform lookup of pre-compiled code to avoid re-compilation.
   ObjectCache *ObjCache;
 
+  // Addresses returned by getFunctionAddress and getGlobalValueAddress once
+  // their modules were finalized, keyed by unmangled name.  These never
+  // change, so lookups check here under a shared reader lock before taking
+  // the engine lock.  getFunctionAddress only finds functions, so the two
+  // lookups have separate caches.
+  StringMap<uint64_t> FinalizedFunctions;
+  StringMap<uint64_t> FinalizedGlobalValues;
+  sys::RWMutex FinalizedSymbolsLock;
+
+  uint64_t getFinalizedSymbolAddress(const std::string &Name,
+                                     bool FunctionsOnly);
+  void addFinalizedSymbol(const std::string &Name, uint64_t Addr,
+                          bool FunctionsOnly);
+
   Function *FindFunctionNamedInModulePtrSet(const char *FnName,
                                             ModulePtrSet::iterator I,
                                             ModulePtrSet::iterator E);
@@ -252,6 +272,8 @@ public:
   virtual void finalizeModule(Module *);
   void finalizeLoadedModules();
 
+  virtual StringRef getStackMapSection(Module *M);
+
   /// runStaticConstructorsDestructors - This method is used to execute all of
   /// the static constructors or destructors for a program.
   ///
@@ -15,6 +15,8 @@
 #include "llvm/Config/config.h"
 #include "llvm/ExecutionEngine/SectionMemoryManager.h"
 #include "llvm/Support/MathExtras.h"
+#include "llvm/Support/Process.h"
+#include <algorithm>
 
 namespace llvm {
 
@@ -58,21 +60,21 @@ uint8_t *SectionMemoryManager::allocateSection(MemoryGroup &MemGroup,
       // Store cutted free memory block.
       MemGroup.FreeMem[i] = sys::MemoryBlock((void*)(Addr + Size),
                                              EndOfBlock - Addr - Size);
+      MemGroup.PendingMem.push_back(sys::MemoryBlock((void*)Addr, Size));
       return (uint8_t*)Addr;
     }
   }
 
-  // No pre-allocated free block was large enough. Allocate a new memory region.
-  // Note that all sections get allocated as read-write.  The permissions will
-  // be updated later based on memory group.
-  //
-  // FIXME: It would be useful to define a default allocation size (or add
-  // it as a constructor parameter) to minimize the number of allocations.
+  // No pre-allocated free block was large enough. Allocate a new memory region
+  // of at least SlabSize bytes; the rest is kept as a free block for the next
+  // sections.  Note that all sections get allocated as read-write.  The
+  // permissions will be updated later based on memory group.
   //
   // FIXME: Initialize the Near member for each memory group to avoid
   // interleaving.
   error_code ec;
-  sys::MemoryBlock MB = sys::Memory::allocateMappedMemory(RequiredSize,
+  sys::MemoryBlock MB = sys::Memory::allocateMappedMemory(std::max(RequiredSize,
+                                                                   SlabSize),
                                                           &MemGroup.Near,
                                                           sys::Memory::MF_READ |
                                                             sys::Memory::MF_WRITE,
@@ -94,9 +96,10 @@ uint8_t *SectionMemoryManager::allocateSection(MemoryGroup &MemGroup,
 
   // The allocateMappedMemory may allocate much more memory than we need. In
   // this case, we store the unused memory as a free memory block.
-  unsigned FreeSize = EndOfBlock-Addr-Size;
+  uintptr_t FreeSize = EndOfBlock-Addr-Size;
   if (FreeSize > 16)
     MemGroup.FreeMem.push_back(sys::MemoryBlock((void*)(Addr + Size), FreeSize));
+  MemGroup.PendingMem.push_back(sys::MemoryBlock((void*)Addr, Size));
 
   // Return aligned address
   return (uint8_t*)Addr;
@@ -107,9 +110,6 @@ bool SectionMemoryManager::finalizeMemory(std::string *ErrMsg)
   // FIXME: Should in-progress permissions be reverted if an error occurs?
   error_code ec;
 
-  // Don't allow free memory blocks to be used after setting protection flags.
-  CodeMem.FreeMem.clear();
-
   // Make code memory executable.
   ec = applyMemoryGroupPermissions(CodeMem,
                                    sys::Memory::MF_READ | sys::Memory::MF_EXEC);
@@ -120,9 +120,6 @@ bool SectionMemoryManager::finalizeMemory(std::string *ErrMsg)
     return true;
   }
 
-  // Don't allow free memory blocks to be used after setting protection flags.
-  RODataMem.FreeMem.clear();
-
   // Make read-only data memory read-only.
   ec = applyMemoryGroupPermissions(RODataMem,
                                    sys::Memory::MF_READ | sys::Memory::MF_EXEC);
@@ -140,30 +137,52 @@ bool SectionMemoryManager::finalizeMemory(std::string *ErrMsg)
   // relocations) will get to the data cache but not to the instruction cache.
   invalidateInstructionCache();
 
+  CodeMem.PendingMem.clear();
+  RWDataMem.PendingMem.clear();
+  RODataMem.PendingMem.clear();
   return false;
 }
 
 error_code SectionMemoryManager::applyMemoryGroupPermissions(MemoryGroup &MemGroup,
                                                              unsigned Permissions) {
-
-  for (int i = 0, e = MemGroup.AllocatedMem.size(); i != e; ++i) {
+  uintptr_t PageSize = sys::process::get_self()->page_size();
+
+  // Protect the pages of the sections handed out since the last call.
+  for (int i = 0, e = MemGroup.PendingMem.size(); i != e; ++i) {
+      uintptr_t Start = (uintptr_t)MemGroup.PendingMem[i].base();
+      uintptr_t End = RoundUpToAlignment(Start + MemGroup.PendingMem[i].size(),
+                                         PageSize);
+      Start &= ~(PageSize - 1);
       error_code ec;
-      ec = sys::Memory::protectMappedMemory(MemGroup.AllocatedMem[i],
-                                            Permissions);
+      ec = sys::Memory::protectMappedMemory(
+          sys::MemoryBlock((void*)Start, End - Start), Permissions);
       if (ec) {
         return ec;
       }
   }
 
+  // Sections are carved from the front of a free block, so the pages past
+  // the last section are untouched and keep their read-write permissions.
+  // Keep those for the next sections and drop the part of each free block
+  // that shares a page with a protected section.
+  for (int i = MemGroup.FreeMem.size() - 1; i >= 0; --i) {
+    uintptr_t Start = (uintptr_t)MemGroup.FreeMem[i].base();
+    uintptr_t End = Start + MemGroup.FreeMem[i].size();
+    Start = RoundUpToAlignment(Start, PageSize);
+    if (Start + 16 < End)
+      MemGroup.FreeMem[i] = sys::MemoryBlock((void*)Start, End - Start);
+    else
+      MemGroup.FreeMem.erase(MemGroup.FreeMem.begin() + i);
+  }
+
   return error_code::success();
 }
 
 void SectionMemoryManager::invalidateInstructionCache() {
-  for (int i = 0, e = CodeMem.AllocatedMem.size(); i != e; ++i)
-    sys::Memory::InvalidateInstructionCache(CodeMem.AllocatedMem[i].base(),
-                                            CodeMem.AllocatedMem[i].size());
+  for (int i = 0, e = CodeMem.PendingMem.size(); i != e; ++i)
+    sys::Memory::InvalidateInstructionCache(CodeMem.PendingMem[i].base(),
+                                            CodeMem.PendingMem[i].size());
 }
-
 SectionMemoryManager::~SectionMemoryManager() {
   for (unsigned i = 0, e = CodeMem.AllocatedMem.size(); i != e; ++i)
     sys::Memory::releaseMappedMemory(CodeMem.AllocatedMem[i]);
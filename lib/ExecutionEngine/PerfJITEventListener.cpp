@@ -0,0 +1,106 @@
+//===-- PerfJITEventListener.cpp - Tell Linux perf about JITted code ------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines a JITEventListener that writes the symbol map read by the
+// Linux perf tool.  perf looks for /tmp/perf-<pid>.map when it finds samples
+// in anonymous executable memory; each line of the map gives the start
+// address, size and name of one function, all in hexadecimal except the name.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "perf-jit-event-listener"
+#include "llvm/ExecutionEngine/JITEventListener.h"
+#include "llvm/ADT/OwningPtr.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ExecutionEngine/ObjectImage.h"
+#include "llvm/IR/Function.h"
+#include "llvm/Object/ObjectFile.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/Mutex.h"
+#include "llvm/Support/MutexGuard.h"
+#include "llvm/Support/Process.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace llvm;
+
+namespace {
+
+class PerfJITEventListener : public JITEventListener {
+  OwningPtr<raw_fd_ostream> MapFile;
+  // The old JIT and MCJIT may notify from several threads.
+  sys::Mutex Lock;
+
+  void writeEntry(uint64_t Addr, uint64_t Size, StringRef Name);
+
+public:
+  PerfJITEventListener();
+
+  virtual void NotifyFunctionEmitted(const Function &F,
+                                void *FnStart, size_t FnSize,
+                                const JITEvent_EmittedFunctionDetails &Details);
+
+  virtual void NotifyObjectEmitted(const ObjectImage &Obj);
+};
+
+PerfJITEventListener::PerfJITEventListener() {
+  SmallString<64> Path;
+  raw_svector_ostream(Path) << "/tmp/perf-"
+                            << sys::process::get_self()->get_id() << ".map";
+  std::string ErrorInfo;
+  MapFile.reset(new raw_fd_ostream(Path.c_str(), ErrorInfo,
+                                   sys::fs::F_Append));
+  if (!ErrorInfo.empty()) {
+    DEBUG(dbgs() << "Failed to open " << Path << ": " << ErrorInfo << "\n");
+    MapFile.reset();
+  }
+}
+
+void PerfJITEventListener::writeEntry(uint64_t Addr, uint64_t Size,
+                                      StringRef Name) {
+  if (!MapFile)
+    return;
+  MutexGuard Guard(Lock);
+  *MapFile << format("%llx %llx ", (unsigned long long)Addr,
+                     (unsigned long long)Size)
+           << Name << '\n';
+  // perf may read the map while the process is still running.
+  MapFile->flush();
+}
+
+void PerfJITEventListener::NotifyFunctionEmitted(
+    const Function &F, void *FnStart, size_t FnSize,
+    const JITEvent_EmittedFunctionDetails &) {
+  writeEntry(reinterpret_cast<uintptr_t>(FnStart), FnSize, F.getName());
+}
+
+void PerfJITEventListener::NotifyObjectEmitted(const ObjectImage &Obj) {
+  // perf never unmaps entries, and code stays mapped after an object is
+  // freed, so only emission needs to be reported.
+  error_code ec;
+  for (object::symbol_iterator I = Obj.begin_symbols(),
+                               E = Obj.end_symbols();
+                        I != E && !ec;
+                        I.increment(ec)) {
+    object::SymbolRef::Type SymType;
+    if (I->getType(SymType) || SymType != object::SymbolRef::ST_Function)
+      continue;
+    StringRef Name;
+    uint64_t Addr, Size;
+    if (I->getName(Name) || I->getAddress(Addr) || I->getSize(Size))
+      continue;
+    writeEntry(Addr, Size, Name);
+  }
+}
+
+}  // anonymous namespace.
+
+JITEventListener *JITEventListener::createPerfJITEventListener() {
+  return new PerfJITEventListener();
+}
@@ -509,9 +509,17 @@ void RuntimeDyldImpl::resolveExternalSymbols() {
       uint64_t Addr = 0;
       SymbolTableMap::const_iterator Loc = GlobalSymbolTable.find(Name);
       if (Loc == GlobalSymbolTable.end()) {
+        StringMap<uint64_t>::const_iterator Cached =
+          ExternalSymbolAddresses.find(Name);
+        if (Cached != ExternalSymbolAddresses.end()) {
+          // An object loaded earlier already needed this symbol.
+          Addr = Cached->second;
+        } else {
           // This is an external symbol, try to get its address from
           // MemoryManager.
           Addr = MemMgr->getSymbolAddress(Name.data());
+          if (Addr)
+            ExternalSymbolAddresses[Name] = Addr;
           // The call to getSymbolAddress may have caused additional modules to
           // be loaded, which may have added new entries to the
           // ExternalSymbolRelocations map.  Consquently, we need to update our
@@ -519,6 +527,7 @@ void RuntimeDyldImpl::resolveExternalSymbols() {
           // associated with this symbol is deferred until below this point.
           // New entries may have been added to the relocation list.
           i = ExternalSymbolRelocations.find(Name);
+        }
       } else {
         // We found the symbol in our global table.  It was probably in a
         // Module that we loaded previously.
@@ -182,6 +182,11 @@ protected:
   // modules.  This map is indexed by symbol name.
   StringMap<RelocationList> ExternalSymbolRelocations;
 
+  // Addresses the memory manager returned for external symbols.  Objects
+  // loaded later that use the same symbols are resolved from here without
+  // asking the memory manager again.
+  StringMap<uint64_t> ExternalSymbolAddresses;
+
   typedef std::map<RelocationValueRef, uintptr_t> StubMap;
 
   Triple::ArchType Arch;
@@ -339,6 +339,9 @@ public:
   int getMetadataSlot(const MDNode *N);
   int getAttributeGroupSlot(AttributeSet AS);
 
+  /// getFunction - Return the incorporated function, or null if there is none.
+  const Function *getFunction() const { return TheFunction; }
+
   /// If you'd like to deal with a function instead of just a module, use
   /// this method to get its data into the SlotTracker.
   void incorporateFunction(const Function *F) {
@@ -1210,14 +1213,23 @@ void AssemblyWriter::init() {
 AssemblyWriter::AssemblyWriter(formatted_raw_ostream &o, SlotTracker &Mac,
                                const Module *M,
                                AssemblyAnnotationWriter *AAW)
-  : Out(o), TheModule(M), Machine(Mac), AnnotationWriter(AAW) {
+  : Out(o), TheModule(M), Machine(Mac), ModuleTypePrinter(new TypePrinting()),
+    TypePrinter(*ModuleTypePrinter), AnnotationWriter(AAW) {
   init();
 }
 
+AssemblyWriter::AssemblyWriter(formatted_raw_ostream &o, SlotTracker &Mac,
+                               TypePrinting &TP, const Module *M,
+                               AssemblyAnnotationWriter *AAW)
+  : Out(o), TheModule(M), Machine(Mac), TypePrinter(TP),
+    AnnotationWriter(AAW) {
+}
+
 AssemblyWriter::AssemblyWriter(formatted_raw_ostream &o, const Module *M,
                                AssemblyAnnotationWriter *AAW)
-  : Out(o), TheModule(M), ModuleSlotTracker(createSlotTracker(M)),
-    Machine(*ModuleSlotTracker), AnnotationWriter(AAW) {
+  : Out(o), TheModule(M), SlotTrackerStorage(createSlotTracker(M)),
+    Machine(*SlotTrackerStorage), ModuleTypePrinter(new TypePrinting()),
+    TypePrinter(*ModuleTypePrinter), AnnotationWriter(AAW) {
   init();
 }
 
@@ -2129,16 +2141,51 @@ void AssemblyWriter::writeAllAttributeGroups() {
 //                       External Interface declarations
 //===----------------------------------------------------------------------===//
 
+namespace {
+/// BufferedFormattedStream - A formatted_raw_ostream that buffers its output
+/// in a local buffer even when the underlying stream is unbuffered, so that
+/// printing to a stream like errs() does not become one write per token.  The
+/// output is flushed, and the underlying stream left unbuffered again, when
+/// the BufferedFormattedStream is destroyed.
+class BufferedFormattedStream : public formatted_raw_ostream {
+  char Buffer[1024];
+  bool WasUnbuffered;
+public:
+  explicit BufferedFormattedStream(raw_ostream &OS)
+    : formatted_raw_ostream(OS), WasUnbuffered(GetBufferSize() == 0) {
+    if (WasUnbuffered)
+      SetBuffer(Buffer, sizeof(Buffer));
+  }
+  ~BufferedFormattedStream() {
+    if (WasUnbuffered)
+      SetUnbuffered();
+  }
+};
+}
+
+ModuleSlotTracker::ModuleSlotTracker(const Module *M)
+  : Machine(new SlotTracker(M)), TypePrinter(new TypePrinting()), M(M) {
+  if (M)
+    TypePrinter->incorporateTypes(*M);
+}
+
+ModuleSlotTracker::~ModuleSlotTracker() {}
+
+void ModuleSlotTracker::incorporateFunction(const Function &F) {
+  Machine->purgeFunction();
+  Machine->incorporateFunction(&F);
+}
+
 void Module::print(raw_ostream &ROS, AssemblyAnnotationWriter *AAW) const {
   SlotTracker SlotTable(this);
-  formatted_raw_ostream OS(ROS);
+  BufferedFormattedStream OS(ROS);
   AssemblyWriter W(OS, SlotTable, this, AAW);
   W.printModule(this);
 }
 
 void NamedMDNode::print(raw_ostream &ROS, AssemblyAnnotationWriter *AAW) const {
   SlotTracker SlotTable(getParent());
-  formatted_raw_ostream OS(ROS);
+  BufferedFormattedStream OS(ROS);
   AssemblyWriter W(OS, SlotTable, getParent(), AAW);
   W.printNamedMDNode(this);
 }
@@ -2164,7 +2211,24 @@ void Value::print(raw_ostream &ROS, AssemblyAnnotationWriter *AAW) const {
     ROS << "printing a <null> value\n";
     return;
   }
-  formatted_raw_ostream OS(ROS);
+
+  // Constants and other operand-like values need neither slot numbers nor
+  // column tracking, print them directly.
+  if (const Constant *C = dyn_cast<Constant>(this)) {
+    if (!isa<GlobalValue>(C)) {
+      TypePrinting TypePrinter;
+      TypePrinter.print(C->getType(), ROS);
+      ROS << ' ';
+      WriteConstantInternal(ROS, C, TypePrinter, 0, 0);
+      return;
+    }
+  } else if (isa<InlineAsm>(this) || isa<MDString>(this) ||
+             isa<Argument>(this)) {
+    WriteAsOperand(ROS, this, true, 0);
+    return;
+  }
+
+  BufferedFormattedStream OS(ROS);
   if (const Instruction *I = dyn_cast<Instruction>(this)) {
     const Function *F = I->getParent() ? I->getParent()->getParent() : 0;
     SlotTracker SlotTable(F);
@@ -2188,14 +2252,6 @@ void Value::print(raw_ostream &ROS, AssemblyAnnotationWriter *AAW) const {
     SlotTracker SlotTable(F);
     AssemblyWriter W(OS, SlotTable, F ? F->getParent() : 0, AAW);
     W.printMDNodeBody(N);
-  } else if (const Constant *C = dyn_cast<Constant>(this)) {
-    TypePrinting TypePrinter;
-    TypePrinter.print(C->getType(), OS);
-    OS << ' ';
-    WriteConstantInternal(OS, C, TypePrinter, 0, 0);
-  } else if (isa<InlineAsm>(this) || isa<MDString>(this) ||
-             isa<Argument>(this)) {
-    WriteAsOperand(OS, this, true, 0);
   } else {
     // Otherwise we don't know what it is. Call the virtual function to
     // allow a subclass to print itself.
@@ -2203,6 +2259,45 @@ void Value::print(raw_ostream &ROS, AssemblyAnnotationWriter *AAW) const {
   }
 }
 
+void Value::print(raw_ostream &ROS, ModuleSlotTracker &MST,
+                  AssemblyAnnotationWriter *AAW) const {
+  // Only instructions, basic blocks and globals of the tracked module have
+  // anything to gain from the cached numbering.
+  const Function *F = 0;
+  const Module *M = 0;
+  if (const Instruction *I = dyn_cast_or_null<Instruction>(this)) {
+    F = I->getParent() ? I->getParent()->getParent() : 0;
+    M = F ? F->getParent() : 0;
+  } else if (const BasicBlock *BB = dyn_cast_or_null<BasicBlock>(this)) {
+    F = BB->getParent();
+    M = F ? F->getParent() : 0;
+  } else if (const GlobalValue *GV = dyn_cast_or_null<GlobalValue>(this)) {
+    M = GV->getParent();
+  }
+
+  if (M == 0 || M != MST.getModule()) {
+    print(ROS, AAW);
+    return;
+  }
+
+  SlotTracker &Machine = MST.getMachine();
+  if (F && Machine.getFunction() != F)
+    MST.incorporateFunction(*F);
+
+  BufferedFormattedStream OS(ROS);
+  AssemblyWriter W(OS, Machine, MST.getTypePrinter(), M, AAW);
+  if (const Instruction *I = dyn_cast<Instruction>(this))
+    W.printInstruction(*I);
+  else if (const BasicBlock *BB = dyn_cast<BasicBlock>(this))
+    W.printBasicBlock(BB);
+  else if (const GlobalVariable *V = dyn_cast<GlobalVariable>(this))
+    W.printGlobal(V);
+  else if (const Function *Fn = dyn_cast<Function>(this))
+    W.printFunction(Fn);
+  else
+    W.printAlias(cast<GlobalAlias>(this));
+}
+
 // Value::printCustom - subclasses should override this to implement printing.
 void Value::printCustom(raw_ostream &OS) const {
   llvm_unreachable("Unknown value to print out!");
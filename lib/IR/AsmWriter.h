@@ -67,9 +67,10 @@ protected:
   const Module *TheModule;
 
 private:
-  OwningPtr<SlotTracker> ModuleSlotTracker;
+  OwningPtr<SlotTracker> SlotTrackerStorage;
   SlotTracker &Machine;
-  TypePrinting TypePrinter;
+  OwningPtr<TypePrinting> ModuleTypePrinter;
+  TypePrinting &TypePrinter;
   AssemblyAnnotationWriter *AnnotationWriter;
 
 public:
@@ -77,6 +78,12 @@ public:
   AssemblyWriter(formatted_raw_ostream &o, SlotTracker &Mac,
                  const Module *M, AssemblyAnnotationWriter *AAW);
 
+  /// Construct an AssemblyWriter with an external SlotTracker and an external
+  /// TypePrinting that already has the types of M incorporated.
+  AssemblyWriter(formatted_raw_ostream &o, SlotTracker &Mac,
+                 TypePrinting &TP, const Module *M,
+                 AssemblyAnnotationWriter *AAW);
+
   /// Construct an AssemblyWriter with an internally allocated SlotTracker
   AssemblyWriter(formatted_raw_ostream &o, const Module *M,
                  AssemblyAnnotationWriter *AAW);
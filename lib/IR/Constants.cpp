@@ -484,6 +484,7 @@ ConstantInt *ConstantInt::get(LLVMContext &Context, const APInt &V) {
   IntegerType *ITy = IntegerType::get(Context, V.getBitWidth());
   // get an existing value or the insertion position
   LLVMContextImpl *pImpl = Context.pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->ConstantsLock);
   ConstantInt *&Slot = pImpl->IntConstants[DenseMapAPIntKeyInfo::KeyTy(V, ITy)];
   if (!Slot) Slot = new ConstantInt(ITy, V);
   return Slot;
@@ -609,6 +610,7 @@ Constant *ConstantFP::getZeroValueForNegation(Type *Ty) {
 // ConstantFP accessors.
 ConstantFP* ConstantFP::get(LLVMContext &Context, const APFloat& V) {
   LLVMContextImpl* pImpl = Context.pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->ConstantsLock);
 
   ConstantFP *&Slot = pImpl->FPConstants[DenseMapAPFloatKeyInfo::KeyTy(V)];
 
@@ -833,6 +835,7 @@ Constant *ConstantArray::get(ArrayType *Ty, ArrayRef<Constant*> V) {
   }
 
   // Otherwise, we really do want to create a ConstantArray.
+  sys::SmartScopedLock<true> Lock(pImpl->ConstantsLock);
   return pImpl->ArrayConstants.getOrCreate(Ty, V);
 }
 
@@ -896,7 +899,9 @@ Constant *ConstantStruct::get(StructType *ST, ArrayRef<Constant*> V) {
   if (isUndef)
     return UndefValue::get(ST);
 
-  return ST->getContext().pImpl->StructConstants.getOrCreate(ST, V);
+  LLVMContextImpl *pImpl = ST->getContext().pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->ConstantsLock);
+  return pImpl->StructConstants.getOrCreate(ST, V);
 }
 
 Constant *ConstantStruct::get(StructType *T, ...) {
@@ -1015,6 +1020,7 @@ Constant *ConstantVector::get(ArrayRef<Constant*> V) {
 
   // Otherwise, the element type isn't compatible with ConstantDataVector, or
   // the operand list constants a ConstantExpr or something else strange.
+  sys::SmartScopedLock<true> Lock(pImpl->ConstantsLock);
   return pImpl->VectorConstants.getOrCreate(T, V);
 }
 
@@ -1232,7 +1238,9 @@ ConstantAggregateZero *ConstantAggregateZero::get(Type *Ty) {
   assert((Ty->isStructTy() || Ty->isArrayTy() || Ty->isVectorTy()) &&
          "Cannot create an aggregate zero of non-aggregate type!");
   
-  ConstantAggregateZero *&Entry = Ty->getContext().pImpl->CAZConstants[Ty];
+  LLVMContextImpl *pImpl = Ty->getContext().pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->ConstantsLock);
+  ConstantAggregateZero *&Entry = pImpl->CAZConstants[Ty];
   if (Entry == 0)
     Entry = new ConstantAggregateZero(Ty);
 
@@ -1242,14 +1250,18 @@ ConstantAggregateZero *ConstantAggregateZero::get(Type *Ty) {
 /// destroyConstant - Remove the constant from the constant table.
 ///
 void ConstantAggregateZero::destroyConstant() {
-  getContext().pImpl->CAZConstants.erase(getType());
+  LLVMContextImpl *pImpl = getContext().pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->ConstantsLock);
+  pImpl->CAZConstants.erase(getType());
   destroyConstantImpl();
 }
 
 /// destroyConstant - Remove the constant from the constant table...
 ///
 void ConstantArray::destroyConstant() {
-  getType()->getContext().pImpl->ArrayConstants.remove(this);
+  LLVMContextImpl *pImpl = getType()->getContext().pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->ConstantsLock);
+  pImpl->ArrayConstants.remove(this);
   destroyConstantImpl();
 }
 
@@ -1260,14 +1272,18 @@ void ConstantArray::destroyConstant() {
 // destroyConstant - Remove the constant from the constant table...
 //
 void ConstantStruct::destroyConstant() {
-  getType()->getContext().pImpl->StructConstants.remove(this);
+  LLVMContextImpl *pImpl = getType()->getContext().pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->ConstantsLock);
+  pImpl->StructConstants.remove(this);
   destroyConstantImpl();
 }
 
 // destroyConstant - Remove the constant from the constant table...
 //
 void ConstantVector::destroyConstant() {
-  getType()->getContext().pImpl->VectorConstants.remove(this);
+  LLVMContextImpl *pImpl = getType()->getContext().pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->ConstantsLock);
+  pImpl->VectorConstants.remove(this);
   destroyConstantImpl();
 }
 
@@ -1312,7 +1328,9 @@ const APInt &Constant::getUniqueInteger() const {
 //
 
 ConstantPointerNull *ConstantPointerNull::get(PointerType *Ty) {
-  ConstantPointerNull *&Entry = Ty->getContext().pImpl->CPNConstants[Ty];
+  LLVMContextImpl *pImpl = Ty->getContext().pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->ConstantsLock);
+  ConstantPointerNull *&Entry = pImpl->CPNConstants[Ty];
   if (Entry == 0)
     Entry = new ConstantPointerNull(Ty);
 
@@ -1322,7 +1340,9 @@ ConstantPointerNull *ConstantPointerNull::get(PointerType *Ty) {
 // destroyConstant - Remove the constant from the constant table...
 //
 void ConstantPointerNull::destroyConstant() {
-  getContext().pImpl->CPNConstants.erase(getType());
+  LLVMContextImpl *pImpl = getContext().pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->ConstantsLock);
+  pImpl->CPNConstants.erase(getType());
   // Free the constant and any dangling references to it.
   destroyConstantImpl();
 }
@@ -1332,7 +1352,9 @@ void ConstantPointerNull::destroyConstant() {
 //
 
 UndefValue *UndefValue::get(Type *Ty) {
-  UndefValue *&Entry = Ty->getContext().pImpl->UVConstants[Ty];
+  LLVMContextImpl *pImpl = Ty->getContext().pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->ConstantsLock);
+  UndefValue *&Entry = pImpl->UVConstants[Ty];
   if (Entry == 0)
     Entry = new UndefValue(Ty);
 
@@ -1343,7 +1365,9 @@ UndefValue *UndefValue::get(Type *Ty) {
 //
 void UndefValue::destroyConstant() {
   // Free the constant and any dangling references to it.
-  getContext().pImpl->UVConstants.erase(getType());
+  LLVMContextImpl *pImpl = getContext().pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->ConstantsLock);
+  pImpl->UVConstants.erase(getType());
   destroyConstantImpl();
 }
 
@@ -1356,8 +1380,9 @@ BlockAddress *BlockAddress::get(BasicBlock *BB) {
 }
 
 BlockAddress *BlockAddress::get(Function *F, BasicBlock *BB) {
-  BlockAddress *&BA =
-    F->getContext().pImpl->BlockAddresses[std::make_pair(F, BB)];
+  LLVMContextImpl *pImpl = F->getContext().pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->ConstantsLock);
+  BlockAddress *&BA = pImpl->BlockAddresses[std::make_pair(F, BB)];
   if (BA == 0)
     BA = new BlockAddress(F, BB);
 
@@ -1377,8 +1402,9 @@ BlockAddress::BlockAddress(Function *F, BasicBlock *BB)
 // destroyConstant - Remove the constant from the constant table.
 //
 void BlockAddress::destroyConstant() {
-  getFunction()->getType()->getContext().pImpl
-    ->BlockAddresses.erase(std::make_pair(getFunction(), getBasicBlock()));
+  LLVMContextImpl *pImpl = getFunction()->getType()->getContext().pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->ConstantsLock);
+  pImpl->BlockAddresses.erase(std::make_pair(getFunction(), getBasicBlock()));
   getBasicBlock()->AdjustBlockAddressRefCount(-1);
   destroyConstantImpl();
 }
@@ -1396,15 +1422,15 @@ void BlockAddress::replaceUsesOfWithOnConstant(Value *From, Value *To, Use *U) {
 
   // See if the 'new' entry already exists, if not, just update this in place
   // and return early.
-  BlockAddress *&NewBA =
-    getContext().pImpl->BlockAddresses[std::make_pair(NewF, NewBB)];
+  LLVMContextImpl *pImpl = getContext().pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->ConstantsLock);
+  BlockAddress *&NewBA = pImpl->BlockAddresses[std::make_pair(NewF, NewBB)];
   if (NewBA == 0) {
     getBasicBlock()->AdjustBlockAddressRefCount(-1);
 
     // Remove the old entry, this can't cause the map to rehash (just a
     // tombstone will get added).
-    getContext().pImpl->BlockAddresses.erase(std::make_pair(getFunction(),
-                                                            getBasicBlock()));
+    pImpl->BlockAddresses.erase(std::make_pair(getFunction(), getBasicBlock()));
     NewBA = this;
     setOperand(0, NewF);
     setOperand(1, NewBB);
@@ -1438,6 +1464,7 @@ static inline Constant *getFoldedCast(
   // Look up the constant in the table first to ensure uniqueness.
   ExprMapKeyType Key(opc, C);
 
+  sys::SmartScopedLock<true> Lock(pImpl->ConstantsLock);
   return pImpl->ExprConstants.getOrCreate(Ty, Key);
 }
 
@@ -1761,6 +1788,7 @@ Constant *ConstantExpr::get(unsigned Opcode, Constant *C1, Constant *C2,
   ExprMapKeyType Key(Opcode, ArgVec, 0, Flags);
 
   LLVMContextImpl *pImpl = C1->getContext().pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->ConstantsLock);
   return pImpl->ExprConstants.getOrCreate(C1->getType(), Key);
 }
 
@@ -1838,6 +1866,7 @@ Constant *ConstantExpr::getSelect(Constant *C, Constant *V1, Constant *V2) {
   ExprMapKeyType Key(Instruction::Select, ArgVec);
 
   LLVMContextImpl *pImpl = C->getContext().pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->ConstantsLock);
   return pImpl->ExprConstants.getOrCreate(V1->getType(), Key);
 }
 
@@ -1874,6 +1903,7 @@ Constant *ConstantExpr::getGetElementPtr(Constant *C, ArrayRef<Value *> Idxs,
                            InBounds ? GEPOperator::IsInBounds : 0);
 
   LLVMContextImpl *pImpl = C->getContext().pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->ConstantsLock);
   return pImpl->ExprConstants.getOrCreate(ReqTy, Key);
 }
 
@@ -1896,6 +1926,7 @@ ConstantExpr::getICmp(unsigned short pred, Constant *LHS, Constant *RHS) {
     ResultTy = VectorType::get(ResultTy, VT->getNumElements());
 
   LLVMContextImpl *pImpl = LHS->getType()->getContext().pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->ConstantsLock);
   return pImpl->ExprConstants.getOrCreate(ResultTy, Key);
 }
 
@@ -1917,6 +1948,7 @@ ConstantExpr::getFCmp(unsigned short pred, Constant *LHS, Constant *RHS) {
     ResultTy = VectorType::get(ResultTy, VT->getNumElements());
 
   LLVMContextImpl *pImpl = LHS->getType()->getContext().pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->ConstantsLock);
   return pImpl->ExprConstants.getOrCreate(ResultTy, Key);
 }
 
@@ -1935,6 +1967,7 @@ Constant *ConstantExpr::getExtractElement(Constant *Val, Constant *Idx) {
 
   LLVMContextImpl *pImpl = Val->getContext().pImpl;
   Type *ReqTy = Val->getType()->getVectorElementType();
+  sys::SmartScopedLock<true> Lock(pImpl->ConstantsLock);
   return pImpl->ExprConstants.getOrCreate(ReqTy, Key);
 }
 
@@ -1954,6 +1987,7 @@ Constant *ConstantExpr::getInsertElement(Constant *Val, Constant *Elt,
   const ExprMapKeyType Key(Instruction::InsertElement, ArgVec);
 
   LLVMContextImpl *pImpl = Val->getContext().pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->ConstantsLock);
   return pImpl->ExprConstants.getOrCreate(Val->getType(), Key);
 }
 
@@ -1974,6 +2008,7 @@ Constant *ConstantExpr::getShuffleVector(Constant *V1, Constant *V2,
   const ExprMapKeyType Key(Instruction::ShuffleVector, ArgVec);
 
   LLVMContextImpl *pImpl = ShufTy->getContext().pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->ConstantsLock);
   return pImpl->ExprConstants.getOrCreate(ShufTy, Key);
 }
 
@@ -1994,6 +2029,7 @@ Constant *ConstantExpr::getInsertValue(Constant *Agg, Constant *Val,
   const ExprMapKeyType Key(Instruction::InsertValue, ArgVec, 0, 0, Idxs);
 
   LLVMContextImpl *pImpl = Agg->getContext().pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->ConstantsLock);
   return pImpl->ExprConstants.getOrCreate(ReqTy, Key);
 }
 
@@ -2015,6 +2051,7 @@ Constant *ConstantExpr::getExtractValue(Constant *Agg,
   const ExprMapKeyType Key(Instruction::ExtractValue, ArgVec, 0, 0, Idxs);
 
   LLVMContextImpl *pImpl = Agg->getContext().pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->ConstantsLock);
   return pImpl->ExprConstants.getOrCreate(ReqTy, Key);
 }
 
@@ -2169,7 +2206,9 @@ Constant *ConstantExpr::getBinOpAbsorber(unsigned Opcode, Type *Ty) {
 // destroyConstant - Remove the constant from the constant table...
 //
 void ConstantExpr::destroyConstant() {
-  getType()->getContext().pImpl->ExprConstants.remove(this);
+  LLVMContextImpl *pImpl = getType()->getContext().pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->ConstantsLock);
+  pImpl->ExprConstants.remove(this);
   destroyConstantImpl();
 }
 
@@ -2264,8 +2303,10 @@ Constant *ConstantDataSequential::getImpl(StringRef Elements, Type *Ty) {
     return ConstantAggregateZero::get(Ty);
 
   // Do a lookup to see if we have already formed one of these.
+  LLVMContextImpl *pImpl = Ty->getContext().pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->ConstantsLock);
   StringMap<ConstantDataSequential*>::MapEntryTy &Slot =
-    Ty->getContext().pImpl->CDSConstants.GetOrCreateValue(Elements);
+    pImpl->CDSConstants.GetOrCreateValue(Elements);
 
   // The bucket can point to a linked list of different CDS's that have the same
   // body but different types.  For example, 0,0,0,1 could be a 4 element array
@@ -2288,8 +2329,9 @@ Constant *ConstantDataSequential::getImpl(StringRef Elements, Type *Ty) {
 
 void ConstantDataSequential::destroyConstant() {
   // Remove the constant from the StringMap.
-  StringMap<ConstantDataSequential*> &CDSConstants = 
-    getType()->getContext().pImpl->CDSConstants;
+  LLVMContextImpl *pImpl = getType()->getContext().pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->ConstantsLock);
+  StringMap<ConstantDataSequential*> &CDSConstants = pImpl->CDSConstants;
 
   StringMap<ConstantDataSequential*>::iterator Slot =
     CDSConstants.find(getRawDataValues());
@@ -2303,7 +2345,7 @@ void ConstantDataSequential::destroyConstant() {
     // If there is only one value in the bucket (common case) it must be this
     // entry, and removing the entry should remove the bucket completely.
     assert((*Entry) == this && "Hash mismatch in ConstantDataSequential");
-    getContext().pImpl->CDSConstants.erase(Slot);
+    CDSConstants.erase(Slot);
   } else {
     // Otherwise, there are multiple entries linked off the bucket, unlink the 
     // node we care about but keep the bucket around.
@@ -2602,7 +2644,9 @@ void ConstantArray::replaceUsesOfWithOnConstant(Value *From, Value *To,
   } else if (AllSame && isa<UndefValue>(ToC)) {
     Replacement = UndefValue::get(getType());
   } else {
-    // Check to see if we have this array type already.
+    // Check to see if we have this array type already.  Finding, removing and
+    // reinserting this constant has to happen as one step.
+    sys::SmartScopedLock<true> Lock(pImpl->ConstantsLock);
     Lookup.second = makeArrayRef(Values);
     LLVMContextImpl::ArrayConstantsTy::MapTy::iterator I =
       pImpl->ArrayConstants.find(Lookup);
@@ -2688,7 +2732,9 @@ void ConstantStruct::replaceUsesOfWithOnConstant(Value *From, Value *To,
   } else if (isAllUndef) {
     Replacement = UndefValue::get(getType());
   } else {
-    // Check to see if we have this struct type already.
+    // Check to see if we have this struct type already.  Finding, removing and
+    // reinserting this constant has to happen as one step.
+    sys::SmartScopedLock<true> Lock(pImpl->ConstantsLock);
     Lookup.second = makeArrayRef(Values);
     LLVMContextImpl::StructConstantsTy::MapTy::iterator I =
       pImpl->StructConstants.find(Lookup);
@@ -324,7 +324,7 @@ struct ExprMapKeyType {
   uint8_t opcode;
   uint8_t subclassoptionaldata;
   uint16_t subclassdata;
-  std::vector<Constant*> operands;
+  SmallVector<Constant*, 4> operands;
   SmallVector<unsigned, 4> indices;
   bool operator==(const ExprMapKeyType& that) const {
     return this->opcode == that.opcode &&
@@ -646,6 +646,113 @@ public:
   }
 };
 
+/// ConstantExprUniqueMap - The unique map for constant expressions.  It is an
+/// open-addressed hash table whose entries keep the hash of their expression,
+/// so growing the table never hashes an expression again and a probe only
+/// compares the expressions whose hash matches the one looked up.
+class ConstantExprUniqueMap {
+public:
+  struct Entry {
+    ConstantExpr *CE;
+    unsigned Hash;
+    Entry(ConstantExpr *CE, unsigned Hash) : CE(CE), Hash(Hash) {}
+  };
+
+  struct LookupKey {
+    Type *Ty;
+    const ExprMapKeyType &Key;
+    unsigned Hash;
+    LookupKey(Type *Ty, const ExprMapKeyType &Key)
+      : Ty(Ty), Key(Key), Hash(getHash(Ty, Key)) {}
+  };
+
+  static unsigned getHash(Type *Ty, const ExprMapKeyType &Key) {
+    return hash_combine(Ty, Key.opcode, Key.subclassoptionaldata,
+                        Key.subclassdata,
+                        hash_combine_range(Key.operands.begin(),
+                                           Key.operands.end()),
+                        hash_combine_range(Key.indices.begin(),
+                                           Key.indices.end()));
+  }
+
+private:
+  struct MapInfo {
+    typedef DenseMapInfo<ConstantExpr*> ConstantExprInfo;
+    static inline Entry getEmptyKey() {
+      return Entry(ConstantExprInfo::getEmptyKey(), 0);
+    }
+    static inline Entry getTombstoneKey() {
+      return Entry(ConstantExprInfo::getTombstoneKey(), 0);
+    }
+    static unsigned getHashValue(const Entry &E) { return E.Hash; }
+    static unsigned getHashValue(const LookupKey &Val) { return Val.Hash; }
+    static bool isEqual(const Entry &LHS, const Entry &RHS) {
+      return LHS.CE == RHS.CE;
+    }
+    static bool isEqual(const LookupKey &LHS, const Entry &RHS) {
+      ConstantExpr *CE = RHS.CE;
+      if (CE == ConstantExprInfo::getEmptyKey() ||
+          CE == ConstantExprInfo::getTombstoneKey())
+        return false;
+      if (LHS.Hash != RHS.Hash)
+        return false;
+      const ExprMapKeyType &Key = LHS.Key;
+      if (LHS.Ty != CE->getType() || Key.opcode != CE->getOpcode() ||
+          Key.subclassoptionaldata != CE->getRawSubclassOptionalData() ||
+          Key.subclassdata != (CE->isCompare() ? CE->getPredicate() : 0) ||
+          Key.operands.size() != CE->getNumOperands())
+        return false;
+      for (unsigned I = 0, E = CE->getNumOperands(); I != E; ++I)
+        if (Key.operands[I] != CE->getOperand(I))
+          return false;
+      if (!CE->hasIndices())
+        return Key.indices.empty();
+      return CE->getIndices().equals(Key.indices);
+    }
+  };
+
+public:
+  typedef DenseMap<Entry, char, MapInfo> MapTy;
+
+private:
+  MapTy Map;
+
+public:
+  MapTy::iterator map_begin() { return Map.begin(); }
+  MapTy::iterator map_end() { return Map.end(); }
+  unsigned size() const { return Map.size(); }
+
+  void freeConstants() {
+    for (MapTy::iterator I = Map.begin(), E = Map.end(); I != E; ++I) {
+      // Asserts that use_empty().
+      delete I->first.CE;
+    }
+  }
+
+  /// getOrCreate - Return the specified constant from the map, creating it if
+  /// necessary.
+  ConstantExpr *getOrCreate(Type *Ty, const ExprMapKeyType &V) {
+    LookupKey Lookup(Ty, V);
+    MapTy::iterator I = Map.find_as(Lookup);
+    if (I != Map.end())
+      return I->first.CE;
+
+    ConstantExpr *Result =
+      ConstantCreator<ConstantExpr, Type, ExprMapKeyType>::create(Ty, V);
+    assert(Result->getType() == Ty && "Type specified is not correct!");
+    Map[Entry(Result, Lookup.Hash)] = '\0';
+    return Result;
+  }
+
+  /// remove - Remove this constant from the map.
+  void remove(ConstantExpr *CE) {
+    ExprMapKeyType Key = ConstantKeyData<ConstantExpr>::getValType(CE);
+    MapTy::iterator I = Map.find(Entry(CE, getHash(CE->getType(), Key)));
+    assert(I != Map.end() && "Constant not found in constant table!");
+    Map.erase(I);
+  }
+};
+
 // Unique map for aggregate constants
 template<class TypeClass, class ConstantClass>
 class ConstantAggrUniqueMap {
@@ -552,6 +552,18 @@ int LLVMGetNumOperands(LLVMValueRef Val) {
   return cast<User>(V)->getNumOperands();
 }
 
+void LLVMGetOperands(LLVMValueRef Val, LLVMValueRef *Operands) {
+  Value *V = unwrap(Val);
+  if (MDNode *MD = dyn_cast<MDNode>(V)) {
+    for (unsigned i = 0, e = MD->getNumOperands(); i != e; ++i)
+      *Operands++ = wrap(MD->getOperand(i));
+    return;
+  }
+  User *U = cast<User>(V);
+  for (User::op_iterator I = U->op_begin(), E = U->op_end(); I != E; ++I)
+    *Operands++ = wrap(I->get());
+}
+
 /*--.. Operations on constants of any type .................................--*/
 
 LLVMValueRef LLVMConstNull(LLVMTypeRef Ty) {
@@ -1747,6 +1759,22 @@ LLVMValueRef LLVMGetLastInstruction(LLVMBasicBlockRef BB) {
   return wrap(--I);
 }
 
+unsigned LLVMCountInstructions(LLVMBasicBlockRef BB) {
+  return unwrap(BB)->size();
+}
+
+void LLVMGetInstructions(LLVMBasicBlockRef BB, LLVMValueRef *Instructions) {
+  BasicBlock *Block = unwrap(BB);
+  for (BasicBlock::iterator I = Block->begin(), E = Block->end(); I != E; ++I)
+    *Instructions++ = wrap(I);
+}
+
+void LLVMGetInstructionOpcodes(LLVMBasicBlockRef BB, LLVMOpcode *Opcodes) {
+  BasicBlock *Block = unwrap(BB);
+  for (BasicBlock::iterator I = Block->begin(), E = Block->end(); I != E; ++I)
+    *Opcodes++ = map_to_llvmopcode(I->getOpcode());
+}
+
 LLVMValueRef LLVMGetNextInstruction(LLVMValueRef Inst) {
   Instruction *Instr = unwrap<Instruction>(Inst);
   BasicBlock::iterator I = Instr;
@@ -2503,6 +2531,143 @@ LLVMValueRef LLVMBuildAtomicRMW(LLVMBuilderRef B,LLVMAtomicRMWBinOp op,
     mapFromLLVMOrdering(ordering), singleThread ? SingleThread : CrossThread));
 }
 
+/*--.. Bulk construction ...................................................--*/
+
+/// isKnownLLVMOpcode - Return true if Code is one of the LLVMOpcode values,
+/// which map_from_llvmopcode can map.
+static bool isKnownLLVMOpcode(LLVMOpcode Code) {
+  switch (Code) {
+#define HANDLE_INST(num, opc, clas) case LLVM##opc: return true;
+#include "llvm/IR/Instruction.def"
+#undef HANDLE_INST
+  }
+  return false;
+}
+
+/// buildInstruction - Build the instruction described by D with the operands
+/// Ops, or return null if D can't be built.
+static Value *buildInstruction(IRBuilder<> &B, const LLVMInstructionDesc &D,
+                               ArrayRef<Value*> Ops) {
+  if (!isKnownLLVMOpcode(D.Opcode))
+    return 0;
+  unsigned Opcode = map_from_llvmopcode(D.Opcode);
+  unsigned NumOps = Ops.size();
+  const char *Name = D.Name ? D.Name : "";
+
+  if (Instruction::isBinaryOp(Opcode)) {
+    if (NumOps != 2)
+      return 0;
+    Value *V = B.CreateBinOp(Instruction::BinaryOps(Opcode), Ops[0], Ops[1],
+                             Name);
+    if (BinaryOperator *BO = dyn_cast<BinaryOperator>(V)) {
+      if (isa<OverflowingBinaryOperator>(BO)) {
+        BO->setHasNoSignedWrap(D.Flags & LLVMInstNoSignedWrap);
+        BO->setHasNoUnsignedWrap(D.Flags & LLVMInstNoUnsignedWrap);
+      } else if (isa<PossiblyExactOperator>(BO)) {
+        BO->setIsExact(D.Flags & LLVMInstExact);
+      }
+    }
+    return V;
+  }
+
+  if (Instruction::isCast(Opcode)) {
+    if (NumOps != 1 || !D.Type)
+      return 0;
+    return B.CreateCast(Instruction::CastOps(Opcode), Ops[0], unwrap(D.Type),
+                        Name);
+  }
+
+  switch (Opcode) {
+  case Instruction::ICmp:
+    if (NumOps != 2)
+      return 0;
+    return B.CreateICmp(CmpInst::Predicate(D.Predicate), Ops[0], Ops[1], Name);
+  case Instruction::FCmp:
+    if (NumOps != 2)
+      return 0;
+    return B.CreateFCmp(CmpInst::Predicate(D.Predicate), Ops[0], Ops[1], Name);
+  case Instruction::Alloca:
+    if (NumOps > 1 || !D.Type)
+      return 0;
+    return B.CreateAlloca(unwrap(D.Type), NumOps ? Ops[0] : 0, Name);
+  case Instruction::Load:
+    if (NumOps != 1)
+      return 0;
+    return B.CreateLoad(Ops[0], D.Flags & LLVMInstVolatile, Name);
+  case Instruction::Store:
+    if (NumOps != 2)
+      return 0;
+    return B.CreateStore(Ops[0], Ops[1], D.Flags & LLVMInstVolatile);
+  case Instruction::GetElementPtr:
+    if (NumOps < 1)
+      return 0;
+    if (D.Flags & LLVMInstInBounds)
+      return B.CreateInBoundsGEP(Ops[0], Ops.slice(1), Name);
+    return B.CreateGEP(Ops[0], Ops.slice(1), Name);
+  case Instruction::Select:
+    if (NumOps != 3)
+      return 0;
+    return B.CreateSelect(Ops[0], Ops[1], Ops[2], Name);
+  case Instruction::Call:
+    if (NumOps < 1)
+      return 0;
+    return B.CreateCall(Ops[0], Ops.slice(1), Name);
+  case Instruction::PHI: {
+    if (NumOps % 2 != 0 || !D.Type)
+      return 0;
+    for (unsigned i = 1; i < NumOps; i += 2)
+      if (!isa<BasicBlock>(Ops[i]))
+        return 0;
+    PHINode *PN = B.CreatePHI(unwrap(D.Type), NumOps / 2, Name);
+    for (unsigned i = 0; i != NumOps; i += 2)
+      PN->addIncoming(Ops[i], cast<BasicBlock>(Ops[i + 1]));
+    return PN;
+  }
+  case Instruction::Br:
+    if (NumOps == 1 && isa<BasicBlock>(Ops[0]))
+      return B.CreateBr(cast<BasicBlock>(Ops[0]));
+    if (NumOps == 3 && isa<BasicBlock>(Ops[1]) && isa<BasicBlock>(Ops[2]))
+      return B.CreateCondBr(Ops[0], cast<BasicBlock>(Ops[1]),
+                            cast<BasicBlock>(Ops[2]));
+    return 0;
+  case Instruction::Ret:
+    if (NumOps == 0)
+      return B.CreateRetVoid();
+    if (NumOps == 1)
+      return B.CreateRet(Ops[0]);
+    return 0;
+  case Instruction::Unreachable:
+    if (NumOps != 0)
+      return 0;
+    return B.CreateUnreachable();
+  default:
+    return 0;
+  }
+}
+
+unsigned LLVMBuildInstructions(LLVMBuilderRef B,
+                               const LLVMInstructionDesc *Insts,
+                               unsigned NumInsts, LLVMValueRef *Values,
+                               unsigned NumValues) {
+  IRBuilder<> &Builder = *unwrap(B);
+  SmallVector<Value*, 8> Ops;
+  for (unsigned i = 0; i != NumInsts; ++i) {
+    const LLVMInstructionDesc &D = Insts[i];
+    Ops.clear();
+    for (unsigned j = 0; j != D.NumOperands; ++j) {
+      unsigned Idx = D.Operands[j];
+      if (Idx >= NumValues + i || !Values[Idx])
+        return i;
+      Ops.push_back(unwrap(Values[Idx]));
+    }
+    Value *V = buildInstruction(Builder, D, Ops);
+    if (!V)
+      return i;
+    Values[NumValues + i] = wrap(V);
+  }
+  return NumInsts;
+}
+
 
 /*===-- Module providers --------------------------------------------------===*/
 
@@ -16,6 +16,7 @@
 #include "llvm/Support/GCOV.h"
 #include "llvm/ADT/OwningPtr.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/Support/Format.h"
 #include "llvm/Support/MemoryObject.h"
 #include "llvm/Support/system_error.h"
@@ -111,6 +112,194 @@ void GCOVFile::collectLineCounts(FileInfo &FI) {
   FI.setProgramCount(ProgramCount);
 }
 
+//===----------------------------------------------------------------------===//
+// GCDAProfile implementation.
+
+/// setFile - Record the version and checksum of the file being added, or
+/// check that they match the ones already recorded.
+bool GCDAProfile::setFile(GCOV::GCOVVersion V, uint32_t C,
+                          raw_ostream &ErrOS) {
+  if (!Initialized) {
+    Initialized = true;
+    Version = V;
+    Checksum = C;
+    return true;
+  }
+  if (Version != V) {
+    ErrOS << "GCOV versions do not match.\n";
+    return false;
+  }
+  if (Checksum != C) {
+    ErrOS << "File checksums do not match: " << Checksum << " != " << C
+          << ".\n";
+    return false;
+  }
+  return true;
+}
+
+/// addFunction - Add the counters of the function identified by Header.
+bool GCDAProfile::addFunction(StringRef Header, ArrayRef<uint64_t> Counters,
+                              raw_ostream &ErrOS) {
+  StringMapEntry<unsigned> &Entry =
+    FunctionIndex.GetOrCreateValue(Header, Functions.size());
+  if (Entry.getValue() == Functions.size()) {
+    Functions.push_back(FunctionData());
+    Functions.back().Header = Header;
+    Functions.back().Counters.append(Counters.begin(), Counters.end());
+    return true;
+  }
+
+  FunctionData &Data = Functions[Entry.getValue()];
+  if (Data.Counters.size() != Counters.size()) {
+    ErrOS << "Function counter numbers do not match: "
+          << Data.Counters.size() << " != " << Counters.size() << ".\n";
+    return false;
+  }
+  for (unsigned i = 0, e = Counters.size(); i != e; ++i)
+    Data.Counters[i] += Counters[i];
+  return true;
+}
+
+static uint64_t readSummaryWord64(ArrayRef<uint32_t> Summary, unsigned i) {
+  return Summary[i] | (uint64_t(Summary[i + 1]) << 32);
+}
+
+static void writeSummaryWord64(SmallVectorImpl<uint32_t> &Summary, unsigned i,
+                               uint64_t Val) {
+  Summary[i] = uint32_t(Val);
+  Summary[i + 1] = uint32_t(Val >> 32);
+}
+
+/// addSummary - Combine an object summary record with the ones already
+/// added, as gcov does when a program runs again: the run counts, the sums
+/// of all counters and the sums of the largest counters of each run are
+/// added, and the largest counter is the largest of any run.  The record is
+/// the checksum, the number of counters, the run count, then sum_all,
+/// run_max and sum_max as 64-bit words.
+void GCDAProfile::addSummary(ArrayRef<uint32_t> Summary) {
+  if (ObjectSummary.empty()) {
+    ObjectSummary.append(Summary.begin(), Summary.end());
+    return;
+  }
+  ObjectSummary[2] += Summary[2];
+  if (ObjectSummary.size() < 9 || Summary.size() < 9)
+    return;
+  writeSummaryWord64(ObjectSummary, 3, readSummaryWord64(ObjectSummary, 3) +
+                                       readSummaryWord64(Summary, 3));
+  writeSummaryWord64(ObjectSummary, 5,
+                     std::max(readSummaryWord64(ObjectSummary, 5),
+                              readSummaryWord64(Summary, 5)));
+  writeSummaryWord64(ObjectSummary, 7, readSummaryWord64(ObjectSummary, 7) +
+                                       readSummaryWord64(Summary, 7));
+}
+
+/// read - Add the counters of a .gcda file.  The function records are only
+/// compared, not parsed, so files written with or without function names or
+/// CFG checksums are all handled.
+bool GCDAProfile::read(GCOVBuffer &Buffer) {
+  if (!Buffer.readGCDAFormat()) return false;
+  GCOV::GCOVVersion GCDAVersion;
+  if (!Buffer.readGCOVVersion(GCDAVersion)) return false;
+  uint32_t GCDAChecksum;
+  if (!Buffer.readInt(GCDAChecksum)) return false;
+  raw_ostream &ErrOS = Buffer.getErrorStream();
+  if (!setFile(GCDAVersion, GCDAChecksum, ErrOS)) return false;
+
+  std::string Header;
+  SmallVector<uint64_t, 32> Counters;
+  while (Buffer.readFunctionTag()) {
+    uint32_t Length;
+    if (!Buffer.readInt(Length)) return false;
+    Header.clear();
+    for (uint32_t i = 0; i != Length; ++i) {
+      uint32_t Word;
+      if (!Buffer.readInt(Word)) return false;
+      Header.append(reinterpret_cast<char *>(&Word), 4);
+    }
+
+    if (!Buffer.readArcTag()) {
+      ErrOS << "Arc tag not found.\n";
+      return false;
+    }
+    uint32_t Count;
+    if (!Buffer.readInt(Count)) return false;
+    Counters.resize(Count / 2);
+    for (uint32_t i = 0, e = Counters.size(); i != e; ++i)
+      if (!Buffer.readInt64(Counters[i])) return false;
+    if (!addFunction(Header, Counters, ErrOS)) return false;
+  }
+
+  if (Buffer.readObjectTag()) {
+    uint32_t Length;
+    if (!Buffer.readInt(Length)) return false;
+    SmallVector<uint32_t, 9> Summary(Length);
+    for (uint32_t i = 0; i != Length; ++i)
+      if (!Buffer.readInt(Summary[i])) return false;
+    if (Length < 3) {
+      ErrOS << "Object summary too short.\n";
+      return false;
+    }
+    addSummary(Summary);
+  }
+  uint32_t Programs = 0;
+  while (Buffer.readProgramTag()) {
+    uint32_t Length;
+    if (!Buffer.readInt(Length)) return false;
+    Buffer.advanceCursor(Length);
+    ++Programs;
+  }
+  ProgramCount = std::max(ProgramCount, Programs);
+  return true;
+}
+
+bool GCDAProfile::merge(const GCDAProfile &Other, raw_ostream &ErrOS) {
+  if (Other.empty()) return true;
+  if (!setFile(Other.Version, Other.Checksum, ErrOS)) return false;
+  for (unsigned i = 0, e = Other.Functions.size(); i != e; ++i)
+    if (!addFunction(Other.Functions[i].Header, Other.Functions[i].Counters,
+                     ErrOS))
+      return false;
+  if (!Other.ObjectSummary.empty())
+    addSummary(Other.ObjectSummary);
+  ProgramCount = std::max(ProgramCount, Other.ProgramCount);
+  return true;
+}
+
+static void writeInt(raw_ostream &OS, uint32_t Val) {
+  OS.write(reinterpret_cast<const char *>(&Val), 4);
+}
+
+/// write - Output the summed counters as a .gcda file, with the functions in
+/// the order they were first seen, which is the order of the .gcno file.
+void GCDAProfile::write(raw_ostream &OS) const {
+  OS << "adcg" << (Version == GCOV::V402 ? "*204" : "*404");
+  writeInt(OS, Checksum);
+  for (unsigned i = 0, e = Functions.size(); i != e; ++i) {
+    const FunctionData &Data = Functions[i];
+    OS.write("\0\0\0\1", 4);
+    writeInt(OS, Data.Header.size() / 4);
+    OS << Data.Header;
+    OS.write("\0\0\xa1\1", 4);
+    writeInt(OS, Data.Counters.size() * 2);
+    for (unsigned j = 0, je = Data.Counters.size(); j != je; ++j) {
+      writeInt(OS, uint32_t(Data.Counters[j]));
+      writeInt(OS, uint32_t(Data.Counters[j] >> 32));
+    }
+  }
+
+  if (!ObjectSummary.empty()) {
+    OS.write("\0\0\0\xa1", 4);
+    writeInt(OS, ObjectSummary.size());
+    for (unsigned i = 0, e = ObjectSummary.size(); i != e; ++i)
+      writeInt(OS, ObjectSummary[i]);
+  }
+  for (unsigned i = 0; i != ProgramCount; ++i) {
+    OS.write("\0\0\0\xa3", 4);
+    writeInt(OS, 0);
+  }
+  OS.write("\0\0\0\0\0\0\0\0", 8);  // EOF
+}
+
 //===----------------------------------------------------------------------===//
 // GCOVFunction implementation.
 
@@ -171,7 +360,9 @@ bool GCOVFunction::readGCNO(GCOVBuffer &Buff, GCOV::GCOVVersion Version) {
       Edges.push_back(Edge);
       Blocks[BlockNo]->addDstEdge(Edge);
       Blocks[Dst]->addSrcEdge(Edge);
-      if (!Buff.readInt(Dummy)) return false; // Edge flag
+      uint32_t Flags;
+      if (!Buff.readInt(Flags)) return false;
+      Edge->OnTree = Flags & GCOV::ArcOnTree;
     }
   }
 
@@ -261,6 +452,7 @@ bool GCOVFunction::readGCDA(GCOVBuffer &Buff, GCOV::GCOVVersion Version) {
 
   // This for loop adds the counts for each block. A second nested loop is
   // required to combine the edge counts that are contained in the GCDA file.
+  // Edges on the spanning tree have no counts there.
   for (uint32_t BlockNo = 0; Count > 0; ++BlockNo) {
     // The last block is always reserved for exit block
     if (BlockNo >= Blocks.size()-1) {
@@ -270,6 +462,8 @@ bool GCOVFunction::readGCDA(GCOVBuffer &Buff, GCOV::GCOVVersion Version) {
     GCOVBlock &Block = *Blocks[BlockNo];
     for (size_t EdgeNo = 0, End = Block.getNumDstEdges(); EdgeNo < End;
            ++EdgeNo) {
+      if (Block.dst_begin()[EdgeNo]->OnTree)
+        continue;
       if (Count == 0) {
         errs() << "Unexpected number of edges (in " << Name << ").\n";
         return false;
@@ -279,11 +473,92 @@ bool GCOVFunction::readGCDA(GCOVBuffer &Buff, GCOV::GCOVVersion Version) {
       Block.addCount(EdgeNo, ArcCount);
       --Count;
     }
-    Block.sortDstEdges();
   }
+  bool HasTreeEdges = false;
+  for (uint32_t i = 0, e = Edges.size(); i != e; ++i)
+    HasTreeEdges |= Edges[i]->OnTree;
+  if (HasTreeEdges)
+    countTreeEdges();
+  for (uint32_t BlockNo = 0, e = Blocks.size(); BlockNo != e; ++BlockNo)
+    Blocks[BlockNo]->sortDstEdges();
   return true;
 }
 
+/// countTreeEdges - Compute the counts of the edges on the spanning tree from
+/// the counted ones: the flow into each block equals the flow out of it, with
+/// the entry and exit blocks as one node since every call that enters the
+/// function also leaves it.  Blocks without successors other than the exit
+/// block don't conserve flow, so they are never used.
+void GCOVFunction::countTreeEdges() {
+  GCOVBlock *Entry = Blocks.front(), *Exit = Blocks.back();
+  SmallPtrSet<GCOVEdge *, 16> Unknown;
+  for (uint32_t i = 0, e = Edges.size(); i != e; ++i)
+    if (Edges[i]->OnTree)
+      Unknown.insert(Edges[i]);
+
+  bool Changed = true;
+  while (Changed && !Unknown.empty()) {
+    Changed = false;
+    for (uint32_t BlockNo = 0, e = Blocks.size() - 1; BlockNo != e; ++BlockNo) {
+      GCOVBlock *Block = Blocks[BlockNo];
+      if (Block != Entry && !Block->getNumDstEdges())
+        continue;
+
+      SmallVector<GCOVEdge *, 8> In(Block->src_begin(), Block->src_end());
+      SmallVector<GCOVEdge *, 8> Out(Block->dst_begin(), Block->dst_end());
+      if (Block == Entry) {
+        In.append(Exit->src_begin(), Exit->src_end());
+        Out.append(Exit->dst_begin(), Exit->dst_end());
+      }
+
+      // Find the single unknown edge, if there is one.
+      uint64_t InCount = 0, OutCount = 0;
+      GCOVEdge *UnknownEdge = 0;
+      bool UnknownIsIn = false;
+      unsigned NumUnknown = 0;
+      for (unsigned i = 0, e = In.size(); i != e; ++i) {
+        if (Unknown.count(In[i])) {
+          UnknownEdge = In[i];
+          UnknownIsIn = true;
+          ++NumUnknown;
+        } else {
+          InCount += In[i]->Count;
+        }
+      }
+      for (unsigned i = 0, e = Out.size(); i != e; ++i) {
+        if (Unknown.count(Out[i])) {
+          UnknownEdge = Out[i];
+          UnknownIsIn = false;
+          ++NumUnknown;
+        } else {
+          OutCount += Out[i]->Count;
+        }
+      }
+      if (NumUnknown != 1)
+        continue;
+
+      // A mismatch can only come from a function left without returning, in
+      // which case the flow is short on the exit side.
+      uint64_t Known = UnknownIsIn ? InCount : OutCount;
+      uint64_t Total = UnknownIsIn ? OutCount : InCount;
+      UnknownEdge->Count = Total > Known ? Total - Known : 0;
+      Unknown.erase(UnknownEdge);
+      Changed = true;
+    }
+  }
+
+  // Credit the derived counts to the blocks like the counted ones.
+  for (uint32_t BlockNo = 0, e = Blocks.size(); BlockNo != e; ++BlockNo) {
+    GCOVBlock &Block = *Blocks[BlockNo];
+    for (size_t EdgeNo = 0, End = Block.getNumDstEdges(); EdgeNo != End;
+         ++EdgeNo) {
+      GCOVEdge *Edge = Block.dst_begin()[EdgeNo];
+      if (Edge->OnTree)
+        Block.addCount(EdgeNo, Edge->Count);
+    }
+  }
+}
+
 /// getEntryCount - Get the number of times the function was called by
 /// retrieving the entry block's count.
 uint64_t GCOVFunction::getEntryCount() const {
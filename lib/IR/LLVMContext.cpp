@@ -118,6 +118,41 @@ void LLVMContext::emitError(const Twine &ErrorStr) {
   emitError(0U, ErrorStr);
 }
 
+/// isDeadConstantExpr - Return true if CE can be deleted.
+static bool isDeadConstantExpr(const ConstantExpr *CE) {
+  return CE->use_empty() && !CE->hasValueHandle();
+}
+
+unsigned LLVMContext::removeDeadConstantExprs() {
+  SmallVector<ConstantExpr*, 64> Worklist;
+  for (ConstantExprUniqueMap::MapTy::iterator
+       I = pImpl->ExprConstants.map_begin(),
+       E = pImpl->ExprConstants.map_end(); I != E; ++I)
+    if (isDeadConstantExpr(I->first.CE))
+      Worklist.push_back(I->first.CE);
+
+  unsigned NumRemoved = 0;
+  SmallPtrSet<Constant*, 4> Operands;
+  while (!Worklist.empty()) {
+    ConstantExpr *CE = Worklist.pop_back_val();
+    Operands.clear();
+    for (unsigned i = 0, e = CE->getNumOperands(); i != e; ++i)
+      Operands.insert(CE->getOperand(i));
+
+    CE->destroyConstant();
+    ++NumRemoved;
+
+    // Each operand is visited once here, so an expression whose last use
+    // just went away is queued exactly once.
+    for (SmallPtrSet<Constant*, 4>::iterator I = Operands.begin(),
+         E = Operands.end(); I != E; ++I)
+      if (ConstantExpr *Op = dyn_cast<ConstantExpr>(*I))
+        if (isDeadConstantExpr(Op))
+          Worklist.push_back(Op);
+  }
+  return NumRemoved;
+}
+
 void LLVMContext::emitError(const Instruction *I, const Twine &ErrorStr) {
   unsigned LocCookie = 0;
   if (const MDNode *SrcLoc = I->getMetadata("srcloc")) {
@@ -43,15 +43,6 @@ LLVMContextImpl::LLVMContextImpl(LLVMContext &C)
 }
 
 namespace {
-struct DropReferences {
-  // Takes the value_type of a ConstantUniqueMap's internal map, whose 'second'
-  // is a Constant*.
-  template<typename PairT>
-  void operator()(const PairT &P) {
-    P.second->dropAllReferences();
-  }
-};
-
 // Temporary - drops pair.first instead of second.
 struct DropFirst {
   // Takes the value_type of a ConstantUniqueMap's internal map, whose 'second'
@@ -73,8 +64,9 @@ LLVMContextImpl::~LLVMContextImpl() {
   
   // Free the constants.  This is important to do here to ensure that they are
   // freed before the LeakDetector is torn down.
-  std::for_each(ExprConstants.map_begin(), ExprConstants.map_end(),
-                DropReferences());
+  for (ConstantExprUniqueMap::MapTy::iterator I = ExprConstants.map_begin(),
+       E = ExprConstants.map_end(); I != E; ++I)
+    I->first.CE->dropAllReferences();
   std::for_each(ArrayConstants.map_begin(), ArrayConstants.map_end(),
                 DropFirst());
   std::for_each(StructConstants.map_begin(), StructConstants.map_end(),
@@ -122,9 +114,9 @@ LLVMContextImpl::~LLVMContextImpl() {
   // and the NonUniquedMDNodes sets, so copy the values out first.
   SmallVector<MDNode*, 8> MDNodes;
   MDNodes.reserve(MDNodeSet.size() + NonUniquedMDNodes.size());
-  for (FoldingSetIterator<MDNode> I = MDNodeSet.begin(), E = MDNodeSet.end();
+  for (MDNodeSetTy::iterator I = MDNodeSet.begin(), E = MDNodeSet.end();
        I != E; ++I)
-    MDNodes.push_back(&*I);
+    MDNodes.push_back(I->first);
   MDNodes.append(NonUniquedMDNodes.begin(), NonUniquedMDNodes.end());
   for (SmallVectorImpl<MDNode *>::iterator I = MDNodes.begin(),
          E = MDNodes.end(); I != E; ++I)
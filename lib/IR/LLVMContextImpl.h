@@ -30,6 +30,7 @@
 #include "llvm/IR/DerivedTypes.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Metadata.h"
+#include "llvm/Support/Mutex.h"
 #include "llvm/Support/ValueHandle.h"
 #include <vector>
 
@@ -187,23 +188,42 @@ struct FunctionTypeKeyInfo {
   }
 };
 
-// Provide a FoldingSetTrait::Equals specialization for MDNode that can use a
-// shortcut to avoid comparing all operands.
-template<> struct FoldingSetTrait<MDNode> : DefaultFoldingSetTrait<MDNode> {
-  static bool Equals(const MDNode &X, const FoldingSetNodeID &ID,
-                     unsigned IDHash, FoldingSetNodeID &TempID) {
-    assert(!X.isNotUniqued() && "Non-uniqued MDNode in FoldingSet?");
-    // First, check if the cached hashes match.  If they don't we can skip the
-    // expensive operand walk.
-    if (X.Hash != IDHash)
+/// MDNodeKeyInfo - Uniques MDNodes by their operands.  The operand hash is
+/// computed once, straight from the operand pointers, and cached in the node,
+/// so lookups neither build a FoldingSetNodeID nor rehash existing nodes.
+struct MDNodeKeyInfo {
+  struct KeyTy {
+    ArrayRef<Value*> Ops;
+    unsigned Hash;
+    KeyTy(ArrayRef<Value*> Ops)
+      : Ops(Ops), Hash(hash_combine_range(Ops.begin(), Ops.end())) {}
+  };
+  static inline MDNode* getEmptyKey() {
+    return DenseMapInfo<MDNode*>::getEmptyKey();
+  }
+  static inline MDNode* getTombstoneKey() {
+    return DenseMapInfo<MDNode*>::getTombstoneKey();
+  }
+  static unsigned getHashValue(const KeyTy& Key) {
+    return Key.Hash;
+  }
+  static unsigned getHashValue(const MDNode *N) {
+    return N->Hash;
+  }
+  static bool isEqual(const KeyTy& LHS, const MDNode *RHS) {
+    if (RHS == getEmptyKey() || RHS == getTombstoneKey())
       return false;
-
-    // If they match we have to compare the operands.
-    X.Profile(TempID);
-    return TempID == ID;
+    assert(!RHS->isNotUniqued() && "Non-uniqued MDNode in MDNodeSet?");
+    // Compare the cached hashes first to skip most operand walks.
+    if (LHS.Hash != RHS->Hash || LHS.Ops.size() != RHS->getNumOperands())
+      return false;
+    for (unsigned i = 0, e = LHS.Ops.size(); i != e; ++i)
+      if (LHS.Ops[i] != RHS->getOperand(i))
+        return false;
+    return true;
   }
-  static unsigned ComputeHash(const MDNode &X, FoldingSetNodeID &) {
-    return X.Hash; // Return cached hash.
+  static bool isEqual(const MDNode *LHS, const MDNode *RHS) {
+    return LHS == RHS;
   }
 };
 
@@ -242,6 +262,13 @@ public:
   LLVMContext::DiagnosticHandlerTy DiagnosticHandler;
   void *DiagnosticContext;
 
+  /// ConstantsLock - Guards the constant uniquing tables below, from
+  /// IntConstants to InlineAsms, when LLVM runs in multithreaded mode (see
+  /// llvm_start_multithreaded).  It is recursive because building a constant
+  /// can build others.  TypesLock may be acquired while holding it, but not
+  /// the other way around.
+  sys::SmartMutex<true> ConstantsLock;
+
   typedef DenseMap<DenseMapAPIntKeyInfo::KeyTy, ConstantInt *,
                    DenseMapAPIntKeyInfo> IntMapTy;
   IntMapTy IntConstants;
@@ -256,7 +283,8 @@ public:
 
   StringMap<Value*> MDStringCache;
 
-  FoldingSet<MDNode> MDNodeSet;
+  typedef DenseMap<MDNode*, bool, MDNodeKeyInfo> MDNodeSetTy;
+  MDNodeSetTy MDNodeSet;
 
   // MDNodes may be uniqued or not uniqued.  When they're not uniqued, they
   // aren't in the MDNodeSet, but they're still shared between objects, so no
@@ -283,8 +311,7 @@ public:
 
   
   DenseMap<std::pair<Function*, BasicBlock*> , BlockAddress*> BlockAddresses;
-  ConstantUniqueMap<ExprMapKeyType, const ExprMapKeyType&, Type, ConstantExpr>
-    ExprConstants;
+  ConstantExprUniqueMap ExprConstants;
 
   ConstantUniqueMap<InlineAsmKeyType, const InlineAsmKeyType&, PointerType,
                     InlineAsm> InlineAsms;
@@ -299,7 +326,11 @@ public:
   Type X86_FP80Ty, FP128Ty, PPC_FP128Ty, X86_MMXTy;
   IntegerType Int1Ty, Int8Ty, Int16Ty, Int32Ty, Int64Ty;
 
-  
+
+  /// TypesLock - Guards TypeAllocator and the type uniquing tables below in
+  /// multithreaded mode.
+  sys::SmartMutex<true> TypesLock;
+
   /// TypeAllocator - All dynamically allocated types are allocated from this.
   /// They live forever until the context is torn down.
   BumpPtrAllocator TypeAllocator;
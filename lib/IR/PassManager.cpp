@@ -9,13 +9,83 @@
 
 #include "llvm/IR/PassManager.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
 
 using namespace llvm;
 
+void PassInstrumentation::startPass() {
+  ActivePass P;
+  P.AnalysisHits = 0;
+  P.AnalysisMisses = 0;
+  P.Start = TimeRecord::getCurrentTime(/*Start=*/true);
+  Active.push_back(P);
+}
+
+void PassInstrumentation::endPass(StringRef PassName, StringRef IRName) {
+  TimeRecord Elapsed = TimeRecord::getCurrentTime(/*Start=*/false);
+  assert(!Active.empty() && "Ending a pass which was never started!");
+  ActivePass P = Active.pop_back_val();
+  Elapsed -= P.Start;
+
+  Record R;
+  R.PassName = PassName;
+  R.IRName = IRName;
+  R.Depth = Active.size();
+  R.WallTime = Elapsed.getWallTime();
+  R.MemUsed = Elapsed.getMemUsed();
+  R.AnalysisHits = P.AnalysisHits;
+  R.AnalysisMisses = P.AnalysisMisses;
+  Records.push_back(R);
+
+  // Keep the enclosing pass's counts inclusive of this one.
+  if (!Active.empty()) {
+    Active.back().AnalysisHits += P.AnalysisHits;
+    Active.back().AnalysisMisses += P.AnalysisMisses;
+  }
+}
+
+static void printJSONString(raw_ostream &OS, StringRef Str) {
+  OS << '"';
+  for (StringRef::iterator I = Str.begin(), E = Str.end(); I != E; ++I) {
+    unsigned char C = *I;
+    if (C == '"' || C == '\\')
+      OS << '\\' << C;
+    else if (C < 0x20)
+      OS << format("\\u%04x", C);
+    else
+      OS << C;
+  }
+  OS << '"';
+}
+
+void PassInstrumentation::printJSON(raw_ostream &OS) const {
+  OS << "{\"passes\":[";
+  for (unsigned Idx = 0, Size = Records.size(); Idx != Size; ++Idx) {
+    const Record &R = Records[Idx];
+    if (Idx)
+      OS << ',';
+    OS << "\n  {\"pass\":";
+    printJSONString(OS, R.PassName);
+    OS << ",\"ir\":";
+    printJSONString(OS, R.IRName);
+    OS << ",\"depth\":" << R.Depth
+       << ",\"wall_time\":" << format("%.9f", R.WallTime)
+       << ",\"mem_used\":" << (int64_t)R.MemUsed
+       << ",\"analysis_hits\":" << R.AnalysisHits
+       << ",\"analysis_misses\":" << R.AnalysisMisses << '}';
+  }
+  OS << "\n]}\n";
+}
+
 PreservedAnalyses ModulePassManager::run(Module *M, ModuleAnalysisManager *AM) {
   PreservedAnalyses PA = PreservedAnalyses::all();
   for (unsigned Idx = 0, Size = Passes.size(); Idx != Size; ++Idx) {
+    if (Instrumentation)
+      Instrumentation->startPass();
     PreservedAnalyses PassPA = Passes[Idx]->run(M, AM);
+    if (Instrumentation)
+      Instrumentation->endPass(Passes[Idx]->name(), M->getModuleIdentifier());
     if (AM)
       AM->invalidate(M, PassPA);
     PA.intersect(llvm_move(PassPA));
@@ -29,6 +99,8 @@ ModuleAnalysisManager::getResultImpl(void *PassID, Module *M) {
   bool Inserted;
   llvm::tie(RI, Inserted) = ModuleAnalysisResults.insert(std::make_pair(
       PassID, polymorphic_ptr<detail::AnalysisResultConcept<Module *> >()));
+  if (Instrumentation)
+    Instrumentation->recordAnalysisQuery(/*CacheHit=*/!Inserted);
 
   // If we don't have a cached result for this module, look up the pass and run
   // it to produce a result, which we then add to the cache.
@@ -62,7 +134,11 @@ void ModuleAnalysisManager::invalidateImpl(Module *M,
 PreservedAnalyses FunctionPassManager::run(Function *F, FunctionAnalysisManager *AM) {
   PreservedAnalyses PA = PreservedAnalyses::all();
   for (unsigned Idx = 0, Size = Passes.size(); Idx != Size; ++Idx) {
+    if (Instrumentation)
+      Instrumentation->startPass();
     PreservedAnalyses PassPA = Passes[Idx]->run(F, AM);
+    if (Instrumentation)
+      Instrumentation->endPass(Passes[Idx]->name(), F->getName());
     if (AM)
       AM->invalidate(F, PassPA);
     PA.intersect(llvm_move(PassPA));
@@ -89,6 +165,8 @@ FunctionAnalysisManager::getResultImpl(void *PassID, Function *F) {
   bool Inserted;
   llvm::tie(RI, Inserted) = FunctionAnalysisResults.insert(std::make_pair(
       std::make_pair(PassID, F), FunctionAnalysisResultListT::iterator()));
+  if (Instrumentation)
+    Instrumentation->recordAnalysisQuery(/*CacheHit=*/!Inserted);
 
   // If we don't have a cached result for this function, look up the pass and
   // run it to produce a result, which we then add to the cache.
@@ -56,6 +56,13 @@ Use *User::allocHungoffUses(unsigned N) const {
 //                         User operator new Implementations
 //===----------------------------------------------------------------------===//
 
+// Users are deliberately allocated from the global heap rather than from an
+// arena owned by the enclosing Function or Module.  An instruction is created
+// before it is inserted anywhere (the insertion point is a constructor
+// argument, not known to operator new), may live detached for a while, and is
+// routinely moved between functions by the inliner, CodeExtractor and friends,
+// so no single arena could be guaranteed to outlive it.  Any pooling scheme
+// must therefore be able to free a User individually, from any owner.
 void *User::operator new(size_t s, unsigned Us) {
   void *Storage = ::operator new(s + sizeof(Use) * Us);
   Use *Start = static_cast<Use*>(Storage);
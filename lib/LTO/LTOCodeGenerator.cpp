@@ -14,6 +14,8 @@
 
 #include "llvm/LTO/LTOCodeGenerator.h"
 #include "llvm/LTO/LTOModule.h"
+#include "llvm/LTO/LTOObjectCache.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/Analysis/Passes.h"
 #include "llvm/Analysis/Verifier.h"
@@ -23,6 +25,7 @@
 #include "llvm/IR/Constants.h"
 #include "llvm/IR/DataLayout.h"
 #include "llvm/IR/DerivedTypes.h"
+#include "llvm/IR/GlobalAlias.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Module.h"
 #include "llvm/InitializePasses.h"
@@ -31,15 +34,24 @@
 #include "llvm/MC/MCContext.h"
 #include "llvm/MC/SubtargetFeature.h"
 #include "llvm/PassManager.h"
+#include "llvm/Support/CallSite.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/FormattedStream.h"
 #include "llvm/Support/Host.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/InstIterator.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Process.h"
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
+#include "llvm/Support/TimeProfiler.h"
 #include "llvm/Support/ToolOutputFile.h"
+#include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/system_error.h"
 #include "llvm/Target/TargetLibraryInfo.h"
 #include "llvm/Target/TargetLowering.h"
@@ -49,8 +61,28 @@
 #include "llvm/Transforms/IPO.h"
 #include "llvm/Transforms/IPO/PassManagerBuilder.h"
 #include "llvm/Transforms/ObjCARC.h"
+#include "llvm/Transforms/Utils/Cloning.h"
+#include "llvm/Transforms/Utils/ValueMapper.h"
 using namespace llvm;
 
+static cl::opt<bool>
+LTOStats("lto-stats", cl::Hidden,
+         cl::desc("Report the memory use of the LTO code generator after each "
+                  "phase"));
+
+/// reportMemoryUsage - Under -lto-stats, print how much memory the process
+/// uses once Phase is done.
+static void reportMemoryUsage(const char *Phase) {
+  if (!LTOStats)
+    return;
+  size_t Current, Peak;
+  sys::Process::GetResidentSetSize(Current, Peak);
+  errs() << "lto-stats: " << Phase << ": "
+         << format("resident %.1f MB, peak %.1f MB, malloc %.1f MB\n",
+                   Current / 1048576.0, Peak / 1048576.0,
+                   sys::Process::GetMallocUsage() / 1048576.0);
+}
+
 const char* LTOCodeGenerator::getVersionString() {
 #ifdef LLVM_VERSION_INFO
   return PACKAGE_NAME " version " PACKAGE_VERSION ", " LLVM_VERSION_INFO;
@@ -111,12 +143,37 @@ void LTOCodeGenerator::initializeLTOPasses() {
 }
 
 bool LTOCodeGenerator::addModule(LTOModule* mod, std::string& errMsg) {
+  if (!mod->getLLVVMModule()) {
+    errMsg = "module has already been added to a code generator";
+    return false;
+  }
+  TimeTraceScope TraceScope("LTO Link",
+                            mod->getLLVVMModule()->getModuleIdentifier());
   bool ret = Linker.linkInModule(mod->getLLVVMModule(), &errMsg);
 
+  // The bitcode reader renames intrinsics whose signature changed and
+  // rewrites the calls to them as it reads each body.  The old declarations
+  // are left behind unused, because the module was read lazily; drop the
+  // copies that were linked in.
+  Module *Src = mod->getLLVVMModule();
+  for (Module::iterator I = Src->begin(), E = Src->end(); I != E; ++I) {
+    if (!I->getName().startswith("llvm.") || I->getIntrinsicID())
+      continue;
+    Function *F = Linker.getModule()->getFunction(I->getName());
+    if (F && F->isDeclaration() && F->use_empty())
+      F->eraseFromParent();
+  }
+
   const std::vector<const char*> &undefs = mod->getAsmUndefinedRefs();
   for (int i = 0, e = undefs.size(); i != e; ++i)
     AsmUndefinedRefs[undefs[i]] = 1;
 
+  // The bodies now live in the merged module, but the rest of the source
+  // module and its bitcode would stay in memory until the client disposed of
+  // it, which some linkers only do at the very end.
+  if (!ret)
+    mod->releaseModule();
+
   return !ret;
 }
 
@@ -202,6 +259,15 @@ bool LTOCodeGenerator::compile_to_file(const char** name,
                                        bool disableInline,
                                        bool disableGVNLoadPRE,
                                        std::string& errMsg) {
+  std::string CacheKey;
+  if (!CacheDir.empty()) {
+    CacheKey = getCacheKey(disableOpt, disableInline, disableGVNLoadPRE, 1);
+    if (LTOObjectCache(CacheDir).lookup(CacheKey, NativeObjectPath)) {
+      *name = NativeObjectPath.c_str();
+      return true;
+    }
+  }
+
   // make unique temp .o file to put generated object file
   SmallString<128> Filename;
   int FD;
@@ -229,11 +295,63 @@ bool LTOCodeGenerator::compile_to_file(const char** name,
     return false;
   }
 
+  if (!CacheKey.empty())
+    LTOObjectCache(CacheDir).store(CacheKey, Filename.str());
+
   NativeObjectPath = Filename.c_str();
   *name = NativeObjectPath.c_str();
   return true;
 }
 
+/// getCacheKey - Hash the merged module, as it is before optimization, along
+/// with everything else that determines the generated code.
+std::string LTOCodeGenerator::getCacheKey(bool disableOpt, bool disableInline,
+                                          bool disableGVNLoadPRE,
+                                          unsigned Partitions) {
+  MD5 Hash;
+  {
+    std::string Bitcode;
+    raw_string_ostream OS(Bitcode);
+    WriteBitcodeToFile(Linker.getModule(), OS);
+    Hash.update(OS.str());
+  }
+
+  // Separate the fields with a NUL so that moving characters between them
+  // changes the key.
+  std::string Config;
+  raw_string_ostream OS(Config);
+  OS << '\0' << MCpu << '\0' << unsigned(CodeModel) << EmitDwarfDebugInfo
+     << disableOpt << disableInline << disableGVNLoadPRE << Partitions << '\0';
+
+  // The preserved symbols decide what is internalized.
+  std::vector<StringRef> Preserved;
+  for (StringSet::iterator I = MustPreserveSymbols.begin(),
+         E = MustPreserveSymbols.end(); I != E; ++I)
+    Preserved.push_back(I->getKey());
+  std::sort(Preserved.begin(), Preserved.end());
+  for (unsigned i = 0, e = Preserved.size(); i != e; ++i)
+    OS << Preserved[i] << '\0';
+  OS << '\0';
+
+  // So do the linker's resolutions.
+  std::vector<std::pair<StringRef, unsigned> > Resolutions;
+  for (StringMap<lto_symbol_resolution>::iterator
+         I = SymbolResolutions.begin(), E = SymbolResolutions.end();
+       I != E; ++I)
+    Resolutions.push_back(std::make_pair(I->getKey(), unsigned(I->second)));
+  std::sort(Resolutions.begin(), Resolutions.end());
+  for (unsigned i = 0, e = Resolutions.size(); i != e; ++i)
+    OS << Resolutions[i].first << '\0' << Resolutions[i].second << '\0';
+  OS << '\0';
+
+  for (unsigned i = 0, e = CodegenOptions.size(); i != e; ++i)
+    OS << CodegenOptions[i] << '\0';
+  Hash.update(OS.str());
+
+  LTOObjectCache::addTargetOptions(Hash, Options);
+  return LTOObjectCache::getKey(Hash);
+}
+
 const void* LTOCodeGenerator::compile(size_t* length,
                                       bool disableOpt,
                                       bool disableInline,
@@ -313,6 +431,22 @@ bool LTOCodeGenerator::determineTarget(std::string &errMsg) {
   return true;
 }
 
+/// dropDefinition - Turn GV into a declaration of the definition the linker
+/// chose over it.  Return false if GV must keep its definition.
+static bool dropDefinition(GlobalValue &GV) {
+  if (Function *F = dyn_cast<Function>(&GV)) {
+    F->deleteBody();
+  } else if (GlobalVariable *Var = dyn_cast<GlobalVariable>(&GV)) {
+    Var->setInitializer(0);
+    Var->setLinkage(GlobalValue::ExternalLinkage);
+  } else {
+    // An alias cannot be made a declaration.
+    return false;
+  }
+  GV.setVisibility(GlobalValue::DefaultVisibility);
+  return true;
+}
+
 void LTOCodeGenerator::
 applyRestriction(GlobalValue &GV,
                  const ArrayRef<StringRef> &Libcalls,
@@ -324,7 +458,19 @@ applyRestriction(GlobalValue &GV,
 
   if (GV.isDeclaration())
     return;
-  if (MustPreserveSymbols.count(Buffer))
+
+  // The linker's resolution, when it gave one, is more precise than the
+  // preserved symbols.
+  StringMap<lto_symbol_resolution>::const_iterator Res =
+    SymbolResolutions.find(Buffer);
+  bool Preserve = MustPreserveSymbols.count(Buffer);
+  if (Res != SymbolResolutions.end()) {
+    if (Res->second == LTO_SYMBOL_RESOLUTION_PREEMPTED &&
+        dropDefinition(GV))
+      return;
+    Preserve = Res->second == LTO_SYMBOL_RESOLUTION_PREVAILING_DEF;
+  }
+  if (Preserve)
     MustPreserveList.push_back(GV.getName().data());
   if (AsmUndefinedRefs.count(Buffer))
     AsmUsed.insert(&GV);
@@ -439,15 +585,14 @@ void LTOCodeGenerator::applyScopeRestrictions() {
 }
 
 /// Optimize merged modules using various IPO passes
-bool LTOCodeGenerator::generateObjectFile(raw_ostream &out,
-                                          bool DisableOpt,
-                                          bool DisableInline,
-                                          bool DisableGVNLoadPRE,
-                                          std::string &errMsg) {
-  if (!this->determineTarget(errMsg))
-    return false;
-
+/// optimizeMergedModule - Restrict the scope of symbols the linker does not
+/// need and run the link-time optimization pipeline on the merged module.
+void LTOCodeGenerator::optimizeMergedModule(bool DisableOpt,
+                                            bool DisableInline,
+                                            bool DisableGVNLoadPRE) {
+  TimeTraceScope TraceScope("LTO Optimize");
   Module *mergedModule = Linker.getModule();
+  reportMemoryUsage("link");
 
   // Mark which symbols can not be internalized
   this->applyScopeRestrictions();
@@ -478,6 +623,21 @@ bool LTOCodeGenerator::generateObjectFile(raw_ostream &out,
   // Make sure everything is still good.
   passes.add(createVerifierPass());
 
+  // Run our queue of passes all at once now, efficiently.
+  passes.run(*mergedModule);
+  reportMemoryUsage("optimization");
+}
+
+bool LTOCodeGenerator::generateObjectFile(raw_ostream &out,
+                                          bool DisableOpt,
+                                          bool DisableInline,
+                                          bool DisableGVNLoadPRE,
+                                          std::string &errMsg) {
+  if (!this->determineTarget(errMsg))
+    return false;
+
+  Module *mergedModule = Linker.getModule();
+
   PassManager codeGenPasses;
 
   codeGenPasses.add(new DataLayout(*TargetMach->getDataLayout()));
@@ -495,12 +655,415 @@ bool LTOCodeGenerator::generateObjectFile(raw_ostream &out,
     return false;
   }
 
-  // Run our queue of passes all at once now, efficiently.
-  passes.run(*mergedModule);
+  optimizeMergedModule(DisableOpt, DisableInline, DisableGVNLoadPRE);
 
   // Run the code generator, and write assembly file
-  codeGenPasses.run(*mergedModule);
+  {
+    TimeTraceScope TraceScope("LTO Code Generation");
+    codeGenPasses.run(*mergedModule);
+  }
+  reportMemoryUsage("code generation");
+
+  return true;
+}
+
+//===----------------------------------------------------------------------===//
+// Partitioned code generation
+//===----------------------------------------------------------------------===//
+
+namespace {
+/// CodeGenJob - One partition of the merged module.  The partition travels as
+/// bitcode so that each thread can parse it into its own LLVMContext; code
+/// generation may create IR constants, which is not safe to do concurrently
+/// in a shared context.
+struct CodeGenJob {
+  std::string Bitcode;
+  const Target *TheTarget;
+  std::string TripleStr;
+  std::string CPU;
+  std::string Features;
+  TargetOptions Options;
+  Reloc::Model RelocModel;
+  std::string OutputPath;
+  std::string ErrMsg;
+};
+}
+
+/// getFunctionSize - Estimate the code generation cost of F.
+static uint64_t getFunctionSize(const Function &F) {
+  uint64_t Size = 0;
+  for (Function::const_iterator BB = F.begin(), E = F.end(); BB != E; ++BB)
+    Size += BB->size();
+  return Size;
+}
+
+/// collectReferencedGlobals - Add the global values used by the operands of
+/// U to Globals, looking through constant expressions and aggregates.
+static void collectReferencedGlobals(const User *U,
+                                     SmallPtrSet<GlobalValue*, 16> &Globals,
+                                     SmallPtrSet<const Constant*, 32> &Visited) {
+  for (User::const_op_iterator I = U->op_begin(), E = U->op_end(); I != E;
+       ++I) {
+    if (GlobalValue *GV = dyn_cast<GlobalValue>(*I))
+      Globals.insert(GV);
+    else if (const Constant *C = dyn_cast<Constant>(*I))
+      if (Visited.insert(C))
+        collectReferencedGlobals(C, Globals, Visited);
+  }
+}
+
+static void collectReferencedGlobals(const Function &F,
+                                     SmallPtrSet<GlobalValue*, 16> &Globals) {
+  SmallPtrSet<const Constant*, 32> Visited;
+  for (const_inst_iterator I = inst_begin(F), E = inst_end(F); I != E; ++I)
+    collectReferencedGlobals(&*I, Globals, Visited);
+}
 
+/// partitionModule - Assign each definition in M to one of at most
+/// NumPartitions partitions and return the number used.  Functions are laid
+/// out in depth-first call order, so that callees tend to follow their
+/// callers, and that order is cut into runs of about equal size.  Variables
+/// go with the first function that uses them.
+static unsigned partitionModule(Module &M, unsigned NumPartitions,
+                          DenseMap<const GlobalValue*, unsigned> &PartitionOf) {
+  std::vector<Function*> Order;
+  SmallPtrSet<Function*, 64> Visited;
+  uint64_t TotalSize = 0;
+  for (Module::iterator I = M.begin(), E = M.end(); I != E; ++I) {
+    SmallVector<Function*, 16> Worklist;
+    Worklist.push_back(I);
+    while (!Worklist.empty()) {
+      Function *F = Worklist.pop_back_val();
+      if (F->isDeclaration() || F->hasAvailableExternallyLinkage() ||
+          !Visited.insert(F))
+        continue;
+
+      // The address of a block cannot refer to a function in another object,
+      // so keep such modules in one piece.
+      for (Function::iterator BB = F->begin(), BE = F->end(); BB != BE; ++BB)
+        if (BB->hasAddressTaken())
+          return 1;
+
+      Order.push_back(F);
+      TotalSize += getFunctionSize(*F);
+
+      // Push the callees in reverse so that the first call is visited first.
+      SmallVector<Function*, 8> Callees;
+      for (inst_iterator II = inst_begin(F), IE = inst_end(F); II != IE; ++II) {
+        CallSite CS(&*II);
+        if (CS)
+          if (Function *Callee = CS.getCalledFunction())
+            Callees.push_back(Callee);
+      }
+      Worklist.append(Callees.rbegin(), Callees.rend());
+    }
+  }
+
+  if (NumPartitions > Order.size())
+    NumPartitions = Order.size();
+  if (NumPartitions <= 1)
+    return 1;
+
+  uint64_t Target = (TotalSize + NumPartitions - 1) / NumPartitions;
+  unsigned Partition = 0;
+  uint64_t Filled = 0;
+  for (unsigned i = 0, e = Order.size(); i != e; ++i) {
+    PartitionOf[Order[i]] = Partition;
+    Filled += getFunctionSize(*Order[i]);
+    if (Filled >= Target * (Partition + 1) && Partition + 1 < NumPartitions)
+      ++Partition;
+  }
+
+  // Special variables such as llvm.used and llvm.global_ctors must be emitted
+  // exactly once; give them to the first partition.
+  for (Module::global_iterator I = M.global_begin(), E = M.global_end();
+       I != E; ++I)
+    if (I->getName().startswith("llvm."))
+      PartitionOf[I] = 0;
+
+  for (unsigned i = 0, e = Order.size(); i != e; ++i) {
+    SmallPtrSet<GlobalValue*, 16> Globals;
+    collectReferencedGlobals(*Order[i], Globals);
+    for (SmallPtrSet<GlobalValue*, 16>::iterator I = Globals.begin(),
+         E = Globals.end(); I != E; ++I)
+      if (isa<GlobalVariable>(*I) && !(*I)->isDeclaration() &&
+          !PartitionOf.count(*I))
+        PartitionOf[*I] = PartitionOf[Order[i]];
+  }
+  for (Module::global_iterator I = M.global_begin(), E = M.global_end();
+       I != E; ++I)
+    if (!I->isDeclaration() && !PartitionOf.count(I))
+      PartitionOf[I] = 0;
+
+  // Aliases must be emitted alongside the object they name.
+  for (Module::alias_iterator I = M.alias_begin(), E = M.alias_end(); I != E;
+       ++I) {
+    const GlobalValue *Aliasee = I->resolveAliasedGlobal(false);
+    DenseMap<const GlobalValue*, unsigned>::iterator P =
+      Aliasee ? PartitionOf.find(Aliasee) : PartitionOf.end();
+    PartitionOf[I] = P == PartitionOf.end() ? 0 : P->second;
+  }
+
+  return Partition + 1;
+}
+
+/// externalizeCrossPartitionReferences - Local symbols used from a partition
+/// other than their own must become visible to the linker.  Rename them so
+/// that they cannot clash with symbols from other objects, and hide them so
+/// that they do not escape the final image.
+static void externalizeCrossPartitionReferences(Module &M,
+                          DenseMap<const GlobalValue*, unsigned> &PartitionOf) {
+  SmallPtrSet<GlobalValue*, 16> ToExternalize;
+  SmallPtrSet<GlobalValue*, 16> Globals;
+
+  for (Module::iterator F = M.begin(), E = M.end(); F != E; ++F) {
+    if (!PartitionOf.count(F))
+      continue;
+    Globals.clear();
+    collectReferencedGlobals(*F, Globals);
+    unsigned Partition = PartitionOf[F];
+    for (SmallPtrSet<GlobalValue*, 16>::iterator I = Globals.begin(),
+         IE = Globals.end(); I != IE; ++I)
+      if ((*I)->hasLocalLinkage() && PartitionOf.lookup(*I) != Partition)
+        ToExternalize.insert(*I);
+  }
+
+  for (Module::global_iterator GV = M.global_begin(), E = M.global_end();
+       GV != E; ++GV) {
+    if (!GV->hasInitializer())
+      continue;
+    Globals.clear();
+    SmallPtrSet<const Constant*, 32> Visited;
+    if (GlobalValue *Init = dyn_cast<GlobalValue>(GV->getInitializer()))
+      Globals.insert(Init);
+    else
+      collectReferencedGlobals(GV->getInitializer(), Globals, Visited);
+    unsigned Partition = PartitionOf.lookup(GV);
+    for (SmallPtrSet<GlobalValue*, 16>::iterator I = Globals.begin(),
+         IE = Globals.end(); I != IE; ++I)
+      if ((*I)->hasLocalLinkage() && PartitionOf.lookup(*I) != Partition)
+        ToExternalize.insert(*I);
+  }
+
+  for (SmallPtrSet<GlobalValue*, 16>::iterator I = ToExternalize.begin(),
+       E = ToExternalize.end(); I != E; ++I) {
+    GlobalValue *GV = *I;
+    GV->setName(GV->getName() + ".lto.priv");
+    GV->setLinkage(GlobalValue::ExternalLinkage);
+    GV->setVisibility(GlobalValue::HiddenVisibility);
+  }
+}
+
+/// extractPartition - Return a copy of M in which only the definitions
+/// assigned to Partition remain; everything else becomes a declaration.
+static Module *extractPartition(const Module &M, unsigned Partition,
+                          DenseMap<const GlobalValue*, unsigned> &PartitionOf) {
+  ValueToValueMapTy VMap;
+  Module *Part = CloneModule(&M, VMap);
+
+  for (Module::const_alias_iterator I = M.alias_begin(), E = M.alias_end();
+       I != E; ++I) {
+    if (PartitionOf.lookup(I) == Partition)
+      continue;
+    GlobalAlias *GA = cast<GlobalAlias>(VMap[I]);
+    PointerType *Ty = GA->getType();
+    GlobalValue *Decl;
+    if (FunctionType *FTy = dyn_cast<FunctionType>(Ty->getElementType()))
+      Decl = Function::Create(FTy, GlobalValue::ExternalLinkage, "", Part);
+    else
+      Decl = new GlobalVariable(*Part, Ty->getElementType(), false,
+                                GlobalValue::ExternalLinkage, 0, "", 0,
+                                GlobalVariable::NotThreadLocal,
+                                Ty->getAddressSpace());
+    Decl->takeName(GA);
+    Decl->setVisibility(GA->getVisibility());
+    GA->replaceAllUsesWith(Decl);
+    GA->eraseFromParent();
+  }
+
+  for (Module::const_iterator I = M.begin(), E = M.end(); I != E; ++I) {
+    if (I->isDeclaration() || I->hasAvailableExternallyLinkage() ||
+        PartitionOf.lookup(I) == Partition)
+      continue;
+    cast<Function>(VMap[I])->deleteBody();
+  }
+
+  for (Module::const_global_iterator I = M.global_begin(), E = M.global_end();
+       I != E; ++I) {
+    if (I->isDeclaration() || I->hasAvailableExternallyLinkage() ||
+        PartitionOf.lookup(I) == Partition)
+      continue;
+    GlobalVariable *GV = cast<GlobalVariable>(VMap[I]);
+    if (GV->getName().startswith("llvm.") && GV->use_empty()) {
+      GV->eraseFromParent();
+      continue;
+    }
+    GV->setInitializer(0);
+    GV->setLinkage(GlobalValue::ExternalLinkage);
+  }
+
+  return Part;
+}
+
+/// runCodeGenJob - Generate the object file for one partition.
+static void runCodeGenJob(void *Arg) {
+  CodeGenJob &Job = *static_cast<CodeGenJob*>(Arg);
+  TimeTraceScope TraceScope("LTO Code Generation");
+
+  int FD;
+  SmallString<128> Filename;
+  if (error_code EC = sys::fs::createTemporaryFile("lto-llvm", "o", FD,
+                                                   Filename)) {
+    Job.ErrMsg = EC.message();
+    return;
+  }
+  tool_output_file ObjFile(Filename.c_str(), FD);
+
+  LLVMContext Context;
+  OwningPtr<MemoryBuffer> Buffer(MemoryBuffer::getMemBuffer(Job.Bitcode, "",
+                                                            false));
+  OwningPtr<Module> M(ParseBitcodeFile(Buffer.get(), Context, &Job.ErrMsg));
+  if (!M)
+    return;
+
+  OwningPtr<TargetMachine> TM(
+    Job.TheTarget->createTargetMachine(Job.TripleStr, Job.CPU, Job.Features,
+                                       Job.Options, Job.RelocModel,
+                                       CodeModel::Default,
+                                       CodeGenOpt::Aggressive));
+  PassManager CodeGenPasses;
+  CodeGenPasses.add(new DataLayout(*TM->getDataLayout()));
+  TM->addAnalysisPasses(CodeGenPasses);
+  CodeGenPasses.add(createObjCARCContractPass());
+
+  {
+    formatted_raw_ostream Out(ObjFile.os());
+    if (TM->addPassesToEmitFile(CodeGenPasses, Out,
+                                TargetMachine::CGFT_ObjectFile)) {
+      Job.ErrMsg = "target file type not supported";
+      return;
+    }
+    CodeGenPasses.run(*M);
+  }
+
+  ObjFile.os().close();
+  if (ObjFile.os().has_error()) {
+    ObjFile.os().clear_error();
+    Job.ErrMsg = "could not write " + Filename.str().str();
+    return;
+  }
+  ObjFile.keep();
+  Job.OutputPath = Filename.str();
+}
+
+/// runCodeGenJobs - Run all jobs, in parallel on the global ThreadPool where
+/// threads are available.
+static void runCodeGenJobs(std::vector<CodeGenJob> &Jobs) {
+  if (Jobs.size() > 1 &&
+      (llvm_is_multithreaded() || llvm_start_multithreaded())) {
+    TaskGroup Group;
+    for (unsigned i = 0, e = Jobs.size(); i != e; ++i)
+      Group.async(runCodeGenJob, &Jobs[i]);
+    Group.wait();
+    return;
+  }
+  for (unsigned i = 0, e = Jobs.size(); i != e; ++i)
+    runCodeGenJob(&Jobs[i]);
+}
+
+bool LTOCodeGenerator::compile_to_files(const char ***Names, unsigned *Count,
+                                        unsigned Partitions,
+                                        bool DisableOpt,
+                                        bool DisableInline,
+                                        bool DisableGVNLoadPRE,
+                                        std::string &errMsg) {
+  if (!this->determineTarget(errMsg))
+    return false;
+
+  NativeObjectPaths.clear();
+  NativeObjectNames.clear();
+
+  // Partitions are cached as "<key>-<i>-of-<n>"; the module may have been
+  // split into fewer pieces than were asked for.
+  std::string CacheKey;
+  if (!CacheDir.empty()) {
+    CacheKey = getCacheKey(DisableOpt, DisableInline, DisableGVNLoadPRE,
+                           Partitions);
+    LTOObjectCache Cache(CacheDir);
+    for (unsigned N = std::max(Partitions, 1U); N != 0; --N) {
+      std::string Suffix = "-of-" + utostr(N);
+      std::string Path;
+      if (!Cache.lookup(CacheKey + "-0" + Suffix, Path))
+        continue;
+      NativeObjectPaths.push_back(Path);
+      for (unsigned i = 1; i != N; ++i) {
+        if (!Cache.lookup(CacheKey + "-" + utostr(i) + Suffix, Path))
+          break;
+        NativeObjectPaths.push_back(Path);
+      }
+      if (NativeObjectPaths.size() == N) {
+        for (unsigned i = 0; i != N; ++i)
+          NativeObjectNames.push_back(NativeObjectPaths[i].c_str());
+        *Names = &NativeObjectNames[0];
+        *Count = N;
+        return true;
+      }
+      for (unsigned i = 0, e = NativeObjectPaths.size(); i != e; ++i)
+        sys::fs::remove(NativeObjectPaths[i]);
+      NativeObjectPaths.clear();
+      break;
+    }
+  }
+
+  optimizeMergedModule(DisableOpt, DisableInline, DisableGVNLoadPRE);
+
+  Module *MergedModule = Linker.getModule();
+  DenseMap<const GlobalValue*, unsigned> PartitionOf;
+  unsigned NumParts = partitionModule(*MergedModule, Partitions, PartitionOf);
+  if (NumParts > 1)
+    externalizeCrossPartitionReferences(*MergedModule, PartitionOf);
+
+  std::vector<CodeGenJob> Jobs(NumParts);
+  for (unsigned i = 0; i != NumParts; ++i) {
+    CodeGenJob &Job = Jobs[i];
+    {
+      OwningPtr<Module> Part(NumParts > 1 ?
+                               extractPartition(*MergedModule, i, PartitionOf) :
+                               CloneModule(MergedModule));
+      raw_string_ostream OS(Job.Bitcode);
+      WriteBitcodeToFile(Part.get(), OS);
+    }
+    Job.TheTarget = &TargetMach->getTarget();
+    Job.TripleStr = TargetMach->getTargetTriple();
+    Job.CPU = TargetMach->getTargetCPU();
+    Job.Features = TargetMach->getTargetFeatureString();
+    Job.Options = TargetMach->Options;
+    Job.RelocModel = TargetMach->getRelocationModel();
+  }
+
+  runCodeGenJobs(Jobs);
+  reportMemoryUsage("code generation");
+
+  for (unsigned i = 0; i != NumParts; ++i) {
+    if (Jobs[i].ErrMsg.empty())
+      continue;
+    errMsg = Jobs[i].ErrMsg;
+    for (unsigned j = 0; j != NumParts; ++j)
+      if (!Jobs[j].OutputPath.empty())
+        sys::fs::remove(Jobs[j].OutputPath);
+    return false;
+  }
+
+  for (unsigned i = 0; i != NumParts; ++i) {
+    if (!CacheKey.empty())
+      LTOObjectCache(CacheDir).store(CacheKey + "-" + utostr(i) + "-of-" +
+                                     utostr(NumParts), Jobs[i].OutputPath);
+    NativeObjectPaths.push_back(Jobs[i].OutputPath);
+  }
+  for (unsigned i = 0; i != NumParts; ++i)
+    NativeObjectNames.push_back(NativeObjectPaths[i].c_str());
+  *Names = &NativeObjectNames[0];
+  *Count = NumParts;
   return true;
 }
 
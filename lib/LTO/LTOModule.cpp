@@ -14,10 +14,13 @@
 
 #include "llvm/LTO/LTOModule.h"
 #include "llvm/ADT/OwningPtr.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/Triple.h"
 #include "llvm/Bitcode/ReaderWriter.h"
+#include "llvm/DebugInfo.h"
 #include "llvm/IR/Constants.h"
 #include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Metadata.h"
 #include "llvm/IR/Module.h"
 #include "llvm/MC/MCExpr.h"
 #include "llvm/MC/MCInst.h"
@@ -131,6 +134,22 @@ LTOModule *LTOModule::makeLTOModule(const void *mem, size_t length,
   return makeLTOModule(buffer.take(), options, errMsg);
 }
 
+/// hasUsesToAnalyze - Return true if M defines a linkonce_odr value whose
+/// address may be significant.  canBeHidden looks at its uses, which are only
+/// all visible once every function body has been read.
+static bool hasUsesToAnalyze(const Module &M) {
+  for (Module::const_iterator I = M.begin(), E = M.end(); I != E; ++I)
+    if (I->getLinkage() == GlobalValue::LinkOnceODRLinkage &&
+        !I->hasUnnamedAddr())
+      return true;
+  for (Module::const_global_iterator I = M.global_begin(),
+         E = M.global_end(); I != E; ++I)
+    if (I->getLinkage() == GlobalValue::LinkOnceODRLinkage &&
+        !I->hasUnnamedAddr())
+      return true;
+  return false;
+}
+
 LTOModule *LTOModule::makeLTOModule(MemoryBuffer *buffer,
                                     TargetOptions options,
                                     std::string &errMsg) {
@@ -167,7 +186,29 @@ LTOModule *LTOModule::makeLTOModule(MemoryBuffer *buffer,
 
   TargetMachine *target = march->createTargetMachine(TripleStr, CPU, FeatureStr,
                                                      options);
-  m->MaterializeAllPermanently();
+  // Function bodies are left in the bitcode until the Linker needs them; it
+  // reads each one straight into the merged module and never reads the local
+  // and linkonce functions that nothing references.  Only stale debug info
+  // needs the whole module, since the reader strips it module-wide.
+  if (m->getNamedMetadata("llvm.dbg.cu") &&
+      getDebugMetadataVersionFromModule(*m) != DEBUG_METADATA_VERSION)
+    m->MaterializeAllPermanently();
+
+  // Deciding whether a linkonce_odr definition can be hidden looks at every
+  // use of its address, so the bodies are read for parseSymbols and dropped
+  // again once the symbol table is built.
+  SmallVector<Function *, 16> Materialized;
+  if (hasUsesToAnalyze(*m)) {
+    for (Module::iterator F = m->begin(), E = m->end(); F != E; ++F) {
+      if (!F->isMaterializable())
+        continue;
+      if (F->Materialize(&errMsg)) {
+        delete target;
+        return NULL;
+      }
+      Materialized.push_back(F);
+    }
+  }
 
   LTOModule *Ret = new LTOModule(m.take(), target);
   if (Ret->parseSymbols(errMsg)) {
@@ -175,6 +216,15 @@ LTOModule *LTOModule::makeLTOModule(MemoryBuffer *buffer,
     return NULL;
   }
 
+  // Dropping a body also makes the function external; give it back the
+  // linkage it had when it was first read lazily.
+  for (unsigned i = 0, e = Materialized.size(); i != e; ++i) {
+    Function *F = Materialized[i];
+    GlobalValue::LinkageTypes Linkage = F->getLinkage();
+    F->Dematerialize();
+    F->setLinkage(Linkage);
+  }
+
   return Ret;
 }
 
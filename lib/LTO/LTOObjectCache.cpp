@@ -0,0 +1,114 @@
+//===-LTOObjectCache.cpp - Cache of LTO native objects --------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the LTOObjectCache class.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/LTO/LTOObjectCache.h"
+#include "llvm/ADT/OwningPtr.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Config/config.h"
+#include "llvm/Support/FileOutputBuffer.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/TimeValue.h"
+#include "llvm/Support/ToolOutputFile.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Support/system_error.h"
+#include "llvm/Target/TargetOptions.h"
+#include <cstring>
+using namespace llvm;
+
+void LTOObjectCache::addTargetOptions(MD5 &Hash, const TargetOptions &Options) {
+  SmallString<128> Str;
+  raw_svector_ostream OS(Str);
+  OS << Options.LessPreciseFPMADOption << Options.NoFramePointerElim
+     << Options.UnsafeFPMath << Options.NoInfsFPMath << Options.NoNaNsFPMath
+     << Options.HonorSignDependentRoundingFPMathOption
+     << Options.UseSoftFloat << Options.NoZerosInBSS
+     << Options.GuaranteedTailCallOpt << Options.DisableTailCalls
+     << Options.EnableFastISel << Options.PositionIndependentExecutable
+     << Options.EnableSegmentedStacks << Options.UseInitArray
+     << ',' << Options.StackAlignmentOverride
+     << ',' << unsigned(Options.FloatABIType)
+     << ',' << unsigned(Options.AllowFPOpFusion)
+     << ',' << Options.TrapFuncName;
+  Hash.update(OS.str());
+  Hash.update(StringRef("\0", 1));
+}
+
+std::string LTOObjectCache::getKey(MD5 &Hash) {
+  // Objects from another version of LLVM may differ for the same input.
+  Hash.update(StringRef(PACKAGE_VERSION));
+  Hash.update(StringRef("\0", 1));
+#ifdef LLVM_VERSION_INFO
+  Hash.update(StringRef(LLVM_VERSION_INFO));
+  Hash.update(StringRef("\0", 1));
+#endif
+
+  MD5::MD5Result Result;
+  Hash.final(Result);
+  SmallString<32> Key;
+  MD5::stringifyResult(Result, Key);
+  return Key.str();
+}
+
+std::string LTOObjectCache::getPath(StringRef Key) const {
+  SmallString<128> Path(CacheDir);
+  sys::path::append(Path, Key + ".o");
+  return Path.str();
+}
+
+bool LTOObjectCache::lookup(StringRef Key, std::string &ObjPath) const {
+  std::string Path = getPath(Key);
+  OwningPtr<MemoryBuffer> Obj;
+  if (MemoryBuffer::getFile(Path, Obj, -1, /*RequiresNullTerminator=*/false))
+    return false;
+
+  // Mark the object as recently used so that pruning by age keeps it.
+  int CacheFD;
+  if (!sys::fs::openFileForWrite(Path, CacheFD, sys::fs::F_Append)) {
+    raw_fd_ostream CacheFile(CacheFD, /*shouldClose=*/true);
+    sys::fs::setLastModificationAndAccessTime(CacheFD, sys::TimeValue::now());
+  }
+
+  int FD;
+  SmallString<128> Filename;
+  if (sys::fs::createTemporaryFile("lto-llvm", "o", FD, Filename))
+    return false;
+  tool_output_file ObjFile(Filename.c_str(), FD);
+  ObjFile.os().write(Obj->getBufferStart(), Obj->getBufferSize());
+  ObjFile.os().close();
+  if (ObjFile.os().has_error()) {
+    ObjFile.os().clear_error();
+    return false;
+  }
+  ObjFile.keep();
+  ObjPath = Filename.str();
+  return true;
+}
+
+void LTOObjectCache::store(StringRef Key, StringRef ObjPath) const {
+  if (sys::fs::create_directories(CacheDir))
+    return;
+
+  OwningPtr<MemoryBuffer> Obj;
+  if (MemoryBuffer::getFile(ObjPath, Obj, -1, false))
+    return;
+
+  OwningPtr<FileOutputBuffer> Out;
+  if (FileOutputBuffer::create(getPath(Key), Obj->getBufferSize(), Out))
+    return;
+  std::memcpy(Out->getBufferStart(), Obj->getBufferStart(),
+              Obj->getBufferSize());
+  Out->commit();
+}
@@ -0,0 +1,654 @@
+//===-ThinLTOCodeGenerator.cpp - Summary-based LTO ------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the ThinLTOCodeGenerator class.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/LTO/ThinLTOCodeGenerator.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/OwningPtr.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Bitcode/ReaderWriter.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/DataLayout.h"
+#include "llvm/IR/DerivedTypes.h"
+#include "llvm/IR/GlobalAlias.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/LTO/LTOObjectCache.h"
+#include "llvm/Linker.h"
+#include "llvm/PassManager.h"
+#include "llvm/Support/CallSite.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/FormattedStream.h"
+#include "llvm/Support/Host.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/InstIterator.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/TargetRegistry.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
+#include "llvm/Support/ToolOutputFile.h"
+#include "llvm/Support/system_error.h"
+#include "llvm/Target/Mangler.h"
+#include "llvm/Target/TargetLibraryInfo.h"
+#include "llvm/Target/TargetMachine.h"
+#include "llvm/Transforms/IPO.h"
+#include "llvm/Transforms/IPO/PassManagerBuilder.h"
+#include "llvm/Transforms/ObjCARC.h"
+using namespace llvm;
+
+/// collectRefs - Add the global values used by the operands of U to Refs,
+/// looking through constant expressions.  Set UsesBlockAddress if any block
+/// addresses are used; those cannot be named from another module.
+static void collectRefs(const User *U, SmallPtrSet<const GlobalValue*, 16> &Refs,
+                        SmallPtrSet<const Constant*, 32> &Visited,
+                        bool &UsesBlockAddress) {
+  for (User::const_op_iterator I = U->op_begin(), E = U->op_end(); I != E;
+       ++I) {
+    if (const GlobalValue *GV = dyn_cast<GlobalValue>(*I)) {
+      Refs.insert(GV);
+    } else if (const Constant *C = dyn_cast<Constant>(*I)) {
+      if (isa<BlockAddress>(C))
+        UsesBlockAddress = true;
+      if (Visited.insert(C))
+        collectRefs(C, Refs, Visited, UsesBlockAddress);
+    }
+  }
+}
+
+/// isSpecialName - Return true for symbols, such as llvm.used, that the
+/// summaries must not treat as ordinary definitions.
+static bool isSpecialName(StringRef Name) {
+  return Name.startswith("llvm.");
+}
+
+/// isDefinition - Return true if GV is defined in its module, whether or not
+/// its body has been read yet.
+static bool isDefinition(const GlobalValue &GV) {
+  return !GV.isDeclaration() || GV.isMaterializable();
+}
+
+ThinLTOCodeGenerator::ThinLTOCodeGenerator()
+    : CodeModel(LTO_CODEGEN_PIC_MODEL_DYNAMIC), ImportInstrLimit(100) {
+}
+
+ThinLTOCodeGenerator::~ThinLTOCodeGenerator() {
+}
+
+bool ThinLTOCodeGenerator::addModule(const char *Identifier, const void *Mem,
+                                     size_t Length, std::string &errMsg) {
+  Modules.push_back(ModuleSummary());
+  unsigned ModuleIdx = Modules.size() - 1;
+  ModuleSummary &Summary = Modules.back();
+  Summary.Identifier = Identifier;
+  Summary.Bitcode.assign(static_cast<const char*>(Mem), Length);
+
+  // The module is only needed while it is summarized, and each body is read
+  // and dropped in turn, so at most one function is in memory at a time.
+  LLVMContext Context;
+  OwningPtr<MemoryBuffer> Buffer(
+    MemoryBuffer::getMemBuffer(Summary.Bitcode, Identifier, false));
+  OwningPtr<Module> M(getLazyBitcodeModule(Buffer.get(), Context, &errMsg));
+  if (!M) {
+    Modules.pop_back();
+    return false;
+  }
+  Buffer.take();
+
+  Summary.HasInlineAsm = !M->getModuleInlineAsm().empty();
+
+  SmallPtrSet<const GlobalValue*, 16> ModuleRefs;
+  SmallPtrSet<const Constant*, 32> Visited;
+  bool UsesBlockAddress = false;
+
+  // Dropping a function body resets its linkage, so note the local symbols
+  // before any body is read.
+  SmallPtrSet<const GlobalValue*, 32> Locals;
+  for (Module::iterator I = M->begin(), E = M->end(); I != E; ++I)
+    if (I->hasLocalLinkage())
+      Locals.insert(I);
+
+  for (Module::global_iterator I = M->global_begin(), E = M->global_end();
+       I != E; ++I) {
+    if (I->hasLocalLinkage())
+      Locals.insert(I);
+    if (I->hasInitializer())
+      collectRefs(I, ModuleRefs, Visited, UsesBlockAddress);
+    if (isDefinition(*I) && !I->hasLocalLinkage() &&
+        !I->hasAvailableExternallyLinkage() && !isSpecialName(I->getName()))
+      Summary.Defined.push_back(I->getName());
+  }
+
+  for (Module::alias_iterator I = M->alias_begin(), E = M->alias_end();
+       I != E; ++I) {
+    collectRefs(I, ModuleRefs, Visited, UsesBlockAddress);
+    if (I->hasLocalLinkage())
+      Locals.insert(I);
+    else
+      Summary.Defined.push_back(I->getName());
+  }
+
+  for (Module::iterator F = M->begin(), E = M->end(); F != E; ++F) {
+    if (!isDefinition(*F))
+      continue;
+
+    bool IsGlobal = !F->hasLocalLinkage() &&
+                    !F->hasAvailableExternallyLinkage();
+    bool IsUnique = F->hasExternalLinkage();
+
+    if (M->Materialize(F, &errMsg)) {
+      for (StringMap<FunctionSummary>::iterator I = Functions.begin(),
+           IE = Functions.end(); I != IE;) {
+        StringMap<FunctionSummary>::iterator Cur = I;
+        ++I;
+        if (Cur->getValue().Module == ModuleIdx)
+          Functions.erase(Cur);
+      }
+      Modules.pop_back();
+      return false;
+    }
+
+    SmallPtrSet<const GlobalValue*, 16> Refs;
+    SmallPtrSet<const Constant*, 32> FnVisited;
+    std::vector<std::string> Callees;
+    bool FnUsesLocal = false;
+    unsigned InstCount = 0;
+    for (inst_iterator I = inst_begin(F), IE = inst_end(F); I != IE; ++I) {
+      ++InstCount;
+      collectRefs(&*I, Refs, FnVisited, FnUsesLocal);
+      CallSite CS(&*I);
+      if (!CS)
+        continue;
+      if (const Function *Callee = CS.getCalledFunction())
+        if (!Callee->isIntrinsic())
+          Callees.push_back(Callee->getName());
+    }
+    for (SmallPtrSet<const GlobalValue*, 16>::iterator I = Refs.begin(),
+         IE = Refs.end(); I != IE; ++I) {
+      if (Locals.count(*I))
+        FnUsesLocal = true;
+      ModuleRefs.insert(*I);
+    }
+    Summary.Callees.insert(Summary.Callees.end(), Callees.begin(),
+                           Callees.end());
+
+    if (IsGlobal) {
+      Summary.Defined.push_back(F->getName());
+
+      FunctionSummary &FS = Functions[F->getName()];
+      FS.Module = ModuleIdx;
+      FS.InstCount = InstCount;
+      FS.Importable = IsUnique && !FnUsesLocal && !F->isVarArg() &&
+        !F->hasSection() &&
+        !F->getAttributes().hasAttribute(AttributeSet::FunctionIndex,
+                                         Attribute::NoInline);
+      FS.Callees.swap(Callees);
+      for (SmallPtrSet<const GlobalValue*, 16>::iterator I = Refs.begin(),
+           IE = Refs.end(); I != IE; ++I)
+        if (!isSpecialName((*I)->getName()))
+          FS.Refs.push_back((*I)->getName());
+    }
+
+    M->Dematerialize(F);
+  }
+
+  // Only the symbols this module needs from elsewhere keep other modules'
+  // definitions from being internalized.
+  for (SmallPtrSet<const GlobalValue*, 16>::iterator I = ModuleRefs.begin(),
+       E = ModuleRefs.end(); I != E; ++I)
+    if (!isDefinition(**I) && !isSpecialName((*I)->getName()))
+      Summary.Referenced.push_back((*I)->getName());
+
+  for (unsigned i = 0, e = Summary.Defined.size(); i != e; ++i)
+    ++Definitions[Summary.Defined[i]];
+
+  return true;
+}
+
+/// computeImports - Decide which functions to import into module ModuleIdx.
+/// Starting from the module's calls, a callee is imported if another module
+/// has its only definition and it is small enough; the calls in an imported
+/// function are considered in turn with a smaller limit.  Imports maps each
+/// function to the module it comes from, and ImportedRefs receives the
+/// symbols that the imported bodies refer to.
+void ThinLTOCodeGenerator::computeImports(unsigned ModuleIdx,
+                                          StringMap<unsigned> &Imports,
+                                          StringSet<> &ImportedRefs) const {
+  SmallVector<std::pair<std::string, unsigned>, 32> Worklist;
+  const std::vector<std::string> &Calls = Modules[ModuleIdx].Callees;
+  for (unsigned i = 0, e = Calls.size(); i != e; ++i)
+    Worklist.push_back(std::make_pair(Calls[i], ImportInstrLimit));
+
+  while (!Worklist.empty()) {
+    std::pair<std::string, unsigned> Item = Worklist.pop_back_val();
+    StringMap<FunctionSummary>::const_iterator I = Functions.find(Item.first);
+    if (I == Functions.end())
+      continue;
+    const FunctionSummary &FS = I->second;
+    if (FS.Module == ModuleIdx || !FS.Importable ||
+        FS.InstCount > Item.second || Definitions.lookup(Item.first) != 1 ||
+        Imports.count(Item.first))
+      continue;
+
+    Imports[Item.first] = FS.Module;
+    for (unsigned i = 0, e = FS.Refs.size(); i != e; ++i)
+      ImportedRefs.insert(FS.Refs[i]);
+    for (unsigned i = 0, e = FS.Callees.size(); i != e; ++i)
+      Worklist.push_back(std::make_pair(FS.Callees[i], Item.second * 7 / 10));
+  }
+}
+
+namespace {
+/// ThinLTOJob - The work for one module, run on its own thread.
+struct ThinLTOJob {
+  const std::vector<ThinLTOCodeGenerator::ModuleSummary> *Modules;
+  unsigned ModuleIdx;
+  // The functions to import, by the module that defines them.
+  std::vector<std::vector<std::string> > Imports;
+  const StringSet<> *ExternallyReferenced;
+  const StringMap<char> *MustPreserveSymbols;
+  TargetOptions Options;
+  Reloc::Model RelocModel;
+  std::string CPU;
+  bool DisableOpt;
+  std::string CacheDir;
+  std::string CacheKey;
+  std::string OutputPath;
+  std::string ErrMsg;
+};
+}
+
+/// importFunctions - Link the functions named in Names from the bitcode of
+/// Src into Dest as available_externally definitions.  Only their bodies are
+/// read; everything else in Src is reduced to declarations first.
+static bool importFunctions(Module &Dest,
+                            const ThinLTOCodeGenerator::ModuleSummary &Src,
+                            const std::vector<std::string> &Names,
+                            std::string &ErrMsg) {
+  OwningPtr<MemoryBuffer> Buffer(
+    MemoryBuffer::getMemBuffer(Src.Bitcode, Src.Identifier, false));
+  OwningPtr<Module> SrcM(getLazyBitcodeModule(Buffer.get(), Dest.getContext(),
+                                              &ErrMsg));
+  if (!SrcM)
+    return false;
+  Buffer.take();
+
+  StringSet<> Wanted;
+  for (unsigned i = 0, e = Names.size(); i != e; ++i)
+    Wanted.insert(Names[i]);
+
+  std::vector<GlobalValue*> Replaced;
+  for (Module::iterator F = SrcM->begin(), E = SrcM->end(); F != E; ++F) {
+    if (!isDefinition(*F))
+      continue;
+    if (!Wanted.count(F->getName())) {
+      Replaced.push_back(F);
+      continue;
+    }
+    if (SrcM->Materialize(F, &ErrMsg))
+      return false;
+    F->setLinkage(GlobalValue::AvailableExternallyLinkage);
+  }
+  for (Module::alias_iterator I = SrcM->alias_begin(), E = SrcM->alias_end();
+       I != E; ++I)
+    Replaced.push_back(I);
+
+  // Create every declaration before erasing anything: the bitcode reader
+  // still knows the unread functions by address, and a new function must not
+  // be allocated where one of them was.
+  std::vector<GlobalValue*> Decls;
+  for (unsigned i = 0, e = Replaced.size(); i != e; ++i) {
+    PointerType *Ty = Replaced[i]->getType();
+    if (FunctionType *FTy = dyn_cast<FunctionType>(Ty->getElementType())) {
+      Function *Decl = Function::Create(FTy, GlobalValue::ExternalLinkage, "",
+                                        SrcM.get());
+      if (Function *F = dyn_cast<Function>(Replaced[i]))
+        Decl->setAttributes(F->getAttributes());
+      Decls.push_back(Decl);
+    } else {
+      Decls.push_back(new GlobalVariable(*SrcM, Ty->getElementType(), false,
+                                         GlobalValue::ExternalLinkage, 0, "",
+                                         0, GlobalVariable::NotThreadLocal,
+                                         Ty->getAddressSpace()));
+    }
+  }
+  for (unsigned i = 0, e = Replaced.size(); i != e; ++i) {
+    Decls[i]->takeName(Replaced[i]);
+    Decls[i]->setVisibility(Replaced[i]->hasLocalLinkage() ?
+                              GlobalValue::DefaultVisibility :
+                              Replaced[i]->getVisibility());
+    Replaced[i]->replaceAllUsesWith(Decls[i]);
+  }
+  for (unsigned i = 0, e = Replaced.size(); i != e; ++i)
+    if (GlobalAlias *GA = dyn_cast<GlobalAlias>(Replaced[i]))
+      GA->eraseFromParent();
+    else
+      cast<Function>(Replaced[i])->eraseFromParent();
+
+  // Variables stay with their own module; special variables such as
+  // llvm.global_ctors must not be appended to Dest at all.
+  for (Module::global_iterator I = SrcM->global_begin(),
+       E = SrcM->global_end(); I != E;) {
+    GlobalVariable *GV = I++;
+    if (isSpecialName(GV->getName())) {
+      GV->eraseFromParent();
+      continue;
+    }
+    if (GV->hasInitializer() && !GV->hasAvailableExternallyLinkage()) {
+      GV->setInitializer(0);
+      GV->setLinkage(GlobalValue::ExternalLinkage);
+      GV->setVisibility(GlobalValue::DefaultVisibility);
+    }
+  }
+
+  // Drop the declarations that only the discarded bodies used, in particular
+  // those of local symbols, which the imported functions never use.
+  for (Module::global_iterator I = SrcM->global_begin(),
+       E = SrcM->global_end(); I != E;) {
+    GlobalVariable *GV = I++;
+    if (GV->use_empty())
+      GV->eraseFromParent();
+  }
+  for (Module::iterator I = SrcM->begin(), E = SrcM->end(); I != E;) {
+    Function *F = I++;
+    if (F->isDeclaration() && F->use_empty())
+      F->eraseFromParent();
+  }
+
+  SrcM->setModuleInlineAsm("");
+  std::vector<NamedMDNode*> NamedMDs;
+  for (Module::named_metadata_iterator I = SrcM->named_metadata_begin(),
+       E = SrcM->named_metadata_end(); I != E; ++I)
+    if (I->getName() != "llvm.module.flags")
+      NamedMDs.push_back(I);
+  for (unsigned i = 0, e = NamedMDs.size(); i != e; ++i)
+    NamedMDs[i]->eraseFromParent();
+
+  return !Linker::LinkModules(&Dest, SrcM.get(), Linker::DestroySource,
+                              &ErrMsg);
+}
+
+/// collectUsedGlobals - Add the members of llvm.used and llvm.compiler.used
+/// to Used; they must keep their names.
+static void collectUsedGlobals(Module &M, StringRef Name,
+                               SmallPtrSet<GlobalValue*, 8> &Used) {
+  GlobalVariable *GV = M.getGlobalVariable(Name, true);
+  if (!GV || !GV->hasInitializer())
+    return;
+  const ConstantArray *Inits = dyn_cast<ConstantArray>(GV->getInitializer());
+  if (!Inits)
+    return;
+  for (unsigned i = 0, e = Inits->getNumOperands(); i != e; ++i)
+    if (GlobalValue *G =
+          dyn_cast<GlobalValue>(Inits->getOperand(i)->stripPointerCasts()))
+      Used.insert(G);
+}
+
+/// internalizeModule - Give local linkage to every definition in M that no
+/// other module refers to and that the linker was not asked to preserve.
+static void internalizeModule(Module &M, const ThinLTOJob &Job,
+                              const TargetMachine &TM) {
+  SmallPtrSet<GlobalValue*, 8> Used;
+  collectUsedGlobals(M, "llvm.used", Used);
+  collectUsedGlobals(M, "llvm.compiler.used", Used);
+
+  Mangler Mang(TM.getDataLayout());
+  std::vector<GlobalValue*> Candidates;
+  for (Module::iterator I = M.begin(), E = M.end(); I != E; ++I)
+    Candidates.push_back(I);
+  for (Module::global_iterator I = M.global_begin(), E = M.global_end();
+       I != E; ++I)
+    Candidates.push_back(I);
+  for (Module::alias_iterator I = M.alias_begin(), E = M.alias_end(); I != E;
+       ++I)
+    Candidates.push_back(I);
+
+  for (unsigned i = 0, e = Candidates.size(); i != e; ++i) {
+    GlobalValue *GV = Candidates[i];
+    if (GV->isDeclaration() || GV->hasLocalLinkage() ||
+        GV->hasAvailableExternallyLinkage() || isSpecialName(GV->getName()) ||
+        Used.count(GV) || Job.ExternallyReferenced->count(GV->getName()))
+      continue;
+    SmallString<64> Buffer;
+    Mang.getNameWithPrefix(Buffer, GV);
+    if (Job.MustPreserveSymbols->count(Buffer))
+      continue;
+    GV->setLinkage(GlobalValue::InternalLinkage);
+    GV->setVisibility(GlobalValue::DefaultVisibility);
+  }
+}
+
+/// runThinLTOJob - Import into, optimize and compile one module.
+static void runThinLTOJob(void *Arg) {
+  ThinLTOJob &Job = *static_cast<ThinLTOJob*>(Arg);
+  const ThinLTOCodeGenerator::ModuleSummary &Summary =
+    (*Job.Modules)[Job.ModuleIdx];
+
+  if (!Job.CacheKey.empty() &&
+      LTOObjectCache(Job.CacheDir).lookup(Job.CacheKey, Job.OutputPath))
+    return;
+
+  LLVMContext Context;
+  OwningPtr<MemoryBuffer> Buffer(
+    MemoryBuffer::getMemBuffer(Summary.Bitcode, Summary.Identifier, false));
+  OwningPtr<Module> M(ParseBitcodeFile(Buffer.get(), Context, &Job.ErrMsg));
+  if (!M)
+    return;
+
+  std::string TripleStr = M->getTargetTriple();
+  if (TripleStr.empty())
+    TripleStr = sys::getDefaultTargetTriple();
+  const Target *TheTarget = TargetRegistry::lookupTarget(TripleStr,
+                                                         Job.ErrMsg);
+  if (!TheTarget)
+    return;
+  OwningPtr<TargetMachine> TM(
+    TheTarget->createTargetMachine(TripleStr, Job.CPU, "", Job.Options,
+                                   Job.RelocModel, CodeModel::Default,
+                                   CodeGenOpt::Aggressive));
+
+  for (unsigned i = 0, e = Job.Imports.size(); i != e; ++i) {
+    if (Job.Imports[i].empty())
+      continue;
+    if (!importFunctions(*M, (*Job.Modules)[i], Job.Imports[i], Job.ErrMsg))
+      return;
+  }
+
+  if (!Summary.HasInlineAsm)
+    internalizeModule(*M, Job, *TM);
+
+  if (!Job.DisableOpt) {
+    PassManager Passes;
+    Passes.add(new DataLayout(*TM->getDataLayout()));
+    Passes.add(new TargetLibraryInfo(Triple(TripleStr)));
+    TM->addAnalysisPasses(Passes);
+
+    PassManagerBuilder PMB;
+    PMB.OptLevel = 2;
+    PMB.Inliner = createFunctionInliningPass();
+    PMB.populateModulePassManager(Passes);
+    // The imported bodies have served their purpose.
+    Passes.add(createGlobalDCEPass());
+    Passes.run(*M);
+  }
+
+  int FD;
+  SmallString<128> Filename;
+  if (error_code EC = sys::fs::createTemporaryFile("lto-llvm", "o", FD,
+                                                   Filename)) {
+    Job.ErrMsg = EC.message();
+    return;
+  }
+  tool_output_file ObjFile(Filename.c_str(), FD);
+
+  PassManager CodeGenPasses;
+  CodeGenPasses.add(new DataLayout(*TM->getDataLayout()));
+  TM->addAnalysisPasses(CodeGenPasses);
+  CodeGenPasses.add(createObjCARCContractPass());
+
+  {
+    formatted_raw_ostream Out(ObjFile.os());
+    if (TM->addPassesToEmitFile(CodeGenPasses, Out,
+                                TargetMachine::CGFT_ObjectFile)) {
+      Job.ErrMsg = "target file type not supported";
+      return;
+    }
+    CodeGenPasses.run(*M);
+  }
+
+  ObjFile.os().close();
+  if (ObjFile.os().has_error()) {
+    ObjFile.os().clear_error();
+    Job.ErrMsg = "could not write " + Filename.str().str();
+    return;
+  }
+  ObjFile.keep();
+  Job.OutputPath = Filename.str();
+
+  if (!Job.CacheKey.empty())
+    LTOObjectCache(Job.CacheDir).store(Job.CacheKey, Job.OutputPath);
+}
+
+/// getCacheKey - Hash everything that determines the object for Job: its
+/// module, the modules it imports from and what it imports, which of its
+/// definitions must stay visible, and the code generation options.
+static std::string getCacheKey(const ThinLTOJob &Job,
+                               const StringMap<char> &MustPreserveSymbols) {
+  const std::vector<ThinLTOCodeGenerator::ModuleSummary> &Modules =
+    *Job.Modules;
+  const ThinLTOCodeGenerator::ModuleSummary &Summary = Modules[Job.ModuleIdx];
+
+  // Separate the fields with a NUL so that moving characters between them
+  // changes the key.
+  MD5 Hash;
+  Hash.update(Summary.Bitcode);
+  Hash.update(StringRef("\0", 1));
+  for (unsigned i = 0, e = Job.Imports.size(); i != e; ++i) {
+    if (Job.Imports[i].empty())
+      continue;
+    Hash.update(Modules[i].Bitcode);
+    Hash.update(StringRef("\0", 1));
+    std::vector<std::string> Names(Job.Imports[i]);
+    std::sort(Names.begin(), Names.end());
+    for (unsigned j = 0, je = Names.size(); j != je; ++j) {
+      Hash.update(Names[j]);
+      Hash.update(StringRef("\0", 1));
+    }
+  }
+
+  std::string Config;
+  raw_string_ostream OS(Config);
+  OS << '\0';
+  for (unsigned i = 0, e = Summary.Defined.size(); i != e; ++i)
+    OS << (Job.ExternallyReferenced->count(Summary.Defined[i]) ? '1' : '0');
+  OS << '\0';
+  std::vector<StringRef> Preserved;
+  for (StringMap<char>::const_iterator I = MustPreserveSymbols.begin(),
+       E = MustPreserveSymbols.end(); I != E; ++I)
+    Preserved.push_back(I->getKey());
+  std::sort(Preserved.begin(), Preserved.end());
+  for (unsigned i = 0, e = Preserved.size(); i != e; ++i)
+    OS << Preserved[i] << '\0';
+  OS << '\0' << Job.CPU << '\0' << unsigned(Job.RelocModel) << Job.DisableOpt;
+  Hash.update(OS.str());
+
+  LTOObjectCache::addTargetOptions(Hash, Job.Options);
+  return LTOObjectCache::getKey(Hash);
+}
+
+bool ThinLTOCodeGenerator::compile_to_files(const char ***Names,
+                                            unsigned *Count,
+                                            bool DisableOpt,
+                                            std::string &errMsg) {
+  if (Modules.empty()) {
+    errMsg = "no modules to compile";
+    return false;
+  }
+
+  Reloc::Model RelocModel = Reloc::Default;
+  switch (CodeModel) {
+  case LTO_CODEGEN_PIC_MODEL_STATIC:
+    RelocModel = Reloc::Static;
+    break;
+  case LTO_CODEGEN_PIC_MODEL_DYNAMIC:
+    RelocModel = Reloc::PIC_;
+    break;
+  case LTO_CODEGEN_PIC_MODEL_DYNAMIC_NO_PIC:
+    RelocModel = Reloc::DynamicNoPIC;
+    break;
+  }
+
+  // A definition must stay visible if any module declares it, including the
+  // declarations that imported bodies bring with them.
+  StringSet<> ExternallyReferenced;
+  std::vector<ThinLTOJob> Jobs(Modules.size());
+  for (unsigned i = 0, e = Modules.size(); i != e; ++i) {
+    for (unsigned j = 0, je = Modules[i].Referenced.size(); j != je; ++j)
+      ExternallyReferenced.insert(Modules[i].Referenced[j]);
+
+    StringMap<unsigned> Imports;
+    computeImports(i, Imports, ExternallyReferenced);
+
+    ThinLTOJob &Job = Jobs[i];
+    Job.Modules = &Modules;
+    Job.ModuleIdx = i;
+    Job.Imports.resize(Modules.size());
+    for (StringMap<unsigned>::const_iterator I = Imports.begin(),
+         IE = Imports.end(); I != IE; ++I)
+      Job.Imports[I->getValue()].push_back(I->getKey());
+    Job.ExternallyReferenced = &ExternallyReferenced;
+    Job.MustPreserveSymbols = &MustPreserveSymbols;
+    Job.Options = Options;
+    Job.RelocModel = RelocModel;
+    Job.CPU = MCpu;
+    Job.DisableOpt = DisableOpt;
+  }
+
+  // The keys depend on ExternallyReferenced, which is only complete now.
+  if (!CacheDir.empty())
+    for (unsigned i = 0, e = Jobs.size(); i != e; ++i) {
+      Jobs[i].CacheDir = CacheDir;
+      Jobs[i].CacheKey = getCacheKey(Jobs[i], MustPreserveSymbols);
+    }
+
+  if (Jobs.size() > 1 &&
+      (llvm_is_multithreaded() || llvm_start_multithreaded())) {
+    TaskGroup Group;
+    for (unsigned i = 0, e = Jobs.size(); i != e; ++i)
+      Group.async(runThinLTOJob, &Jobs[i]);
+    Group.wait();
+  } else {
+    for (unsigned i = 0, e = Jobs.size(); i != e; ++i)
+      runThinLTOJob(&Jobs[i]);
+  }
+
+  for (unsigned i = 0, e = Jobs.size(); i != e; ++i) {
+    if (Jobs[i].ErrMsg.empty())
+      continue;
+    errMsg = Modules[i].Identifier + ": " + Jobs[i].ErrMsg;
+    for (unsigned j = 0; j != e; ++j)
+      if (!Jobs[j].OutputPath.empty())
+        sys::fs::remove(Jobs[j].OutputPath);
+    return false;
+  }
+
+  NativeObjectPaths.clear();
+  NativeObjectNames.clear();
+  for (unsigned i = 0, e = Jobs.size(); i != e; ++i)
+    NativeObjectPaths.push_back(Jobs[i].OutputPath);
+  for (unsigned i = 0, e = Jobs.size(); i != e; ++i)
+    NativeObjectNames.push_back(NativeObjectPaths[i].c_str());
+  *Names = &NativeObjectNames[0];
+  *Count = NativeObjectNames.size();
+  return true;
+}
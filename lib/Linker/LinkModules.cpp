@@ -11,11 +11,14 @@
 //
 //===----------------------------------------------------------------------===//
 
+#define DEBUG_TYPE "link-modules"
 #include "llvm/Linker.h"
 #include "llvm-c/Linker.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/Optional.h"
 #include "llvm/ADT/SetVector.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/IR/Constants.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/TypeFinder.h"
@@ -25,12 +28,18 @@
 #include <cctype>
 using namespace llvm;
 
+STATISTIC(NumStructTypesMerged,
+          "Number of source struct types merged into an existing type");
+STATISTIC(NumStructTypesCreated,
+          "Number of struct types created in the destination module");
+
 //===----------------------------------------------------------------------===//
 // TypeMap implementation.
 //===----------------------------------------------------------------------===//
 
 namespace {
   typedef SmallPtrSet<StructType*, 32> TypeSet;
+  typedef DenseMap<unsigned, SmallVector<StructType*, 1> > TypeShapeMap;
 
 class TypeMapTy : public ValueMapTypeRemapper {
   /// MappedTypes - This is a mapping from a source type to a destination type
@@ -51,8 +60,19 @@ class TypeMapTy : public ValueMapTypeRemapper {
   /// destination modules who are getting a body from the source module.
   SmallPtrSet<StructType*, 16> DstResolvedOpaqueTypes;
 
+  /// DstStructTypesByShape - The destination structs with a body, indexed by
+  /// getStructShape.
+  TypeShapeMap &DstStructTypesByShape;
+
+  /// MatchingStructure - Set while looking for a destination struct that is
+  /// structurally identical to a source struct.  Opaque types then only match
+  /// themselves, so that a failed candidate leaves no mapping behind.
+  bool MatchingStructure;
+
 public:
-  TypeMapTy(TypeSet &Set) : DstStructTypesSet(Set) {}
+  TypeMapTy(TypeSet &Set, TypeShapeMap &Shapes)
+    : DstStructTypesByShape(Shapes), MatchingStructure(false),
+      DstStructTypesSet(Set) {}
 
   TypeSet &DstStructTypesSet;
   /// addTypeMapping - Indicate that the specified type in the destination
@@ -90,9 +110,87 @@ private:
   }
   
   bool areTypesIsomorphic(Type *DstTy, Type *SrcTy);
+  StructType *findIsomorphicStruct(StructType *SrcSTy);
 };
 }
 
+/// getTypeShape - Hash everything about Ty that areTypesIsomorphic compares,
+/// except for structs: an opaque struct can be mapped onto any other.
+static hash_code getTypeShape(Type *Ty) {
+  if (isa<StructType>(Ty))
+    return hash_value(unsigned(Type::StructTyID));
+
+  hash_code Shape = hash_combine(unsigned(Ty->getTypeID()),
+                                 Ty->getNumContainedTypes());
+  if (IntegerType *ITy = dyn_cast<IntegerType>(Ty))
+    Shape = hash_combine(Shape, ITy->getBitWidth());
+  else if (PointerType *PTy = dyn_cast<PointerType>(Ty))
+    Shape = hash_combine(Shape, PTy->getAddressSpace());
+  else if (FunctionType *FTy = dyn_cast<FunctionType>(Ty))
+    Shape = hash_combine(Shape, FTy->isVarArg());
+  else if (SequentialType *STy = dyn_cast<SequentialType>(Ty))
+    if (!isa<PointerType>(STy))
+      Shape = hash_combine(Shape, isa<ArrayType>(STy) ?
+                           cast<ArrayType>(STy)->getNumElements() :
+                           cast<VectorType>(STy)->getNumElements());
+
+  for (unsigned i = 0, e = Ty->getNumContainedTypes(); i != e; ++i)
+    Shape = hash_combine(Shape, getTypeShape(Ty->getContainedType(i)));
+  return Shape;
+}
+
+/// getStructShape - Hash the body of STy so that two struct types can only be
+/// isomorphic if their shapes are equal.
+static unsigned getStructShape(StructType *STy) {
+  hash_code Shape = hash_combine(STy->isPacked(), STy->getNumElements());
+  for (unsigned i = 0, e = STy->getNumElements(); i != e; ++i)
+    Shape = hash_combine(Shape, getTypeShape(STy->getElementType(i)));
+  // Keep clear of the DenseMap empty and tombstone keys.
+  return unsigned(size_t(Shape)) >> 1;
+}
+
+/// getStructNamePrefix - Return the name of STy without the ".N" suffix that
+/// the LLVMContext adds to keep the names of identified structs unique.
+static StringRef getStructNamePrefix(StructType *STy) {
+  StringRef Name = STy->getName();
+  size_t DotPos = Name.rfind('.');
+  if (DotPos == 0 || DotPos == StringRef::npos || Name.back() == '.' ||
+      !isdigit(static_cast<unsigned char>(Name[DotPos+1])))
+    return Name;
+  return Name.substr(0, DotPos);
+}
+
+/// findIsomorphicStruct - Find a struct with a body in the destination module
+/// that SrcSTy can be mapped onto without creating a new type, and map it.
+/// Only structs that have the same name as SrcSTy, once the ".N" suffixes are
+/// stripped, are considered: structurally identical types with different names
+/// are different types to the front end.
+StructType *TypeMapTy::findIsomorphicStruct(StructType *SrcSTy) {
+  if (!SrcSTy->hasName())
+    return 0;
+  TypeShapeMap::iterator I =
+    DstStructTypesByShape.find(getStructShape(SrcSTy));
+  if (I == DstStructTypesByShape.end())
+    return 0;
+
+  StringRef SrcPrefix = getStructNamePrefix(SrcSTy);
+  MatchingStructure = true;
+  StructType *Found = 0;
+  for (unsigned i = 0, e = I->second.size(); i != e && !Found; ++i) {
+    StructType *DstSTy = I->second[i];
+    if (!DstSTy->hasName() || getStructNamePrefix(DstSTy) != SrcPrefix)
+      continue;
+    if (areTypesIsomorphic(DstSTy, SrcSTy))
+      Found = DstSTy;
+    else
+      for (unsigned j = 0, je = SpeculativeTypes.size(); j != je; ++j)
+        MappedTypes.erase(SpeculativeTypes[j]);
+    SpeculativeTypes.clear();
+  }
+  MatchingStructure = false;
+  return Found;
+}
+
 void TypeMapTy::addTypeMapping(Type *DstTy, Type *SrcTy) {
   Type *&Entry = MappedTypes[SrcTy];
   if (Entry) return;
@@ -135,6 +233,10 @@ bool TypeMapTy::areTypesIsomorphic(Type *DstTy, Type *SrcTy) {
 
   // If this is an opaque struct type, special case it.
   if (StructType *SSTy = dyn_cast<StructType>(SrcTy)) {
+    if (MatchingStructure &&
+        (SSTy->isOpaque() || cast<StructType>(DstTy)->isOpaque()))
+      return false;
+
     // Mapping an opaque type to any struct, just keep the dest struct.
     if (SSTy->isOpaque()) {
       Entry = DstTy;
@@ -222,6 +324,7 @@ void TypeMapTy::linkDefinedTypeBodies() {
       Elements[i] = getImpl(SrcSTy->getElementType(i));
     
     DstSTy->setBody(Elements, SrcSTy->isPacked());
+    DstStructTypesByShape[getStructShape(DstSTy)].push_back(DstSTy);
     
     // If DstSTy has no name or has a longer name than STy, then viciously steal
     // STy's name.
@@ -328,6 +431,12 @@ Type *TypeMapTy::getImpl(Type *Ty) {
   // safe would we map the entire thing over.  Because this is an optimization,
   // and is not required for the prettiness of the linked module, we just skip
   // it and always rebuild a type here.
+  //
+  // What we do look for is a struct in the destination module with the same
+  // structure and the same name, up to the ".N" suffix.  When many modules
+  // that each define their own copy of a type are linked together, reusing it
+  // keeps the destination from collecting a copy per module, which every
+  // later link would have to search through.
   StructType *STy = cast<StructType>(Ty);
   
   // If the type is opaque, we can just use it directly.
@@ -338,8 +447,15 @@ Type *TypeMapTy::getImpl(Type *Ty) {
     return *Entry = STy;
   }
   
+  if (StructType *DTy = findIsomorphicStruct(STy)) {
+    ++NumStructTypesMerged;
+    return DTy;
+  }
+
   // Otherwise we create a new type and resolve its body later.  This will be
   // resolved by the top level of get().
+  ++NumStructTypesCreated;
+  Entry = &MappedTypes[Ty];
   SrcDefinitionsToResolve.push_back(STy);
   StructType *DTy = StructType::create(STy->getContext());
   // A new identified structure type was created. Add it to the set of
@@ -406,8 +522,9 @@ namespace {
   public:
     std::string ErrorMsg;
     
-    ModuleLinker(Module *dstM, TypeSet &Set, Module *srcM, unsigned mode)
-      : DstM(dstM), SrcM(srcM), TypeMap(Set),
+    ModuleLinker(Module *dstM, TypeSet &Set, TypeShapeMap &Shapes,
+                 Module *srcM, unsigned mode)
+      : DstM(dstM), SrcM(srcM), TypeMap(Set, Shapes),
         ValMaterializer(TypeMap, DstM, LazilyLinkFunctions),
         Mode(mode) { }
     
@@ -642,14 +759,12 @@ void ModuleLinker::computeTypeMapping() {
     if (!ST->hasName()) continue;
     
     // Check to see if there is a dot in the name followed by a digit.
-    size_t DotPos = ST->getName().rfind('.');
-    if (DotPos == 0 || DotPos == StringRef::npos ||
-        ST->getName().back() == '.' ||
-        !isdigit(static_cast<unsigned char>(ST->getName()[DotPos+1])))
+    StringRef Prefix = getStructNamePrefix(ST);
+    if (Prefix.size() == ST->getName().size())
       continue;
     
     // Check to see if the destination module has a struct with the prefix name.
-    if (StructType *DST = DstM->getTypeByName(ST->getName().substr(0, DotPos)))
+    if (StructType *DST = DstM->getTypeByName(Prefix))
       // Don't use it if this actually came from the source module. They're in
       // the same LLVMContext after all. Also don't use it unless the type is
       // actually used in the destination module. This can happen in situations
@@ -1347,6 +1462,10 @@ Linker::Linker(Module *M) : Composite(M) {
   TypeFinder StructTypes;
   StructTypes.run(*M, true);
   IdentifiedStructTypes.insert(StructTypes.begin(), StructTypes.end());
+  for (TypeFinder::iterator I = StructTypes.begin(), E = StructTypes.end();
+       I != E; ++I)
+    if (!(*I)->isOpaque())
+      StructTypesByShape[getStructShape(*I)].push_back(*I);
 }
 
 Linker::~Linker() {
@@ -1358,7 +1477,8 @@ void Linker::deleteModule() {
 }
 
 bool Linker::linkInModule(Module *Src, unsigned Mode, std::string *ErrorMsg) {
-  ModuleLinker TheLinker(Composite, IdentifiedStructTypes, Src, Mode);
+  ModuleLinker TheLinker(Composite, IdentifiedStructTypes, StructTypesByShape,
+                         Src, Mode);
   if (TheLinker.run()) {
     if (ErrorMsg)
       *ErrorMsg = TheLinker.ErrorMsg;
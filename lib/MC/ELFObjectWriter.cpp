@@ -19,6 +19,7 @@
 #include "llvm/ADT/StringMap.h"
 #include "llvm/MC/MCAsmBackend.h"
 #include "llvm/MC/MCAsmLayout.h"
+#include "llvm/MC/MCAsmInfo.h"
 #include "llvm/MC/MCAssembler.h"
 #include "llvm/MC/MCContext.h"
 #include "llvm/MC/MCELF.h"
@@ -28,9 +29,12 @@
 #include "llvm/MC/MCObjectWriter.h"
 #include "llvm/MC/MCSectionELF.h"
 #include "llvm/MC/MCValue.h"
+#include "llvm/Support/Compression.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/ELF.h"
+#include "llvm/Support/Endian.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include <vector>
 using namespace llvm;
 
@@ -89,6 +93,12 @@ class ELFObjectWriter : public MCObjectWriter {
                    std::vector<ELFRelocationEntry> > Relocations;
     DenseMap<const MCSection*, uint64_t> SectionStringTableIndex;
 
+    /// CompressedFragments - The fragments of the debug sections that were
+    /// replaced by their compressed contents.  The relocations recorded for
+    /// those sections point at the fixups of these fragments, so they are
+    /// kept until the object has been written.
+    iplist<MCFragment> CompressedFragments;
+
     /// @}
     /// @name Symbol Table Data
     /// @{
@@ -282,6 +292,10 @@ class ELFObjectWriter : public MCObjectWriter {
                          SectionIndexMapTy &SectionIndexMap,
                          const RelMapTy &RelMap);
 
+    /// CompressDebugSections - Replace the contents of each .debug_* section
+    /// by its zlib compressed form and rename it to .zdebug_*.
+    void CompressDebugSections(MCAssembler &Asm, MCAsmLayout &Layout);
+
     void CreateRelocationSections(MCAssembler &Asm, MCAsmLayout &Layout,
                                   RelMapTy &RelMap);
 
@@ -583,6 +597,17 @@ void ELFObjectWriter::WriteSymbolTable(MCDataFragment *SymtabF,
 
   // FIXME: Make sure the start of the symbol table is aligned.
 
+  // Size the tables up front; section symbols are bounded by the number of
+  // sections. Growing them entry by entry would copy the table repeatedly.
+  size_t NumEntries = 1 + FileSymbolData.size() + LocalSymbolData.size() +
+                      Asm.size() + ExternalSymbolData.size() +
+                      UndefinedSymbolData.size();
+  SymtabF->getContents().reserve(NumEntries * (is64Bit() ?
+                                               ELF::SYMENTRY_SIZE64 :
+                                               ELF::SYMENTRY_SIZE32));
+  if (ShndxF)
+    ShndxF->getContents().reserve(NumEntries * 4);
+
   // The first entry is the undefined symbol entry.
   WriteSymbolEntry(SymtabF, ShndxF, 0, 0, 0, 0, 0, 0, false);
 
@@ -1002,6 +1027,105 @@ void ELFObjectWriter::ComputeSymbolTable(MCAssembler &Asm,
     NeedsSymtabShndx = true;
 }
 
+/// getUncompressedData - Concatenate the contents of the fragments in \p SD
+/// into \p Data. Return false if the section holds a fragment, such as an
+/// alignment, whose contents are only produced when the section is written.
+static bool getUncompressedData(const MCSectionData &SD,
+                                SmallVectorImpl<char> &Data) {
+  for (MCSectionData::const_iterator I = SD.begin(), E = SD.end(); I != E;
+       ++I) {
+    const SmallVectorImpl<char> *Contents;
+    switch (I->getKind()) {
+    case MCFragment::FT_Data:
+      Contents = &cast<MCDataFragment>(I)->getContents();
+      break;
+    case MCFragment::FT_Dwarf:
+      Contents = &cast<MCDwarfLineAddrFragment>(I)->getContents();
+      break;
+    case MCFragment::FT_DwarfFrame:
+      Contents = &cast<MCDwarfCallFrameFragment>(I)->getContents();
+      break;
+    default:
+      return false;
+    }
+    Data.append(Contents->begin(), Contents->end());
+  }
+  return true;
+}
+
+void ELFObjectWriter::CompressDebugSections(MCAssembler &Asm,
+                                            MCAsmLayout &Layout) {
+  MCContext &Ctx = Asm.getContext();
+  if (!Ctx.getAsmInfo()->compressDebugSections())
+    return;
+
+  // Symbols defined in each section, along with their uncompressed offsets.
+  // Relocations and symbol values keep referring to the uncompressed
+  // contents, which is what a consumer sees after decompressing: the
+  // relocation offsets were computed when they were recorded.
+  DenseMap<const MCSectionData*,
+           std::vector<std::pair<MCSymbolData*, uint64_t> > > DefinedSymbols;
+  for (MCAssembler::symbol_iterator I = Asm.symbol_begin(),
+         E = Asm.symbol_end(); I != E; ++I)
+    if (MCFragment *F = I->getFragment())
+      DefinedSymbols[F->getParent()].push_back(
+        std::make_pair(&*I, Layout.getSymbolOffset(&*I)));
+
+  for (MCAssembler::iterator it = Asm.begin(), ie = Asm.end(); it != ie;
+       ++it) {
+    MCSectionData &SD = *it;
+    const MCSectionELF &Section =
+      static_cast<const MCSectionELF&>(SD.getSection());
+    StringRef SectionName = Section.getSectionName();
+    if (!SectionName.startswith(".debug_") || Section.getGroup())
+      continue;
+
+    SmallVector<char, 128> UncompressedData;
+    if (!getUncompressedData(SD, UncompressedData))
+      continue;
+
+    OwningPtr<MemoryBuffer> CompressedBuffer;
+    if (zlib::compress(StringRef(UncompressedData.data(),
+                                 UncompressedData.size()),
+                       CompressedBuffer) != zlib::StatusOK)
+      continue;
+
+    // The compressed contents are preceded by "ZLIB" and the uncompressed
+    // size as a 64-bit big-endian integer. Keep the section as it is if
+    // that does not make it smaller.
+    const size_t HeaderSize = 12;
+    if (CompressedBuffer->getBufferSize() + HeaderSize >=
+        UncompressedData.size())
+      continue;
+
+    Layout.invalidateFragmentsFrom(&*SD.begin());
+    CompressedFragments.splice(CompressedFragments.end(),
+                               SD.getFragmentList());
+    MCDataFragment *F = new MCDataFragment(&SD);
+    F->setLayoutOrder(0);
+
+    SmallVectorImpl<char> &Contents = F->getContents();
+    Contents.reserve(HeaderSize + CompressedBuffer->getBufferSize());
+    const char Magic[] = "ZLIB";
+    Contents.append(Magic, Magic + 4);
+    char Size[8];
+    support::endian::write<uint64_t, support::big, support::unaligned>(
+      Size, UncompressedData.size());
+    Contents.append(Size, Size + 8);
+    Contents.append(CompressedBuffer->getBufferStart(),
+                    CompressedBuffer->getBufferEnd());
+
+    std::vector<std::pair<MCSymbolData*, uint64_t> > &Symbols =
+      DefinedSymbols[&SD];
+    for (unsigned i = 0, e = Symbols.size(); i != e; ++i) {
+      Symbols[i].first->setFragment(F);
+      Symbols[i].first->setOffset(Symbols[i].second);
+    }
+
+    Ctx.renameELFSection(&Section, (".z" + SectionName.drop_front(1)).str());
+  }
+}
+
 void ELFObjectWriter::CreateRelocationSections(MCAssembler &Asm,
                                                MCAsmLayout &Layout,
                                                RelMapTy &RelMap) {
@@ -1088,6 +1212,13 @@ void ELFObjectWriter::WriteRelocationsFragment(const MCAssembler &Asm,
   // (e.g., MIPS) have additional constraints.
   TargetObjectWriter->sortRelocs(Asm, Relocs);
 
+  unsigned EntrySize;
+  if (hasRelocationAddend())
+    EntrySize = is64Bit() ? sizeof(ELF::Elf64_Rela) : sizeof(ELF::Elf32_Rela);
+  else
+    EntrySize = is64Bit() ? sizeof(ELF::Elf64_Rel) : sizeof(ELF::Elf32_Rel);
+  F->getContents().reserve(Relocs.size() * EntrySize);
+
   for (unsigned i = 0, e = Relocs.size(); i != e; ++i) {
     ELFRelocationEntry entry = Relocs[e - i - 1];
 
@@ -1125,6 +1256,10 @@ void ELFObjectWriter::WriteRelocationsFragment(const MCAssembler &Asm,
         String32(*F, entry.r_addend);
     }
   }
+
+  // The encoded copy is all that is needed from here on; free the entries
+  // so that both copies are not alive for every section at once.
+  std::vector<ELFRelocationEntry>().swap(Relocs);
 }
 
 static int compareBySuffix(const MCSectionELF *const *a,
@@ -1197,8 +1332,15 @@ void ELFObjectWriter::CreateMetadataSections(MCAssembler &Asm,
   }
   WriteSymbolTable(F, ShndxF, Asm, Layout, SectionIndexMap);
 
+  // The symbol table is encoded; the per-symbol data is no longer needed.
+  std::vector<uint64_t>().swap(FileSymbolData);
+  std::vector<ELFSymbolData>().swap(LocalSymbolData);
+  std::vector<ELFSymbolData>().swap(ExternalSymbolData);
+  std::vector<ELFSymbolData>().swap(UndefinedSymbolData);
+
   F = new MCDataFragment(&StrtabSD);
   F->getContents().append(StringTable.begin(), StringTable.end());
+  SmallString<256>().swap(StringTable);
 
   F = new MCDataFragment(&ShstrtabSD);
 
@@ -1519,6 +1661,8 @@ void ELFObjectWriter::WriteObject(MCAssembler &Asm,
 
   unsigned NumUserSections = Asm.size();
 
+  CompressDebugSections(Asm, const_cast<MCAsmLayout&>(Layout));
+
   DenseMap<const MCSectionELF*, const MCSectionELF*> RelMap;
   CreateRelocationSections(Asm, const_cast<MCAsmLayout&>(Layout), RelMap);
 
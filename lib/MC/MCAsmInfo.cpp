@@ -85,6 +85,7 @@ MCAsmInfo::MCAsmInfo() {
   ExceptionsType = ExceptionHandling::None;
   DwarfUsesRelocationsAcrossSections = true;
   DwarfRegNumForCFI = false;
+  CompressDebugSections = false;
   NeedsDwarfSectionOffsetDirective = false;
   UseParensForSymbolVariant = false;
 }
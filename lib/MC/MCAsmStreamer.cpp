@@ -1271,11 +1271,11 @@ void MCAsmStreamer::AddEncodingComment(const MCInst &Inst) {
 
     if (MapEntry != uint8_t(~0U)) {
       if (MapEntry == 0) {
-        OS << format("0x%02x", uint8_t(Code[i]));
+        OS << format_hex(uint8_t(Code[i]), 4);
       } else {
         if (Code[i]) {
           // FIXME: Some of the 8 bits require fix up.
-          OS << format("0x%02x", uint8_t(Code[i])) << '\''
+          OS << format_hex(uint8_t(Code[i]), 4) << '\''
              << char('A' + MapEntry - 1) << '\'';
         } else
           OS << char('A' + MapEntry - 1);
@@ -51,6 +51,10 @@ STATISTIC(FragmentLayouts, "Number of fragment layouts");
 STATISTIC(ObjectBytes, "Number of emitted object file bytes");
 STATISTIC(RelaxationSteps, "Number of assembler layout and relaxation steps");
 STATISTIC(RelaxedInstructions, "Number of relaxed instructions");
+STATISTIC(SectionRelaxationRounds,
+          "Number of section layout rounds that relaxed a fragment");
+STATISTIC(RelaxationCandidateVisits,
+          "Number of fragments revisited during relaxation");
 }
 }
 
@@ -737,11 +741,14 @@ void MCAssembler::writeSectionData(const MCSectionData *SD,
 
 uint64_t MCAssembler::handleFixup(const MCAsmLayout &Layout,
                                   MCFragment &F,
-                                  const MCFixup &Fixup) {
+                                  const MCFixup &Fixup,
+                                  bool &Recorded) {
    // Evaluate the fixup.
    MCValue Target;
    uint64_t FixedValue;
+   Recorded = false;
    if (!evaluateFixup(Layout, Fixup, &F, Target, FixedValue)) {
+     Recorded = true;
      // The fixup was unresolved, we need a relocation. Inform the object
      // writer of the relocation, and give it an opportunity to adjust the
      // fixup value if need be.
@@ -750,6 +757,37 @@ uint64_t MCAssembler::handleFixup(const MCAsmLayout &Layout,
    return FixedValue;
  }
 
+// Once layout is final, evaluating a fixup only reads the layout and the
+// symbol table, and applying it only writes to its own fragment, so the
+// sections are independent of each other. The exception is the object
+// writer: RecordRelocation appends to per-writer tables and symbol sets, and
+// the order of the relocations it records ends up in the object file. Running
+// sections concurrently would first need the writer to buffer relocations
+// per section and merge them in section order.
+void MCAssembler::applySectionFixups(const MCAsmLayout &Layout,
+                                     MCSectionData &SD) {
+  for (MCSectionData::iterator it = SD.begin(), ie = SD.end(); it != ie;
+       ++it) {
+    MCEncodedFragmentWithFixups *F = dyn_cast<MCEncodedFragmentWithFixups>(it);
+    if (!F)
+      continue;
+    bool AnyRecorded = false;
+    for (MCEncodedFragmentWithFixups::fixup_iterator it2 = F->fixup_begin(),
+         ie2 = F->fixup_end(); it2 != ie2; ++it2) {
+      MCFixup &Fixup = *it2;
+      bool Recorded;
+      uint64_t FixedValue = handleFixup(Layout, *F, Fixup, Recorded);
+      AnyRecorded |= Recorded;
+      getBackend().applyFixup(Fixup, F->getContents().data(),
+                              F->getContents().size(), FixedValue);
+    }
+    // Resolved fixups are now part of the contents and nothing refers to
+    // them, so their storage can go before the object is written.
+    if (!AnyRecorded)
+      F->releaseFixups();
+  }
+}
+
 void MCAssembler::Finish() {
   DEBUG_WITH_TYPE("mc-dump", {
       llvm::errs() << "assembler backend - pre-layout\n--\n";
@@ -769,19 +807,25 @@ void MCAssembler::Finish() {
     it->setOrdinal(SectionIndex++);
   }
 
-  // Assign layout order indices to sections and fragments.
+  // Assign layout order indices to sections and fragments, and collect the
+  // fragments that may change size during relaxation. Everything else has a
+  // fixed size, so there is no need to look at it again.
+  std::vector<RelaxWorklist> Worklists(Layout.getSectionOrder().size());
   for (unsigned i = 0, e = Layout.getSectionOrder().size(); i != e; ++i) {
     MCSectionData *SD = Layout.getSectionOrder()[i];
     SD->setLayoutOrder(i);
 
     unsigned FragmentIndex = 0;
     for (MCSectionData::iterator iFrag = SD->begin(), iFragEnd = SD->end();
-         iFrag != iFragEnd; ++iFrag)
+         iFrag != iFragEnd; ++iFrag) {
       iFrag->setLayoutOrder(FragmentIndex++);
+      if (isRelaxationCandidate(*iFrag))
+        Worklists[i].push_back(iFrag);
+    }
   }
 
   // Layout until everything fits.
-  while (layoutOnce(Layout))
+  while (layoutOnce(Layout, Worklists))
     continue;
 
   DEBUG_WITH_TYPE("mc-dump", {
@@ -802,22 +846,8 @@ void MCAssembler::Finish() {
   getWriter().ExecutePostLayoutBinding(*this, Layout);
 
   // Evaluate and apply the fixups, generating relocation entries as necessary.
-  for (MCAssembler::iterator it = begin(), ie = end(); it != ie; ++it) {
-    for (MCSectionData::iterator it2 = it->begin(),
-           ie2 = it->end(); it2 != ie2; ++it2) {
-      MCEncodedFragmentWithFixups *F =
-        dyn_cast<MCEncodedFragmentWithFixups>(it2);
-      if (F) {
-        for (MCEncodedFragmentWithFixups::fixup_iterator it3 = F->fixup_begin(),
-             ie3 = F->fixup_end(); it3 != ie3; ++it3) {
-          MCFixup &Fixup = *it3;
-          uint64_t FixedValue = handleFixup(Layout, *F, Fixup);
-          getBackend().applyFixup(Fixup, F->getContents().data(),
-                                  F->getContents().size(), FixedValue);
-        }
-      }
-    }
-  }
+  for (MCAssembler::iterator it = begin(), ie = end(); it != ie; ++it)
+    applySectionFixups(Layout, *it);
 
   // Write the object file.
   getWriter().WriteObject(*this, Layout);
@@ -937,15 +967,35 @@ bool MCAssembler::relaxDwarfCallFrameFragment(MCAsmLayout &Layout,
   return OldSize != Data.size();
 }
 
-bool MCAssembler::layoutSectionOnce(MCAsmLayout &Layout, MCSectionData &SD) {
+bool MCAssembler::isRelaxationCandidate(const MCFragment &F) const {
+  switch (F.getKind()) {
+  default:
+    return false;
+  case MCFragment::FT_Relaxable:
+    return getBackend().mayNeedRelaxation(
+             cast<MCRelaxableFragment>(F).getInst());
+  case MCFragment::FT_Dwarf:
+  case MCFragment::FT_DwarfFrame:
+  case MCFragment::FT_LEB:
+    return true;
+  }
+}
+
+bool MCAssembler::layoutSectionOnce(MCAsmLayout &Layout, MCSectionData &SD,
+                                    RelaxWorklist &Worklist) {
   // Holds the first fragment which needed relaxing during this layout. It will
   // remain NULL if none were relaxed.
   // When a fragment is relaxed, all the fragments following it should get
   // invalidated because their offset is going to change.
   MCFragment *FirstRelaxedFragment = NULL;
 
-  // Attempt to relax all the fragments in the section.
-  for (MCSectionData::iterator I = SD.begin(), IE = SD.end(); I != IE; ++I) {
+  // Attempt to relax the candidate fragments in the section. A fragment's
+  // fixups may refer to any offset in the section, so every candidate is
+  // rechecked, but the fixed-size fragments in between are skipped.
+  unsigned NumKept = 0;
+  for (unsigned i = 0, e = Worklist.size(); i != e; ++i) {
+    MCFragment *I = Worklist[i];
+    ++stats::RelaxationCandidateVisits;
     // Check if this is a fragment that needs relaxation.
     bool RelaxedFrag = false;
     switch(I->getKind()) {
@@ -971,7 +1021,11 @@ bool MCAssembler::layoutSectionOnce(MCAsmLayout &Layout, MCSectionData &SD) {
     }
     if (RelaxedFrag && !FirstRelaxedFragment)
       FirstRelaxedFragment = I;
+    // An instruction relaxed to its final form cannot grow any further.
+    if (!RelaxedFrag || isRelaxationCandidate(*I))
+      Worklist[NumKept++] = I;
   }
+  Worklist.resize(NumKept);
   if (FirstRelaxedFragment) {
     Layout.invalidateFragmentsFrom(FirstRelaxedFragment);
     return true;
@@ -979,14 +1033,24 @@ bool MCAssembler::layoutSectionOnce(MCAsmLayout &Layout, MCSectionData &SD) {
   return false;
 }
 
-bool MCAssembler::layoutOnce(MCAsmLayout &Layout) {
+bool MCAssembler::layoutOnce(MCAsmLayout &Layout,
+                             std::vector<RelaxWorklist> &Worklists) {
   ++stats::RelaxationSteps;
 
   bool WasRelaxed = false;
   for (iterator it = begin(), ie = end(); it != ie; ++it) {
     MCSectionData &SD = *it;
-    while (layoutSectionOnce(Layout, SD))
-      WasRelaxed = true;
+    RelaxWorklist &Worklist = Worklists[SD.getLayoutOrder()];
+    unsigned Rounds = 0;
+    while (layoutSectionOnce(Layout, SD, Worklist))
+      ++Rounds;
+    if (!Rounds)
+      continue;
+    WasRelaxed = true;
+    stats::SectionRelaxationRounds += Rounds;
+    DEBUG(dbgs() << "Relaxed section " << SD.getOrdinal() << " in " << Rounds
+                 << " rounds, " << Worklist.size()
+                 << " candidate fragments left\n");
   }
 
   return WasRelaxed;
@@ -44,7 +44,8 @@ MCContext::MCContext(const MCAsmInfo *mai, const MCRegisterInfo *mri,
   NextUniqueID(0),
   CurrentDwarfLoc(0,0,0,DWARF2_FLAG_IS_STMT,0,0),
   DwarfLocSeen(false), GenDwarfForAssembly(false), GenDwarfFileNumber(0),
-  AllowTemporaryLabels(true), DwarfCompileUnitID(0), AutoReset(DoAutoReset) {
+  AllowTemporaryLabels(true), UseNamesForTempLabels(true),
+  DwarfCompileUnitID(0), AutoReset(DoAutoReset) {
 
   error_code EC = llvm::sys::fs::current_path(CompilationDir);
   if (EC)
@@ -161,6 +162,11 @@ MCSymbol *MCContext::GetOrCreateSymbol(const Twine &Name) {
 }
 
 MCSymbol *MCContext::CreateTempSymbol() {
+  // An unnamed temporary is never looked up or printed, so it needs neither
+  // a name nor an entry in UsedNames.
+  if (!UseNamesForTempLabels && AllowTemporaryLabels)
+    return new (*this) MCSymbol(StringRef(), true);
+
   SmallString<128> NameSV;
   raw_svector_ostream(NameSV)
     << MAI->getPrivateGlobalPrefix() << "tmp" << NextUniqueID++;
@@ -271,6 +277,24 @@ getELFSection(StringRef Section, unsigned Type, unsigned Flags,
   return Result;
 }
 
+void MCContext::renameELFSection(const MCSectionELF *Section, StringRef Name) {
+  assert(ELFUniquingMap && "Renaming a section that was never created");
+  ELFUniqueMapTy &Map = *(ELFUniqueMapTy*)ELFUniquingMap;
+
+  StringRef GroupName;
+  if (const MCSymbol *Group = Section->getGroup())
+    GroupName = Group->getName();
+
+  ELFUniqueMapTy::iterator I =
+    Map.find(SectionGroupPair(Section->getSectionName(), GroupName));
+  assert(I != Map.end() && I->second == Section && "Section is not uniqued");
+  Map.erase(I);
+
+  ELFUniqueMapTy::iterator Entry = Map.insert(
+      std::make_pair(SectionGroupPair(Name, GroupName), Section)).first;
+  const_cast<MCSectionELF*>(Section)->setSectionName(Entry->first.first);
+}
+
 const MCSectionELF *MCContext::CreateELFGroupSection() {
   MCSectionELF *Result =
     new (*this) MCSectionELF(".group", ELF::SHT_GROUP, 0,
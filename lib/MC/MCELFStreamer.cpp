@@ -434,6 +434,19 @@ void MCELFStreamer::EmitInstToFragment(const MCInst &Inst) {
 
 void MCELFStreamer::EmitInstToData(const MCInst &Inst) {
   MCAssembler &Assembler = getAssembler();
+
+  // Without bundling, the instruction always goes at the end of the current
+  // data fragment, so encode it there directly.
+  if (!Assembler.isBundlingEnabled()) {
+    MCDataFragment *DF = getOrCreateDataFragment();
+    unsigned FirstFixup = DF->getFixups().size();
+    EncodeInstToFragment(Inst, DF);
+    for (unsigned i = FirstFixup, e = DF->getFixups().size(); i != e; ++i)
+      fixSymbolsInTLSFixups(DF->getFixups()[i].getValue());
+    DF->setHasInstructions(true);
+    return;
+  }
+
   SmallVector<MCFixup, 4> Fixups;
   SmallString<256> Code;
   raw_svector_ostream VecOS(Code);
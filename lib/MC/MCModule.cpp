@@ -103,6 +103,11 @@ MCFunction *MCModule::createFunction(StringRef Name) {
   return Functions.back();
 }
 
+void MCModule::trackFunctionEntry(MCFunction *MCFN, uint64_t EntryAddr) {
+  // Keep the first function seen at an address.
+  FunctionsByEntry.insert(std::make_pair(EntryAddr, MCFN));
+}
+
 static bool CompBBToAtom(MCBasicBlock *BB, const MCTextAtom *Atom) {
   return BB->getInsts() < Atom;
 }
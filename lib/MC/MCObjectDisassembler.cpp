@@ -481,15 +481,8 @@ MCObjectDisassembler::createFunction(MCModule *Module, uint64_t BeginAddr,
     return Module->createFunction(ExtFnName);
 
   // If it's not, look for an existing function.
-  for (MCModule::func_iterator FI = Module->func_begin(),
-                               FE = Module->func_end();
-       FI != FE; ++FI) {
-    if ((*FI)->empty())
-      continue;
-    // FIXME: MCModule should provide a findFunctionByAddr()
-    if ((*FI)->getEntryBlock()->getInsts()->getBeginAddr() == BeginAddr)
-      return *FI;
-  }
+  if (MCFunction *MCFN = Module->findFunctionAt(BeginAddr))
+    return MCFN;
 
   // Finally, just create a new one.
   MCFunction *MCFN = Module->createFunction("");
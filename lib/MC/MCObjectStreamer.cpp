@@ -74,6 +74,21 @@ MCDataFragment *MCObjectStreamer::getOrCreateDataFragment() const {
   return F;
 }
 
+void MCObjectStreamer::EncodeInstToFragment(const MCInst &Inst,
+                                            MCDataFragment *DF) {
+  SmallVectorImpl<char> &Contents = DF->getContents();
+  SmallVectorImpl<MCFixup> &Fixups = DF->getFixups();
+  uint64_t Offset = Contents.size();
+  unsigned FirstFixup = Fixups.size();
+  {
+    raw_svector_ostream VecOS(Contents);
+    Assembler->getEmitter().EncodeInstruction(Inst, VecOS, Fixups);
+  }
+  // The emitter gives fixup offsets relative to the start of the instruction.
+  for (unsigned i = FirstFixup, e = Fixups.size(); i != e; ++i)
+    Fixups[i].setOffset(Fixups[i].getOffset() + Offset);
+}
+
 const MCExpr *MCObjectStreamer::AddValueSymbols(const MCExpr *Value) {
   switch (Value->getKind()) {
   case MCExpr::Target:
@@ -274,6 +289,47 @@ void MCObjectStreamer::EmitDwarfLocDirective(unsigned FileNo, unsigned Line,
                                           Isa, Discriminator, FileName);
 }
 
+/// Compute Label - LastLabel if both are in the same section and every
+/// fragment between them already has its final size. DWARF line and frame
+/// advances between such labels can then be encoded directly instead of
+/// through a fragment that takes part in relaxation.
+static bool evaluateFixedDistance(MCAssembler &Asm, const MCSymbol *LastLabel,
+                                  const MCSymbol *Label, int64_t &Res) {
+  // Bundle padding is only known after layout.
+  if (Asm.isBundlingEnabled())
+    return false;
+  if (!LastLabel->isInSection() || !Label->isInSection() ||
+      &LastLabel->getSection() != &Label->getSection())
+    return false;
+
+  const MCSymbolData &FromSD = Asm.getSymbolData(*LastLabel);
+  const MCSymbolData &ToSD = Asm.getSymbolData(*Label);
+  const MCFragment *From = FromSD.getFragment();
+  const MCFragment *To = ToSD.getFragment();
+  if (!From || !To || From->getParent() != To->getParent())
+    return false;
+
+  MCContext &Ctx = Asm.getContext();
+  if (!Asm.getWriter().IsSymbolRefDifferenceFullyResolved(
+         Asm, MCSymbolRefExpr::Create(Label, Ctx),
+         MCSymbolRefExpr::Create(LastLabel, Ctx), false))
+    return false;
+
+  int64_t Distance = -(int64_t)FromSD.getOffset();
+  MCSectionData::const_iterator I = From, E = From->getParent()->end();
+  for (; I != E && &*I != To; ++I) {
+    const MCEncodedFragment *EF = dyn_cast<MCEncodedFragment>(&*I);
+    // Only data and instructions that can't be relaxed have a fixed size.
+    if (!EF || isa<MCRelaxableFragment>(EF))
+      return false;
+    Distance += EF->getContents().size();
+  }
+  if (I == E)
+    return false;
+  Res = Distance + ToSD.getOffset();
+  return true;
+}
+
 void MCObjectStreamer::EmitDwarfAdvanceLineAddr(int64_t LineDelta,
                                                 const MCSymbol *LastLabel,
                                                 const MCSymbol *Label,
@@ -284,7 +340,8 @@ void MCObjectStreamer::EmitDwarfAdvanceLineAddr(int64_t LineDelta,
   }
   const MCExpr *AddrDelta = BuildSymbolDiff(getContext(), Label, LastLabel);
   int64_t Res;
-  if (AddrDelta->EvaluateAsAbsolute(Res, getAssembler())) {
+  if (AddrDelta->EvaluateAsAbsolute(Res, getAssembler()) ||
+      evaluateFixedDistance(getAssembler(), LastLabel, Label, Res)) {
     MCDwarfLineAddr::Emit(this, LineDelta, Res);
     return;
   }
@@ -296,7 +353,8 @@ void MCObjectStreamer::EmitDwarfAdvanceFrameAddr(const MCSymbol *LastLabel,
                                                  const MCSymbol *Label) {
   const MCExpr *AddrDelta = BuildSymbolDiff(getContext(), Label, LastLabel);
   int64_t Res;
-  if (AddrDelta->EvaluateAsAbsolute(Res, getAssembler())) {
+  if (AddrDelta->EvaluateAsAbsolute(Res, getAssembler()) ||
+      evaluateFixedDistance(getAssembler(), LastLabel, Label, Res)) {
     MCDwarfFrameEmitter::EmitAdvanceLoc(*this, Res);
     return;
   }
@@ -1210,12 +1210,15 @@ bool AsmParser::parseStatement(ParseStatementInfo &Info) {
 
   // Handle conditional assembly here before checking for skipping.  We
   // have to do this so that .endif isn't skipped in a ".if 0" block for
-  // example.
-  StringMap<DirectiveKind>::const_iterator DirKindIt =
-      DirectiveKindMap.find(IDVal);
-  DirectiveKind DirKind = (DirKindIt == DirectiveKindMap.end())
-                              ? DK_NO_DIRECTIVE
-                              : DirKindIt->getValue();
+  // example.  Every directive starts with '.', so instructions, which make
+  // up most of compiler-generated assembly, don't need the table lookup.
+  DirectiveKind DirKind = DK_NO_DIRECTIVE;
+  if (IDVal.startswith(".")) {
+    StringMap<DirectiveKind>::const_iterator DirKindIt =
+        DirectiveKindMap.find(IDVal);
+    if (DirKindIt != DirectiveKindMap.end())
+      DirKind = DirKindIt->getValue();
+  }
   switch (DirKind) {
   default:
     break;
@@ -3787,6 +3790,7 @@ bool AsmParser::parseDirectiveEndIf(SMLoc DirectiveLoc) {
 }
 
 void AsmParser::initializeDirectiveKindMap() {
+  // All keys must start with '.'; parseStatement relies on it.
   DirectiveKindMap[".set"] = DK_SET;
   DirectiveKindMap[".equ"] = DK_EQU;
   DirectiveKindMap[".equiv"] = DK_EQUIV;
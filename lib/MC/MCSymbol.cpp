@@ -69,6 +69,11 @@ void MCSymbol::print(raw_ostream &OS) const {
   // some targets support quoting names with funny characters.  If the name
   // contains a funny character, then print it quoted.
   StringRef Name = getName();
+  if (Name.empty()) {
+    // Unnamed temporary, see MCContext::CreateTempSymbol.
+    OS << "<temp " << (const void *)this << '>';
+    return;
+  }
   if (!NameNeedsQuoting(Name)) {
     OS << Name;
     return;
@@ -194,7 +194,8 @@ error_code Archive::Child::getAsBinary(OwningPtr<Binary> &Result) const {
 }
 
 Archive::Archive(MemoryBuffer *source, error_code &ec)
-  : Binary(Binary::ID_Archive, source), SymbolTable(end_children()) {
+  : Binary(Binary::ID_Archive, source), SymbolTable(end_children()),
+    SymbolMapBuilt(false), SymbolMapValid(false) {
   // Check for sufficient magic.
   assert(source);
   if (source->getBufferSize() < 8 ||
@@ -427,7 +428,38 @@ Archive::symbol_iterator Archive::end_symbols() const {
     Symbol(this, symbol_count, 0));
 }
 
+bool Archive::buildSymbolMap() const {
+  StringRef SymName;
+  for (symbol_iterator I = begin_symbols(), E = end_symbols(); I != E; ++I) {
+    if (I->getName(SymName))
+      return false;
+    // The first definition wins, as it does for a linear scan.
+    if (SymbolMap.count(SymName))
+      continue;
+    child_iterator Member;
+    if (I->getMember(Member))
+      Member = end_children();
+    SymbolMap.GetOrCreateValue(SymName, Member);
+  }
+  return true;
+}
+
 Archive::child_iterator Archive::findSym(StringRef name) const {
+  // Archives of large libraries have many thousands of symbols and are
+  // searched once per undefined symbol, so index the table on first use.
+  if (!SymbolMapBuilt) {
+    SymbolMapBuilt = true;
+    SymbolMapValid = buildSymbolMap();
+    if (!SymbolMapValid)
+      SymbolMap.clear();
+  }
+  if (SymbolMapValid) {
+    StringMap<child_iterator>::const_iterator I = SymbolMap.find(name);
+    if (I == SymbolMap.end())
+      return end_children();
+    return I->getValue();
+  }
+
   Archive::symbol_iterator bs = begin_symbols();
   Archive::symbol_iterator es = end_symbols();
   Archive::child_iterator result;
@@ -0,0 +1,126 @@
+//===- StackMapParser.cpp - Parse the stack map section -------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the StackMapParser class.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Object/StackMapParser.h"
+#include "llvm/Object/Error.h"
+#include "llvm/Object/ObjectFile.h"
+#include "llvm/Support/DataExtractor.h"
+using namespace llvm;
+using namespace object;
+
+/// parseRecord - Read the record at Offset into R, advancing Offset past it.
+/// Return false if the record does not fit in the section or is malformed.
+static bool parseRecord(const DataExtractor &DE, StringRef Data,
+                        uint32_t &Offset, uint32_t NumConstants,
+                        StackMapParser::Record &R) {
+  typedef StackMapParser::Location Location;
+  const uint64_t Size = Data.size();
+
+  if (Size - Offset < 16)
+    return false;
+  R.ID = DE.getU64(&Offset);
+  R.InstructionOffset = DE.getU32(&Offset);
+  R.Flags = DE.getU16(&Offset);
+  uint16_t NumLocations = DE.getU16(&Offset);
+
+  if (Size - Offset < uint64_t(NumLocations) * 8 + 2)
+    return false;
+  R.Locations.resize(NumLocations);
+  for (uint16_t i = 0; i != NumLocations; ++i) {
+    Location &L = R.Locations[i];
+    uint8_t Kind = DE.getU8(&Offset);
+    L.Size = DE.getU8(&Offset);
+    L.DwarfRegNum = DE.getU16(&Offset);
+    L.Offset = int32_t(DE.getU32(&Offset));
+    if (Kind < Location::Register || Kind > Location::ConstantIndex)
+      return false;
+    if (Kind == Location::ConstantIndex && uint32_t(L.Offset) >= NumConstants)
+      return false;
+    L.Kind = Location::LocationKind(Kind);
+  }
+
+  uint16_t NumLiveOuts = DE.getU16(&Offset);
+  if (Size - Offset < uint64_t(NumLiveOuts) * 4)
+    return false;
+  R.LiveOuts.resize(NumLiveOuts);
+  for (uint16_t i = 0; i != NumLiveOuts; ++i) {
+    StackMapParser::LiveOut &LO = R.LiveOuts[i];
+    LO.DwarfRegNum = DE.getU16(&Offset);
+    DE.getU8(&Offset); // Reserved.
+    LO.Size = DE.getU8(&Offset);
+  }
+  return true;
+}
+
+error_code StackMapParser::parse(StringRef Data, bool IsLittleEndian) {
+  Constants.clear();
+  Records.clear();
+
+  DataExtractor DE(Data, IsLittleEndian, 8);
+  const uint64_t Size = Data.size();
+  uint32_t Offset = 0;
+
+  // The header is followed by the constant count.
+  if (Size < 8)
+    return object_error::parse_failed;
+  DE.getU32(&Offset);
+  uint32_t NumConstants = DE.getU32(&Offset);
+  if (Size - Offset < uint64_t(NumConstants) * 8 + 4)
+    return object_error::parse_failed;
+  Constants.reserve(NumConstants);
+  for (uint32_t i = 0; i != NumConstants; ++i)
+    Constants.push_back(int64_t(DE.getU64(&Offset)));
+
+  // Every record takes at least 18 bytes, so a larger count is malformed and
+  // must not be used to size the record table.
+  uint32_t NumRecords = DE.getU32(&Offset);
+  bool Valid = (Size - Offset) / 18 >= NumRecords;
+  if (Valid)
+    Records.resize(NumRecords);
+  for (uint32_t i = 0; Valid && i != NumRecords; ++i)
+    Valid = parseRecord(DE, Data, Offset, NumConstants, Records[i]);
+
+  if (!Valid) {
+    Constants.clear();
+    Records.clear();
+    return object_error::parse_failed;
+  }
+  return error_code::success();
+}
+
+error_code StackMapParser::findStackMapSection(const ObjectFile &Obj,
+                                               StringRef &Data) {
+  Data = StringRef();
+  error_code EC;
+  for (section_iterator I = Obj.begin_sections(), E = Obj.end_sections();
+       I != E; I.increment(EC)) {
+    if (EC)
+      return EC;
+    StringRef Name;
+    if ((EC = I->getName(Name)))
+      return EC;
+    // The ELF and the Mach-O section names.
+    if (Name == ".llvm_stackmaps" || Name == "__llvm_stackmaps")
+      return I->getContents(Data);
+  }
+  return EC;
+}
+
+const StackMapParser::Record *StackMapParser::findRecord(uint64_t ID) const {
+  for (std::vector<Record>::const_iterator I = Records.begin(),
+                                           E = Records.end();
+       I != E; ++I)
+    if (I->ID == ID)
+      return &*I;
+  return 0;
+}
@@ -323,8 +323,11 @@ unsigned InputArgList::MakeIndex(StringRef String0) const {
   unsigned Index = ArgStrings.size();
 
   // Tuck away so we have a reliable const char *.
-  SynthesizedStrings.push_back(String0);
-  ArgStrings.push_back(SynthesizedStrings.back().c_str());
+  char *Str = static_cast<char*>(
+    SynthesizedStrings.Allocate(String0.size() + 1, 1));
+  memcpy(Str, String0.data(), String0.size());
+  Str[String0.size()] = '\0';
+  ArgStrings.push_back(Str);
 
   return Index;
 }
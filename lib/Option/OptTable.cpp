@@ -8,6 +8,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/Option/OptTable.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/Option/Arg.h"
 #include "llvm/Option/ArgList.h"
 #include "llvm/Option/Option.h"
@@ -23,6 +24,7 @@ using namespace llvm::opt;
 namespace llvm {
 namespace opt {
 
+#ifndef NDEBUG
 // Ordering on Info. The ordering is *almost* case-insensitive lexicographic,
 // with an exceptions. '\0' comes at the end of the alphabet instead of the
 // beginning (thus options precede any other options which prefix them).
@@ -46,7 +48,6 @@ static int StrCmpOptionNameIgnoreCase(const char *A, const char *B) {
   return (a < b) ? -1 : 1;
 }
 
-#ifndef NDEBUG
 static int StrCmpOptionName(const char *A, const char *B) {
   if (int N = StrCmpOptionNameIgnoreCase(A, B))
     return N;
@@ -74,11 +75,6 @@ static inline bool operator<(const OptTable::Info &A, const OptTable::Info &B) {
   return B.Kind == Option::JoinedClass;
 }
 #endif
-
-// Support lower_bound between info and an option name.
-static inline bool operator<(const OptTable::Info &I, const char *Name) {
-  return StrCmpOptionNameIgnoreCase(I.Name, Name) < 0;
-}
 }
 }
 
@@ -152,6 +148,33 @@ OptTable::OptTable(const Info *_OptionInfos, unsigned _NumOptionInfos,
             == PrefixChars.end())
         PrefixChars.push_back(*C);
   }
+
+  // Build the name trie. Options whose names only differ in case are adjacent
+  // in the table, so each node covers a single range.
+  NameTrieNode Root = { 0, 0, 0, 0, 0 };
+  NameTrie.push_back(Root);
+  for (unsigned i = FirstSearchableIndex, e = getNumOptions(); i != e; ++i) {
+    unsigned Node = 0;
+    for (const char *C = OptionInfos[i].Name; *C; ++C) {
+      char Lower = tolower(*C);
+      unsigned *Link = &NameTrie[Node].FirstChild;
+      while (*Link && NameTrie[*Link].Char != Lower)
+        Link = &NameTrie[*Link].NextSibling;
+      if (*Link) {
+        Node = *Link;
+        continue;
+      }
+      NameTrieNode Child = { Lower, 0, 0, 0, 0 };
+      Node = *Link = NameTrie.size();
+      NameTrie.push_back(Child);
+    }
+    NameTrieNode &N = NameTrie[Node];
+    if (N.OptBegin == N.OptEnd)
+      N.OptBegin = i;
+    else
+      assert(N.OptEnd == i && "Options with the same name are not adjacent!");
+    N.OptEnd = i + 1;
+  }
 }
 
 OptTable::~OptTable() {
@@ -203,44 +226,51 @@ Arg *OptTable::ParseOneArg(const ArgList &Args, unsigned &Index,
   if (isInput(PrefixesUnion, Str))
     return new Arg(getOption(TheInputOptionID), Str, Index++, Str);
 
-  const Info *Start = OptionInfos + FirstSearchableIndex;
-  const Info *End = OptionInfos + getNumOptions();
   StringRef Name = StringRef(Str).ltrim(PrefixChars);
 
-  // Search for the first next option which could be a prefix.
-  Start = std::lower_bound(Start, End, Name.data());
-
-  // Options are stored in sorted order, with '\0' at the end of the
-  // alphabet. Since the only options which can accept a string must
-  // prefix it, we iteratively search for the next option which could
-  // be a prefix.
-  //
-  // FIXME: This is searching much more than necessary, but I am
-  // blanking on the simplest way to make it fast. We can solve this
-  // problem when we move to TableGen.
-  for (; Start != End; ++Start) {
-    unsigned ArgSize = 0;
-    // Scan for first option which is a proper prefix.
-    for (; Start != End; ++Start)
-      if ((ArgSize = matchOption(Start, Str, IgnoreCase)))
-        break;
-    if (Start == End)
+  // Walk the name trie to find the options whose name is a prefix of the
+  // argument. Options with an empty name, such as a bare "--", are on the
+  // root.
+  SmallVector<unsigned, 8> Candidates;
+  if (NameTrie[0].OptBegin != NameTrie[0].OptEnd)
+    Candidates.push_back(0);
+  for (unsigned i = 0, e = Name.size(), Node = 0; i != e; ++i) {
+    char Lower = tolower(Name[i]);
+    for (Node = NameTrie[Node].FirstChild;
+         Node && NameTrie[Node].Char != Lower;
+         Node = NameTrie[Node].NextSibling)
+      ;
+    if (!Node)
       break;
+    if (NameTrie[Node].OptBegin != NameTrie[Node].OptEnd)
+      Candidates.push_back(Node);
+  }
 
-    Option Opt(Start, this);
-
-    if (FlagsToInclude && !Opt.hasFlag(FlagsToInclude))
-      continue;
-    if (Opt.hasFlag(FlagsToExclude))
-      continue;
-
-    // See if this option matches.
-    if (Arg *A = Opt.accept(Args, Index, ArgSize))
-      return A;
-
-    // Otherwise, see if this argument was missing values.
-    if (Prev != Index)
-      return 0;
+  // Try the longest names first, and options with the same name in table
+  // order, which is the order the table is sorted in.
+  while (!Candidates.empty()) {
+    const NameTrieNode &N = NameTrie[Candidates.pop_back_val()];
+    for (const Info *I = OptionInfos + N.OptBegin,
+                    *E = OptionInfos + N.OptEnd; I != E; ++I) {
+      unsigned ArgSize = matchOption(I, Str, IgnoreCase);
+      if (!ArgSize)
+        continue;
+
+      Option Opt(I, this);
+
+      if (FlagsToInclude && !Opt.hasFlag(FlagsToInclude))
+        continue;
+      if (Opt.hasFlag(FlagsToExclude))
+        continue;
+
+      // See if this option matches.
+      if (Arg *A = Opt.accept(Args, Index, ArgSize))
+        return A;
+
+      // Otherwise, see if this argument was missing values.
+      if (Prev != Index)
+        return 0;
+    }
   }
 
   // If we failed to find an option and this arg started with /, then it's
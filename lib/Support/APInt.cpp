@@ -28,15 +28,6 @@
 #include <limits>
 using namespace llvm;
 
-/// A utility function for allocating memory, checking for allocation failures,
-/// and ensuring the contents are zeroed.
-inline static uint64_t* getClearedMemory(unsigned numWords) {
-  uint64_t * result = new uint64_t[numWords];
-  assert(result && "APInt memory allocation fails!");
-  memset(result, 0, numWords * sizeof(uint64_t));
-  return result;
-}
-
 /// A utility function for allocating memory and checking for allocation
 /// failure.  The content is not zeroed.
 inline static uint64_t* getMemory(unsigned numWords) {
@@ -74,7 +65,8 @@ inline static unsigned getDigit(char cdigit, uint8_t radix) {
 
 
 void APInt::initSlowCase(unsigned numBits, uint64_t val, bool isSigned) {
-  pVal = getClearedMemory(getNumWords());
+  allocateWords();
+  clearAllBits();
   pVal[0] = val;
   if (isSigned && int64_t(val) < 0)
     for (unsigned i = 1; i < getNumWords(); ++i)
@@ -82,7 +74,7 @@ void APInt::initSlowCase(unsigned numBits, uint64_t val, bool isSigned) {
 }
 
 void APInt::initSlowCase(const APInt& that) {
-  pVal = getMemory(getNumWords());
+  allocateWords();
   memcpy(pVal, that.pVal, getNumWords() * APINT_WORD_SIZE);
 }
 
@@ -93,7 +85,8 @@ void APInt::initFromArray(ArrayRef<uint64_t> bigVal) {
     VAL = bigVal[0];
   else {
     // Get memory, cleared to 0
-    pVal = getClearedMemory(getNumWords());
+    allocateWords();
+    clearAllBits();
     // Calculate the number of words to copy
     unsigned words = std::min<unsigned>(bigVal.size(), getNumWords());
     // Copy the words from bigVal to pVal
@@ -131,23 +124,21 @@ APInt& APInt::AssignSlowCase(const APInt& RHS) {
     return *this;
   }
 
-  if (isSingleWord()) {
-    // assume case where both are single words is already handled
-    assert(!RHS.isSingleWord());
-    VAL = 0;
-    pVal = getMemory(RHS.getNumWords());
-    memcpy(pVal, RHS.pVal, RHS.getNumWords() * APINT_WORD_SIZE);
-  } else if (getNumWords() == RHS.getNumWords())
+  if (!isSingleWord() && getNumWords() == RHS.getNumWords()) {
     memcpy(pVal, RHS.pVal, RHS.getNumWords() * APINT_WORD_SIZE);
-  else if (RHS.isSingleWord()) {
+    BitWidth = RHS.BitWidth;
+    return clearUnusedBits();
+  }
+
+  if (needsCleanup())
     delete [] pVal;
+  BitWidth = RHS.BitWidth;
+  if (isSingleWord())
     VAL = RHS.VAL;
-  } else {
-    delete [] pVal;
-    pVal = getMemory(RHS.getNumWords());
+  else {
+    allocateWords();
     memcpy(pVal, RHS.pVal, RHS.getNumWords() * APINT_WORD_SIZE);
   }
-  BitWidth = RHS.BitWidth;
   return clearUnusedBits();
 }
 
@@ -193,11 +184,8 @@ static bool add_1(uint64_t dest[], uint64_t x[], unsigned len, uint64_t y) {
 }
 
 /// @brief Prefix increment operator. Increments the APInt by one.
-APInt& APInt::operator++() {
-  if (isSingleWord())
-    ++VAL;
-  else
-    add_1(pVal, pVal, getNumWords(), 1);
+APInt& APInt::IncrementSlowCase() {
+  add_1(pVal, pVal, getNumWords(), 1);
   return clearUnusedBits();
 }
 
@@ -222,11 +210,8 @@ static bool sub_1(uint64_t x[], unsigned len, uint64_t y) {
 }
 
 /// @brief Prefix decrement operator. Decrements the APInt by one.
-APInt& APInt::operator--() {
-  if (isSingleWord())
-    --VAL;
-  else
-    sub_1(pVal, getNumWords(), 1);
+APInt& APInt::DecrementSlowCase() {
+  sub_1(pVal, getNumWords(), 1);
   return clearUnusedBits();
 }
 
@@ -248,13 +233,8 @@ static bool add(uint64_t *dest, const uint64_t *x, const uint64_t *y,
 /// Adds the RHS APint to this APInt.
 /// @returns this, after addition of RHS.
 /// @brief Addition assignment operator.
-APInt& APInt::operator+=(const APInt& RHS) {
-  assert(BitWidth == RHS.BitWidth && "Bit widths must be the same");
-  if (isSingleWord())
-    VAL += RHS.VAL;
-  else {
-    add(pVal, pVal, RHS.pVal, getNumWords());
-  }
+APInt& APInt::AddAssignSlowCase(const APInt& RHS) {
+  add(pVal, pVal, RHS.pVal, getNumWords());
   return clearUnusedBits();
 }
 
@@ -275,12 +255,8 @@ static bool sub(uint64_t *dest, const uint64_t *x, const uint64_t *y,
 /// Subtracts the RHS APInt from this APInt
 /// @returns this, after subtraction
 /// @brief Subtraction assignment operator.
-APInt& APInt::operator-=(const APInt& RHS) {
-  assert(BitWidth == RHS.BitWidth && "Bit widths must be the same");
-  if (isSingleWord())
-    VAL -= RHS.VAL;
-  else
-    sub(pVal, pVal, RHS.pVal, getNumWords());
+APInt& APInt::SubAssignSlowCase(const APInt& RHS) {
+  sub(pVal, pVal, RHS.pVal, getNumWords());
   return clearUnusedBits();
 }
 
@@ -376,9 +352,11 @@ APInt& APInt::operator*=(const APInt& RHS) {
     return *this;
   }
 
-  // Allocate space for the result
+  // Allocate space for the result, on the stack if it is small.
   unsigned destWords = rhsWords + lhsWords;
-  uint64_t *dest = getMemory(destWords);
+  uint64_t Space[2 * NumInlineWords];
+  uint64_t *dest = destWords <= 2 * NumInlineWords ? Space
+                                                   : getMemory(destWords);
 
   // Perform the long multiply
   mul(dest, pVal, lhsWords, RHS.pVal, rhsWords);
@@ -390,7 +368,8 @@ APInt& APInt::operator*=(const APInt& RHS) {
   clearUnusedBits();
 
   // delete dest array and return
-  delete[] dest;
+  if (dest != Space)
+    delete[] dest;
   return *this;
 }
 
@@ -433,55 +412,49 @@ APInt& APInt::operator^=(const APInt& RHS) {
 
 APInt APInt::AndSlowCase(const APInt& RHS) const {
   unsigned numWords = getNumWords();
-  uint64_t* val = getMemory(numWords);
+  APInt Result(BitWidth, Uninitialized);
   for (unsigned i = 0; i < numWords; ++i)
-    val[i] = pVal[i] & RHS.pVal[i];
-  return APInt(val, getBitWidth());
+    Result.pVal[i] = pVal[i] & RHS.pVal[i];
+  return Result;
 }
 
 APInt APInt::OrSlowCase(const APInt& RHS) const {
   unsigned numWords = getNumWords();
-  uint64_t *val = getMemory(numWords);
+  APInt Result(BitWidth, Uninitialized);
   for (unsigned i = 0; i < numWords; ++i)
-    val[i] = pVal[i] | RHS.pVal[i];
-  return APInt(val, getBitWidth());
+    Result.pVal[i] = pVal[i] | RHS.pVal[i];
+  return Result;
 }
 
 APInt APInt::XorSlowCase(const APInt& RHS) const {
   unsigned numWords = getNumWords();
-  uint64_t *val = getMemory(numWords);
+  APInt Result(BitWidth, Uninitialized);
   for (unsigned i = 0; i < numWords; ++i)
-    val[i] = pVal[i] ^ RHS.pVal[i];
+    Result.pVal[i] = pVal[i] ^ RHS.pVal[i];
 
   // 0^0==1 so clear the high bits in case they got set.
-  return APInt(val, getBitWidth()).clearUnusedBits();
+  Result.clearUnusedBits();
+  return Result;
 }
 
-APInt APInt::operator*(const APInt& RHS) const {
-  assert(BitWidth == RHS.BitWidth && "Bit widths must be the same");
-  if (isSingleWord())
-    return APInt(BitWidth, VAL * RHS.VAL);
+APInt APInt::MulSlowCase(const APInt& RHS) const {
   APInt Result(*this);
   Result *= RHS;
   return Result;
 }
 
-APInt APInt::operator+(const APInt& RHS) const {
-  assert(BitWidth == RHS.BitWidth && "Bit widths must be the same");
-  if (isSingleWord())
-    return APInt(BitWidth, VAL + RHS.VAL);
-  APInt Result(BitWidth, 0);
+APInt APInt::AddSlowCase(const APInt& RHS) const {
+  APInt Result(BitWidth, Uninitialized);
   add(Result.pVal, this->pVal, RHS.pVal, getNumWords());
-  return Result.clearUnusedBits();
+  Result.clearUnusedBits();
+  return Result;
 }
 
-APInt APInt::operator-(const APInt& RHS) const {
-  assert(BitWidth == RHS.BitWidth && "Bit widths must be the same");
-  if (isSingleWord())
-    return APInt(BitWidth, VAL - RHS.VAL);
-  APInt Result(BitWidth, 0);
+APInt APInt::SubSlowCase(const APInt& RHS) const {
+  APInt Result(BitWidth, Uninitialized);
   sub(Result.pVal, this->pVal, RHS.pVal, getNumWords());
-  return Result.clearUnusedBits();
+  Result.clearUnusedBits();
+  return Result;
 }
 
 bool APInt::EqualSlowCase(const APInt& RHS) const {
@@ -512,11 +485,7 @@ bool APInt::EqualSlowCase(uint64_t Val) const {
     return false;
 }
 
-bool APInt::ult(const APInt& RHS) const {
-  assert(BitWidth == RHS.BitWidth && "Bit widths must be same for comparison");
-  if (isSingleWord())
-    return VAL < RHS.VAL;
-
+bool APInt::ultSlowCase(const APInt& RHS) const {
   // Get active bit length of both operands
   unsigned n1 = getActiveBits();
   unsigned n2 = RHS.getActiveBits();
@@ -544,14 +513,7 @@ bool APInt::ult(const APInt& RHS) const {
   return false;
 }
 
-bool APInt::slt(const APInt& RHS) const {
-  assert(BitWidth == RHS.BitWidth && "Bit widths must be same for comparison");
-  if (isSingleWord()) {
-    int64_t lhsSext = (int64_t(VAL) << (64-BitWidth)) >> (64-BitWidth);
-    int64_t rhsSext = (int64_t(RHS.VAL) << (64-BitWidth)) >> (64-BitWidth);
-    return lhsSext < rhsSext;
-  }
-
+bool APInt::sltSlowCase(const APInt& RHS) const {
   APInt lhs(*this);
   APInt rhs(RHS);
   bool lhsNeg = isNegative();
@@ -580,22 +542,6 @@ bool APInt::slt(const APInt& RHS) const {
     return lhs.ult(rhs);
 }
 
-void APInt::setBit(unsigned bitPosition) {
-  if (isSingleWord())
-    VAL |= maskBit(bitPosition);
-  else
-    pVal[whichWord(bitPosition)] |= maskBit(bitPosition);
-}
-
-/// Set the given bit to 0 whose position is given as "bitPosition".
-/// @brief Set a given bit to 0.
-void APInt::clearBit(unsigned bitPosition) {
-  if (isSingleWord())
-    VAL &= ~maskBit(bitPosition);
-  else
-    pVal[whichWord(bitPosition)] &= ~maskBit(bitPosition);
-}
-
 /// @brief Toggle every bit to its opposite value.
 
 /// Toggle a given bit to its opposite value whose position is given
@@ -733,9 +679,7 @@ unsigned APInt::countLeadingOnes() const {
   return Count;
 }
 
-unsigned APInt::countTrailingZeros() const {
-  if (isSingleWord())
-    return std::min(unsigned(llvm::countTrailingZeros(VAL)), BitWidth);
+unsigned APInt::countTrailingZerosSlowCase() const {
   unsigned Count = 0;
   unsigned i = 0;
   for (; i < getNumWords() && pVal[i] == 0; ++i)
@@ -923,7 +867,7 @@ APInt APInt::trunc(unsigned width) const {
   if (width <= APINT_BITS_PER_WORD)
     return APInt(width, getRawData()[0]);
 
-  APInt Result(getMemory(getNumWords(width)), width);
+  APInt Result(width, Uninitialized);
 
   // Copy full words.
   unsigned i;
@@ -948,7 +892,7 @@ APInt APInt::sext(unsigned width) const {
     return APInt(width, val >> (APINT_BITS_PER_WORD - width));
   }
 
-  APInt Result(getMemory(getNumWords(width)), width);
+  APInt Result(width, Uninitialized);
 
   // Copy full words.
   unsigned i;
@@ -986,7 +930,7 @@ APInt APInt::zext(unsigned width) const {
   if (width <= APINT_BITS_PER_WORD)
     return APInt(width, VAL);
 
-  APInt Result(getMemory(getNumWords(width)), width);
+  APInt Result(width, Uninitialized);
 
   // Copy words.
   unsigned i;
@@ -1063,7 +1007,8 @@ APInt APInt::ashr(unsigned shiftAmt) const {
   }
 
   // Create some space for the result.
-  uint64_t * val = new uint64_t[getNumWords()];
+  APInt Result(BitWidth, Uninitialized);
+  uint64_t *val = Result.pVal;
 
   // Compute some values needed by the following shift algorithms
   unsigned wordShift = shiftAmt % APINT_BITS_PER_WORD; // bits to shift per word
@@ -1113,7 +1058,8 @@ APInt APInt::ashr(unsigned shiftAmt) const {
   uint64_t fillValue = (isNegative() ? -1ULL : 0);
   for (unsigned i = breakWord+1; i < getNumWords(); ++i)
     val[i] = fillValue;
-  return APInt(val, BitWidth).clearUnusedBits();
+  Result.clearUnusedBits();
+  return Result;
 }
 
 /// Logical right-shift this APInt by shiftAmt.
@@ -1145,12 +1091,14 @@ APInt APInt::lshr(unsigned shiftAmt) const {
     return *this;
 
   // Create some space for the result.
-  uint64_t * val = new uint64_t[getNumWords()];
+  APInt Result(BitWidth, Uninitialized);
+  uint64_t *val = Result.pVal;
 
   // If we are shifting less than a word, compute the shift with a simple carry
   if (shiftAmt < APINT_BITS_PER_WORD) {
     lshrNear(val, pVal, getNumWords(), shiftAmt);
-    return APInt(val, BitWidth).clearUnusedBits();
+    Result.clearUnusedBits();
+    return Result;
   }
 
   // Compute some values needed by the remaining shift algorithms
@@ -1163,7 +1111,8 @@ APInt APInt::lshr(unsigned shiftAmt) const {
       val[i] = pVal[i+offset];
     for (unsigned i = getNumWords()-offset; i < getNumWords(); i++)
       val[i] = 0;
-    return APInt(val,BitWidth).clearUnusedBits();
+    Result.clearUnusedBits();
+    return Result;
   }
 
   // Shift the low order words
@@ -1177,7 +1126,8 @@ APInt APInt::lshr(unsigned shiftAmt) const {
   // Remaining words are 0
   for (unsigned i = breakWord+1; i < getNumWords(); ++i)
     val[i] = 0;
-  return APInt(val, BitWidth).clearUnusedBits();
+  Result.clearUnusedBits();
+  return Result;
 }
 
 /// Left-shift this APInt by shiftAmt.
@@ -1201,7 +1151,8 @@ APInt APInt::shlSlowCase(unsigned shiftAmt) const {
     return *this;
 
   // Create some space for the result.
-  uint64_t * val = new uint64_t[getNumWords()];
+  APInt Result(BitWidth, Uninitialized);
+  uint64_t *val = Result.pVal;
 
   // If we are shifting less than a word, do it the easy way
   if (shiftAmt < APINT_BITS_PER_WORD) {
@@ -1210,7 +1161,8 @@ APInt APInt::shlSlowCase(unsigned shiftAmt) const {
       val[i] = pVal[i] << shiftAmt | carry;
       carry = pVal[i] >> (APINT_BITS_PER_WORD - shiftAmt);
     }
-    return APInt(val, BitWidth).clearUnusedBits();
+    Result.clearUnusedBits();
+    return Result;
   }
 
   // Compute some values needed by the remaining shift algorithms
@@ -1223,7 +1175,8 @@ APInt APInt::shlSlowCase(unsigned shiftAmt) const {
       val[i] = 0;
     for (unsigned i = offset; i < getNumWords(); i++)
       val[i] = pVal[i-offset];
-    return APInt(val,BitWidth).clearUnusedBits();
+    Result.clearUnusedBits();
+    return Result;
   }
 
   // Copy whole words from this to Result.
@@ -1234,7 +1187,8 @@ APInt APInt::shlSlowCase(unsigned shiftAmt) const {
   val[offset] = pVal[0] << wordShift;
   for (i = 0; i < offset; ++i)
     val[i] = 0;
-  return APInt(val, BitWidth).clearUnusedBits();
+  Result.clearUnusedBits();
+  return Result;
 }
 
 APInt APInt::rotl(const APInt &rotateAmt) const {
@@ -1772,15 +1726,13 @@ void APInt::divide(const APInt LHS, unsigned lhsWords,
   if (Quotient) {
     // Set up the Quotient value's memory.
     if (Quotient->BitWidth != LHS.BitWidth) {
-      if (Quotient->isSingleWord())
-        Quotient->VAL = 0;
-      else
+      if (Quotient->needsCleanup())
         delete [] Quotient->pVal;
       Quotient->BitWidth = LHS.BitWidth;
       if (!Quotient->isSingleWord())
-        Quotient->pVal = getClearedMemory(Quotient->getNumWords());
-    } else
-      Quotient->clearAllBits();
+        Quotient->allocateWords();
+    }
+    Quotient->clearAllBits();
 
     // The quotient is in Q. Reconstitute the quotient into Quotient's low
     // order words.
@@ -1803,15 +1755,13 @@ void APInt::divide(const APInt LHS, unsigned lhsWords,
   if (Remainder) {
     // Set up the Remainder value's memory.
     if (Remainder->BitWidth != RHS.BitWidth) {
-      if (Remainder->isSingleWord())
-        Remainder->VAL = 0;
-      else
+      if (Remainder->needsCleanup())
         delete [] Remainder->pVal;
       Remainder->BitWidth = RHS.BitWidth;
       if (!Remainder->isSingleWord())
-        Remainder->pVal = getClearedMemory(Remainder->getNumWords());
-    } else
-      Remainder->clearAllBits();
+        Remainder->allocateWords();
+    }
+    Remainder->clearAllBits();
 
     // The remainder is in R. Reconstitute the remainder into Remainder's low
     // order words.
@@ -2083,8 +2033,10 @@ void APInt::fromString(unsigned numbits, StringRef str, uint8_t radix) {
          "Insufficient bit width");
 
   // Allocate memory
-  if (!isSingleWord())
-    pVal = getClearedMemory(getNumWords());
+  if (!isSingleWord()) {
+    allocateWords();
+    clearAllBits();
+  }
 
   // Figure out if we can shift instead of multiply
   unsigned shift = (radix == 16 ? 4 : radix == 8 ? 3 : radix == 2 ? 1 : 0);
@@ -11,7 +11,9 @@
 //
 //===----------------------------------------------------------------------===//
 
+#define DEBUG_TYPE "allocator"
 #include "llvm/Support/Allocator.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/Support/Compiler.h"
 #include "llvm/Support/DataTypes.h"
 #include "llvm/Support/Memory.h"
@@ -19,6 +21,9 @@
 #include "llvm/Support/raw_ostream.h"
 #include <cstring>
 
+STATISTIC(NumSlabsMalloced, "Number of slabs malloc'd for bump allocators");
+STATISTIC(NumBytesRequested, "Number of bytes requested from bump allocators");
+
 namespace llvm {
 
 BumpPtrAllocator::BumpPtrAllocator(size_t size, size_t threshold,
@@ -31,6 +36,7 @@ BumpPtrAllocator::BumpPtrAllocator(size_t size, size_t threshold)
       Allocator(DefaultSlabAllocator), CurSlab(0), BytesAllocated(0) { }
 
 BumpPtrAllocator::~BumpPtrAllocator() {
+  NumBytesRequested += BytesAllocated;
   DeallocateSlabs(CurSlab);
 }
 
@@ -83,6 +89,7 @@ void BumpPtrAllocator::DeallocateSlabs(MemSlab *Slab) {
 void BumpPtrAllocator::Reset() {
   if (!CurSlab)
     return;
+  NumBytesRequested += BytesAllocated;
   DeallocateSlabs(CurSlab->NextPtr);
   CurSlab->NextPtr = 0;
   CurPtr = (char*)(CurSlab + 1);
@@ -176,6 +183,7 @@ SlabAllocator::~SlabAllocator() { }
 MallocSlabAllocator::~MallocSlabAllocator() { }
 
 MemSlab *MallocSlabAllocator::Allocate(size_t Size) {
+  ++NumSlabsMalloced;
   MemSlab *Slab = (MemSlab*)Allocator.Allocate(Size, 0);
   Slab->Size = Size;
   Slab->NextPtr = 0;
@@ -127,13 +127,9 @@ void OptionCategory::registerCategory()
 // Basic, shared command line option processing machinery.
 //
 
-/// GetOptionInfo - Scan the list of registered options, turning them into data
-/// structures that are easier to handle.
-static void GetOptionInfo(SmallVectorImpl<Option*> &PositionalOpts,
-                          SmallVectorImpl<Option*> &SinkOpts,
-                          StringMap<Option*> &OptionsMap) {
+/// GetOptionNames - Map the names of every registered option to the option.
+static void GetOptionNames(StringMap<Option*> &OptionsMap) {
   SmallVector<const char*, 16> OptionNames;
-  Option *CAOpt = 0;  // The ConsumeAfter option if it exists.
   for (Option *O = RegisteredOptionList; O; O = O->getNextRegisteredOption()) {
     // If this option wants to handle multiple option names, get the full set.
     // This handles enum options like "-O1 -O2" etc.
@@ -151,7 +147,15 @@ static void GetOptionInfo(SmallVectorImpl<Option*> &PositionalOpts,
     }
 
     OptionNames.clear();
+  }
+}
 
+/// GetOptionInfo - Scan the list of registered options for the positional,
+/// sink and ConsumeAfter options.
+static void GetOptionInfo(SmallVectorImpl<Option*> &PositionalOpts,
+                          SmallVectorImpl<Option*> &SinkOpts) {
+  Option *CAOpt = 0;  // The ConsumeAfter option if it exists.
+  for (Option *O = RegisteredOptionList; O; O = O->getNextRegisteredOption()) {
     // Remember information about positional options.
     if (O->getFormattingFlag() == cl::Positional)
       PositionalOpts.push_back(O);
@@ -171,12 +175,107 @@ static void GetOptionInfo(SmallVectorImpl<Option*> &PositionalOpts,
   std::reverse(PositionalOpts.begin(), PositionalOpts.end());
 }
 
+/// GetOptionInfo - Scan the list of registered options, turning them into data
+/// structures that are easier to handle.
+static void GetOptionInfo(SmallVectorImpl<Option*> &PositionalOpts,
+                          SmallVectorImpl<Option*> &SinkOpts,
+                          StringMap<Option*> &OptionsMap) {
+  GetOptionInfo(PositionalOpts, SinkOpts);
+  GetOptionNames(OptionsMap);
+}
+
+namespace {
+/// OptionTable - Finds the registered options by name while the command line
+/// is parsed.  Mapping every option name costs far more than the few lookups
+/// of a short command line, so the first lookups scan the registered options
+/// and the map is only built once a command line has made enough of them.
+class OptionTable {
+  StringMap<Option*> Map;
+  bool MapBuilt;
+  unsigned NumScans;
+
+  Option *scan(StringRef Name);
+
+public:
+  OptionTable() : MapBuilt(false), NumScans(0) {}
+
+  /// lookup - Return the option named \p Name, or null if there is none.
+  Option *lookup(StringRef Name);
+
+  /// getMap - Return the map of every option name, building it if needed.
+  const StringMap<Option*> &getMap();
+
+  /// clear - Forget the options looked up, after the option list changed.
+  void clear() {
+    Map.clear();
+    MapBuilt = false;
+    NumScans = 0;
+  }
+};
+} // end anonymous namespace
+
+/// MaxOptionScans - The number of names looked up by scanning the registered
+/// options before building the map, which takes about as long as this many
+/// scans.
+static const unsigned MaxOptionScans = 8;
+
+Option *OptionTable::scan(StringRef Name) {
+  // Check every option rather than stopping at the first match so that
+  // duplicate names are still diagnosed.  As in the map, the option
+  // registered last wins.
+  SmallVector<const char*, 16> OptionNames;
+  Option *Found = 0;
+  for (Option *O = RegisteredOptionList; O; O = O->getNextRegisteredOption()) {
+    O->getExtraOptionNames(OptionNames);
+    if (O->ArgStr[0])
+      OptionNames.push_back(O->ArgStr);
+
+    for (size_t i = 0, e = OptionNames.size(); i != e; ++i) {
+      if (Name != OptionNames[i])
+        continue;
+      if (!Found)
+        Found = O;
+      else if (Found != O)
+        errs() << ProgramName << ": CommandLine Error: Argument '"
+               << Name << "' defined more than once!\n";
+    }
+
+    OptionNames.clear();
+  }
+  return Found;
+}
+
+Option *OptionTable::lookup(StringRef Name) {
+  if (!MapBuilt && NumScans < MaxOptionScans) {
+    ++NumScans;
+    return scan(Name);
+  }
+  return getMap().lookup(Name);
+}
+
+const StringMap<Option*> &OptionTable::getMap() {
+  if (!MapBuilt) {
+    GetOptionNames(Map);
+    MapBuilt = true;
+  }
+  return Map;
+}
+
+
+/// isNamedOption - Return true if \p O has a name on the command line.
+static bool isNamedOption(Option *O) {
+  if (O->ArgStr[0])
+    return true;
+  SmallVector<const char*, 16> OptionNames;
+  O->getExtraOptionNames(OptionNames);
+  return !OptionNames.empty();
+}
 
 /// LookupOption - Lookup the option specified by the specified option on the
 /// command line.  If there is a value specified (after an equal sign) return
 /// that as well.  This assumes that leading dashes have already been stripped.
 static Option *LookupOption(StringRef &Arg, StringRef &Value,
-                            const StringMap<Option*> &OptionsMap) {
+                            OptionTable &Options) {
   // Reject all dashes.
   if (Arg.empty()) return 0;
 
@@ -185,19 +284,17 @@ static Option *LookupOption(StringRef &Arg, StringRef &Value,
   // If we have an equals sign, remember the value.
   if (EqualPos == StringRef::npos) {
     // Look up the option.
-    StringMap<Option*>::const_iterator I = OptionsMap.find(Arg);
-    return I != OptionsMap.end() ? I->second : 0;
+    return Options.lookup(Arg);
   }
 
   // If the argument before the = is a valid option name, we match.  If not,
   // return Arg unmolested.
-  StringMap<Option*>::const_iterator I =
-    OptionsMap.find(Arg.substr(0, EqualPos));
-  if (I == OptionsMap.end()) return 0;
+  Option *O = Options.lookup(Arg.substr(0, EqualPos));
+  if (O == 0) return 0;
 
   Value = Arg.substr(EqualPos+1);
   Arg = Arg.substr(0, EqualPos);
-  return I->second;
+  return O;
 }
 
 /// LookupNearestOption - Lookup the closest match to the option specified by
@@ -359,21 +456,21 @@ static inline bool isPrefixedOrGrouping(const Option *O) {
 //
 static Option *getOptionPred(StringRef Name, size_t &Length,
                              bool (*Pred)(const Option*),
-                             const StringMap<Option*> &OptionsMap) {
+                             OptionTable &Options) {
 
-  StringMap<Option*>::const_iterator OMI = OptionsMap.find(Name);
+  Option *O = Options.lookup(Name);
 
   // Loop while we haven't found an option and Name still has at least two
   // characters in it (so that the next iteration will not be the empty
   // string.
-  while (OMI == OptionsMap.end() && Name.size() > 1) {
+  while (O == 0 && Name.size() > 1) {
     Name = Name.substr(0, Name.size()-1);   // Chop off the last character.
-    OMI = OptionsMap.find(Name);
+    O = Options.lookup(Name);
   }
 
-  if (OMI != OptionsMap.end() && Pred(OMI->second)) {
+  if (O != 0 && Pred(O)) {
     Length = Name.size();
-    return OMI->second;    // Found one!
+    return O;    // Found one!
   }
   return 0;                // No option found!
 }
@@ -384,12 +481,12 @@ static Option *getOptionPred(StringRef Name, size_t &Length,
 /// Arg/Value pair and return the Option to parse it with.
 static Option *HandlePrefixedOrGroupedOption(StringRef &Arg, StringRef &Value,
                                              bool &ErrorParsing,
-                                         const StringMap<Option*> &OptionsMap) {
+                                             OptionTable &Options) {
   if (Arg.size() == 1) return 0;
 
   // Do the lookup!
   size_t Length = 0;
-  Option *PGOpt = getOptionPred(Arg, Length, isPrefixedOrGrouping, OptionsMap);
+  Option *PGOpt = getOptionPred(Arg, Length, isPrefixedOrGrouping, Options);
   if (PGOpt == 0) return 0;
 
   // If the option is a prefixed option, then the value is simply the
@@ -398,7 +495,7 @@ static Option *HandlePrefixedOrGroupedOption(StringRef &Arg, StringRef &Value,
   if (PGOpt->getFormattingFlag() == cl::Prefix) {
     Value = Arg.substr(Length);
     Arg = Arg.substr(0, Length);
-    assert(OptionsMap.count(Arg) && OptionsMap.find(Arg)->second == PGOpt);
+    assert(Options.lookup(Arg) == PGOpt);
     return PGOpt;
   }
 
@@ -420,7 +517,7 @@ static Option *HandlePrefixedOrGroupedOption(StringRef &Arg, StringRef &Value,
                                   StringRef(), 0, 0, Dummy);
 
     // Get the next grouping option.
-    PGOpt = getOptionPred(Arg, Length, isGrouping, OptionsMap);
+    PGOpt = getOptionPred(Arg, Length, isGrouping, Options);
   } while (PGOpt && Length != Arg.size());
 
   // Return the last option with Arg cut down to just the last one.
@@ -720,11 +817,10 @@ void cl::ParseCommandLineOptions(int argc, const char * const *argv,
   // Process all registered options.
   SmallVector<Option*, 4> PositionalOpts;
   SmallVector<Option*, 4> SinkOpts;
-  StringMap<Option*> Opts;
-  GetOptionInfo(PositionalOpts, SinkOpts, Opts);
+  OptionTable Opts;
+  GetOptionInfo(PositionalOpts, SinkOpts);
 
-  assert((!Opts.empty() || !PositionalOpts.empty()) &&
-         "No options specified!");
+  assert(RegisteredOptionList && "No options specified!");
 
   // Expand response files.
   SmallVector<const char *, 20> newArgv;
@@ -814,7 +910,7 @@ void cl::ParseCommandLineOptions(int argc, const char * const *argv,
       PositionalOpts.clear();
       SinkOpts.clear();
       Opts.clear();
-      GetOptionInfo(PositionalOpts, SinkOpts, Opts);
+      GetOptionInfo(PositionalOpts, SinkOpts);
       OptionListChanged = false;
     }
 
@@ -881,7 +977,7 @@ void cl::ParseCommandLineOptions(int argc, const char * const *argv,
       // Otherwise, look for the closest available option to report to the user
       // in the upcoming error.
       if (Handler == 0 && SinkOpts.empty())
-        NearestHandler = LookupNearestOption(ArgName, Opts,
+        NearestHandler = LookupNearestOption(ArgName, Opts.getMap(),
                                              NearestHandlerString);
     }
 
@@ -995,13 +1091,14 @@ void cl::ParseCommandLineOptions(int argc, const char * const *argv,
   }
 
   // Loop over args and make sure all required args are specified!
-  for (StringMap<Option*>::iterator I = Opts.begin(),
-         E = Opts.end(); I != E; ++I) {
-    switch (I->second->getNumOccurrencesFlag()) {
+  for (Option *O = RegisteredOptionList; O; O = O->getNextRegisteredOption()) {
+    if (!isNamedOption(O))
+      continue;
+    switch (O->getNumOccurrencesFlag()) {
     case Required:
     case OneOrMore:
-      if (I->second->getNumOccurrences() == 0) {
-        I->second->error("must be specified at least once!");
+      if (O->getNumOccurrences() == 0) {
+        O->error("must be specified at least once!");
         ErrorParsing = true;
       }
       // Fall through
@@ -17,12 +17,16 @@
 #define DEBUG_TYPE "Data-stream"
 #include "llvm/Support/DataStream.h"
 #include "llvm/ADT/Statistic.h"
+#include "llvm/Config/config.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Program.h"
 #include "llvm/Support/system_error.h"
+#include <algorithm>
 #include <cerrno>
 #include <cstdio>
+#include <cstring>
 #include <string>
+#include <vector>
 #if !defined(_MSC_VER) && !defined(__MINGW32__)
 #include <unistd.h>
 #else
@@ -42,6 +46,8 @@ using namespace llvm;
 // to be able to to free Data, BitstreamBytes/BitcodeReader will implement it
 
 STATISTIC(NumStreamFetches, "Number of calls to Data stream fetch");
+STATISTIC(NumReadAheadStalls,
+          "Number of times a read-ahead stream waited for its source");
 
 namespace llvm {
 DataStreamer::~DataStreamer() {}
@@ -89,3 +95,134 @@ DataStreamer *getDataFileStreamer(const std::string &Filename,
 }
 
 }
+
+#if LLVM_ENABLE_THREADS != 0 && defined(HAVE_PTHREAD_H)
+#include <pthread.h>
+
+namespace {
+
+// Streamer that reads its source on a separate thread into a ring buffer of
+// a fixed size.  The reading thread only writes to the free part of the
+// buffer and the consumer only reads from the filled part, so the lock is
+// only held to update the bounds, never while calling the source.
+class ReadAheadDataStreamer : public DataStreamer {
+  DataStreamer *Source;
+  std::vector<unsigned char> Buffer;
+  size_t Head; // Offset of the first filled byte.
+  size_t Size; // Number of filled bytes.
+  bool SourceDone;
+  bool Stopping;
+
+  pthread_t Reader;
+  pthread_mutex_t Lock;
+  pthread_cond_t DataAvailable;
+  pthread_cond_t SpaceAvailable;
+
+  /// The most bytes asked of the source at once.
+  static const size_t MaxFetchSize = 64 * 1024;
+
+  static void *runReader(void *Arg) {
+    static_cast<ReadAheadDataStreamer *>(Arg)->readAhead();
+    return 0;
+  }
+
+  void readAhead() {
+    size_t Capacity = Buffer.size();
+    pthread_mutex_lock(&Lock);
+    for (;;) {
+      while (Size == Capacity && !Stopping)
+        pthread_cond_wait(&SpaceAvailable, &Lock);
+      if (Stopping)
+        break;
+      size_t Tail = (Head + Size) % Capacity;
+      size_t Len = std::min(std::min(Capacity - Size, Capacity - Tail),
+                            MaxFetchSize);
+      pthread_mutex_unlock(&Lock);
+
+      size_t Read = Source->GetBytes(&Buffer[Tail], Len);
+
+      pthread_mutex_lock(&Lock);
+      // Treat errors, which file streamers report as (size_t)-1, as the end.
+      if (Read == 0 || Read > Len)
+        SourceDone = true;
+      else
+        Size += Read;
+      pthread_cond_signal(&DataAvailable);
+      if (SourceDone)
+        break;
+    }
+    pthread_mutex_unlock(&Lock);
+  }
+
+public:
+  ReadAheadDataStreamer(DataStreamer *Source, size_t BufferSize)
+    : Source(Source), Buffer(std::max(BufferSize, size_t(1))), Head(0),
+      Size(0), SourceDone(false), Stopping(false) {
+    pthread_mutex_init(&Lock, 0);
+    pthread_cond_init(&DataAvailable, 0);
+    pthread_cond_init(&SpaceAvailable, 0);
+    if (pthread_create(&Reader, 0, runReader, this) != 0) {
+      // Read synchronously instead.
+      Buffer.clear();
+      SourceDone = true;
+    }
+  }
+
+  virtual ~ReadAheadDataStreamer() {
+    if (!Buffer.empty()) {
+      pthread_mutex_lock(&Lock);
+      Stopping = true;
+      pthread_cond_signal(&SpaceAvailable);
+      pthread_mutex_unlock(&Lock);
+      // This waits for a read of the source that is under way.
+      pthread_join(Reader, 0);
+    }
+    pthread_cond_destroy(&SpaceAvailable);
+    pthread_cond_destroy(&DataAvailable);
+    pthread_mutex_destroy(&Lock);
+    delete Source;
+  }
+
+  virtual size_t GetBytes(unsigned char *buf, size_t len) LLVM_OVERRIDE {
+    if (Buffer.empty())
+      return Source->GetBytes(buf, len);
+
+    size_t Capacity = Buffer.size();
+    size_t Copied = 0;
+    pthread_mutex_lock(&Lock);
+    while (Copied != len) {
+      if (Size == 0) {
+        if (SourceDone)
+          break;
+        ++NumReadAheadStalls;
+        while (Size == 0 && !SourceDone)
+          pthread_cond_wait(&DataAvailable, &Lock);
+        continue;
+      }
+      size_t Len = std::min(std::min(Size, len - Copied), Capacity - Head);
+      memcpy(buf + Copied, &Buffer[Head], Len);
+      Head = (Head + Len) % Capacity;
+      Size -= Len;
+      Copied += Len;
+      pthread_cond_signal(&SpaceAvailable);
+    }
+    pthread_mutex_unlock(&Lock);
+    return Copied;
+  }
+};
+
+}
+
+DataStreamer *llvm::getReadAheadDataStreamer(DataStreamer *Source,
+                                             size_t BufferSize) {
+  return new ReadAheadDataStreamer(Source, BufferSize);
+}
+
+#else
+
+DataStreamer *llvm::getReadAheadDataStreamer(DataStreamer *Source,
+                                             size_t BufferSize) {
+  return Source;
+}
+
+#endif
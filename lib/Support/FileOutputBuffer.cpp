@@ -14,6 +14,7 @@
 #include "llvm/Support/FileOutputBuffer.h"
 #include "llvm/ADT/OwningPtr.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/Signals.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/system_error.h"
 
@@ -30,6 +31,7 @@ FileOutputBuffer::FileOutputBuffer(mapped_file_region * R,
 FileOutputBuffer::~FileOutputBuffer() {
   bool Existed;
   sys::fs::remove(Twine(TempPath), Existed);
+  sys::DontRemoveFileOnSignal(TempPath);
 }
 
 error_code FileOutputBuffer::create(StringRef FilePath,
@@ -75,6 +77,9 @@ error_code FileOutputBuffer::create(StringRef FilePath,
   if (EC)
     return EC;
 
+  // Do not leave the temporary file behind if the tool is killed.
+  sys::RemoveFileOnSignal(TempFilePath);
+
   OwningPtr<mapped_file_region> MappedFile(new mapped_file_region(
       FD, true, mapped_file_region::readwrite, Size, 0, EC));
   if (EC)
@@ -101,4 +106,18 @@ error_code FileOutputBuffer::commit(int64_t NewSmallerSize) {
   // Rename file to final name.
   return sys::fs::rename(Twine(TempPath), Twine(FinalPath));
 }
+
+error_code FileOutputBuffer::extend(size_t NewSize) {
+  assert(NewSize >= getBufferSize() && "Cannot shrink the buffer!");
+  // Unmap the buffer first; its contents are already in the file.
+  Region.reset(0);
+
+  error_code EC;
+  OwningPtr<mapped_file_region> MappedFile(new mapped_file_region(
+      Twine(TempPath), mapped_file_region::readwrite, NewSize, 0, EC));
+  if (EC)
+    return EC;
+  Region.reset(MappedFile.take());
+  return error_code::success();
+}
 } // namespace
@@ -14,7 +14,9 @@
 
 #include "llvm/Support/Memory.h"
 #include "llvm/Config/config.h"
+#include "llvm/Support/Process.h"
 #include "llvm/Support/Valgrind.h"
+#include <cstring>
 
 // Include the platform-specific parts of this class.
 #ifdef LLVM_ON_UNIX
@@ -23,3 +25,26 @@
 #ifdef LLVM_ON_WIN32
 #include "Windows/Memory.inc"
 #endif
+
+namespace llvm {
+namespace sys {
+
+error_code Memory::patchCode(void *Addr, const void *Code, size_t Size) {
+  if (Size == 0)
+    return error_code::success();
+
+  uintptr_t PageSize = process::get_self()->page_size();
+  uintptr_t Start = uintptr_t(Addr) & ~(PageSize - 1);
+  uintptr_t End = (uintptr_t(Addr) + Size + PageSize - 1) & ~(PageSize - 1);
+  MemoryBlock Pages((void *)Start, End - Start);
+
+  if (error_code EC =
+          protectMappedMemory(Pages, MF_READ | MF_WRITE | MF_EXEC))
+    return EC;
+  memcpy(Addr, Code, Size);
+  // This also invalidates the instruction cache for the pages.
+  return protectMappedMemory(Pages, MF_READ | MF_EXEC);
+}
+
+} // end namespace sys
+} // end namespace llvm
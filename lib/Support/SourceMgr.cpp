@@ -21,18 +21,47 @@
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/system_error.h"
+#include <algorithm>
+#include <cstring>
 using namespace llvm;
 
 static const size_t TabStop = 8;
 
 namespace {
+  /// LineNoCacheTy - For each buffer that line numbers were asked about, the
+  /// sorted offsets of its newlines, so that a query is a binary search
+  /// whatever order the locations come in.
   struct LineNoCacheTy {
-    int LastQueryBufferID;
-    const char *LastQuery;
-    unsigned LineNoOfQuery;
+    std::vector<std::vector<unsigned> > NewlineOffsets;
+    std::vector<bool> Indexed;
+
+    /// getNewlineOffsets - Return the offsets of the newlines of Buffer,
+    /// scanning it the first time.
+    const std::vector<unsigned> &getNewlineOffsets(int BufferID,
+                                                   const MemoryBuffer *Buffer);
   };
 }
 
+const std::vector<unsigned> &
+LineNoCacheTy::getNewlineOffsets(int BufferID, const MemoryBuffer *Buffer) {
+  if (NewlineOffsets.size() <= unsigned(BufferID)) {
+    NewlineOffsets.resize(BufferID + 1);
+    Indexed.resize(BufferID + 1);
+  }
+  std::vector<unsigned> &Offsets = NewlineOffsets[BufferID];
+  if (Indexed[BufferID])
+    return Offsets;
+
+  // memchr skips to the next newline many bytes at a time.
+  const char *Start = Buffer->getBufferStart();
+  const char *End = Buffer->getBufferEnd();
+  for (const char *Ptr = Start;
+       (Ptr = (const char *)memchr(Ptr, '\n', End - Ptr)); ++Ptr)
+    Offsets.push_back(Ptr - Start);
+  Indexed[BufferID] = true;
+  return Offsets;
+}
+
 static LineNoCacheTy *getCache(void *Ptr) {
   return (LineNoCacheTy*)Ptr;
 }
@@ -84,46 +113,35 @@ int SourceMgr::FindBufferContainingLoc(SMLoc Loc) const {
 }
 
 /// getLineAndColumn - Find the line and column number for the specified
-/// location in the specified file.  This is not a fast method.
+/// location in the specified file.  The first query on a buffer indexes its
+/// lines.
 std::pair<unsigned, unsigned>
 SourceMgr::getLineAndColumn(SMLoc Loc, int BufferID) const {
   if (BufferID == -1) BufferID = FindBufferContainingLoc(Loc);
   assert(BufferID != -1 && "Invalid Location!");
 
   MemoryBuffer *Buff = getBufferInfo(BufferID).Buffer;
-
-  // Count the number of \n's between the start of the file and the specified
-  // location.
-  unsigned LineNo = 1;
-
   const char *BufStart = Buff->getBufferStart();
-  const char *Ptr = BufStart;
-
-  // If we have a line number cache, and if the query is to a later point in the
-  // same file, start searching from the last query location.  This optimizes
-  // for the case when multiple diagnostics come out of one file in order.
-  if (LineNoCacheTy *Cache = getCache(LineNoCache))
-    if (Cache->LastQueryBufferID == BufferID &&
-        Cache->LastQuery <= Loc.getPointer()) {
-      Ptr = Cache->LastQuery;
-      LineNo = Cache->LineNoOfQuery;
-    }
+  const char *Ptr = Loc.getPointer();
+  unsigned LineNo = 1;
 
-  // Scan for the location being queried, keeping track of the number of lines
-  // we see.
-  for (; SMLoc::getFromPointer(Ptr) != Loc; ++Ptr)
-    if (*Ptr == '\n') ++LineNo;
+  if (Buff->getBufferSize() <= ~0U) {
+    // Allocate the line number cache if it doesn't exist.
+    if (LineNoCache == 0)
+      LineNoCache = new LineNoCacheTy();
 
-  // Allocate the line number cache if it doesn't exist.
-  if (LineNoCache == 0)
-    LineNoCache = new LineNoCacheTy();
+    // The line number is one more than the number of \n's before the
+    // location.
+    const std::vector<unsigned> &Offsets =
+      getCache(LineNoCache)->getNewlineOffsets(BufferID, Buff);
+    LineNo += std::lower_bound(Offsets.begin(), Offsets.end(),
+                               unsigned(Ptr - BufStart)) - Offsets.begin();
+  } else {
+    // Offsets into buffers this large do not fit the index; count the \n's.
+    for (const char *I = BufStart; I != Ptr; ++I)
+      if (*I == '\n') ++LineNo;
+  }
 
-  // Update the line # cache.
-  LineNoCacheTy &Cache = *getCache(LineNoCache);
-  Cache.LastQueryBufferID = BufferID;
-  Cache.LastQuery = Ptr;
-  Cache.LineNoOfQuery = LineNo;
-  
   size_t NewlineOffs = StringRef(BufStart, Ptr-BufStart).find_last_of("\n\r");
   if (NewlineOffs == StringRef::npos) NewlineOffs = ~(size_t)0;
   return std::make_pair(LineNo, Ptr-BufStart-NewlineOffs);
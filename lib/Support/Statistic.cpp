@@ -44,6 +44,9 @@ Enabled(
     "stats",
     cl::desc("Enable statistics output from program (available with Asserts)"));
 
+static cl::opt<bool>
+StatsAsJSON("stats-json", cl::desc("Display statistics as json data"));
+
 
 namespace {
 /// StatisticInfo - This class is used in a ManagedStatic so that it is created
@@ -53,6 +56,7 @@ class StatisticInfo {
   std::vector<const Statistic*> Stats;
   friend void llvm::PrintStatistics();
   friend void llvm::PrintStatistics(raw_ostream &OS);
+  friend void llvm::PrintStatisticsJSON(raw_ostream &OS);
 public:
   ~StatisticInfo();
 
@@ -112,6 +116,11 @@ bool llvm::AreStatisticsEnabled() {
 }
 
 void llvm::PrintStatistics(raw_ostream &OS) {
+  if (StatsAsJSON) {
+    PrintStatisticsJSON(OS);
+    return;
+  }
+
   StatisticInfo &Stats = *StatInfo;
 
   // Figure out how long the biggest Value and Name fields are.
@@ -143,6 +152,38 @@ void llvm::PrintStatistics(raw_ostream &OS) {
 
 }
 
+/// Write S as the contents of a JSON string.
+static void printJSONString(raw_ostream &OS, const char *S) {
+  for (; *S; ++S) {
+    unsigned char C = *S;
+    if (C == '"' || C == '\\')
+      OS << '\\' << C;
+    else if (C < 0x20)
+      OS << format("\\u%04x", static_cast<unsigned>(C));
+    else
+      OS << C;
+  }
+}
+
+void llvm::PrintStatisticsJSON(raw_ostream &OS) {
+  StatisticInfo &Stats = *StatInfo;
+  std::stable_sort(Stats.Stats.begin(), Stats.Stats.end(), NameCompare());
+
+  // Statistics made with construct() have no variable name; use their
+  // description instead.
+  OS << "{\n";
+  for (size_t i = 0, e = Stats.Stats.size(); i != e; ++i) {
+    const Statistic *S = Stats.Stats[i];
+    OS << "\t\"";
+    printJSONString(OS, S->getName());
+    OS << '.';
+    printJSONString(OS, S->getVarName() ? S->getVarName() : S->getDesc());
+    OS << "\": " << S->getValue() << (i + 1 != e ? ",\n" : "\n");
+  }
+  OS << "}\n";
+  OS.flush();
+}
+
 void llvm::PrintStatistics() {
 #if !defined(NDEBUG) || defined(LLVM_ENABLE_STATS)
   StatisticInfo &Stats = *StatInfo;
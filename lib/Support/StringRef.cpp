@@ -12,8 +12,13 @@
 #include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/OwningPtr.h"
 #include "llvm/ADT/edit_distance.h"
+#include "llvm/Support/MathExtras.h"
 #include <bitset>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 using namespace llvm;
 
 // MSVC emits references to this into the translation units which reference it.
@@ -140,11 +145,56 @@ std::string StringRef::upper() const {
 ///
 /// \return - The index of the first occurrence of \arg Str, or npos if not
 /// found.
+#ifdef __SSE2__
+/// findSSE2 - Find Needle, of at least two characters, in Data from From on.
+/// Sixteen positions are tested at once; a position is only compared in full
+/// if the first and the last character of the needle both match there.
+static size_t findSSE2(const char *Data, size_t Length, StringRef Needle,
+                       size_t From) {
+  size_t N = Needle.size();
+  const __m128i First = _mm_set1_epi8(Needle.front());
+  const __m128i Last = _mm_set1_epi8(Needle.back());
+
+  size_t Pos = From;
+  for (; Pos + N - 1 + 16 <= Length; Pos += 16) {
+    __m128i BlockFirst = _mm_loadu_si128((const __m128i *)(Data + Pos));
+    __m128i BlockLast = _mm_loadu_si128((const __m128i *)(Data + Pos + N - 1));
+    unsigned Mask = _mm_movemask_epi8(
+        _mm_and_si128(_mm_cmpeq_epi8(First, BlockFirst),
+                      _mm_cmpeq_epi8(Last, BlockLast)));
+    while (Mask) {
+      unsigned Bit = countTrailingZeros(Mask);
+      if (std::memcmp(Data + Pos + Bit + 1, Needle.data() + 1, N - 2) == 0)
+        return Pos + Bit;
+      Mask &= Mask - 1;
+    }
+  }
+
+  // Try the positions left over one at a time.
+  for (; Pos + N <= Length; ++Pos)
+    if (Data[Pos] == Needle.front() &&
+        std::memcmp(Data + Pos, Needle.data(), N) == 0)
+      return Pos;
+  return StringRef::npos;
+}
+#endif
+
 size_t StringRef::find(StringRef Str, size_t From) const {
   size_t N = Str.size();
   if (N > Length)
     return npos;
 
+  if (N == 1)
+    return find(Str.front(), From);
+
+#ifdef __SSE2__
+  if (N != 0) {
+    if (From >= Length)
+      return npos;
+    return findSSE2(Data, Length, Str, From);
+  }
+#endif
+
   // For short haystacks or unsupported needles fall back to the naive algorithm
   if (Length < 16 || N > 255 || N == 0) {
     for (size_t e = Length - N + 1, i = min(From, e); i != e; ++i)
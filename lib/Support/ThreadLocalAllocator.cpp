@@ -0,0 +1,135 @@
+//===- ThreadLocalAllocator.cpp - Allocators shared by threads ------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the RecyclingSlabAllocator and
+// ThreadLocalBumpPtrAllocator interfaces.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "allocator"
+#include "llvm/Support/ThreadLocalAllocator.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Support/raw_ostream.h"
+
+STATISTIC(NumSlabsRecycled, "Number of slabs reused by bump allocators");
+
+namespace llvm {
+
+RecyclingSlabAllocator::RecyclingSlabAllocator(unsigned MaxFreeSlabs)
+  : Lock(/*recursive=*/false), FreeSlabs(0), NumFreeSlabs(0),
+    MaxFreeSlabs(MaxFreeSlabs) {}
+
+RecyclingSlabAllocator::~RecyclingSlabAllocator() {
+  releaseMemory();
+}
+
+MemSlab *RecyclingSlabAllocator::Allocate(size_t Size) {
+  {
+    sys::ScopedLock Guard(Lock);
+    // Take a slab that is big enough and less than twice the size requested,
+    // so that less than half of it goes unused; most requests are for the
+    // default slab size.
+    for (MemSlab **Link = &FreeSlabs; *Link; Link = &(*Link)->NextPtr) {
+      MemSlab *Slab = *Link;
+      if (Slab->Size < Size || Slab->Size / 2 >= Size)
+        continue;
+      *Link = Slab->NextPtr;
+      --NumFreeSlabs;
+      ++NumSlabsRecycled;
+      Slab->NextPtr = 0;
+      return Slab;
+    }
+  }
+  return Allocator.Allocate(Size);
+}
+
+void RecyclingSlabAllocator::Deallocate(MemSlab *Slab) {
+  {
+    sys::ScopedLock Guard(Lock);
+    if (NumFreeSlabs < MaxFreeSlabs) {
+      Slab->NextPtr = FreeSlabs;
+      FreeSlabs = Slab;
+      ++NumFreeSlabs;
+      return;
+    }
+  }
+  Allocator.Deallocate(Slab);
+}
+
+void RecyclingSlabAllocator::releaseMemory() {
+  sys::ScopedLock Guard(Lock);
+  while (FreeSlabs) {
+    MemSlab *Slab = FreeSlabs;
+    FreeSlabs = Slab->NextPtr;
+    Allocator.Deallocate(Slab);
+  }
+  NumFreeSlabs = 0;
+}
+
+ThreadLocalBumpPtrAllocator::ThreadLocalBumpPtrAllocator(size_t size,
+                                                         size_t threshold)
+  : SlabSize(size), SizeThreshold(threshold), Lock(/*recursive=*/false) {}
+
+ThreadLocalBumpPtrAllocator::~ThreadLocalBumpPtrAllocator() {
+  for (unsigned i = 0, e = Arenas.size(); i != e; ++i)
+    delete Arenas[i];
+}
+
+BumpPtrAllocator &ThreadLocalBumpPtrAllocator::getArena() {
+  if (const BumpPtrAllocator *Arena = Current.get())
+    return *const_cast<BumpPtrAllocator*>(Arena);
+
+  BumpPtrAllocator *Arena =
+    new BumpPtrAllocator(SlabSize, SizeThreshold, Slabs);
+  sys::ScopedLock Guard(Lock);
+  Arenas.push_back(Arena);
+  Current.set(Arena);
+  return *Arena;
+}
+
+void ThreadLocalBumpPtrAllocator::Reset() {
+  sys::ScopedLock Guard(Lock);
+  for (unsigned i = 0, e = Arenas.size(); i != e; ++i)
+    Arenas[i]->Reset();
+}
+
+unsigned ThreadLocalBumpPtrAllocator::GetNumSlabs() const {
+  unsigned NumSlabs = 0;
+  for (unsigned i = 0, e = Arenas.size(); i != e; ++i)
+    NumSlabs += Arenas[i]->GetNumSlabs();
+  return NumSlabs;
+}
+
+size_t ThreadLocalBumpPtrAllocator::getTotalMemory() const {
+  size_t TotalMemory = 0;
+  for (unsigned i = 0, e = Arenas.size(); i != e; ++i)
+    TotalMemory += Arenas[i]->getTotalMemory();
+  return TotalMemory;
+}
+
+size_t ThreadLocalBumpPtrAllocator::getBytesAllocated() const {
+  size_t Bytes = 0;
+  for (unsigned i = 0, e = Arenas.size(); i != e; ++i)
+    Bytes += Arenas[i]->getBytesAllocated();
+  return Bytes;
+}
+
+void ThreadLocalBumpPtrAllocator::PrintStats() const {
+  size_t TotalMemory = getTotalMemory();
+  size_t BytesAllocated = getBytesAllocated();
+  errs() << "\nNumber of threads: " << Arenas.size() << '\n'
+         << "Number of memory regions: " << GetNumSlabs() << '\n'
+         << "Bytes used: " << BytesAllocated << '\n'
+         << "Bytes allocated: " << TotalMemory << '\n'
+         << "Bytes wasted: " << (TotalMemory - BytesAllocated)
+         << " (includes alignment, etc)\n"
+         << "Slabs waiting to be reused: " << Slabs.getNumFreeSlabs() << '\n';
+}
+
+} // end namespace llvm
@@ -0,0 +1,330 @@
+//===-- llvm/Support/ThreadPool.cpp - A pool of worker threads ------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the ThreadPool and TaskGroup classes.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Config/config.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/ManagedStatic.h"
+
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#ifdef LLVM_ON_WIN32
+#include "Windows/Windows.h"
+#endif
+
+using namespace llvm;
+
+static cl::opt<unsigned>
+Threads("threads", cl::Hidden, cl::init(0),
+        cl::desc("Number of threads used by parallel algorithms "
+                 "(default: the number of hardware threads)"));
+
+#if LLVM_ENABLE_THREADS != 0 && defined(HAVE_PTHREAD_H)
+#include "llvm/Support/Mutex.h"
+#include "llvm/Support/ThreadLocal.h"
+#include <deque>
+#include <pthread.h>
+#include <vector>
+
+namespace {
+
+struct Task {
+  void (*Fn)(void *);
+  void *Arg;
+  TaskGroup *Group;
+};
+
+/// TaskQueue - The tasks queued by or for one worker.  The worker takes tasks
+/// from the front and other threads steal them from the back.
+struct TaskQueue {
+  ThreadPoolImpl *Pool;
+  unsigned Index;
+  sys::Mutex Lock;
+  std::deque<Task> Tasks;
+
+  TaskQueue(ThreadPoolImpl *Pool, unsigned Index)
+    : Pool(Pool), Index(Index), Lock(/*recursive=*/false) {}
+};
+
+} // end anonymous namespace
+
+namespace llvm {
+
+class ThreadPoolImpl {
+  std::vector<TaskQueue*> Queues;
+  std::vector<pthread_t> Workers;
+  // The queue of the worker running on this thread, if it is one of ours.
+  sys::ThreadLocal<const TaskQueue> CurrentQueue;
+
+  // Threads with nothing to do sleep on WakeUp.  It is signalled when a task
+  // is queued and broadcast when a count being waited for drops to zero.
+  pthread_mutex_t SleepLock;
+  pthread_cond_t WakeUp;
+  bool Stopping;
+
+  volatile sys::cas_flag Queued;
+  volatile sys::cas_flag Outstanding;
+  volatile sys::cas_flag NextQueue;
+
+  static void *runWorker(void *Arg);
+  bool takeTask(Task &T);
+  void runTask(const Task &T);
+  void notifyAll();
+
+public:
+  explicit ThreadPoolImpl(unsigned NumThreads);
+  ~ThreadPoolImpl();
+
+  void push(void (*Fn)(void *), void *Arg, TaskGroup *Group);
+
+  /// Run queued tasks until Count drops to zero.
+  void waitUntilZero(volatile sys::cas_flag &Count);
+  void waitForAll() { waitUntilZero(Outstanding); }
+};
+
+} // end namespace llvm
+
+ThreadPoolImpl::ThreadPoolImpl(unsigned NumThreads)
+  : Stopping(false), Queued(0), Outstanding(0), NextQueue(0) {
+  ::pthread_mutex_init(&SleepLock, 0);
+  ::pthread_cond_init(&WakeUp, 0);
+
+  for (unsigned i = 0; i != NumThreads; ++i)
+    Queues.push_back(new TaskQueue(this, i));
+  // A queue whose thread could not be started is still emptied by the
+  // other workers and by waiting threads.
+  for (unsigned i = 0; i != NumThreads; ++i) {
+    pthread_t Thread;
+    if (::pthread_create(&Thread, 0, runWorker, Queues[i]) == 0)
+      Workers.push_back(Thread);
+  }
+}
+
+ThreadPoolImpl::~ThreadPoolImpl() {
+  waitForAll();
+
+  ::pthread_mutex_lock(&SleepLock);
+  Stopping = true;
+  ::pthread_cond_broadcast(&WakeUp);
+  ::pthread_mutex_unlock(&SleepLock);
+  for (unsigned i = 0, e = Workers.size(); i != e; ++i)
+    ::pthread_join(Workers[i], 0);
+
+  for (unsigned i = 0, e = Queues.size(); i != e; ++i)
+    delete Queues[i];
+  ::pthread_cond_destroy(&WakeUp);
+  ::pthread_mutex_destroy(&SleepLock);
+}
+
+void *ThreadPoolImpl::runWorker(void *Arg) {
+  TaskQueue *Queue = static_cast<TaskQueue*>(Arg);
+  ThreadPoolImpl *Pool = Queue->Pool;
+  Pool->CurrentQueue.set(Queue);
+
+  for (;;) {
+    Task T;
+    if (Pool->takeTask(T)) {
+      Pool->runTask(T);
+      continue;
+    }
+
+    ::pthread_mutex_lock(&Pool->SleepLock);
+    while (Pool->Queued == 0 && !Pool->Stopping)
+      ::pthread_cond_wait(&Pool->WakeUp, &Pool->SleepLock);
+    // The pool only stops once every task has finished.
+    bool Stop = Pool->Stopping;
+    ::pthread_mutex_unlock(&Pool->SleepLock);
+    if (Stop)
+      break;
+  }
+
+  Pool->CurrentQueue.erase();
+  return 0;
+}
+
+void ThreadPoolImpl::push(void (*Fn)(void *), void *Arg, TaskGroup *Group) {
+  Task T = { Fn, Arg, Group };
+  if (Group)
+    sys::AtomicIncrement(&Group->Pending);
+  sys::AtomicIncrement(&Outstanding);
+
+  // A worker keeps the tasks it creates; other threads spread theirs.
+  const TaskQueue *Current = CurrentQueue.get();
+  unsigned Index = Current ? Current->Index
+                           : sys::AtomicIncrement(&NextQueue) % Queues.size();
+  TaskQueue *Queue = Queues[Index];
+
+  // Count the task before it can be taken so that Queued never wraps.
+  sys::AtomicIncrement(&Queued);
+  Queue->Lock.acquire();
+  Queue->Tasks.push_front(T);
+  Queue->Lock.release();
+
+  ::pthread_mutex_lock(&SleepLock);
+  ::pthread_cond_signal(&WakeUp);
+  ::pthread_mutex_unlock(&SleepLock);
+}
+
+bool ThreadPoolImpl::takeTask(Task &T) {
+  if (Queued == 0)
+    return false;
+
+  // Take the newest task of our own queue, whose data is most likely still
+  // in cache, and otherwise the oldest task of some other queue, which is
+  // most likely to create more work.
+  const TaskQueue *Current = CurrentQueue.get();
+  unsigned Start = Current ? Current->Index : 0;
+  for (unsigned i = 0, e = Queues.size(); i != e; ++i) {
+    TaskQueue *Queue = Queues[(Start + i) % e];
+    bool Own = Queue == Current;
+    Queue->Lock.acquire();
+    if (Queue->Tasks.empty()) {
+      Queue->Lock.release();
+      continue;
+    }
+    if (Own) {
+      T = Queue->Tasks.front();
+      Queue->Tasks.pop_front();
+    } else {
+      T = Queue->Tasks.back();
+      Queue->Tasks.pop_back();
+    }
+    Queue->Lock.release();
+    sys::AtomicDecrement(&Queued);
+    return true;
+  }
+  return false;
+}
+
+void ThreadPoolImpl::runTask(const Task &T) {
+  T.Fn(T.Arg);
+
+  // The group may be destroyed as soon as its count reaches zero.
+  bool Notify = sys::AtomicDecrement(&Outstanding) == 0;
+  if (T.Group && sys::AtomicDecrement(&T.Group->Pending) == 0)
+    Notify = true;
+  if (Notify)
+    notifyAll();
+}
+
+void ThreadPoolImpl::notifyAll() {
+  ::pthread_mutex_lock(&SleepLock);
+  ::pthread_cond_broadcast(&WakeUp);
+  ::pthread_mutex_unlock(&SleepLock);
+}
+
+void ThreadPoolImpl::waitUntilZero(volatile sys::cas_flag &Count) {
+  while (Count != 0) {
+    Task T;
+    if (takeTask(T)) {
+      runTask(T);
+      continue;
+    }
+
+    ::pthread_mutex_lock(&SleepLock);
+    while (Count != 0 && Queued == 0)
+      ::pthread_cond_wait(&WakeUp, &SleepLock);
+    ::pthread_mutex_unlock(&SleepLock);
+  }
+}
+
+#else
+// Without threads no ThreadPoolImpl is ever created; tasks are run by the
+// thread queueing them.
+namespace llvm {
+
+class ThreadPoolImpl {
+public:
+  explicit ThreadPoolImpl(unsigned) {}
+  void push(void (*Fn)(void *), void *Arg, TaskGroup *) { Fn(Arg); }
+  void waitUntilZero(volatile sys::cas_flag &) {}
+  void waitForAll() {}
+};
+
+} // end namespace llvm
+#endif
+
+ThreadPool::ThreadPool(unsigned NumThreads)
+  : Impl(0), ThreadCount(NumThreads ? NumThreads : getDefaultThreadCount()) {
+#if LLVM_ENABLE_THREADS != 0 && defined(HAVE_PTHREAD_H)
+  if (ThreadCount > 1)
+    Impl = new ThreadPoolImpl(ThreadCount);
+#else
+  ThreadCount = 1;
+#endif
+}
+
+ThreadPool::~ThreadPool() {
+  delete Impl;
+}
+
+void ThreadPool::async(void (*Fn)(void *), void *Arg) {
+  if (!Impl) {
+    Fn(Arg);
+    return;
+  }
+  Impl->push(Fn, Arg, 0);
+}
+
+void ThreadPool::wait() {
+  if (Impl)
+    Impl->waitForAll();
+}
+
+static ManagedStatic<ThreadPool> GlobalPool;
+
+ThreadPool &ThreadPool::getGlobal() {
+  return *GlobalPool;
+}
+
+unsigned ThreadPool::getDefaultThreadCount() {
+  if (Threads)
+    return Threads;
+  return getHardwareThreadCount();
+}
+
+unsigned ThreadPool::getHardwareThreadCount() {
+#if defined(LLVM_ON_WIN32)
+  SYSTEM_INFO Info;
+  ::GetSystemInfo(&Info);
+  if (Info.dwNumberOfProcessors > 0)
+    return Info.dwNumberOfProcessors;
+#elif defined(HAVE_UNISTD_H) && defined(_SC_NPROCESSORS_ONLN)
+  long Count = ::sysconf(_SC_NPROCESSORS_ONLN);
+  if (Count > 0)
+    return Count;
+#endif
+  return 1;
+}
+
+TaskGroup::TaskGroup() : Pool(ThreadPool::getGlobal()), Pending(0) {}
+
+TaskGroup::TaskGroup(ThreadPool &Pool) : Pool(Pool), Pending(0) {}
+
+TaskGroup::~TaskGroup() {
+  wait();
+}
+
+void TaskGroup::async(void (*Fn)(void *), void *Arg) {
+  if (!Pool.Impl) {
+    Fn(Arg);
+    return;
+  }
+  Pool.Impl->push(Fn, Arg, this);
+}
+
+void TaskGroup::wait() {
+  if (Pool.Impl)
+    Pool.Impl->waitUntilZero(Pending);
+}
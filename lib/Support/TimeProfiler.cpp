@@ -0,0 +1,179 @@
+//===-- TimeProfiler.cpp - Hierarchical time trace ------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the time trace profiler declared in TimeProfiler.h.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/TimeProfiler.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/Mutex.h"
+#include "llvm/Support/ThreadLocal.h"
+#include "llvm/Support/TimeValue.h"
+#include "llvm/Support/raw_ostream.h"
+#include <string>
+#include <vector>
+
+using namespace llvm;
+
+static cl::opt<std::string>
+TimeTraceFile("time-trace-file", cl::Hidden, cl::value_desc("filename"),
+              cl::desc("Write a Chrome trace of the compilation's phases "
+                       "to this file"));
+
+namespace {
+
+/// TraceEvent - One event, with times in microseconds since the profiler
+/// started.
+struct TraceEvent {
+  std::string Name;
+  std::string Detail;
+  uint64_t Start;
+  uint64_t Duration;
+};
+
+/// ThreadTrace - The events of one thread: those still open, innermost last,
+/// and those closed, in the order they were closed.
+struct ThreadTrace {
+  unsigned Tid;
+  std::vector<TraceEvent> Open;
+  std::vector<TraceEvent> Closed;
+};
+
+/// TimeTraceProfiler - The traces of every thread that recorded an event.
+/// They are kept until llvm_shutdown, when the trace is written if
+/// -time-trace-file was given.
+class TimeTraceProfiler {
+  sys::TimeValue StartTime;
+  sys::Mutex Lock;
+  std::vector<ThreadTrace*> Threads;
+  sys::ThreadLocal<const ThreadTrace> Current;
+
+public:
+  TimeTraceProfiler() : StartTime(sys::TimeValue::now()) {}
+  ~TimeTraceProfiler();
+
+  uint64_t now() const { return (sys::TimeValue::now() - StartTime).usec(); }
+  ThreadTrace &getThreadTrace();
+  void closeEvent(ThreadTrace &Trace);
+  void write(raw_ostream &OS);
+};
+
+} // end anonymous namespace
+
+static ManagedStatic<TimeTraceProfiler> Profiler;
+static bool ProfilerInitialized = false;
+
+ThreadTrace &TimeTraceProfiler::getThreadTrace() {
+  if (const ThreadTrace *Trace = Current.get())
+    return *const_cast<ThreadTrace*>(Trace);
+
+  ThreadTrace *Trace = new ThreadTrace();
+  sys::ScopedLock Guard(Lock);
+  Trace->Tid = Threads.size();
+  Threads.push_back(Trace);
+  Current.set(Trace);
+  return *Trace;
+}
+
+void TimeTraceProfiler::closeEvent(ThreadTrace &Trace) {
+  assert(!Trace.Open.empty() && "No time trace event to end!");
+  TraceEvent &Event = Trace.Open.back();
+  Event.Duration = now() - Event.Start;
+
+  // The closed events may be written by another thread at any time.
+  sys::ScopedLock Guard(Lock);
+  Trace.Closed.push_back(Event);
+  Trace.Open.pop_back();
+}
+
+/// Write S as the contents of a JSON string.
+static void printJSONString(raw_ostream &OS, StringRef S) {
+  for (StringRef::iterator I = S.begin(), E = S.end(); I != E; ++I) {
+    unsigned char C = *I;
+    if (C == '"' || C == '\\')
+      OS << '\\' << C;
+    else if (C < 0x20)
+      OS << format("\\u%04x", static_cast<unsigned>(C));
+    else
+      OS << C;
+  }
+}
+
+void TimeTraceProfiler::write(raw_ostream &OS) {
+  sys::ScopedLock Guard(Lock);
+  OS << "{\"traceEvents\":[\n";
+  bool First = true;
+  for (unsigned i = 0, e = Threads.size(); i != e; ++i) {
+    const std::vector<TraceEvent> &Events = Threads[i]->Closed;
+    for (unsigned j = 0, je = Events.size(); j != je; ++j) {
+      const TraceEvent &Event = Events[j];
+      if (!First)
+        OS << ",\n";
+      First = false;
+      OS << "{\"pid\":1,\"tid\":" << Threads[i]->Tid
+         << ",\"ph\":\"X\",\"ts\":" << Event.Start
+         << ",\"dur\":" << Event.Duration << ",\"name\":\"";
+      printJSONString(OS, Event.Name);
+      OS << "\"";
+      if (!Event.Detail.empty()) {
+        OS << ",\"args\":{\"detail\":\"";
+        printJSONString(OS, Event.Detail);
+        OS << "\"}";
+      }
+      OS << "}";
+    }
+  }
+  OS << "\n]}\n";
+  OS.flush();
+}
+
+TimeTraceProfiler::~TimeTraceProfiler() {
+  if (!TimeTraceFile.empty()) {
+    std::string Error;
+    raw_fd_ostream OS(TimeTraceFile.c_str(), Error, sys::fs::F_None);
+    if (Error.empty())
+      write(OS);
+    else
+      errs() << "Error opening time trace file '" << TimeTraceFile
+             << "': " << Error << "\n";
+  }
+  for (unsigned i = 0, e = Threads.size(); i != e; ++i)
+    delete Threads[i];
+}
+
+void llvm::timeTraceProfilerInitialize() {
+  ProfilerInitialized = true;
+  // Create the profiler now so that times start from here.
+  *Profiler;
+}
+
+bool llvm::timeTraceProfilerEnabled() {
+  return ProfilerInitialized || !TimeTraceFile.empty();
+}
+
+void llvm::timeTraceProfilerWrite(raw_ostream &OS) {
+  Profiler->write(OS);
+}
+
+void llvm::timeTraceProfilerBegin(StringRef Name, StringRef Detail) {
+  ThreadTrace &Trace = Profiler->getThreadTrace();
+  Trace.Open.push_back(TraceEvent());
+  TraceEvent &Event = Trace.Open.back();
+  Event.Name = Name;
+  Event.Detail = Detail;
+  Event.Start = Profiler->now();
+}
+
+void llvm::timeTraceProfilerEnd() {
+  Profiler->closeEvent(Profiler->getThreadTrace());
+}
@@ -21,6 +21,7 @@
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/raw_ostream.h"
+#include <cstring>
 
 using namespace llvm;
 using namespace yaml;
@@ -159,10 +160,19 @@ private:
 
 template<>
 struct ilist_node_traits<Token> {
+  /// Tokens popped off the queue are put back in a free list and handed out
+  /// again, so the queue only ever allocates as many tokens as it held at
+  /// once.
   Token *createNode(const Token &V) {
-    return new (Alloc.Allocate<Token>()) Token(V);
+    if (FreeTokens.empty())
+      return new (Alloc.Allocate<Token>()) Token(V);
+    Token *T = FreeTokens.pop_back_val();
+    return new (T) Token(V);
+  }
+  void deleteNode(Token *V) {
+    V->~Token();
+    FreeTokens.push_back(V);
   }
-  static void deleteNode(Token *V) {}
 
   void addNodeToList(Token *) {}
   void removeNodeFromList(Token *) {}
@@ -171,6 +181,7 @@ struct ilist_node_traits<Token> {
                              ilist_iterator<Token> /*last*/) {}
 
   BumpPtrAllocator Alloc;
+  SmallVector<Token *, 16> FreeTokens;
 };
 }
 
@@ -764,13 +775,6 @@ Token Scanner::getNext() {
   // TokenQueue can be empty if there was an error getting the next token.
   if (!TokenQueue.empty())
     TokenQueue.pop_front();
-
-  // There cannot be any referenced Token's if the TokenQueue is empty. So do a
-  // quick deallocation of them all.
-  if (TokenQueue.empty()) {
-    TokenQueue.Alloc.Reset();
-  }
-
   return Ret;
 }
 
@@ -1240,8 +1244,8 @@ bool Scanner::scanFlowScalar(bool IsDoubleQuoted) {
   if (IsDoubleQuoted) {
     do {
       ++Current;
-      while (Current != End && *Current != '"')
-        ++Current;
+      const char *Quote = (const char *)memchr(Current, '"', End - Current);
+      Current = Quote ? Quote : End;
       // Repeat until the previous character was not a '\' or was an escaped
       // backslash.
     } while (   Current != End
@@ -47,6 +47,7 @@ Input::Input(StringRef InputContent,
              void *DiagHandlerCtxt)
   : IO(Ctxt),
     Strm(new Stream(InputContent, SrcMgr)),
+    TopNode(NULL),
     CurrentNode(NULL) {
   if (DiagHandler)
     SrcMgr.setDiagHandler(DiagHandler, DiagHandlerCtxt);
@@ -64,6 +65,8 @@ error_code Input::error() {
 void Input::HNode::anchor() {}
 void Input::EmptyHNode::anchor() {}
 void Input::ScalarHNode::anchor() {}
+void Input::MapHNode::anchor() {}
+void Input::SequenceHNode::anchor() {}
 
 bool Input::outputting() {
   return false;
@@ -83,8 +86,9 @@ bool Input::setCurrentDocument() {
       ++DocIterator;
       return setCurrentDocument();
     }
-    TopNode.reset(this->createHNodes(N));
-    CurrentNode = TopNode.get();
+    releaseHNodes();
+    TopNode = this->createHNodes(N);
+    CurrentNode = TopNode;
     return true;
   }
   return false;
@@ -316,9 +320,10 @@ Input::HNode *Input::createHNodes(Node *N) {
       memcpy(Buf, &StringStorage[0], Len);
       KeyStr = StringRef(Buf, Len);
     }
-    return new ScalarHNode(N, KeyStr);
+    return new (ScalarHNodeAllocator.Allocate()) ScalarHNode(N, KeyStr);
   } else if (SequenceNode *SQ = dyn_cast<SequenceNode>(N)) {
-    SequenceHNode *SQHNode = new SequenceHNode(N);
+    SequenceHNode *SQHNode =
+        new (SequenceHNodeAllocator.Allocate()) SequenceHNode(N);
     for (SequenceNode::iterator i = SQ->begin(), End = SQ->end(); i != End;
          ++i) {
       HNode *Entry = this->createHNodes(i);
@@ -328,7 +333,7 @@ Input::HNode *Input::createHNodes(Node *N) {
     }
     return SQHNode;
   } else if (MappingNode *Map = dyn_cast<MappingNode>(N)) {
-    MapHNode *mapHNode = new MapHNode(N);
+    MapHNode *mapHNode = new (MapHNodeAllocator.Allocate()) MapHNode(N);
     for (MappingNode::iterator i = Map->begin(), End = Map->end(); i != End;
          ++i) {
       ScalarNode *KeyScalar = dyn_cast<ScalarNode>(i->getKey());
@@ -348,7 +353,7 @@ Input::HNode *Input::createHNodes(Node *N) {
     }
     return mapHNode;
   } else if (isa<NullNode>(N)) {
-    return new EmptyHNode(N);
+    return new (EmptyHNodeAllocator.Allocate()) EmptyHNode(N);
   } else {
     setError(N, "unknown node kind");
     return NULL;
@@ -372,18 +377,12 @@ bool Input::canElideEmptySequence() {
   return false;
 }
 
-Input::MapHNode::~MapHNode() {
-  for (MapHNode::NameToNode::iterator i = Mapping.begin(), End = Mapping.end();
-                                                                i != End; ++i) {
-    delete i->second;
-  }
-}
-
-Input::SequenceHNode::~SequenceHNode() {
-  for (std::vector<HNode*>::iterator i = Entries.begin(), End = Entries.end();
-                                                                i != End; ++i) {
-    delete *i;
-  }
+void Input::releaseHNodes() {
+  TopNode = CurrentNode = NULL;
+  EmptyHNodeAllocator.DestroyAll();
+  ScalarHNodeAllocator.DestroyAll();
+  MapHNodeAllocator.DestroyAll();
+  SequenceHNodeAllocator.DestroyAll();
 }
 
 
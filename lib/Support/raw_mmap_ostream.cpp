@@ -0,0 +1,114 @@
+//===--- raw_mmap_ostream.cpp - Implement the raw_mmap_ostream class ------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This implements support for writing files through a memory mapping.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/raw_mmap_ostream.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/system_error.h"
+#include <algorithm>
+#include <cstring>
+using namespace llvm;
+
+static cl::opt<bool>
+MmapOutput("mmap-output", cl::Hidden, cl::init(true),
+           cl::desc("Write object and bitcode files through a memory "
+                    "mapping"));
+
+/// The size of the file when it is created, and the least room kept free
+/// after the bytes written.
+static const uint64_t MinMappedSize = 1 << 20;
+static const uint64_t MinFreeSize = 64 * 1024;
+
+raw_mmap_ostream::raw_mmap_ostream(StringRef Filename, std::string &ErrorInfo,
+                                   unsigned Flags)
+  : Pos(0), Mapped(0), Error(false), Keep(false) {
+  ErrorInfo.clear();
+  if (error_code EC = FileOutputBuffer::create(Filename, MinMappedSize, Buffer,
+                                               Flags)) {
+    ErrorInfo = "Error opening output file '" + Filename.str() + "': " +
+                EC.message();
+    return;
+  }
+  mapBuffer();
+}
+
+raw_mmap_ostream::~raw_mmap_ostream() {
+  if (Buffer) {
+    flush();
+    if (Keep && !Error)
+      if (Buffer->commit(Pos))
+        Error = true;
+  }
+
+  // As in raw_fd_ostream, clients wishing to avoid report_fatal_error calls
+  // should check for errors with has_error() and clear the error flag with
+  // clear_error() first.
+  if (has_error())
+    report_fatal_error("IO failure on output stream.", /*GenCrashDiag=*/false);
+}
+
+bool raw_mmap_ostream::reserve(uint64_t Size) {
+  uint64_t Capacity = Buffer->getBufferSize();
+  if (Pos + Size <= Capacity)
+    return true;
+
+  // Grow geometrically so that a large file is remapped only a few times.
+  uint64_t NewCapacity = std::max(Capacity * 2, Pos + Size);
+  if (Buffer->extend(NewCapacity)) {
+    Error = true;
+    return false;
+  }
+  return true;
+}
+
+void raw_mmap_ostream::mapBuffer() {
+  if (!reserve(MinFreeSize)) {
+    // Keep going without a mapping; the bytes written from here on are lost
+    // and the error is reported when the stream is destroyed.
+    Mapped = 0;
+    SetUnbuffered();
+    return;
+  }
+  char *Start = reinterpret_cast<char*>(Buffer->getBufferStart()) + Pos;
+  Mapped = Start;
+  SetBuffer(Start, Buffer->getBufferSize() - Pos);
+}
+
+void raw_mmap_ostream::write_impl(const char *Ptr, size_t Size) {
+  if (Error)
+    return;
+
+  // A stream buffered in the mapping flushes bytes that are already in
+  // place; anything else is copied in.  Clients such as formatted_raw_ostream
+  // may give the stream a buffer of its own or make it unbuffered.
+  bool InPlace = Mapped && Ptr == Mapped;
+  if (!InPlace) {
+    if (!reserve(Size))
+      return;
+    memcpy(Buffer->getBufferStart() + Pos, Ptr, Size);
+  }
+  Pos += Size;
+
+  if (Mapped && getBufferStart() == Mapped)
+    mapBuffer();
+}
+
+bool raw_mmap_ostream::shouldUse(StringRef Filename) {
+  if (!MmapOutput || Filename == "-")
+    return false;
+  sys::fs::file_status Status;
+  if (sys::fs::status(Filename, Status))
+    return Status.type() == sys::fs::file_type::file_not_found;
+  return sys::fs::is_regular_file(Status);
+}
@@ -104,19 +104,56 @@ void raw_ostream::SetBufferAndMode(char *BufferStart, size_t Size,
   assert(OutBufStart <= OutBufEnd && "Invalid size!");
 }
 
-raw_ostream &raw_ostream::operator<<(unsigned long N) {
-  // Zero is a special case.
-  if (N == 0)
-    return *this << '0';
+/// TwoDigits - The decimal digits of 00 to 99, two characters each.
+static const char TwoDigits[] =
+  "00010203040506070809"
+  "10111213141516171819"
+  "20212223242526272829"
+  "30313233343536373839"
+  "40414243444546474849"
+  "50515253545556575859"
+  "60616263646566676869"
+  "70717273747576777879"
+  "80818283848586878889"
+  "90919293949596979899";
+
+/// formatDecimal - Write the decimal digits of N backwards from EndPtr, two
+/// at a time, and return a pointer to the first digit.
+template <typename T>
+static char *formatDecimal(T N, char *EndPtr) {
+  char *CurPtr = EndPtr;
+  while (N >= 100) {
+    unsigned Index = static_cast<unsigned>(N % 100) * 2;
+    N /= 100;
+    *--CurPtr = TwoDigits[Index + 1];
+    *--CurPtr = TwoDigits[Index];
+  }
+  if (N < 10) {
+    *--CurPtr = char('0' + N);
+  } else {
+    unsigned Index = static_cast<unsigned>(N) * 2;
+    *--CurPtr = TwoDigits[Index + 1];
+    *--CurPtr = TwoDigits[Index];
+  }
+  return CurPtr;
+}
 
-  char NumberBuffer[20];
-  char *EndPtr = NumberBuffer+sizeof(NumberBuffer);
+/// formatHex - Write the hexadecimal digits of N backwards from EndPtr and
+/// return a pointer to the first digit.
+static char *formatHex(uint64_t N, char *EndPtr, bool Upper) {
+  const char *Digits = Upper ? "0123456789ABCDEF" : "0123456789abcdef";
   char *CurPtr = EndPtr;
+  do {
+    *--CurPtr = Digits[N & 15];
+    N >>= 4;
+  } while (N);
+  return CurPtr;
+}
 
-  while (N) {
-    *--CurPtr = '0' + char(N % 10);
-    N /= 10;
-  }
+raw_ostream &raw_ostream::operator<<(unsigned long N) {
+  char NumberBuffer[20];
+  char *EndPtr = NumberBuffer+sizeof(NumberBuffer);
+  char *CurPtr = formatDecimal(N, EndPtr);
   return write(CurPtr, EndPtr-CurPtr);
 }
 
@@ -137,12 +174,7 @@ raw_ostream &raw_ostream::operator<<(unsigned long long N) {
 
   char NumberBuffer[20];
   char *EndPtr = NumberBuffer+sizeof(NumberBuffer);
-  char *CurPtr = EndPtr;
-
-  while (N) {
-    *--CurPtr = '0' + char(N % 10);
-    N /= 10;
-  }
+  char *CurPtr = formatDecimal(N, EndPtr);
   return write(CurPtr, EndPtr-CurPtr);
 }
 
@@ -157,21 +189,50 @@ raw_ostream &raw_ostream::operator<<(long long N) {
 }
 
 raw_ostream &raw_ostream::write_hex(unsigned long long N) {
-  // Zero is a special case.
-  if (N == 0)
-    return *this << '0';
+  char NumberBuffer[16];
+  char *EndPtr = NumberBuffer+sizeof(NumberBuffer);
+  char *CurPtr = formatHex(N, EndPtr, /*Upper=*/false);
+  return write(CurPtr, EndPtr-CurPtr);
+}
 
-  char NumberBuffer[20];
+/// writeZeros - Output NumZeros '0' characters.
+static void writeZeros(raw_ostream &OS, unsigned NumZeros) {
+  static const char Zeros[] = "0000000000000000";
+  const unsigned ArraySize = sizeof(Zeros) - 1;
+  while (NumZeros > ArraySize) {
+    OS.write(Zeros, ArraySize);
+    NumZeros -= ArraySize;
+  }
+  OS.write(Zeros, NumZeros);
+}
+
+raw_ostream &raw_ostream::operator<<(const FormattedNumber &FN) {
+  char NumberBuffer[21];
   char *EndPtr = NumberBuffer+sizeof(NumberBuffer);
-  char *CurPtr = EndPtr;
 
-  while (N) {
-    uintptr_t x = N % 16;
-    *--CurPtr = (x < 10 ? '0' + x : 'a' + x - 10);
-    N /= 16;
+  if (FN.Hex) {
+    char *CurPtr = formatHex(FN.HexValue, EndPtr, FN.Upper);
+    unsigned Len = EndPtr - CurPtr;
+    unsigned Width = FN.Width;
+    if (FN.HexPrefix) {
+      *this << '0' << 'x';
+      Width = Width > 2 ? Width - 2 : 0;
+    }
+    if (Width > Len)
+      writeZeros(*this, Width - Len);
+    return write(CurPtr, Len);
   }
 
-  return write(CurPtr, EndPtr-CurPtr);
+  // Avoid undefined behavior on INT64_MIN with a cast.
+  bool Negative = FN.DecValue < 0;
+  uint64_t N = Negative ? -(uint64_t)FN.DecValue : FN.DecValue;
+  char *CurPtr = formatDecimal(N, EndPtr);
+  if (Negative)
+    *--CurPtr = '-';
+  unsigned Len = EndPtr - CurPtr;
+  if (FN.Width > Len)
+    indent(FN.Width - Len);
+  return write(CurPtr, Len);
 }
 
 raw_ostream &raw_ostream::write_escaped(StringRef Str,
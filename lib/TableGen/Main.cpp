@@ -29,9 +29,9 @@
 using namespace llvm;
 
 namespace {
-  cl::opt<std::string>
-  OutputFilename("o", cl::desc("Output filename"), cl::value_desc("filename"),
-                 cl::init("-"));
+  cl::list<std::string>
+  OutputFilenames("o", cl::desc("Output filename, once per action"),
+                  cl::value_desc("filename"));
 
   cl::opt<std::string>
   DependFilename("d",
@@ -52,7 +52,8 @@ namespace {
 /// This functionality is really only for the benefit of the build system.
 /// It is similar to GCC's `-M*` family of options.
 static int createDependencyFile(const TGParser &Parser, const char *argv0) {
-  if (OutputFilename == "-") {
+  if (std::find(OutputFilenames.begin(), OutputFilenames.end(), "-") !=
+      OutputFilenames.end()) {
     errs() << argv0 << ": the option -d must be used together with -o\n";
     return 1;
   }
@@ -63,7 +64,9 @@ static int createDependencyFile(const TGParser &Parser, const char *argv0) {
       << ":" << Error << "\n";
     return 1;
   }
-  DepOut.os() << OutputFilename << ":";
+  for (unsigned i = 0, e = OutputFilenames.size(); i != e; ++i)
+    DepOut.os() << (i ? " " : "") << OutputFilenames[i];
+  DepOut.os() << ":";
   const TGLexer::DependenciesMapTy &Dependencies = Parser.getDependencies();
   for (TGLexer::DependenciesMapTy::const_iterator I = Dependencies.begin(),
                                                   E = Dependencies.end();
@@ -75,9 +78,20 @@ static int createDependencyFile(const TGParser &Parser, const char *argv0) {
   return 0;
 }
 
-namespace llvm {
+/// \brief Parse the input and run either MainFn, or MultiFn once for each of
+/// the NumActions outputs.
+static int runTableGen(char *argv0, TableGenMainFn *MainFn,
+                       TableGenMultiMainFn *MultiFn, unsigned NumActions) {
+  if (OutputFilenames.size() > NumActions ||
+      (NumActions > 1 && OutputFilenames.size() != NumActions)) {
+    errs() << argv0 << ": expected " << NumActions << " output file"
+           << (NumActions > 1 ? "s" : "") << ", got "
+           << OutputFilenames.size() << "\n";
+    return 1;
+  }
+  if (OutputFilenames.empty())
+    OutputFilenames.push_back("-");
 
-int TableGenMain(char *argv0, TableGenMainFn *MainFn) {
   RecordKeeper Records;
 
   // Parse the input file.
@@ -102,29 +116,44 @@ int TableGenMain(char *argv0, TableGenMainFn *MainFn) {
   if (Parser.ParseFile())
     return 1;
 
-  std::string Error;
-  tool_output_file Out(OutputFilename.c_str(), Error);
-  if (!Error.empty()) {
-    errs() << argv0 << ": error opening " << OutputFilename
-      << ":" << Error << "\n";
-    return 1;
-  }
   if (!DependFilename.empty()) {
     if (int Ret = createDependencyFile(Parser, argv0))
       return Ret;
   }
 
-  if (MainFn(Out.os(), Records))
-    return 1;
-
-  if (ErrorsPrinted > 0) {
-    errs() << argv0 << ": " << ErrorsPrinted << " errors.\n";
-    return 1;
+  for (unsigned i = 0; i != NumActions; ++i) {
+    std::string Error;
+    tool_output_file Out(OutputFilenames[i].c_str(), Error);
+    if (!Error.empty()) {
+      errs() << argv0 << ": error opening " << OutputFilenames[i]
+        << ":" << Error << "\n";
+      return 1;
+    }
+
+    if (MainFn ? MainFn(Out.os(), Records) : MultiFn(Out.os(), Records, i))
+      return 1;
+
+    if (ErrorsPrinted > 0) {
+      errs() << argv0 << ": " << ErrorsPrinted << " errors.\n";
+      return 1;
+    }
+
+    // Declare success.
+    Out.keep();
   }
-
-  // Declare success.
-  Out.keep();
   return 0;
 }
 
+namespace llvm {
+
+int TableGenMain(char *argv0, TableGenMainFn *MainFn) {
+  return runTableGen(argv0, MainFn, 0, 1);
+}
+
+int TableGenMain(char *argv0, TableGenMultiMainFn *MainFn,
+                 unsigned NumActions) {
+  assert(NumActions && "No action to perform");
+  return runTableGen(argv0, 0, MainFn, NumActions);
+}
+
 }
@@ -522,10 +522,13 @@ Init *BitsInit::resolveReferences(Record &R, const RecordVal *RV) const {
 
   for (unsigned i = 0, e = getNumBits(); i != e; ++i) {
     Init *CurBit = Bits[i];
-    Init *CurBitVar = CurBit->getBitVar();
-
     NewBits[i] = CurBit;
 
+    // Constant bits never change.
+    if (isa<BitInit>(CurBit))
+      continue;
+    Init *CurBitVar = CurBit->getBitVar();
+
     if (CurBitVar == CachedBitVar) {
       if (CachedBitVarChanged) {
         Init *Bit = CachedInit->getBit(CurBit->getBitNum());
@@ -1385,6 +1388,10 @@ Init *VarInit::getFieldInit(Record &R, const RecordVal *RV,
 /// users of the value to allow the value to propagate out.
 ///
 Init *VarInit::resolveReferences(Record &R, const RecordVal *RV) const {
+  // When resolving a single value, only references to it change. This avoids
+  // searching the record for every variable in it.
+  if (RV && RV->getNameInit() != VarName)
+    return const_cast<VarInit *>(this);
   if (RecordVal *Val = R.getValue(VarName))
     if (RV == Val || (RV == 0 && !isa<UnsetInit>(Val->getValue())))
       return Val->getValue();
@@ -1723,8 +1730,12 @@ void Record::resolveReferencesTo(const RecordVal *RV) {
   for (unsigned i = 0, e = Values.size(); i != e; ++i) {
     if (RV == &Values[i]) // Skip resolve the same field as the given one
       continue;
-    if (Init *V = Values[i].getValue())
-      if (Values[i].setValue(V->resolveReferences(*this, RV)))
+    if (Init *V = Values[i].getValue()) {
+      Init *NewV = V->resolveReferences(*this, RV);
+      // The value was converted to the field's type when it was set.
+      if (NewV == V)
+        continue;
+      if (Values[i].setValue(NewV))
         PrintFatalError(getLoc(), "Invalid value is found when setting '"
                       + Values[i].getNameInitAsString()
                       + "' after resolving references"
@@ -1733,6 +1744,7 @@ void Record::resolveReferencesTo(const RecordVal *RV) {
                               + RV->getValue()->getAsUnquotedString() + ")"
                             : "")
                       + "\n");
+    }
   }
   Init *OldName = getNameInit();
   Init *NewName = Name->resolveReferences(*this, RV);
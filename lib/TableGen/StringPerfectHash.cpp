@@ -0,0 +1,175 @@
+//===- StringPerfectHash.cpp - Generate perfect hash tables ---------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the StringPerfectHash class.  Each key is hashed once
+// to 64 bits.  Keys are then split into buckets by mixing that hash with a
+// fixed seed, and starting with the largest bucket, a seed is searched for
+// each bucket that sends all of its keys to distinct free slots ("hash and
+// displace").
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/TableGen/StringPerfectHash.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+using namespace llvm;
+
+/// The average number of keys per bucket.  Larger buckets give smaller seed
+/// tables but make the seed search slower.
+static const unsigned KeysPerBucket = 4;
+
+/// The number of seeds to try for a bucket before growing the table.
+static const uint32_t MaxSeedTries = 1U << 16;
+
+uint64_t StringPerfectHash::hash(StringRef S) {
+  // 64-bit FNV-1a.
+  uint64_t H = 14695981039346656037ULL;
+  for (unsigned i = 0, e = S.size(); i != e; ++i)
+    H = (H ^ (unsigned char)S[i]) * 1099511628211ULL;
+  return H;
+}
+
+uint32_t StringPerfectHash::mix(uint64_t H, uint32_t Seed) {
+  // The MurmurHash3 finalizer, so that every bit of the hash and the seed
+  // affects the low bits, which select the bucket and the slot.
+  H ^= Seed * 0x9E3779B97F4A7C15ULL;
+  H ^= H >> 33;
+  H *= 0xFF51AFD7ED558CCDULL;
+  H ^= H >> 33;
+  return uint32_t(H);
+}
+
+namespace {
+/// BucketSizeGreater - Order bucket indices by decreasing size.
+struct BucketSizeGreater {
+  const std::vector<std::vector<unsigned> > &Buckets;
+  BucketSizeGreater(const std::vector<std::vector<unsigned> > &B)
+    : Buckets(B) {}
+  bool operator()(unsigned LHS, unsigned RHS) const {
+    if (Buckets[LHS].size() != Buckets[RHS].size())
+      return Buckets[LHS].size() > Buckets[RHS].size();
+    return LHS < RHS;
+  }
+};
+} // end anonymous namespace
+
+StringPerfectHash::StringPerfectHash(const std::vector<std::string> &keys)
+  : Keys(keys) {
+  unsigned NumKeys = Keys.size();
+  unsigned NumBuckets = NumKeys / KeysPerBucket + 1;
+
+  // Keys with equal hashes could never be given distinct slots.
+  std::vector<uint64_t> Hashes;
+  for (unsigned i = 0; i != NumKeys; ++i) {
+    assert(!Keys[i].empty() && "Empty keys cannot be hashed");
+    Hashes.push_back(hash(Keys[i]));
+  }
+  std::vector<uint64_t> Sorted(Hashes);
+  std::sort(Sorted.begin(), Sorted.end());
+  if (std::adjacent_find(Sorted.begin(), Sorted.end()) != Sorted.end())
+    report_fatal_error("Duplicate key in perfect hash table");
+
+  std::vector<std::vector<unsigned> > Buckets(NumBuckets);
+  for (unsigned i = 0; i != NumKeys; ++i)
+    Buckets[mix(Hashes[i], 0) % NumBuckets].push_back(i);
+
+  std::vector<unsigned> Order;
+  for (unsigned i = 0; i != NumBuckets; ++i)
+    Order.push_back(i);
+  std::sort(Order.begin(), Order.end(), BucketSizeGreater(Buckets));
+
+  // Start with a minimal table and grow it if some bucket cannot be placed.
+  for (unsigned NumSlots = std::max(NumKeys, 1U); ; ++NumSlots) {
+    Seeds.assign(NumBuckets, 0);
+    SlotKeys.assign(NumSlots, -1);
+    KeySlots.assign(NumKeys, 0);
+
+    bool Placed = true;
+    std::vector<unsigned> Tried;
+    for (unsigned b = 0; b != NumBuckets && Placed; ++b) {
+      const std::vector<unsigned> &Bucket = Buckets[Order[b]];
+      if (Bucket.empty())
+        break;
+
+      Placed = false;
+      for (uint32_t Seed = 1; Seed != MaxSeedTries && !Placed; ++Seed) {
+        Tried.clear();
+        bool Fits = true;
+        for (unsigned k = 0, ke = Bucket.size(); k != ke && Fits; ++k) {
+          unsigned Slot = mix(Hashes[Bucket[k]], Seed) % NumSlots;
+          Fits = SlotKeys[Slot] == -1 &&
+                 std::find(Tried.begin(), Tried.end(), Slot) == Tried.end();
+          Tried.push_back(Slot);
+        }
+        if (!Fits)
+          continue;
+
+        Seeds[Order[b]] = Seed;
+        for (unsigned k = 0, ke = Bucket.size(); k != ke; ++k) {
+          SlotKeys[Tried[k]] = Bucket[k];
+          KeySlots[Bucket[k]] = Tried[k];
+        }
+        Placed = true;
+      }
+    }
+
+    if (Placed)
+      return;
+  }
+}
+
+void StringPerfectHash::emit(raw_ostream &OS, StringRef Name,
+                             unsigned Indent) const {
+  std::string Pad(Indent * 2, ' ');
+
+  OS << Pad << "static const uint32_t " << Name << "Seeds[] = {";
+  for (unsigned i = 0, e = Seeds.size(); i != e; ++i)
+    OS << (i % 12 ? " " : "\n" + Pad + "  ") << Seeds[i] << ",";
+  OS << "\n" << Pad << "};\n";
+
+  OS << Pad << "static const char *const " << Name << "Keys[] = {\n";
+  for (unsigned i = 0, e = SlotKeys.size(); i != e; ++i) {
+    OS << Pad << "  \"";
+    if (SlotKeys[i] != -1)
+      OS.write_escaped(Keys[SlotKeys[i]]);
+    OS << "\",\n";
+  }
+  OS << Pad << "};\n";
+
+  OS << Pad << "struct " << Name << " {\n";
+  OS << Pad << "  static uint64_t hashInit() {\n";
+  OS << Pad << "    return 14695981039346656037ULL;\n";
+  OS << Pad << "  }\n";
+  OS << Pad << "  static uint64_t hashStep(uint64_t H, char C) {\n";
+  OS << Pad << "    return (H ^ (unsigned char)C) * 1099511628211ULL;\n";
+  OS << Pad << "  }\n";
+  OS << Pad << "  static uint32_t mix(uint64_t H, uint32_t Seed) {\n";
+  OS << Pad << "    H ^= Seed * 0x9E3779B97F4A7C15ULL;\n";
+  OS << Pad << "    H ^= H >> 33;\n";
+  OS << Pad << "    H *= 0xFF51AFD7ED558CCDULL;\n";
+  OS << Pad << "    H ^= H >> 33;\n";
+  OS << Pad << "    return uint32_t(H);\n";
+  OS << Pad << "  }\n";
+  OS << Pad << "  static int lookup(StringRef Key, uint64_t H) {\n";
+  OS << Pad << "    uint32_t Seed = " << Name << "Seeds[mix(H, 0) % "
+     << Seeds.size() << "];\n";
+  OS << Pad << "    uint32_t Slot = mix(H, Seed) % " << SlotKeys.size()
+     << ";\n";
+  OS << Pad << "    return !Key.empty() && Key == " << Name
+     << "Keys[Slot] ? int(Slot) : -1;\n";
+  OS << Pad << "  }\n";
+  OS << Pad << "  static int lookup(StringRef Key) {\n";
+  OS << Pad << "    uint64_t H = hashInit();\n";
+  OS << Pad << "    for (unsigned i = 0, e = Key.size(); i != e; ++i)\n";
+  OS << Pad << "      H = hashStep(H, Key[i]);\n";
+  OS << Pad << "    return lookup(Key, H);\n";
+  OS << Pad << "  }\n";
+  OS << Pad << "};\n";
+}
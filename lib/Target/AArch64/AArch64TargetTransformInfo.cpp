@@ -0,0 +1,465 @@
+//===-- AArch64TargetTransformInfo.cpp - AArch64 specific TTI pass --------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file implements a TargetTransformInfo analysis pass specific to the
+/// AArch64 target machine. It uses the target's detailed information to
+/// provide more precise answers to certain TTI queries, while letting the
+/// target independent and default TTI implementations handle the rest.
+///
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "aarch64tti"
+#include "AArch64.h"
+#include "AArch64TargetMachine.h"
+#include "Utils/AArch64BaseInfo.h"
+#include "llvm/Analysis/TargetTransformInfo.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Target/CostTable.h"
+#include "llvm/Target/TargetLowering.h"
+using namespace llvm;
+
+// Declare the pass initialization routine locally as target-specific passes
+// don't have a target-wide initialization entry point, and so we rely on the
+// pass constructor initialization.
+namespace llvm {
+void initializeAArch64TTIPass(PassRegistry &);
+}
+
+namespace {
+
+class AArch64TTI : public ImmutablePass, public TargetTransformInfo {
+  const AArch64TargetMachine *TM;
+  const AArch64Subtarget *ST;
+  const AArch64TargetLowering *TLI;
+
+public:
+  AArch64TTI() : ImmutablePass(ID), TM(0), ST(0), TLI(0) {
+    llvm_unreachable("This pass cannot be directly constructed");
+  }
+
+  AArch64TTI(const AArch64TargetMachine *TM)
+      : ImmutablePass(ID), TM(TM), ST(TM->getSubtargetImpl()),
+        TLI(TM->getTargetLowering()) {
+    initializeAArch64TTIPass(*PassRegistry::getPassRegistry());
+  }
+
+  virtual void initializePass() {
+    pushTTIStack(this);
+  }
+
+  virtual void finalizePass() {
+    popTTIStack();
+  }
+
+  virtual void getAnalysisUsage(AnalysisUsage &AU) const {
+    TargetTransformInfo::getAnalysisUsage(AU);
+  }
+
+  /// Pass identification.
+  static char ID;
+
+  /// Provide necessary pointer adjustments for the two base classes.
+  virtual void *getAdjustedAnalysisPointer(const void *ID) {
+    if (ID == &TargetTransformInfo::ID)
+      return (TargetTransformInfo*)this;
+    return this;
+  }
+
+  /// \name Scalar TTI Implementations
+  /// @{
+
+  virtual unsigned getIntImmCost(const APInt &Imm, Type *Ty) const;
+
+  /// @}
+
+
+  /// \name Vector TTI Implementations
+  /// @{
+
+  unsigned getNumberOfRegisters(bool Vector) const {
+    if (Vector) {
+      if (ST->hasNEON())
+        return 32;
+      return 0;
+    }
+    return 31;
+  }
+
+  unsigned getRegisterBitWidth(bool Vector) const {
+    if (Vector) {
+      if (ST->hasNEON())
+        return 128;
+      return 0;
+    }
+    return 64;
+  }
+
+  unsigned getMaximumUnrollFactor() const {
+    // ARMv8 cores issue at least two NEON operations per cycle, and the
+    // register file is big enough to keep two interleaved iterations live.
+    return 2;
+  }
+
+  unsigned getShuffleCost(ShuffleKind Kind, Type *Tp,
+                          int Index, Type *SubTp) const;
+
+  unsigned getCastInstrCost(unsigned Opcode, Type *Dst,
+                            Type *Src) const;
+
+  unsigned getCmpSelInstrCost(unsigned Opcode, Type *ValTy, Type *CondTy) const;
+
+  unsigned getVectorInstrCost(unsigned Opcode, Type *Val, unsigned Index) const;
+
+  unsigned getAddressComputationCost(Type *Val, bool IsComplex) const;
+
+  unsigned getArithmeticInstrCost(unsigned Opcode, Type *Ty,
+                                  OperandValueKind Op1Info = OK_AnyValue,
+                                  OperandValueKind Op2Info = OK_AnyValue) const;
+  /// @}
+};
+
+} // end anonymous namespace
+
+INITIALIZE_AG_PASS(AArch64TTI, TargetTransformInfo, "aarch64tti",
+                   "AArch64 Target Transform Info", true, true, false)
+char AArch64TTI::ID = 0;
+
+ImmutablePass *
+llvm::createAArch64TargetTransformInfoPass(const AArch64TargetMachine *TM) {
+  return new AArch64TTI(TM);
+}
+
+
+unsigned AArch64TTI::getIntImmCost(const APInt &Imm, Type *Ty) const {
+  assert(Ty->isIntegerTy());
+
+  unsigned Bits = Ty->getPrimitiveSizeInBits();
+  if (Bits == 0 || Bits > 64)
+    return 4;
+
+  unsigned RegWidth = Bits <= 32 ? 32 : 64;
+  uint64_t Val = Imm.getZExtValue();
+  if (RegWidth == 32)
+    Val &= 0xffffffffULL;
+
+  // A bitmask immediate is a single ORR from the zero register.
+  uint32_t Encoding;
+  if (Val != 0 && A64Imms::isLogicalImm(RegWidth, Val, Encoding))
+    return 1;
+
+  // Otherwise the value is built 16 bits at a time by a MOVZ or MOVN and a
+  // MOVK for each further chunk that is not all zeros or all ones.
+  unsigned ZeroChunks = 0, OnesChunks = 0;
+  for (unsigned Shift = 0; Shift < RegWidth; Shift += 16) {
+    uint64_t Chunk = (Val >> Shift) & 0xffff;
+    ZeroChunks += Chunk == 0;
+    OnesChunks += Chunk == 0xffff;
+  }
+  unsigned NumChunks = RegWidth / 16;
+  unsigned Cost = NumChunks - std::max(ZeroChunks, OnesChunks);
+  return std::max(Cost, 1U);
+}
+
+unsigned AArch64TTI::getCastInstrCost(unsigned Opcode, Type *Dst,
+                                      Type *Src) const {
+  int ISD = TLI->InstructionOpcodeToISD(Opcode);
+  assert(ISD && "Invalid opcode");
+
+  EVT SrcTy = TLI->getValueType(Src);
+  EVT DstTy = TLI->getValueType(Dst);
+
+  if (!SrcTy.isSimple() || !DstTy.isSimple())
+    return TargetTransformInfo::getCastInstrCost(Opcode, Dst, Src);
+
+  // The number of xtn, sxtl/uxtl, fcvtn/fcvtl and int <-> fp instructions
+  // each conversion takes on NEON.
+  static const TypeConversionCostTblEntry<MVT::SimpleValueType>
+  NEONVectorConversionTbl[] = {
+    // Truncations narrow one half of the element width per xtn.
+    { ISD::TRUNCATE,    MVT::v4i16, MVT::v4i32, 1 },
+    { ISD::TRUNCATE,    MVT::v8i8,  MVT::v8i16, 1 },
+    { ISD::TRUNCATE,    MVT::v2i32, MVT::v2i64, 1 },
+    { ISD::TRUNCATE,    MVT::v4i32, MVT::v4i64, 2 },
+    { ISD::TRUNCATE,    MVT::v8i16, MVT::v8i32, 2 },
+    { ISD::TRUNCATE,    MVT::v16i8, MVT::v16i16, 2 },
+    { ISD::TRUNCATE,    MVT::v8i8,  MVT::v8i32, 3 },
+    { ISD::TRUNCATE,    MVT::v16i8, MVT::v16i32, 6 },
+
+    // Extensions double the element width per sxtl/uxtl.
+    { ISD::SIGN_EXTEND, MVT::v8i16, MVT::v8i8,  1 },
+    { ISD::ZERO_EXTEND, MVT::v8i16, MVT::v8i8,  1 },
+    { ISD::SIGN_EXTEND, MVT::v4i32, MVT::v4i16, 1 },
+    { ISD::ZERO_EXTEND, MVT::v4i32, MVT::v4i16, 1 },
+    { ISD::SIGN_EXTEND, MVT::v2i64, MVT::v2i32, 1 },
+    { ISD::ZERO_EXTEND, MVT::v2i64, MVT::v2i32, 1 },
+    { ISD::SIGN_EXTEND, MVT::v16i16, MVT::v16i8, 2 },
+    { ISD::ZERO_EXTEND, MVT::v16i16, MVT::v16i8, 2 },
+    { ISD::SIGN_EXTEND, MVT::v8i32, MVT::v8i16, 2 },
+    { ISD::ZERO_EXTEND, MVT::v8i32, MVT::v8i16, 2 },
+    { ISD::SIGN_EXTEND, MVT::v4i64, MVT::v4i32, 2 },
+    { ISD::ZERO_EXTEND, MVT::v4i64, MVT::v4i32, 2 },
+    { ISD::SIGN_EXTEND, MVT::v8i32, MVT::v8i8,  3 },
+    { ISD::ZERO_EXTEND, MVT::v8i32, MVT::v8i8,  3 },
+    { ISD::SIGN_EXTEND, MVT::v4i64, MVT::v4i16, 3 },
+    { ISD::ZERO_EXTEND, MVT::v4i64, MVT::v4i16, 3 },
+    { ISD::SIGN_EXTEND, MVT::v16i32, MVT::v16i8, 6 },
+    { ISD::ZERO_EXTEND, MVT::v16i32, MVT::v16i8, 6 },
+
+    // Single to/from double precision conversions.
+    { ISD::FP_EXTEND,   MVT::v2f64, MVT::v2f32, 1 },
+    { ISD::FP_EXTEND,   MVT::v4f64, MVT::v4f32, 2 },
+    { ISD::FP_ROUND,    MVT::v2f32, MVT::v2f64, 1 },
+    { ISD::FP_ROUND,    MVT::v4f32, MVT::v4f64, 2 },
+
+    // Integer to floating point conversions of the same element width are an
+    // scvtf/ucvtf per register; narrower integers are extended first.
+    { ISD::SINT_TO_FP,  MVT::v2f32, MVT::v2i32, 1 },
+    { ISD::UINT_TO_FP,  MVT::v2f32, MVT::v2i32, 1 },
+    { ISD::SINT_TO_FP,  MVT::v4f32, MVT::v4i32, 1 },
+    { ISD::UINT_TO_FP,  MVT::v4f32, MVT::v4i32, 1 },
+    { ISD::SINT_TO_FP,  MVT::v2f64, MVT::v2i64, 1 },
+    { ISD::UINT_TO_FP,  MVT::v2f64, MVT::v2i64, 1 },
+    { ISD::SINT_TO_FP,  MVT::v4f32, MVT::v4i16, 2 },
+    { ISD::UINT_TO_FP,  MVT::v4f32, MVT::v4i16, 2 },
+    { ISD::SINT_TO_FP,  MVT::v4f32, MVT::v4i8,  3 },
+    { ISD::UINT_TO_FP,  MVT::v4f32, MVT::v4i8,  3 },
+    { ISD::SINT_TO_FP,  MVT::v2f64, MVT::v2i32, 2 },
+    { ISD::UINT_TO_FP,  MVT::v2f64, MVT::v2i32, 2 },
+    { ISD::SINT_TO_FP,  MVT::v8f32, MVT::v8i32, 2 },
+    { ISD::UINT_TO_FP,  MVT::v8f32, MVT::v8i32, 2 },
+    { ISD::SINT_TO_FP,  MVT::v8f32, MVT::v8i16, 4 },
+    { ISD::UINT_TO_FP,  MVT::v8f32, MVT::v8i16, 4 },
+
+    // Floating point to integer conversions, narrowing the result as needed.
+    { ISD::FP_TO_SINT,  MVT::v2i32, MVT::v2f32, 1 },
+    { ISD::FP_TO_UINT,  MVT::v2i32, MVT::v2f32, 1 },
+    { ISD::FP_TO_SINT,  MVT::v4i32, MVT::v4f32, 1 },
+    { ISD::FP_TO_UINT,  MVT::v4i32, MVT::v4f32, 1 },
+    { ISD::FP_TO_SINT,  MVT::v2i64, MVT::v2f64, 1 },
+    { ISD::FP_TO_UINT,  MVT::v2i64, MVT::v2f64, 1 },
+    { ISD::FP_TO_SINT,  MVT::v4i16, MVT::v4f32, 2 },
+    { ISD::FP_TO_UINT,  MVT::v4i16, MVT::v4f32, 2 },
+    { ISD::FP_TO_SINT,  MVT::v2i32, MVT::v2f64, 2 },
+    { ISD::FP_TO_UINT,  MVT::v2i32, MVT::v2f64, 2 },
+    { ISD::FP_TO_SINT,  MVT::v8i32, MVT::v8f32, 2 },
+    { ISD::FP_TO_UINT,  MVT::v8i32, MVT::v8f32, 2 },
+    { ISD::FP_TO_SINT,  MVT::v8i16, MVT::v8f32, 3 },
+    { ISD::FP_TO_UINT,  MVT::v8i16, MVT::v8f32, 3 }
+  };
+
+  if (SrcTy.isVector() && ST->hasNEON()) {
+    int Idx = ConvertCostTableLookup(NEONVectorConversionTbl, ISD,
+                                     DstTy.getSimpleVT(), SrcTy.getSimpleVT());
+    if (Idx != -1)
+      return NEONVectorConversionTbl[Idx].Cost;
+  }
+
+  // Scalar conversions between integer and floating point registers are a
+  // single scvtf/ucvtf/fcvtzs/fcvtzu whatever the integer width.
+  if (!SrcTy.isVector() && ST->hasFPARMv8() &&
+      (ISD == ISD::SINT_TO_FP || ISD == ISD::UINT_TO_FP ||
+       ISD == ISD::FP_TO_SINT || ISD == ISD::FP_TO_UINT)) {
+    EVT IntTy = ISD == ISD::SINT_TO_FP || ISD == ISD::UINT_TO_FP ? SrcTy
+                                                                 : DstTy;
+    EVT FPTy = IntTy == SrcTy ? DstTy : SrcTy;
+    if (IntTy.getSizeInBits() <= 64 &&
+        (FPTy == MVT::f32 || FPTy == MVT::f64))
+      return 1;
+  }
+
+  return TargetTransformInfo::getCastInstrCost(Opcode, Dst, Src);
+}
+
+unsigned AArch64TTI::getVectorInstrCost(unsigned Opcode, Type *ValTy,
+                                        unsigned Index) const {
+  assert(ValTy->isVectorTy() && "This must be a vector type");
+
+  if (Index != -1U) {
+    // Legalize the type.
+    std::pair<unsigned, MVT> LT = TLI->getTypeLegalizationCost(ValTy);
+
+    // The type is legalized to a single register, so the lane is known.
+    if (LT.second.isVector())
+      Index %= LT.second.getVectorNumElements();
+
+    // Lane 0 of a floating point vector is the scalar register itself.
+    if (Index == 0 && ValTy->getScalarType()->isFloatingPointTy())
+      return 0;
+  }
+
+  // Any other floating point lane is a dup or ins within the vector unit.
+  if (ValTy->getScalarType()->isFloatingPointTy())
+    return 1;
+
+  // Integer lanes are moved to or from a general purpose register by a umov
+  // or ins, which crosses between the register files.
+  return 2;
+}
+
+unsigned AArch64TTI::getCmpSelInstrCost(unsigned Opcode, Type *ValTy,
+                                        Type *CondTy) const {
+  int ISD = TLI->InstructionOpcodeToISD(Opcode);
+  // A vector select is a bsl per register once the condition has the width
+  // of the selected elements.
+  if (ST->hasNEON() && ValTy->isVectorTy() && ISD == ISD::SELECT) {
+    // As on ARM, lowering of selects whose condition is much narrower than
+    // the selected values is currently far from perfect.
+    static const TypeConversionCostTblEntry<MVT::SimpleValueType>
+    NEONVectorSelectTbl[] = {
+      { ISD::SELECT, MVT::v16i1, MVT::v16i16, 2*16 + 1 + 3*1 + 4*1 },
+      { ISD::SELECT, MVT::v8i1, MVT::v8i32, 4*8 + 1*3 + 1*4 + 1*2 },
+      { ISD::SELECT, MVT::v16i1, MVT::v16i32, 4*16 + 1*6 + 1*8 + 1*4 },
+      { ISD::SELECT, MVT::v4i1, MVT::v4i64, 4*4 + 1*2 + 1 },
+      { ISD::SELECT, MVT::v8i1, MVT::v8i64, 50 },
+      { ISD::SELECT, MVT::v16i1, MVT::v16i64, 100 }
+    };
+
+    EVT SelCondTy = TLI->getValueType(CondTy);
+    EVT SelValTy = TLI->getValueType(ValTy);
+    if (SelCondTy.isSimple() && SelValTy.isSimple()) {
+      int Idx = ConvertCostTableLookup(NEONVectorSelectTbl, ISD,
+                                       SelCondTy.getSimpleVT(),
+                                       SelValTy.getSimpleVT());
+      if (Idx != -1)
+        return NEONVectorSelectTbl[Idx].Cost;
+    }
+
+    std::pair<unsigned, MVT> LT = TLI->getTypeLegalizationCost(ValTy);
+    return LT.first;
+  }
+
+  return TargetTransformInfo::getCmpSelInstrCost(Opcode, ValTy, CondTy);
+}
+
+unsigned AArch64TTI::getAddressComputationCost(Type *Ty, bool IsComplex) const {
+  // Address computations in vectorized code with non-consecutive addresses
+  // will likely result in more instructions compared to scalar code where the
+  // computation can more often be merged into the index mode. The resulting
+  // extra micro-ops can significantly decrease throughput.
+  unsigned NumVectorInstToHideOverhead = 10;
+
+  if (Ty->isVectorTy() && IsComplex)
+    return NumVectorInstToHideOverhead;
+
+  // In many cases the address computation is not merged into the instruction
+  // addressing mode.
+  return 1;
+}
+
+unsigned AArch64TTI::getShuffleCost(ShuffleKind Kind, Type *Tp, int Index,
+                                    Type *SubTp) const {
+  if (Kind != SK_Reverse && Kind != SK_Broadcast)
+    return TargetTransformInfo::getShuffleCost(Kind, Tp, Index, SubTp);
+
+  // A broadcast is a single dup.
+  static const CostTblEntry<MVT::SimpleValueType> NEONBroadcastTbl[] = {
+    { ISD::VECTOR_SHUFFLE, MVT::v8i8,  1 },
+    { ISD::VECTOR_SHUFFLE, MVT::v4i16, 1 },
+    { ISD::VECTOR_SHUFFLE, MVT::v2i32, 1 },
+    { ISD::VECTOR_SHUFFLE, MVT::v2f32, 1 },
+    { ISD::VECTOR_SHUFFLE, MVT::v16i8, 1 },
+    { ISD::VECTOR_SHUFFLE, MVT::v8i16, 1 },
+    { ISD::VECTOR_SHUFFLE, MVT::v4i32, 1 },
+    { ISD::VECTOR_SHUFFLE, MVT::v4f32, 1 },
+    { ISD::VECTOR_SHUFFLE, MVT::v2i64, 1 },
+    { ISD::VECTOR_SHUFFLE, MVT::v2f64, 1 }
+  };
+
+  // Reversing a double word is a single rev64, or an ext for two elements;
+  // reversing a quad word takes a rev64 and an ext.
+  static const CostTblEntry<MVT::SimpleValueType> NEONReverseTbl[] = {
+    { ISD::VECTOR_SHUFFLE, MVT::v8i8,  1 },
+    { ISD::VECTOR_SHUFFLE, MVT::v4i16, 1 },
+    { ISD::VECTOR_SHUFFLE, MVT::v2i32, 1 },
+    { ISD::VECTOR_SHUFFLE, MVT::v2f32, 1 },
+    { ISD::VECTOR_SHUFFLE, MVT::v2i64, 1 },
+    { ISD::VECTOR_SHUFFLE, MVT::v2f64, 1 },
+    { ISD::VECTOR_SHUFFLE, MVT::v16i8, 2 },
+    { ISD::VECTOR_SHUFFLE, MVT::v8i16, 2 },
+    { ISD::VECTOR_SHUFFLE, MVT::v4i32, 2 },
+    { ISD::VECTOR_SHUFFLE, MVT::v4f32, 2 }
+  };
+
+  if (!ST->hasNEON())
+    return TargetTransformInfo::getShuffleCost(Kind, Tp, Index, SubTp);
+
+  std::pair<unsigned, MVT> LT = TLI->getTypeLegalizationCost(Tp);
+
+  if (Kind == SK_Broadcast) {
+    int Idx = CostTableLookup(NEONBroadcastTbl, ISD::VECTOR_SHUFFLE,
+                              LT.second);
+    if (Idx == -1)
+      return TargetTransformInfo::getShuffleCost(Kind, Tp, Index, SubTp);
+    // Every part of a split vector is a dup of the same lane.
+    return LT.first * NEONBroadcastTbl[Idx].Cost;
+  }
+
+  int Idx = CostTableLookup(NEONReverseTbl, ISD::VECTOR_SHUFFLE, LT.second);
+  if (Idx == -1)
+    return TargetTransformInfo::getShuffleCost(Kind, Tp, Index, SubTp);
+
+  return LT.first * NEONReverseTbl[Idx].Cost;
+}
+
+unsigned AArch64TTI::getArithmeticInstrCost(unsigned Opcode, Type *Ty,
+                                            OperandValueKind Op1Info,
+                                            OperandValueKind Op2Info) const {
+  int ISDOpcode = TLI->InstructionOpcodeToISD(Opcode);
+  std::pair<unsigned, MVT> LT = TLI->getTypeLegalizationCost(Ty);
+
+  // NEON has no integer division, so vector divisions and remainders are
+  // scalarized: every lane is moved out, divided by a sdiv/udiv, whose
+  // latency is several times that of other integer operations, and moved
+  // back in.  Remainders also take an msub.
+  const unsigned LaneDivCost = 6;
+  const unsigned LaneRemCost = 7;
+  static const CostTblEntry<MVT::SimpleValueType> CostTbl[] = {
+    // Double registers types.
+    { ISD::SDIV, MVT::v2i32, 2 * LaneDivCost },
+    { ISD::UDIV, MVT::v2i32, 2 * LaneDivCost },
+    { ISD::SREM, MVT::v2i32, 2 * LaneRemCost },
+    { ISD::UREM, MVT::v2i32, 2 * LaneRemCost },
+    { ISD::SDIV, MVT::v4i16, 4 * LaneDivCost },
+    { ISD::UDIV, MVT::v4i16, 4 * LaneDivCost },
+    { ISD::SREM, MVT::v4i16, 4 * LaneRemCost },
+    { ISD::UREM, MVT::v4i16, 4 * LaneRemCost },
+    { ISD::SDIV, MVT::v8i8,  8 * LaneDivCost },
+    { ISD::UDIV, MVT::v8i8,  8 * LaneDivCost },
+    { ISD::SREM, MVT::v8i8,  8 * LaneRemCost },
+    { ISD::UREM, MVT::v8i8,  8 * LaneRemCost },
+    // Quad register types.
+    { ISD::SDIV, MVT::v2i64, 2 * LaneDivCost },
+    { ISD::UDIV, MVT::v2i64, 2 * LaneDivCost },
+    { ISD::SREM, MVT::v2i64, 2 * LaneRemCost },
+    { ISD::UREM, MVT::v2i64, 2 * LaneRemCost },
+    { ISD::SDIV, MVT::v4i32, 4 * LaneDivCost },
+    { ISD::UDIV, MVT::v4i32, 4 * LaneDivCost },
+    { ISD::SREM, MVT::v4i32, 4 * LaneRemCost },
+    { ISD::UREM, MVT::v4i32, 4 * LaneRemCost },
+    { ISD::SDIV, MVT::v8i16, 8 * LaneDivCost },
+    { ISD::UDIV, MVT::v8i16, 8 * LaneDivCost },
+    { ISD::SREM, MVT::v8i16, 8 * LaneRemCost },
+    { ISD::UREM, MVT::v8i16, 8 * LaneRemCost },
+    { ISD::SDIV, MVT::v16i8, 16 * LaneDivCost },
+    { ISD::UDIV, MVT::v16i8, 16 * LaneDivCost },
+    { ISD::SREM, MVT::v16i8, 16 * LaneRemCost },
+    { ISD::UREM, MVT::v16i8, 16 * LaneRemCost }
+  };
+
+  int Idx = -1;
+
+  if (ST->hasNEON())
+    Idx = CostTableLookup(CostTbl, ISDOpcode, LT.second);
+
+  if (Idx != -1)
+    return LT.first * CostTbl[Idx].Cost;
+
+  return TargetTransformInfo::getArithmeticInstrCost(Opcode, Ty, Op1Info,
+                                                     Op2Info);
+}
@@ -155,7 +155,18 @@ namespace {
       }
     };
 
-    std::vector<BasicBlockInfo> BBInfo;
+    /// BBInfo - Size and offset information for each basic block, indexed by
+    /// block number.  Only the offsets of the first NumValidOffsets blocks are
+    /// current; the rest are recomputed on demand by getBBInfo, so a change at
+    /// the start of a large function doesn't sweep every block behind it.
+    mutable std::vector<BasicBlockInfo> BBInfo;
+    mutable unsigned NumValidOffsets;
+
+    /// FirstChangedBB - The lowest block number whose size changed during the
+    /// current placement sweep, and during the two sweeps before it.  Offsets
+    /// of blocks before all of these are unchanged, so constant pool users and
+    /// branches that only span such blocks are known to still be in range.
+    unsigned FirstChangedBB, PrevChangedBB, OlderChangedBB;
 
     /// WaterList - A sorted list of basic blocks where islands could be placed
     /// (i.e. blocks that don't fall through to the following block, due
@@ -281,6 +292,12 @@ namespace {
     MachineBasicBlock *splitBlockBeforeInstr(MachineInstr *MI);
     void updateForInsertedWaterBlock(MachineBasicBlock *NewBB);
     void adjustBBOffsetsAfter(MachineBasicBlock *BB);
+    const BasicBlockInfo &getBBInfo(unsigned BBNum) const;
+    void startSweep();
+    bool isUnchangedSinceLastSweep(unsigned BBNum) const {
+      return BBNum < std::min(FirstChangedBB,
+                              std::min(PrevChangedBB, OlderChangedBB));
+    }
     bool decrementCPEReferenceCount(unsigned CPI, MachineInstr* CPEMI);
     int findInRangeCPEntry(CPUser& U, unsigned UserOffset);
     bool findAvailableWater(CPUser&U, unsigned UserOffset,
@@ -332,7 +349,8 @@ void ARMConstantIslands::verify() {
        MBBI != E; ++MBBI) {
     MachineBasicBlock *MBB = MBBI;
     unsigned MBBId = MBB->getNumber();
-    assert(!MBBId || BBInfo[MBBId - 1].postOffset() <= BBInfo[MBBId].Offset);
+    assert(!MBBId || getBBInfo(MBBId - 1).postOffset() <=
+                     getBBInfo(MBBId).Offset);
   }
   DEBUG(dbgs() << "Verifying " << CPUsers.size() << " CP users.\n");
   for (unsigned i = 0, e = CPUsers.size(); i != e; ++i) {
@@ -357,7 +375,7 @@ void ARMConstantIslands::verify() {
 void ARMConstantIslands::dumpBBs() {
   DEBUG({
     for (unsigned J = 0, E = BBInfo.size(); J !=E; ++J) {
-      const BasicBlockInfo &BBI = BBInfo[J];
+      const BasicBlockInfo &BBI = getBBInfo(J);
       dbgs() << format("%08x BB#%u\t", BBI.Offset, J)
              << " kb=" << unsigned(BBI.KnownBits)
              << " ua=" << unsigned(BBI.Unalign)
@@ -440,11 +458,21 @@ bool ARMConstantIslands::runOnMachineFunction(MachineFunction &mf) {
   // Iteratively place constant pool entries and fix up branches until there
   // is no change.
   unsigned NoCPIters = 0, NoBRIters = 0;
+  unsigned NumCheckedBranches = 0;
+  FirstChangedBB = PrevChangedBB = OlderChangedBB = 0;
   while (true) {
     DEBUG(dbgs() << "Beginning CP iteration #" << NoCPIters << '\n');
     bool CPChange = false;
-    for (unsigned i = 0, e = CPUsers.size(); i != e; ++i)
+    startSweep();
+    for (unsigned i = 0, e = CPUsers.size(); i != e; ++i) {
+      // A user whose instruction and entry both precede every block touched
+      // since it was last checked is still in range.
+      CPUser &U = CPUsers[i];
+      if (isUnchangedSinceLastSweep(std::max(U.MI->getParent()->getNumber(),
+                                             U.CPEMI->getParent()->getNumber())))
+        continue;
       CPChange |= handleConstantPoolUser(i);
+    }
     if (CPChange && ++NoCPIters > 30)
       report_fatal_error("Constant Island pass failed to converge!");
     DEBUG(dumpBBs());
@@ -455,8 +483,17 @@ bool ARMConstantIslands::runOnMachineFunction(MachineFunction &mf) {
 
     DEBUG(dbgs() << "Beginning BR iteration #" << NoBRIters << '\n');
     bool BRChange = false;
-    for (unsigned i = 0, e = ImmBranches.size(); i != e; ++i)
+    startSweep();
+    for (unsigned i = 0, e = ImmBranches.size(); i != e; ++i) {
+      // Branches added since the last sweep have never been checked.
+      MachineInstr *MI = ImmBranches[i].MI;
+      if (i < NumCheckedBranches &&
+          isUnchangedSinceLastSweep(std::max(MI->getParent()->getNumber(),
+                                    MI->getOperand(0).getMBB()->getNumber())))
+        continue;
       BRChange |= fixupImmediateBr(ImmBranches[i]);
+    }
+    NumCheckedBranches = ImmBranches.size();
     if (BRChange && ++NoBRIters > 30)
       report_fatal_error("Branch Fix Up pass failed to converge!");
     DEBUG(dumpBBs());
@@ -634,6 +671,7 @@ void ARMConstantIslands::
 initializeFunctionInfo(const std::vector<MachineInstr*> &CPEMIs) {
   BBInfo.clear();
   BBInfo.resize(MF->getNumBlockIDs());
+  NumValidOffsets = 1;
 
   // First thing, compute the size of all basic blocks, and see if the function
   // has any inline assembly in it. If so, we have to be conservative about
@@ -829,7 +867,7 @@ unsigned ARMConstantIslands::getOffsetOf(MachineInstr *MI) const {
   // The offset is composed of two things: the sum of the sizes of all MBB's
   // before this instruction's block, and the offset from the start of the block
   // it is in.
-  unsigned Offset = BBInfo[MBB->getNumber()].Offset;
+  unsigned Offset = getBBInfo(MBB->getNumber()).Offset;
 
   // Sum instructions before MI in MBB.
   for (MachineBasicBlock::iterator I = MBB->begin(); &*I != MI; ++I) {
@@ -856,6 +894,8 @@ void ARMConstantIslands::updateForInsertedWaterBlock(MachineBasicBlock *NewBB) {
   // Insert an entry into BBInfo to align it properly with the (newly
   // renumbered) block numbers.
   BBInfo.insert(BBInfo.begin() + NewBB->getNumber(), BasicBlockInfo());
+  NumValidOffsets = std::min(NumValidOffsets, unsigned(NewBB->getNumber()));
+  FirstChangedBB = std::min(FirstChangedBB, unsigned(NewBB->getNumber()));
 
   // Next, update WaterList.  Specifically, we need to add NewMBB as having
   // available water after it.
@@ -907,6 +947,8 @@ MachineBasicBlock *ARMConstantIslands::splitBlockBeforeInstr(MachineInstr *MI) {
   // Insert an entry into BBInfo to align it properly with the (newly
   // renumbered) block numbers.
   BBInfo.insert(BBInfo.begin() + NewBB->getNumber(), BasicBlockInfo());
+  NumValidOffsets = std::min(NumValidOffsets, unsigned(NewBB->getNumber()));
+  FirstChangedBB = std::min(FirstChangedBB, unsigned(NewBB->getNumber()));
 
   // Next, update WaterList.  Specifically, we need to add OrigMBB as having
   // available water after it (but not if it's already there, which happens
@@ -944,7 +986,7 @@ MachineBasicBlock *ARMConstantIslands::splitBlockBeforeInstr(MachineInstr *MI) {
 /// basic block location.
 unsigned ARMConstantIslands::getUserOffset(CPUser &U) const {
   unsigned UserOffset = getOffsetOf(U.MI);
-  const BasicBlockInfo &BBI = BBInfo[U.MI->getParent()->getNumber()];
+  const BasicBlockInfo &BBI = getBBInfo(U.MI->getParent()->getNumber());
   unsigned KnownBits = BBI.internalKnownBits();
 
   // The value read from PC is offset from the actual instruction address.
@@ -993,14 +1035,14 @@ bool ARMConstantIslands::isWaterInRange(unsigned UserOffset,
                                         MachineBasicBlock* Water, CPUser &U,
                                         unsigned &Growth) {
   unsigned CPELogAlign = getCPELogAlign(U.CPEMI);
-  unsigned CPEOffset = BBInfo[Water->getNumber()].postOffset(CPELogAlign);
+  unsigned CPEOffset = getBBInfo(Water->getNumber()).postOffset(CPELogAlign);
   unsigned NextBlockOffset, NextBlockAlignment;
   MachineFunction::const_iterator NextBlock = Water;
   if (++NextBlock == MF->end()) {
-    NextBlockOffset = BBInfo[Water->getNumber()].postOffset();
+    NextBlockOffset = getBBInfo(Water->getNumber()).postOffset();
     NextBlockAlignment = 0;
   } else {
-    NextBlockOffset = BBInfo[NextBlock->getNumber()].Offset;
+    NextBlockOffset = getBBInfo(NextBlock->getNumber()).Offset;
     NextBlockAlignment = NextBlock->getAlignment();
   }
   unsigned Size = U.CPEMI->getOperand(2).getImm();
@@ -1037,7 +1079,7 @@ bool ARMConstantIslands::isCPEntryInRange(MachineInstr *MI, unsigned UserOffset,
   if (DoDump) {
     DEBUG({
       unsigned Block = MI->getParent()->getNumber();
-      const BasicBlockInfo &BBI = BBInfo[Block];
+      const BasicBlockInfo &BBI = getBBInfo(Block);
       dbgs() << "User of CPE#" << CPEMI->getOperand(0).getImm()
              << " max delta=" << MaxDisp
              << format(" insn address=%#x", UserOffset)
@@ -1068,26 +1110,37 @@ static bool BBIsJumpedOver(MachineBasicBlock *MBB) {
 }
 #endif // NDEBUG
 
+/// adjustBBOffsetsAfter - The size or alignment of BB changed.  Invalidate the
+/// offsets of the blocks following it; they are recomputed when next queried.
 void ARMConstantIslands::adjustBBOffsetsAfter(MachineBasicBlock *BB) {
   unsigned BBNum = BB->getNumber();
-  for(unsigned i = BBNum + 1, e = MF->getNumBlockIDs(); i < e; ++i) {
+  NumValidOffsets = std::min(NumValidOffsets, BBNum + 1);
+  FirstChangedBB = std::min(FirstChangedBB, BBNum);
+}
+
+/// getBBInfo - Return the information for block BBNum, first bringing the
+/// offsets of it and all blocks before it up to date.
+const ARMConstantIslands::BasicBlockInfo &
+ARMConstantIslands::getBBInfo(unsigned BBNum) const {
+  for (unsigned i = std::max(NumValidOffsets, 1U); i <= BBNum; ++i) {
     // Get the offset and known bits at the end of the layout predecessor.
     // Include the alignment of the current block.
     unsigned LogAlign = MF->getBlockNumbered(i)->getAlignment();
     unsigned Offset = BBInfo[i - 1].postOffset(LogAlign);
     unsigned KnownBits = BBInfo[i - 1].postKnownBits(LogAlign);
-
-    // This is where block i begins.  Stop if the offset is already correct,
-    // and we have updated 2 blocks.  This is the maximum number of blocks
-    // changed before calling this function.
-    if (i > BBNum + 2 &&
-        BBInfo[i].Offset == Offset &&
-        BBInfo[i].KnownBits == KnownBits)
-      break;
-
     BBInfo[i].Offset = Offset;
     BBInfo[i].KnownBits = KnownBits;
   }
+  NumValidOffsets = std::max(NumValidOffsets, BBNum + 1);
+  return BBInfo[BBNum];
+}
+
+/// startSweep - Begin a sweep over the constant pool users or the immediate
+/// branches, remembering where the previous sweeps changed the function.
+void ARMConstantIslands::startSweep() {
+  OlderChangedBB = PrevChangedBB;
+  PrevChangedBB = FirstChangedBB;
+  FirstChangedBB = ~0U;
 }
 
 /// decrementCPEReferenceCount - find the constant pool entry with index CPI
@@ -1234,7 +1287,7 @@ void ARMConstantIslands::createNewWater(unsigned CPUserIndex,
   MachineInstr *CPEMI  = U.CPEMI;
   unsigned CPELogAlign = getCPELogAlign(CPEMI);
   MachineBasicBlock *UserMBB = UserMI->getParent();
-  const BasicBlockInfo &UserBBI = BBInfo[UserMBB->getNumber()];
+  const BasicBlockInfo &UserBBI = getBBInfo(UserMBB->getNumber());
 
   // If the block does not end in an unconditional branch already, and if the
   // end of the block is within range, make new water there.  (The addition
@@ -1453,7 +1506,7 @@ bool ARMConstantIslands::handleConstantPoolUser(unsigned CPUserIndex) {
     }
 
   DEBUG(dbgs() << "  Moved CPE to #" << ID << " CPI=" << CPI
-        << format(" offset=%#x\n", BBInfo[NewIsland->getNumber()].Offset));
+        << format(" offset=%#x\n", getBBInfo(NewIsland->getNumber()).Offset));
 
   return true;
 }
@@ -1506,7 +1559,7 @@ bool ARMConstantIslands::isBBInRange(MachineInstr *MI,MachineBasicBlock *DestBB,
                                      unsigned MaxDisp) {
   unsigned PCAdj      = isThumb ? 4 : 8;
   unsigned BrOffset   = getOffsetOf(MI) + PCAdj;
-  unsigned DestOffset = BBInfo[DestBB->getNumber()].Offset;
+  unsigned DestOffset = getBBInfo(DestBB->getNumber()).Offset;
 
   DEBUG(dbgs() << "Branch of destination BB#" << DestBB->getNumber()
                << " from BB#" << MI->getParent()->getNumber()
@@ -1805,7 +1858,7 @@ bool ARMConstantIslands::optimizeThumb2Branches() {
     // Check if the distance is within 126. Subtract starting offset by 2
     // because the cmp will be eliminated.
     unsigned BrOffset = getOffsetOf(Br.MI) + 4 - 2;
-    unsigned DestOffset = BBInfo[DestBB->getNumber()].Offset;
+    unsigned DestOffset = getBBInfo(DestBB->getNumber()).Offset;
     if (BrOffset < DestOffset && (DestOffset - BrOffset) <= 126) {
       MachineBasicBlock::iterator CmpMI = Br.MI;
       if (CmpMI != Br.MI->getParent()->begin()) {
@@ -1863,7 +1916,7 @@ bool ARMConstantIslands::optimizeThumb2JumpTables() {
     const std::vector<MachineBasicBlock*> &JTBBs = JT[JTI].MBBs;
     for (unsigned j = 0, ee = JTBBs.size(); j != ee; ++j) {
       MachineBasicBlock *MBB = JTBBs[j];
-      unsigned DstOffset = BBInfo[MBB->getNumber()].Offset;
+      unsigned DstOffset = getBBInfo(MBB->getNumber()).Offset;
       // Negative offset is not ok. FIXME: We should change BB layout to make
       // sure all the branches are forward.
       if (ByteOk && (DstOffset - JTOffset) > ((1<<8)-1)*2)
@@ -24,6 +24,7 @@
 #include "llvm/ADT/SmallSet.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/Statistic.h"
+#include "llvm/Analysis/AliasAnalysis.h"
 #include "llvm/CodeGen/MachineBasicBlock.h"
 #include "llvm/CodeGen/MachineFunctionPass.h"
 #include "llvm/CodeGen/MachineInstr.h"
@@ -34,6 +35,7 @@
 #include "llvm/IR/DataLayout.h"
 #include "llvm/IR/DerivedTypes.h"
 #include "llvm/IR/Function.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/raw_ostream.h"
@@ -54,6 +56,21 @@ STATISTIC(NumSTRD2STM,  "Number of strd instructions turned back into stm");
 STATISTIC(NumLDRD2LDR,  "Number of ldrd instructions turned back into ldr's");
 STATISTIC(NumSTRD2STR,  "Number of strd instructions turned back into str's");
 
+static cl::opt<unsigned>
+PreRAMaxRunLength("arm-prera-ldst-max-ops", cl::Hidden, cl::init(8),
+  cl::desc("Maximum number of loads / stores clustered into one run by the "
+           "pre-RA load / store optimizer"));
+
+static cl::opt<unsigned>
+PreRADistancePerOp("arm-prera-ldst-distance", cl::Hidden, cl::init(4),
+  cl::desc("Maximum distance, in instructions per clustered op, between the "
+           "first and last load / store of a run"));
+
+static cl::opt<bool>
+PreRAUseAA("arm-prera-ldst-use-aa", cl::Hidden, cl::init(true),
+  cl::desc("Use alias analysis to move loads / stores past unrelated memory "
+           "operations in the pre-RA load / store optimizer"));
+
 /// ARMAllocLoadStoreOpt - Post- register allocation pass the combine
 /// load / store instructions to form ldm / stm instructions.
 
@@ -1544,6 +1561,7 @@ namespace {
     ARMPreAllocLoadStoreOpt() : MachineFunctionPass(ID) {}
 
     const DataLayout *TD;
+    AliasAnalysis *AA;
     const TargetInstrInfo *TII;
     const TargetRegisterInfo *TRI;
     const ARMSubtarget *STI;
@@ -1556,6 +1574,11 @@ namespace {
       return "ARM pre- register allocation load / store optimization pass";
     }
 
+    virtual void getAnalysisUsage(AnalysisUsage &AU) const {
+      AU.addRequired<AliasAnalysis>();
+      MachineFunctionPass::getAnalysisUsage(AU);
+    }
+
   private:
     bool CanFormLdStDWord(MachineInstr *Op0, MachineInstr *Op1, DebugLoc &dl,
                           unsigned &NewOpc, unsigned &EvenReg,
@@ -1579,6 +1602,7 @@ bool ARMPreAllocLoadStoreOpt::runOnMachineFunction(MachineFunction &Fn) {
   STI = &Fn.getTarget().getSubtarget<ARMSubtarget>();
   MRI = &Fn.getRegInfo();
   MF  = &Fn;
+  AA  = PreRAUseAA ? &getAnalysis<AliasAnalysis>() : 0;
 
   bool Modified = false;
   for (MachineFunction::iterator MFI = Fn.begin(), E = Fn.end(); MFI != E;
@@ -1588,31 +1612,67 @@ bool ARMPreAllocLoadStoreOpt::runOnMachineFunction(MachineFunction &Fn) {
   return Modified;
 }
 
+/// isKnownNoAlias - Return true if alias analysis proves that the memory
+/// accessed by MIa and MIb is disjoint.  Instructions without exactly one
+/// non-volatile memory operand are assumed to alias anything.
+static bool isKnownNoAlias(AliasAnalysis *AA, MachineInstr *MIa,
+                           MachineInstr *MIb) {
+  if (!MIa->hasOneMemOperand() || !MIb->hasOneMemOperand() ||
+      MIa->hasOrderedMemoryRef() || MIb->hasOrderedMemoryRef())
+    return false;
+  MachineMemOperand *MMOa = *MIa->memoperands_begin();
+  MachineMemOperand *MMOb = *MIb->memoperands_begin();
+  if (!MMOa->getValue() || !MMOb->getValue() ||
+      MMOa->getOffset() < 0 || MMOb->getOffset() < 0)
+    return false;
+
+  // Extend both locations back to the smaller offset so the query covers the
+  // bytes actually accessed, as ScheduleDAGInstrs does.
+  int64_t MinOffset = std::min(MMOa->getOffset(), MMOb->getOffset());
+  int64_t Overlapa = MMOa->getSize() + MMOa->getOffset() - MinOffset;
+  int64_t Overlapb = MMOb->getSize() + MMOb->getOffset() - MinOffset;
+  return AA->alias(AliasAnalysis::Location(MMOa->getValue(), Overlapa,
+                                           MMOa->getTBAAInfo()),
+                   AliasAnalysis::Location(MMOb->getValue(), Overlapb,
+                                           MMOb->getTBAAInfo())) ==
+    AliasAnalysis::NoAlias;
+}
+
+/// isKnownNoAlias - Return true if MI is known not to alias any of MemOps.
+static bool isKnownNoAlias(AliasAnalysis *AA, MachineInstr *MI,
+                           SmallPtrSet<MachineInstr*, 4> &MemOps) {
+  if (!AA)
+    return false;
+  for (SmallPtrSet<MachineInstr*, 4>::iterator I = MemOps.begin(),
+         E = MemOps.end(); I != E; ++I)
+    if (!isKnownNoAlias(AA, MI, *I))
+      return false;
+  return true;
+}
+
 static bool IsSafeAndProfitableToMove(bool isLd, unsigned Base,
                                       MachineBasicBlock::iterator I,
                                       MachineBasicBlock::iterator E,
                                       SmallPtrSet<MachineInstr*, 4> &MemOps,
                                       SmallSet<unsigned, 4> &MemRegs,
-                                      const TargetRegisterInfo *TRI) {
-  // Are there stores / loads / calls between them?
-  // FIXME: This is overly conservative. We should make use of alias information
-  // some day.
+                                      const TargetRegisterInfo *TRI,
+                                      AliasAnalysis *AA) {
+  // Are there stores / loads / calls between them?  Memory operations that
+  // alias analysis proves disjoint from the ones being clustered are fine.
   SmallSet<unsigned, 4> AddedRegPressure;
   while (++I != E) {
     if (I->isDebugValue() || MemOps.count(&*I))
       continue;
     if (I->isCall() || I->isTerminator() || I->hasUnmodeledSideEffects())
       return false;
-    if (isLd && I->mayStore())
+    if (isLd && I->mayStore() && !isKnownNoAlias(AA, I, MemOps))
       return false;
     if (!isLd) {
-      if (I->mayLoad())
-        return false;
       // It's not safe to move the first 'str' down.
       // str r1, [r0]
       // strh r5, [r0]
       // str r4, [r0, #+4]
-      if (I->mayStore())
+      if ((I->mayLoad() || I->mayStore()) && !isKnownNoAlias(AA, I, MemOps))
         return false;
     }
     for (unsigned j = 0, NumOps = I->getNumOperands(); j != NumOps; ++j) {
@@ -1783,7 +1843,7 @@ bool ARMPreAllocLoadStoreOpt::RescheduleOps(MachineBasicBlock *MBB,
       LastOffset = Offset;
       LastBytes = Bytes;
       LastOpcode = LSMOpcode;
-      if (++NumMove == 8) // FIXME: Tune this limit.
+      if (++NumMove == PreRAMaxRunLength)
         break;
     }
 
@@ -1799,10 +1859,10 @@ bool ARMPreAllocLoadStoreOpt::RescheduleOps(MachineBasicBlock *MBB,
 
       // Be conservative, if the instructions are too far apart, don't
       // move them. We want to limit the increase of register pressure.
-      bool DoMove = (LastLoc - FirstLoc) <= NumMove*4; // FIXME: Tune this.
+      bool DoMove = (LastLoc - FirstLoc) <= NumMove * PreRADistancePerOp;
       if (DoMove)
         DoMove = IsSafeAndProfitableToMove(isLd, Base, FirstOp, LastOp,
-                                           MemOps, MemRegs, TRI);
+                                           MemOps, MemRegs, TRI, AA);
       if (!DoMove) {
         for (unsigned i = 0; i != NumMove; ++i)
           Ops.pop_back();
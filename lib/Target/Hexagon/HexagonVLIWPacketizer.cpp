@@ -35,6 +35,7 @@
 #include "llvm/Target/TargetInstrInfo.h"
 #include "llvm/Target/TargetRegisterInfo.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/Support/MathExtras.h"
 #include "llvm/MC/MCInstrItineraries.h"
@@ -56,6 +57,13 @@ static cl::opt<bool> PacketizeVolatiles("hexagon-packetize-volatiles",
       cl::ZeroOrMore, cl::Hidden, cl::init(true),
       cl::desc("Allow non-solo packetization of volatile memory references"));
 
+static cl::opt<bool> ScheduleHwLoops("hexagon-sched-hw-loops",
+      cl::ZeroOrMore, cl::Hidden, cl::init(true),
+      cl::desc("Reorder single-block hardware loop bodies into packets using "
+               "the DFA before packetization"));
+
+STATISTIC(NumHwLoopsScheduled, "Number of hardware loop bodies rescheduled");
+
 namespace llvm {
   void initializeHexagonPacketizerPass(PassRegistry&);
 }
@@ -181,6 +189,195 @@ INITIALIZE_PASS_END(HexagonPacketizer, "packets", "Hexagon Packetizer",
                     false, false)
 
 
+namespace {
+  /// HexagonLoopBodyScheduler - Post-RA list scheduler for the body of a
+  /// single-block hardware loop.  It fills one packet at a time, checking
+  /// resources with the DFA, so that the packetizer, which only groups
+  /// adjacent instructions, sees independent instructions next to each
+  /// other.  Instructions on the critical path of an iteration come first.
+  class HexagonLoopBodyScheduler : public ScheduleDAGInstrs {
+    DFAPacketizer *ResourceTracker;
+    const InstrItineraryData *InstrItins;
+    std::vector<SUnit*> Order;
+
+  public:
+    HexagonLoopBodyScheduler(MachineFunction &MF, MachineLoopInfo &MLI,
+                             MachineDominatorTree &MDT,
+                             DFAPacketizer *ResourceTracker)
+      : ScheduleDAGInstrs(MF, MLI, MDT, /*IsPostRA=*/true),
+        ResourceTracker(ResourceTracker),
+        InstrItins(MF.getTarget().getInstrItineraryData()) {}
+
+    void schedule();
+
+    /// reorderRegion - Move the region's instructions into the scheduled
+    /// order.  Return true if the order changed.
+    bool reorderRegion();
+
+  private:
+    bool usesResources(MachineInstr *MI) const {
+      unsigned SchedClass = MI->getDesc().getSchedClass();
+      return InstrItins &&
+        InstrItins->beginStage(SchedClass) != InstrItins->endStage(SchedClass);
+    }
+  };
+}
+
+void HexagonLoopBodyScheduler::schedule() {
+  buildSchedGraph(0);
+
+  std::vector<unsigned> PredsLeft(SUnits.size());
+  std::vector<unsigned> ReadyCycle(SUnits.size(), 0);
+  std::vector<SUnit*> Ready;
+  for (unsigned i = 0, e = SUnits.size(); i != e; ++i) {
+    PredsLeft[i] = SUnits[i].Preds.size();
+    if (!PredsLeft[i])
+      Ready.push_back(&SUnits[i]);
+  }
+
+  Order.clear();
+  ResourceTracker->clearResources();
+  bool PacketEmpty = true;
+  for (unsigned Cycle = 0; Order.size() != SUnits.size();) {
+    // Pick the tallest ready instruction that fits in the current packet.  An
+    // instruction the DFA rejects even in an empty packet is placed alone.
+    SUnit *Best = 0;
+    unsigned BestIdx = 0;
+    for (unsigned i = 0, e = Ready.size(); i != e; ++i) {
+      SUnit *SU = Ready[i];
+      if (ReadyCycle[SU->NodeNum] > Cycle)
+        continue;
+      MachineInstr *MI = SU->getInstr();
+      if (!PacketEmpty && usesResources(MI) &&
+          !ResourceTracker->canReserveResources(MI))
+        continue;
+      if (!Best || SU->getHeight() > Best->getHeight() ||
+          (SU->getHeight() == Best->getHeight() &&
+           SU->NodeNum < Best->NodeNum)) {
+        Best = SU;
+        BestIdx = i;
+      }
+    }
+
+    if (!Best) {
+      ++Cycle;
+      ResourceTracker->clearResources();
+      PacketEmpty = true;
+      continue;
+    }
+
+    Ready[BestIdx] = Ready.back();
+    Ready.pop_back();
+    Order.push_back(Best);
+    MachineInstr *MI = Best->getInstr();
+    if (usesResources(MI)) {
+      if (ResourceTracker->canReserveResources(MI))
+        ResourceTracker->reserveResources(MI);
+      PacketEmpty = false;
+    }
+
+    // Dependent instructions go in a later packet, and wait out the latency.
+    for (SUnit::const_succ_iterator I = Best->Succs.begin(),
+           E = Best->Succs.end(); I != E; ++I) {
+      SUnit *Succ = I->getSUnit();
+      if (Succ->isBoundaryNode())
+        continue;
+      ReadyCycle[Succ->NodeNum] =
+        std::max(ReadyCycle[Succ->NodeNum],
+                 Cycle + std::max(I->getLatency(), 1U));
+      if (--PredsLeft[Succ->NodeNum] == 0)
+        Ready.push_back(Succ);
+    }
+  }
+  ResourceTracker->clearResources();
+}
+
+bool HexagonLoopBodyScheduler::reorderRegion() {
+  bool Changed = false;
+  MachineBasicBlock::iterator I = RegionBegin;
+  for (unsigned i = 0, e = Order.size(); i != e; ++i, ++I) {
+    while (I->isDebugValue())
+      ++I;
+    if (&*I != Order[i]->getInstr())
+      Changed = true;
+  }
+  if (!Changed)
+    return false;
+
+  // Splice everything in front of the region end, then put each DBG_VALUE
+  // back after the instruction it used to follow.
+  MachineInstr *First = Order.front()->getInstr();
+  for (unsigned i = 0, e = Order.size(); i != e; ++i)
+    BB->splice(RegionEnd, BB, Order[i]->getInstr());
+  RegionBegin = First;
+
+  for (DbgValueVector::reverse_iterator DI = DbgValues.rbegin(),
+         DE = DbgValues.rend(); DI != DE; ++DI) {
+    MachineInstr *DbgValue = DI->first;
+    MachineInstr *OrigPrev = DI->second;
+    BB->splice(llvm::next(MachineBasicBlock::iterator(OrigPrev)), BB,
+               DbgValue);
+  }
+  if (FirstDbgValue) {
+    BB->splice(RegionBegin, BB, FirstDbgValue);
+    RegionBegin = FirstDbgValue;
+  }
+  DbgValues.clear();
+  FirstDbgValue = 0;
+  return true;
+}
+
+/// isSingleBlockHwLoop - Return true if MBB is a hardware loop whose body is
+/// MBB itself.
+static bool isSingleBlockHwLoop(MachineBasicBlock *MBB) {
+  MachineBasicBlock::iterator Term = MBB->getFirstTerminator();
+  return Term != MBB->end() && Term->getOpcode() == Hexagon::ENDLOOP0 &&
+    Term->getOperand(0).getMBB() == MBB;
+}
+
+/// scheduleHwLoops - Reorder the bodies of single-block hardware loops ahead
+/// of packetization.  Returns true if anything moved.
+static bool scheduleHwLoops(MachineFunction &Fn, MachineLoopInfo &MLI,
+                            MachineDominatorTree &MDT,
+                            DFAPacketizer *ResourceTracker) {
+  const TargetInstrInfo *TII = Fn.getTarget().getInstrInfo();
+  HexagonLoopBodyScheduler Scheduler(Fn, MLI, MDT, ResourceTracker);
+  bool Changed = false;
+  for (MachineFunction::iterator MBB = Fn.begin(), MBBe = Fn.end();
+       MBB != MBBe; ++MBB) {
+    if (!isSingleBlockHwLoop(MBB))
+      continue;
+
+    // The body must be a single scheduling region ending at the terminators.
+    MachineBasicBlock::iterator RegionEnd = MBB->getFirstTerminator();
+    unsigned NumRegionInstrs = 0;
+    bool HasBoundary = false;
+    for (MachineBasicBlock::iterator I = MBB->begin(); I != RegionEnd; ++I) {
+      if (TII->isSchedulingBoundary(I, MBB, Fn)) {
+        HasBoundary = true;
+        break;
+      }
+      if (!I->isDebugValue())
+        ++NumRegionInstrs;
+    }
+    if (HasBoundary || NumRegionInstrs < 2)
+      continue;
+
+    Scheduler.startBlock(MBB);
+    Scheduler.enterRegion(MBB, MBB->begin(), RegionEnd, NumRegionInstrs);
+    Scheduler.schedule();
+    bool Moved = Scheduler.reorderRegion();
+    Scheduler.exitRegion();
+    Scheduler.finishBlock();
+    if (Moved) {
+      Scheduler.fixupKills(MBB);
+      ++NumHwLoopsScheduled;
+      Changed = true;
+    }
+  }
+  return Changed;
+}
+
 // HexagonPacketizerList Ctor.
 HexagonPacketizerList::HexagonPacketizerList(
   MachineFunction &MF, MachineLoopInfo &MLI,MachineDominatorTree &MDT,
@@ -227,6 +424,11 @@ bool HexagonPacketizer::runOnMachineFunction(MachineFunction &Fn) {
     }
   }
 
+  // Group independent instructions of hardware loop bodies so that the
+  // packets below are as full as the resources allow.
+  if (ScheduleHwLoops)
+    scheduleHwLoops(Fn, MLI, MDT, Packetizer.getResourceTracker());
+
   // Loop over all of the basic blocks.
   for (MachineFunction::iterator MBB = Fn.begin(), MBBe = Fn.end();
        MBB != MBBe; ++MBB) {
@@ -28,6 +28,7 @@ namespace llvm {
 class NVPTXTargetMachine;
 class FunctionPass;
 class MachineFunctionPass;
+class ImmutablePass;
 class formatted_raw_ostream;
 
 namespace NVPTXCC {
@@ -65,6 +66,11 @@ ModulePass *createGenericToNVVMPass();
 ModulePass *createNVVMReflectPass();
 ModulePass *createNVVMReflectPass(const StringMap<int>& Mapping);
 MachineFunctionPass *createNVPTXPrologEpilogPass();
+FunctionPass *createNVPTXLoadStoreVectorizerPass();
+FunctionPass *createNVPTXInferAddressSpacesPass();
+
+/// \brief Creates an NVPTX-specific Target Transformation Info pass.
+ImmutablePass *createNVPTXTargetTransformInfoPass(const NVPTXTargetMachine *TM);
 
 bool isImageOrSamplerVal(const Value *, const Module *);
 
@@ -0,0 +1,321 @@
+//===-- NVPTXInferAddressSpaces.cpp - Infer address spaces of pointers ----===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// A load or store through a generic pointer is emitted as a generic ld or st,
+// which the hardware has to resolve to a state space at run time.  Many
+// generic pointers are known to point into one specific space, however: the
+// address of a global variable, for instance, is converted to a generic
+// pointer by GenericToNVVM with llvm.nvvm.ptr.global.to.gen.
+//
+// This pass follows such conversions through getelementptrs, bitcasts, phis
+// and selects.  The derived pointers whose every source is in the same space
+// are rebuilt in that space, and the loads and stores through them are
+// rewritten to use the specific pointers, which instruction selection turns
+// into ld.global, st.shared and so on.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "nvptx-infer-addrspaces"
+#include "NVPTX.h"
+#include "MCTargetDesc/NVPTXBaseInfo.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/IntrinsicInst.h"
+#include "llvm/Pass.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/InstIterator.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace llvm;
+
+STATISTIC(NumAccessesRewritten,
+          "Number of generic loads and stores given a specific address space");
+
+namespace llvm { void initializeNVPTXInferAddressSpacesPass(PassRegistry &); }
+
+namespace {
+
+/// UninitializedAddressSpace - The address space of a pointer that has not
+/// been reached yet.  It is the identity of joinAddressSpaces.
+const unsigned UninitializedAddressSpace = ~0U;
+
+class NVPTXInferAddressSpaces : public FunctionPass {
+  /// The address space inferred for each generic derived pointer.
+  DenseMap<Value *, unsigned> InferredAS;
+  /// The rebuilt, specific version of each generic pointer.
+  DenseMap<Value *, Value *> SpecificValues;
+
+public:
+  static char ID;
+  NVPTXInferAddressSpaces() : FunctionPass(ID) {
+    initializeNVPTXInferAddressSpacesPass(*PassRegistry::getPassRegistry());
+  }
+
+  virtual bool runOnFunction(Function &F);
+
+  virtual const char *getPassName() const {
+    return "NVPTX Address Space Inference";
+  }
+
+  virtual void getAnalysisUsage(AnalysisUsage &AU) const {
+    AU.setPreservesCFG();
+  }
+
+private:
+  unsigned getAddressSpace(Value *V) const;
+  unsigned computeAddressSpace(Instruction *I) const;
+  void inferAddressSpaces(ArrayRef<Instruction *> Derived);
+  Value *getSpecificValue(Value *V, unsigned AS);
+  void eraseDeadPointers(ArrayRef<Instruction *> Derived);
+};
+
+} // end anonymous namespace
+
+char NVPTXInferAddressSpaces::ID = 0;
+
+INITIALIZE_PASS(NVPTXInferAddressSpaces, "nvptx-infer-addrspaces",
+                "NVPTX Address Space Inference", false, false)
+
+FunctionPass *llvm::createNVPTXInferAddressSpacesPass() {
+  return new NVPTXInferAddressSpaces();
+}
+
+static bool isGenericPointer(Value *V) {
+  PointerType *PTy = dyn_cast<PointerType>(V->getType());
+  return PTy && PTy->getAddressSpace() == ADDRESS_SPACE_GENERIC;
+}
+
+/// isConversionToGeneric - Whether I converts a pointer in a specific
+/// address space to a generic one.
+static bool isConversionToGeneric(const Instruction *I) {
+  const IntrinsicInst *II = dyn_cast<IntrinsicInst>(I);
+  if (!II)
+    return false;
+  switch (II->getIntrinsicID()) {
+  default:
+    return false;
+  case Intrinsic::nvvm_ptr_global_to_gen:
+  case Intrinsic::nvvm_ptr_shared_to_gen:
+  case Intrinsic::nvvm_ptr_constant_to_gen:
+  case Intrinsic::nvvm_ptr_local_to_gen:
+    return true;
+  }
+}
+
+/// isDerivedPointer - Whether the address space of the generic pointer I
+/// follows from the address spaces of its pointer operands.
+static bool isDerivedPointer(const Instruction *I) {
+  return isa<GetElementPtrInst>(I) || isa<PHINode>(I) || isa<SelectInst>(I) ||
+         (isa<BitCastInst>(I) && I->getOperand(0)->getType()->isPointerTy()) ||
+         isConversionToGeneric(I);
+}
+
+static unsigned joinAddressSpaces(unsigned AS1, unsigned AS2) {
+  if (AS1 == UninitializedAddressSpace)
+    return AS2;
+  if (AS2 == UninitializedAddressSpace || AS1 == AS2)
+    return AS1;
+  return ADDRESS_SPACE_GENERIC;
+}
+
+/// getAddressSpace - Return the address space V is known to point into so
+/// far, which is generic for a pointer of unknown origin.
+unsigned NVPTXInferAddressSpaces::getAddressSpace(Value *V) const {
+  if (isa<UndefValue>(V))
+    return UninitializedAddressSpace;
+  DenseMap<Value *, unsigned>::const_iterator I = InferredAS.find(V);
+  if (I != InferredAS.end())
+    return I->second;
+  return ADDRESS_SPACE_GENERIC;
+}
+
+unsigned NVPTXInferAddressSpaces::computeAddressSpace(Instruction *I) const {
+  if (isConversionToGeneric(I))
+    return cast<PointerType>(I->getOperand(0)->getType())->getAddressSpace();
+  if (PHINode *PN = dyn_cast<PHINode>(I)) {
+    unsigned AS = UninitializedAddressSpace;
+    for (unsigned i = 0, e = PN->getNumIncomingValues(); i != e; ++i)
+      AS = joinAddressSpaces(AS, getAddressSpace(PN->getIncomingValue(i)));
+    return AS;
+  }
+  if (SelectInst *SI = dyn_cast<SelectInst>(I))
+    return joinAddressSpaces(getAddressSpace(SI->getTrueValue()),
+                             getAddressSpace(SI->getFalseValue()));
+  // A getelementptr or bitcast points into the space of its operand.
+  return getAddressSpace(I->getOperand(0));
+}
+
+/// inferAddressSpaces - Iterate to the fixed point of the address spaces of
+/// the derived pointers.  Every pointer starts out uninitialized, so that a
+/// cycle of phis keeps the space of the pointers entering it, and only ever
+/// moves down to a specific space and then to generic.
+void NVPTXInferAddressSpaces::inferAddressSpaces(
+    ArrayRef<Instruction *> Derived) {
+  for (unsigned i = 0, e = Derived.size(); i != e; ++i)
+    InferredAS[Derived[i]] = UninitializedAddressSpace;
+
+  SetVector<Instruction *> Worklist;
+  Worklist.insert(Derived.begin(), Derived.end());
+  while (!Worklist.empty()) {
+    Instruction *I = Worklist.pop_back_val();
+    unsigned AS = computeAddressSpace(I);
+    unsigned &Current = InferredAS[I];
+    if (AS == Current)
+      continue;
+    Current = AS;
+
+    for (Value::use_iterator UI = I->use_begin(), UE = I->use_end();
+         UI != UE; ++UI) {
+      Instruction *User = cast<Instruction>(*UI);
+      if (InferredAS.count(User))
+        Worklist.insert(User);
+    }
+  }
+
+  // Pointers only reached by undef have no source to take a space from.
+  for (unsigned i = 0, e = Derived.size(); i != e; ++i)
+    if (InferredAS[Derived[i]] == UninitializedAddressSpace)
+      InferredAS[Derived[i]] = ADDRESS_SPACE_GENERIC;
+}
+
+/// getSpecificValue - Return a pointer in address space AS to the same
+/// memory as the generic pointer V, which was inferred to point into AS.
+Value *NVPTXInferAddressSpaces::getSpecificValue(Value *V, unsigned AS) {
+  Type *NewTy = PointerType::get(V->getType()->getPointerElementType(), AS);
+  if (isa<UndefValue>(V))
+    return UndefValue::get(NewTy);
+
+  Value *&Entry = SpecificValues[V];
+  if (Entry)
+    return Entry;
+
+  Instruction *I = cast<Instruction>(V);
+  assert(InferredAS.lookup(I) == AS && "Pointer is not in that space");
+
+  if (isConversionToGeneric(I)) {
+    Value *Src = I->getOperand(0);
+    if (Src->getType() != NewTy)
+      Src = new BitCastInst(Src, NewTy, Src->getName() + ".cast", I);
+    return SpecificValues[V] = Src;
+  }
+
+  if (PHINode *PN = dyn_cast<PHINode>(I)) {
+    // Record the new phi before visiting the incoming values, which may
+    // lead back to it.
+    PHINode *NewPN = PHINode::Create(NewTy, PN->getNumIncomingValues(),
+                                     PN->getName() + ".as", PN);
+    SpecificValues[V] = NewPN;
+    for (unsigned i = 0, e = PN->getNumIncomingValues(); i != e; ++i)
+      NewPN->addIncoming(getSpecificValue(PN->getIncomingValue(i), AS),
+                         PN->getIncomingBlock(i));
+    return NewPN;
+  }
+
+  Value *NewV;
+  if (GetElementPtrInst *GEP = dyn_cast<GetElementPtrInst>(I)) {
+    Value *NewPtr = getSpecificValue(GEP->getPointerOperand(), AS);
+    SmallVector<Value *, 4> Indices(GEP->idx_begin(), GEP->idx_end());
+    GetElementPtrInst *NewGEP =
+        GetElementPtrInst::Create(NewPtr, Indices, GEP->getName() + ".as", GEP);
+    NewGEP->setIsInBounds(GEP->isInBounds());
+    NewV = NewGEP;
+  } else if (SelectInst *SI = dyn_cast<SelectInst>(I)) {
+    Value *NewTrue = getSpecificValue(SI->getTrueValue(), AS);
+    Value *NewFalse = getSpecificValue(SI->getFalseValue(), AS);
+    NewV = SelectInst::Create(SI->getCondition(), NewTrue, NewFalse,
+                              SI->getName() + ".as", SI);
+  } else {
+    Value *NewSrc = getSpecificValue(I->getOperand(0), AS);
+    NewV = new BitCastInst(NewSrc, NewTy, I->getName() + ".as", I);
+  }
+  return SpecificValues[V] = NewV;
+}
+
+/// eraseDeadPointers - Erase the generic derived pointers that are no longer
+/// used, other than by each other.
+void NVPTXInferAddressSpaces::eraseDeadPointers(
+    ArrayRef<Instruction *> Derived) {
+  SmallPtrSet<Instruction *, 32> DerivedSet(Derived.begin(), Derived.end());
+
+  // A pointer is live if something other than a derived pointer uses it, or
+  // if a live derived pointer does.
+  SmallPtrSet<Instruction *, 32> Live;
+  SmallVector<Instruction *, 32> Worklist;
+  for (unsigned i = 0, e = Derived.size(); i != e; ++i) {
+    Instruction *I = Derived[i];
+    for (Value::use_iterator UI = I->use_begin(), UE = I->use_end();
+         UI != UE; ++UI)
+      if (!DerivedSet.count(cast<Instruction>(*UI))) {
+        if (Live.insert(I))
+          Worklist.push_back(I);
+        break;
+      }
+  }
+  while (!Worklist.empty()) {
+    Instruction *I = Worklist.pop_back_val();
+    for (unsigned i = 0, e = I->getNumOperands(); i != e; ++i) {
+      Instruction *Op = dyn_cast<Instruction>(I->getOperand(i));
+      if (Op && DerivedSet.count(Op) && Live.insert(Op))
+        Worklist.push_back(Op);
+    }
+  }
+
+  SmallVector<Instruction *, 32> Dead;
+  for (unsigned i = 0, e = Derived.size(); i != e; ++i)
+    if (!Live.count(Derived[i]) && !Derived[i]->mayHaveSideEffects())
+      Dead.push_back(Derived[i]);
+  for (unsigned i = 0, e = Dead.size(); i != e; ++i)
+    Dead[i]->dropAllReferences();
+  for (unsigned i = 0, e = Dead.size(); i != e; ++i)
+    Dead[i]->eraseFromParent();
+}
+
+bool NVPTXInferAddressSpaces::runOnFunction(Function &F) {
+  SmallVector<Instruction *, 32> Derived;
+  SmallVector<Instruction *, 32> Accesses;
+  for (inst_iterator I = inst_begin(F), E = inst_end(F); I != E; ++I) {
+    if (isGenericPointer(&*I) && isDerivedPointer(&*I))
+      Derived.push_back(&*I);
+    else if (isa<LoadInst>(*I) || isa<StoreInst>(*I))
+      Accesses.push_back(&*I);
+  }
+  if (Derived.empty())
+    return false;
+
+  inferAddressSpaces(Derived);
+
+  bool Changed = false;
+  for (unsigned i = 0, e = Accesses.size(); i != e; ++i) {
+    Instruction *I = Accesses[i];
+    unsigned PtrIdx = isa<LoadInst>(I) ? LoadInst::getPointerOperandIndex()
+                                       : StoreInst::getPointerOperandIndex();
+    Value *Ptr = I->getOperand(PtrIdx);
+    unsigned AS = getAddressSpace(Ptr);
+    if (AS == ADDRESS_SPACE_GENERIC || AS == UninitializedAddressSpace)
+      continue;
+
+    DEBUG(dbgs() << "NVPTX-IAS: address space " << AS << " for " << *I
+                 << '\n');
+    I->setOperand(PtrIdx, getSpecificValue(Ptr, AS));
+    ++NumAccessesRewritten;
+    Changed = true;
+  }
+
+  if (Changed)
+    eraseDeadPointers(Derived);
+  InferredAS.clear();
+  SpecificValues.clear();
+  return Changed;
+}
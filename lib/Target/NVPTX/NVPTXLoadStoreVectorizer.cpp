@@ -0,0 +1,355 @@
+//===-- NVPTXLoadStoreVectorizer.cpp - Merge adjacent memory accesses -----===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// PTX loads and stores of two or four elements (ld.v2, ld.v4, st.v2 and
+// st.v4) move up to 128 bits in one memory transaction, but the generic
+// vectorizers are told that NVPTX has no vector registers and leave scalar
+// code alone.  This pass merges the simple scalar loads and stores of a basic
+// block that access adjacent elements off the same base pointer into one
+// vector load or store, which instruction selection turns into the forms of
+// NVPTXVector.td.
+//
+// PTX requires a vector access to be aligned to its full size, so a run of
+// accesses is only merged from an element whose known alignment allows it.
+// Merged loads are issued at the position of the first load of the run and
+// merged stores at the position of the last store, provided no instruction
+// in between may access the memory involved.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "nvptx-load-store-vectorizer"
+#include "NVPTX.h"
+#include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Analysis/AliasAnalysis.h"
+#include "llvm/Analysis/ValueTracking.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/DataLayout.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/Pass.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+
+using namespace llvm;
+
+STATISTIC(NumVectorLoads, "Number of vector loads formed");
+STATISTIC(NumVectorStores, "Number of vector stores formed");
+STATISTIC(NumScalarsMerged, "Number of scalar accesses merged");
+
+namespace llvm { void initializeNVPTXLoadStoreVectorizerPass(PassRegistry &); }
+
+namespace {
+
+/// MemAccess - One candidate load or store and where it points.
+struct MemAccess {
+  Instruction *I;
+  int64_t Offset;
+  unsigned Order;
+
+  MemAccess(Instruction *I, int64_t Offset, unsigned Order)
+    : I(I), Offset(Offset), Order(Order) {}
+
+  bool operator<(const MemAccess &RHS) const {
+    if (Offset != RHS.Offset)
+      return Offset < RHS.Offset;
+    return Order < RHS.Order;
+  }
+};
+
+typedef SmallVector<MemAccess, 8> AccessList;
+typedef std::pair<Value *, Type *> AccessKey;
+
+class NVPTXLoadStoreVectorizer : public FunctionPass {
+  const DataLayout *DL;
+  AliasAnalysis *AA;
+
+public:
+  static char ID;
+  NVPTXLoadStoreVectorizer() : FunctionPass(ID), DL(0), AA(0) {
+    initializeNVPTXLoadStoreVectorizerPass(*PassRegistry::getPassRegistry());
+  }
+
+  virtual bool runOnFunction(Function &F);
+
+  virtual const char *getPassName() const {
+    return "NVPTX Load/Store Vectorizer";
+  }
+
+  virtual void getAnalysisUsage(AnalysisUsage &AU) const {
+    AU.addRequired<AliasAnalysis>();
+    AU.setPreservesCFG();
+  }
+
+private:
+  bool vectorizeBlock(BasicBlock &BB);
+  bool vectorizeGroup(AccessList &Accesses, bool IsStore);
+  bool isSafeToMerge(ArrayRef<MemAccess> Run, bool IsStore);
+  void mergeLoads(ArrayRef<MemAccess> Run, unsigned Align);
+  void mergeStores(ArrayRef<MemAccess> Run, unsigned Align);
+};
+
+} // end anonymous namespace
+
+char NVPTXLoadStoreVectorizer::ID = 0;
+
+INITIALIZE_PASS_BEGIN(NVPTXLoadStoreVectorizer, "nvptx-load-store-vectorizer",
+                      "NVPTX Load/Store Vectorizer", false, false)
+INITIALIZE_AG_DEPENDENCY(AliasAnalysis)
+INITIALIZE_PASS_END(NVPTXLoadStoreVectorizer, "nvptx-load-store-vectorizer",
+                    "NVPTX Load/Store Vectorizer", false, false)
+
+FunctionPass *llvm::createNVPTXLoadStoreVectorizerPass() {
+  return new NVPTXLoadStoreVectorizer();
+}
+
+/// getAccessedType - Return the type accessed by a load or store.
+static Type *getAccessedType(Instruction *I) {
+  if (LoadInst *LI = dyn_cast<LoadInst>(I))
+    return LI->getType();
+  return cast<StoreInst>(I)->getValueOperand()->getType();
+}
+
+static Value *getPointerOperand(Instruction *I) {
+  if (LoadInst *LI = dyn_cast<LoadInst>(I))
+    return LI->getPointerOperand();
+  return cast<StoreInst>(I)->getPointerOperand();
+}
+
+static unsigned getAlignment(Instruction *I) {
+  if (LoadInst *LI = dyn_cast<LoadInst>(I))
+    return LI->getAlignment();
+  return cast<StoreInst>(I)->getAlignment();
+}
+
+/// isVectorizableType - Whether elements of type Ty have PTX vector forms.
+static bool isVectorizableType(Type *Ty) {
+  if (Ty->isFloatTy() || Ty->isDoubleTy())
+    return true;
+  if (IntegerType *ITy = dyn_cast<IntegerType>(Ty)) {
+    unsigned Bits = ITy->getBitWidth();
+    return Bits == 8 || Bits == 16 || Bits == 32 || Bits == 64;
+  }
+  return false;
+}
+
+/// getFirstInOrder - Return the index of the access of Run that comes first
+/// in its block.
+static unsigned getFirstInOrder(ArrayRef<MemAccess> Run) {
+  unsigned First = 0;
+  for (unsigned i = 1, e = Run.size(); i != e; ++i)
+    if (Run[i].Order < Run[First].Order)
+      First = i;
+  return First;
+}
+
+/// getLastInOrder - Return the index of the access of Run that comes last in
+/// its block.
+static unsigned getLastInOrder(ArrayRef<MemAccess> Run) {
+  unsigned Last = 0;
+  for (unsigned i = 1, e = Run.size(); i != e; ++i)
+    if (Run[i].Order > Run[Last].Order)
+      Last = i;
+  return Last;
+}
+
+bool NVPTXLoadStoreVectorizer::runOnFunction(Function &F) {
+  DL = getAnalysisIfAvailable<DataLayout>();
+  if (!DL)
+    return false;
+  AA = &getAnalysis<AliasAnalysis>();
+
+  bool Changed = false;
+  for (Function::iterator BB = F.begin(), E = F.end(); BB != E; ++BB)
+    Changed |= vectorizeBlock(*BB);
+  return Changed;
+}
+
+bool NVPTXLoadStoreVectorizer::vectorizeBlock(BasicBlock &BB) {
+  // Group the simple accesses by base pointer and element type, keeping the
+  // groups in the order they are first seen so that the output is stable.
+  MapVector<AccessKey, AccessList> Loads, Stores;
+  unsigned Order = 0;
+  for (BasicBlock::iterator I = BB.begin(), E = BB.end(); I != E;
+       ++I, ++Order) {
+    bool IsStore = isa<StoreInst>(I);
+    if (!IsStore && !isa<LoadInst>(I))
+      continue;
+    if (IsStore ? !cast<StoreInst>(I)->isSimple()
+                : !cast<LoadInst>(I)->isSimple())
+      continue;
+
+    Type *Ty = getAccessedType(I);
+    if (!isVectorizableType(Ty))
+      continue;
+
+    int64_t Offset = 0;
+    Value *Base = GetPointerBaseWithConstantOffset(getPointerOperand(I),
+                                                   Offset, DL);
+    MemAccess Access(I, Offset, Order);
+    (IsStore ? Stores : Loads)[std::make_pair(Base, Ty)].push_back(Access);
+  }
+
+  bool Changed = false;
+  for (MapVector<AccessKey, AccessList>::iterator I = Loads.begin(),
+       E = Loads.end(); I != E; ++I)
+    if (I->second.size() > 1)
+      Changed |= vectorizeGroup(I->second, /*IsStore=*/false);
+  for (MapVector<AccessKey, AccessList>::iterator I = Stores.begin(),
+       E = Stores.end(); I != E; ++I)
+    if (I->second.size() > 1)
+      Changed |= vectorizeGroup(I->second, /*IsStore=*/true);
+  return Changed;
+}
+
+bool NVPTXLoadStoreVectorizer::vectorizeGroup(AccessList &Accesses,
+                                              bool IsStore) {
+  std::stable_sort(Accesses.begin(), Accesses.end());
+
+  Type *Ty = getAccessedType(Accesses[0].I);
+  int64_t EltSize = DL->getTypeStoreSize(Ty);
+  unsigned ABIAlign = DL->getABITypeAlignment(Ty);
+  unsigned MaxElts = std::min<unsigned>(4, 16 / EltSize);
+
+  bool Changed = false;
+  for (unsigned i = 0, e = Accesses.size(); i < e;) {
+    // Count the accesses following this one at consecutive offsets.
+    unsigned Length = 1;
+    while (i + Length < e && Length < MaxElts &&
+           Accesses[i + Length].Offset == Accesses[i].Offset +
+                                              int64_t(Length) * EltSize)
+      ++Length;
+
+    unsigned Align = getAlignment(Accesses[i].I);
+    if (Align == 0)
+      Align = ABIAlign;
+
+    // Use the widest vector the alignment of the first element allows.
+    unsigned NumElts = 0;
+    for (unsigned Width = MaxElts; Width >= 2; Width /= 2)
+      if (Length >= Width && Align >= Width * EltSize) {
+        NumElts = Width;
+        break;
+      }
+
+    ArrayRef<MemAccess> Run(&Accesses[i], NumElts);
+    if (NumElts == 0 || !isSafeToMerge(Run, IsStore)) {
+      ++i;
+      continue;
+    }
+
+    if (IsStore)
+      mergeStores(Run, NumElts * EltSize);
+    else
+      mergeLoads(Run, NumElts * EltSize);
+    NumScalarsMerged += NumElts;
+    Changed = true;
+    i += NumElts;
+  }
+  return Changed;
+}
+
+/// isSafeToMerge - Check that no instruction between the first and the last
+/// access of Run in program order may write the memory a merged load reads,
+/// or access the memory a merged store writes.
+bool NVPTXLoadStoreVectorizer::isSafeToMerge(ArrayRef<MemAccess> Run,
+                                             bool IsStore) {
+  unsigned First = getFirstInOrder(Run), Last = getLastInOrder(Run);
+
+  SmallPtrSet<Instruction *, 4> InRun;
+  SmallVector<AliasAnalysis::Location, 4> Locs;
+  for (unsigned i = 0, e = Run.size(); i != e; ++i) {
+    InRun.insert(Run[i].I);
+    if (IsStore)
+      Locs.push_back(AA->getLocation(cast<StoreInst>(Run[i].I)));
+    else
+      Locs.push_back(AA->getLocation(cast<LoadInst>(Run[i].I)));
+  }
+
+  BasicBlock::iterator I = Run[First].I, E = Run[Last].I;
+  for (++I; I != E; ++I) {
+    if (InRun.count(I))
+      continue;
+    if (IsStore ? !I->mayReadOrWriteMemory() : !I->mayWriteToMemory())
+      continue;
+    for (unsigned i = 0, e = Locs.size(); i != e; ++i) {
+      AliasAnalysis::ModRefResult MR = AA->getModRefInfo(I, Locs[i]);
+      if (IsStore ? MR != AliasAnalysis::NoModRef : (MR & AliasAnalysis::Mod))
+        return false;
+    }
+  }
+  return true;
+}
+
+void NVPTXLoadStoreVectorizer::mergeLoads(ArrayRef<MemAccess> Run,
+                                          unsigned Align) {
+  const MemAccess &First = Run[getFirstInOrder(Run)];
+  LoadInst *Lowest = cast<LoadInst>(Run[0].I);
+  VectorType *VecTy = VectorType::get(Lowest->getType(), Run.size());
+  unsigned AS = Lowest->getPointerAddressSpace();
+
+  // The address of the lowest element may only be computed after the first
+  // load, so the vector is addressed from the pointer of the first load.
+  IRBuilder<> Builder(First.I);
+  Value *Ptr = getPointerOperand(First.I);
+  if (First.I != Lowest) {
+    Type *IntPtrTy = DL->getIntPtrType(Builder.getContext(), AS);
+    Ptr = Builder.CreateBitCast(Ptr, Builder.getInt8PtrTy(AS));
+    Ptr = Builder.CreateGEP(Ptr, ConstantInt::get(IntPtrTy,
+                                                  Run[0].Offset - First.Offset,
+                                                  /*isSigned=*/true));
+  }
+  Ptr = Builder.CreateBitCast(Ptr, VecTy->getPointerTo(AS));
+  LoadInst *VecLoad = Builder.CreateAlignedLoad(Ptr, Align,
+                                                Lowest->getName() + ".vec");
+  for (unsigned i = 0, e = Run.size(); i != e; ++i) {
+    LoadInst *LI = cast<LoadInst>(Run[i].I);
+    Value *Elt = Builder.CreateExtractElement(VecLoad, Builder.getInt32(i));
+    Elt->takeName(LI);
+    LI->replaceAllUsesWith(Elt);
+  }
+  for (unsigned i = 0, e = Run.size(); i != e; ++i)
+    Run[i].I->eraseFromParent();
+
+  DEBUG(dbgs() << "NVPTX-LSV: merged " << Run.size() << " loads into "
+               << *VecLoad << '\n');
+  ++NumVectorLoads;
+}
+
+void NVPTXLoadStoreVectorizer::mergeStores(ArrayRef<MemAccess> Run,
+                                           unsigned Align) {
+  Instruction *Last = Run[getLastInOrder(Run)].I;
+
+  // Every stored value and pointer is defined before its own store, and so
+  // before the last one.
+  StoreInst *Lowest = cast<StoreInst>(Run[0].I);
+  Type *EltTy = Lowest->getValueOperand()->getType();
+  VectorType *VecTy = VectorType::get(EltTy, Run.size());
+  unsigned AS = Lowest->getPointerAddressSpace();
+
+  IRBuilder<> Builder(Last);
+  Value *Vec = UndefValue::get(VecTy);
+  for (unsigned i = 0, e = Run.size(); i != e; ++i)
+    Vec = Builder.CreateInsertElement(
+        Vec, cast<StoreInst>(Run[i].I)->getValueOperand(),
+        Builder.getInt32(i));
+  Value *Ptr = Builder.CreateBitCast(Lowest->getPointerOperand(),
+                                     VecTy->getPointerTo(AS));
+  StoreInst *VecStore = Builder.CreateAlignedStore(Vec, Ptr, Align);
+  for (unsigned i = 0, e = Run.size(); i != e; ++i)
+    Run[i].I->eraseFromParent();
+
+  DEBUG(dbgs() << "NVPTX-LSV: merged " << Run.size() << " stores into "
+               << *VecStore << '\n');
+  ++NumVectorStores;
+}
@@ -50,8 +50,16 @@ using namespace llvm;
 namespace llvm {
 void initializeNVVMReflectPass(PassRegistry&);
 void initializeGenericToNVVMPass(PassRegistry&);
+void initializeNVPTXLoadStoreVectorizerPass(PassRegistry&);
+void initializeNVPTXInferAddressSpacesPass(PassRegistry&);
 }
 
+static cl::opt<bool>
+DisableLoadStoreVectorizer("disable-nvptx-load-store-vectorizer", cl::Hidden,
+                           cl::desc("Do not merge adjacent loads and stores "
+                                    "into vector accesses"),
+                           cl::init(false));
+
 extern "C" void LLVMInitializeNVPTXTarget() {
   // Register the target.
   RegisterTargetMachine<NVPTXTargetMachine32> X(TheNVPTXTarget32);
@@ -61,6 +69,8 @@ extern "C" void LLVMInitializeNVPTXTarget() {
   // but it's very NVPTX-specific.
   initializeNVVMReflectPass(*PassRegistry::getPassRegistry());
   initializeGenericToNVVMPass(*PassRegistry::getPassRegistry());
+  initializeNVPTXLoadStoreVectorizerPass(*PassRegistry::getPassRegistry());
+  initializeNVPTXInferAddressSpacesPass(*PassRegistry::getPassRegistry());
 }
 
 static std::string computeDataLayout(const NVPTXSubtarget &ST) {
@@ -86,6 +96,14 @@ NVPTXTargetMachine::NVPTXTargetMachine(
   initAsmInfo();
 }
 
+void NVPTXTargetMachine::addAnalysisPasses(PassManagerBase &PM) {
+  // Add first the target-independent BasicTTI pass, then our NVPTX pass. This
+  // allows the NVPTX pass to delegate to the target independent layer when
+  // appropriate.
+  PM.add(createBasicTargetTransformInfoPass(this));
+  PM.add(createNVPTXTargetTransformInfoPass(this));
+}
+
 void NVPTXTargetMachine32::anchor() {}
 
 NVPTXTargetMachine32::NVPTXTargetMachine32(
@@ -141,6 +159,13 @@ void NVPTXPassConfig::addIRPasses() {
 
   TargetPassConfig::addIRPasses();
   addPass(createGenericToNVVMPass());
+  if (getOptLevel() != CodeGenOpt::None) {
+    // Give the pointers GenericToNVVM made generic their space back before
+    // the accesses through them are merged.
+    addPass(createNVPTXInferAddressSpacesPass());
+    if (!DisableLoadStoreVectorizer)
+      addPass(createNVPTXLoadStoreVectorizerPass());
+  }
 }
 
 bool NVPTXPassConfig::addInstSelector() {
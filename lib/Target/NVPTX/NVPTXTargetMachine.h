@@ -81,6 +81,9 @@ public:
 
   virtual TargetPassConfig *createPassConfig(PassManagerBase &PM);
 
+  /// \brief Register NVPTX analysis passes with a pass manager.
+  virtual void addAnalysisPasses(PassManagerBase &PM);
+
   // Emission of machine code through JITCodeEmitter is not supported.
   virtual bool addPassesToEmitMachineCode(PassManagerBase &, JITCodeEmitter &,
                                           bool = true) {
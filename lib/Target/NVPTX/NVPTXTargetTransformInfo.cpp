@@ -0,0 +1,190 @@
+//===-- NVPTXTargetTransformInfo.cpp - NVPTX specific TTI pass ------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file implements a TargetTransformInfo analysis pass specific to the
+/// NVPTX target machine. It tells the generic passes that the target runs
+/// threads in lock step, so that branches on thread dependent values are
+/// expensive, and that the only vector operations PTX has are loads and
+/// stores, while letting the target independent and default TTI
+/// implementations handle the rest.
+///
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "nvptxtti"
+#include "NVPTX.h"
+#include "NVPTXTargetMachine.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/TargetTransformInfo.h"
+#include "llvm/IR/IntrinsicInst.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Target/TargetLowering.h"
+using namespace llvm;
+
+// Declare the pass initialization routine locally as target-specific passes
+// don't have a target-wide initialization entry point, and so we rely on the
+// pass constructor initialization.
+namespace llvm {
+void initializeNVPTXTTIPass(PassRegistry &);
+}
+
+namespace {
+
+class NVPTXTTI : public ImmutablePass, public TargetTransformInfo {
+  const NVPTXTargetMachine *TM;
+  const NVPTXSubtarget *ST;
+  const NVPTXTargetLowering *TLI;
+
+public:
+  NVPTXTTI() : ImmutablePass(ID), TM(0), ST(0), TLI(0) {
+    llvm_unreachable("This pass cannot be directly constructed");
+  }
+
+  NVPTXTTI(const NVPTXTargetMachine *TM)
+      : ImmutablePass(ID), TM(TM), ST(TM->getSubtargetImpl()),
+        TLI(TM->getTargetLowering()) {
+    initializeNVPTXTTIPass(*PassRegistry::getPassRegistry());
+  }
+
+  virtual void initializePass() {
+    pushTTIStack(this);
+  }
+
+  virtual void finalizePass() {
+    popTTIStack();
+  }
+
+  virtual void getAnalysisUsage(AnalysisUsage &AU) const {
+    TargetTransformInfo::getAnalysisUsage(AU);
+  }
+
+  /// Pass identification.
+  static char ID;
+
+  /// Provide necessary pointer adjustments for the two base classes.
+  virtual void *getAdjustedAnalysisPointer(const void *ID) {
+    if (ID == &TargetTransformInfo::ID)
+      return (TargetTransformInfo*)this;
+    return this;
+  }
+
+  /// \name Scalar TTI Implementations
+  /// @{
+
+  virtual bool hasBranchDivergence() const { return true; }
+
+  virtual void getUnrollingPreferences(Loop *L,
+                                       UnrollingPreferences &UP) const;
+
+  /// @}
+
+
+  /// \name Vector TTI Implementations
+  /// @{
+
+  unsigned getNumberOfRegisters(bool Vector) const {
+    // PTX has no vector registers; the elements of a vector are held in
+    // scalar registers and every operation on them is scalarized.  Saying so
+    // keeps the loop and SLP vectorizers from widening arithmetic that would
+    // only be split apart again.  Adjacent memory accesses are merged into
+    // ld.v2/ld.v4 by the NVPTX load/store vectorizer instead.
+    if (Vector)
+      return 0;
+    // The register allocation done by ptxas is limited to 63 registers per
+    // thread before sm_35 and to 255 from then on.
+    return ST->getSmVersion() >= 35 ? 255 : 63;
+  }
+
+  unsigned getRegisterBitWidth(bool Vector) const {
+    // The widest access is a 128-bit ld.v4 or st.v4.
+    if (Vector)
+      return 128;
+    return ST->is64Bit() ? 64 : 32;
+  }
+
+  unsigned getMaximumUnrollFactor() const {
+    // The hardware hides latency by switching between warps rather than by
+    // overlapping iterations of one thread.
+    return 1;
+  }
+
+  unsigned getArithmeticInstrCost(unsigned Opcode, Type *Ty,
+                                  OperandValueKind Op1Info = OK_AnyValue,
+                                  OperandValueKind Op2Info = OK_AnyValue) const;
+  /// @}
+};
+
+} // end anonymous namespace
+
+INITIALIZE_AG_PASS(NVPTXTTI, TargetTransformInfo, "nvptxtti",
+                   "NVPTX Target Transform Info", true, true, false)
+char NVPTXTTI::ID = 0;
+
+ImmutablePass *
+llvm::createNVPTXTargetTransformInfoPass(const NVPTXTargetMachine *TM) {
+  return new NVPTXTTI(TM);
+}
+
+void NVPTXTTI::getUnrollingPreferences(Loop *L,
+                                       UnrollingPreferences &UP) const {
+  // Every register a thread holds is taken from the register file shared by
+  // the threads of a multiprocessor, so unrolling that adds live values costs
+  // occupancy.  Partial and runtime unrolling are still worth it for the
+  // loads they batch up, but only while the body stays small: every load
+  // kept in flight takes a sixteenth of the usual budget, down to a quarter.
+  UP.Partial = UP.Runtime = true;
+
+  unsigned NumLoads = 0;
+  for (Loop::block_iterator BI = L->block_begin(), BE = L->block_end();
+       BI != BE; ++BI)
+    for (BasicBlock::iterator I = (*BI)->begin(), E = (*BI)->end(); I != E;
+         ++I) {
+      // A call is a full ABI sequence through the param space, which
+      // unrolling only duplicates.
+      if (isa<CallInst>(I) && !isa<IntrinsicInst>(I)) {
+        UP.Partial = UP.Runtime = false;
+        return;
+      }
+      if (isa<LoadInst>(I))
+        ++NumLoads;
+    }
+
+  UP.Threshold -= std::min(NumLoads, 12U) * (UP.Threshold / 16);
+}
+
+unsigned NVPTXTTI::getArithmeticInstrCost(unsigned Opcode, Type *Ty,
+                                          OperandValueKind Op1Info,
+                                          OperandValueKind Op2Info) const {
+  std::pair<unsigned, MVT> LT = TLI->getTypeLegalizationCost(Ty);
+  int ISD = TLI->InstructionOpcodeToISD(Opcode);
+
+  switch (ISD) {
+  default:
+    break;
+  case ISD::ADD:
+  case ISD::SUB:
+  case ISD::MUL:
+    // The ALUs are 32 bits wide; 64-bit additions are an add.cc/addc pair
+    // and 64-bit multiplications a chain of mad.lo/mad.hi.
+    if (LT.second.getScalarType() == MVT::i64)
+      return LT.first * (ISD == ISD::MUL ? 4 : 2);
+    break;
+  case ISD::SDIV:
+  case ISD::UDIV:
+  case ISD::SREM:
+  case ISD::UREM:
+    // Integer division has no hardware support and expands to a
+    // subroutine of several dozen instructions.
+    if (Op2Info != OK_UniformConstantValue)
+      return LT.first * (LT.second.getScalarType() == MVT::i64 ? 70 : 20);
+    break;
+  }
+
+  return TargetTransformInfo::getArithmeticInstrCost(Opcode, Ty, Op1Info,
+                                                     Op2Info);
+}
@@ -186,6 +186,39 @@ bool PPCCTRLoops::runOnFunction(Function &F) {
   return MadeChange;
 }
 
+/// isExpandedInline - Return true if the memory intrinsic MI has a constant
+/// length small enough that SelectionDAG expands it into loads and stores
+/// instead of calling the library.  This mirrors the limit checked by
+/// FindOptimalMemOpLowering, assuming the narrowest access the alignment
+/// allows, so it never claims a call is inlined when it is not.
+static bool isExpandedInline(const MemIntrinsic *MI, const Triple &TT,
+                             const TargetLowering *TLI) {
+  const ConstantInt *Len = dyn_cast<ConstantInt>(MI->getLength());
+  if (!Len)
+    return false;
+
+  const Function *F = MI->getParent()->getParent();
+  bool OptSize = F->getAttributes().
+    hasAttribute(AttributeSet::FunctionIndex, Attribute::OptimizeForSize);
+  unsigned Limit;
+  switch (MI->getIntrinsicID()) {
+  default: llvm_unreachable("Unknown memory intrinsic");
+  case Intrinsic::memcpy:  Limit = TLI->getMaxStoresPerMemcpy(OptSize);  break;
+  case Intrinsic::memmove: Limit = TLI->getMaxStoresPerMemmove(OptSize); break;
+  case Intrinsic::memset:  Limit = TLI->getMaxStoresPerMemset(OptSize);  break;
+  }
+
+  uint64_t Size = Len->getZExtValue();
+  uint64_t Width = TT.isArch64Bit() ? 8 : 4;
+  Width = std::min<uint64_t>(Width, std::max(MI->getAlignment(), 1U));
+  uint64_t NumOps = 0;
+  for (; Width && NumOps <= Limit; Width /= 2) {
+    NumOps += Size / Width;
+    Size %= Width;
+  }
+  return NumOps <= Limit;
+}
+
 bool PPCCTRLoops::mightUseCTR(const Triple &TT, BasicBlock *BB) {
   for (BasicBlock::iterator J = BB->begin(), JE = BB->end();
        J != JE; ++J) {
@@ -240,9 +273,6 @@ bool PPCCTRLoops::mightUseCTR(const Triple &TT, BasicBlock *BB) {
           // an eh_sjlj_setjmp.
           case Intrinsic::eh_sjlj_setjmp:
 
-          case Intrinsic::memcpy:
-          case Intrinsic::memmove:
-          case Intrinsic::memset:
           case Intrinsic::powi:
           case Intrinsic::log:
           case Intrinsic::log2:
@@ -253,12 +283,23 @@ bool PPCCTRLoops::mightUseCTR(const Triple &TT, BasicBlock *BB) {
           case Intrinsic::sin:
           case Intrinsic::cos:
             return true;
+          case Intrinsic::memcpy:
+          case Intrinsic::memmove:
+          case Intrinsic::memset:
+            // Short constant-length copies become inline loads and stores.
+            if (isExpandedInline(cast<MemIntrinsic>(CI), TT, TLI))
+              continue;
+            return true;
           case Intrinsic::copysign:
+          case Intrinsic::fma:
+          case Intrinsic::fmuladd:
+            // ISD::FCOPYSIGN and ISD::FMA only become library calls for
+            // ppc_fp128, where there is no hardware support.
             if (CI->getArgOperand(0)->getType()->getScalarType()->
                 isPPC_FP128Ty())
               return true;
             else
-              continue; // ISD::FCOPYSIGN is never a library call.
+              continue;
           case Intrinsic::sqrt:      Opcode = ISD::FSQRT;      break;
           case Intrinsic::floor:     Opcode = ISD::FFLOOR;     break;
           case Intrinsic::ceil:      Opcode = ISD::FCEIL;      break;
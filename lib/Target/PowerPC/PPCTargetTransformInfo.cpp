@@ -187,8 +187,56 @@ unsigned PPCTTI::getArithmeticInstrCost(unsigned Opcode, Type *Ty,
                                                      Op2Info);
 }
 
+/// isAltivecType - Return true if VT is a vector type held in one Altivec
+/// register.
+static bool isAltivecType(MVT VT) {
+  return VT == MVT::v16i8 || VT == MVT::v8i16 ||
+         VT == MVT::v4i32 || VT == MVT::v4f32;
+}
+
+// Estimated cost of a load-hit-store delay.  This was obtained
+// experimentally as a minimum needed to prevent unprofitable
+// vectorization for the paq8p benchmark.  It may need to be
+// raised further if other unprofitable cases remain.
+static const unsigned LHSPenalty = 12;
+
 unsigned PPCTTI::getShuffleCost(ShuffleKind Kind, Type *Tp, int Index,
                                 Type *SubTp) const {
+  if (!ST->hasAltivec() ||
+      (Kind != SK_Broadcast && Kind != SK_Reverse))
+    return TargetTransformInfo::getShuffleCost(Kind, Tp, Index, SubTp);
+
+  static const CostTblEntry<MVT::SimpleValueType> AltivecBroadcastTbl[] = {
+    // A broadcast is a single vsplt[bhw].
+    { ISD::VECTOR_SHUFFLE, MVT::v16i8, 1 },
+    { ISD::VECTOR_SHUFFLE, MVT::v8i16, 1 },
+    { ISD::VECTOR_SHUFFLE, MVT::v4i32, 1 },
+    { ISD::VECTOR_SHUFFLE, MVT::v4f32, 1 }
+  };
+
+  static const CostTblEntry<MVT::SimpleValueType> AltivecReverseTbl[] = {
+    // Any other permute is a vperm, whose control vector is loaded from the
+    // constant pool.
+    { ISD::VECTOR_SHUFFLE, MVT::v16i8, 2 },
+    { ISD::VECTOR_SHUFFLE, MVT::v8i16, 2 },
+    { ISD::VECTOR_SHUFFLE, MVT::v4i32, 2 },
+    { ISD::VECTOR_SHUFFLE, MVT::v4f32, 2 }
+  };
+
+  std::pair<unsigned, MVT> LT = TLI->getTypeLegalizationCost(Tp);
+
+  if (Kind == SK_Broadcast) {
+    int Idx = CostTableLookup(AltivecBroadcastTbl, ISD::VECTOR_SHUFFLE,
+                              LT.second);
+    if (Idx != -1)
+      return LT.first * AltivecBroadcastTbl[Idx].Cost;
+  } else {
+    int Idx = CostTableLookup(AltivecReverseTbl, ISD::VECTOR_SHUFFLE,
+                              LT.second);
+    if (Idx != -1)
+      return LT.first * AltivecReverseTbl[Idx].Cost;
+  }
+
   return TargetTransformInfo::getShuffleCost(Kind, Tp, Index, SubTp);
 }
 
@@ -210,12 +258,6 @@ unsigned PPCTTI::getVectorInstrCost(unsigned Opcode, Type *Val,
   int ISD = TLI->InstructionOpcodeToISD(Opcode);
   assert(ISD && "Invalid opcode");
 
-  // Estimated cost of a load-hit-store delay.  This was obtained
-  // experimentally as a minimum needed to prevent unprofitable
-  // vectorization for the paq8p benchmark.  It may need to be
-  // raised further if other unprofitable cases remain.
-  unsigned LHSPenalty = 12;
-
   // Vector element insert/extract with Altivec is very expensive,
   // because they require store and reload with the attendant
   // processor stall for load-hit-store.  Until VSX is available,
@@ -238,9 +280,23 @@ unsigned PPCTTI::getMemoryOpCost(unsigned Opcode, Type *Src, unsigned Alignment,
   // Each load/store unit costs 1.
   unsigned Cost = LT.first * 1;
 
+  unsigned SrcBytes = LT.second.getStoreSize();
+  if (ST->hasAltivec() && isAltivecType(LT.second) &&
+      Alignment && Alignment < SrcBytes) {
+    // An unaligned Altivec load is an lvsl, an lvx for each vector plus one
+    // more, and a vperm for each vector.
+    if (Opcode == Instruction::Load)
+      return 2 * Cost + 2;
+
+    // An unaligned Altivec store has no permuted form.  It goes through a
+    // stack slot, is reloaded in GPR-sized pieces and stored again, paying
+    // a load-hit-store stall.
+    unsigned Pieces = SrcBytes / (ST->isPPC64() ? 8 : 4);
+    return Cost * (1 + 2 * Pieces) + LHSPenalty;
+  }
+
   // PPC in general does not support unaligned loads and stores. They'll need
   // to be decomposed based on the alignment factor.
-  unsigned SrcBytes = LT.second.getStoreSize();
   if (SrcBytes && Alignment && Alignment < SrcBytes)
     Cost *= (SrcBytes/Alignment);
 
@@ -70,7 +70,7 @@ public:
   bool isIfCvtEnabled() const;
 
   virtual bool enableMachineScheduler() const {
-    return getGeneration() <= NORTHERN_ISLANDS;
+    return true;
   }
 
   // Helper functions to simplify if statements
@@ -20,6 +20,7 @@
 #include "R600MachineScheduler.h"
 #include "SIISelLowering.h"
 #include "SIInstrInfo.h"
+#include "SIMachineScheduler.h"
 #include "llvm/Analysis/Passes.h"
 #include "llvm/Analysis/Verifier.h"
 #include "llvm/CodeGen/MachineFunctionAnalysis.h"
@@ -49,6 +50,16 @@ static MachineSchedRegistry
 SchedCustomRegistry("r600", "Run R600's custom scheduler",
                     createR600MachineScheduler);
 
+static ScheduleDAGInstrs *createSIMachineScheduler(MachineSchedContext *C) {
+  ScheduleDAGMILive *DAG = new ScheduleDAGMILive(C, new SISchedStrategy(C));
+  DAG->addMutation(new SIM0LiveRangeMutation());
+  return DAG;
+}
+
+static MachineSchedRegistry
+SISchedRegistry("si", "Run SI's occupancy aware scheduler",
+                createSIMachineScheduler);
+
 static std::string computeDataLayout(const AMDGPUSubtarget &ST) {
   std::string Ret = "e-p:32:32";
 
@@ -108,7 +119,7 @@ public:
     const AMDGPUSubtarget &ST = TM->getSubtarget<AMDGPUSubtarget>();
     if (ST.getGeneration() <= AMDGPUSubtarget::NORTHERN_ISLANDS)
       return createR600MachineScheduler(C);
-    return 0;
+    return createSIMachineScheduler(C);
   }
 
   virtual bool addPreISel();
@@ -197,7 +197,9 @@ void SIInstrInfo::storeRegToStackSlot(MachineBasicBlock &MBB,
   DebugLoc DL = MBB.findDebugLoc(MI);
   unsigned KillFlag = isKill ? RegState::Kill : 0;
 
-  if (TRI->getCommonSubClass(RC, &AMDGPU::SGPR_32RegClass)) {
+  // Like the reload below, any 32-bit SGPR class, including M0, is written to
+  // a single lane; it has no sub0 to split on.
+  if (TRI->getCommonSubClass(RC, &AMDGPU::SReg_32RegClass)) {
     unsigned Lane = MFI->SpillTracker.getNextLane(MRI);
     BuildMI(MBB, MI, DL, get(AMDGPU::V_WRITELANE_B32),
             MFI->SpillTracker.LaneVGPR)
@@ -0,0 +1,241 @@
+//===-- SIMachineScheduler.cpp - SI Scheduler Interface -------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+/// \file
+/// \brief SI Machine Scheduler interface
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "misched"
+
+#include "SIMachineScheduler.h"
+#include "AMDGPU.h"
+#include "SIRegisterInfo.h"
+#include "llvm/CodeGen/MachineRegisterInfo.h"
+#include "llvm/Target/TargetInstrInfo.h"
+#include "llvm/Target/TargetMachine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+
+using namespace llvm;
+
+unsigned SISchedStrategy::getOccupancyWithNumVGPRs(unsigned NumVGPRs) {
+  // A SIMD has 256 VGPRs per lane, allocated to waves in blocks of four.
+  NumVGPRs = std::max((NumVGPRs + 3) & ~3U, 4U);
+  return std::min(256 / NumVGPRs, 10U);
+}
+
+unsigned SISchedStrategy::getOccupancyWithNumSGPRs(unsigned NumSGPRs) {
+  // A SIMD has 512 SGPRs, allocated to waves in blocks of eight.
+  NumSGPRs = std::max((NumSGPRs + 7) & ~7U, 8U);
+  return std::min(512 / NumSGPRs, 10U);
+}
+
+unsigned SISchedStrategy::getOccupancy(unsigned NumVGPRs,
+                                       unsigned NumSGPRs) const {
+  return std::min(getOccupancyWithNumVGPRs(NumVGPRs),
+                  getOccupancyWithNumSGPRs(NumSGPRs));
+}
+
+/// Return the pressure set of RC with the smallest limit, which is the one
+/// counting only the registers of that kind rather than a union with others.
+unsigned SISchedStrategy::getPressureSet(const TargetRegisterClass *RC) const {
+  const int *PSet = TRI->getRegClassPressureSets(RC);
+  assert(*PSet != -1 && "Register class without a pressure set");
+  unsigned Best = *PSet;
+  for (; *PSet != -1; ++PSet)
+    if (TRI->getRegPressureSetLimit(*PSet) < TRI->getRegPressureSetLimit(Best))
+      Best = *PSet;
+  return Best;
+}
+
+void SISchedStrategy::initialize(ScheduleDAGMI *dag) {
+  assert(dag->hasVRegLiveness() && "SISchedStrategy needs vreg liveness");
+  DAG = static_cast<ScheduleDAGMILive*>(dag);
+  SchedModel = DAG->getSchedModel();
+  TRI = DAG->TRI;
+
+  Rem.init(DAG, SchedModel);
+  Top.init(DAG, SchedModel, &Rem);
+  Bot.init(DAG, SchedModel, &Rem);
+
+  // The boundaries own their hazard recognizers, which are disabled when
+  // there are no itineraries.
+  const InstrItineraryData *Itin = SchedModel->getInstrItineraries();
+  const TargetInstrInfo *TII = DAG->MF.getTarget().getInstrInfo();
+  if (!Top.HazardRec)
+    Top.HazardRec = TII->CreateTargetMIHazardRecognizer(Itin, DAG);
+  if (!Bot.HazardRec)
+    Bot.HazardRec = TII->CreateTargetMIHazardRecognizer(Itin, DAG);
+
+  VGPRSetID = getPressureSet(&AMDGPU::VReg_32RegClass);
+  SGPRSetID = getPressureSet(&AMDGPU::SReg_32RegClass);
+}
+
+void SISchedStrategy::registerRoots() {
+  Rem.CriticalPath = DAG->ExitSU.getDepth();
+
+  // Some roots may not feed into ExitSU. Check all of them in case.
+  for (std::vector<SUnit*>::const_iterator
+         I = Bot.Available.begin(), E = Bot.Available.end(); I != E; ++I) {
+    if ((*I)->getDepth() > Rem.CriticalPath)
+      Rem.CriticalPath = (*I)->getDepth();
+  }
+  DEBUG(dbgs() << "Critical Path: " << Rem.CriticalPath << '\n');
+}
+
+/// Record the pressure left after scheduling the candidate bottom-up.
+void SISchedStrategy::initCandidate(SICandidate &Cand,
+                                    RegPressureTracker &TempTracker) {
+  TempTracker.getUpwardPressure(Cand.SU->getInstr(), Pressure, MaxPressure);
+  Cand.VGPRPressure = Pressure[VGPRSetID];
+  Cand.SGPRPressure = Pressure[SGPRSetID];
+}
+
+void SISchedStrategy::tryCandidate(SICandidate &Cand, SICandidate &TryCand) {
+  // Initialize the candidate if needed.
+  if (!Cand.isValid()) {
+    TryCand.Reason = NodeOrder;
+    return;
+  }
+
+  // Keep the occupancy the region has reached so far.
+  const std::vector<unsigned> &RegionMax =
+    DAG->getBotRPTracker().getPressure().MaxSetPressure;
+  unsigned MaxVGPR = RegionMax[VGPRSetID];
+  unsigned MaxSGPR = RegionMax[SGPRSetID];
+  if (tryGreater(getOccupancy(std::max(TryCand.VGPRPressure, MaxVGPR),
+                              std::max(TryCand.SGPRPressure, MaxSGPR)),
+                 getOccupancy(std::max(Cand.VGPRPressure, MaxVGPR),
+                              std::max(Cand.SGPRPressure, MaxSGPR)),
+                 TryCand, Cand, RegExcess))
+    return;
+
+  // Avoid raising the peak VGPR pressure, which gets the region closer to
+  // the next threshold.
+  if (tryLess(std::max(TryCand.VGPRPressure, MaxVGPR),
+              std::max(Cand.VGPRPressure, MaxVGPR),
+              TryCand, Cand, RegCritical))
+    return;
+
+  // Prioritize instructions that read unbuffered resources by stall cycles.
+  if (tryLess(Bot.getLatencyStallCycles(TryCand.SU),
+              Bot.getLatencyStallCycles(Cand.SU), TryCand, Cand, Stall))
+    return;
+
+  if (Cand.Policy.ReduceLatency && tryLatency(TryCand, Cand, Bot))
+    return;
+
+  // Within the peak, keep live ranges short.
+  if (tryLess(TryCand.VGPRPressure, Cand.VGPRPressure,
+              TryCand, Cand, RegMax))
+    return;
+
+  // Fall through to original instruction order.
+  if (TryCand.SU->NodeNum > Cand.SU->NodeNum)
+    TryCand.Reason = NodeOrder;
+}
+
+void SISchedStrategy::pickNodeFromQueue(SICandidate &Cand) {
+  ReadyQueue &Q = Bot.Available;
+
+  DEBUG(Q.dump());
+
+  // getUpwardPressure temporarily modifies the tracker.
+  RegPressureTracker &TempTracker =
+    const_cast<RegPressureTracker&>(DAG->getBotRPTracker());
+
+  for (ReadyQueue::iterator I = Q.begin(), E = Q.end(); I != E; ++I) {
+    SICandidate TryCand(Cand.Policy);
+    TryCand.SU = *I;
+    initCandidate(TryCand, TempTracker);
+    tryCandidate(Cand, TryCand);
+    if (TryCand.Reason != NoCand) {
+      Cand.setBest(TryCand);
+      DEBUG(traceCandidate(Cand));
+    }
+  }
+}
+
+SUnit *SISchedStrategy::pickNode(bool &IsTopNode) {
+  if (DAG->top() == DAG->bottom()) {
+    assert(Top.Available.empty() && Top.Pending.empty() &&
+           Bot.Available.empty() && Bot.Pending.empty() && "ReadyQ garbage");
+    return NULL;
+  }
+  SUnit *SU;
+  do {
+    SU = Bot.pickOnlyChoice();
+    if (!SU) {
+      CandPolicy NoPolicy;
+      SICandidate BotCand(NoPolicy);
+      setPolicy(BotCand.Policy, /*IsPostRA=*/false, Bot, &Top);
+      pickNodeFromQueue(BotCand);
+      assert(BotCand.Reason != NoCand && "failed to find a candidate");
+      DEBUG(dbgs() << "Pick Bot " << getReasonStr(BotCand.Reason) << " VGPR "
+                   << BotCand.VGPRPressure << " SGPR "
+                   << BotCand.SGPRPressure << '\n');
+      SU = BotCand.SU;
+    }
+    IsTopNode = false;
+  } while (SU->isScheduled);
+
+  if (SU->isTopReady())
+    Top.removeReady(SU);
+  if (SU->isBottomReady())
+    Bot.removeReady(SU);
+
+  DEBUG(dbgs() << "Scheduling SU(" << SU->NodeNum << ") " << *SU->getInstr());
+  return SU;
+}
+
+void SISchedStrategy::schedNode(SUnit *SU, bool IsTopNode) {
+  assert(!IsTopNode && "SISchedStrategy only schedules bottom-up");
+  SU->BotReadyCycle = std::max(SU->BotReadyCycle, Bot.getCurrCycle());
+  Bot.bumpNode(SU);
+}
+
+/// Return true if MO is a virtual register of the M0 class.
+static bool isM0VirtReg(const MachineOperand &MO,
+                        const MachineRegisterInfo &MRI) {
+  return MO.isReg() && TargetRegisterInfo::isVirtualRegister(MO.getReg()) &&
+         MRI.getRegClass(MO.getReg()) == &AMDGPU::M0RegRegClass;
+}
+
+void SIM0LiveRangeMutation::apply(ScheduleDAGMI *DAG) {
+  const MachineRegisterInfo &MRI = DAG->MF.getRegInfo();
+
+  // The readers of the M0 value defined last, in the original order; the
+  // definition itself stands in when nothing has read it yet.
+  SmallVector<SUnit*, 8> Readers;
+  for (unsigned Idx = 0, End = DAG->SUnits.size(); Idx != End; ++Idx) {
+    SUnit *SU = &DAG->SUnits[Idx];
+    const MachineInstr *MI = SU->getInstr();
+    bool Reads = false, Defines = false;
+    for (MachineInstr::const_mop_iterator I = MI->operands_begin(),
+           E = MI->operands_end(); I != E; ++I) {
+      if (!isM0VirtReg(*I, MRI))
+        continue;
+      if (I->isDef())
+        Defines = true;
+      else if (I->readsReg())
+        Reads = true;
+    }
+    if (Reads)
+      Readers.push_back(SU);
+    if (!Defines)
+      continue;
+    for (unsigned i = 0, e = Readers.size(); i != e; ++i)
+      if (Readers[i] != SU)
+        DAG->addEdge(SU, SDep(Readers[i], SDep::Artificial));
+    Readers.clear();
+    Readers.push_back(SU);
+  }
+}
@@ -0,0 +1,114 @@
+//===-- SIMachineScheduler.h - SI Scheduler Interface -----------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+/// \file
+/// \brief SI Machine Scheduler interface
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SIMACHINESCHEDULER_H_
+#define SIMACHINESCHEDULER_H_
+
+#include "llvm/CodeGen/MachineScheduler.h"
+#include "llvm/CodeGen/RegisterPressure.h"
+
+namespace llvm {
+
+/// \brief A bottom-up scheduling strategy that keeps the number of waves a
+/// compute unit can run at once.
+///
+/// The number of waves resident on a SIMD is limited by the VGPRs and SGPRs
+/// each of them uses, and a wave more or less hides a good part of the
+/// memory latency.  Each time the pressure of a candidate would cross one of
+/// these occupancy thresholds a candidate that does not is preferred, and
+/// among the rest the ones that do not raise the peak pressure of the
+/// region.  The latency heuristics of GenericSchedulerBase decide what is
+/// left.
+class SISchedStrategy : public GenericSchedulerBase {
+  /// \brief A candidate with the pressure it leaves behind.
+  struct SICandidate : public SchedCandidate {
+    unsigned VGPRPressure;
+    unsigned SGPRPressure;
+
+    SICandidate(const CandPolicy &Policy)
+      : SchedCandidate(Policy), VGPRPressure(0), SGPRPressure(0) {}
+
+    void setBest(SICandidate &Best) {
+      SchedCandidate::setBest(Best);
+      VGPRPressure = Best.VGPRPressure;
+      SGPRPressure = Best.SGPRPressure;
+    }
+  };
+
+  ScheduleDAGMILive *DAG;
+
+  SchedBoundary Top;
+  SchedBoundary Bot;
+
+  /// The pressure sets counting VGPRs and SGPRs.
+  unsigned VGPRSetID;
+  unsigned SGPRSetID;
+
+  std::vector<unsigned> Pressure;
+  std::vector<unsigned> MaxPressure;
+
+public:
+  SISchedStrategy(const MachineSchedContext *C)
+    : GenericSchedulerBase(C), DAG(0), Top(SchedBoundary::TopQID, "TopQ"),
+      Bot(SchedBoundary::BotQID, "BotQ"), VGPRSetID(0), SGPRSetID(0) {}
+
+  /// \returns the number of waves a SIMD can run when each of them uses
+  /// \p NumVGPRs vector registers.
+  static unsigned getOccupancyWithNumVGPRs(unsigned NumVGPRs);
+
+  /// \returns the number of waves a SIMD can run when each of them uses
+  /// \p NumSGPRs scalar registers.
+  static unsigned getOccupancyWithNumSGPRs(unsigned NumSGPRs);
+
+  virtual bool shouldTrackPressure() const LLVM_OVERRIDE { return true; }
+
+  virtual void initialize(ScheduleDAGMI *dag) LLVM_OVERRIDE;
+
+  virtual void registerRoots() LLVM_OVERRIDE;
+
+  virtual SUnit *pickNode(bool &IsTopNode) LLVM_OVERRIDE;
+
+  virtual void schedNode(SUnit *SU, bool IsTopNode) LLVM_OVERRIDE;
+
+  virtual void releaseTopNode(SUnit *SU) LLVM_OVERRIDE {
+    Top.releaseTopNode(SU);
+  }
+
+  virtual void releaseBottomNode(SUnit *SU) LLVM_OVERRIDE {
+    Bot.releaseBottomNode(SU);
+  }
+
+private:
+  unsigned getPressureSet(const TargetRegisterClass *RC) const;
+  unsigned getOccupancy(unsigned NumVGPRs, unsigned NumSGPRs) const;
+  void initCandidate(SICandidate &Cand, RegPressureTracker &TempTracker);
+  void tryCandidate(SICandidate &Cand, SICandidate &TryCand);
+  void pickNodeFromQueue(SICandidate &Cand);
+};
+
+/// \brief Keeps the live ranges of M0 values apart.
+///
+/// M0 is the only register of its class, so two M0 values that are live at
+/// the same time force a spill, which the SGPR lane spilling cannot undo
+/// cleanly.  Instruction selection copies a value into M0 right before each
+/// group of its users; this mutation makes every such copy wait for the
+/// users of the previous M0 value, so no schedule overlaps them.
+class SIM0LiveRangeMutation : public ScheduleDAGMutation {
+public:
+  virtual void apply(ScheduleDAGMI *DAG) LLVM_OVERRIDE;
+};
+
+} // namespace llvm
+
+#endif /* SIMACHINESCHEDULER_H_ */
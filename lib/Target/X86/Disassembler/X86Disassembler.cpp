@@ -81,16 +81,33 @@ X86GenericDisassembler::~X86GenericDisassembler() {
   delete MII;
 }
 
-/// regionReader - a callback function that wraps the readByte method from
-///   MemoryObject.
+namespace {
+/// InstructionBytes - The bytes of one instruction, read from a MemoryObject
+///   in a single readBytes call so that the decoder, which looks at most
+///   bytes several times, does not go through the virtual readByte for each.
+struct InstructionBytes {
+  enum { MaxLength = 15 }; // Longest legal x86 instruction.
+  uint8_t Bytes[MaxLength];
+  uint64_t Start;
+  uint64_t Size;
+  const MemoryObject* Region;
+};
+}
+
+/// bufferReader - a callback function that reads from an InstructionBytes,
+///   and from the underlying MemoryObject for bytes outside of it.
 ///
 /// @param arg      - The generic callback parameter.  In this case, this should
-///                   be a pointer to a MemoryObject.
+///                   be a pointer to an InstructionBytes.
 /// @param byte     - A pointer to the byte to be read.
 /// @param address  - The address to be read.
-static int regionReader(const void* arg, uint8_t* byte, uint64_t address) {
-  const MemoryObject* region = static_cast<const MemoryObject*>(arg);
-  return region->readByte(address, byte);
+static int bufferReader(const void* arg, uint8_t* byte, uint64_t address) {
+  const InstructionBytes* buffer = static_cast<const InstructionBytes*>(arg);
+  uint64_t offset = address - buffer->Start;
+  if (offset >= buffer->Size)
+    return buffer->Region->readByte(address, byte);
+  *byte = buffer->Bytes[offset];
+  return 0;
 }
 
 /// logger - a callback function that wraps the operator<< method from
@@ -126,9 +143,23 @@ X86GenericDisassembler::getInstruction(MCInst &instr,
   if (&vStream == &nulls())
     loggerFn = 0; // Disable logging completely if it's going to nulls().
   
+  // Read as many bytes as the longest instruction needs up front. Anything
+  // the region can't provide in one go is read byte by byte as before.
+  InstructionBytes buffer;
+  buffer.Start = address;
+  buffer.Size = 0;
+  buffer.Region = &region;
+  uint64_t limit = region.getBase() + region.getExtent();
+  if (address >= region.getBase() && address < limit) {
+    buffer.Size = std::min<uint64_t>(InstructionBytes::MaxLength,
+                                     limit - address);
+    if (region.readBytes(address, buffer.Size, buffer.Bytes))
+      buffer.Size = 0;
+  }
+
   int ret = decodeInstruction(&internalInstr,
-                              regionReader,
-                              (const void*)&region,
+                              bufferReader,
+                              (const void*)&buffer,
                               loggerFn,
                               (void*)&vStream,
                               (const void*)MII,
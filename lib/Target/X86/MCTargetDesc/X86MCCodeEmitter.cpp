@@ -23,11 +23,40 @@
 #include "llvm/MC/MCRegisterInfo.h"
 #include "llvm/MC/MCSubtargetInfo.h"
 #include "llvm/MC/MCSymbol.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/raw_ostream.h"
 
 using namespace llvm;
 
+static cl::opt<bool>
+EnableFastEncoding("x86-fast-encoding", cl::Hidden, cl::init(true),
+  cl::desc("Encode common X86 instruction forms from the tblgen'd tables"));
+
 namespace {
+
+/// X86FastEncoding - The precomputed prefix and opcode bytes of an
+/// instruction with a legacy register or immediate form, generated by
+/// tblgen -gen-x86-encoding.  Instructions with a Pseudo form use the general
+/// encoder.
+struct X86FastEncoding {
+  uint8_t Form;           // X86II form, or X86II::Pseudo if not described.
+  uint8_t Flags;          // X86FastEncodingFlags.
+  uint8_t ImmSize;        // Size of the trailing immediate, or 0.
+  uint8_t Prefix;         // Mandatory prefix (F2, F3 or D8-DF), or 0.
+  uint8_t NumEscapeBytes; // Number of opcode escape bytes (0F, 0F 38, ...).
+  uint8_t EscapeBytes[2];
+  uint8_t BaseOpcode;
+};
+
+enum X86FastEncodingFlags {
+  FastLock     = 1 << 0,  // F0 prefix.
+  FastRep      = 1 << 1,  // F3 repeat prefix.
+  FastOpSize   = 1 << 2,  // 66 prefix outside of 16-bit mode.
+  FastOpSize16 = 1 << 3   // 66 prefix in 16-bit mode.
+};
+
+#include "X86GenEncoding.inc"
+
 class X86MCCodeEmitter : public MCCodeEmitter {
   X86MCCodeEmitter(const X86MCCodeEmitter &) LLVM_DELETED_FUNCTION;
   void operator=(const X86MCCodeEmitter &) LLVM_DELETED_FUNCTION;
@@ -136,6 +165,10 @@ public:
   void EncodeInstruction(const MCInst &MI, raw_ostream &OS,
                          SmallVectorImpl<MCFixup> &Fixups) const;
 
+  bool EncodeInstructionFast(const MCInst &MI, const MCInstrDesc &Desc,
+                             raw_ostream &OS,
+                             SmallVectorImpl<MCFixup> &Fixups) const;
+
   void EmitVEXOpcodePrefix(uint64_t TSFlags, unsigned &CurByte, int MemOperand,
                            const MCInst &MI, const MCInstrDesc &Desc,
                            raw_ostream &OS) const;
@@ -220,6 +253,18 @@ static MCFixupKind getImmFixupKind(uint64_t TSFlags) {
   return MCFixup::getKindForSize(Size, isPCRel);
 }
 
+/// getTrailingImmFixupKind - Return the fixup kind to use for the trailing
+/// immediate of the specified instruction.
+static MCFixupKind getTrailingImmFixupKind(unsigned Opcode, uint64_t TSFlags) {
+  // FIXME: Is there a better way to know that we need a signed relocation?
+  if (Opcode == X86::ADD64ri32 ||
+      Opcode == X86::MOV64ri32 ||
+      Opcode == X86::MOV64mi32 ||
+      Opcode == X86::PUSH64i32)
+    return MCFixupKind(X86::reloc_signed_4byte);
+  return getImmFixupKind(TSFlags);
+}
+
 /// Is32BitMemOperand - Return true if the specified instruction has
 /// a 32-bit memory operand. Op specifies the operand # of the memoperand.
 static bool Is32BitMemOperand(const MCInst &MI, unsigned Op) {
@@ -1251,6 +1296,86 @@ void X86MCCodeEmitter::EmitOpcodePrefix(uint64_t TSFlags, unsigned &CurByte,
   }
 }
 
+/// EncodeInstructionFast - Encode an instruction with a legacy register or
+/// immediate form from its X86FastEncoding template, without decoding TSFlags
+/// or looking for a memory operand.  Return false, having emitted nothing, if
+/// the instruction needs the general encoder.
+bool X86MCCodeEmitter::
+EncodeInstructionFast(const MCInst &MI, const MCInstrDesc &Desc,
+                      raw_ostream &OS,
+                      SmallVectorImpl<MCFixup> &Fixups) const {
+  const X86FastEncoding &FE = X86FastEncodings[MI.getOpcode()];
+  if (FE.Form == X86II::Pseudo)
+    return false;
+
+  // The register operands encoded by the form, followed by the immediate if
+  // any, have to account for all of the operands.
+  unsigned NumOps = Desc.getNumOperands();
+  unsigned CurOp = X86II::getOperandBias(Desc);
+  unsigned NumRegOps;
+  switch (FE.Form) {
+  case X86II::RawFrm:     NumRegOps = 0; break;
+  case X86II::MRMDestReg:
+  case X86II::MRMSrcReg:  NumRegOps = 2; break;
+  default:                NumRegOps = 1; break;
+  }
+  if (CurOp + NumRegOps + (FE.ImmSize != 0) != NumOps)
+    return false;
+
+  unsigned CurByte = 0;
+  if (FE.Flags & FastLock)
+    EmitByte(0xF0, CurByte, OS);
+  if (FE.Flags & FastRep)
+    EmitByte(0xF3, CurByte, OS);
+  if (FE.Flags & (is16BitMode() ? FastOpSize16 : FastOpSize))
+    EmitByte(0x66, CurByte, OS);
+  if (FE.Prefix)
+    EmitByte(FE.Prefix, CurByte, OS);
+
+  if (is64BitMode()) {
+    if (unsigned REX = DetermineREXPrefix(MI, Desc.TSFlags, Desc))
+      EmitByte(0x40 | REX, CurByte, OS);
+  }
+
+  for (unsigned i = 0; i != FE.NumEscapeBytes; ++i)
+    EmitByte(FE.EscapeBytes[i], CurByte, OS);
+
+  switch (FE.Form) {
+  case X86II::RawFrm:
+    EmitByte(FE.BaseOpcode, CurByte, OS);
+    break;
+  case X86II::AddRegFrm:
+    EmitByte(FE.BaseOpcode + GetX86RegNum(MI.getOperand(CurOp++)), CurByte,
+             OS);
+    break;
+  case X86II::MRMDestReg:
+    EmitByte(FE.BaseOpcode, CurByte, OS);
+    EmitRegModRMByte(MI.getOperand(CurOp),
+                     GetX86RegNum(MI.getOperand(CurOp + 1)), CurByte, OS);
+    CurOp += 2;
+    break;
+  case X86II::MRMSrcReg:
+    EmitByte(FE.BaseOpcode, CurByte, OS);
+    EmitRegModRMByte(MI.getOperand(CurOp + 1),
+                     GetX86RegNum(MI.getOperand(CurOp)), CurByte, OS);
+    CurOp += 2;
+    break;
+  default:
+    assert(FE.Form >= X86II::MRM0r && FE.Form <= X86II::MRM7r &&
+           "Unexpected form in the fast encoding table!");
+    EmitByte(FE.BaseOpcode, CurByte, OS);
+    EmitRegModRMByte(MI.getOperand(CurOp++), FE.Form - X86II::MRM0r,
+                     CurByte, OS);
+    break;
+  }
+
+  if (FE.ImmSize)
+    EmitImmediate(MI.getOperand(CurOp++), MI.getLoc(), FE.ImmSize,
+                  getTrailingImmFixupKind(MI.getOpcode(), Desc.TSFlags),
+                  CurByte, OS, Fixups);
+  return true;
+}
+
 void X86MCCodeEmitter::
 EncodeInstruction(const MCInst &MI, raw_ostream &OS,
                   SmallVectorImpl<MCFixup> &Fixups) const {
@@ -1262,6 +1387,11 @@ EncodeInstruction(const MCInst &MI, raw_ostream &OS,
   if ((TSFlags & X86II::FormMask) == X86II::Pseudo)
     return;
 
+  // Most instructions in practice have a simple register or immediate form
+  // that the tblgen'd tables describe completely.
+  if (EnableFastEncoding && EncodeInstructionFast(MI, Desc, OS, Fixups))
+    return;
+
   unsigned NumOps = Desc.getNumOperands();
   unsigned CurOp = X86II::getOperandBias(Desc);
 
@@ -1500,17 +1630,9 @@ EncodeInstruction(const MCInst &MI, raw_ostream &OS,
       EmitImmediate(MCOperand::CreateImm(RegNum), MI.getLoc(), 1, FK_Data_1,
                     CurByte, OS, Fixups);
     } else {
-      unsigned FixupKind;
-      // FIXME: Is there a better way to know that we need a signed relocation?
-      if (MI.getOpcode() == X86::ADD64ri32 ||
-          MI.getOpcode() == X86::MOV64ri32 ||
-          MI.getOpcode() == X86::MOV64mi32 ||
-          MI.getOpcode() == X86::PUSH64i32)
-        FixupKind = X86::reloc_signed_4byte;
-      else
-        FixupKind = getImmFixupKind(TSFlags);
       EmitImmediate(MI.getOperand(CurOp++), MI.getLoc(),
-                    X86II::getSizeOfImm(TSFlags), MCFixupKind(FixupKind),
+                    X86II::getSizeOfImm(TSFlags),
+                    getTrailingImmFixupKind(MI.getOpcode(), TSFlags),
                     CurByte, OS, Fixups);
     }
   }
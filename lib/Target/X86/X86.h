@@ -75,6 +75,10 @@ FunctionPass *createX86PadShortFunctions();
 /// to eliminate execution delays in some Atom processors.
 FunctionPass *createX86FixupLEAs();
 
+/// createX86AlignHotLoops - Return a pass that aligns small, hot innermost
+/// loops to the 32-byte windows of the decoded instruction cache.
+FunctionPass *createX86AlignHotLoops();
+
 } // End llvm namespace
 
 #endif
@@ -0,0 +1,138 @@
+//===-- X86AlignHotLoops.cpp - Align hot loops to decode windows ----------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines a pass that aligns the headers of small, hot innermost
+// loops to the 32-byte windows used by the decoded instruction cache of
+// recent Intel cores. A loop that fits in one or two windows then starts on a
+// window boundary, so its body, including the compare and branch that close
+// it, spans as few windows as possible and fused compare/branch pairs are
+// less likely to be split.
+//
+// Code sizes are not known before emission, so loop size is estimated from
+// the instruction count. The padding is only added where block frequency
+// says the loop runs many times for each time the padding is executed.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "x86-align-hot-loops"
+#include "X86.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/CodeGen/MachineBlockFrequencyInfo.h"
+#include "llvm/CodeGen/MachineFunction.h"
+#include "llvm/CodeGen/MachineFunctionPass.h"
+#include "llvm/CodeGen/MachineLoopInfo.h"
+#include "llvm/IR/Function.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace llvm;
+
+STATISTIC(NumLoopsAligned, "Number of hot loop headers aligned");
+
+static cl::opt<unsigned>
+MaxLoopSize("x86-align-hot-loops-max-size", cl::Hidden, cl::init(64),
+  cl::desc("Estimated size in bytes of the largest loop to align"));
+
+static cl::opt<unsigned>
+MinTripRatio("x86-align-hot-loops-min-ratio", cl::Hidden, cl::init(8),
+  cl::desc("Minimum header frequency, relative to the frequency of falling "
+           "through into the padding, for a loop to be aligned"));
+
+namespace {
+  struct AlignHotLoops : public MachineFunctionPass {
+    static char ID;
+    AlignHotLoops() : MachineFunctionPass(ID) {}
+
+    virtual bool runOnMachineFunction(MachineFunction &MF);
+
+    virtual void getAnalysisUsage(AnalysisUsage &AU) const {
+      AU.setPreservesAll();
+      AU.addRequired<MachineBlockFrequencyInfo>();
+      AU.addRequired<MachineLoopInfo>();
+      MachineFunctionPass::getAnalysisUsage(AU);
+    }
+
+    virtual const char *getPassName() const {
+      return "X86 align hot loops";
+    }
+  };
+
+  char AlignHotLoops::ID = 0;
+}
+
+FunctionPass *llvm::createX86AlignHotLoops() {
+  return new AlignHotLoops();
+}
+
+/// Log2 of the size of a decoded instruction cache window.
+static const unsigned WindowAlign = 5;
+
+/// Rough average size of an x86 instruction in bytes.
+static const unsigned AvgInstrSize = 4;
+
+bool AlignHotLoops::runOnMachineFunction(MachineFunction &MF) {
+  const AttributeSet &FnAttrs = MF.getFunction()->getAttributes();
+  if (FnAttrs.hasAttribute(AttributeSet::FunctionIndex,
+                           Attribute::OptimizeForSize) ||
+      FnAttrs.hasAttribute(AttributeSet::FunctionIndex,
+                           Attribute::MinSize))
+    return false;
+
+  MachineLoopInfo &MLI = getAnalysis<MachineLoopInfo>();
+  MachineBlockFrequencyInfo &MBFI = getAnalysis<MachineBlockFrequencyInfo>();
+
+  SmallVector<MachineLoop*, 8> Loops;
+  MLI.getInnermostLoops(Loops);
+
+  bool MadeChange = false;
+  for (unsigned i = 0, e = Loops.size(); i != e; ++i) {
+    MachineLoop *L = Loops[i];
+
+    // The first block in the layout is the one that needs the alignment.
+    // Block placement may have rotated the loop so that it is not the header.
+    MachineFunction::iterator TopI = MF.begin();
+    while (!L->contains(TopI))
+      ++TopI;
+    MachineBasicBlock *Top = TopI;
+    if (Top->getAlignment() >= WindowAlign)
+      continue;
+
+    unsigned NumInstrs = 0;
+    for (MachineLoop::block_iterator BI = L->block_begin(),
+         BE = L->block_end(); BI != BE; ++BI)
+      for (MachineBasicBlock::iterator MI = (*BI)->begin(),
+           ME = (*BI)->end(); MI != ME; ++MI)
+        if (!MI->isDebugValue())
+          ++NumInstrs;
+    if (NumInstrs * AvgInstrSize > MaxLoopSize)
+      continue;
+
+    // The padding executes whenever the layout predecessor falls through
+    // into the loop. Only pay for it if the loop runs many times per entry.
+    BlockFrequency PadFreq;
+    if (TopI != MF.begin()) {
+      MachineBasicBlock *Prev = llvm::prior(TopI);
+      if (Prev->isSuccessor(Top) && Prev->canFallThrough())
+        PadFreq = MBFI.getBlockFreq(Prev);
+    }
+    BlockFrequency HeaderFreq = MBFI.getBlockFreq(L->getHeader());
+    if (HeaderFreq.getFrequency() <
+        PadFreq.getFrequency() * (uint64_t)MinTripRatio)
+      continue;
+
+    DEBUG(dbgs() << "Aligning BB#" << Top->getNumber() << " in "
+                 << MF.getName() << ", about " << NumInstrs * AvgInstrSize
+                 << " bytes\n");
+    Top->setAlignment(WindowAlign);
+    ++NumLoopsAligned;
+    MadeChange = true;
+  }
+  return MadeChange;
+}
@@ -1726,12 +1726,32 @@ bool X86FastISel::X86VisitIntrinsicCall(const IntrinsicInst &I) {
     BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, DL, TII.get(X86::TRAP));
     return true;
   }
+  case Intrinsic::sqrt: {
+    MVT VT;
+    if (!isTypeLegal(I.getType(), VT))
+      return false;
+    if (!(VT == MVT::f32 && X86ScalarSSEf32) &&
+        !(VT == MVT::f64 && X86ScalarSSEf64))
+      return false;
+
+    unsigned OpReg = getRegForValue(I.getArgOperand(0));
+    if (OpReg == 0)
+      return false;
+    unsigned ResultReg = FastEmit_r(VT, VT, ISD::FSQRT, OpReg,
+                                    /*Op0IsKill=*/false);
+    if (ResultReg == 0)
+      return false;
+    UpdateValueMap(&I, ResultReg);
+    return true;
+  }
   case Intrinsic::sadd_with_overflow:
-  case Intrinsic::uadd_with_overflow: {
+  case Intrinsic::uadd_with_overflow:
+  case Intrinsic::ssub_with_overflow:
+  case Intrinsic::usub_with_overflow: {
     // FIXME: Should fold immediates.
 
-    // Replace "add with overflow" intrinsics with an "add" instruction followed
-    // by a seto/setc instruction.
+    // Replace "add/sub with overflow" intrinsics with an "add" or "sub"
+    // instruction followed by a seto/setc instruction.
     const Function *Callee = I.getCalledFunction();
     Type *RetTy =
       cast<StructType>(Callee->getReturnType())->getTypeAtIndex(unsigned(0));
@@ -1749,11 +1769,13 @@ bool X86FastISel::X86VisitIntrinsicCall(const IntrinsicInst &I) {
       // FIXME: Handle values *not* in registers.
       return false;
 
+    bool IsSub = I.getIntrinsicID() == Intrinsic::ssub_with_overflow ||
+                 I.getIntrinsicID() == Intrinsic::usub_with_overflow;
     unsigned OpC = 0;
     if (VT == MVT::i32)
-      OpC = X86::ADD32rr;
+      OpC = IsSub ? X86::SUB32rr : X86::ADD32rr;
     else if (VT == MVT::i64)
-      OpC = X86::ADD64rr;
+      OpC = IsSub ? X86::SUB64rr : X86::ADD64rr;
     else
       return false;
 
@@ -1764,7 +1786,8 @@ bool X86FastISel::X86VisitIntrinsicCall(const IntrinsicInst &I) {
       .addReg(Reg1).addReg(Reg2);
 
     unsigned Opc = X86::SETBr;
-    if (I.getIntrinsicID() == Intrinsic::sadd_with_overflow)
+    if (I.getIntrinsicID() == Intrinsic::sadd_with_overflow ||
+        I.getIntrinsicID() == Intrinsic::ssub_with_overflow)
       Opc = X86::SETOr;
     BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, DL, TII.get(Opc), ResultReg+1);
 
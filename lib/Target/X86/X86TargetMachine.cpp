@@ -151,6 +151,10 @@ static cl::opt<bool>
 X86EarlyIfConv("x86-early-ifcvt", cl::Hidden,
 	       cl::desc("Enable early if-conversion on X86"));
 
+static cl::opt<bool>
+X86AlignHotLoopsOpt("x86-align-hot-loops", cl::Hidden,
+  cl::desc("Align small hot loops to 32-byte decode windows"));
+
 //===----------------------------------------------------------------------===//
 // X86 Analysis Pass Setup
 //===----------------------------------------------------------------------===//
@@ -249,6 +253,10 @@ bool X86PassConfig::addPreEmitPass() {
     addPass(createX86FixupLEAs());
     ShouldPrint = true;
   }
+  if (getOptLevel() != CodeGenOpt::None && X86AlignHotLoopsOpt) {
+    addPass(createX86AlignHotLoops());
+    ShouldPrint = true;
+  }
 
   return ShouldPrint;
 }
@@ -99,6 +99,10 @@ public:
   virtual unsigned getMemoryOpCost(unsigned Opcode, Type *Src,
                                    unsigned Alignment,
                                    unsigned AddressSpace) const;
+  virtual unsigned getInterleavedMemoryOpCost(unsigned Opcode, Type *VecTy,
+                                              unsigned Factor,
+                                              unsigned Alignment,
+                                              unsigned AddressSpace) const;
 
   virtual unsigned getAddressComputationCost(Type *PtrTy, bool IsComplex) const;
   
@@ -138,13 +142,17 @@ unsigned X86TTI::getNumberOfRegisters(bool Vector) const {
   if (Vector && !ST->hasSSE1())
     return 0;
 
-  if (ST->is64Bit())
+  if (ST->is64Bit()) {
+    if (Vector && ST->hasAVX512())
+      return 32;
     return 16;
+  }
   return 8;
 }
 
 unsigned X86TTI::getRegisterBitWidth(bool Vector) const {
   if (Vector) {
+    if (ST->hasAVX512()) return 512;
     if (ST->hasAVX()) return 256;
     if (ST->hasSSE1()) return 128;
     return 0;
@@ -177,6 +185,30 @@ unsigned X86TTI::getArithmeticInstrCost(unsigned Opcode, Type *Ty,
   int ISD = TLI->InstructionOpcodeToISD(Opcode);
   assert(ISD && "Invalid opcode");
 
+  static const CostTblEntry<MVT::SimpleValueType> AVX512CostTable[] = {
+    { ISD::SHL,     MVT::v16i32,    1 },
+    { ISD::SRL,     MVT::v16i32,    1 },
+    { ISD::SRA,     MVT::v16i32,    1 },
+    { ISD::SHL,     MVT::v8i64,     1 },
+    { ISD::SRL,     MVT::v8i64,     1 },
+    { ISD::SRA,     MVT::v8i64,     1 },
+
+    { ISD::MUL,     MVT::v16i32,    1 }, // pmulld
+    { ISD::MUL,     MVT::v8i64,     5 }, // Custom lowered: 3 pmuludq + shifts.
+
+    // Vectorizing division is a bad idea. See the SSE2 table for more comments.
+    { ISD::SDIV,    MVT::v16i32,    16*20 },
+    { ISD::SDIV,    MVT::v8i64,     8*20 },
+    { ISD::UDIV,    MVT::v16i32,    16*20 },
+    { ISD::UDIV,    MVT::v8i64,     8*20 },
+  };
+
+  if (ST->hasAVX512()) {
+    int Idx = CostTableLookup(AVX512CostTable, ISD, LT.second);
+    if (Idx != -1)
+      return LT.first * AVX512CostTable[Idx].Cost;
+  }
+
   static const CostTblEntry<MVT::SimpleValueType> AVX2CostTable[] = {
     // Shifts on v4i64/v8i32 on AVX2 is legal even though we declare to
     // customize them to detect the cases where shift amount is a scalar one.
@@ -399,6 +431,40 @@ unsigned X86TTI::getCastInstrCost(unsigned Opcode, Type *Dst, Type *Src) const {
   if (!SrcTy.isSimple() || !DstTy.isSimple())
     return TargetTransformInfo::getCastInstrCost(Opcode, Dst, Src);
 
+  static const TypeConversionCostTblEntry<MVT::SimpleValueType>
+  AVX512ConversionTbl[] = {
+    { ISD::FP_EXTEND,   MVT::v8f64,  MVT::v8f32,  1 },
+    { ISD::FP_ROUND,    MVT::v8f32,  MVT::v8f64,  1 },
+
+    { ISD::TRUNCATE,    MVT::v16i8,  MVT::v16i32, 1 },
+    { ISD::TRUNCATE,    MVT::v16i16, MVT::v16i32, 1 },
+    { ISD::TRUNCATE,    MVT::v8i16,  MVT::v8i64,  1 },
+    { ISD::TRUNCATE,    MVT::v8i32,  MVT::v8i64,  1 },
+
+    { ISD::SIGN_EXTEND, MVT::v16i32, MVT::v16i8,  1 },
+    { ISD::SIGN_EXTEND, MVT::v16i32, MVT::v16i16, 1 },
+    { ISD::SIGN_EXTEND, MVT::v8i64,  MVT::v8i16,  1 },
+    { ISD::SIGN_EXTEND, MVT::v8i64,  MVT::v8i32,  1 },
+    { ISD::ZERO_EXTEND, MVT::v16i32, MVT::v16i8,  1 },
+    { ISD::ZERO_EXTEND, MVT::v16i32, MVT::v16i16, 1 },
+    { ISD::ZERO_EXTEND, MVT::v8i64,  MVT::v8i16,  1 },
+    { ISD::ZERO_EXTEND, MVT::v8i64,  MVT::v8i32,  1 },
+
+    { ISD::SINT_TO_FP,  MVT::v16f32, MVT::v16i32, 1 },
+    { ISD::SINT_TO_FP,  MVT::v8f64,  MVT::v8i32,  1 },
+    { ISD::UINT_TO_FP,  MVT::v16f32, MVT::v16i32, 1 },
+    { ISD::UINT_TO_FP,  MVT::v8f64,  MVT::v8i32,  1 },
+    { ISD::FP_TO_SINT,  MVT::v16i32, MVT::v16f32, 1 },
+    { ISD::FP_TO_UINT,  MVT::v16i32, MVT::v16f32, 1 },
+  };
+
+  if (ST->hasAVX512()) {
+    int Idx = ConvertCostTableLookup(AVX512ConversionTbl, ISD,
+                                     DstTy.getSimpleVT(), SrcTy.getSimpleVT());
+    if (Idx != -1)
+      return AVX512ConversionTbl[Idx].Cost;
+  }
+
   static const TypeConversionCostTblEntry<MVT::SimpleValueType>
   AVXConversionTbl[] = {
     { ISD::SIGN_EXTEND, MVT::v16i16, MVT::v16i8, 1 },
@@ -493,6 +559,24 @@ unsigned X86TTI::getCmpSelInstrCost(unsigned Opcode, Type *ValTy,
     { ISD::SETCC,   MVT::v32i8,   1 },
   };
 
+  // Compares write a mask register and selects are masked moves.
+  static const CostTblEntry<MVT::SimpleValueType> AVX512CostTbl[] = {
+    { ISD::SETCC,   MVT::v8i64,   1 },
+    { ISD::SETCC,   MVT::v16i32,  1 },
+    { ISD::SETCC,   MVT::v8f64,   1 },
+    { ISD::SETCC,   MVT::v16f32,  1 },
+    { ISD::SELECT,  MVT::v8i64,   1 },
+    { ISD::SELECT,  MVT::v16i32,  1 },
+    { ISD::SELECT,  MVT::v8f64,   1 },
+    { ISD::SELECT,  MVT::v16f32,  1 },
+  };
+
+  if (ST->hasAVX512()) {
+    int Idx = CostTableLookup(AVX512CostTbl, ISD, MTy);
+    if (Idx != -1)
+      return LT.first * AVX512CostTbl[Idx].Cost;
+  }
+
   if (ST->hasAVX2()) {
     int Idx = CostTableLookup(AVX2CostTbl, ISD, MTy);
     if (Idx != -1)
@@ -599,6 +683,47 @@ unsigned X86TTI::getMemoryOpCost(unsigned Opcode, Type *Src, unsigned Alignment,
   return Cost;
 }
 
+unsigned X86TTI::getInterleavedMemoryOpCost(unsigned Opcode, Type *VecTy,
+                                            unsigned Factor,
+                                            unsigned Alignment,
+                                            unsigned AddressSpace) const {
+  VectorType *VT = cast<VectorType>(VecTy);
+  Type *SubTy = VectorType::get(VT->getElementType(),
+                                VT->getNumElements() / Factor);
+  std::pair<unsigned, MVT> LT = TLI->getTypeLegalizationCost(SubTy);
+  unsigned EltSize = VT->getScalarSizeInBits();
+
+  // Number of shuffles needed per member register. Two members are split or
+  // merged with one unpck/shufps per register, four with a 4x4 transpose and
+  // three with a blend and a permute for every source register.
+  unsigned ShufflesPerReg = 0;
+  if (Factor == 2)
+    ShufflesPerReg = 1;
+  else if (Factor == 4)
+    ShufflesPerReg = 2;
+  else if (Factor == 3)
+    ShufflesPerReg = 3;
+
+  // Bytes and words need pshufb, one per source register, plus the or that
+  // merges the results.
+  if (EltSize < 32)
+    ShufflesPerReg = ST->hasSSSE3() ? Factor + 1 : 0;
+
+  // Without AVX2 crossing 128-bit lanes needs an extract and an insert; with
+  // it vpermd/vpermq fixes up the lanes.
+  if (LT.second.getSizeInBits() > 128)
+    ShufflesPerReg += ST->hasAVX2() ? 1 : ShufflesPerReg;
+
+  if (!ShufflesPerReg || !LT.second.isVector() ||
+      LT.second.getVectorElementType().getSizeInBits() != EltSize)
+    return TargetTransformInfo::getInterleavedMemoryOpCost(
+        Opcode, VecTy, Factor, Alignment, AddressSpace);
+
+  // The wide access is split into register-sized accesses.
+  unsigned MemCost = getMemoryOpCost(Opcode, SubTy, Alignment, AddressSpace);
+  return Factor * (MemCost + LT.first * ShufflesPerReg);
+}
+
 unsigned X86TTI::getAddressComputationCost(Type *Ty, bool IsComplex) const {
   // Address computations in vectorized code with non-consecutive addresses will
   // likely result in more instructions compared to scalar code where the
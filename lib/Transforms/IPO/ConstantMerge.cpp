@@ -13,7 +13,8 @@
 // the program, regardless of whether or not an existing string is available.
 //
 // Algorithm: ConstantMerge is designed to build up a map of available constants
-// and eliminate duplicates when it is initialized.
+// and eliminate duplicates when it is initialized.  Then the strings that end
+// another string are replaced with a pointer into it.
 //
 //===----------------------------------------------------------------------===//
 
@@ -21,6 +22,7 @@
 #include "llvm/Transforms/IPO.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/PointerIntPair.h"
+#include "llvm/ADT/SetVector.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/IR/Constants.h"
@@ -29,9 +31,18 @@
 #include "llvm/IR/Module.h"
 #include "llvm/IR/Operator.h"
 #include "llvm/Pass.h"
+#include "llvm/Support/CommandLine.h"
+#include <algorithm>
+#include <iterator>
 using namespace llvm;
 
 STATISTIC(NumMerged, "Number of global constants merged");
+STATISTIC(NumSuffixesMerged, "Number of strings merged into longer strings");
+
+static cl::opt<bool>
+MergeStringSuffixes("constmerge-string-suffixes", cl::init(true), cl::Hidden,
+                    cl::desc("Replace string constants that end another "
+                             "string constant with a pointer into it"));
 
 namespace {
   struct ConstantMerge : public ModulePass {
@@ -51,6 +62,10 @@ namespace {
     // alignment to a concrete value.
     unsigned getAlignment(GlobalVariable *GV) const;
 
+    // Merge the strings that are suffixes of other strings into them.
+    bool mergeStringSuffixes(
+        Module &M, const SmallPtrSet<const GlobalValue*, 8> &UsedGlobals);
+
     const DataLayout *TD;
   };
 }
@@ -101,6 +116,69 @@ unsigned ConstantMerge::getAlignment(GlobalVariable *GV) const {
   return 0;
 }
 
+/// Return true if GV is a constant that can be merged with others, either as
+/// the canonical copy or, if it has local linkage, as a duplicate.
+static bool
+IsMergeCandidate(GlobalVariable *GV,
+                 const SmallPtrSet<const GlobalValue*, 8> &UsedGlobals) {
+  // Only process constants with initializers in the default address space.
+  if (!GV->isConstant() || !GV->hasDefinitiveInitializer() ||
+      GV->getType()->getAddressSpace() != 0 || GV->hasSection() ||
+      // Don't touch values marked with attribute(used).
+      UsedGlobals.count(GV))
+    return false;
+
+  // This transformation is legal for weak ODR globals in the sense it
+  // doesn't change semantics, but we really don't want to perform it
+  // anyway; it's likely to pessimize code generation, and some tools
+  // (like the Darwin linker in cases involving CFString) don't expect it.
+  return !GV->isWeakForLinker();
+}
+
+/// Find the global variables whose initializers refer to GV, directly or
+/// through other constants.
+static void
+FindInitializerUsers(GlobalVariable *GV,
+                     SmallSetVector<GlobalVariable*, 16> &InitUsers) {
+  SmallPtrSet<Constant*, 16> Visited;
+  SmallVector<Constant*, 16> Worklist;
+  Worklist.push_back(GV);
+  while (!Worklist.empty()) {
+    Constant *C = Worklist.pop_back_val();
+    for (Value::use_iterator UI = C->use_begin(), E = C->use_end(); UI != E;
+         ++UI) {
+      if (GlobalVariable *User = dyn_cast<GlobalVariable>(*UI))
+        InitUsers.insert(User);
+      else if (Constant *CU = dyn_cast<Constant>(*UI))
+        if (!isa<GlobalValue>(CU) && Visited.insert(CU))
+          Worklist.push_back(CU);
+    }
+  }
+}
+
+/// The globals with the same initializer and alignment knowledge, in the
+/// order they were found.  We don't want to merge globals of unknown
+/// alignment with those of explicit alignment.  If we have DataLayout, we
+/// always know the alignment.  Constants are uniqued, so equal initializers
+/// of the same type are the same pointer and the map hashes their contents
+/// at no extra cost.
+typedef PointerIntPair<Constant*, 1, bool> ConstantKey;
+typedef DenseMap<ConstantKey, SmallVector<GlobalVariable*, 2> > ConstantMap;
+
+static void RemoveFromMap(ConstantMap &CMap, ConstantKey Key,
+                          GlobalVariable *GV) {
+  ConstantMap::iterator I = CMap.find(Key);
+  if (I == CMap.end())
+    return;
+  SmallVectorImpl<GlobalVariable*> &Globals = I->second;
+  SmallVectorImpl<GlobalVariable*>::iterator GI =
+    std::find(Globals.begin(), Globals.end(), GV);
+  if (GI != Globals.end())
+    Globals.erase(GI);
+  if (Globals.empty())
+    CMap.erase(I);
+}
+
 bool ConstantMerge::runOnModule(Module &M) {
   TD = getAnalysisIfAvailable<DataLayout>();
 
@@ -108,126 +186,255 @@ bool ConstantMerge::runOnModule(Module &M) {
   SmallPtrSet<const GlobalValue*, 8> UsedGlobals;
   FindUsedValues(M.getGlobalVariable("llvm.used"), UsedGlobals);
   FindUsedValues(M.getGlobalVariable("llvm.compiler.used"), UsedGlobals);
-  
-  // Map unique <constants, has-unknown-alignment> pairs to globals.  We don't
-  // want to merge globals of unknown alignment with those of explicit
-  // alignment.  If we have DataLayout, we always know the alignment.
-  DenseMap<PointerIntPair<Constant*, 1, bool>, GlobalVariable*> CMap;
+
+  // Map unique <constants, has-unknown-alignment> pairs to globals.
+  ConstantMap CMap;
+
+  // The keys of CMap whose globals are looked at in the next round.
+  SetVector<ConstantKey> Dirty;
 
   // Replacements - This vector contains a list of replacements to perform.
   SmallVector<std::pair<GlobalVariable*, GlobalVariable*>, 32> Replacements;
 
   bool MadeChange = false;
 
-  // Iterate constant merging while we are still making progress.  Merging two
-  // constants together may allow us to merge other constants together if the
-  // second level constants have initializers which point to the globals that
-  // were just merged.
-  while (1) {
-
-    // First: Find the canonical constants others will be merged with.
-    for (Module::global_iterator GVI = M.global_begin(), E = M.global_end();
-         GVI != E; ) {
-      GlobalVariable *GV = GVI++;
-
-      // If this GV is dead, remove it.
-      GV->removeDeadConstantUsers();
-      if (GV->use_empty() && GV->hasLocalLinkage()) {
-        GV->eraseFromParent();
-        continue;
-      }
-
-      // Only process constants with initializers in the default address space.
-      if (!GV->isConstant() || !GV->hasDefinitiveInitializer() ||
-          GV->getType()->getAddressSpace() != 0 || GV->hasSection() ||
-          // Don't touch values marked with attribute(used).
-          UsedGlobals.count(GV))
-        continue;
-
-      // This transformation is legal for weak ODR globals in the sense it
-      // doesn't change semantics, but we really don't want to perform it
-      // anyway; it's likely to pessimize code generation, and some tools
-      // (like the Darwin linker in cases involving CFString) don't expect it.
-      if (GV->isWeakForLinker())
-        continue;
-
-      Constant *Init = GV->getInitializer();
+  // The module is walked once, to find the globals that can be merged.
+  for (Module::global_iterator GVI = M.global_begin(), E = M.global_end();
+       GVI != E; ) {
+    GlobalVariable *GV = GVI++;
 
-      // Check to see if the initializer is already known.
-      PointerIntPair<Constant*, 1, bool> Pair(Init, hasKnownAlignment(GV));
-      GlobalVariable *&Slot = CMap[Pair];
-
-      // If this is the first constant we find or if the old one is local,
-      // replace with the current one. If the current is externally visible
-      // it cannot be replace, but can be the canonical constant we merge with.
-      if (Slot == 0 || IsBetterCannonical(*GV, *Slot))
-        Slot = GV;
+    // If this GV is dead, remove it.
+    GV->removeDeadConstantUsers();
+    if (GV->use_empty() && GV->hasLocalLinkage()) {
+      GV->eraseFromParent();
+      continue;
     }
 
-    // Second: identify all globals that can be merged together, filling in
-    // the Replacements vector.  We cannot do the replacement in this pass
-    // because doing so may cause initializers of other globals to be rewritten,
-    // invalidating the Constant* pointers in CMap.
-    for (Module::global_iterator GVI = M.global_begin(), E = M.global_end();
-         GVI != E; ) {
-      GlobalVariable *GV = GVI++;
-
-      // Only process constants with initializers in the default address space.
-      if (!GV->isConstant() || !GV->hasDefinitiveInitializer() ||
-          GV->getType()->getAddressSpace() != 0 || GV->hasSection() ||
-          // Don't touch values marked with attribute(used).
-          UsedGlobals.count(GV))
-        continue;
-
-      // We can only replace constant with local linkage.
-      if (!GV->hasLocalLinkage())
-        continue;
-
-      Constant *Init = GV->getInitializer();
-
-      // Check to see if the initializer is already known.
-      PointerIntPair<Constant*, 1, bool> Pair(Init, hasKnownAlignment(GV));
-      GlobalVariable *Slot = CMap[Pair];
-
-      if (!Slot || Slot == GV)
-        continue;
+    if (!IsMergeCandidate(GV, UsedGlobals))
+      continue;
+    ConstantKey Key(GV->getInitializer(), hasKnownAlignment(GV));
+    CMap[Key].push_back(GV);
+    Dirty.insert(Key);
+  }
 
-      if (!Slot->hasUnnamedAddr() && !GV->hasUnnamedAddr())
+  // Iterate constant merging while we are still making progress.  Merging two
+  // constants together may allow us to merge other constants together if the
+  // second level constants have initializers which point to the globals that
+  // were just merged, or if the canonical constant lost its unnamed_addr.
+  // Only the globals that could be affected are looked at again.
+  while (!Dirty.empty()) {
+    SmallVector<ConstantKey, 32> Keys(Dirty.begin(), Dirty.end());
+    Dirty.clear();
+
+    for (unsigned i = 0, e = Keys.size(); i != e; ++i) {
+      ConstantMap::iterator I = CMap.find(Keys[i]);
+      if (I == CMap.end())
         continue;
-
-      if (!GV->hasUnnamedAddr())
-        Slot->setUnnamedAddr(false);
-
-      // Make all uses of the duplicate constant use the canonical version.
-      Replacements.push_back(std::make_pair(GV, Slot));
+      SmallVectorImpl<GlobalVariable*> &Globals = I->second;
+
+      // First: Find the canonical constant others will be merged with.  If
+      // the old one is local, replace with the current one. If the current is
+      // externally visible it cannot be replace, but can be the canonical
+      // constant we merge with.
+      GlobalVariable *Slot = 0;
+      for (unsigned j = 0, je = Globals.size(); j != je; ++j)
+        if (Slot == 0 || IsBetterCannonical(*Globals[j], *Slot))
+          Slot = Globals[j];
+
+      // Second: identify all globals that can be merged together, filling in
+      // the Replacements vector.  We cannot do the replacement now because
+      // doing so may cause initializers of other globals to be rewritten,
+      // invalidating the Constant* pointers in CMap.
+      for (unsigned j = 0, je = Globals.size(); j != je; ++j) {
+        GlobalVariable *GV = Globals[j];
+
+        // We can only replace constant with local linkage.
+        if (GV == Slot || !GV->hasLocalLinkage())
+          continue;
+
+        if (!Slot->hasUnnamedAddr() && !GV->hasUnnamedAddr())
+          continue;
+
+        if (!GV->hasUnnamedAddr())
+          Slot->setUnnamedAddr(false);
+
+        // Make all uses of the duplicate constant use the canonical version.
+        Replacements.push_back(std::make_pair(GV, Slot));
+      }
     }
 
     if (Replacements.empty())
-      return MadeChange;
-    CMap.clear();
+      break;
+    MadeChange = true;
+
+    // The keys with replacements are looked at again, since a canonical
+    // constant that lost its unnamed_addr may no longer be the best one.
+    // The initializers that refer to the duplicates are about to change, and
+    // their old constants may be destroyed, so take their globals out of
+    // CMap before the pointers can be reused.
+    SmallSetVector<GlobalVariable*, 16> Changed;
+    for (unsigned i = 0, e = Replacements.size(); i != e; ++i) {
+      GlobalVariable *GV = Replacements[i].first;
+      ConstantKey Key(GV->getInitializer(), hasKnownAlignment(GV));
+      RemoveFromMap(CMap, Key, GV);
+      Dirty.insert(Key);
+      FindInitializerUsers(GV, Changed);
+    }
+    for (unsigned i = 0, e = Replacements.size(); i != e; ++i)
+      Changed.remove(Replacements[i].first);
+    for (unsigned i = 0, e = Changed.size(); i != e; ++i) {
+      GlobalVariable *GV = Changed[i];
+      RemoveFromMap(CMap, ConstantKey(GV->getInitializer(),
+                                      hasKnownAlignment(GV)), GV);
+    }
 
     // Now that we have figured out which replacements must be made, do them all
     // now.  This avoid invalidating the pointers in CMap, which are unneeded
     // now.
     for (unsigned i = 0, e = Replacements.size(); i != e; ++i) {
-      // Bump the alignment if necessary.
-      if (Replacements[i].first->getAlignment() ||
-          Replacements[i].second->getAlignment()) {
-        Replacements[i].second->setAlignment(
-            std::max(getAlignment(Replacements[i].first),
-                     getAlignment(Replacements[i].second)));
+      GlobalVariable *GV = Replacements[i].first;
+      GlobalVariable *Slot = Replacements[i].second;
+
+      // Bump the alignment if necessary.  If that makes the alignment of the
+      // canonical constant known, it moves to another key.
+      if (GV->getAlignment() || Slot->getAlignment()) {
+        ConstantKey OldKey(Slot->getInitializer(), hasKnownAlignment(Slot));
+        Slot->setAlignment(std::max(getAlignment(GV), getAlignment(Slot)));
+        if (!OldKey.getInt() && hasKnownAlignment(Slot) &&
+            !Changed.count(Slot)) {
+          RemoveFromMap(CMap, OldKey, Slot);
+          ConstantKey NewKey(Slot->getInitializer(), true);
+          CMap[NewKey].push_back(Slot);
+          Dirty.insert(NewKey);
+        }
       }
 
       // Eliminate any uses of the dead global.
-      Replacements[i].first->replaceAllUsesWith(Replacements[i].second);
+      GV->replaceAllUsesWith(Slot);
 
       // Delete the global value from the module.
-      assert(Replacements[i].first->hasLocalLinkage() &&
+      assert(GV->hasLocalLinkage() &&
              "Refusing to delete an externally visible global variable.");
-      Replacements[i].first->eraseFromParent();
+      GV->eraseFromParent();
+    }
+
+    // The globals whose initializers changed are looked at again with the
+    // new ones.
+    for (unsigned i = 0, e = Changed.size(); i != e; ++i) {
+      GlobalVariable *GV = Changed[i];
+      if (!IsMergeCandidate(GV, UsedGlobals))
+        continue;
+      ConstantKey Key(GV->getInitializer(), hasKnownAlignment(GV));
+      CMap[Key].push_back(GV);
+      Dirty.insert(Key);
     }
 
     NumMerged += Replacements.size();
     Replacements.clear();
   }
+
+  if (MergeStringSuffixes)
+    MadeChange |= mergeStringSuffixes(M, UsedGlobals);
+  return MadeChange;
+}
+
+namespace {
+/// A string constant and its contents, ordered by their reversed contents so
+/// that the strings ending with another one follow it.
+struct StringEntry {
+  GlobalVariable *GV;
+  StringRef Data;
+
+  StringEntry(GlobalVariable *GV, StringRef Data) : GV(GV), Data(Data) {}
+
+  bool operator<(const StringEntry &RHS) const {
+    typedef std::reverse_iterator<const char*> rev_iterator;
+    return std::lexicographical_compare(rev_iterator(Data.end()),
+                                        rev_iterator(Data.begin()),
+                                        rev_iterator(RHS.Data.end()),
+                                        rev_iterator(RHS.Data.begin()));
+  }
+};
+}
+
+/// Replace the local unnamed_addr strings that are a suffix of another
+/// string constant with a pointer into that one, so that every string ending
+/// the same way is emitted once.
+bool ConstantMerge::mergeStringSuffixes(
+    Module &M, const SmallPtrSet<const GlobalValue*, 8> &UsedGlobals) {
+  std::vector<StringEntry> Strings;
+  for (Module::global_iterator GVI = M.global_begin(), E = M.global_end();
+       GVI != E; ++GVI) {
+    GlobalVariable *GV = GVI;
+    if (!IsMergeCandidate(GV, UsedGlobals))
+      continue;
+    ConstantDataSequential *Init =
+      dyn_cast<ConstantDataSequential>(GV->getInitializer());
+    if (Init && Init->isString())
+      Strings.push_back(StringEntry(GV, Init->getRawDataValues()));
+  }
+  if (Strings.size() < 2)
+    return false;
+
+  // After sorting, all the strings that end with a string follow it, so the
+  // last string of that run contains every one before it and is not itself a
+  // suffix of anything.
+  std::stable_sort(Strings.begin(), Strings.end());
+  std::vector<unsigned> Longest(Strings.size());
+  Longest.back() = Strings.size() - 1;
+  for (unsigned i = Strings.size() - 1; i-- != 0; )
+    Longest[i] = Strings[i + 1].Data.endswith(Strings[i].Data) ?
+                 Longest[i + 1] : i;
+
+  Type *Int64Ty = Type::getInt64Ty(M.getContext());
+  bool MadeChange = false;
+  for (unsigned i = 0, e = Strings.size(); i != e; ++i) {
+    GlobalVariable *GV = Strings[i].GV;
+    const StringEntry &Target = Strings[Longest[i]];
+    // Strings as long as their target are duplicates that the first step
+    // chose not to merge.  The others must not need more than byte alignment
+    // or an address of their own, which a pointer into the target lacks.
+    if (Target.Data.size() == Strings[i].Data.size() ||
+        !GV->hasLocalLinkage() || !GV->hasUnnamedAddr() ||
+        GV->getAlignment() > 1)
+      continue;
+
+    uint64_t Offset = Target.Data.size() - Strings[i].Data.size();
+
+    // Pointers to a character of the string, the usual uses, become pointers
+    // to the same character of the target rather than casts of a pointer
+    // into it.
+    SmallVector<User*, 8> Users(GV->use_begin(), GV->use_end());
+    for (unsigned u = 0, ue = Users.size(); u != ue; ++u) {
+      ConstantExpr *CE = dyn_cast<ConstantExpr>(Users[u]);
+      if (!CE || CE->getOpcode() != Instruction::GetElementPtr ||
+          CE->getNumOperands() != 3 || CE->getOperand(0) != GV)
+        continue;
+      ConstantInt *Zero = dyn_cast<ConstantInt>(CE->getOperand(1));
+      ConstantInt *Index = dyn_cast<ConstantInt>(CE->getOperand(2));
+      if (!Zero || !Zero->isZero() || !Index || Index->isNegative() ||
+          Index->getZExtValue() > Strings[i].Data.size())
+        continue;
+      Constant *Idxs[] = {
+        ConstantInt::get(Int64Ty, 0),
+        ConstantInt::get(Int64Ty, Offset + Index->getZExtValue())
+      };
+      CE->replaceAllUsesWith(ConstantExpr::getGetElementPtr(
+          Target.GV, Idxs, cast<GEPOperator>(CE)->isInBounds()));
+    }
+    GV->removeDeadConstantUsers();
+
+    if (!GV->use_empty()) {
+      Constant *Idxs[] = {
+        ConstantInt::get(Int64Ty, 0),
+        ConstantInt::get(Int64Ty, Offset)
+      };
+      Constant *Ptr = ConstantExpr::getInBoundsGetElementPtr(Target.GV, Idxs);
+      GV->replaceAllUsesWith(ConstantExpr::getBitCast(Ptr, GV->getType()));
+    }
+    GV->eraseFromParent();
+    ++NumSuffixesMerged;
+    MadeChange = true;
+  }
+  return MadeChange;
 }
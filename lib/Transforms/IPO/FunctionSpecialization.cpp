@@ -0,0 +1,277 @@
+//===-- FunctionSpecialization.cpp - Clone functions for constant args ----===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This pass clones functions that are frequently called with the same
+// constant values for some of their arguments.  Each clone has those
+// arguments replaced by the constants in its body, and the matching call
+// sites are redirected to it.  The arguments of the clone become dead but are
+// not removed; IPSCCP should be run after this pass to propagate the
+// constants through the clones, and dead argument elimination to clean up.
+//
+// IPSCCP and IPConstantPropagation only help when every call site agrees on
+// an argument.  This pass handles the common case of a generic routine that a
+// few hot call sites invoke with fixed configuration arguments.
+//
+// The amount of cloning is bounded by the total number of instructions this
+// pass may add to the module, by the number of clones per function, and by
+// how often the call sites of a constant argument tuple execute relative to
+// the entry of their callers.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "function-specialization"
+#include "llvm/Transforms/IPO.h"
+#include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Analysis/BlockFrequencyInfo.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/IntrinsicInst.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Pass.h"
+#include "llvm/Support/CallSite.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Transforms/Utils/Cloning.h"
+#include <algorithm>
+using namespace llvm;
+
+STATISTIC(NumSpecializations, "Number of function specializations created");
+STATISTIC(NumCallsSpecialized, "Number of call sites redirected to a "
+                               "specialization");
+
+static cl::opt<unsigned>
+SpecializeBudget("func-spec-budget", cl::init(1000), cl::Hidden,
+  cl::desc("Maximum number of instructions function specialization may add "
+           "to a module"));
+
+static cl::opt<unsigned>
+SpecializeMaxClones("func-spec-max-clones", cl::init(3), cl::Hidden,
+  cl::desc("Maximum number of specializations of a single function"));
+
+static cl::opt<unsigned>
+SpecializeMaxSize("func-spec-max-size", cl::init(500), cl::Hidden,
+  cl::desc("Functions with more instructions than this are not specialized"));
+
+static cl::opt<unsigned>
+SpecializeMinFreq("func-spec-min-freq", cl::init(4), cl::Hidden,
+  cl::desc("Minimum number of times, relative to the entry of their callers, "
+           "that the call sites of a constant argument tuple must execute"));
+
+namespace {
+  /// ConstArgList - The constant arguments of a call site, as pairs of
+  /// argument number and value, in argument order.
+  typedef SmallVector<std::pair<unsigned, Constant*>, 4> ConstArgList;
+
+  /// SpecializationCandidate - All call sites of one function that pass the
+  /// same constant argument tuple, and how often they execute.
+  struct SpecializationCandidate {
+    ConstArgList Args;
+    SmallVector<Instruction*, 4> Calls;
+    /// Frequency - Sum of the call site frequencies, in units of 1/Scale of
+    /// the entry frequency of the caller.
+    uint64_t Frequency;
+
+    static const uint64_t Scale = 16;
+
+    SpecializationCandidate() : Frequency(0) {}
+  };
+
+  /// Compare candidates so the most frequently executed comes first.
+  struct CandidateFrequencyGreater {
+    bool operator()(const SpecializationCandidate &A,
+                    const SpecializationCandidate &B) const {
+      return A.Frequency > B.Frequency;
+    }
+  };
+
+  /// FunctionSpecializer - Clone functions for hot constant argument tuples.
+  struct FunctionSpecializer : public ModulePass {
+    static char ID; // Pass identification, replacement for typeid
+    FunctionSpecializer() : ModulePass(ID) {
+      initializeFunctionSpecializerPass(*PassRegistry::getPassRegistry());
+    }
+
+    bool runOnModule(Module &M);
+
+    void getAnalysisUsage(AnalysisUsage &AU) const {
+      AU.addRequired<BlockFrequencyInfo>();
+    }
+
+  private:
+    bool specializeFunction(Function &F, unsigned &Budget);
+  };
+}
+
+char FunctionSpecializer::ID = 0;
+INITIALIZE_PASS_BEGIN(FunctionSpecializer, "function-specialization",
+                "Specialize functions for constant arguments", false, false)
+INITIALIZE_PASS_DEPENDENCY(BlockFrequencyInfo)
+INITIALIZE_PASS_END(FunctionSpecializer, "function-specialization",
+                "Specialize functions for constant arguments", false, false)
+
+ModulePass *llvm::createFunctionSpecializationPass() {
+  return new FunctionSpecializer();
+}
+
+/// getSpecializableSize - Return the number of instructions in F, or ~0U if
+/// F must not be cloned.
+static unsigned getSpecializableSize(const Function &F) {
+  if (F.isDeclaration() || F.isVarArg() || F.mayBeOverridden())
+    return ~0U;
+  if (F.getAttributes().hasAttribute(AttributeSet::FunctionIndex,
+                                     Attribute::OptimizeForSize) ||
+      F.getAttributes().hasAttribute(AttributeSet::FunctionIndex,
+                                     Attribute::MinSize))
+    return ~0U;
+
+  unsigned Size = 0;
+  for (Function::const_iterator BB = F.begin(), E = F.end(); BB != E; ++BB) {
+    // A blockaddress in the clone would still refer to the original function.
+    if (BB->hasAddressTaken())
+      return ~0U;
+    for (BasicBlock::const_iterator I = BB->begin(), IE = BB->end(); I != IE;
+         ++I) {
+      if (isa<DbgInfoIntrinsic>(I))
+        continue;
+      ImmutableCallSite CS(I);
+      if (CS && CS.hasFnAttr(Attribute::NoDuplicate))
+        return ~0U;
+      ++Size;
+    }
+  }
+  return Size;
+}
+
+bool FunctionSpecializer::runOnModule(Module &M) {
+  // Collect the functions up front; the clones are appended to the module.
+  SmallVector<Function*, 32> Worklist;
+  for (Module::iterator F = M.begin(), E = M.end(); F != E; ++F)
+    if (!F->isDeclaration())
+      Worklist.push_back(F);
+
+  unsigned Budget = SpecializeBudget;
+  bool Changed = false;
+  for (unsigned i = 0, e = Worklist.size(); i != e && Budget; ++i)
+    Changed |= specializeFunction(*Worklist[i], Budget);
+  return Changed;
+}
+
+/// specializeFunction - Group the direct calls of F by the constants they
+/// pass and clone F for the most frequent groups that fit in Budget.
+bool FunctionSpecializer::specializeFunction(Function &F, unsigned &Budget) {
+  unsigned Size = getSpecializableSize(F);
+  if (Size > SpecializeMaxSize || Size > Budget)
+    return false;
+
+  // Collect the calls that pass constants grouped by caller, so that the
+  // block frequencies of each caller are only computed once.
+  typedef SmallVector<std::pair<Instruction*, ConstArgList>, 4> ConstCallList;
+  MapVector<Function*, ConstCallList> CallsByCaller;
+  unsigned NumUses = 0;
+  for (Value::use_iterator UI = F.use_begin(), E = F.use_end(); UI != E; ++UI) {
+    ++NumUses;
+    CallSite CS(*UI);
+    if (!CS || !CS.isCallee(UI))
+      continue;
+
+    ConstArgList Args;
+    Function::arg_iterator AI = F.arg_begin();
+    for (unsigned ArgNo = 0, NumArgs = CS.arg_size(); ArgNo != NumArgs;
+         ++ArgNo, ++AI) {
+      Constant *C = dyn_cast<Constant>(CS.getArgument(ArgNo));
+      // A byval or inalloca argument is a copy; the clone cannot use the
+      // constant pointer in its place.
+      if (!C || isa<UndefValue>(C) || AI->hasByValAttr() ||
+          AI->hasInAllocaAttr())
+        continue;
+      Args.push_back(std::make_pair(ArgNo, C));
+    }
+    if (Args.empty())
+      continue;
+
+    Instruction *Call = CS.getInstruction();
+    Function *Caller = Call->getParent()->getParent();
+    CallsByCaller[Caller].push_back(std::make_pair(Call, Args));
+  }
+
+  SmallVector<SpecializationCandidate, 4> Candidates;
+  for (MapVector<Function*, ConstCallList>::iterator I = CallsByCaller.begin(),
+         E = CallsByCaller.end(); I != E; ++I) {
+    BlockFrequencyInfo &BFI = getAnalysis<BlockFrequencyInfo>(*I->first);
+    uint64_t EntryFreq = BFI.getEntryFreq();
+    if (!EntryFreq)
+      continue;
+
+    for (unsigned i = 0, e = I->second.size(); i != e; ++i) {
+      Instruction *Call = I->second[i].first;
+      const ConstArgList &Args = I->second[i].second;
+      uint64_t Freq = BFI.getBlockFreq(Call->getParent()).getFrequency();
+
+      SpecializationCandidate *Cand = 0;
+      for (unsigned j = 0, je = Candidates.size(); j != je && !Cand; ++j)
+        if (Candidates[j].Args == Args)
+          Cand = &Candidates[j];
+      if (!Cand) {
+        Candidates.push_back(SpecializationCandidate());
+        Cand = &Candidates.back();
+        Cand->Args = Args;
+      }
+      Cand->Calls.push_back(Call);
+      Cand->Frequency += Freq * SpecializationCandidate::Scale / EntryFreq;
+    }
+  }
+
+  // If every use of a local function passes the same constants, IPSCCP can
+  // propagate them without a clone.
+  if (Candidates.size() == 1 && F.hasLocalLinkage() &&
+      Candidates[0].Calls.size() == NumUses)
+    return false;
+
+  std::stable_sort(Candidates.begin(), Candidates.end(),
+                   CandidateFrequencyGreater());
+
+  bool Changed = false;
+  unsigned NumClones = 0;
+  for (unsigned i = 0, e = Candidates.size(); i != e; ++i) {
+    SpecializationCandidate &Cand = Candidates[i];
+    if (NumClones == SpecializeMaxClones || Size > Budget ||
+        Cand.Frequency < SpecializeMinFreq * SpecializationCandidate::Scale)
+      break;
+
+    ValueToValueMapTy VMap;
+    Function *Clone = CloneFunction(&F, VMap, /*ModuleLevelChanges=*/false);
+    Clone->setLinkage(GlobalValue::InternalLinkage);
+    Clone->setName(F.getName() + ".spec");
+    F.getParent()->getFunctionList().push_back(Clone);
+
+    for (unsigned j = 0, je = Cand.Args.size(); j != je; ++j) {
+      Function::arg_iterator AI = Clone->arg_begin();
+      std::advance(AI, Cand.Args[j].first);
+      AI->replaceAllUsesWith(Cand.Args[j].second);
+    }
+
+    for (unsigned j = 0, je = Cand.Calls.size(); j != je; ++j)
+      CallSite(Cand.Calls[j]).setCalledFunction(Clone);
+
+    DEBUG(dbgs() << "FuncSpec: cloned " << F.getName() << " as "
+                 << Clone->getName() << " for " << Cand.Calls.size()
+                 << " call sites (frequency "
+                 << Cand.Frequency / SpecializationCandidate::Scale << ")\n");
+
+    Budget -= Size;
+    ++NumClones;
+    ++NumSpecializations;
+    NumCallsSpecialized += Cand.Calls.size();
+    Changed = true;
+  }
+  return Changed;
+}
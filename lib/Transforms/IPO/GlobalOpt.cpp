@@ -32,6 +32,7 @@
 #include "llvm/IR/Operator.h"
 #include "llvm/Pass.h"
 #include "llvm/Support/CallSite.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/GetElementPtrTypeIterator.h"
@@ -60,6 +61,15 @@ STATISTIC(NumNestRemoved   , "Number of nest attributes removed");
 STATISTIC(NumAliasesResolved, "Number of global aliases resolved");
 STATISTIC(NumAliasesRemoved, "Number of global aliases eliminated");
 STATISTIC(NumCXXDtorsRemoved, "Number of global C++ destructors removed");
+STATISTIC(NumAnalysesReused, "Number of unchanged globals not analyzed again");
+
+static cl::opt<bool>
+ReuseGlobalAnalysis("globalopt-reuse-analysis", cl::Hidden, cl::init(true),
+                    cl::desc("Don't analyze globals again in later "
+                             "iterations unless their uses changed"));
+
+/// The number of uses from which the analysis of a global is remembered.
+static const unsigned MinUsesToReuseAnalysis = 16;
 
 namespace {
   struct GlobalOpt : public ModulePass {
@@ -80,12 +90,28 @@ namespace {
     bool OptimizeGlobalAliases(Module &M);
     bool OptimizeGlobalCtorsList(GlobalVariable *&GCL);
     bool ProcessGlobal(GlobalVariable *GV,Module::global_iterator &GVI);
+    void DeleteDeadGlobals(GlobalVariable *GV, Module::global_iterator &GVI);
     bool ProcessInternalGlobal(GlobalVariable *GV,Module::global_iterator &GVI,
                                const GlobalStatus &GS);
     bool OptimizeEmptyGlobalCXXDtors(Function *CXAAtExitFn);
 
     DataLayout *TD;
     TargetLibraryInfo *TLI;
+
+    /// AnalyzedGlobal - What ProcessGlobal saw of a global it analyzed and
+    /// left alone.  As long as the global keeps the same number of uses and the
+    /// same initializer, analyzing it again would find the same thing.
+    struct AnalyzedGlobal {
+      unsigned NumUses;
+      Constant *Initializer;
+    };
+    /// UnchangedGlobals - The globals ProcessGlobal analyzed without
+    /// optimizing them.  The uses of a global can also change without their
+    /// number changing, when the global's loads or stores are rewritten for
+    /// another global, so this is cleared whenever something other than a
+    /// dead global is optimized.  That is also when globals are created and
+    /// deleted, so the keys cannot be reused for new globals.
+    DenseMap<GlobalVariable*, AnalyzedGlobal> UnchangedGlobals;
   };
 }
 
@@ -1702,6 +1728,80 @@ static bool TryToShrinkGlobalToBoolean(GlobalVariable *GV, Constant *OtherVal) {
 }
 
 
+/// CollectReferencedGlobals - Add the global variables and functions that C
+/// refers to, looking through constant expressions and aggregates, to Refs.
+static void CollectReferencedGlobals(Constant *C,
+                                     SmallPtrSet<Constant*, 16> &Visited,
+                                     SmallVectorImpl<GlobalValue*> &Refs) {
+  if (!Visited.insert(C))
+    return;
+  if (GlobalValue *G = dyn_cast<GlobalValue>(C)) {
+    if (isa<GlobalVariable>(G) || isa<Function>(G))
+      Refs.push_back(G);
+    return;
+  }
+  for (User::op_iterator I = C->op_begin(), E = C->op_end(); I != E; ++I)
+    if (Constant *Op = dyn_cast<Constant>(*I))
+      CollectReferencedGlobals(Op, Visited, Refs);
+}
+
+/// DeleteDeadGlobals - Delete the dead global variable GV, then the global
+/// variables and functions that only it kept alive, and so on, instead of
+/// leaving each level of a chain of dead globals to another iteration over
+/// the whole module.  GVI is moved past any global it pointed to that is
+/// deleted.
+void GlobalOpt::DeleteDeadGlobals(GlobalVariable *GV,
+                                  Module::global_iterator &GVI) {
+  SmallVector<GlobalValue*, 16> Worklist;
+  SmallPtrSet<GlobalValue*, 16> Pending;
+  GlobalValue *Dead = GV;
+  while (Dead) {
+    // Find what Dead refers to before deleting it.
+    SmallPtrSet<Constant*, 16> Visited;
+    SmallVector<GlobalValue*, 8> Refs;
+    if (GlobalVariable *DeadGV = dyn_cast<GlobalVariable>(Dead)) {
+      if (DeadGV->hasInitializer())
+        CollectReferencedGlobals(DeadGV->getInitializer(), Visited, Refs);
+      DEBUG(dbgs() << "GLOBAL DEAD: " << *DeadGV);
+      UnchangedGlobals.erase(DeadGV);
+      if (Module::global_iterator(DeadGV) == GVI)
+        ++GVI;
+      DeadGV->eraseFromParent();
+      ++NumDeleted;
+    } else {
+      Function *F = cast<Function>(Dead);
+      for (Function::iterator BB = F->begin(), E = F->end(); BB != E; ++BB)
+        for (BasicBlock::iterator I = BB->begin(), IE = BB->end(); I != IE;
+             ++I)
+          for (User::op_iterator OI = I->op_begin(), OE = I->op_end();
+               OI != OE; ++OI)
+            if (Constant *C = dyn_cast<Constant>(*OI))
+              CollectReferencedGlobals(C, Visited, Refs);
+      DEBUG(dbgs() << "FUNCTION DEAD: " << F->getName() << '\n');
+      F->eraseFromParent();
+      ++NumFnDeleted;
+    }
+
+    for (unsigned i = 0, e = Refs.size(); i != e; ++i)
+      if (Pending.insert(Refs[i]))
+        Worklist.push_back(Refs[i]);
+
+    // A global that is dead now had no users left to queue it again.
+    Dead = 0;
+    while (!Dead && !Worklist.empty()) {
+      GlobalValue *G = Worklist.pop_back_val();
+      Pending.erase(G);
+      G->removeDeadConstantUsers();
+      if (Function *F = dyn_cast<Function>(G)) {
+        if (F->isDefTriviallyDead())
+          Dead = F;
+      } else if (G->isDiscardableIfUnused() && G->use_empty()) {
+        Dead = G;
+      }
+    }
+  }
+}
+
 /// ProcessGlobal - Analyze the specified global variable and optimize it if
 /// possible.  If we make a change, return true.
 bool GlobalOpt::ProcessGlobal(GlobalVariable *GV,
@@ -1713,29 +1813,47 @@ bool GlobalOpt::ProcessGlobal(GlobalVariable *GV,
   GV->removeDeadConstantUsers();
 
   if (GV->use_empty()) {
-    DEBUG(dbgs() << "GLOBAL DEAD: " << *GV);
-    GV->eraseFromParent();
-    ++NumDeleted;
+    DeleteDeadGlobals(GV, GVI);
     return true;
   }
 
   if (!GV->hasLocalLinkage())
     return false;
 
+  // Globals with few uses are analyzed as quickly as they are looked up.
+  bool ReuseAnalysis = ReuseGlobalAnalysis &&
+                       GV->hasNUsesOrMore(MinUsesToReuseAnalysis);
+  AnalyzedGlobal Seen;
+  if (ReuseAnalysis) {
+    Seen.NumUses = GV->getNumUses();
+    Seen.Initializer = GV->hasInitializer() ? GV->getInitializer() : 0;
+    DenseMap<GlobalVariable*, AnalyzedGlobal>::iterator I =
+      UnchangedGlobals.find(GV);
+    if (I != UnchangedGlobals.end() && I->second.NumUses == Seen.NumUses &&
+        I->second.Initializer == Seen.Initializer) {
+      ++NumAnalysesReused;
+      return false;
+    }
+  }
+
   GlobalStatus GS;
 
-  if (GlobalStatus::analyzeGlobal(GV, GS))
-    return false;
+  bool Changed = false;
+  if (!GlobalStatus::analyzeGlobal(GV, GS)) {
+    if (!GS.IsCompared && !GV->hasUnnamedAddr()) {
+      GV->setUnnamedAddr(true);
+      NumUnnamed++;
+    }
 
-  if (!GS.IsCompared && !GV->hasUnnamedAddr()) {
-    GV->setUnnamedAddr(true);
-    NumUnnamed++;
+    if (!GV->isConstant() && GV->hasInitializer())
+      Changed = ProcessInternalGlobal(GV, GVI, GS);
   }
 
-  if (GV->isConstant() || !GV->hasInitializer())
-    return false;
-
-  return ProcessInternalGlobal(GV, GVI, GS);
+  if (Changed)
+    UnchangedGlobals.clear();
+  else if (ReuseAnalysis)
+    UnchangedGlobals[GV] = Seen;
+  return Changed;
 }
 
 /// ProcessInternalGlobal - Analyze the specified global variable and optimize
@@ -3171,15 +3289,22 @@ bool GlobalOpt::runOnModule(Module &M) {
     // Delete functions that are trivially dead, ccc -> fastcc
     LocalChange |= OptimizeFunctions(M);
 
-    // Optimize global_ctors list.
-    if (GlobalCtors)
-      LocalChange |= OptimizeGlobalCtorsList(GlobalCtors);
+    // Optimize global_ctors list.  Evaluating the constructors changes the
+    // initializers and the uses of the globals they store to.
+    if (GlobalCtors && OptimizeGlobalCtorsList(GlobalCtors)) {
+      UnchangedGlobals.clear();
+      LocalChange = true;
+    }
 
     // Optimize non-address-taken globals.
     LocalChange |= OptimizeGlobalVars(M);
 
-    // Resolve aliases, when possible.
-    LocalChange |= OptimizeGlobalAliases(M);
+    // Resolve aliases, when possible.  This replaces values stored to other
+    // globals.
+    if (OptimizeGlobalAliases(M)) {
+      UnchangedGlobals.clear();
+      LocalChange = true;
+    }
 
     // Try to remove trivial global destructors if they are not removed
     // already.
@@ -3193,5 +3318,6 @@ bool GlobalOpt::runOnModule(Module &M) {
   // TODO: Move all global ctors functions to the end of the module for code
   // layout.
 
+  UnchangedGlobals.clear();
   return Changed;
 }
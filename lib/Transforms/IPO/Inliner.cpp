@@ -22,6 +22,7 @@
 #include "llvm/IR/DataLayout.h"
 #include "llvm/IR/Instructions.h"
 #include "llvm/IR/IntrinsicInst.h"
+#include "llvm/IR/Metadata.h"
 #include "llvm/IR/Module.h"
 #include "llvm/Support/CallSite.h"
 #include "llvm/Support/CommandLine.h"
@@ -41,6 +42,7 @@ STATISTIC(NumMergedAllocas, "Number of allocas merged together");
 // to inline a function A into B, we analyze the callers of B in order to see
 // if those would be more profitable and blocked inline steps.
 STATISTIC(NumCallerCallersAnalyzed, "Number of caller-callers analyzed");
+STATISTIC(NumCachedCosts, "Number of inline costs reused across iterations");
 
 static cl::opt<int>
 InlineLimit("inline-threshold", cl::Hidden, cl::init(225), cl::ZeroOrMore,
@@ -50,16 +52,26 @@ static cl::opt<int>
 HintThreshold("inlinehint-threshold", cl::Hidden, cl::init(325),
               cl::desc("Threshold for inlining functions with inline hint"));
 
+static cl::opt<int>
+ColdThreshold("inlinecold-threshold", cl::Hidden, cl::init(75),
+              cl::desc("Threshold for inlining at cold call sites"));
+
 // Threshold to use when optsize is specified (and there is no -inline-limit).
 const int OptSizeThreshold = 75;
 
+// A call site whose block is entered through an edge taken at most once in
+// this many times, per branch weight metadata, is considered cold.  This
+// matches the weights that @llvm.expect lowering puts on unlikely edges.
+const unsigned ColdEdgeRatio = 16;
+
 Inliner::Inliner(char &ID) 
-  : CallGraphSCCPass(ID), InlineThreshold(InlineLimit), InsertLifetime(true) {}
+  : CallGraphSCCPass(ID), InlineThreshold(InlineLimit), InsertLifetime(true),
+    LastChangeStamp(0) {}
 
 Inliner::Inliner(char &ID, int Threshold, bool InsertLifetime)
   : CallGraphSCCPass(ID), InlineThreshold(InlineLimit.getNumOccurrences() > 0 ?
                                           InlineLimit : Threshold),
-    InsertLifetime(InsertLifetime) {}
+    InsertLifetime(InsertLifetime), LastChangeStamp(0) {}
 
 /// getAnalysisUsage - For this class, we declare that we require and preserve
 /// the call graph.  If the derived class implements this method, it should
@@ -252,6 +264,39 @@ static bool InlineCallIfPossible(CallSite CS, InlineFunctionInfo &IFI,
   return true;
 }
 
+/// isColdCallSite - Return true if the call site is known to be rarely
+/// executed: either the callee is marked cold, or the only way into the
+/// call's block is an edge that branch weight metadata says is rarely taken.
+static bool isColdCallSite(CallSite CS) {
+  Function *Callee = CS.getCalledFunction();
+  if (Callee && Callee->getAttributes().hasAttribute(
+                    AttributeSet::FunctionIndex, Attribute::Cold))
+    return true;
+
+  BasicBlock *BB = CS.getInstruction()->getParent();
+  BasicBlock *Pred = BB->getSinglePredecessor();
+  if (!Pred)
+    return false;
+  TerminatorInst *TI = Pred->getTerminator();
+  MDNode *WeightsNode = TI->getMetadata(LLVMContext::MD_prof);
+  if (!WeightsNode || WeightsNode->getNumOperands() != TI->getNumSuccessors()+1)
+    return false;
+  MDString *MDName = dyn_cast<MDString>(WeightsNode->getOperand(0));
+  if (!MDName || !MDName->getString().equals("branch_weights"))
+    return false;
+
+  uint64_t EdgeWeight = 0, TotalWeight = 0;
+  for (unsigned i = 0, e = TI->getNumSuccessors(); i != e; ++i) {
+    ConstantInt *Weight = dyn_cast<ConstantInt>(WeightsNode->getOperand(i+1));
+    if (!Weight)
+      return false;
+    TotalWeight += Weight->getZExtValue();
+    if (TI->getSuccessor(i) == BB)
+      EdgeWeight += Weight->getZExtValue();
+  }
+  return TotalWeight && EdgeWeight * ColdEdgeRatio <= TotalWeight;
+}
+
 unsigned Inliner::getInlineThreshold(CallSite CS) const {
   int thres = InlineThreshold; // -inline-threshold or else selected by
                                // overall opt level
@@ -277,13 +322,50 @@ unsigned Inliner::getInlineThreshold(CallSite CS) const {
                                                Attribute::MinSize))
     thres = HintThreshold;
 
+  // Inlining into a cold call site buys little run time for its code growth,
+  // so listen to the cold threshold when it would decrease the threshold.
+  if (ColdThreshold < thres && isColdCallSite(CS))
+    thres = ColdThreshold;
+
   return thres;
 }
 
+/// getCachedInlineCost - The inliner loop revisits every call site it did not
+/// inline each time anything in the SCC changes, and reanalyzing a large callee
+/// for each of its call sites every time dominates compile time.  The cost of
+/// a call site depends only on the bodies of its caller and callee and, via the
+/// last-call bonus, on whether the callee has a single use, so a cost is
+/// reused for as long as all three are unchanged.
+InlineCost Inliner::getCachedInlineCost(CallSite CS) {
+  Instruction *Call = CS.getInstruction();
+  Function *Callee = CS.getCalledFunction();
+  unsigned CallerStamp = ChangeStamps.lookup(CS.getCaller());
+  unsigned CalleeStamp = ChangeStamps.lookup(Callee);
+  bool CalleeHasOneUse = Callee->hasOneUse();
+
+  DenseMap<Instruction *, CachedInlineCost>::iterator I = CostCache.find(Call);
+  if (I != CostCache.end()) {
+    const CachedInlineCost &C = I->second;
+    if (C.Callee == Callee && C.CallerStamp == CallerStamp &&
+        C.CalleeStamp == CalleeStamp && C.CalleeHadOneUse == CalleeHasOneUse) {
+      ++NumCachedCosts;
+      return C.IC;
+    }
+    CostCache.erase(I);
+  }
+
+  InlineCost IC = getInlineCost(CS);
+  CostCache.insert(std::make_pair(Call, CachedInlineCost(IC, Callee,
+                                                         CallerStamp,
+                                                         CalleeStamp,
+                                                         CalleeHasOneUse)));
+  return IC;
+}
+
 /// shouldInline - Return true if the inliner should attempt to inline
 /// at the given CallSite.
 bool Inliner::shouldInline(CallSite CS) {
-  InlineCost IC = getInlineCost(CS);
+  InlineCost IC = getCachedInlineCost(CS);
   
   if (IC.isAlways()) {
     DEBUG(dbgs() << "    Inlining: cost=always"
@@ -482,6 +564,7 @@ bool Inliner::runOnSCC(CallGraphSCC &SCC) {
         // Update the call graph by deleting the edge from Callee to Caller.
         CG[Caller]->removeCallEdgeFor(CS);
         CS.getInstruction()->eraseFromParent();
+        markChanged(Caller);
         ++NumCallsDeleted;
       } else {
         // We can only inline direct calls to non-declarations.
@@ -507,6 +590,7 @@ bool Inliner::runOnSCC(CallGraphSCC &SCC) {
         if (!InlineCallIfPossible(CS, InlineInfo, InlinedArrayAllocas,
                                   InlineHistoryID, InsertLifetime, TD))
           continue;
+        markChanged(Caller);
         ++NumInlined;
         
         // If inlining this function gave us any new call sites, throw them
@@ -564,6 +648,8 @@ bool Inliner::runOnSCC(CallGraphSCC &SCC) {
     }
   } while (LocalChange);
 
+  CostCache.clear();
+  ChangeStamps.clear();
   return Changed;
 }
 
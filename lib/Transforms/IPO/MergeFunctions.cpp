@@ -9,8 +9,8 @@
 //
 // This pass looks for equivalent functions that are mergable and folds them.
 //
-// A hash is computed from the function, based on its type and number of
-// basic blocks.
+// A hash is computed from the function, based on its type, number of basic
+// blocks and the opcodes of its instructions in CFG order.
 //
 // Once all hashes are computed, we perform an expensive equality comparison
 // on each function pair. This takes n^2/2 comparisons per bucket, so it's
@@ -21,6 +21,11 @@
 // overridable, we move the functionality into a new internal function and
 // leave two overridable thunks to it.
 //
+// In fold mode, used at link time when the whole program is visible, a local
+// unnamed_addr function is removed outright and every use of it, including
+// uses of its address, refers to its equivalent instead.  Since nothing can
+// compare the addresses, no thunk is needed.
+//
 //===----------------------------------------------------------------------===//
 //
 // Future work:
@@ -60,6 +65,7 @@
 #include "llvm/IR/Operator.h"
 #include "llvm/Pass.h"
 #include "llvm/Support/CallSite.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/ValueHandle.h"
@@ -71,6 +77,26 @@ STATISTIC(NumFunctionsMerged, "Number of functions merged");
 STATISTIC(NumThunksWritten, "Number of thunks generated");
 STATISTIC(NumAliasesWritten, "Number of aliases generated");
 STATISTIC(NumDoubleWeak, "Number of new functions created");
+STATISTIC(NumFunctionsFolded, "Number of functions folded without a thunk");
+STATISTIC(NumInstructionsRemoved, "Number of instructions removed by merging");
+
+static cl::opt<bool>
+MergeFunctionsFold("mergefunc-fold", cl::Hidden, cl::init(false),
+                   cl::desc("Fold local unnamed_addr functions into their "
+                            "equivalents instead of writing thunks"));
+
+static cl::opt<bool>
+MergeFunctionsReport("mergefunc-report", cl::Hidden, cl::init(false),
+                     cl::desc("Print each merged function and the number of "
+                              "instructions removed"));
+
+/// Count the instructions in F, for the merge report.
+static unsigned countInstructions(const Function *F) {
+  unsigned Count = 0;
+  for (Function::const_iterator BB = F->begin(), E = F->end(); BB != E; ++BB)
+    Count += BB->size();
+  return Count;
+}
 
 /// Returns the type id for a type to be hashed. We turn pointer types into
 /// integers here because the actual compare logic below considers pointers and
@@ -82,8 +108,12 @@ static Type::TypeID getTypeIDForHash(Type *Ty) {
 }
 
 /// Creates a hash-code for the function which is the same for any two
-/// functions that will compare equal, without looking at the instructions
-/// inside the function.
+/// functions that will compare equal.  Besides the signature, this mixes in
+/// the shape of the body: the number of instructions in each block and their
+/// opcodes and operand counts, visiting blocks in the same CFG order that
+/// FunctionComparator::compare uses.  Functions that only share a signature
+/// then land in different buckets and are never compared at all, which keeps
+/// modules with thousands of same-typed functions from going quadratic.
 static unsigned profileFunction(const Function *F) {
   FunctionType *FTy = F->getFunctionType();
 
@@ -95,6 +125,28 @@ static unsigned profileFunction(const Function *F) {
   ID.AddInteger(getTypeIDForHash(FTy->getReturnType()));
   for (unsigned i = 0, e = FTy->getNumParams(); i != e; ++i)
     ID.AddInteger(getTypeIDForHash(FTy->getParamType(i)));
+
+  SmallVector<const BasicBlock *, 8> BBs;
+  SmallSet<const BasicBlock *, 16> VisitedBBs;
+  BBs.push_back(&F->getEntryBlock());
+  VisitedBBs.insert(BBs[0]);
+  while (!BBs.empty()) {
+    const BasicBlock *BB = BBs.pop_back_val();
+    ID.AddInteger(BB->size());
+    for (BasicBlock::const_iterator I = BB->begin(), E = BB->end(); I != E;
+         ++I) {
+      ID.AddInteger(I->getOpcode());
+      // GEPs with different operand counts can still compare equal when they
+      // compute the same constant offset.
+      if (!isa<GetElementPtrInst>(I))
+        ID.AddInteger(I->getNumOperands());
+    }
+
+    const TerminatorInst *TI = BB->getTerminator();
+    for (unsigned i = 0, e = TI->getNumSuccessors(); i != e; ++i)
+      if (VisitedBBs.insert(TI->getSuccessor(i)))
+        BBs.push_back(TI->getSuccessor(i));
+  }
   return ID.ComputeHash();
 }
 
@@ -556,8 +608,9 @@ namespace {
 class MergeFunctions : public ModulePass {
 public:
   static char ID;
-  MergeFunctions()
-    : ModulePass(ID), HasGlobalAliases(false) {
+  explicit MergeFunctions(bool FoldIdentical = false)
+    : ModulePass(ID), HasGlobalAliases(false),
+      FoldIdentical(FoldIdentical || MergeFunctionsFold) {
     initializeMergeFunctionsPass(*PassRegistry::getPassRegistry());
   }
 
@@ -601,6 +654,13 @@ private:
   /// Replace G with an alias to F. Deletes G.
   void writeAlias(Function *F, Function *G);
 
+  /// Whether G may be deleted and all of its uses pointed at an equivalent
+  /// function, rather than being replaced by a thunk or an alias.
+  bool canFold(Function *G) const;
+
+  /// Replace every use of G with bitcast(F). Deletes G.
+  void foldFunction(Function *F, Function *G);
+
   /// The set of all distinct functions. Use the insert() and remove() methods
   /// to modify it.
   FnSetType FnSet;
@@ -610,6 +670,10 @@ private:
 
   /// Whether or not the target supports global aliases.
   bool HasGlobalAliases;
+
+  /// Fold functions whose address is not significant instead of writing
+  /// thunks for them.
+  bool FoldIdentical;
 };
 
 }  // end anonymous namespace
@@ -617,17 +681,20 @@ private:
 char MergeFunctions::ID = 0;
 INITIALIZE_PASS(MergeFunctions, "mergefunc", "Merge Functions", false, false)
 
-ModulePass *llvm::createMergeFunctionsPass() {
-  return new MergeFunctions();
+ModulePass *llvm::createMergeFunctionsPass(bool FoldIdentical) {
+  return new MergeFunctions(FoldIdentical);
 }
 
 bool MergeFunctions::runOnModule(Module &M) {
   bool Changed = false;
   TD = getAnalysisIfAvailable<DataLayout>();
 
+  unsigned InstructionsBefore = 0;
   for (Module::iterator I = M.begin(), E = M.end(); I != E; ++I) {
-    if (!I->isDeclaration() && !I->hasAvailableExternallyLinkage())
+    if (!I->isDeclaration() && !I->hasAvailableExternallyLinkage()) {
       Deferred.push_back(WeakVH(I));
+      InstructionsBefore += countInstructions(I);
+    }
   }
   FnSet.resize(Deferred.size());
 
@@ -670,6 +737,18 @@ bool MergeFunctions::runOnModule(Module &M) {
 
   FnSet.clear();
 
+  // Thunks add instructions back, so measure the whole module rather than
+  // summing the sizes of the merged functions.
+  unsigned InstructionsAfter = 0;
+  for (Module::iterator I = M.begin(), E = M.end(); I != E; ++I)
+    if (!I->isDeclaration() && !I->hasAvailableExternallyLinkage())
+      InstructionsAfter += countInstructions(I);
+  if (InstructionsAfter < InstructionsBefore)
+    NumInstructionsRemoved += InstructionsBefore - InstructionsAfter;
+  if (MergeFunctionsReport)
+    dbgs() << "mergefunc: " << InstructionsBefore << " instructions before, "
+           << InstructionsAfter << " after\n";
+
   return Changed;
 }
 
@@ -798,9 +877,32 @@ void MergeFunctions::writeAlias(Function *F, Function *G) {
   ++NumAliasesWritten;
 }
 
+// A local unnamed_addr function is only known by its uses in this module, and
+// none of them can tell it apart from an equivalent function.
+bool MergeFunctions::canFold(Function *G) const {
+  return FoldIdentical && G->hasLocalLinkage() && G->hasUnnamedAddr();
+}
+
+// Replace every use of G, calls or not, with F and delete G.
+void MergeFunctions::foldFunction(Function *F, Function *G) {
+  F->setAlignment(std::max(F->getAlignment(), G->getAlignment()));
+  removeUsers(G);
+  G->replaceAllUsesWith(ConstantExpr::getBitCast(F, G->getType()));
+  G->eraseFromParent();
+
+  ++NumFunctionsFolded;
+}
+
 // Merge two equivalent functions. Upon completion, Function G is deleted.
 void MergeFunctions::mergeTwoFunctions(Function *F, Function *G) {
-  if (F->mayBeOverridden()) {
+  if (MergeFunctionsReport)
+    dbgs() << "mergefunc: " << G->getName() << " -> " << F->getName()
+           << (canFold(G) ? " (folded, " : " (")
+           << countInstructions(G) << " instructions)\n";
+
+  if (canFold(G)) {
+    foldFunction(F, G);
+  } else if (F->mayBeOverridden()) {
     assert(G->mayBeOverridden());
 
     if (HasGlobalAliases) {
@@ -845,10 +947,10 @@ bool MergeFunctions::insert(ComparableFunction &NewF) {
   const ComparableFunction &OldF = *Result.first;
 
   // Don't merge tiny functions, since it can just end up making the function
-  // larger.
+  // larger.  Folding never adds code, so tiny functions can still be folded.
   // FIXME: Should still merge them if they are unnamed_addr and produce an
   // alias.
-  if (NewF.getFunc()->size() == 1) {
+  if (NewF.getFunc()->size() == 1 && !canFold(NewF.getFunc())) {
     if (NewF.getFunc()->front().size() <= 2) {
       DEBUG(dbgs() << NewF.getFunc()->getName()
             << " is to small to bother merging\n");
@@ -53,6 +53,19 @@ static cl::opt<bool>
 RunLoopRerolling("reroll-loops", cl::Hidden,
                  cl::desc("Run the loop rerolling pass"));
 
+static cl::opt<bool>
+RunLoopInterchange("enable-loopinterchange", cl::init(false), cl::Hidden,
+                   cl::desc("Run the loop interchange pass"));
+
+static cl::opt<bool>
+RunFunctionSpecialization("enable-function-specialization", cl::init(false),
+                          cl::Hidden,
+                          cl::desc("Run the function specialization pass"));
+
+static cl::opt<bool>
+RunLTOMergeFunctions("enable-lto-mergefunc", cl::init(false), cl::Hidden,
+                     cl::desc("Fold identical functions at link time"));
+
 PassManagerBuilder::PassManagerBuilder() {
     OptLevel = 2;
     SizeLevel = 0;
@@ -152,6 +165,8 @@ void PassManagerBuilder::populateModulePassManager(PassManagerBase &MPM) {
 
     MPM.add(createGlobalOptimizerPass());     // Optimize out global vars
 
+    if (RunFunctionSpecialization && OptLevel > 2 && SizeLevel == 0)
+      MPM.add(createFunctionSpecializationPass());
     MPM.add(createIPSCCPPass());              // IP SCCP
     MPM.add(createDeadArgEliminationPass());  // Dead argument elimination
 
@@ -193,6 +208,8 @@ void PassManagerBuilder::populateModulePassManager(PassManagerBase &MPM) {
   MPM.add(createIndVarSimplifyPass());        // Canonicalize indvars
   MPM.add(createLoopIdiomPass());             // Recognize idioms like memset.
   MPM.add(createLoopDeletionPass());          // Delete dead loops
+  if (RunLoopInterchange)
+    MPM.add(createLoopInterchangePass());     // Interchange loop nests
 
   if (!DisableUnrollLoops)
     MPM.add(createLoopUnrollPass());          // Unroll small loops
@@ -339,6 +356,11 @@ void PassManagerBuilder::populateLTOPassManager(PassManagerBase &PM,
   // Delete basic blocks, which optimization passes may have killed.
   PM.add(createCFGSimplificationPass());
 
+  // Functions that are identical once optimized can be folded outright when
+  // nothing outside the program can take their address.
+  if (RunLTOMergeFunctions)
+    PM.add(createMergeFunctionsPass(/*FoldIdentical=*/true));
+
   // Now that we have optimized the program, discard unreachable functions.
   PM.add(createGlobalDCEPass());
 }
@@ -77,6 +77,10 @@ class LLVM_LIBRARY_VISIBILITY InstCombiner
   bool MadeIRChange;
   LibCallSimplifier *Simplifier;
   bool MinimizeSize;
+
+  /// CombinesPerOpcode - The number of successful combines for each opcode
+  /// in the current function, if -instcombine-print-stats is given.
+  SmallVector<unsigned, 64> CombinesPerOpcode;
 public:
   /// Worklist - All of the instructions that need to be simplified.
   InstCombineWorklist Worklist;
@@ -12,10 +12,12 @@
 
 #define DEBUG_TYPE "instcombine"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/IR/Instruction.h"
 #include "llvm/Support/Compiler.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/ValueHandle.h"
 #include "llvm/Support/raw_ostream.h"
 
 namespace llvm {
@@ -26,10 +28,15 @@ class LLVM_LIBRARY_VISIBILITY InstCombineWorklist {
   SmallVector<Instruction*, 256> Worklist;
   DenseMap<Instruction*, unsigned> WorklistMap;
 
+  /// Changed - If TrackChanges is set, the instructions that were added one
+  /// at a time, i.e. that were created or affected by a combine.
+  SmallVector<WeakVH, 64> Changed;
+  bool TrackChanges;
+
   void operator=(const InstCombineWorklist&RHS) LLVM_DELETED_FUNCTION;
   InstCombineWorklist(const InstCombineWorklist&) LLVM_DELETED_FUNCTION;
 public:
-  InstCombineWorklist() {}
+  InstCombineWorklist() : TrackChanges(false) {}
 
   bool isEmpty() const { return Worklist.empty(); }
 
@@ -39,7 +46,27 @@ public:
     if (WorklistMap.insert(std::make_pair(I, Worklist.size())).second) {
       DEBUG(dbgs() << "IC: ADD: " << *I << '\n');
       Worklist.push_back(I);
+      if (TrackChanges)
+        Changed.push_back(I);
+    }
+  }
+
+  /// setTrackChanges - Start or stop recording the instructions added with
+  /// Add.  This discards anything recorded so far.
+  void setTrackChanges(bool Track) {
+    TrackChanges = Track;
+    Changed.clear();
+  }
+
+  /// takeChanged - Move the recorded instructions that still exist into
+  /// Insts and start a new recording.
+  void takeChanged(SmallPtrSet<Instruction*, 64> &Insts) {
+    for (unsigned i = 0, e = Changed.size(); i != e; ++i) {
+      Value *V = Changed[i];
+      if (Instruction *I = dyn_cast_or_null<Instruction>(V))
+        Insts.insert(I);
     }
+    Changed.clear();
   }
 
   void AddValue(Value *V) {
@@ -65,12 +65,30 @@ STATISTIC(NumSunkInst , "Number of instructions sunk");
 STATISTIC(NumExpand,    "Number of expansions");
 STATISTIC(NumFactor   , "Number of factorizations");
 STATISTIC(NumReassoc  , "Number of reassociations");
+STATISTIC(NumIterations, "Number of instcombine iterations");
+STATISTIC(NumIterationLimit, "Number of functions that hit the iteration limit");
 
 static cl::opt<bool> UnsafeFPShrink("enable-double-float-shrink", cl::Hidden,
                                    cl::init(false),
                                    cl::desc("Enable unsafe double to float "
                                             "shrinking for math lib calls"));
 
+static cl::opt<bool>
+IncrementalMode("instcombine-incremental", cl::Hidden, cl::init(false),
+                cl::desc("After the first iteration, only revisit the "
+                         "instructions changed by the previous iteration "
+                         "and their users"));
+
+static cl::opt<unsigned>
+MaxIterations("instcombine-max-iterations", cl::Hidden, cl::init(1000),
+              cl::desc("Maximum number of instcombine iterations per "
+                       "function"));
+
+static cl::opt<bool>
+PrintStats("instcombine-print-stats", cl::Hidden, cl::init(false),
+           cl::desc("Print the number of iterations and of combines per "
+                    "opcode for each function"));
+
 // Initialization Routines
 void llvm::initializeInstCombine(PassRegistry &Registry) {
   initializeInstCombinerPass(Registry);
@@ -2211,11 +2229,15 @@ static bool TryToSinkInstruction(Instruction *I, BasicBlock *DestBlock) {
 /// many instructions are dead or constant).  Additionally, if we find a branch
 /// whose condition is a known constant, we only visit the reachable successors.
 ///
+/// If Seeds is non-null, only the instructions in it, and those whose operands
+/// were folded here, are added to the worklist.
+///
 static bool AddReachableCodeToWorklist(BasicBlock *BB,
                                        SmallPtrSet<BasicBlock*, 64> &Visited,
                                        InstCombiner &IC,
                                        const DataLayout *TD,
-                                       const TargetLibraryInfo *TLI) {
+                                       const TargetLibraryInfo *TLI,
+                                    const SmallPtrSet<Instruction*, 64> *Seeds) {
   bool MadeIRChange = false;
   SmallVector<BasicBlock*, 256> Worklist;
   Worklist.push_back(BB);
@@ -2251,6 +2273,7 @@ static bool AddReachableCodeToWorklist(BasicBlock *BB,
           continue;
         }
 
+      bool FoldedOperand = false;
       if (TD) {
         // See if we can constant fold its operands.
         for (User::op_iterator i = Inst->op_begin(), e = Inst->op_end();
@@ -2267,11 +2290,13 @@ static bool AddReachableCodeToWorklist(BasicBlock *BB,
           if (FoldRes != CE) {
             *i = FoldRes;
             MadeIRChange = true;
+            FoldedOperand = true;
           }
         }
       }
 
-      InstrsForInstCombineWorklist.push_back(Inst);
+      if (!Seeds || FoldedOperand || Seeds->count(Inst))
+        InstrsForInstCombineWorklist.push_back(Inst);
     }
 
     // Recursively visit successors.  If this is a branch or switch on a
@@ -2310,7 +2335,7 @@ static bool AddReachableCodeToWorklist(BasicBlock *BB,
   // of the function down.  This jives well with the way that it adds all uses
   // of instructions to the worklist after doing a transformation, thus avoiding
   // some N^2 behavior in pathological cases.
-  IC.Worklist.AddInitialGroup(&InstrsForInstCombineWorklist[0],
+  IC.Worklist.AddInitialGroup(InstrsForInstCombineWorklist.data(),
                               InstrsForInstCombineWorklist.size());
 
   return MadeIRChange;
@@ -2321,6 +2346,21 @@ bool InstCombiner::DoOneIteration(Function &F, unsigned Iteration) {
 
   DEBUG(dbgs() << "\n\nINSTCOMBINE ITERATION #" << Iteration << " on "
                << F.getName() << "\n");
+  ++NumIterations;
+
+  // In incremental mode, every iteration after the first one starts from the
+  // instructions the previous one created or affected, plus their users,
+  // instead of from every instruction in the function.
+  bool Incremental = IncrementalMode && Iteration != 0;
+  SmallPtrSet<Instruction*, 64> Seeds;
+  if (Incremental) {
+    Worklist.takeChanged(Seeds);
+    SmallVector<Instruction*, 64> Changed(Seeds.begin(), Seeds.end());
+    for (unsigned i = 0, e = Changed.size(); i != e; ++i)
+      for (Value::use_iterator UI = Changed[i]->use_begin(),
+           UE = Changed[i]->use_end(); UI != UE; ++UI)
+        Seeds.insert(cast<Instruction>(*UI));
+  }
 
   {
     // Do a depth-first traversal of the function, populate the worklist with
@@ -2328,7 +2368,7 @@ bool InstCombiner::DoOneIteration(Function &F, unsigned Iteration) {
     // track of which blocks we visit.
     SmallPtrSet<BasicBlock*, 64> Visited;
     MadeIRChange |= AddReachableCodeToWorklist(F.begin(), Visited, *this, TD,
-                                               TLI);
+                                               TLI, Incremental ? &Seeds : 0);
 
     // Do a quick scan over the function.  If we find any blocks that are
     // unreachable, remove any instructions inside of them.  This prevents
@@ -2424,8 +2464,11 @@ bool InstCombiner::DoOneIteration(Function &F, unsigned Iteration) {
     DEBUG(raw_string_ostream SS(OrigI); I->print(SS); OrigI = SS.str(););
     DEBUG(dbgs() << "IC: Visiting: " << OrigI << '\n');
 
+    unsigned Opcode = I->getOpcode();
     if (Instruction *Result = visit(*I)) {
       ++NumCombined;
+      if (PrintStats)
+        ++CombinesPerOpcode[Opcode];
       // Should we replace the old instruction with a new one?
       if (Result != I) {
         DEBUG(dbgs() << "IC: Old = " << *I << '\n'
@@ -2520,10 +2563,30 @@ bool InstCombiner::runOnFunction(Function &F) {
   // by instcombiner.
   EverMadeChange = LowerDbgDeclare(F);
 
+  if (PrintStats)
+    CombinesPerOpcode.assign(Instruction::OtherOpsEnd, 0);
+  Worklist.setTrackChanges(IncrementalMode);
+
   // Iterate while there is work to do.
   unsigned Iteration = 0;
-  while (DoOneIteration(F, Iteration++))
+  while (DoOneIteration(F, Iteration++)) {
     EverMadeChange = true;
+    if (Iteration == MaxIterations) {
+      DEBUG(dbgs() << "IC: Stopping after " << Iteration << " iterations on "
+                   << F.getName() << '\n');
+      ++NumIterationLimit;
+      break;
+    }
+  }
+
+  Worklist.setTrackChanges(false);
+  if (PrintStats) {
+    dbgs() << "IC: " << F.getName() << ": " << Iteration << " iterations\n";
+    for (unsigned Op = 0, E = CombinesPerOpcode.size(); Op != E; ++Op)
+      if (CombinesPerOpcode[Op])
+        dbgs() << "IC:   " << Instruction::getOpcodeName(Op) << ": "
+               << CombinesPerOpcode[Op] << " combines\n";
+  }
 
   Builder = 0;
   return EverMadeChange;
@@ -20,12 +20,14 @@
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/DepthFirstIterator.h"
 #include "llvm/ADT/OwningPtr.h"
+#include "llvm/ADT/PostOrderIterator.h"
 #include "llvm/ADT/SmallSet.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/Triple.h"
+#include "llvm/Analysis/LoopInfo.h"
 #include "llvm/DIBuilder.h"
 #include "llvm/IR/DataLayout.h"
 #include "llvm/IR/Function.h"
@@ -36,6 +38,7 @@
 #include "llvm/IR/Module.h"
 #include "llvm/IR/Type.h"
 #include "llvm/InstVisitor.h"
+#include "llvm/Support/CFG.h"
 #include "llvm/Support/CallSite.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/DataTypes.h"
@@ -176,6 +179,12 @@ static cl::opt<bool> ClOptSameTemp("asan-opt-same-temp",
        cl::init(true));
 static cl::opt<bool> ClOptGlobals("asan-opt-globals",
        cl::desc("Don't instrument scalar globals"), cl::Hidden, cl::init(true));
+static cl::opt<bool> ClOptAcrossBlocks("asan-opt-across-blocks",
+       cl::desc("Don't instrument a temp that was checked on every path to it"),
+       cl::Hidden, cl::init(true));
+static cl::opt<bool> ClOptHoist("asan-opt-hoist",
+       cl::desc("Check loop invariant temps once before loops without calls"),
+       cl::Hidden, cl::init(true));
 
 static cl::opt<bool> ClCheckLifetime("asan-check-lifetime",
        cl::desc("Use llvm.lifetime intrinsics to insert extra checks"),
@@ -199,6 +208,10 @@ STATISTIC(NumOptimizedAccessesToGlobalArray,
           "Number of optimized accesses to global arrays");
 STATISTIC(NumOptimizedAccessesToGlobalVar,
           "Number of optimized accesses to global vars");
+STATISTIC(NumOptimizedRedundantAccesses,
+          "Number of accesses to temps already checked on every path");
+STATISTIC(NumHoistedChecks,
+          "Number of checks hoisted to loop preheaders");
 
 namespace {
 /// A set of dynamically initialized globals extracted from metadata.
@@ -296,7 +309,7 @@ struct AddressSanitizer : public FunctionPass {
   virtual const char *getPassName() const {
     return "AddressSanitizerFunctionPass";
   }
-  void instrumentMop(Instruction *I);
+  void instrumentMop(Instruction *I, Instruction *InsertBefore);
   void instrumentAddress(Instruction *OrigIns, Instruction *InsertBefore,
                          Value *Addr, uint32_t TypeSize, bool IsWrite,
                          Value *SizeArgument);
@@ -311,6 +324,9 @@ struct AddressSanitizer : public FunctionPass {
                                    Instruction *InsertBefore, bool IsWrite);
   Value *memToShadow(Value *Shadow, IRBuilder<> &IRB);
   bool runOnFunction(Function &F);
+  virtual void getAnalysisUsage(AnalysisUsage &AU) const {
+    AU.addRequired<LoopInfo>();
+  }
   bool maybeInsertAsanInitAtFunctionEntry(Function &F);
   void emitShadowMapping(Module &M, IRBuilder<> &IRB) const;
   virtual bool doInitialization(Module &M);
@@ -324,6 +340,11 @@ struct AddressSanitizer : public FunctionPass {
   void FindDynamicInitializers(Module &M);
   bool GlobalIsLinkerInitialized(GlobalVariable *G);
   bool InjectCoverage(Function &F);
+  typedef SmallVector<std::pair<Instruction*, BasicBlock*>, 8> HoistedList;
+  typedef DenseMap<BasicBlock*, SmallVector<Value*, 8> > CheckedTempMap;
+  void findHoistableChecks(Loop *L, HoistedList &Hoisted);
+  void findCheckedTemps(Function &F, const HoistedList &Hoisted,
+                        CheckedTempMap &CheckedAtEntry);
 
   bool CheckInitOrder;
   bool CheckUseAfterReturn;
@@ -531,7 +552,11 @@ struct FunctionStackPoisoner : public InstVisitor<FunctionStackPoisoner> {
 }  // namespace
 
 char AddressSanitizer::ID = 0;
-INITIALIZE_PASS(AddressSanitizer, "asan",
+INITIALIZE_PASS_BEGIN(AddressSanitizer, "asan",
+    "AddressSanitizer: detects use-after-free and out-of-bounds bugs.",
+    false, false)
+INITIALIZE_PASS_DEPENDENCY(LoopInfo)
+INITIALIZE_PASS_END(AddressSanitizer, "asan",
     "AddressSanitizer: detects use-after-free and out-of-bounds bugs.",
     false, false)
 FunctionPass *llvm::createAddressSanitizerFunctionPass(
@@ -669,7 +694,8 @@ bool AddressSanitizer::GlobalIsLinkerInitialized(GlobalVariable *G) {
   return G->hasInitializer() && !DynamicallyInitializedGlobals.Contains(G);
 }
 
-void AddressSanitizer::instrumentMop(Instruction *I) {
+void AddressSanitizer::instrumentMop(Instruction *I,
+                                     Instruction *InsertBefore) {
   bool IsWrite = false;
   Value *Addr = isInterestingMemoryAccess(I, &IsWrite);
   assert(Addr);
@@ -709,19 +735,19 @@ void AddressSanitizer::instrumentMop(Instruction *I) {
   // Instrument a 1-, 2-, 4-, 8-, or 16- byte access with one check.
   if (TypeSize == 8  || TypeSize == 16 ||
       TypeSize == 32 || TypeSize == 64 || TypeSize == 128)
-    return instrumentAddress(I, I, Addr, TypeSize, IsWrite, 0);
+    return instrumentAddress(I, InsertBefore, Addr, TypeSize, IsWrite, 0);
   // Instrument unusual size (but still multiple of 8).
   // We can not do it with a single check, so we do 1-byte check for the first
   // and the last bytes. We call __asan_report_*_n(addr, real_size) to be able
   // to report the actual access size.
-  IRBuilder<> IRB(I);
+  IRBuilder<> IRB(InsertBefore);
   Value *LastByte =  IRB.CreateIntToPtr(
       IRB.CreateAdd(IRB.CreatePointerCast(Addr, IntptrTy),
                     ConstantInt::get(IntptrTy, TypeSize / 8 - 1)),
       OrigPtrTy);
   Value *Size = ConstantInt::get(IntptrTy, TypeSize / 8);
-  instrumentAddress(I, I, Addr, 8, IsWrite, Size);
-  instrumentAddress(I, I, LastByte, 8, IsWrite, Size);
+  instrumentAddress(I, InsertBefore, Addr, 8, IsWrite, Size);
+  instrumentAddress(I, InsertBefore, LastByte, 8, IsWrite, Size);
 }
 
 // Validate the result of Module::getOrInsertFunction called for an interface
@@ -1209,6 +1235,127 @@ bool AddressSanitizer::InjectCoverage(Function &F) {
   return true;
 }
 
+// Return true if I may free or poison memory, so that earlier checks of a
+// temp do not cover later accesses to it.
+static bool invalidatesChecks(Instruction *I) {
+  return CallSite(I) && !isa<DbgInfoIntrinsic>(I);
+}
+
+// Find the accesses to loop invariant temps at the top of the header of each
+// loop without calls, which are executed whenever the loop is entered. Their
+// check is made once in the preheader instead.
+void AddressSanitizer::findHoistableChecks(Loop *L, HoistedList &Hoisted) {
+  for (Loop::iterator I = L->begin(), E = L->end(); I != E; ++I)
+    findHoistableChecks(*I, Hoisted);
+
+  BasicBlock *Preheader = L->getLoopPreheader();
+  if (!Preheader)
+    return;
+  for (Loop::block_iterator BI = L->block_begin(), BE = L->block_end();
+       BI != BE; ++BI)
+    for (BasicBlock::iterator I = (*BI)->begin(), E = (*BI)->end(); I != E;
+         ++I)
+      if (invalidatesChecks(I))
+        return;
+
+  SmallPtrSet<Value*, 8> Seen;
+  bool IsWrite;
+  BasicBlock *Header = L->getHeader();
+  for (BasicBlock::iterator I = Header->begin(), E = Header->end(); I != E;
+       ++I) {
+    Value *Addr = isInterestingMemoryAccess(I, &IsWrite);
+    if (Addr && L->isLoopInvariant(Addr) && Seen.insert(Addr)) {
+      Hoisted.push_back(std::make_pair(&*I, Preheader));
+      NumHoistedChecks++;
+    }
+  }
+}
+
+// Compute the temps that are checked on every path to the entry of each block,
+// using the same rules for which accesses are instrumented and which
+// instructions clear the checked temps as runOnFunction. Accesses past the
+// per-block limit are conservatively left out.
+void AddressSanitizer::findCheckedTemps(Function &F,
+                                        const HoistedList &Hoisted,
+                                        CheckedTempMap &CheckedAtEntry) {
+  CheckedTempMap Gen, Out;
+  SmallPtrSet<BasicBlock*, 16> Kills;
+  bool IsWrite;
+  for (Function::iterator FI = F.begin(), FE = F.end(); FI != FE; ++FI) {
+    SmallVector<Value*, 8> &G = Gen[FI];
+    int NumInsnsPerBB = 0;
+    for (BasicBlock::iterator BI = FI->begin(), BE = FI->end();
+         BI != BE; ++BI) {
+      if (Value *Addr = isInterestingMemoryAccess(BI, &IsWrite)) {
+        if (NumInsnsPerBB++ < ClMaxInsnsToInstrumentPerBB)
+          G.push_back(Addr);
+      } else if (isa<MemIntrinsic>(BI) && ClMemIntrin) {
+        NumInsnsPerBB++;
+      } else if (invalidatesChecks(BI)) {
+        G.clear();
+        Kills.insert(FI);
+      }
+    }
+  }
+  for (unsigned i = 0, e = Hoisted.size(); i != e; ++i)
+    Gen[Hoisted[i].second].push_back(
+        isInterestingMemoryAccess(Hoisted[i].first, &IsWrite));
+  for (CheckedTempMap::iterator I = Gen.begin(), E = Gen.end(); I != E; ++I) {
+    std::sort(I->second.begin(), I->second.end());
+    I->second.erase(std::unique(I->second.begin(), I->second.end()),
+                    I->second.end());
+  }
+
+  // Iterate to a fixed point in reverse post order. A block without an
+  // entry in Out has not been visited yet and does not restrict its
+  // successors.
+  ReversePostOrderTraversal<Function*> RPOT(&F);
+  bool Changed = true;
+  while (Changed) {
+    Changed = false;
+    for (ReversePostOrderTraversal<Function*>::rpo_iterator I = RPOT.begin(),
+         E = RPOT.end(); I != E; ++I) {
+      BasicBlock *BB = *I;
+      SmallVector<Value*, 8> In, Tmp;
+      bool First = true;
+      for (pred_iterator PI = pred_begin(BB), PE = pred_end(BB); PI != PE;
+           ++PI) {
+        CheckedTempMap::iterator O = Out.find(*PI);
+        if (O == Out.end())
+          continue;
+        if (First) {
+          In = O->second;
+          First = false;
+          continue;
+        }
+        Tmp.clear();
+        std::set_intersection(In.begin(), In.end(),
+                              O->second.begin(), O->second.end(),
+                              std::back_inserter(Tmp));
+        In.swap(Tmp);
+      }
+
+      SmallVector<Value*, 8> &G = Gen[BB];
+      SmallVector<Value*, 8> NewOut;
+      if (Kills.count(BB))
+        NewOut = G;
+      else
+        std::set_union(In.begin(), In.end(), G.begin(), G.end(),
+                       std::back_inserter(NewOut));
+      CheckedAtEntry[BB].swap(In);
+
+      CheckedTempMap::iterator O = Out.find(BB);
+      if (O == Out.end()) {
+        Out[BB].swap(NewOut);
+        Changed = true;
+      } else if (O->second != NewOut) {
+        O->second.swap(NewOut);
+        Changed = true;
+      }
+    }
+  }
+}
+
 bool AddressSanitizer::runOnFunction(Function &F) {
   if (BL->isIn(F)) return false;
   if (&F == AsanCtorFunction) return false;
@@ -1225,39 +1372,60 @@ bool AddressSanitizer::runOnFunction(Function &F) {
   if (!ClDebugFunc.empty() && ClDebugFunc != F.getName())
     return false;
 
-  // We want to instrument every address only once per basic block (unless there
-  // are calls between uses).
+  // We want to instrument every address only once (unless there are calls
+  // between uses), both within a basic block and across blocks when it was
+  // checked on every path to the block.
   SmallSet<Value*, 16> TempsToInstrument;
   SmallVector<Instruction*, 16> ToInstrument;
   SmallVector<Instruction*, 8> NoReturnCalls;
   int NumAllocas = 0;
   bool IsWrite;
 
+  HoistedList Hoisted;
+  CheckedTempMap CheckedAtEntry;
+  DenseMap<Instruction*, Instruction*> HoistedTo;
+  if (ClOpt && ClOptSameTemp && ClOptAcrossBlocks) {
+    if (ClOptHoist) {
+      LoopInfo &LI = getAnalysis<LoopInfo>();
+      for (LoopInfo::iterator I = LI.begin(), E = LI.end(); I != E; ++I)
+        findHoistableChecks(*I, Hoisted);
+    }
+    findCheckedTemps(F, Hoisted, CheckedAtEntry);
+    for (unsigned i = 0, e = Hoisted.size(); i != e; ++i) {
+      ToInstrument.push_back(Hoisted[i].first);
+      HoistedTo[Hoisted[i].first] = Hoisted[i].second->getTerminator();
+    }
+  }
+
   // Fill the set of memory operations to instrument.
   for (Function::iterator FI = F.begin(), FE = F.end();
        FI != FE; ++FI) {
     TempsToInstrument.clear();
+    CheckedTempMap::iterator Checked = CheckedAtEntry.find(FI);
+    if (Checked != CheckedAtEntry.end())
+      TempsToInstrument.insert(Checked->second.begin(), Checked->second.end());
     int NumInsnsPerBB = 0;
     for (BasicBlock::iterator BI = FI->begin(), BE = FI->end();
          BI != BE; ++BI) {
       if (LooksLikeCodeInBug11395(BI)) return false;
       if (Value *Addr = isInterestingMemoryAccess(BI, &IsWrite)) {
         if (ClOpt && ClOptSameTemp) {
-          if (!TempsToInstrument.insert(Addr))
-            continue;  // We've seen this temp in the current BB.
+          if (!TempsToInstrument.insert(Addr)) {
+            // This temp was checked earlier in the BB or on all paths to it.
+            NumOptimizedRedundantAccesses++;
+            continue;
+          }
         }
       } else if (isa<MemIntrinsic>(BI) && ClMemIntrin) {
         // ok, take it.
       } else {
         if (isa<AllocaInst>(BI))
           NumAllocas++;
-        CallSite CS(BI);
-        if (CS) {
-          // A call inside BB.
+        if (invalidatesChecks(BI))
           TempsToInstrument.clear();
-          if (CS.doesNotReturn())
-            NoReturnCalls.push_back(CS.getInstruction());
-        }
+        CallSite CS(BI);
+        if (CS && CS.doesNotReturn())
+          NoReturnCalls.push_back(CS.getInstruction());
         continue;
       }
       ToInstrument.push_back(BI);
@@ -1284,9 +1452,10 @@ bool AddressSanitizer::runOnFunction(Function &F) {
     Instruction *Inst = ToInstrument[i];
     if (ClDebugMin < 0 || ClDebugMax < 0 ||
         (NumInstrumented >= ClDebugMin && NumInstrumented <= ClDebugMax)) {
-      if (isInterestingMemoryAccess(Inst, &IsWrite))
-        instrumentMop(Inst);
-      else
+      if (isInterestingMemoryAccess(Inst, &IsWrite)) {
+        Instruction *InsertBefore = HoistedTo.lookup(Inst);
+        instrumentMop(Inst, InsertBefore ? InsertBefore : Inst);
+      } else
         instrumentMemIntrinsic(cast<MemIntrinsic>(Inst));
     }
     NumInstrumented++;
@@ -0,0 +1,151 @@
+//===- ExecutionCounters.cpp - In-memory execution counts for JIT tiers ---===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements a pass that gives every defined function a pair of
+// 64-bit counters, incremented on function entry and on every loop back-edge.
+// The counters live in ordinary global variables, so a JIT can read them
+// while the code runs and decide which functions to recompile with more
+// optimization.  Unlike GCOVProfiling nothing is written out; the counters
+// are meant to be read in memory through the ExecutionEngine.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "exec-counters"
+#include "llvm/Transforms/Instrumentation.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Analysis/CFG.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/DerivedTypes.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/GlobalVariable.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Pass.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Transforms/Utils/BasicBlockUtils.h"
+using namespace llvm;
+
+STATISTIC(NumFunctionsInstrumented, "Functions given execution counters");
+STATISTIC(NumBackEdgesInstrumented, "Loop back-edges given counters");
+
+namespace {
+  struct ExecutionCounters : public ModulePass {
+    static char ID;
+
+    ExecutionCounters() : ModulePass(ID) {
+      initializeExecutionCountersPass(*PassRegistry::getPassRegistry());
+    }
+
+    virtual bool runOnModule(Module &M);
+
+  private:
+    void instrumentFunction(Function &F);
+    void emitIncrement(GlobalVariable *Counters, unsigned Index,
+                       Instruction *InsertPt);
+  };
+}
+
+char ExecutionCounters::ID = 0;
+INITIALIZE_PASS(ExecutionCounters, "exec-counters",
+                "Insert in-memory execution counters", false, false)
+
+ModulePass *llvm::createExecutionCountersPass() {
+  return new ExecutionCounters();
+}
+
+std::string llvm::getExecutionCounterName(StringRef FunctionName) {
+  return ("__llvm_exec_count_" + FunctionName).str();
+}
+
+/// emitIncrement - Add one to element Index of the counter array before
+/// InsertPt.  The update is deliberately not atomic: counts only need to be
+/// approximately right to find hot code, and a plain add is far cheaper.
+void ExecutionCounters::emitIncrement(GlobalVariable *Counters, unsigned Index,
+                                      Instruction *InsertPt) {
+  IRBuilder<> Builder(InsertPt);
+  Value *Addr = Builder.CreateConstInBoundsGEP2_64(Counters, 0, Index);
+  Value *Count = Builder.CreateLoad(Addr);
+  Builder.CreateStore(Builder.CreateAdd(Count, Builder.getInt64(1)), Addr);
+}
+
+void ExecutionCounters::instrumentFunction(Function &F) {
+  // Find the back-edges before the CFG is changed by splitting them.
+  SmallVector<std::pair<const BasicBlock*, const BasicBlock*>, 8> BackEdges;
+  FindFunctionBackedges(F, BackEdges);
+
+  Module *M = F.getParent();
+  ArrayType *CountersTy = ArrayType::get(Type::getInt64Ty(M->getContext()), 2);
+  // The counters go wherever the function goes: a linkonce or weak function
+  // may be defined in several modules, which must then share one set of
+  // counters rather than clash.  They must have a name in the generated
+  // object so that the ExecutionEngine can find them, so the counters of a
+  // private function are internal instead.
+  GlobalValue::LinkageTypes Linkage = F.getLinkage();
+  if (Linkage == GlobalValue::PrivateLinkage)
+    Linkage = GlobalValue::InternalLinkage;
+  GlobalVariable *Counters =
+    new GlobalVariable(*M, CountersTy, false, Linkage,
+                       Constant::getNullValue(CountersTy),
+                       getExecutionCounterName(F.getName()));
+  Counters->setVisibility(F.getVisibility());
+
+  // Count entries after the entry block's allocas so that they stay
+  // together at the top of the function.
+  BasicBlock::iterator EntryPt = F.getEntryBlock().getFirstInsertionPt();
+  while (isa<AllocaInst>(EntryPt))
+    ++EntryPt;
+  emitIncrement(Counters, 0, EntryPt);
+
+  for (unsigned i = 0, e = BackEdges.size(); i != e; ++i) {
+    BasicBlock *From = const_cast<BasicBlock*>(BackEdges[i].first);
+    BasicBlock *To = const_cast<BasicBlock*>(BackEdges[i].second);
+    TerminatorInst *TI = From->getTerminator();
+
+    // Put the increment on the edge itself: in the latch if it only goes to
+    // the header, in the header if only the latch reaches it, and otherwise
+    // in a new block splitting the edge.
+    Instruction *InsertPt = 0;
+    if (TI->getNumSuccessors() == 1) {
+      InsertPt = TI;
+    } else if (To->getSinglePredecessor()) {
+      InsertPt = To->getFirstInsertionPt();
+    } else if (!isa<IndirectBrInst>(TI)) {
+      // Edges out of an indirectbr cannot be split; leave them uncounted.
+      for (unsigned s = 0, se = TI->getNumSuccessors(); s != se; ++s) {
+        if (TI->getSuccessor(s) != To)
+          continue;
+        if (BasicBlock *NewBB = SplitCriticalEdge(TI, s))
+          InsertPt = NewBB->getTerminator();
+        break;
+      }
+    }
+    if (!InsertPt)
+      continue;
+    emitIncrement(Counters, 1, InsertPt);
+    ++NumBackEdgesInstrumented;
+  }
+
+  DEBUG(dbgs() << "exec-counters: " << F.getName() << ", "
+               << BackEdges.size() << " back-edges\n");
+  ++NumFunctionsInstrumented;
+}
+
+bool ExecutionCounters::runOnModule(Module &M) {
+  bool Changed = false;
+  for (Module::iterator F = M.begin(), E = M.end(); F != E; ++F) {
+    if (F->isDeclaration() || F->hasAvailableExternallyLinkage())
+      continue;
+    instrumentFunction(*F);
+    Changed = true;
+  }
+  return Changed;
+}
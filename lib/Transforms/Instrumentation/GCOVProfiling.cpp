@@ -18,12 +18,14 @@
 
 #include "llvm/Transforms/Instrumentation.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/EquivalenceClasses.h"
 #include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/UniqueVector.h"
+#include "llvm/Analysis/LoopInfo.h"
 #include "llvm/DebugInfo.h"
 #include "llvm/IR/IRBuilder.h"
 #include "llvm/IR/Instructions.h"
@@ -33,6 +35,7 @@
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/DebugLoc.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/GCOVFormat.h"
 #include "llvm/Support/InstIterator.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/raw_ostream.h"
@@ -46,6 +49,15 @@ static cl::opt<std::string>
 DefaultGCOVVersion("default-gcov-version", cl::init("402*"), cl::Hidden,
                    cl::ValueRequired);
 
+static cl::opt<bool>
+SpanningTree("gcov-spanning-tree", cl::init(false), cl::Hidden,
+             cl::desc("Only add counters to the edges that are not on a "
+                      "spanning tree of the CFG; the counts of the others are "
+                      "derived from flow conservation by gcov and llvm-cov"));
+
+STATISTIC(NumEdgesOnTree, "Number of edges left without a counter");
+STATISTIC(NumEdgeCounters, "Number of edge counters inserted");
+
 GCOVOptions GCOVOptions::getDefault() {
   GCOVOptions Options;
   Options.EmitNotes = true;
@@ -82,6 +94,9 @@ namespace {
     virtual const char *getPassName() const {
       return "GCOV Profiler";
     }
+    virtual void getAnalysisUsage(AnalysisUsage &AU) const {
+      AU.addRequired<LoopInfo>();
+    }
 
   private:
     void init() {
@@ -101,6 +116,11 @@ namespace {
     // profiling runtime to emit .gcda files when run.
     bool emitProfileArcs();
 
+    // Return, for every edge of F in .gcno order, whether it is on the spanning
+    // tree and so gets no counter. The tree is computed once so that the notes
+    // and the instrumentation agree on it.
+    const std::vector<bool> &getTreeEdges(Function *F);
+
     // Get pointers to the functions in the runtime library.
     Constant *getStartFileFunc();
     Constant *getIncrementIndirectCounterFunc();
@@ -119,6 +139,7 @@ namespace {
     // block number.
     GlobalVariable *buildEdgeLookupTable(Function *F,
                                          GlobalVariable *Counter,
+                                         ArrayRef<unsigned> CounterIdx,
                                          const UniqueVector<BasicBlock *>&Preds,
                                          const UniqueVector<BasicBlock*>&Succs);
 
@@ -141,12 +162,16 @@ namespace {
     Module *M;
     LLVMContext *Ctx;
     SmallVector<GCOVFunction *, 16> Funcs;
+    DenseMap<Function *, std::vector<bool> > TreeEdges;
   };
 }
 
 char GCOVProfiler::ID = 0;
-INITIALIZE_PASS(GCOVProfiler, "insert-gcov-profiling",
-                "Insert instrumentation for GCOV profiling", false, false)
+INITIALIZE_PASS_BEGIN(GCOVProfiler, "insert-gcov-profiling",
+                      "Insert instrumentation for GCOV profiling", false, false)
+INITIALIZE_PASS_DEPENDENCY(LoopInfo)
+INITIALIZE_PASS_END(GCOVProfiler, "insert-gcov-profiling",
+                    "Insert instrumentation for GCOV profiling", false, false)
 
 ModulePass *llvm::createGCOVProfilerPass(const GCOVOptions &Options) {
   return new GCOVProfiler(Options);
@@ -259,8 +284,9 @@ namespace {
       return *Lines;
     }
 
-    void addEdge(GCOVBlock &Successor) {
+    void addEdge(GCOVBlock &Successor, bool OnTree) {
       OutEdges.push_back(&Successor);
+      OutEdgeOnTree.push_back(OnTree);
     }
 
     void writeOut() {
@@ -301,6 +327,7 @@ namespace {
     uint32_t Number;
     StringMap<GCOVLines *> LinesByFile;
     SmallVector<GCOVBlock *, 4> OutEdges;
+    SmallVector<bool, 4> OutEdgeOnTree;
   };
 
   // A function has a unique identifier, a checksum (we leave as zero) and a
@@ -398,7 +425,7 @@ namespace {
           DEBUG(dbgs() << Block.Number << " -> " << Block.OutEdges[i]->Number
                        << "\n");
           write(Block.OutEdges[i]->Number);
-          write(0);  // no flags
+          write(Block.OutEdgeOnTree[i] ? GCOV::ArcOnTree : 0);
         }
       }
 
@@ -485,15 +512,17 @@ void GCOVProfiler::emitProfileNotes() {
         new GCOVFunction(SP, &out, i, Options.UseCfgChecksum);
       Funcs.push_back(Func);
 
+      const std::vector<bool> &OnTree = getTreeEdges(F);
+      unsigned Edge = 0;
       for (Function::iterator BB = F->begin(), E = F->end(); BB != E; ++BB) {
         GCOVBlock &Block = Func->getBlock(BB);
         TerminatorInst *TI = BB->getTerminator();
         if (int successors = TI->getNumSuccessors()) {
           for (int i = 0; i != successors; ++i) {
-            Block.addEdge(Func->getBlock(TI->getSuccessor(i)));
+            Block.addEdge(Func->getBlock(TI->getSuccessor(i)), OnTree[Edge++]);
           }
         } else if (isa<ReturnInst>(TI)) {
-          Block.addEdge(Func->getReturnBlock());
+          Block.addEdge(Func->getReturnBlock(), OnTree[Edge++]);
         }
 
         uint32_t Line = 0;
@@ -548,17 +577,17 @@ bool GCOVProfiler::emitProfileArcs() {
       Function *F = SP.getFunction();
       if (!F) continue;
       if (!Result) Result = true;
-      unsigned Edges = 0;
-      for (Function::iterator BB = F->begin(), E = F->end(); BB != E; ++BB) {
-        TerminatorInst *TI = BB->getTerminator();
-        if (isa<ReturnInst>(TI))
-          ++Edges;
-        else
-          Edges += TI->getNumSuccessors();
-      }
-      
+
+      // Number the counters of the edges that are not on the spanning tree.
+      const std::vector<bool> &OnTree = getTreeEdges(F);
+      SmallVector<unsigned, 32> CounterIdx;
+      unsigned Counts = 0;
+      for (unsigned Edge = 0, E = OnTree.size(); Edge != E; ++Edge)
+        CounterIdx.push_back(OnTree[Edge] ? ~0U : Counts++);
+      NumEdgeCounters += Counts;
+
       ArrayType *CounterTy =
-        ArrayType::get(Type::getInt64Ty(*Ctx), Edges);
+        ArrayType::get(Type::getInt64Ty(*Ctx), Counts);
       GlobalVariable *Counters =
         new GlobalVariable(*M, CounterTy, false,
                            GlobalValue::InternalLinkage,
@@ -575,24 +604,47 @@ bool GCOVProfiler::emitProfileArcs() {
         int Successors = isa<ReturnInst>(TI) ? 1 : TI->getNumSuccessors();
         if (Successors) {
           if (Successors == 1) {
-            IRBuilder<> Builder(BB->getFirstInsertionPt());
-            Value *Counter = Builder.CreateConstInBoundsGEP2_64(Counters, 0,
-                                                                Edge);
-            Value *Count = Builder.CreateLoad(Counter);
-            Count = Builder.CreateAdd(Count, Builder.getInt64(1));
-            Builder.CreateStore(Count, Counter);
+            if (!OnTree[Edge]) {
+              IRBuilder<> Builder(BB->getFirstInsertionPt());
+              Value *Counter =
+                Builder.CreateConstInBoundsGEP2_64(Counters, 0,
+                                                   CounterIdx[Edge]);
+              Value *Count = Builder.CreateLoad(Counter);
+              Count = Builder.CreateAdd(Count, Builder.getInt64(1));
+              Builder.CreateStore(Count, Counter);
+            }
           } else if (BranchInst *BI = dyn_cast<BranchInst>(TI)) {
-            IRBuilder<> Builder(BI);
-            Value *Sel = Builder.CreateSelect(BI->getCondition(),
-                                              Builder.getInt64(Edge),
-                                              Builder.getInt64(Edge + 1));
-            SmallVector<Value *, 2> Idx;
-            Idx.push_back(Builder.getInt64(0));
-            Idx.push_back(Sel);
-            Value *Counter = Builder.CreateInBoundsGEP(Counters, Idx);
-            Value *Count = Builder.CreateLoad(Counter);
-            Count = Builder.CreateAdd(Count, Builder.getInt64(1));
-            Builder.CreateStore(Count, Counter);
+            if (OnTree[Edge] && OnTree[Edge + 1]) {
+              // Neither edge needs counting.
+            } else if (OnTree[Edge] || OnTree[Edge + 1]) {
+              // Only one edge has a counter, so add the condition, or its
+              // inverse, to it without a select.
+              IRBuilder<> Builder(BI);
+              bool CountTrue = !OnTree[Edge];
+              Value *Cond = BI->getCondition();
+              if (!CountTrue)
+                Cond = Builder.CreateNot(Cond);
+              Value *Counter =
+                Builder.CreateConstInBoundsGEP2_64(
+                    Counters, 0, CounterIdx[CountTrue ? Edge : Edge + 1]);
+              Value *Count = Builder.CreateLoad(Counter);
+              Value *Taken = Builder.CreateZExt(Cond, Builder.getInt64Ty());
+              Count = Builder.CreateAdd(Count, Taken);
+              Builder.CreateStore(Count, Counter);
+            } else {
+              IRBuilder<> Builder(BI);
+              Value *Sel =
+                Builder.CreateSelect(BI->getCondition(),
+                                     Builder.getInt64(CounterIdx[Edge]),
+                                     Builder.getInt64(CounterIdx[Edge + 1]));
+              SmallVector<Value *, 2> Idx;
+              Idx.push_back(Builder.getInt64(0));
+              Idx.push_back(Sel);
+              Value *Counter = Builder.CreateInBoundsGEP(Counters, Idx);
+              Value *Count = Builder.CreateLoad(Counter);
+              Count = Builder.CreateAdd(Count, Builder.getInt64(1));
+              Builder.CreateStore(Count, Counter);
+            }
           } else {
             ComplexEdgePreds.insert(BB);
             for (int i = 0; i != Successors; ++i)
@@ -605,7 +657,7 @@ bool GCOVProfiler::emitProfileArcs() {
       
       if (!ComplexEdgePreds.empty()) {
         GlobalVariable *EdgeTable =
-          buildEdgeLookupTable(F, Counters,
+          buildEdgeLookupTable(F, Counters, CounterIdx,
                                ComplexEdgePreds, ComplexEdgeSuccs);
         GlobalVariable *EdgeState = getEdgeStateValue();
         
@@ -669,11 +721,71 @@ bool GCOVProfiler::emitProfileArcs() {
   return Result;
 }
 
+// Return the number of gcov edges out of BB, where a return is an edge to the
+// function's exit block.
+static unsigned getNumEdges(BasicBlock *BB) {
+  TerminatorInst *TI = BB->getTerminator();
+  return isa<ReturnInst>(TI) ? 1 : TI->getNumSuccessors();
+}
+
+// The edges of a spanning tree of the CFG, with the entry and exit blocks
+// joined by the edge that every call of the function takes from the exit back
+// to the entry, need no counters: walking the tree from its leaves, each
+// block's in-flow equal to its out-flow gives the count of the tree edge that
+// reaches it. The tree is grown from the most deeply nested edges so that the
+// counters end up on the colder ones. Complex edges keep their counters, and
+// so do edges into blocks that end in unreachable or resume, whose flow isn't
+// conserved.
+const std::vector<bool> &GCOVProfiler::getTreeEdges(Function *F) {
+  DenseMap<Function *, std::vector<bool> >::iterator I = TreeEdges.find(F);
+  if (I != TreeEdges.end())
+    return I->second;
+
+  std::vector<bool> &OnTree = TreeEdges[F];
+  SmallVector<std::pair<BasicBlock *, BasicBlock *>, 32> Ends;
+  SmallVector<std::pair<int, unsigned>, 32> Candidates;
+  LoopInfo *LI = SpanningTree ? &getAnalysis<LoopInfo>(*F) : 0;
+  for (Function::iterator BB = F->begin(), E = F->end(); BB != E; ++BB) {
+    TerminatorInst *TI = BB->getTerminator();
+    unsigned Successors = getNumEdges(BB);
+    bool Simple = Successors == 1 || isa<BranchInst>(TI);
+    for (unsigned i = 0; i != Successors; ++i) {
+      BasicBlock *Succ = isa<ReturnInst>(TI) ? 0 : TI->getSuccessor(i);
+      if (LI && Simple && (!Succ || getNumEdges(Succ))) {
+        unsigned Depth = Succ ? std::min(LI->getLoopDepth(BB),
+                                         LI->getLoopDepth(Succ)) : 0;
+        Candidates.push_back(std::make_pair(-(int)Depth, OnTree.size()));
+      }
+      Ends.push_back(std::make_pair((BasicBlock *)BB, Succ));
+      OnTree.push_back(false);
+    }
+  }
+  if (!LI)
+    return OnTree;
+
+  // Kruskal's algorithm, with a null block standing for the exit block.
+  std::sort(Candidates.begin(), Candidates.end());
+  EquivalenceClasses<BasicBlock *> Forest;
+  Forest.unionSets(&F->getEntryBlock(), 0);
+  for (unsigned i = 0, e = Candidates.size(); i != e; ++i) {
+    unsigned Edge = Candidates[i].second;
+    BasicBlock *Src = Ends[Edge].first, *Dst = Ends[Edge].second;
+    if (Forest.findLeader(Forest.insert(Src)) ==
+        Forest.findLeader(Forest.insert(Dst)))
+      continue;
+    Forest.unionSets(Src, Dst);
+    OnTree[Edge] = true;
+    ++NumEdgesOnTree;
+  }
+  return OnTree;
+}
+
 // All edges with successors that aren't branches are "complex", because it
 // requires complex logic to pick which counter to update.
 GlobalVariable *GCOVProfiler::buildEdgeLookupTable(
     Function *F,
     GlobalVariable *Counters,
+    ArrayRef<unsigned> CounterIdx,
     const UniqueVector<BasicBlock *> &Preds,
     const UniqueVector<BasicBlock *> &Succs) {
   // TODO: support invoke, threads. We rely on the fact that nothing can modify
@@ -698,8 +810,8 @@ GlobalVariable *GCOVProfiler::buildEdgeLookupTable(
       for (int i = 0; i != Successors; ++i) {
         BasicBlock *Succ = TI->getSuccessor(i);
         IRBuilder<> Builder(Succ);
-        Value *Counter = Builder.CreateConstInBoundsGEP2_64(Counters, 0,
-                                                            Edge + i);
+        Value *Counter =
+          Builder.CreateConstInBoundsGEP2_64(Counters, 0, CounterIdx[Edge + i]);
         EdgeTable[((Succs.idFor(Succ)-1) * Preds.size()) +
                   (Preds.idFor(BB)-1)] = cast<Constant>(Counter);
       }
@@ -22,11 +22,14 @@
 #define DEBUG_TYPE "tsan"
 
 #include "llvm/Transforms/Instrumentation.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SmallSet.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/StringExtras.h"
+#include "llvm/Analysis/CaptureTracking.h"
+#include "llvm/Analysis/ValueTracking.h"
 #include "llvm/IR/DataLayout.h"
 #include "llvm/IR/Function.h"
 #include "llvm/IR/IRBuilder.h"
@@ -60,6 +63,10 @@ static cl::opt<bool>  ClInstrumentAtomics(
 static cl::opt<bool>  ClInstrumentMemIntrinsics(
     "tsan-instrument-memintrinsics", cl::init(true),
     cl::desc("Instrument memintrinsics (memset/memcpy/memmove)"), cl::Hidden);
+static cl::opt<bool>  ClSkipNonCaptured(
+    "tsan-skip-non-captured", cl::init(true),
+    cl::desc("Don't instrument accesses to allocas whose address does not "
+             "escape"), cl::Hidden);
 
 STATISTIC(NumInstrumentedReads, "Number of instrumented reads");
 STATISTIC(NumInstrumentedWrites, "Number of instrumented writes");
@@ -71,6 +78,7 @@ STATISTIC(NumInstrumentedVtableReads, "Number of vtable ptr reads");
 STATISTIC(NumOmittedReadsFromConstantGlobals,
           "Number of reads from constant globals");
 STATISTIC(NumOmittedReadsFromVtable, "Number of vtable reads");
+STATISTIC(NumOmittedNonCaptured, "Number of accesses ignored due to capturing");
 
 namespace {
 
@@ -94,6 +102,7 @@ struct ThreadSanitizer : public FunctionPass {
   void chooseInstructionsToInstrument(SmallVectorImpl<Instruction*> &Local,
                                       SmallVectorImpl<Instruction*> &All);
   bool addrPointsToConstantData(Value *Addr);
+  bool addrPointsToNonCapturedAlloca(Value *Addr);
   int getMemoryAccessFuncIndex(Value *Addr);
 
   DataLayout *TD;
@@ -117,6 +126,8 @@ struct ThreadSanitizer : public FunctionPass {
   Function *TsanVptrUpdate;
   Function *TsanVptrLoad;
   Function *MemmoveFn, *MemcpyFn, *MemsetFn;
+  // Whether each alloca accessed in the current function may be captured.
+  DenseMap<AllocaInst*, bool> AllocaMayBeCaptured;
 };
 }  // namespace
 
@@ -266,9 +277,24 @@ bool ThreadSanitizer::addrPointsToConstantData(Value *Addr) {
   return false;
 }
 
+// An alloca whose address is never captured can not be referenced from a
+// different thread, so accesses through it can not race.
+bool ThreadSanitizer::addrPointsToNonCapturedAlloca(Value *Addr) {
+  AllocaInst *AI = dyn_cast<AllocaInst>(GetUnderlyingObject(Addr, TD));
+  if (!AI)
+    return false;
+  DenseMap<AllocaInst*, bool>::iterator It = AllocaMayBeCaptured.find(AI);
+  if (It == AllocaMayBeCaptured.end())
+    It = AllocaMayBeCaptured.insert(std::make_pair(AI,
+        PointerMayBeCaptured(AI, /*ReturnCaptures=*/true,
+                             /*StoreCaptures=*/true))).first;
+  return !It->second;
+}
+
 // Instrumenting some of the accesses may be proven redundant.
 // Currently handled:
 //  - read-before-write (within same BB, no calls between)
+//  - accesses to allocas whose address does not escape
 //
 // We do not handle some of the patterns that should not survive
 // after the classic compiler optimizations.
@@ -285,11 +311,15 @@ void ThreadSanitizer::chooseInstructionsToInstrument(
   for (SmallVectorImpl<Instruction*>::reverse_iterator It = Local.rbegin(),
        E = Local.rend(); It != E; ++It) {
     Instruction *I = *It;
-    if (StoreInst *Store = dyn_cast<StoreInst>(I)) {
-      WriteTargets.insert(Store->getPointerOperand());
+    Value *Addr = isa<StoreInst>(I) ? cast<StoreInst>(I)->getPointerOperand()
+                                    : cast<LoadInst>(I)->getPointerOperand();
+    if (ClSkipNonCaptured && addrPointsToNonCapturedAlloca(Addr)) {
+      NumOmittedNonCaptured++;
+      continue;
+    }
+    if (isa<StoreInst>(I)) {
+      WriteTargets.insert(Addr);
     } else {
-      LoadInst *Load = cast<LoadInst>(I);
-      Value *Addr = Load->getPointerOperand();
       if (WriteTargets.count(Addr)) {
         // We will write to this temp, so no reason to analyze the read.
         NumOmittedReadsBeforeWrite++;
@@ -323,6 +353,7 @@ bool ThreadSanitizer::runOnFunction(Function &F) {
   if (!TD) return false;
   if (BL->isIn(F)) return false;
   initializeCallbacks(*F.getParent());
+  AllocaMayBeCaptured.clear();
   SmallVector<Instruction*, 8> RetVec;
   SmallVector<Instruction*, 8> AllLoadsAndStores;
   SmallVector<Instruction*, 8> LocalLoadsAndStores;
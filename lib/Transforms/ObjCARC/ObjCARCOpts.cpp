@@ -135,6 +135,27 @@ namespace {
       Map.clear();
       Vector.clear();
     }
+
+    /// Erase the elements for which Pred returns true, along with the blotted
+    /// ones, keeping the others in order.
+    template<class Predicate>
+    void remove_if(Predicate Pred) {
+      size_t Out = 0;
+      for (size_t In = 0, E = Vector.size(); In != E; ++In) {
+        if (!Vector[In].first)
+          continue;
+        if (Pred(Vector[In])) {
+          Map.erase(Vector[In].first);
+          continue;
+        }
+        if (In != Out) {
+          std::swap(Vector[Out], Vector[In]);
+          Map[Vector[Out].first] = Out;
+        }
+        ++Out;
+      }
+      Vector.erase(Vector.begin() + Out, Vector.end());
+    }
   };
 }
 
@@ -533,6 +554,22 @@ namespace {
     const RRInfo &GetRRInfo() const {
       return RRI;
     }
+
+    /// Return true if this is the state of a pointer with no sequence nor
+    /// anything else known about it, which is the same as not tracking the
+    /// pointer at all.
+    bool IsTrivial() const {
+      return GetSeq() == S_None && !KnownPositiveRefCount && !Partial &&
+             !RRI.KnownSafe && !RRI.IsTailCallRelease && !RRI.ReleaseMetadata &&
+             RRI.Calls.empty() && RRI.ReverseInsertPts.empty() &&
+             !RRI.CFGHazardAfflicted;
+    }
+  };
+
+  struct PtrStateIsTrivial {
+    bool operator()(const std::pair<const Value *, PtrState> &P) const {
+      return P.second.IsTrivial();
+    }
   };
 }
 
@@ -650,6 +687,19 @@ namespace {
       PerPtrTopDown.clear();
     }
 
+    /// Stop tracking the pointers whose bottom-up state is trivial.  Pointers
+    /// whose sequences ended stay in the maps otherwise, and every later
+    /// block copies, merges and visits their states, which on large
+    /// functions makes the traversals quadratic.
+    void pruneBottomUpPointers() {
+      PerPtrBottomUp.remove_if(PtrStateIsTrivial());
+    }
+
+    /// Stop tracking the pointers whose top-down state is trivial.
+    void pruneTopDownPointers() {
+      PerPtrTopDown.remove_if(PtrStateIsTrivial());
+    }
+
     void InitFromPred(const BBState &Other);
     void InitFromSucc(const BBState &Other);
     void MergePred(const BBState &Other);
@@ -1970,6 +2020,11 @@ ObjCARCOpt::VisitBottomUp(BasicBlock *BB,
   // top of the basic block.
   ANNOTATE_BOTTOMUP_BBSTART(MyStates, BB);
 
+  // The annotations list every pointer seen, trivial states included.
+#ifdef ARC_ANNOTATIONS
+  if (!EnableARCAnnotations)
+#endif
+  MyStates.pruneBottomUpPointers();
   return NestingDetected;
 }
 
@@ -2170,6 +2225,11 @@ ObjCARCOpt::VisitTopDown(BasicBlock *BB,
   if (!(EnableARCAnnotations && DisableCheckForCFGHazards))
 #endif
   CheckForCFGHazards(BB, BBStates, MyStates);
+
+#ifdef ARC_ANNOTATIONS
+  if (!EnableARCAnnotations)
+#endif
+  MyStates.pruneTopDownPointers();
   return NestingDetected;
 }
 
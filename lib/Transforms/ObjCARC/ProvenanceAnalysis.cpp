@@ -26,10 +26,18 @@
 #include "ProvenanceAnalysis.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/Support/CommandLine.h"
 
 using namespace llvm;
 using namespace llvm::objcarc;
 
+/// Queries on PHIs and selects recurse into their operands, which, on large
+/// generated functions, can chain through a great many PHIs.  Past this depth
+/// the values are conservatively assumed to be related.
+static cl::opt<unsigned>
+MaxQueryDepth("objc-arc-provenance-max-depth", cl::init(16), cl::Hidden,
+              cl::desc("Maximum nesting of ObjC ARC provenance queries"));
+
 bool ProvenanceAnalysis::relatedSelect(const SelectInst *A,
                                        const Value *B) {
   // If the values are Selects with the same condition, we can do a more precise
@@ -72,7 +80,7 @@ bool ProvenanceAnalysis::relatedPHI(const PHINode *A,
 
 /// Test if the value of P, or any value covered by its provenance, is ever
 /// stored within the function (not counting callees).
-static bool IsStoredObjCPointer(const Value *P) {
+static bool IsStoredObjCPointerImpl(const Value *P) {
   SmallPtrSet<const Value *, 8> Visited;
   SmallVector<const Value *, 8> Worklist;
   Worklist.push_back(P);
@@ -104,6 +112,16 @@ static bool IsStoredObjCPointer(const Value *P) {
   return false;
 }
 
+/// Cached version of IsStoredObjCPointerImpl, which walks all the transitive
+/// users of P.
+bool ProvenanceAnalysis::isStoredObjCPointer(const Value *P) {
+  std::pair<DenseMap<const Value *, bool>::iterator, bool> Pair =
+    StoredPointers.insert(std::make_pair(P, false));
+  if (Pair.second)
+    Pair.first->second = IsStoredObjCPointerImpl(P);
+  return Pair.first->second;
+}
+
 bool ProvenanceAnalysis::relatedCheck(const Value *A,
                                       const Value *B) {
   // Skip past provenance pass-throughs.
@@ -132,18 +150,18 @@ bool ProvenanceAnalysis::relatedCheck(const Value *A,
   if (AIsIdentified) {
     // Check for an obvious escape.
     if (isa<LoadInst>(B))
-      return IsStoredObjCPointer(A);
+      return isStoredObjCPointer(A);
     if (BIsIdentified) {
       // Check for an obvious escape.
       if (isa<LoadInst>(A))
-        return IsStoredObjCPointer(B);
+        return isStoredObjCPointer(B);
       // Both pointers are identified and escapes aren't an evident problem.
       return false;
     }
   } else if (BIsIdentified) {
     // Check for an obvious escape.
     if (isa<LoadInst>(A))
-      return IsStoredObjCPointer(B);
+      return isStoredObjCPointer(B);
   }
 
    // Special handling for PHI and Select.
@@ -171,7 +189,17 @@ bool ProvenanceAnalysis::related(const Value *A,
   if (!Pair.second)
     return Pair.first->second;
 
+  // Too deep in a chain of PHIs and selects: give up, and leave the answer
+  // out of the cache so that a query starting closer to these values can
+  // still do better.
+  if (Depth >= MaxQueryDepth) {
+    CachedResults.erase(Pair.first);
+    return true;
+  }
+
+  ++Depth;
   bool Result = relatedCheck(A, B);
+  --Depth;
   CachedResults[ValuePairTy(A, B)] = Result;
   return Result;
 }
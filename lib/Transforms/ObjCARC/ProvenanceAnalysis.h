@@ -53,6 +53,14 @@ class ProvenanceAnalysis {
   typedef DenseMap<ValuePairTy, bool> CachedResultsTy;
   CachedResultsTy CachedResults;
 
+  /// Whether each pointer asked about, or a value covered by its provenance,
+  /// is stored within the function.
+  DenseMap<const Value *, bool> StoredPointers;
+
+  /// The number of nested related queries being answered.
+  unsigned Depth;
+
+  bool isStoredObjCPointer(const Value *P);
   bool relatedCheck(const Value *A, const Value *B);
   bool relatedSelect(const SelectInst *A, const Value *B);
   bool relatedPHI(const PHINode *A, const Value *B);
@@ -61,7 +69,7 @@ class ProvenanceAnalysis {
   ProvenanceAnalysis(const ProvenanceAnalysis &) LLVM_DELETED_FUNCTION;
 
 public:
-  ProvenanceAnalysis() {}
+  ProvenanceAnalysis() : AA(0), Depth(0) {}
 
   void setAA(AliasAnalysis *aa) { AA = aa; }
 
@@ -71,6 +79,7 @@ public:
 
   void clear() {
     CachedResults.clear();
+    StoredPointers.clear();
   }
 };
 
@@ -16,9 +16,11 @@
 #define DEBUG_TYPE "codegenprepare"
 #include "llvm/Transforms/Scalar.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/SmallSet.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/ValueMap.h"
+#include "llvm/Analysis/BlockFrequencyInfo.h"
 #include "llvm/Analysis/DominatorInternals.h"
 #include "llvm/Analysis/Dominators.h"
 #include "llvm/Analysis/InstructionSimplify.h"
@@ -55,6 +57,10 @@ STATISTIC(NumCmpUses, "Number of uses of Cmp expressions replaced with uses of "
                       "sunken Cmps");
 STATISTIC(NumCastUses, "Number of uses of Cast expressions replaced with uses "
                        "of sunken Casts");
+STATISTIC(NumAddrsNotRematched, "Number of memory instructions whose address "
+                                "was not matched again");
+STATISTIC(NumAddrsNotSunkHot, "Number of addresses not sunk into hotter "
+                              "blocks");
 STATISTIC(NumMemoryInsts, "Number of memory instructions whose address "
                           "computations were sunk");
 STATISTIC(NumExtsMoved,  "Number of [s|z]ext instructions combined with loads");
@@ -71,7 +77,14 @@ static cl::opt<bool> DisableSelectToBranch(
   "disable-cgp-select2branch", cl::Hidden, cl::init(false),
   cl::desc("Disable select to branch conversion."));
 
+static cl::opt<unsigned> AddrSinkMaxFreqRatio(
+  "cgp-addr-sink-max-freq-ratio", cl::Hidden, cl::init(0),
+  cl::desc("Don't sink address computations into blocks more than this many "
+           "times as frequent as the blocks computing them (0 = no limit)"));
+
 namespace {
+  struct ExtAddrMode;
+
   class CodeGenPrepare : public FunctionPass {
     /// TLI - Keep a pointer of a TargetLowering to consult for determining
     /// transformation profitability.
@@ -90,6 +103,17 @@ namespace {
     /// multiple load/stores of the same address.
     ValueMap<Value*, Value*> SunkAddrs;
 
+    /// Addresses of the current block that were matched for an access type
+    /// and found not worth sinking.  Whether an address is worth sinking
+    /// depends on what is live in the block, so this is cleared whenever the
+    /// block changes.
+    DenseSet<std::pair<Value*, Type*> > UnsunkAddrs;
+
+    /// BlockFreqs - The frequency of each block when the addresses started
+    /// being sunk, if -cgp-addr-sink-max-freq-ratio is given.  Blocks created
+    /// afterwards have no entry.
+    DenseMap<const BasicBlock*, uint64_t> BlockFreqs;
+
     /// ModifiedDT - If CFG is modified in anyway, dominator tree may need to
     /// be updated.
     bool ModifiedDT;
@@ -110,6 +134,8 @@ namespace {
     virtual void getAnalysisUsage(AnalysisUsage &AU) const {
       AU.addPreserved<DominatorTree>();
       AU.addRequired<TargetLibraryInfo>();
+      if (AddrSinkMaxFreqRatio)
+        AU.addRequired<BlockFrequencyInfo>();
     }
 
   private:
@@ -120,6 +146,8 @@ namespace {
     bool OptimizeBlock(BasicBlock &BB);
     bool OptimizeInst(Instruction *I);
     bool OptimizeMemoryInst(Instruction *I, Value *Addr, Type *AccessTy);
+    bool FindAddrModeToSink(Instruction *MemoryInst, Value *Addr,
+                            Type *AccessTy, ExtAddrMode &AddrMode);
     bool OptimizeInlineAsmInst(CallInst *CS);
     bool OptimizeCallInst(CallInst *CI);
     bool MoveExtToFormExtLoad(Instruction *I);
@@ -134,6 +162,7 @@ char CodeGenPrepare::ID = 0;
 INITIALIZE_PASS_BEGIN(CodeGenPrepare, "codegenprepare",
                 "Optimize for code generation", false, false)
 INITIALIZE_PASS_DEPENDENCY(TargetLibraryInfo)
+INITIALIZE_PASS_DEPENDENCY(BlockFrequencyInfo)
 INITIALIZE_PASS_END(CodeGenPrepare, "codegenprepare",
                 "Optimize for code generation", false, false)
 
@@ -169,6 +198,13 @@ bool CodeGenPrepare::runOnFunction(Function &F) {
   // find a node corresponding to the value.
   EverMadeChange |= PlaceDbgValues(F);
 
+  BlockFreqs.clear();
+  if (AddrSinkMaxFreqRatio) {
+    BlockFrequencyInfo &BFI = getAnalysis<BlockFrequencyInfo>();
+    for (Function::iterator I = F.begin(), E = F.end(); I != E; ++I)
+      BlockFreqs[I] = BFI.getBlockFreq(I).getFrequency();
+  }
+
   bool MadeChange = true;
   while (MadeChange) {
     MadeChange = false;
@@ -180,6 +216,8 @@ bool CodeGenPrepare::runOnFunction(Function &F) {
   }
 
   SunkAddrs.clear();
+  UnsunkAddrs.clear();
+  BlockFreqs.clear();
 
   if (!DisableBranchOpts) {
     MadeChange = false;
@@ -804,8 +842,10 @@ bool CodeGenPrepare::DupRetToEnableTailCallOpts(BasicBlock *BB) {
   }
 
   // If we eliminated all predecessors of the block, delete the block now.
-  if (Changed && !BB->hasAddressTaken() && pred_begin(BB) == pred_end(BB))
+  if (Changed && !BB->hasAddressTaken() && pred_begin(BB) == pred_end(BB)) {
+    BlockFreqs.erase(BB);
     BB->eraseFromParent();
+  }
 
   return Changed;
 }
@@ -1445,19 +1485,11 @@ static bool IsNonLocalValue(Value *V, BasicBlock *BB) {
   return false;
 }
 
-/// OptimizeMemoryInst - Load and Store Instructions often have
-/// addressing modes that can do significant amounts of computation.  As such,
-/// instruction selection will try to get the load or store to do as much
-/// computation as possible for the program.  The problem is that isel can only
-/// see within a single block.  As such, we sink as much legal addressing mode
-/// stuff into the block as possible.
-///
-/// This method is used to optimize both load/store and inline asms with memory
-/// operands.
-bool CodeGenPrepare::OptimizeMemoryInst(Instruction *MemoryInst, Value *Addr,
-                                        Type *AccessTy) {
-  Value *Repl = Addr;
-
+/// FindAddrModeToSink - Match the addressing mode of Addr for MemoryInst into
+/// AddrMode.  Return true if it folds computations of other blocks that are
+/// worth sinking into the block of MemoryInst.
+bool CodeGenPrepare::FindAddrModeToSink(Instruction *MemoryInst, Value *Addr,
+                                        Type *AccessTy, ExtAddrMode &AddrMode) {
   // Try to collapse single-value PHI nodes.  This is necessary to undo
   // unprofitable PRE transformations.
   SmallVector<Value*, 8> worklist;
@@ -1471,7 +1503,6 @@ bool CodeGenPrepare::OptimizeMemoryInst(Instruction *MemoryInst, Value *Addr,
   unsigned NumUsesConsensus = 0;
   bool IsNumUsesConsensusValid = false;
   SmallVector<Instruction*, 16> AddrModeInsts;
-  ExtAddrMode AddrMode;
   while (!worklist.empty()) {
     Value *V = worklist.back();
     worklist.pop_back();
@@ -1548,6 +1579,50 @@ bool CodeGenPrepare::OptimizeMemoryInst(Instruction *MemoryInst, Value *Addr,
     return false;
   }
 
+  // Don't sink the address into a block much hotter than the ones computing
+  // it now: what the addressing mode can't fold would be computed more often.
+  if (!BlockFreqs.empty()) {
+    uint64_t UserFreq = BlockFreqs.lookup(MemoryInst->getParent());
+    for (unsigned i = 0, e = AddrModeInsts.size(); i != e; ++i) {
+      uint64_t DefFreq = BlockFreqs.lookup(AddrModeInsts[i]->getParent());
+      if (DefFreq && UserFreq / AddrSinkMaxFreqRatio > DefFreq) {
+        DEBUG(dbgs() << "CGP: Not sinking addrmode into a hotter block: "
+                     << AddrMode << "\n");
+        ++NumAddrsNotSunkHot;
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+/// OptimizeMemoryInst - Load and Store Instructions often have
+/// addressing modes that can do significant amounts of computation.  As such,
+/// instruction selection will try to get the load or store to do as much
+/// computation as possible for the program.  The problem is that isel can only
+/// see within a single block.  As such, we sink as much legal addressing mode
+/// stuff into the block as possible.
+///
+/// This method is used to optimize both load/store and inline asms with memory
+/// operands.
+bool CodeGenPrepare::OptimizeMemoryInst(Instruction *MemoryInst, Value *Addr,
+                                        Type *AccessTy) {
+  Value *Repl = Addr;
+
+  // Many memory instructions of a block often use the same address.  Don't
+  // match it again if it was already sunk into this block, or found not worth
+  // sinking since the block last changed.
+  ExtAddrMode AddrMode;
+  if (SunkAddrs.lookup(Addr)) {
+    ++NumAddrsNotRematched;
+  } else if (UnsunkAddrs.count(std::make_pair(Addr, AccessTy))) {
+    ++NumAddrsNotRematched;
+    return false;
+  } else if (!FindAddrModeToSink(MemoryInst, Addr, AccessTy, AddrMode)) {
+    UnsunkAddrs.insert(std::make_pair(Addr, AccessTy));
+    return false;
+  }
+
   // Insert this computation right after this user.  Since our caller is
   // scanning from the top of the BB to the bottom, reuse of the expr are
   // guaranteed to happen later.
@@ -1559,8 +1634,7 @@ bool CodeGenPrepare::OptimizeMemoryInst(Instruction *MemoryInst, Value *Addr,
   // computation.
   Value *&SunkAddr = SunkAddrs[Addr];
   if (SunkAddr) {
-    DEBUG(dbgs() << "CGP: Reusing nonlocal addrmode: " << AddrMode << " for "
-                 << *MemoryInst);
+    DEBUG(dbgs() << "CGP: Reusing nonlocal address for " << *MemoryInst);
     if (SunkAddr->getType() != Addr->getType())
       SunkAddr = Builder.CreateBitCast(SunkAddr, Addr->getType());
   } else {
@@ -1631,6 +1705,10 @@ bool CodeGenPrepare::OptimizeMemoryInst(Instruction *MemoryInst, Value *Addr,
 
   MemoryInst->replaceUsesOfWith(Repl, SunkAddr);
 
+  // This changes what is live in the block, and so which addresses are worth
+  // sinking, even before the caller sees that something changed.
+  UnsunkAddrs.clear();
+
   // If we have no uses, recursively delete the value and all dead instructions
   // using it.
   if (Repl->use_empty()) {
@@ -1960,11 +2038,15 @@ bool CodeGenPrepare::OptimizeInst(Instruction *I) {
 // selection.
 bool CodeGenPrepare::OptimizeBlock(BasicBlock &BB) {
   SunkAddrs.clear();
+  UnsunkAddrs.clear();
   bool MadeChange = false;
 
   CurInstIterator = BB.begin();
   while (CurInstIterator != BB.end())
-    MadeChange |= OptimizeInst(CurInstIterator++);
+    if (OptimizeInst(CurInstIterator++)) {
+      MadeChange = true;
+      UnsunkAddrs.clear();
+    }
 
   MadeChange |= DupRetToEnableTailCallOpts(&BB);
 
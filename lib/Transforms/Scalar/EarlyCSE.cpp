@@ -17,11 +17,13 @@
 #include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/ScopedHashTable.h"
 #include "llvm/ADT/Statistic.h"
+#include "llvm/Analysis/AliasAnalysis.h"
 #include "llvm/Analysis/Dominators.h"
 #include "llvm/Analysis/InstructionSimplify.h"
 #include "llvm/IR/DataLayout.h"
 #include "llvm/IR/Instructions.h"
 #include "llvm/Pass.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/RecyclingAllocator.h"
 #include "llvm/Target/TargetLibraryInfo.h"
@@ -34,6 +36,13 @@ STATISTIC(NumCSE,      "Number of instructions CSE'd");
 STATISTIC(NumCSELoad,  "Number of load instructions CSE'd");
 STATISTIC(NumCSECall,  "Number of call instructions CSE'd");
 STATISTIC(NumDSE,      "Number of trivial dead stores removed");
+STATISTIC(NumCSELoadAA, "Number of load instructions CSE'd across "
+                        "non-aliasing writes");
+
+static cl::opt<unsigned>
+MaxAliasQueries("earlycse-max-alias-queries", cl::init(4), cl::Hidden,
+  cl::desc("Max number of intervening writes EarlyCSE checks with alias "
+           "analysis before giving up on an available load (0 disables)"));
 
 static unsigned getHash(const void *V) {
   return DenseMapInfo<const void*>::getHashValue(V);
@@ -265,6 +274,7 @@ public:
   const DataLayout *TD;
   const TargetLibraryInfo *TLI;
   DominatorTree *DT;
+  AliasAnalysis *AA;
   typedef RecyclingAllocator<BumpPtrAllocator,
                       ScopedHashTableVal<SimpleValue, Value*> > AllocatorTy;
   typedef ScopedHashTable<SimpleValue, Value*, DenseMapInfo<SimpleValue>,
@@ -298,6 +308,13 @@ public:
   /// CurrentGeneration - This is the current generation of the memory value.
   unsigned CurrentGeneration;
 
+  /// GenerationClobbers - For each generation G on the current dominator tree
+  /// path, the write that started generation G+1, or null if that is not
+  /// known (for example at a join point).  A later sibling subtree reuses the
+  /// generation numbers of an earlier one, but it overwrites each entry
+  /// before it can be looked at.
+  SmallVector<Instruction*, 32> GenerationClobbers;
+
   static char ID;
   explicit EarlyCSE() : FunctionPass(ID) {
     initializeEarlyCSEPass(*PassRegistry::getPassRegistry());
@@ -375,10 +392,21 @@ private:
 
   bool processNode(DomTreeNode *Node);
 
+  /// bumpGeneration - Start a new memory generation because of Clobber, or
+  /// because of something unknown if Clobber is null.
+  void bumpGeneration(Instruction *Clobber) {
+    if (GenerationClobbers.size() <= CurrentGeneration)
+      GenerationClobbers.resize(CurrentGeneration + 1);
+    GenerationClobbers[CurrentGeneration++] = Clobber;
+  }
+
+  bool isLoadAvailableSince(LoadInst *LI, unsigned Generation);
+
   // This transformation requires dominator postdominator info
   virtual void getAnalysisUsage(AnalysisUsage &AU) const {
     AU.addRequired<DominatorTree>();
     AU.addRequired<TargetLibraryInfo>();
+    AU.addRequired<AliasAnalysis>();
     AU.setPreservesCFG();
   }
 };
@@ -394,8 +422,26 @@ FunctionPass *llvm::createEarlyCSEPass() {
 INITIALIZE_PASS_BEGIN(EarlyCSE, "early-cse", "Early CSE", false, false)
 INITIALIZE_PASS_DEPENDENCY(DominatorTree)
 INITIALIZE_PASS_DEPENDENCY(TargetLibraryInfo)
+INITIALIZE_AG_DEPENDENCY(AliasAnalysis)
 INITIALIZE_PASS_END(EarlyCSE, "early-cse", "Early CSE", false, false)
 
+/// isLoadAvailableSince - A load of LI's address was available in generation
+/// Generation.  Return true if alias analysis shows that none of the writes
+/// since then may modify the location LI reads.  Only a few writes are
+/// checked, to keep this pass cheap.
+bool EarlyCSE::isLoadAvailableSince(LoadInst *LI, unsigned Generation) {
+  if (CurrentGeneration - Generation > MaxAliasQueries)
+    return false;
+
+  AliasAnalysis::Location Loc = AA->getLocation(LI);
+  for (unsigned G = Generation; G != CurrentGeneration; ++G) {
+    Instruction *Clobber = GenerationClobbers[G];
+    if (!Clobber || (AA->getModRefInfo(Clobber, Loc) & AliasAnalysis::Mod))
+      return false;
+  }
+  return true;
+}
+
 bool EarlyCSE::processNode(DomTreeNode *Node) {
   BasicBlock *BB = Node->getBlock();
 
@@ -406,7 +452,7 @@ bool EarlyCSE::processNode(DomTreeNode *Node) {
   // just be conservative and invalidate memory if this block has multiple
   // predecessors.
   if (BB->getSinglePredecessor() == 0)
-    ++CurrentGeneration;
+    bumpGeneration(0);
 
   /// LastStore - Keep track of the last non-volatile store that we saw... for
   /// as long as there in no instruction that reads memory.  If we see a store
@@ -470,9 +516,13 @@ bool EarlyCSE::processNode(DomTreeNode *Node) {
       // generation, replace this instruction.
       std::pair<Value*, unsigned> InVal =
         AvailableLoads->lookup(Inst->getOperand(0));
-      if (InVal.first != 0 && InVal.second == CurrentGeneration) {
+      if (InVal.first != 0 &&
+          (InVal.second == CurrentGeneration ||
+           isLoadAvailableSince(LI, InVal.second))) {
         DEBUG(dbgs() << "EarlyCSE CSE LOAD: " << *Inst << "  to: "
               << *InVal.first << '\n');
+        if (InVal.second != CurrentGeneration)
+          ++NumCSELoadAA;
         if (!Inst->use_empty()) Inst->replaceAllUsesWith(InVal.first);
         Inst->eraseFromParent();
         Changed = true;
@@ -516,15 +566,25 @@ bool EarlyCSE::processNode(DomTreeNode *Node) {
     // something that could modify memory.  If so, our available memory values
     // cannot be used so bump the generation count.
     if (Inst->mayWriteToMemory()) {
-      ++CurrentGeneration;
+      // Remember simple stores and calls so that alias analysis can tell
+      // which loads they leave intact.
+      StoreInst *SI = dyn_cast<StoreInst>(Inst);
+      bumpGeneration((SI && SI->isSimple()) || isa<CallInst>(Inst) ? Inst : 0);
 
-      if (StoreInst *SI = dyn_cast<StoreInst>(Inst)) {
+      if (SI) {
         // We do a trivial form of DSE if there are two stores to the same
         // location with no intervening loads.  Delete the earlier store.
         if (LastStore &&
             LastStore->getPointerOperand() == SI->getPointerOperand()) {
           DEBUG(dbgs() << "EarlyCSE DEAD STORE: " << *LastStore << "  due to: "
                        << *Inst << '\n');
+          // SI writes the same location, so it can stand in for LastStore
+          // as the write that started its generation.
+          for (unsigned G = CurrentGeneration; G-- != 0;)
+            if (GenerationClobbers[G] == LastStore) {
+              GenerationClobbers[G] = SI;
+              break;
+            }
           LastStore->eraseFromParent();
           Changed = true;
           ++NumDSE;
@@ -557,6 +617,7 @@ bool EarlyCSE::runOnFunction(Function &F) {
   TD = getAnalysisIfAvailable<DataLayout>();
   TLI = &getAnalysis<TargetLibraryInfo>();
   DT = &getAnalysis<DominatorTree>();
+  AA = &getAnalysis<AliasAnalysis>();
 
   // Tables that the pass uses when walking the domtree.
   ScopedHTType AVTable;
@@ -613,6 +674,7 @@ bool EarlyCSE::runOnFunction(Function &F) {
 
   // Reset the current generation.
   CurrentGeneration = LiveOutGeneration;
+  GenerationClobbers.clear();
 
   return Changed;
 }
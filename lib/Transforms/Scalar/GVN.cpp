@@ -24,6 +24,8 @@
 #include "llvm/ADT/SetVector.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/Analysis/AliasAnalysis.h"
+#include "llvm/Analysis/BlockFrequencyInfo.h"
+#include "llvm/Analysis/BranchProbabilityInfo.h"
 #include "llvm/Analysis/CFG.h"
 #include "llvm/Analysis/ConstantFolding.h"
 #include "llvm/Analysis/Dominators.h"
@@ -58,11 +60,23 @@ STATISTIC(NumGVNBlocks, "Number of blocks merged");
 STATISTIC(NumGVNSimpl,  "Number of instructions simplified");
 STATISTIC(NumGVNEqProp, "Number of equalities propagated");
 STATISTIC(NumPRELoad,   "Number of loads PRE'd");
+STATISTIC(NumPRELoadMultiPred, "Number of loads PRE'd into several preds");
 
 static cl::opt<bool> EnablePRE("enable-pre",
                                cl::init(true), cl::Hidden);
 static cl::opt<bool> EnableLoadPRE("enable-load-pre", cl::init(true));
 
+static cl::opt<bool>
+EnableMultiPredLoadPRE("enable-load-pre-multi-pred", cl::init(false),
+  cl::Hidden,
+  cl::desc("Allow load PRE to insert loads in several predecessors if they "
+           "run less often than the load"));
+
+static cl::opt<unsigned>
+MaxLoadPREPreds("max-load-pre-preds", cl::init(4), cl::Hidden,
+  cl::desc("The maximum number of predecessors load PRE may insert loads "
+           "into (default = 4)"));
+
 // Maximum allowed recursion depth.
 static cl::opt<uint32_t>
 MaxRecurseDepth("max-recurse-depth", cl::Hidden, cl::init(1000), cl::ZeroOrMore,
@@ -589,6 +603,8 @@ namespace {
     DominatorTree *DT;
     const DataLayout *TD;
     const TargetLibraryInfo *TLI;
+    BlockFrequencyInfo *BFI;
+    BranchProbabilityInfo *BPI;
     SetVector<BasicBlock *> DeadBlocks;
 
     ValueTable VN;
@@ -605,6 +621,10 @@ namespace {
 
     SmallVector<Instruction*, 8> InstrsToErase;
 
+    /// SimplifyCache - The instructions that failed to simplify, so that
+    /// later iterations over the function do not analyze them again.
+    SimplifyInstructionCache SimplifyCache;
+
     typedef SmallVector<NonLocalDepResult, 64> LoadDepVect;
     typedef SmallVector<AvailableValueInBlock, 64> AvailValInBlkVect;
     typedef SmallVector<BasicBlock*, 64> UnavailBlkVect;
@@ -683,6 +703,10 @@ namespace {
       if (!NoLoads)
         AU.addRequired<MemoryDependenceAnalysis>();
       AU.addRequired<AliasAnalysis>();
+      if (EnableMultiPredLoadPRE) {
+        AU.addRequired<BlockFrequencyInfo>();
+        AU.addRequired<BranchProbabilityInfo>();
+      }
 
       AU.addPreserved<DominatorTree>();
       AU.addPreserved<AliasAnalysis>();
@@ -697,6 +721,8 @@ namespace {
                                  UnavailBlkVect &UnavailableBlocks);
     bool PerformLoadPRE(LoadInst *LI, AvailValInBlkVect &ValuesPerBlock, 
                         UnavailBlkVect &UnavailableBlocks);
+    bool isMultiPredLoadPREProfitable(BasicBlock *LoadBB,
+                                const DenseMap<BasicBlock*, Value*> &PredLoads);
 
     // Other helper routines
     bool processInstruction(Instruction *I);
@@ -729,6 +755,8 @@ INITIALIZE_PASS_BEGIN(GVN, "gvn", "Global Value Numbering", false, false)
 INITIALIZE_PASS_DEPENDENCY(MemoryDependenceAnalysis)
 INITIALIZE_PASS_DEPENDENCY(DominatorTree)
 INITIALIZE_PASS_DEPENDENCY(TargetLibraryInfo)
+INITIALIZE_PASS_DEPENDENCY(BlockFrequencyInfo)
+INITIALIZE_PASS_DEPENDENCY(BranchProbabilityInfo)
 INITIALIZE_AG_DEPENDENCY(AliasAnalysis)
 INITIALIZE_PASS_END(GVN, "gvn", "Global Value Numbering", false, false)
 
@@ -1501,6 +1529,34 @@ void GVN::AnalyzeLoadAvailability(LoadInst *LI, LoadDepVect &Deps,
   }
 }
 
+/// isMultiPredLoadPREProfitable - Return true if loading the value at the end
+/// of each of the predecessors in PredLoads, which are all the predecessors of
+/// LoadBB the value is unavailable in, is cheaper than the load in LoadBB.
+/// That is the case when the edges from those predecessors are together taken
+/// less than half as often as LoadBB is entered.
+bool GVN::isMultiPredLoadPREProfitable(BasicBlock *LoadBB,
+                              const DenseMap<BasicBlock*, Value*> &PredLoads) {
+  if (!EnableMultiPredLoadPRE || PredLoads.size() > MaxLoadPREPreds)
+    return false;
+
+  // Inserting several loads grows the code.
+  if (LoadBB->getParent()->getAttributes().
+        hasAttribute(AttributeSet::FunctionIndex, Attribute::OptimizeForSize))
+    return false;
+
+  BlockFrequency InsertedFreq;
+  for (DenseMap<BasicBlock*, Value*>::const_iterator I = PredLoads.begin(),
+         E = PredLoads.end(); I != E; ++I)
+    InsertedFreq += BFI->getBlockFreq(I->first) *
+                    BPI->getEdgeProbability(I->first, LoadBB);
+
+  BlockFrequency LoadFreq = BFI->getBlockFreq(LoadBB);
+  DEBUG(dbgs() << "GVN: load PRE into " << PredLoads.size()
+               << " preds would run " << InsertedFreq.getFrequency()
+               << " times instead of " << LoadFreq.getFrequency() << '\n');
+  return InsertedFreq + InsertedFreq < LoadFreq;
+}
+
 bool GVN::PerformLoadPRE(LoadInst *LI, AvailValInBlkVect &ValuesPerBlock, 
                          UnavailBlkVect &UnavailableBlocks) {
   // Okay, we have *some* definitions of the value.  This means that the value
@@ -1580,11 +1636,14 @@ bool GVN::PerformLoadPRE(LoadInst *LI, AvailValInBlkVect &ValuesPerBlock,
   assert(NumUnavailablePreds != 0 &&
          "Fully available value should already be eliminated!");
 
-  // If this load is unavailable in multiple predecessors, reject it.
+  // If this load is unavailable in multiple predecessors, reject it unless
+  // those predecessors are cold enough that reloading the value in each of
+  // them still executes fewer loads.
   // FIXME: If we could restructure the CFG, we could make a common pred with
   // all the preds that don't have an available LI and insert a new load into
   // that one block.
-  if (NumUnavailablePreds != 1)
+  if (NumUnavailablePreds != 1 &&
+      !isMultiPredLoadPREProfitable(LoadBB, PredLoads))
       return false;
 
   // Split critical edges, and update the unavailable predecessors accordingly.
@@ -1688,6 +1747,8 @@ bool GVN::PerformLoadPRE(LoadInst *LI, AvailValInBlkVect &ValuesPerBlock,
     MD->invalidateCachedPointerInfo(V);
   markInstructionForDeletion(LI);
   ++NumPRELoad;
+  if (NumUnavailablePreds != 1)
+    ++NumPRELoadMultiPred;
   return true;
 }
 
@@ -2202,7 +2263,7 @@ bool GVN::processInstruction(Instruction *I) {
   // to value numbering it.  Value numbering often exposes redundancies, for
   // example if it determines that %y is equal to %x then the instruction
   // "%z = and i32 %x, %y" becomes "%z = and i32 %x, %x" which we now simplify.
-  if (Value *V = SimplifyInstruction(I, TD, TLI, DT)) {
+  if (Value *V = SimplifyInstruction(I, TD, TLI, DT, &SimplifyCache)) {
     I->replaceAllUsesWith(V);
     if (MD && V->getType()->getScalarType()->isPointerTy())
       MD->invalidateCachedPointerInfo(V);
@@ -2319,6 +2380,8 @@ bool GVN::runOnFunction(Function& F) {
   DT = &getAnalysis<DominatorTree>();
   TD = getAnalysisIfAvailable<DataLayout>();
   TLI = &getAnalysis<TargetLibraryInfo>();
+  BFI = EnableMultiPredLoadPRE ? &getAnalysis<BlockFrequencyInfo>() : 0;
+  BPI = EnableMultiPredLoadPRE ? &getAnalysis<BranchProbabilityInfo>() : 0;
   VN.setAliasAnalysis(&getAnalysis<AliasAnalysis>());
   VN.setMemDep(MD);
   VN.setDomTree(DT);
@@ -2365,6 +2428,7 @@ bool GVN::runOnFunction(Function& F) {
   // Do not cleanup DeadBlocks in cleanupGlobalSets() as it's called for each
   // iteration. 
   DeadBlocks.clear();
+  SimplifyCache.clear();
 
   return Changed;
 }
@@ -19,8 +19,11 @@
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallSet.h"
 #include "llvm/ADT/Statistic.h"
+#include "llvm/ADT/ValueMap.h"
+#include "llvm/Analysis/BlockFrequencyInfo.h"
 #include "llvm/Analysis/CFG.h"
 #include "llvm/Analysis/ConstantFolding.h"
+#include "llvm/Analysis/Dominators.h"
 #include "llvm/Analysis/InstructionSimplify.h"
 #include "llvm/Analysis/LazyValueInfo.h"
 #include "llvm/Analysis/Loads.h"
@@ -41,12 +44,31 @@ using namespace llvm;
 STATISTIC(NumThreads, "Number of jumps threaded");
 STATISTIC(NumFolds,   "Number of terminators folded");
 STATISTIC(NumDupes,   "Number of branch blocks duplicated to eliminate phi");
+STATISTIC(NumHeaderThreads, "Number of jumps threaded across loop headers");
 
 static cl::opt<unsigned>
 Threshold("jump-threading-threshold",
           cl::desc("Max block size to duplicate for jump threading"),
           cl::init(6), cl::Hidden);
 
+static cl::opt<bool>
+ThreadAcrossLoopHeaders("jump-threading-across-loop-headers",
+          cl::desc("Allow threading across loop headers when the loop stays "
+                   "reducible"),
+          cl::init(false), cl::Hidden);
+
+static cl::opt<unsigned>
+HeaderDupBudget("jump-threading-header-budget",
+          cl::desc("Max number of instructions per function duplicated by "
+                   "threading across loop headers"),
+          cl::init(40), cl::Hidden);
+
+static cl::opt<unsigned>
+HeaderMinFreqPercent("jump-threading-header-min-freq",
+          cl::desc("Min percentage of a loop header's frequency that the "
+                   "threaded predecessors must carry"),
+          cl::init(20), cl::Hidden);
+
 namespace {
   // These are at global scope so static functions can use them too.
   typedef SmallVectorImpl<std::pair<Constant*, BasicBlock*> > PredValueInfo;
@@ -86,6 +108,17 @@ namespace {
 #endif
     DenseSet<std::pair<Value*, BasicBlock*> > RecursionSet;
 
+    /// HeaderBudget - Instructions that may still be duplicated by threading
+    /// across loop headers in the current function.
+    unsigned HeaderBudget;
+    /// BlockFreqs - Frequencies of the blocks of the function as they were
+    /// before jump threading changed it.  Blocks created since are absent.
+    ValueMap<const BasicBlock*, uint64_t> BlockFreqs;
+    /// DT - The dominator tree of the function, computed by getDomTree the
+    /// first time it is needed after the CFG last changed.
+    DominatorTreeBase<BasicBlock> DT;
+    bool DTValid;
+
     // RAII helper for updating the recursion stack.
     struct RecursionSetRemover {
       DenseSet<std::pair<Value*, BasicBlock*> > &TheSet;
@@ -101,7 +134,8 @@ namespace {
     };
   public:
     static char ID; // Pass identification
-    JumpThreading() : FunctionPass(ID) {
+    JumpThreading() : FunctionPass(ID), DT(/*isPostDom=*/false),
+                      DTValid(false) {
       initializeJumpThreadingPass(*PassRegistry::getPassRegistry());
     }
 
@@ -111,9 +145,18 @@ namespace {
       AU.addRequired<LazyValueInfo>();
       AU.addPreserved<LazyValueInfo>();
       AU.addRequired<TargetLibraryInfo>();
+      if (ThreadAcrossLoopHeaders)
+        AU.addRequired<BlockFrequencyInfo>();
     }
 
     void FindLoopHeaders(Function &F);
+    DominatorTreeBase<BasicBlock> &getDomTree(Function &F);
+    bool CanThreadAcrossLoopHeader(BasicBlock *BB,
+                                   const SmallVectorImpl<BasicBlock*> &PredBBs,
+                                   BasicBlock *SuccBB, unsigned Cost,
+                                   bool &FormsNestedLoop);
+    void DropLoopEntryEdges(BasicBlock *BB,
+               SmallVectorImpl<std::pair<BasicBlock*, BasicBlock*> > &PredToDest);
     bool ProcessBlock(BasicBlock *BB);
     bool ThreadEdge(BasicBlock *BB, const SmallVectorImpl<BasicBlock*> &PredBBs,
                     BasicBlock *SuccBB);
@@ -139,6 +182,7 @@ INITIALIZE_PASS_BEGIN(JumpThreading, "jump-threading",
                 "Jump Threading", false, false)
 INITIALIZE_PASS_DEPENDENCY(LazyValueInfo)
 INITIALIZE_PASS_DEPENDENCY(TargetLibraryInfo)
+INITIALIZE_PASS_DEPENDENCY(BlockFrequencyInfo)
 INITIALIZE_PASS_END(JumpThreading, "jump-threading",
                 "Jump Threading", false, false)
 
@@ -155,14 +199,24 @@ bool JumpThreading::runOnFunction(Function &F) {
 
   FindLoopHeaders(F);
 
+  HeaderBudget = 0;
+  if (ThreadAcrossLoopHeaders && !LoopHeaders.empty()) {
+    HeaderBudget = HeaderDupBudget;
+    BlockFrequencyInfo &BFI = getAnalysis<BlockFrequencyInfo>();
+    for (Function::iterator I = F.begin(), E = F.end(); I != E; ++I)
+      BlockFreqs[I] = BFI.getBlockFreq(I).getFrequency();
+  }
+
   bool Changed, EverChanged = false;
   do {
     Changed = false;
     for (Function::iterator I = F.begin(), E = F.end(); I != E;) {
       BasicBlock *BB = I;
       // Thread all of the branches we can over this block.
-      while (ProcessBlock(BB))
+      while (ProcessBlock(BB)) {
+        DTValid = false;
         Changed = true;
+      }
 
       ++I;
 
@@ -175,6 +229,7 @@ bool JumpThreading::runOnFunction(Function &F) {
         LoopHeaders.erase(BB);
         LVI->eraseBlock(BB);
         DeleteDeadBlock(BB);
+        DTValid = false;
         Changed = true;
         continue;
       }
@@ -200,6 +255,7 @@ bool JumpThreading::runOnFunction(Function &F) {
         // dangling pointer issues within LazyValueInfo.
         LVI->eraseBlock(BB);
         if (TryToSimplifyUncondBranchFromEmptyBlock(BB)) {
+          DTValid = false;
           Changed = true;
           // If we deleted BB and BB was the header of a loop, then the
           // successor is now the header of the loop.
@@ -214,6 +270,9 @@ bool JumpThreading::runOnFunction(Function &F) {
   } while (Changed);
 
   LoopHeaders.clear();
+  BlockFreqs.clear();
+  DT.releaseMemory();
+  DTValid = false;
   return EverChanged;
 }
 
@@ -297,6 +356,82 @@ void JumpThreading::FindLoopHeaders(Function &F) {
     LoopHeaders.insert(const_cast<BasicBlock*>(Edges[i].second));
 }
 
+/// getDomTree - Return the dominator tree of F, recomputing it if the CFG has
+/// changed since it was last needed.  The tree is only used to check loop
+/// header threading, so it is computed lazily rather than kept up to date.
+DominatorTreeBase<BasicBlock> &JumpThreading::getDomTree(Function &F) {
+  if (!DTValid) {
+    DT.recalculate(F);
+    DTValid = true;
+  }
+  return DT;
+}
+
+/// CanThreadAcrossLoopHeader - Decide whether threading PredBBs through the
+/// loop header BB to SuccBB is allowed in -jump-threading-across-loop-headers
+/// mode.  This keeps the loop structure reducible in two cases:
+///
+///  - SuccBB cannot reach BB, so it is outside the loop and the threaded edge
+///    simply leaves (or skips) the loop.
+///  - SuccBB dominates every block in PredBBs, so the new edge into SuccBB is
+///    a backedge and SuccBB becomes the header of a nested loop.  In this case
+///    FormsNestedLoop is set.
+///
+/// Entering the body of the loop anywhere else would create a second loop
+/// entry.  The predecessors must also carry a large enough share of BB's
+/// frequency, and Cost must fit in the remaining per-function budget.
+bool JumpThreading::CanThreadAcrossLoopHeader(BasicBlock *BB,
+                                  const SmallVectorImpl<BasicBlock*> &PredBBs,
+                                  BasicBlock *SuccBB, unsigned Cost,
+                                  bool &FormsNestedLoop) {
+  FormsNestedLoop = false;
+  if (Cost > HeaderBudget)
+    return false;
+
+  ValueMap<const BasicBlock*, uint64_t>::iterator HI = BlockFreqs.find(BB);
+  if (HI == BlockFreqs.end() || !HI->second)
+    return false;
+  uint64_t PredFreq = 0;
+  for (unsigned i = 0, e = PredBBs.size(); i != e; ++i) {
+    ValueMap<const BasicBlock*, uint64_t>::iterator PI =
+      BlockFreqs.find(PredBBs[i]);
+    if (PI != BlockFreqs.end())
+      PredFreq += PI->second;
+  }
+  if (PredFreq * 100 < HI->second * HeaderMinFreqPercent) {
+    DEBUG(dbgs() << "  Not threading across loop header BB '" << BB->getName()
+          << "' - predecessors are too cold\n");
+    return false;
+  }
+
+  if (!isPotentiallyReachable(SuccBB, BB))
+    return true;
+
+  DominatorTreeBase<BasicBlock> &DT = getDomTree(*BB->getParent());
+  for (unsigned i = 0, e = PredBBs.size(); i != e; ++i)
+    if (!DT.dominates(SuccBB, PredBBs[i]))
+      return false;
+  FormsNestedLoop = true;
+  return true;
+}
+
+/// DropLoopEntryEdges - Remove from PredToDest the predecessors of the loop
+/// header BB whose threaded edge would enter the loop below its header, and
+/// which CanThreadAcrossLoopHeader would reject.  Otherwise such a predecessor
+/// can make its destination the most popular one and keep the remaining
+/// predecessors from being threaded.
+void JumpThreading::DropLoopEntryEdges(BasicBlock *BB,
+             SmallVectorImpl<std::pair<BasicBlock*, BasicBlock*> > &PredToDest) {
+  DominatorTreeBase<BasicBlock> &DT = getDomTree(*BB->getParent());
+  for (unsigned i = 0; i != PredToDest.size(); ) {
+    BasicBlock *Pred = PredToDest[i].first, *Dest = PredToDest[i].second;
+    if (Dest && isPotentiallyReachable(Dest, BB) && !DT.dominates(Dest, Pred))
+      PredToDest.erase(PredToDest.begin() + i);
+    else
+      ++i;
+  }
+}
+
 /// getKnownConstant - Helper method to determine if we can thread over a
 /// terminator with the given value as its condition, and if so what value to
 /// use for that. What kind of value this is depends on whether we want an
@@ -1074,8 +1209,8 @@ FindMostPopularDest(BasicBlock *BB,
 bool JumpThreading::ProcessThreadableEdges(Value *Cond, BasicBlock *BB,
                                            ConstantPreference Preference) {
   // If threading this would thread across a loop header, don't even try to
-  // thread the edge.
-  if (LoopHeaders.count(BB))
+  // thread the edge, unless ThreadEdge may still allow it.
+  if (LoopHeaders.count(BB) && !HeaderBudget)
     return false;
 
   PredValueInfoTy PredValues;
@@ -1136,6 +1271,17 @@ bool JumpThreading::ProcessThreadableEdges(Value *Cond, BasicBlock *BB,
     PredToDestList.push_back(std::make_pair(Pred, DestBB));
   }
 
+  // Across a loop header, only the edges that leave the loop or form a
+  // nested loop can be threaded.
+  if (LoopHeaders.count(BB)) {
+    DropLoopEntryEdges(BB, PredToDestList);
+    for (unsigned i = 0, e = PredToDestList.size(); i != e; ++i)
+      if (i == 0)
+        OnlyDest = PredToDestList[i].second;
+      else if (OnlyDest != PredToDestList[i].second)
+        OnlyDest = MultipleDestSentinel;
+  }
+
   // If all edges were unthreadable, we fail.
   if (PredToDestList.empty())
     return false;
@@ -1348,20 +1494,30 @@ bool JumpThreading::ThreadEdge(BasicBlock *BB,
     return false;
   }
 
+  unsigned JumpThreadCost = getJumpThreadDuplicationCost(BB, Threshold);
+  if (JumpThreadCost > Threshold) {
+    DEBUG(dbgs() << "  Not threading BB '" << BB->getName()
+          << "' - Cost is too high: " << JumpThreadCost << "\n");
+    return false;
+  }
+
   // If threading this would thread across a loop header, don't thread the edge.
   // See the comments above FindLoopHeaders for justifications and caveats.
-  if (LoopHeaders.count(BB)) {
+  bool AcrossHeader = LoopHeaders.count(BB), FormsNestedLoop = false;
+  if (AcrossHeader &&
+      !CanThreadAcrossLoopHeader(BB, PredBBs, SuccBB, JumpThreadCost,
+                                 FormsNestedLoop)) {
     DEBUG(dbgs() << "  Not threading across loop header BB '" << BB->getName()
           << "' to dest BB '" << SuccBB->getName()
           << "' - it might create an irreducible loop!\n");
     return false;
   }
-
-  unsigned JumpThreadCost = getJumpThreadDuplicationCost(BB, Threshold);
-  if (JumpThreadCost > Threshold) {
-    DEBUG(dbgs() << "  Not threading BB '" << BB->getName()
-          << "' - Cost is too high: " << JumpThreadCost << "\n");
-    return false;
+  if (AcrossHeader) {
+    HeaderBudget -= JumpThreadCost;
+    ++NumHeaderThreads;
+    // The threaded edge is a new backedge into SuccBB.
+    if (FormsNestedLoop)
+      LoopHeaders.insert(SuccBB);
   }
 
   // And finally, do it!  Start by factoring the predecessors is needed.
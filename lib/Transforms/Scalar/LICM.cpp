@@ -35,6 +35,7 @@
 #include "llvm/ADT/Statistic.h"
 #include "llvm/Analysis/AliasAnalysis.h"
 #include "llvm/Analysis/AliasSetTracker.h"
+#include "llvm/Analysis/CaptureTracking.h"
 #include "llvm/Analysis/ConstantFolding.h"
 #include "llvm/Analysis/Dominators.h"
 #include "llvm/Analysis/LoopInfo.h"
@@ -62,6 +63,8 @@ STATISTIC(NumHoisted   , "Number of instructions hoisted out of loop");
 STATISTIC(NumMovedLoads, "Number of load insts hoisted or sunk");
 STATISTIC(NumMovedCalls, "Number of call insts hoisted or sunk");
 STATISTIC(NumPromoted  , "Number of memory locations promoted to registers");
+STATISTIC(NumPromotedSpeculatively,
+          "Number of conditionally stored locations promoted to registers");
 
 static cl::opt<bool>
 DisablePromotion("disable-licm-promotion", cl::Hidden,
@@ -184,6 +187,7 @@ namespace {
     void PromoteAliasSet(AliasSet &AS,
                          SmallVectorImpl<BasicBlock*> &ExitBlocks,
                          SmallVectorImpl<Instruction*> &InsertPts);
+    bool isThreadLocalDereferenceable(Value *Ptr);
   };
 }
 
@@ -714,6 +718,16 @@ namespace {
   };
 } // end anon namespace
 
+/// isThreadLocalDereferenceable - Return true if Ptr is always dereferenceable
+/// and points into an alloca whose address is never captured.
+bool LICM::isThreadLocalDereferenceable(Value *Ptr) {
+  if (!Ptr->isDereferenceablePointer())
+    return false;
+  AllocaInst *AI = dyn_cast<AllocaInst>(GetUnderlyingObject(Ptr, TD));
+  return AI && !PointerMayBeCaptured(AI, /*ReturnCaptures=*/true,
+                                     /*StoreCaptures=*/true);
+}
+
 /// PromoteAliasSet - Try to promote memory values to scalars by sinking
 /// stores out of the loop and moving loads to before the loop.  We do this by
 /// looping over the stores in the loop, looking for stores to Must pointers
@@ -825,9 +839,15 @@ void LICM::PromoteAliasSet(AliasSet &AS,
     }
   }
 
-  // If there isn't a guaranteed-to-execute instruction, we can't promote.
-  if (!GuaranteedToExecute)
-    return;
+  // If there isn't a guaranteed-to-execute instruction, we can still promote
+  // a location that no other thread can see and that can be accessed on every
+  // path: the inserted loads and stores cannot trap and no one can observe
+  // the stores introduced on paths that did not store before.
+  if (!GuaranteedToExecute) {
+    if (!isThreadLocalDereferenceable(SomePtr))
+      return;
+    ++NumPromotedSpeculatively;
+  }
 
   // Otherwise, this is safe to promote, lets do it!
   DEBUG(dbgs() << "LICM: Promoting value stored to in loop: " <<*SomePtr<<'\n');
@@ -43,6 +43,7 @@
 
 #define DEBUG_TYPE "loop-idiom"
 #include "llvm/Transforms/Scalar.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/Analysis/AliasAnalysis.h"
 #include "llvm/Analysis/Dominators.h"
@@ -63,6 +64,8 @@ using namespace llvm;
 
 STATISTIC(NumMemSet, "Number of memset's formed from loop stores");
 STATISTIC(NumMemCpy, "Number of memcpy's formed from loop load+stores");
+STATISTIC(NumMultiStoreMemSet,
+          "Number of memset's formed from several stores per iteration");
 
 namespace {
 
@@ -149,11 +152,14 @@ namespace {
                         SmallVectorImpl<BasicBlock*> &ExitBlocks);
 
     bool processLoopStore(StoreInst *SI, const SCEV *BECount);
+    bool processLoopStoreGroup(StoreInst *SI, const SCEVAddRecExpr *StoreEv,
+                               const SCEV *BECount);
     bool processLoopMemSet(MemSetInst *MSI, const SCEV *BECount);
 
     bool processLoopStridedStore(Value *DestPtr, unsigned StoreSize,
                                  unsigned StoreAlignment,
                                  Value *SplatValue, Instruction *TheStore,
+                                 SmallPtrSet<Instruction*, 8> &TheStores,
                                  const SCEVAddRecExpr *Ev,
                                  const SCEV *BECount);
     bool processLoopStoreOfLoopLoad(StoreInst *SI, unsigned StoreSize,
@@ -804,12 +810,18 @@ bool LoopIdiomRecognize::processLoopStore(StoreInst *SI, const SCEV *BECount) {
       dbgs() << "BB: " << *SI->getParent();
     }
 
+    // The stride may still be covered by this store together with its
+    // neighbours, as in "for (i) { A[i].x = 0; A[i].y = 0; }".
+    if (Stride && Stride->getValue()->getValue().ugt(StoreSize))
+      return processLoopStoreGroup(SI, StoreEv, BECount);
     return false;
   }
 
   // See if we can optimize just this store in isolation.
+  SmallPtrSet<Instruction*, 8> TheStores;
+  TheStores.insert(SI);
   if (processLoopStridedStore(StorePtr, StoreSize, SI->getAlignment(),
-                              StoredVal, SI, StoreEv, BECount))
+                              StoredVal, SI, TheStores, StoreEv, BECount))
     return true;
 
   // If the stored value is a strided load in the same loop with the same stride
@@ -828,6 +840,75 @@ bool LoopIdiomRecognize::processLoopStore(StoreInst *SI, const SCEV *BECount) {
   return false;
 }
 
+/// processLoopStoreGroup - SI stores a splattable value with a stride larger
+/// than its size.  Look for other stores of the same value in its block with
+/// the same stride, and see if together they write every byte of each stride.
+/// If so, the whole group can become a single memset.
+bool LoopIdiomRecognize::processLoopStoreGroup(StoreInst *SI,
+                                               const SCEVAddRecExpr *StoreEv,
+                                               const SCEV *BECount) {
+  Value *SplatValue = isBytewiseValue(SI->getValueOperand());
+  if (!SplatValue || !CurLoop->isLoopInvariant(SplatValue) ||
+      !TLI->has(LibFunc::memset))
+    return false;
+
+  const SCEV *Stride = StoreEv->getOperand(1);
+  uint64_t StrideBytes = cast<SCEVConstant>(Stride)->getValue()->getZExtValue();
+  if ((StrideBytes >> 32) != 0)
+    return false;
+
+  // Collect the stores of the group as (offset from SI, size) in bytes.
+  typedef std::pair<int64_t, uint64_t> ByteRange;
+  SmallVector<std::pair<ByteRange, StoreInst*>, 8> Group;
+  SmallPtrSet<Instruction*, 8> TheStores;
+  BasicBlock *BB = SI->getParent();
+  for (BasicBlock::iterator I = BB->begin(), E = BB->end(); I != E; ++I) {
+    StoreInst *Other = dyn_cast<StoreInst>(I);
+    if (!Other || !Other->isSimple() ||
+        isBytewiseValue(Other->getValueOperand()) != SplatValue)
+      continue;
+    const SCEVAddRecExpr *OtherEv =
+      dyn_cast<SCEVAddRecExpr>(SE->getSCEV(Other->getPointerOperand()));
+    if (!OtherEv || OtherEv->getLoop() != CurLoop || !OtherEv->isAffine() ||
+        OtherEv->getOperand(1) != Stride ||
+        Other->getPointerAddressSpace() != SI->getPointerAddressSpace())
+      continue;
+    const SCEVConstant *Diff = dyn_cast<SCEVConstant>(
+      SE->getMinusSCEV(OtherEv->getStart(), StoreEv->getStart()));
+    if (!Diff)
+      continue;
+    uint64_t Size = TD->getTypeStoreSize(Other->getValueOperand()->getType());
+    Group.push_back(std::make_pair(
+      ByteRange(Diff->getValue()->getSExtValue(), Size), Other));
+    TheStores.insert(Other);
+  }
+
+  // The group must write every byte of one stride, starting at the lowest
+  // offset.  Overlapping stores are fine since they store the same byte.
+  std::sort(Group.begin(), Group.end());
+  int64_t Begin = Group[0].first.first, End = Begin;
+  for (unsigned i = 0, e = Group.size(); i != e; ++i) {
+    if (Group[i].first.first > End)
+      return false;
+    End = std::max(End, Group[i].first.first + int64_t(Group[i].first.second));
+  }
+  if (End - Begin != int64_t(StrideBytes))
+    return false;
+
+  StoreInst *First = Group[0].second;
+  const SCEVAddRecExpr *FirstEv =
+    cast<SCEVAddRecExpr>(SE->getSCEV(First->getPointerOperand()));
+  unsigned Alignment = First->getAlignment();
+  if (!Alignment)
+    Alignment = TD->getABITypeAlignment(First->getValueOperand()->getType());
+  if (!processLoopStridedStore(First->getPointerOperand(),
+                               unsigned(StrideBytes), Alignment, SplatValue,
+                               First, TheStores, FirstEv, BECount))
+    return false;
+  ++NumMultiStoreMemSet;
+  return true;
+}
+
 /// processLoopMemSet - See if this memset can be promoted to a large memset.
 bool LoopIdiomRecognize::
 processLoopMemSet(MemSetInst *MSI, const SCEV *BECount) {
@@ -861,19 +942,22 @@ processLoopMemSet(MemSetInst *MSI, const SCEV *BECount) {
   if (Stride == 0 || MSI->getLength() != Stride->getValue())
     return false;
 
+  SmallPtrSet<Instruction*, 8> TheStores;
+  TheStores.insert(MSI);
   return processLoopStridedStore(Pointer, (unsigned)SizeInBytes,
                                  MSI->getAlignment(), MSI->getValue(),
-                                 MSI, Ev, BECount);
+                                 MSI, TheStores, Ev, BECount);
 }
 
 
 /// mayLoopAccessLocation - Return true if the specified loop might access the
 /// specified pointer location, which is a loop-strided access.  The 'Access'
 /// argument specifies what the verboten forms of access are (read or write).
+/// The instructions in IgnoredStores are the ones being replaced.
 static bool mayLoopAccessLocation(Value *Ptr,AliasAnalysis::ModRefResult Access,
                                   Loop *L, const SCEV *BECount,
                                   unsigned StoreSize, AliasAnalysis &AA,
-                                  Instruction *IgnoredStore) {
+                                  SmallPtrSet<Instruction*, 8> &IgnoredStores) {
   // Get the location that may be stored across the loop.  Since the access is
   // strided positively through memory, we say that the modified location starts
   // at the pointer and has infinite size.
@@ -893,7 +977,7 @@ static bool mayLoopAccessLocation(Value *Ptr,AliasAnalysis::ModRefResult Access,
   for (Loop::block_iterator BI = L->block_begin(), E = L->block_end(); BI != E;
        ++BI)
     for (BasicBlock::iterator I = (*BI)->begin(), E = (*BI)->end(); I != E; ++I)
-      if (&*I != IgnoredStore &&
+      if (!IgnoredStores.count(I) &&
           (AA.getModRefInfo(I, StoreLoc) & Access))
         return true;
 
@@ -944,8 +1028,9 @@ static Constant *getMemSetPatternValue(Value *V, const DataLayout &TD) {
 bool LoopIdiomRecognize::
 processLoopStridedStore(Value *DestPtr, unsigned StoreSize,
                         unsigned StoreAlignment, Value *StoredVal,
-                        Instruction *TheStore, const SCEVAddRecExpr *Ev,
-                        const SCEV *BECount) {
+                        Instruction *TheStore,
+                        SmallPtrSet<Instruction*, 8> &TheStores,
+                        const SCEVAddRecExpr *Ev, const SCEV *BECount) {
 
   // If the stored value is a byte-wise value (like i32 -1), then it may be
   // turned into a memset of i8 -1, assuming that all the consecutive bytes
@@ -964,7 +1049,7 @@ processLoopStridedStore(Value *DestPtr, unsigned StoreSize,
       CurLoop->isLoopInvariant(SplatValue)) {
     // Keep and use SplatValue.
     PatternValue = 0;
-  } else if (DestAS == 0 &&
+  } else if (DestAS == 0 && TheStores.size() == 1 &&
              TLI->has(LibFunc::memset_pattern16) &&
              (PatternValue = getMemSetPatternValue(StoredVal, *TD))) {
     // Don't create memset_pattern16s with address spaces.
@@ -996,7 +1081,8 @@ processLoopStridedStore(Value *DestPtr, unsigned StoreSize,
 
   if (mayLoopAccessLocation(BasePtr, AliasAnalysis::ModRef,
                             CurLoop, BECount,
-                            StoreSize, getAnalysis<AliasAnalysis>(), TheStore)) {
+                            StoreSize, getAnalysis<AliasAnalysis>(),
+                            TheStores)) {
     Expander.clear();
     // If we generated new code for the base pointer, clean up.
     deleteIfDeadInstruction(BasePtr, *SE, TLI);
@@ -1053,9 +1139,11 @@ processLoopStridedStore(Value *DestPtr, unsigned StoreSize,
                << "    from store to: " << *Ev << " at: " << *TheStore << "\n");
   NewCall->setDebugLoc(TheStore->getDebugLoc());
 
-  // Okay, the memset has been formed.  Zap the original store and anything that
-  // feeds into it.
-  deleteDeadInstruction(TheStore, *SE, TLI);
+  // Okay, the memset has been formed.  Zap the original stores and anything
+  // that feeds into them.
+  for (SmallPtrSet<Instruction*, 8>::iterator I = TheStores.begin(),
+       E = TheStores.end(); I != E; ++I)
+    deleteDeadInstruction(*I, *SE, TLI);
   ++NumMemSet;
   return true;
 }
@@ -1091,9 +1179,11 @@ processLoopStoreOfLoopLoad(StoreInst *SI, unsigned StoreSize,
                            Builder.getInt8PtrTy(SI->getPointerAddressSpace()),
                            Preheader->getTerminator());
 
+  SmallPtrSet<Instruction*, 8> TheStores;
+  TheStores.insert(SI);
   if (mayLoopAccessLocation(StoreBasePtr, AliasAnalysis::ModRef,
                             CurLoop, BECount, StoreSize,
-                            getAnalysis<AliasAnalysis>(), SI)) {
+                            getAnalysis<AliasAnalysis>(), TheStores)) {
     Expander.clear();
     // If we generated new code for the base pointer, clean up.
     deleteIfDeadInstruction(StoreBasePtr, *SE, TLI);
@@ -1108,7 +1198,8 @@ processLoopStoreOfLoopLoad(StoreInst *SI, unsigned StoreSize,
                            Preheader->getTerminator());
 
   if (mayLoopAccessLocation(LoadBasePtr, AliasAnalysis::Mod, CurLoop, BECount,
-                            StoreSize, getAnalysis<AliasAnalysis>(), SI)) {
+                            StoreSize, getAnalysis<AliasAnalysis>(),
+                            TheStores)) {
     Expander.clear();
     // If we generated new code for the base pointer, clean up.
     deleteIfDeadInstruction(LoadBasePtr, *SE, TLI);
@@ -0,0 +1,419 @@
+//===- LoopInterchange.cpp - Interchange the loops of a loop nest ---------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This pass interchanges the two loops of a perfect loop nest when that makes
+// the memory accesses of the inner loop consecutive.  For example:
+//
+//   for (i = 0; i < 100; ++i)        for (j = 0; j < 200; ++j)
+//     for (j = 0; j < 200; ++j)  =>    for (i = 0; i < 100; ++i)
+//       A[j][i] += k;                    A[j][i] += k;
+//
+// The nest is only interchanged if no dependence reported by
+// DependenceAnalysis has a direction vector whose sign would change, i.e. no
+// dependence runs forward in one loop and backward in the other.
+//
+// The transformation does not touch the CFG.  Both loops must be in rotated
+// form with a single induction variable whose start, step and bound are
+// invariant in the whole nest, so the two loops can be interchanged by
+// swapping their induction recipes and then swapping the uses of the two
+// induction variables in the loop body.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "loop-interchange"
+#include "llvm/Transforms/Scalar.h"
+#include "llvm/ADT/OwningPtr.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Analysis/DependenceAnalysis.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/LoopPass.h"
+#include "llvm/Analysis/ScalarEvolution.h"
+#include "llvm/Analysis/ScalarEvolutionExpressions.h"
+#include "llvm/Analysis/ValueTracking.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/DataLayout.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/Pass.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+using namespace llvm;
+
+STATISTIC(NumInterchanged, "Number of loop nests interchanged");
+
+namespace {
+  /// InductionInfo - The instructions that step and test the induction
+  /// variable of one loop of the nest.
+  struct InductionInfo {
+    PHINode *Phi;
+    BinaryOperator *Next;
+    ICmpInst *Cmp;
+    BranchInst *Br;
+    BasicBlock *Preheader;
+
+    InductionInfo() : Phi(0), Next(0), Cmp(0), Br(0), Preheader(0) {}
+
+    bool isControl(const Instruction *I) const {
+      return I == Phi || I == Next || I == Cmp || I == Br;
+    }
+  };
+
+  class LoopInterchange : public LoopPass {
+  public:
+    static char ID; // Pass identification, replacement for typeid
+    LoopInterchange() : LoopPass(ID), LI(0), SE(0), DA(0), DL(0) {
+      initializeLoopInterchangePass(*PassRegistry::getPassRegistry());
+    }
+
+    bool runOnLoop(Loop *L, LPPassManager &LPM);
+
+    virtual void getAnalysisUsage(AnalysisUsage &AU) const {
+      AU.addRequiredID(LoopSimplifyID);
+      AU.addRequired<LoopInfo>();
+      AU.addRequired<ScalarEvolution>();
+      AU.addRequired<DependenceAnalysis>();
+
+      AU.addPreserved<LoopInfo>();
+      AU.addPreserved<ScalarEvolution>();
+      AU.addPreservedID(LoopSimplifyID);
+    }
+
+  private:
+    LoopInfo *LI;
+    ScalarEvolution *SE;
+    DependenceAnalysis *DA;
+    const DataLayout *DL;
+
+    bool processNest(Loop *Outer, Loop *Inner);
+    bool analyzeInduction(Loop *L, Loop *Outer, InductionInfo &IV);
+    bool collectSinkable(Loop *Outer, Loop *Inner, const InductionInfo &OuterIV,
+                         SmallVectorImpl<Instruction *> &Sinkable);
+    bool isLegal(Loop *Outer, SmallVectorImpl<Instruction *> &MemInsts);
+    bool isProfitable(Loop *Outer, Loop *Inner,
+                      SmallVectorImpl<Instruction *> &MemInsts);
+    void interchange(Loop *Inner, InductionInfo &OuterIV,
+                     InductionInfo &InnerIV,
+                     SmallVectorImpl<Instruction *> &Sinkable);
+  };
+}
+
+char LoopInterchange::ID = 0;
+INITIALIZE_PASS_BEGIN(LoopInterchange, "loop-interchange",
+                      "Interchange loops", false, false)
+INITIALIZE_PASS_DEPENDENCY(LoopInfo)
+INITIALIZE_PASS_DEPENDENCY(ScalarEvolution)
+INITIALIZE_PASS_DEPENDENCY(DependenceAnalysis)
+INITIALIZE_PASS_DEPENDENCY(LoopSimplify)
+INITIALIZE_PASS_END(LoopInterchange, "loop-interchange",
+                    "Interchange loops", false, false)
+
+Pass *llvm::createLoopInterchangePass() {
+  return new LoopInterchange();
+}
+
+/// runOnLoop - Interchange L with its sub-loop if it has exactly one, which is
+/// itself innermost.
+bool LoopInterchange::runOnLoop(Loop *L, LPPassManager &LPM) {
+  const std::vector<Loop *> &SubLoops = L->getSubLoops();
+  if (SubLoops.size() != 1 || !SubLoops[0]->empty())
+    return false;
+
+  LI = &getAnalysis<LoopInfo>();
+  SE = &getAnalysis<ScalarEvolution>();
+  DA = &getAnalysis<DependenceAnalysis>();
+  DL = getAnalysisIfAvailable<DataLayout>();
+  if (!DL)
+    return false;
+  return processNest(L, SubLoops[0]);
+}
+
+/// analyzeInduction - Match the induction variable of the rotated loop L:
+/// a single header phi stepped by a constant in the latch, which is also the
+/// only exiting block.  The start and bound must be invariant in Outer.
+bool LoopInterchange::analyzeInduction(Loop *L, Loop *Outer,
+                                       InductionInfo &IV) {
+  BasicBlock *Header = L->getHeader();
+  BasicBlock *Latch = L->getLoopLatch();
+  IV.Preheader = L->getLoopPreheader();
+  if (!Latch || !IV.Preheader || L->getExitingBlock() != Latch ||
+      !L->getExitBlock())
+    return false;
+
+  IV.Phi = dyn_cast<PHINode>(Header->begin());
+  if (!IV.Phi || isa<PHINode>(IV.Phi->getNextNode()) ||
+      !IV.Phi->getType()->isIntegerTy())
+    return false;
+
+  IV.Br = dyn_cast<BranchInst>(Latch->getTerminator());
+  if (!IV.Br || !IV.Br->isConditional())
+    return false;
+  IV.Cmp = dyn_cast<ICmpInst>(IV.Br->getCondition());
+  IV.Next = dyn_cast<BinaryOperator>(IV.Phi->getIncomingValueForBlock(Latch));
+  if (!IV.Cmp || !IV.Cmp->hasOneUse() || !IV.Next ||
+      IV.Next->getOpcode() != Instruction::Add ||
+      IV.Next->getOperand(0) != IV.Phi ||
+      !isa<ConstantInt>(IV.Next->getOperand(1)))
+    return false;
+
+  Value *Tested = IV.Cmp->getOperand(0);
+  if ((Tested != IV.Phi && Tested != IV.Next) ||
+      !Outer->isLoopInvariant(IV.Cmp->getOperand(1)) ||
+      !Outer->isLoopInvariant(IV.Phi->getIncomingValueForBlock(IV.Preheader)))
+    return false;
+
+  // The final value of the induction variable changes, so it must not be
+  // used after the loop.  The body keeps using the phi, but the increment
+  // is only available in the latch once the loops are swapped.
+  for (Value::use_iterator UI = IV.Phi->use_begin(), UE = IV.Phi->use_end();
+       UI != UE; ++UI)
+    if (!L->contains(cast<Instruction>(*UI)))
+      return false;
+  for (Value::use_iterator UI = IV.Next->use_begin(), UE = IV.Next->use_end();
+       UI != UE; ++UI)
+    if (*UI != IV.Phi && *UI != IV.Cmp)
+      return false;
+  return true;
+}
+
+/// collectSinkable - Check that the outer loop does nothing but step its
+/// induction variable and run the inner loop.  Speculatable instructions in
+/// the outer header or inner preheader that only feed the inner loop, such as
+/// row addresses hoisted by LICM, are collected in Sinkable so that they can
+/// be moved into the inner loop.
+bool LoopInterchange::collectSinkable(Loop *Outer, Loop *Inner,
+                                      const InductionInfo &OuterIV,
+                                      SmallVectorImpl<Instruction *> &Sinkable) {
+  BasicBlock *OuterHeader = Outer->getHeader();
+  BasicBlock *InnerPreheader = Inner->getLoopPreheader();
+  SmallPtrSet<Instruction *, 8> SinkSet;
+
+  for (Loop::block_iterator BI = Outer->block_begin(), BE = Outer->block_end();
+       BI != BE; ++BI) {
+    BasicBlock *BB = *BI;
+    if (Inner->contains(BB))
+      continue;
+    for (BasicBlock::iterator I = BB->begin(), E = BB->end(); I != E; ++I) {
+      if (OuterIV.isControl(I))
+        continue;
+      if (BranchInst *Br = dyn_cast<BranchInst>(I)) {
+        if (Br->isUnconditional())
+          continue;
+        return false;
+      }
+      if ((BB != OuterHeader && BB != InnerPreheader) || isa<PHINode>(I) ||
+          I->mayReadOrWriteMemory() || !isSafeToSpeculativelyExecute(I, DL))
+        return false;
+      Sinkable.push_back(I);
+      SinkSet.insert(I);
+    }
+  }
+
+  // The header is the first block of a loop, so Sinkable is in dominance
+  // order: the outer header, then the inner preheader.
+  for (unsigned i = 0, e = Sinkable.size(); i != e; ++i)
+    for (Value::use_iterator UI = Sinkable[i]->use_begin(),
+         UE = Sinkable[i]->use_end(); UI != UE; ++UI) {
+      Instruction *User = cast<Instruction>(*UI);
+      if (!Inner->contains(User) && !SinkSet.count(User))
+        return false;
+    }
+  return true;
+}
+
+/// isLegal - Return true if interchanging the loop Outer with its sub-loop
+/// preserves every dependence between the memory instructions of the nest.
+bool LoopInterchange::isLegal(Loop *Outer,
+                              SmallVectorImpl<Instruction *> &MemInsts) {
+  unsigned OuterLevel = Outer->getLoopDepth();
+  unsigned InnerLevel = OuterLevel + 1;
+
+  for (unsigned i = 0, e = MemInsts.size(); i != e; ++i)
+    for (unsigned j = i; j != e; ++j) {
+      Instruction *Src = MemInsts[i], *Dst = MemInsts[j];
+      if (isa<LoadInst>(Src) && isa<LoadInst>(Dst))
+        continue;
+
+      OwningPtr<Dependence> D(DA->depends(Src, Dst, true));
+      if (!D)
+        continue;
+      if (D->isConfused() || D->getLevels() < InnerLevel) {
+        DEBUG(dbgs() << "LoopInterchange: unknown dependence between "
+                     << *Src << " and " << *Dst << '\n');
+        return false;
+      }
+
+      // Swapping the two directions changes the sign of the vector only if
+      // one loop carries the dependence forward and the other backward.
+      unsigned OuterDir = D->getDirection(OuterLevel);
+      unsigned InnerDir = D->getDirection(InnerLevel);
+      if (((OuterDir & Dependence::DVEntry::LT) &&
+           (InnerDir & Dependence::DVEntry::GT)) ||
+          ((OuterDir & Dependence::DVEntry::GT) &&
+           (InnerDir & Dependence::DVEntry::LT))) {
+        DEBUG(dbgs() << "LoopInterchange: dependence between " << *Src
+                     << " and " << *Dst << " prevents interchange\n");
+        return false;
+      }
+    }
+  return true;
+}
+
+/// isConsecutiveIn - Return true if the address S advances by at most Size
+/// bytes per iteration of L.  Addresses invariant in L count as consecutive.
+static bool isConsecutiveIn(ScalarEvolution *SE, const SCEV *S, const Loop *L,
+                            uint64_t Size) {
+  while (const SCEVAddRecExpr *AR = dyn_cast<SCEVAddRecExpr>(S)) {
+    if (AR->getLoop() == L) {
+      const SCEVConstant *Step =
+        dyn_cast<SCEVConstant>(AR->getStepRecurrence(*SE));
+      return Step && Step->getValue()->getValue().abs().ule(Size);
+    }
+    S = AR->getStart();
+  }
+  return SE->isLoopInvariant(S, L);
+}
+
+/// isProfitable - Return true if more memory accesses of the nest are
+/// consecutive in the outer loop than in the inner loop.
+bool LoopInterchange::isProfitable(Loop *Outer, Loop *Inner,
+                                   SmallVectorImpl<Instruction *> &MemInsts) {
+  unsigned InnerConsecutive = 0, OuterConsecutive = 0;
+  for (unsigned i = 0, e = MemInsts.size(); i != e; ++i) {
+    Value *Ptr;
+    Type *AccessTy;
+    if (LoadInst *LD = dyn_cast<LoadInst>(MemInsts[i])) {
+      Ptr = LD->getPointerOperand();
+      AccessTy = LD->getType();
+    } else {
+      StoreInst *ST = cast<StoreInst>(MemInsts[i]);
+      Ptr = ST->getPointerOperand();
+      AccessTy = ST->getValueOperand()->getType();
+    }
+
+    const SCEV *S = SE->getSCEV(Ptr);
+    uint64_t Size = DL->getTypeStoreSize(AccessTy);
+    if (isConsecutiveIn(SE, S, Inner, Size))
+      ++InnerConsecutive;
+    if (isConsecutiveIn(SE, S, Outer, Size))
+      ++OuterConsecutive;
+  }
+
+  DEBUG(dbgs() << "LoopInterchange: " << InnerConsecutive
+               << " accesses consecutive in the inner loop, "
+               << OuterConsecutive << " in the outer loop\n");
+  return OuterConsecutive > InnerConsecutive;
+}
+
+bool LoopInterchange::processNest(Loop *Outer, Loop *Inner) {
+  InductionInfo OuterIV, InnerIV;
+  if (!analyzeInduction(Outer, Outer, OuterIV) ||
+      !analyzeInduction(Inner, Outer, InnerIV))
+    return false;
+
+  // The recipes can only be swapped if both loops test the same kind of
+  // value of the same type and leave through the same branch successor.
+  if (OuterIV.Phi->getType() != InnerIV.Phi->getType() ||
+      (OuterIV.Cmp->getOperand(0) == OuterIV.Phi) !=
+        (InnerIV.Cmp->getOperand(0) == InnerIV.Phi) ||
+      (OuterIV.Br->getSuccessor(0) == Outer->getHeader()) !=
+        (InnerIV.Br->getSuccessor(0) == Inner->getHeader()))
+    return false;
+
+  SmallVector<Instruction *, 4> Sinkable;
+  if (!collectSinkable(Outer, Inner, OuterIV, Sinkable))
+    return false;
+
+  SmallVector<Instruction *, 8> MemInsts;
+  for (Loop::block_iterator BI = Inner->block_begin(), BE = Inner->block_end();
+       BI != BE; ++BI)
+    for (BasicBlock::iterator I = (*BI)->begin(), E = (*BI)->end(); I != E;
+         ++I) {
+      // The last iteration of the inner loop changes, so nothing it computes
+      // may be used after it.
+      for (Value::use_iterator UI = I->use_begin(), UE = I->use_end();
+           UI != UE; ++UI)
+        if (!Inner->contains(cast<Instruction>(*UI)))
+          return false;
+      if (!I->mayReadOrWriteMemory())
+        continue;
+      LoadInst *LD = dyn_cast<LoadInst>(I);
+      StoreInst *ST = dyn_cast<StoreInst>(I);
+      if ((!LD || !LD->isSimple()) && (!ST || !ST->isSimple()))
+        return false;
+      MemInsts.push_back(I);
+    }
+
+  if (MemInsts.empty() || !isProfitable(Outer, Inner, MemInsts) ||
+      !isLegal(Outer, MemInsts))
+    return false;
+
+  DEBUG(dbgs() << "LoopInterchange: interchanging the loops with headers "
+               << Outer->getHeader()->getName() << " and "
+               << Inner->getHeader()->getName() << '\n');
+  interchange(Inner, OuterIV, InnerIV, Sinkable);
+  SE->forgetLoop(Outer);
+  ++NumInterchanged;
+  return true;
+}
+
+/// swapStarts - Exchange the start values of the two induction phis.
+static void swapStarts(InductionInfo &A, InductionInfo &B) {
+  int AIdx = A.Phi->getBasicBlockIndex(A.Preheader);
+  int BIdx = B.Phi->getBasicBlockIndex(B.Preheader);
+  Value *AStart = A.Phi->getIncomingValue(AIdx);
+  A.Phi->setIncomingValue(AIdx, B.Phi->getIncomingValue(BIdx));
+  B.Phi->setIncomingValue(BIdx, AStart);
+}
+
+void LoopInterchange::interchange(Loop *Inner, InductionInfo &OuterIV,
+                                  InductionInfo &InnerIV,
+                                  SmallVectorImpl<Instruction *> &Sinkable) {
+  // Move the outer-loop computations feeding the body into the inner loop,
+  // where they will see the new inner induction variable.
+  Instruction *InsertPt = Inner->getHeader()->getFirstInsertionPt();
+  for (unsigned i = 0, e = Sinkable.size(); i != e; ++i)
+    Sinkable[i]->moveBefore(InsertPt);
+
+  // Each loop now runs through the other loop's iteration space.
+  swapStarts(OuterIV, InnerIV);
+
+  Value *OuterStep = OuterIV.Next->getOperand(1);
+  OuterIV.Next->setOperand(1, InnerIV.Next->getOperand(1));
+  InnerIV.Next->setOperand(1, OuterStep);
+  bool OuterNSW = OuterIV.Next->hasNoSignedWrap();
+  bool OuterNUW = OuterIV.Next->hasNoUnsignedWrap();
+  OuterIV.Next->setHasNoSignedWrap(InnerIV.Next->hasNoSignedWrap());
+  OuterIV.Next->setHasNoUnsignedWrap(InnerIV.Next->hasNoUnsignedWrap());
+  InnerIV.Next->setHasNoSignedWrap(OuterNSW);
+  InnerIV.Next->setHasNoUnsignedWrap(OuterNUW);
+
+  CmpInst::Predicate OuterPred = OuterIV.Cmp->getPredicate();
+  Value *OuterBound = OuterIV.Cmp->getOperand(1);
+  OuterIV.Cmp->setPredicate(InnerIV.Cmp->getPredicate());
+  OuterIV.Cmp->setOperand(1, InnerIV.Cmp->getOperand(1));
+  InnerIV.Cmp->setPredicate(OuterPred);
+  InnerIV.Cmp->setOperand(1, OuterBound);
+
+  // The body refers to the old outer induction variable through the new
+  // inner one and vice versa.
+  for (Loop::block_iterator BI = Inner->block_begin(), BE = Inner->block_end();
+       BI != BE; ++BI)
+    for (BasicBlock::iterator I = (*BI)->begin(), E = (*BI)->end(); I != E;
+         ++I) {
+      if (InnerIV.isControl(I))
+        continue;
+      for (unsigned i = 0, e = I->getNumOperands(); i != e; ++i) {
+        if (I->getOperand(i) == OuterIV.Phi)
+          I->setOperand(i, InnerIV.Phi);
+        else if (I->getOperand(i) == InnerIV.Phi)
+          I->setOperand(i, OuterIV.Phi);
+      }
+    }
+}
@@ -59,6 +59,7 @@
 #include "llvm/ADT/SetVector.h"
 #include "llvm/ADT/SmallBitVector.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/Analysis/Dominators.h"
 #include "llvm/Analysis/IVUsers.h"
 #include "llvm/Analysis/LoopPass.h"
@@ -78,6 +79,19 @@
 #include <algorithm>
 using namespace llvm;
 
+STATISTIC(NumSolverSteps, "Number of formulae rated by the LSR solver");
+STATISTIC(MaxSolverStepsPerLoop,
+          "Maximum number of formulae rated by the LSR solver for one loop");
+STATISTIC(NumSolverBudgetExhausted,
+          "Number of loops whose LSR solver ran out of budget");
+
+/// MaxSolverSteps bounds the number of formulae the exhaustive solver may
+/// rate for one loop. Once it is exhausted, the solver keeps the best solution
+/// found so far, or finishes the current one greedily if it has none yet.
+static cl::opt<unsigned> MaxSolverSteps(
+  "lsr-max-solver-steps", cl::Hidden, cl::init(100000),
+  cl::desc("Maximum number of formulae rated when solving one loop"));
+
 /// MaxIVUsers is an arbitrary threshold that provides an early opportunitiy for
 /// bail out. This threshold is far beyond the number of users that LSR can
 /// conceivably solve, so it should not affect generated code, but catches the
@@ -1635,6 +1649,9 @@ class LSRInstance {
   /// IVIncSet - IV users that belong to profitable IVChains.
   SmallPtrSet<Use*, MaxChains> IVIncSet;
 
+  /// SolverSteps - The number of formulae rated by the current Solve.
+  mutable unsigned SolverSteps;
+
   void OptimizeShadowIV();
   bool FindIVUserForCond(ICmpInst *Cond, IVStrideUse *&CondUse);
   ICmpInst *OptimizeMax(ICmpInst *Cond, IVStrideUse* &CondUse);
@@ -1705,6 +1722,13 @@ class LSRInstance {
                     const Cost &CurCost,
                     const SmallPtrSet<const SCEV *, 16> &CurRegs,
                     DenseSet<const SCEV *> &VisitedRegs) const;
+  void SolveGreedily(SmallVectorImpl<const Formula *> &Solution,
+                     Cost &SolutionCost,
+                     SmallVectorImpl<const Formula *> &Workspace,
+                     const Cost &CurCost,
+                     const SmallPtrSet<const SCEV *, 16> &CurRegs,
+                     DenseSet<const SCEV *> &VisitedRegs,
+                     const SmallSetVector<const SCEV *, 4> &ReqRegs) const;
   void Solve(SmallVectorImpl<const Formula *> &Solution) const;
 
   BasicBlock::iterator
@@ -4123,6 +4147,63 @@ void LSRInstance::NarrowSearchSpaceUsingHeuristics() {
   NarrowSearchSpaceByPickingWinnerRegs();
 }
 
+/// usesRequiredRegs - Return true if F references every register in ReqRegs.
+static bool usesRequiredRegs(const Formula &F,
+                             const SmallSetVector<const SCEV *, 4> &ReqRegs) {
+  for (SmallSetVector<const SCEV *, 4>::const_iterator J = ReqRegs.begin(),
+       JE = ReqRegs.end(); J != JE; ++J) {
+    const SCEV *Reg = *J;
+    if ((!F.ScaledReg || F.ScaledReg != Reg) &&
+        std::find(F.BaseRegs.begin(), F.BaseRegs.end(), Reg) ==
+        F.BaseRegs.end())
+      return false;
+  }
+  return true;
+}
+
+/// SolveGreedily - Complete the solution in Workspace by picking the cheapest
+/// formula for each remaining use, without backtracking. This is used once
+/// the solver has run out of budget.
+void LSRInstance::SolveGreedily(SmallVectorImpl<const Formula *> &Solution,
+                                Cost &SolutionCost,
+                                SmallVectorImpl<const Formula *> &Workspace,
+                                const Cost &CurCost,
+                                const SmallPtrSet<const SCEV *, 16> &CurRegs,
+                                DenseSet<const SCEV *> &VisitedRegs,
+                       const SmallSetVector<const SCEV *, 4> &ReqRegs) const {
+  const LSRUse &LU = Uses[Workspace.size()];
+  const Formula *Best = 0;
+  Cost BestCost;
+  SmallPtrSet<const SCEV *, 16> BestRegs;
+  for (SmallVectorImpl<Formula>::const_iterator I = LU.Formulae.begin(),
+       E = LU.Formulae.end(); I != E; ++I) {
+    if (!usesRequiredRegs(*I, ReqRegs))
+      continue;
+    Cost NewCost = CurCost;
+    SmallPtrSet<const SCEV *, 16> NewRegs = CurRegs;
+    NewCost.RateFormula(TTI, *I, NewRegs, VisitedRegs, L, LU.Offsets, SE, DT,
+                        LU);
+    ++SolverSteps;
+    if (!Best || NewCost < BestCost) {
+      Best = &*I;
+      BestCost = NewCost;
+      BestRegs = NewRegs;
+    }
+  }
+  if (!Best)
+    return;
+
+  Workspace.push_back(Best);
+  if (Workspace.size() != Uses.size())
+    SolveRecurse(Solution, SolutionCost, Workspace, BestCost, BestRegs,
+                 VisitedRegs);
+  else if (BestCost < SolutionCost) {
+    SolutionCost = BestCost;
+    Solution = Workspace;
+  }
+  Workspace.pop_back();
+}
+
 /// SolveRecurse - This is the recursive solver.
 void LSRInstance::SolveRecurse(SmallVectorImpl<const Formula *> &Solution,
                                Cost &SolutionCost,
@@ -4152,6 +4233,14 @@ void LSRInstance::SolveRecurse(SmallVectorImpl<const Formula *> &Solution,
     if (LU.Regs.count(*I))
       ReqRegs.insert(*I);
 
+  // Out of budget: stop exploring as soon as there is any solution.
+  if (SolverSteps >= MaxSolverSteps) {
+    if (Solution.empty())
+      SolveGreedily(Solution, SolutionCost, Workspace, CurCost, CurRegs,
+                    VisitedRegs, ReqRegs);
+    return;
+  }
+
   SmallPtrSet<const SCEV *, 16> NewRegs;
   Cost NewCost;
   for (SmallVectorImpl<Formula>::const_iterator I = LU.Formulae.begin(),
@@ -4159,18 +4248,7 @@ void LSRInstance::SolveRecurse(SmallVectorImpl<const Formula *> &Solution,
     const Formula &F = *I;
 
     // Ignore formulae which do not use any of the required registers.
-    bool SatisfiedReqReg = true;
-    for (SmallSetVector<const SCEV *, 4>::const_iterator J = ReqRegs.begin(),
-         JE = ReqRegs.end(); J != JE; ++J) {
-      const SCEV *Reg = *J;
-      if ((!F.ScaledReg || F.ScaledReg != Reg) &&
-          std::find(F.BaseRegs.begin(), F.BaseRegs.end(), Reg) ==
-          F.BaseRegs.end()) {
-        SatisfiedReqReg = false;
-        break;
-      }
-    }
-    if (!SatisfiedReqReg) {
+    if (!usesRequiredRegs(F, ReqRegs)) {
       // If none of the formulae satisfied the required registers, then we could
       // clear ReqRegs and try again. Currently, we simply give up in this case.
       continue;
@@ -4182,6 +4260,7 @@ void LSRInstance::SolveRecurse(SmallVectorImpl<const Formula *> &Solution,
     NewRegs = CurRegs;
     NewCost.RateFormula(TTI, F, NewRegs, VisitedRegs, L, LU.Offsets, SE, DT,
                         LU);
+    ++SolverSteps;
     if (NewCost < SolutionCost) {
       Workspace.push_back(&F);
       if (Workspace.size() != Uses.size()) {
@@ -4215,10 +4294,20 @@ void LSRInstance::Solve(SmallVectorImpl<const Formula *> &Solution) const {
   SmallPtrSet<const SCEV *, 16> CurRegs;
   DenseSet<const SCEV *> VisitedRegs;
   Workspace.reserve(Uses.size());
+  SolverSteps = 0;
 
   // SolveRecurse does all the work.
   SolveRecurse(Solution, SolutionCost, Workspace, CurCost,
                CurRegs, VisitedRegs);
+
+  NumSolverSteps += SolverSteps;
+  MaxSolverStepsPerLoop =
+      std::max<unsigned>(SolverSteps, MaxSolverStepsPerLoop);
+  if (SolverSteps >= MaxSolverSteps) {
+    DEBUG(dbgs() << "LSR solver ran out of budget after " << SolverSteps
+                 << " formulae\n");
+    ++NumSolverBudgetExhausted;
+  }
   if (Solution.empty()) {
     DEBUG(dbgs() << "\nNo Satisfactory Solution\n");
     return;
@@ -4697,7 +4786,7 @@ LSRInstance::LSRInstance(Loop *L, Pass *P)
     : IU(P->getAnalysis<IVUsers>()), SE(P->getAnalysis<ScalarEvolution>()),
       DT(P->getAnalysis<DominatorTree>()), LI(P->getAnalysis<LoopInfo>()),
       TTI(P->getAnalysis<TargetTransformInfo>()), L(L), Changed(false),
-      IVIncInsertPos(0) {
+      IVIncInsertPos(0), SolverSteps(0) {
   // If LoopSimplify form is not available, stay out of trouble.
   if (!L->isLoopSimplifyForm())
     return;
@@ -20,11 +20,16 @@
 #include "llvm/Analysis/ScalarEvolution.h"
 #include "llvm/Analysis/TargetTransformInfo.h"
 #include "llvm/IR/DataLayout.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/Instructions.h"
 #include "llvm/IR/IntrinsicInst.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Metadata.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Transforms/Utils/UnrollLoop.h"
+#include <algorithm>
 #include <climits>
 
 using namespace llvm;
@@ -46,6 +51,16 @@ static cl::opt<bool>
 UnrollRuntime("unroll-runtime", cl::ZeroOrMore, cl::init(false), cl::Hidden,
   cl::desc("Unroll loops with run-time trip counts"));
 
+static cl::opt<bool>
+UnrollUseProfile("unroll-use-profile", cl::init(false), cl::Hidden,
+  cl::desc("Use branch weights on the loop latch to skip cold loops and to "
+           "pick runtime unroll counts for hot ones"));
+
+static cl::opt<unsigned>
+UnrollProfileColdCount("unroll-profile-cold-count", cl::init(100), cl::Hidden,
+  cl::desc("With -unroll-use-profile, loops whose latch weights add up to "
+           "less than this are not unrolled"));
+
 namespace {
   class LoopUnroll : public LoopPass {
   public:
@@ -146,6 +161,33 @@ static unsigned ApproximateLoopSize(const Loop *L, unsigned &NumCalls,
   return LoopSize;
 }
 
+/// getLatchProfile - If the latch of L ends in a conditional branch with
+/// branch weights, return true and set BackedgeWeight and ExitWeight to the
+/// weights of the backedge and of the exit edge.
+static bool getLatchProfile(const Loop *L, uint64_t &BackedgeWeight,
+                            uint64_t &ExitWeight) {
+  BasicBlock *Latch = L->getLoopLatch();
+  if (!Latch)
+    return false;
+  BranchInst *BI = dyn_cast<BranchInst>(Latch->getTerminator());
+  if (!BI || !BI->isConditional())
+    return false;
+  MDNode *MD = BI->getMetadata(LLVMContext::MD_prof);
+  if (!MD || MD->getNumOperands() != 3)
+    return false;
+  ConstantInt *TrueWeight = dyn_cast<ConstantInt>(MD->getOperand(1));
+  ConstantInt *FalseWeight = dyn_cast<ConstantInt>(MD->getOperand(2));
+  if (!TrueWeight || !FalseWeight)
+    return false;
+
+  BackedgeWeight = TrueWeight->getZExtValue();
+  ExitWeight = FalseWeight->getZExtValue();
+  if (BI->getSuccessor(0) != L->getHeader())
+    std::swap(BackedgeWeight, ExitWeight);
+  return BI->getSuccessor(0) == L->getHeader() ||
+         BI->getSuccessor(1) == L->getHeader();
+}
+
 bool LoopUnroll::runOnLoop(Loop *L, LPPassManager &LPM) {
   LoopInfo *LI = &getAnalysis<LoopInfo>();
   ScalarEvolution *SE = &getAnalysis<ScalarEvolution>();
@@ -193,6 +235,37 @@ bool LoopUnroll::runOnLoop(Loop *L, LPPassManager &LPM) {
   // and the trip count is a run-time value.  The default is different
   // for run-time or compile-time trip count loops.
   unsigned Count = UserCount ? CurrentCount : UP.Count;
+
+  // With a profile, leave cold loops alone, and unroll hot loops with an
+  // unknown trip count by the average trip count the profile shows, capped
+  // at the usual runtime unroll count.
+  uint64_t BackedgeWeight, ExitWeight;
+  if (UnrollUseProfile && !UserCount &&
+      getLatchProfile(L, BackedgeWeight, ExitWeight)) {
+    if (BackedgeWeight + ExitWeight < UnrollProfileColdCount) {
+      DEBUG(dbgs() << "  Not unrolling cold loop.\n");
+      return false;
+    }
+    // An explicit -unroll-runtime=false still wins over the profile.
+    if (TripCount == 0 && Count == 0 && (!UserRuntime || CurrentRuntime)) {
+      uint64_t AvgTripCount = (BackedgeWeight + ExitWeight) /
+                              std::max(ExitWeight, (uint64_t)1);
+      unsigned ProfileCount = 1;
+      while (ProfileCount * 2 <= std::min(AvgTripCount,
+                                          (uint64_t)UnrollRuntimeCount))
+        ProfileCount *= 2;
+      if (ProfileCount < 2) {
+        DEBUG(dbgs() << "  Not unrolling loop with average trip count "
+              << AvgTripCount << ".\n");
+        return false;
+      }
+      DEBUG(dbgs() << "  Profile suggests runtime unroll count "
+            << ProfileCount << "\n");
+      Count = ProfileCount;
+      Runtime = true;
+    }
+  }
+
   if (Runtime && Count == 0 && TripCount == 0)
     Count = UnrollRuntimeCount;
 
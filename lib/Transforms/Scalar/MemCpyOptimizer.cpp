@@ -14,6 +14,7 @@
 
 #define DEBUG_TYPE "memcpyopt"
 #include "llvm/Transforms/Scalar.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/Analysis/AliasAnalysis.h"
@@ -30,7 +31,7 @@
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Target/TargetLibraryInfo.h"
 #include "llvm/Transforms/Utils/Local.h"
-#include <list>
+#include <map>
 using namespace llvm;
 
 STATISTIC(NumMemCpyInstr, "Number of memcpy instructions deleted");
@@ -191,15 +192,19 @@ bool MemsetRange::isProfitableToUseMemset(const DataLayout &TD) const {
 
 namespace {
 class MemsetRanges {
-  /// Ranges - A sorted list of the memset ranges.  We use std::list here
-  /// because each element is relatively large and expensive to copy.
-  std::list<MemsetRange> Ranges;
-  typedef std::list<MemsetRange>::iterator range_iterator;
+  /// Ranges - The memset ranges, keyed by their start offset.  The ranges are
+  /// disjoint and never touch, so they are sorted by their end offset as well,
+  /// and the range a new store joins can be found with a single lookup.  We
+  /// use a node-based map because each element is relatively large and
+  /// expensive to copy.
+  typedef std::map<int64_t, MemsetRange> RangeMap;
+  RangeMap Ranges;
+  typedef RangeMap::iterator range_iterator;
   const DataLayout &TD;
 public:
   MemsetRanges(const DataLayout &td) : TD(td) {}
 
-  typedef std::list<MemsetRange>::const_iterator const_iterator;
+  typedef RangeMap::const_iterator const_iterator;
   const_iterator begin() const { return Ranges.begin(); }
   const_iterator end() const { return Ranges.end(); }
   bool empty() const { return Ranges.empty(); }
@@ -235,23 +240,26 @@ public:
 /// new range for the specified store at the specified offset, merging into
 /// existing ranges as appropriate.
 ///
-/// Do a linear search of the ranges to see if this can be joined and/or to
-/// find the insertion point in the list.  We keep the ranges sorted for
-/// simplicity here.  This is a linear search of a linked list, which is ugly,
-/// however the number of ranges is limited, so this won't get crazy slow.
+/// The first range that could be joined is either the last one starting at or
+/// before Start, or the one after it, so this is a logarithmic lookup plus the
+/// cost of any merging.  Blocks with thousands of adjacent stores hit this on
+/// every store.
 void MemsetRanges::addRange(int64_t Start, int64_t Size, Value *Ptr,
                             unsigned Alignment, Instruction *Inst) {
   int64_t End = Start+Size;
-  range_iterator I = Ranges.begin(), E = Ranges.end();
-
-  while (I != E && Start > I->End)
-    ++I;
+  range_iterator I = Ranges.upper_bound(Start), E = Ranges.end();
+  if (I != Ranges.begin()) {
+    range_iterator PrevI = llvm::prior(I);
+    if (Start <= PrevI->second.End)
+      I = PrevI;
+  }
 
   // We now know that I == E, in which case we didn't find anything to merge
   // with, or that Start <= I->End.  If End < I->Start or I == E, then we need
   // to insert a new range.  Handle this now.
-  if (I == E || End < I->Start) {
-    MemsetRange &R = *Ranges.insert(I, MemsetRange());
+  if (I == E || End < I->second.Start) {
+    MemsetRange &R = Ranges.insert(I, std::make_pair(Start,
+                                                     MemsetRange()))->second;
     R.Start        = Start;
     R.End          = End;
     R.StartPtr     = Ptr;
@@ -261,11 +269,11 @@ void MemsetRanges::addRange(int64_t Start, int64_t Size, Value *Ptr,
   }
 
   // This store overlaps with I, add it.
-  I->TheStores.push_back(Inst);
+  I->second.TheStores.push_back(Inst);
 
   // At this point, we may have an interval that completely contains our store.
   // If so, just add it to the interval and return.
-  if (I->Start <= Start && I->End >= End)
+  if (I->second.Start <= Start && I->second.End >= End)
     return;
 
   // Now we know that Start <= I->End and End >= I->Start so the range overlaps
@@ -273,26 +281,35 @@ void MemsetRanges::addRange(int64_t Start, int64_t Size, Value *Ptr,
 
   // See if the range extends the start of the range.  In this case, it couldn't
   // possibly cause it to join the prior range, because otherwise we would have
-  // stopped on *it*.
-  if (Start < I->Start) {
-    I->Start = Start;
-    I->StartPtr = Ptr;
-    I->Alignment = Alignment;
+  // stopped on *it*.  The start is the key of the range, so move the range to
+  // a new node; swapping its stores avoids copying them.
+  if (Start < I->second.Start) {
+    range_iterator NewI = Ranges.insert(I, std::make_pair(Start,
+                                                          MemsetRange()));
+    MemsetRange &R = NewI->second;
+    R.Start = Start;
+    R.End = I->second.End;
+    R.StartPtr = Ptr;
+    R.Alignment = Alignment;
+    R.TheStores.swap(I->second.TheStores);
+    Ranges.erase(I);
+    I = NewI;
   }
 
   // Now we know that Start <= I->End and Start >= I->Start (so the startpoint
   // is in or right at the end of I), and that End >= I->Start.  Extend I out to
   // End.
-  if (End > I->End) {
-    I->End = End;
-    range_iterator NextI = I;
-    while (++NextI != E && End >= NextI->Start) {
+  if (End > I->second.End) {
+    MemsetRange &R = I->second;
+    R.End = End;
+    range_iterator NextI = llvm::next(I);
+    while (NextI != E && End >= NextI->second.Start) {
       // Merge the range in.
-      I->TheStores.append(NextI->TheStores.begin(), NextI->TheStores.end());
-      if (NextI->End > I->End)
-        I->End = NextI->End;
-      Ranges.erase(NextI);
-      NextI = I;
+      R.TheStores.append(NextI->second.TheStores.begin(),
+                         NextI->second.TheStores.end());
+      if (NextI->second.End > R.End)
+        R.End = NextI->second.End;
+      Ranges.erase(NextI++);
     }
   }
 }
@@ -436,7 +453,7 @@ Instruction *MemCpyOpt::tryMergingIntoMemset(Instruction *StartInst,
   Instruction *AMemSet = 0;
   for (MemsetRanges::const_iterator I = Ranges.begin(), E = Ranges.end();
        I != E; ++I) {
-    const MemsetRange &Range = *I;
+    const MemsetRange &Range = I->second;
 
     if (Range.TheStores.size() == 1) continue;
 
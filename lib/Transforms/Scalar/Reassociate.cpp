@@ -26,6 +26,7 @@
 #include "llvm/ADT/PostOrderIterator.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/SmallSet.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/Assembly/Writer.h"
 #include "llvm/IR/Constants.h"
@@ -36,6 +37,7 @@
 #include "llvm/IR/IntrinsicInst.h"
 #include "llvm/Pass.h"
 #include "llvm/Support/CFG.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/ValueHandle.h"
 #include "llvm/Support/raw_ostream.h"
@@ -46,6 +48,12 @@ using namespace llvm;
 STATISTIC(NumChanged, "Number of insts reassociated");
 STATISTIC(NumAnnihil, "Number of expr tree annihilated");
 STATISTIC(NumFactor , "Number of multiplies factored");
+STATISTIC(NumPairsGrouped, "Number of operand pairs grouped for CSE");
+
+static cl::opt<unsigned>
+MaxPairedOperands("reassociate-max-paired-operands", cl::Hidden, cl::init(10),
+  cl::desc("Largest expression whose operand pairs are counted to expose "
+           "common subexpressions within a block (0 = none)"));
 
 namespace {
   struct ValueEntry {
@@ -157,10 +165,30 @@ namespace {
 }
 
 namespace {
+  /// PairMapValue - The number of expressions of the current block that
+  /// combine a pair of operands.  The handles tell whether the key still
+  /// names the values it was counted for, as values created while
+  /// reassociating may reuse the address of erased ones.
+  struct PairMapValue {
+    WeakVH Value1, Value2;
+    unsigned Score;
+    PairMapValue(Value *V1, Value *V2) : Value1(V1), Value2(V2), Score(1) {}
+    bool isValid(Value *V1, Value *V2) const {
+      return Value1 == V1 && Value2 == V2;
+    }
+  };
+
   class Reassociate : public FunctionPass {
     DenseMap<BasicBlock*, unsigned> RankMap;
     DenseMap<AssertingVH<Value>, unsigned> ValueRankMap;
     SetVector<AssertingVH<Instruction> > RedoInsts;
+
+    /// PairMap - For each associative opcode, how often each pair of operands
+    /// occurs in the expressions of the block being optimized.  Combining the
+    /// most frequent pair first lets the expressions share that computation.
+    typedef DenseMap<std::pair<Value*, Value*>, PairMapValue> PairMapTy;
+    PairMapTy PairMap[Instruction::BinaryOpsEnd - Instruction::BinaryOpsBegin];
+
     bool MadeChange;
   public:
     static char ID; // Pass identification, replacement for typeid
@@ -175,6 +203,9 @@ namespace {
     }
   private:
     void BuildRankMap(Function &F);
+    void BuildPairMap(BasicBlock *BB);
+    void GroupMostFrequentPair(BinaryOperator *I,
+                               SmallVectorImpl<ValueEntry> &Ops);
     unsigned getRank(Value *V);
     void ReassociateExpression(BinaryOperator *I);
     void RewriteExprTree(BinaryOperator *I, SmallVectorImpl<ValueEntry> &Ops);
@@ -283,6 +314,107 @@ void Reassociate::BuildRankMap(Function &F) {
   }
 }
 
+/// BuildPairMap - Count the pairs of operands of the expressions rooted in BB
+/// into PairMap.
+void Reassociate::BuildPairMap(BasicBlock *BB) {
+  for (BasicBlock::iterator I = BB->begin(), E = BB->end(); I != E; ++I) {
+    if (!I->isAssociative() || !I->getType()->isIntegerTy() ||
+        I->getType()->isIntegerTy(1))
+      continue;
+
+    // Only count each expression once, from its root.
+    unsigned Opcode = I->getOpcode();
+    if (I->hasOneUse() && I->use_back()->getOpcode() == Opcode)
+      continue;
+
+    // Collect the operands of the expression.  Unlike LinearizeExprTree this
+    // doesn't look through anything but single-use nodes of the same opcode,
+    // which is enough to tell which operands are combined by several
+    // expressions.
+    SmallVector<Value*, 8> Worklist;
+    SmallVector<Value*, 8> Ops;
+    Worklist.push_back(I->getOperand(0));
+    Worklist.push_back(I->getOperand(1));
+    while (!Worklist.empty() && Ops.size() <= MaxPairedOperands) {
+      Value *Op = Worklist.pop_back_val();
+      Instruction *OpI = dyn_cast<Instruction>(Op);
+      if (!OpI || OpI->getOpcode() != Opcode || !OpI->hasOneUse()) {
+        Ops.push_back(Op);
+        continue;
+      }
+      // Self-referential expressions only occur in unreachable code.
+      if (OpI->getOperand(0) != OpI)
+        Worklist.push_back(OpI->getOperand(0));
+      if (OpI->getOperand(1) != OpI)
+        Worklist.push_back(OpI->getOperand(1));
+    }
+    // The number of pairs grows quadratically, so leave big expressions out.
+    if (!Worklist.empty() || Ops.size() > MaxPairedOperands)
+      continue;
+
+    PairMapTy &Pairs = PairMap[Opcode - Instruction::BinaryOpsBegin];
+    SmallSet<std::pair<Value*, Value*>, 32> Visited;
+    for (unsigned i = 0, e = Ops.size(); i + 1 < e; ++i)
+      for (unsigned j = i + 1; j != e; ++j) {
+        Value *Op0 = Ops[i], *Op1 = Ops[j];
+        if (std::less<Value*>()(Op1, Op0))
+          std::swap(Op0, Op1);
+        if (!Visited.insert(std::make_pair(Op0, Op1)))
+          continue;
+        std::pair<PairMapTy::iterator, bool> Res =
+          Pairs.insert(std::make_pair(std::make_pair(Op0, Op1),
+                                      PairMapValue(Op0, Op1)));
+        if (!Res.second)
+          ++Res.first->second.Score;
+      }
+  }
+}
+
+/// GroupMostFrequentPair - If some pair of the operands in Ops is combined by
+/// other expressions of the block too, move it to the end of Ops, so that it
+/// is computed first and the expressions can share (CSE) that computation.
+void Reassociate::GroupMostFrequentPair(BinaryOperator *I,
+                                        SmallVectorImpl<ValueEntry> &Ops) {
+  if (Ops.size() <= 2 || Ops.size() > MaxPairedOperands)
+    return;
+
+  const PairMapTy &Pairs = PairMap[I->getOpcode() - Instruction::BinaryOpsBegin];
+  if (Pairs.empty())
+    return;
+
+  // Prefer the pair seen most often, then the one of lowest rank, which can be
+  // computed earliest.  A score of one means only this expression has it.
+  unsigned BestScore = 1, BestRank = 0, BestI = 0, BestJ = 0;
+  for (unsigned i = 0, e = Ops.size(); i + 1 < e; ++i)
+    for (unsigned j = i + 1; j != e; ++j) {
+      Value *Op0 = Ops[i].Op, *Op1 = Ops[j].Op;
+      if (std::less<Value*>()(Op1, Op0))
+        std::swap(Op0, Op1);
+      PairMapTy::const_iterator It = Pairs.find(std::make_pair(Op0, Op1));
+      if (It == Pairs.end() || !It->second.isValid(Op0, Op1))
+        continue;
+      unsigned Score = It->second.Score;
+      unsigned Rank = std::max(Ops[i].Rank, Ops[j].Rank);
+      if (Score > BestScore || (Score == BestScore && BestScore > 1 &&
+                                Rank < BestRank)) {
+        BestScore = Score;
+        BestRank = Rank;
+        BestI = i;
+        BestJ = j;
+      }
+    }
+  if (BestScore == 1 || (BestI + 2 == Ops.size() && BestJ + 1 == Ops.size()))
+    return;
+
+  // The two operands keep their relative order, which follows their ranks.
+  ValueEntry Op0 = Ops[BestI], Op1 = Ops[BestJ];
+  Ops.erase(Ops.begin() + BestJ);
+  Ops.erase(Ops.begin() + BestI);
+  Ops.push_back(Op0);
+  Ops.push_back(Op1);
+  ++NumPairsGrouped;
+}
+
 unsigned Reassociate::getRank(Value *V) {
   Instruction *I = dyn_cast<Instruction>(V);
   if (I == 0) {
@@ -818,6 +950,8 @@ void Reassociate::RewriteExprTree(BinaryOperator *I,
   if (ExpressionChanged)
     do {
       ExpressionChanged->clearSubclassOptionalData();
+      // Its rank was computed for the operands it had before.
+      ValueRankMap.erase(ExpressionChanged);
       if (ExpressionChanged == I)
         break;
       ExpressionChanged->moveBefore(I);
@@ -1966,6 +2100,8 @@ void Reassociate::ReassociateExpression(BinaryOperator *I) {
     return;
   }
 
+  GroupMostFrequentPair(I, Ops);
+
   // Now that we ordered and optimized the expressions, splat them back into
   // the expression tree, removing any unneeded nodes.
   RewriteExprTree(I, Ops);
@@ -1977,6 +2113,9 @@ bool Reassociate::runOnFunction(Function &F) {
 
   MadeChange = false;
   for (Function::iterator BI = F.begin(), BE = F.end(); BI != BE; ++BI) {
+    if (MaxPairedOperands)
+      BuildPairMap(BI);
+
     // Optimize every instruction in the basic block.
     for (BasicBlock::iterator II = BI->begin(), IE = BI->end(); II != IE; )
       if (isInstructionTriviallyDead(II)) {
@@ -1995,6 +2134,9 @@ bool Reassociate::runOnFunction(Function &F) {
       else
         OptimizeInst(I);
     }
+
+    for (unsigned i = 0, e = array_lengthof(PairMap); i != e; ++i)
+      PairMap[i].clear();
   }
 
   // We are done with the rank map.
@@ -67,12 +67,23 @@ STATISTIC(NumPromoted, "Number of allocas promoted to SSA values");
 STATISTIC(NumLoadsSpeculated, "Number of loads speculated to allow promotion");
 STATISTIC(NumDeleted, "Number of instructions deleted");
 STATISTIC(NumVectorized, "Number of vectorized aggregates");
+STATISTIC(NumAllocasOverSliceLimit,
+          "Number of allocas only partly split for having too many slices");
 
 /// Hidden option to force the pass to not use DomTree and mem2reg, instead
 /// forming SSA values through the SSAUpdater infrastructure.
 static cl::opt<bool>
 ForceSSAUpdater("force-ssa-updater", cl::init(false), cl::Hidden);
 
+/// Hidden option to bound the number of slices built for a single alloca.
+/// Only the uses at the lowest offsets get slices, and the rest of the alloca
+/// is left in place, which bounds the time spent on huge generated aggregates
+/// while still promoting their leading fields. Zero means no limit.
+static cl::opt<unsigned>
+MaxAllocaSlices("sroa-max-alloca-slices", cl::init(2048), cl::Hidden,
+                cl::desc("Maximum number of slices to build for an alloca "
+                         "(0 = unlimited)"));
+
 namespace {
 /// \brief A custom IRBuilder inserter which prefixes all names if they are
 /// preserved.
@@ -203,6 +214,14 @@ public:
   /// ignored.
   bool isEscaped() const { return PointerEscapingInstr; }
 
+  /// \brief Test whether some uses were left out of the slices.
+  ///
+  /// This happens when an alloca has more uses than the slice limit. They all
+  /// start at or after getUnslicedOffset(), and that part of the alloca must
+  /// not be rewritten.
+  bool hasUnslicedUses() const { return UnslicedOffset != ~uint64_t(0); }
+  uint64_t getUnslicedOffset() const { return UnslicedOffset; }
+
   /// \brief Support for iterating over the slices.
   /// @{
   typedef SmallVectorImpl<Slice>::iterator iterator;
@@ -266,6 +285,10 @@ private:
   /// alloca. This will be null if the alloca slices are analyzed successfully.
   Instruction *PointerEscapingInstr;
 
+  /// \brief The lowest offset used by a use that has no slice, or ~0 if every
+  /// use has one.
+  uint64_t UnslicedOffset;
+
   /// \brief The slices of the alloca.
   ///
   /// We store a vector of the slices formed by uses of the alloca here. This
@@ -329,6 +352,12 @@ public:
       : PtrUseVisitor<SliceBuilder>(DL),
         AllocSize(DL.getTypeAllocSize(AI.getAllocatedType())), S(S) {}
 
+  /// \brief Trim the slices to the slice limit once every use is visited.
+  void applySliceLimit() {
+    if (MaxAllocaSlices && S.Slices.size() > MaxAllocaSlices)
+      dropHighSlices();
+  }
+
 private:
   void markAsDead(Instruction &I) {
     if (VisitedDeadInsts.insert(&I))
@@ -366,9 +395,58 @@ private:
       EndOffset = AllocSize;
     }
 
+    // Uses at or past the unsliced offset keep that part of the alloca in
+    // place, so they need no slice.
+    if (!reserveSlice() || BeginOffset >= S.UnslicedOffset)
+      return;
+
     S.Slices.push_back(Slice(BeginOffset, EndOffset, U, IsSplittable));
   }
 
+  /// \brief Make room for one more slice under the slice limit.
+  ///
+  /// The slices are allowed to grow to twice the limit before the ones at
+  /// the highest offsets are dropped, which keeps the cost of dropping them
+  /// linear in the number of uses. Returns false if no slice can start
+  /// before the unsliced offset anymore.
+  bool reserveSlice() {
+    if (MaxAllocaSlices && S.Slices.size() >= 2 * MaxAllocaSlices)
+      dropHighSlices();
+    return S.UnslicedOffset != 0;
+  }
+
+  /// \brief Drop the slices past the first MaxAllocaSlices by offset, and
+  /// lower the unsliced offset to the first one dropped.
+  void dropHighSlices() {
+    SmallVector<uint64_t, 16> Offsets;
+    for (AllocaSlices::iterator I = S.begin(), E = S.end(); I != E; ++I)
+      if (!I->isDead())
+        Offsets.push_back(I->beginOffset());
+    if (Offsets.size() > MaxAllocaSlices) {
+      std::nth_element(Offsets.begin(), Offsets.begin() + MaxAllocaSlices,
+                       Offsets.end());
+      S.UnslicedOffset =
+          std::min(S.UnslicedOffset, Offsets[MaxAllocaSlices]);
+    }
+
+    // Compact the slices, keeping the mem transfer indices pointing at them.
+    SmallVector<unsigned, 16> NewIndex(S.Slices.size(), ~0u);
+    unsigned NumKept = 0;
+    for (unsigned i = 0, e = S.Slices.size(); i != e; ++i) {
+      Slice &Sl = S.Slices[i];
+      if (Sl.isDead() || Sl.beginOffset() >= S.UnslicedOffset)
+        continue;
+      NewIndex[i] = NumKept;
+      S.Slices[NumKept++] = Sl;
+    }
+    S.Slices.resize(NumKept);
+    for (SmallDenseMap<Instruction *, unsigned>::iterator
+             I = MemTransferSliceMap.begin(), E = MemTransferSliceMap.end();
+         I != E; ++I)
+      if (I->second != ~0u)
+        I->second = NewIndex[I->second];
+  }
+
   void visitBitCastInst(BitCastInst &BC) {
     if (BC.use_empty())
       return markAsDead(BC);
@@ -483,12 +561,26 @@ private:
       return insertUse(II, Offset, Size, /*IsSplittable=*/false);
     }
 
+    // Past the slice limit, one pointer of a transfer within the alloca may
+    // have no slice. The slice of the other one is then kept whole.
+    if (!reserveSlice() || RawOffset >= S.UnslicedOffset) {
+      SmallDenseMap<Instruction *, unsigned>::iterator MTPI =
+          MemTransferSliceMap.find(&II);
+      if (MTPI != MemTransferSliceMap.end() && MTPI->second != ~0u)
+        S.Slices[MTPI->second].makeUnsplittable();
+      else
+        MemTransferSliceMap.insert(std::make_pair(&II, ~0u));
+      return;
+    }
+
     // If we have seen both source and destination for a mem transfer, then
     // they both point to the same alloca.
     bool Inserted;
     SmallDenseMap<Instruction *, unsigned>::iterator MTPI;
     llvm::tie(MTPI, Inserted) =
         MemTransferSliceMap.insert(std::make_pair(&II, S.Slices.size()));
+    if (!Inserted && MTPI->second == ~0u)
+      return insertUse(II, Offset, Size, /*IsSplittable=*/false);
     unsigned PrevIdx = MTPI->second;
     if (!Inserted) {
       Slice &PrevP = S.Slices[PrevIdx];
@@ -658,7 +750,7 @@ AllocaSlices::AllocaSlices(const DataLayout &DL, AllocaInst &AI)
 #if !defined(NDEBUG) || defined(LLVM_ENABLE_DUMP)
       AI(AI),
 #endif
-      PointerEscapingInstr(0) {
+      PointerEscapingInstr(0), UnslicedOffset(~uint64_t(0)) {
   SliceBuilder PB(DL, AI, *this);
   SliceBuilder::PtrInfo PtrI = PB.visitPtr(AI);
   if (PtrI.isEscaped() || PtrI.isAborted()) {
@@ -669,6 +761,7 @@ AllocaSlices::AllocaSlices(const DataLayout &DL, AllocaInst &AI)
     assert(PointerEscapingInstr && "Did not track a bad instruction");
     return;
   }
+  PB.applySliceLimit();
 
   Slices.erase(std::remove_if(Slices.begin(), Slices.end(),
                               std::mem_fun_ref(&Slice::isDead)),
@@ -3219,7 +3312,28 @@ removeFinishedSplitUses(SmallVectorImpl<AllocaSlices::iterator> &SplitUses,
 /// \brief Walks the slices of an alloca and form partitions based on them,
 /// rewriting each of their uses.
 bool SROA::splitAlloca(AllocaInst &AI, AllocaSlices &S) {
-  if (S.begin() == S.end())
+  // With uses left out of the slices, only split the leading slices that end
+  // at a boundary no slice straddles, before any of those uses; the rest stay
+  // on the original alloca.
+  AllocaSlices::iterator SE = S.end();
+  if (S.hasUnslicedUses()) {
+    uint64_t UnslicedOffset = S.getUnslicedOffset();
+    uint64_t MaxEndOffset = 0;
+    AllocaSlices::iterator SI = S.begin();
+    SE = SI;
+    for (; SI != S.end() && SI->beginOffset() < UnslicedOffset; ++SI) {
+      if (SI->beginOffset() >= MaxEndOffset)
+        SE = SI;
+      MaxEndOffset = std::max(MaxEndOffset, SI->endOffset());
+    }
+    if (MaxEndOffset <= UnslicedOffset)
+      SE = SI;
+    DEBUG(dbgs() << "  Splitting " << (SE - S.begin())
+                 << " slices before offset " << UnslicedOffset << "\n");
+    ++NumAllocasOverSliceLimit;
+  }
+
+  if (S.begin() == SE)
     return false;
 
   unsigned NumPartitions = 0;
@@ -3229,8 +3343,8 @@ bool SROA::splitAlloca(AllocaInst &AI, AllocaSlices &S) {
 
   uint64_t BeginOffset = S.begin()->beginOffset();
 
-  for (AllocaSlices::iterator SI = S.begin(), SJ = llvm::next(SI), SE = S.end();
-       SI != SE; SI = SJ) {
+  for (AllocaSlices::iterator SI = S.begin(), SJ = llvm::next(SI); SI != SE;
+       SI = SJ) {
     uint64_t MaxEndOffset = SI->endOffset();
 
     if (!SI->isSplittable()) {
@@ -39,6 +39,7 @@
 #include "llvm/Pass.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/Endian.h"
 #include "llvm/Support/InstIterator.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Regex.h"
@@ -131,8 +132,9 @@ public:
   SampleModuleProfile(StringRef F) : Profiles(0), Filename(F) {}
 
   void dump();
-  void loadText();
-  void loadNative() { llvm_unreachable("not implemented"); }
+  void load(const Module &M);
+  void loadText(MemoryBuffer *Buffer);
+  void loadNative(const MemoryBuffer &Buffer, const Module &M);
   void printFunctionProfile(raw_ostream &OS, StringRef FName);
   void dumpFunctionProfile(StringRef FName);
   SampleFunctionProfile &getProfile(const Function &F) {
@@ -154,6 +156,11 @@ protected:
   /// version of the profile format to be used in constructing test
   /// cases and debugging.
   StringRef Filename;
+
+private:
+  void reportNativeError(const Twine &Msg) const {
+    report_fatal_error(Filename + ": " + Msg);
+  }
 };
 
 /// \brief Loader class for text-based profiles.
@@ -167,12 +174,11 @@ protected:
 /// reader. It should be moved to the Support library and made more general.
 class ExternalProfileTextLoader {
 public:
-  ExternalProfileTextLoader(StringRef F) : Filename(F) {
-    error_code EC;
-    EC = MemoryBuffer::getFile(Filename, Buffer);
-    if (EC)
-      report_fatal_error("Could not open profile file " + Filename + ": " +
-                         EC.message());
+  /// \brief Read lines from the contents \p B of file \p F.
+  ///
+  /// This takes ownership of \p B.
+  ExternalProfileTextLoader(StringRef F, MemoryBuffer *B)
+      : Buffer(B), Filename(F) {
     FP = Buffer->getBufferStart();
     Lineno = 0;
   }
@@ -318,8 +324,8 @@ void SampleModuleProfile::dump() {
 /// for debugging purposes, but it should not be used to generate
 /// profiles for large programs, as the representation is extremely
 /// inefficient.
-void SampleModuleProfile::loadText() {
-  ExternalProfileTextLoader Loader(Filename);
+void SampleModuleProfile::loadText(MemoryBuffer *Buffer) {
+  ExternalProfileTextLoader Loader(Filename, Buffer);
 
   // Read the symbol table.
   StringRef Line = Loader.readLine();
@@ -369,13 +375,108 @@ void SampleModuleProfile::loadText() {
   }
 }
 
+/// \brief Magic number at the start of a native (binary) profile.
+static const char NativeMagic[] = "LLVMSPRF";
+static const unsigned NativeMagicSize = sizeof(NativeMagic) - 1;
+static const uint32_t NativeVersion = 1;
+
+static uint32_t readNativeWord(const char *P) {
+  return support::endian::read<uint32_t, support::little,
+                               support::unaligned>(P);
+}
+
+/// \brief Load the profile into memory and parse it.
+///
+/// Native profiles are recognized by their magic number; anything else is
+/// parsed as a text profile.
+void SampleModuleProfile::load(const Module &M) {
+  OwningPtr<MemoryBuffer> Buffer;
+  if (error_code EC = MemoryBuffer::getFile(Filename, Buffer, -1, false))
+    report_fatal_error("Could not open profile file " + Filename + ": " +
+                       EC.message());
+
+  if (Buffer->getBuffer().startswith(StringRef(NativeMagic, NativeMagicSize)))
+    loadNative(*Buffer, M);
+  else
+    loadText(Buffer.take());
+}
+
+/// \brief Load samples from a native (binary) profile.
+///
+/// All fields are little-endian 32-bit words, and all offsets are from the
+/// start of the file:
+///
+/// Header
+///    magic ("LLVMSPRF", 8 bytes, no terminator)
+///    version (currently 1)
+///    number of functions N
+///
+/// Function index, N entries of
+///    name offset, name length, profile offset
+///
+/// Function profiles, each found at its profile offset
+///    total_samples, total_head_samples, number_of_locations L
+///    L pairs of location_offset, number_of_samples
+///
+/// Names are not NUL terminated and may be stored anywhere in the file.
+///
+/// Unlike loadText, this never scans the whole file: only the index is
+/// walked, and only the profiles of functions defined in \p M are decoded.
+/// The buffer is typically mmapped, so the pages holding the profiles of
+/// other functions are never even read in.  A function that appears more
+/// than once in the index gets its samples aggregated, as for text profiles.
+void SampleModuleProfile::loadNative(const MemoryBuffer &Buffer,
+                                     const Module &M) {
+  const char *Start = Buffer.getBufferStart();
+  uint64_t Size = Buffer.getBufferSize();
+
+  const uint64_t HeaderSize = NativeMagicSize + 8;
+  if (Size < HeaderSize)
+    reportNativeError("Truncated profile header");
+  uint32_t Version = readNativeWord(Start + NativeMagicSize);
+  if (Version != NativeVersion)
+    reportNativeError("Unsupported profile version " + Twine(Version));
+  uint32_t NumFunctions = readNativeWord(Start + NativeMagicSize + 4);
+
+  const uint64_t IndexEntrySize = 12;
+  if ((Size - HeaderSize) / IndexEntrySize < NumFunctions)
+    reportNativeError("Truncated function index");
+
+  for (uint32_t I = 0; I < NumFunctions; ++I) {
+    const char *Entry = Start + HeaderSize + I * IndexEntrySize;
+    uint32_t NameOffset = readNativeWord(Entry);
+    uint32_t NameSize = readNativeWord(Entry + 4);
+    uint32_t ProfileOffset = readNativeWord(Entry + 8);
+    if (NameOffset > Size || NameSize > Size - NameOffset)
+      reportNativeError("Function name out of bounds");
+    StringRef FName(Start + NameOffset, NameSize);
+
+    const Function *F = M.getFunction(FName);
+    if (!F || F->isDeclaration())
+      continue;
+
+    if (ProfileOffset > Size || Size - ProfileOffset < 12)
+      reportNativeError("Profile of " + FName + " out of bounds");
+    const char *P = Start + ProfileOffset;
+    uint32_t NumSampledLines = readNativeWord(P + 8);
+    if ((Size - ProfileOffset - 12) / 8 < NumSampledLines)
+      reportNativeError("Profile of " + FName + " out of bounds");
+
+    SampleFunctionProfile &FProfile = Profiles[FName];
+    FProfile.addTotalSamples(readNativeWord(P));
+    FProfile.addHeadSamples(readNativeWord(P + 4));
+    for (P += 12; NumSampledLines; --NumSampledLines, P += 8)
+      FProfile.addBodySamples(readNativeWord(P), readNativeWord(P + 4));
+  }
+}
+
 char SampleProfileLoader::ID = 0;
 INITIALIZE_PASS(SampleProfileLoader, "sample-profile", "Sample Profile loader",
                 false, false)
 
 bool SampleProfileLoader::doInitialization(Module &M) {
   Profiler.reset(new SampleModuleProfile(Filename));
-  Profiler->loadText();
+  Profiler->load(M);
   return true;
 }
 
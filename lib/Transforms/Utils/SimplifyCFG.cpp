@@ -66,8 +66,20 @@ static cl::opt<bool>
 HoistCondStores("simplifycfg-hoist-cond-stores", cl::Hidden, cl::init(true),
        cl::desc("Hoist conditional stores if an unconditional store preceeds"));
 
+static cl::opt<unsigned>
+SwitchPeelHotCasePercent("switch-peel-hot-case-percent", cl::Hidden,
+       cl::init(40),
+       cl::desc("Peel a switch case off in front of a lookup table when its "
+                "branch weight is at least this percentage of the total"));
+
+static cl::opt<unsigned>
+SwitchPeelMaxCases("switch-peel-max-cases", cl::Hidden, cl::init(2),
+       cl::desc("Maximum number of hot cases to peel off in front of a "
+                "switch lookup table"));
+
 STATISTIC(NumBitMaps, "Number of switch instructions turned into bitmaps");
 STATISTIC(NumLookupTables, "Number of switch instructions turned into lookup tables");
+STATISTIC(NumPeeledSwitchCases, "Number of hot switch cases peeled off in front of lookup tables");
 STATISTIC(NumSinkCommons, "Number of common instructions sunk down to the end block");
 STATISTIC(NumSpeculations, "Number of speculative executed instructions");
 
@@ -3660,6 +3672,36 @@ static bool ShouldBuildLookupTable(SwitchInst *SI,
   return SI->getNumCases() * 10 >= TableSize * 4;
 }
 
+/// GetHotSwitchCases - Use the branch weights on SI to find the cases that
+/// are taken often enough that a compare and branch in front of the lookup
+/// table is cheaper than the table access. The cases are returned hottest
+/// first along with their weights; TotalWeight is the sum of all weights.
+static void GetHotSwitchCases(SwitchInst *SI,
+                      SmallVectorImpl<std::pair<uint64_t, unsigned> > &Hot,
+                      uint64_t &TotalWeight) {
+  TotalWeight = 0;
+  if (!SwitchPeelMaxCases || !SI->getMetadata(LLVMContext::MD_prof))
+    return;
+
+  SmallVector<uint64_t, 8> Weights;
+  GetBranchWeights(SI, Weights);
+  if (Weights.size() != SI->getNumSuccessors())
+    return;
+  for (unsigned i = 0, e = Weights.size(); i != e; ++i)
+    TotalWeight += Weights[i];
+  if (!TotalWeight)
+    return;
+
+  // Weights[0] is the default destination; case i has weight Weights[i + 1].
+  for (unsigned i = 1, e = Weights.size(); i != e; ++i)
+    if (Weights[i] * 100 >= TotalWeight * SwitchPeelHotCasePercent)
+      Hot.push_back(std::make_pair(Weights[i], i - 1));
+  std::sort(Hot.begin(), Hot.end(),
+            std::greater<std::pair<uint64_t, unsigned> >());
+  if (Hot.size() > SwitchPeelMaxCases)
+    Hot.resize(SwitchPeelMaxCases);
+}
+
 /// SwitchToLookupTable - If the switch is only used to initialize one or more
 /// phi nodes in a common successor block with different constant values,
 /// replace the switch with lookup tables.
@@ -3747,8 +3789,49 @@ static bool SwitchToLookupTable(SwitchInst *SI,
                                             CommonDest->getParent(),
                                             CommonDest);
 
-  // Compute the table index value.
   Builder.SetInsertPoint(SI);
+
+  // If the profile says a few cases take almost all of the hits, test for
+  // those directly before touching the table. The peeled cases stay in the
+  // table, which keeps it dense; they just never reach it.
+  SmallVector<std::pair<uint64_t, unsigned>, 4> HotCases;
+  uint64_t RemainingWeight;
+  GetHotSwitchCases(SI, HotCases, RemainingWeight);
+  BasicBlock *TableBB = SI->getParent();
+  for (unsigned i = 0, e = HotCases.size(); i != e; ++i) {
+    ConstantInt *HotVal = SwitchInst::CaseIt(SI, HotCases[i].second)
+                            .getCaseValue();
+    BasicBlock *HotBB = BasicBlock::Create(Mod.getContext(), "switch.hot",
+                                           CommonDest->getParent(), LookupBB);
+    BasicBlock *PeelBB = BasicBlock::Create(Mod.getContext(), "switch.peel",
+                                            CommonDest->getParent(), LookupBB);
+    Value *Cmp = Builder.CreateICmpEQ(SI->getCondition(), HotVal,
+                                      "switch.hotcase");
+    BranchInst *BI = Builder.CreateCondBr(Cmp, HotBB, PeelBB);
+
+    RemainingWeight -= HotCases[i].first;
+    uint64_t BrWeights[] = { HotCases[i].first, RemainingWeight };
+    FitWeights(BrWeights);
+    BI->setMetadata(LLVMContext::MD_prof, MDBuilder(BI->getContext()).
+                    createBranchWeights(BrWeights[0], BrWeights[1]));
+
+    // The hot block feeds each phi the constant this case would have loaded.
+    BranchInst::Create(CommonDest, HotBB);
+    for (size_t I = 0, E = PHIs.size(); I != E; ++I) {
+      const ResultListTy &Results = ResultLists[PHIs[I]];
+      for (size_t J = 0, JE = Results.size(); J != JE; ++J)
+        if (Results[J].first == HotVal) {
+          PHIs[I]->addIncoming(Results[J].second, HotBB);
+          break;
+        }
+    }
+
+    Builder.SetInsertPoint(PeelBB);
+    TableBB = PeelBB;
+    ++NumPeeledSwitchCases;
+  }
+
+  // Compute the table index value.
   Value *TableIndex = Builder.CreateSub(SI->getCondition(), MinCaseVal,
                                         "switch.tableidx");
 
@@ -3772,6 +3855,15 @@ static bool SwitchToLookupTable(SwitchInst *SI,
     Value *Cmp = Builder.CreateICmpULT(TableIndex, ConstantInt::get(
                                          MinCaseVal->getType(), TableSize));
     Builder.CreateCondBr(Cmp, LookupBB, SI->getDefaultDest());
+
+    // After peeling, the default destination is reached from the last peel
+    // block instead of the switch block.
+    if (TableBB != SI->getParent())
+      for (BasicBlock::iterator I = SI->getDefaultDest()->begin();
+           PHINode *PN = dyn_cast<PHINode>(I); ++I)
+        for (unsigned i = 0, e = PN->getNumIncomingValues(); i != e; ++i)
+          if (PN->getIncomingBlock(i) == SI->getParent())
+            PN->setIncomingBlock(i, TableBB);
   }
 
   // Populate the BB that does the lookups.
@@ -42,6 +42,13 @@ Value *llvm::MapValue(const Value *V, ValueToValueMapTy &VM, RemapFlags Flags,
   // are using the identity mapping.
   if (isa<GlobalValue>(V) || isa<MDString>(V))
     return VM[V] = const_cast<Value*>(V);
+
+  // Constants without operands, like ConstantInt, map to themselves unless
+  // their type is remapped.  They are most of the operands of cloned code, so
+  // don't make the map track each of them.
+  if (!TypeMapper && isa<Constant>(V) &&
+      cast<Constant>(V)->getNumOperands() == 0)
+    return const_cast<Value*>(V);
   
   if (const InlineAsm *IA = dyn_cast<InlineAsm>(V)) {
     // Inline asm may need *type* remapping.
@@ -130,7 +137,7 @@ Value *llvm::MapValue(const Value *V, ValueToValueMapTy &VM, RemapFlags Flags,
   for (; OpNo != NumOperands; ++OpNo) {
     Value *Op = C->getOperand(OpNo);
     Mapped = MapValue(Op, VM, Flags, TypeMapper, Materializer);
-    if (Mapped != C) break;
+    if (Mapped != Op) break;
   }
   
   // See if the type mapper wants to remap the type as well.
@@ -207,9 +214,22 @@ void llvm::RemapInstruction(Instruction *I, ValueToValueMapTy &VMap,
     }
   }
 
+  // Remap the debug location through its compact form, so that no DILocation
+  // node is built and kept alive for every instruction mapped.
+  DebugLoc DL = I->getDebugLoc();
+  if (!DL.isUnknown()) {
+    MDNode *Scope, *IA;
+    DL.getScopeAndInlinedAt(Scope, IA, I->getContext());
+    MDNode *NewScope = MapValue(Scope, VMap, Flags, TypeMapper, Materializer);
+    MDNode *NewIA =
+      IA ? MapValue(IA, VMap, Flags, TypeMapper, Materializer) : 0;
+    if (NewScope != Scope || NewIA != IA)
+      I->setDebugLoc(DebugLoc::get(DL.getLine(), DL.getCol(), NewScope, NewIA));
+  }
+
   // Remap attached metadata.
   SmallVector<std::pair<unsigned, MDNode *>, 4> MDs;
-  I->getAllMetadata(MDs);
+  I->getAllMetadataOtherThanDebugLoc(MDs);
   for (SmallVectorImpl<std::pair<unsigned, MDNode *> >::iterator
        MI = MDs.begin(), ME = MDs.end(); MI != ME; ++MI) {
     MDNode *Old = MI->second;
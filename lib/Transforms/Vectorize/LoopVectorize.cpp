@@ -117,6 +117,29 @@ TinyTripCountVectorThreshold("vectorizer-min-trip-count", cl::init(16),
 /// We don't unroll loops with a known constant trip count below this number.
 static const unsigned TinyTripCountUnrollThreshold = 128;
 
+/// When the trip count is a known constant, charge each vectorization factor
+/// for the iterations left over for the scalar epilogue.
+static cl::opt<bool>
+EpilogueAwareVF("vectorizer-epilogue-aware-vf", cl::init(true), cl::Hidden,
+                cl::desc("Account for the scalar remainder loop when choosing "
+                         "the vectorization factor of a loop with a constant "
+                         "trip count."));
+
+/// Vectorize groups of strided accesses that together cover every element,
+/// such as the fields of an array of structs, with one wide access and
+/// shuffles instead of scalarizing each of them.
+static cl::opt<bool>
+EnableInterleavedMemAccesses("enable-interleaved-mem-accesses",
+                             cl::init(true), cl::Hidden,
+                             cl::desc("Vectorize interleaved groups of strided "
+                                      "loads and stores."));
+
+static cl::opt<unsigned>
+MaxInterleaveGroupFactor("max-interleave-group-factor", cl::init(4),
+                         cl::Hidden,
+                         cl::desc("Maximum stride, in elements, of an "
+                                  "interleaved group of accesses."));
+
 /// When performing memory disambiguation checks at runtime do not make more
 /// than this number of comparisons.
 static const unsigned RuntimeMemoryCheckThreshold = 8;
@@ -232,6 +255,11 @@ protected:
   virtual void vectorizeMemoryInstruction(Instruction *Instr,
                                   LoopVectorizationLegality *Legal);
 
+  /// Emit the wide access and the shuffles of the interleaved group that
+  /// Instr belongs to, if Instr is the group's insert position.
+  void vectorizeInterleaveGroup(Instruction *Instr,
+                                LoopVectorizationLegality *Legal);
+
   /// Create a broadcast instruction. This method generates a broadcast
   /// instruction (shuffle) for loop invariant values and for the induction
   /// value. If this is the induction variable then we extend it to N, N+1, ...
@@ -496,12 +524,38 @@ public:
       Ends.clear();
       IsWritePtr.clear();
       DependencySetId.clear();
+      Groups.clear();
     }
 
     /// Insert a pointer and calculate the start and end SCEVs.
     void insert(ScalarEvolution *SE, Loop *Lp, Value *Ptr, bool WritePtr,
                 unsigned DepSetId);
 
+    /// A set of pointers whose ranges are checked as one interval.
+    struct CheckingPtrGroup {
+      /// The lowest start and highest end of the members.
+      const SCEV *Low, *High;
+      /// Indices into Pointers of the members.
+      SmallVector<unsigned, 2> Members;
+    };
+
+    /// Partition the pointers into Groups.  Pointers into the same object
+    /// that advance by the same positive constant stride, such as a[i-1],
+    /// a[i] and a[i+1], are merged as long as no check between them is
+    /// needed, so that the other pointers are checked against their combined
+    /// range once instead of against each of them.
+    void groupChecks(ScalarEvolution *SE, Loop *Lp);
+
+    /// Return true if the ranges of pointers I and J must be checked.
+    bool needsChecking(unsigned I, unsigned J) const;
+
+    /// Return true if the ranges of groups M and N must be checked.
+    bool needsChecking(const CheckingPtrGroup &M,
+                       const CheckingPtrGroup &N) const;
+
+    /// Return the number of group pairs that must be checked.
+    unsigned getNumberOfChecks() const;
+
     /// This flag indicates if we need to add the runtime check.
     bool Need;
     /// Holds the pointers that we need to check.
@@ -515,6 +569,34 @@ public:
     /// Holds the id of the set of pointers that could be dependent because of a
     /// shared underlying object.
     SmallVector<unsigned, 2> DependencySetId;
+    /// Holds the groups built by groupChecks.
+    SmallVector<CheckingPtrGroup, 2> Groups;
+  };
+
+  /// A complete group of loads or stores with the same constant stride of
+  /// Factor elements, whose members access consecutive elements of each
+  /// stride, e.g. the re and im fields of an array of complex numbers. The
+  /// group is vectorized as one wide access of Factor * VF elements.
+  struct InterleaveGroup {
+    InterleaveGroup() : Factor(0), Align(0), InsertPos(0) {}
+
+    /// Return the offset, in elements, of member I from the first member.
+    unsigned getIndex(const Instruction *I) const {
+      for (unsigned Idx = 0; Idx < Factor; ++Idx)
+        if (Members[Idx] == I)
+          return Idx;
+      llvm_unreachable("Instruction is not a member of the group");
+    }
+
+    /// The stride of every member, which is also the number of members.
+    unsigned Factor;
+    /// The alignment of the first member, where the wide access starts.
+    unsigned Align;
+    /// The members, ordered by address.
+    SmallVector<Instruction*, 4> Members;
+    /// Where the wide access is emitted: the first member in program order
+    /// for loads and the last one for stores.
+    Instruction *InsertPos;
   };
 
   /// A struct for saving information about induction variables.
@@ -575,6 +657,14 @@ public:
   /// Returns true if this instruction will remain scalar after vectorization.
   bool isUniformAfterVectorization(Instruction* I) { return Uniforms.count(I); }
 
+  /// Returns the interleaved group that the load or store I belongs to, or
+  /// null if it is not part of one.
+  const InterleaveGroup *getInterleaveGroup(Instruction *I) const {
+    DenseMap<Instruction*, unsigned>::const_iterator It =
+      InterleaveGroupMap.find(I);
+    return It == InterleaveGroupMap.end() ? 0 : &InterleaveGroups[It->second];
+  }
+
   /// Returns the information that we collected about runtime memory check.
   RuntimePointerCheck *getRuntimePointerCheck() { return &PtrRtCheck; }
 
@@ -603,6 +693,10 @@ private:
   /// Collect the variables that need to stay uniform after vectorization.
   void collectLoopUniforms();
 
+  /// Find the groups of strided accesses that can be vectorized as
+  /// interleaved groups.
+  void analyzeInterleaving();
+
   /// Return true if all of the instructions in the block can be speculatively
   /// executed. \p SafePtrs is a list of addresses that are known to be legal
   /// and we know that we can read from them without segfault.
@@ -664,6 +758,11 @@ private:
   bool HasFunNoNaNAttr;
 
   unsigned MaxSafeDepDistBytes;
+
+  /// The interleaved groups found by analyzeInterleaving.
+  SmallVector<InterleaveGroup, 4> InterleaveGroups;
+  /// Maps each member of a group to its index in InterleaveGroups.
+  DenseMap<Instruction*, unsigned> InterleaveGroupMap;
 };
 
 /// LoopVectorizationCostModel - estimates the expected speedups due to
@@ -1050,6 +1149,102 @@ LoopVectorizationLegality::RuntimePointerCheck::insert(ScalarEvolution *SE,
   DependencySetId.push_back(DepSetId);
 }
 
+bool LoopVectorizationLegality::RuntimePointerCheck::needsChecking(
+    unsigned I, unsigned J) const {
+  // No need to check if two readonly pointers intersect.
+  if (!IsWritePtr[I] && !IsWritePtr[J])
+    return false;
+
+  // Only need to check pointers between two different dependency sets.
+  return DependencySetId[I] != DependencySetId[J];
+}
+
+bool LoopVectorizationLegality::RuntimePointerCheck::needsChecking(
+    const CheckingPtrGroup &M, const CheckingPtrGroup &N) const {
+  for (unsigned I = 0, EI = M.Members.size(); I != EI; ++I)
+    for (unsigned J = 0, EJ = N.Members.size(); J != EJ; ++J)
+      if (needsChecking(M.Members[I], N.Members[J]))
+        return true;
+  return false;
+}
+
+unsigned LoopVectorizationLegality::RuntimePointerCheck::getNumberOfChecks()
+    const {
+  unsigned NumChecks = 0;
+  for (unsigned I = 0, E = Groups.size(); I != E; ++I)
+    for (unsigned J = I + 1; J != E; ++J)
+      if (needsChecking(Groups[I], Groups[J]))
+        ++NumChecks;
+  return NumChecks;
+}
+
+/// Return the constant positive stride of the pointer with SCEV \p Sc in
+/// loop \p Lp, or null.
+static const SCEVConstant *getPositiveConstantStride(ScalarEvolution *SE,
+                                                     const SCEV *Sc, Loop *Lp) {
+  const SCEVAddRecExpr *AR = dyn_cast<SCEVAddRecExpr>(Sc);
+  if (!AR || AR->getLoop() != Lp)
+    return 0;
+  const SCEVConstant *Step =
+    dyn_cast<SCEVConstant>(AR->getStepRecurrence(*SE));
+  if (!Step || !Step->getValue()->getValue().isStrictlyPositive())
+    return 0;
+  return Step;
+}
+
+void LoopVectorizationLegality::RuntimePointerCheck::groupChecks(
+    ScalarEvolution *SE, Loop *Lp) {
+  Groups.clear();
+  for (unsigned I = 0, E = Pointers.size(); I != E; ++I) {
+    const SCEV *Sc = SE->getSCEV(Pointers[I]);
+    const SCEVConstant *Step = getPositiveConstantStride(SE, Sc, Lp);
+    unsigned AS = Pointers[I]->getType()->getPointerAddressSpace();
+
+    bool Merged = false;
+    for (unsigned G = 0, GE = Groups.size(); Step && G != GE && !Merged; ++G) {
+      CheckingPtrGroup &Group = Groups[G];
+      unsigned Leader = Group.Members[0];
+      if (Pointers[Leader]->getType()->getPointerAddressSpace() != AS ||
+          getPositiveConstantStride(SE, SE->getSCEV(Pointers[Leader]), Lp) !=
+            Step)
+        continue;
+
+      // Merging hides the checks between the new member and the group.
+      bool Independent = true;
+      for (unsigned M = 0, ME = Group.Members.size(); M != ME; ++M)
+        if (needsChecking(I, Group.Members[M])) {
+          Independent = false;
+          break;
+        }
+      if (!Independent)
+        continue;
+
+      // With equal strides and trip counts, the start and end offsets from
+      // the group's bounds are the same constant.
+      const SCEVConstant *LowDiff =
+        dyn_cast<SCEVConstant>(SE->getMinusSCEV(Starts[I], Group.Low));
+      const SCEVConstant *HighDiff =
+        dyn_cast<SCEVConstant>(SE->getMinusSCEV(Ends[I], Group.High));
+      if (!LowDiff || !HighDiff)
+        continue;
+
+      if (LowDiff->getValue()->isNegative())
+        Group.Low = Starts[I];
+      if (HighDiff->getValue()->getValue().isStrictlyPositive())
+        Group.High = Ends[I];
+      Group.Members.push_back(I);
+      Merged = true;
+    }
+
+    if (!Merged) {
+      Groups.push_back(CheckingPtrGroup());
+      Groups.back().Low = Starts[I];
+      Groups.back().High = Ends[I];
+      Groups.back().Members.push_back(I);
+    }
+  }
+}
+
 Value *InnerLoopVectorizer::getBroadcastInstrs(Value *V) {
   // We need to place the broadcast of invariant variables outside the loop.
   Instruction *Instr = dyn_cast<Instruction>(V);
@@ -1216,8 +1411,105 @@ Value *InnerLoopVectorizer::reverseVector(Value *Vec) {
 }
 
 
+/// Concatenate the vectors in Vecs, which all have the same type, into one
+/// vector. If their number is not a power of two the result has undefined
+/// lanes at the end.
+static Value *concatenateVectors(IRBuilder<> &Builder,
+                                 SmallVectorImpl<Value*> &Vecs) {
+  SmallVector<Value*, 4> Parts(Vecs.begin(), Vecs.end());
+  while (Parts.size() > 1) {
+    SmallVector<Value*, 4> Merged;
+    for (unsigned i = 0, e = Parts.size(); i < e; i += 2) {
+      Value *V0 = Parts[i];
+      unsigned NumElts = V0->getType()->getVectorNumElements();
+      Value *V1 = i + 1 < e ? Parts[i + 1] : UndefValue::get(V0->getType());
+      SmallVector<Constant*, 16> Mask;
+      for (unsigned j = 0; j < 2 * NumElts; ++j)
+        Mask.push_back(Builder.getInt32(j));
+      Merged.push_back(Builder.CreateShuffleVector(V0, V1,
+                                                   ConstantVector::get(Mask)));
+    }
+    Parts.swap(Merged);
+  }
+  return Parts[0];
+}
+
+void InnerLoopVectorizer::vectorizeInterleaveGroup(Instruction *Instr,
+                                             LoopVectorizationLegality *Legal) {
+  const LoopVectorizationLegality::InterleaveGroup *Group =
+    Legal->getInterleaveGroup(Instr);
+  // The whole group is emitted at its insert position.
+  if (Instr != Group->InsertPos)
+    return;
+
+  LoadInst *LI = dyn_cast<LoadInst>(Instr);
+  Value *Ptr = LI ? LI->getPointerOperand() :
+                    cast<StoreInst>(Instr)->getPointerOperand();
+  Type *ScalarTy = Ptr->getType()->getPointerElementType();
+  unsigned Factor = Group->Factor;
+  unsigned Index = Group->getIndex(Instr);
+  Type *WideTy = VectorType::get(ScalarTy, Factor * VF);
+  unsigned AddressSpace = Ptr->getType()->getPointerAddressSpace();
+  Constant *Zero = Builder.getInt32(0);
+
+  // Lane zero of each part points at member Index of the first tuple of the
+  // part. The wide access starts Index elements before that.
+  setDebugLocFromInst(Builder, Instr);
+  VectorParts &PtrParts = getVectorValue(Ptr);
+  SmallVector<Value*, 2> WidePtrs;
+  for (unsigned Part = 0; Part < UF; ++Part) {
+    Value *NewPtr = Builder.CreateExtractElement(PtrParts[Part], Zero);
+    NewPtr = Builder.CreateGEP(NewPtr, Builder.getInt32(-(int)Index));
+    WidePtrs.push_back(
+      Builder.CreateBitCast(NewPtr, WideTy->getPointerTo(AddressSpace)));
+  }
+
+  if (LI) {
+    for (unsigned Part = 0; Part < UF; ++Part) {
+      LoadInst *WideLoad = Builder.CreateLoad(WidePtrs[Part], "wide.vec");
+      WideLoad->setAlignment(Group->Align);
+      // Member I reads every Factor'th lane starting at I.
+      for (unsigned I = 0; I < Factor; ++I) {
+        SmallVector<Constant*, 16> Mask;
+        for (unsigned i = 0; i < VF; ++i)
+          Mask.push_back(Builder.getInt32(I + i * Factor));
+        WidenMap.get(Group->Members[I])[Part] =
+          Builder.CreateShuffleVector(WideLoad, UndefValue::get(WideTy),
+                                      ConstantVector::get(Mask),
+                                      "strided.vec");
+      }
+    }
+    return;
+  }
+
+  for (unsigned Part = 0; Part < UF; ++Part) {
+    SmallVector<Value*, 4> StoredVecs;
+    for (unsigned I = 0; I < Factor; ++I) {
+      StoreInst *Member = cast<StoreInst>(Group->Members[I]);
+      StoredVecs.push_back(getVectorValue(Member->getValueOperand())[Part]);
+    }
+
+    // Interleave the members: lane j of member I goes to lane j * Factor + I.
+    Value *Concat = concatenateVectors(Builder, StoredVecs);
+    SmallVector<Constant*, 16> Mask;
+    for (unsigned i = 0; i < VF; ++i)
+      for (unsigned I = 0; I < Factor; ++I)
+        Mask.push_back(Builder.getInt32(I * VF + i));
+    Value *Interleaved =
+      Builder.CreateShuffleVector(Concat, UndefValue::get(Concat->getType()),
+                                  ConstantVector::get(Mask),
+                                  "interleaved.vec");
+    Builder.CreateStore(Interleaved, WidePtrs[Part])
+      ->setAlignment(Group->Align);
+  }
+}
+
 void InnerLoopVectorizer::vectorizeMemoryInstruction(Instruction *Instr,
                                              LoopVectorizationLegality *Legal) {
+  // Members of an interleaved group are emitted together.
+  if (Legal->getInterleaveGroup(Instr))
+    return vectorizeInterleaveGroup(Instr, Legal);
+
   // Attempt to issue a wide load.
   LoadInst *LI = dyn_cast<LoadInst>(Instr);
   StoreInst *SI = dyn_cast<StoreInst>(Instr);
@@ -1436,15 +1728,18 @@ InnerLoopVectorizer::addRuntimeCheck(LoopVectorizationLegality *Legal,
   if (!PtrRtCheck->Need)
     return NULL;
 
-  unsigned NumPointers = PtrRtCheck->Pointers.size();
+  typedef LoopVectorizationLegality::RuntimePointerCheck::CheckingPtrGroup
+    CheckingPtrGroup;
+  const SmallVectorImpl<CheckingPtrGroup> &Groups = PtrRtCheck->Groups;
+  unsigned NumGroups = Groups.size();
   SmallVector<TrackingVH<Value> , 2> Starts;
   SmallVector<TrackingVH<Value> , 2> Ends;
 
   LLVMContext &Ctx = Loc->getContext();
   SCEVExpander Exp(*SE, "induction");
 
-  for (unsigned i = 0; i < NumPointers; ++i) {
-    Value *Ptr = PtrRtCheck->Pointers[i];
+  for (unsigned i = 0; i < NumGroups; ++i) {
+    Value *Ptr = PtrRtCheck->Pointers[Groups[i].Members[0]];
     const SCEV *Sc = SE->getSCEV(Ptr);
 
     if (SE->isLoopInvariant(Sc, OrigLoop)) {
@@ -1459,8 +1754,8 @@ InnerLoopVectorizer::addRuntimeCheck(LoopVectorizationLegality *Legal,
       // Use this type for pointer arithmetic.
       Type *PtrArithTy = Type::getInt8PtrTy(Ctx, AS);
 
-      Value *Start = Exp.expandCodeFor(PtrRtCheck->Starts[i], PtrArithTy, Loc);
-      Value *End = Exp.expandCodeFor(PtrRtCheck->Ends[i], PtrArithTy, Loc);
+      Value *Start = Exp.expandCodeFor(Groups[i].Low, PtrArithTy, Loc);
+      Value *End = Exp.expandCodeFor(Groups[i].High, PtrArithTy, Loc);
       Starts.push_back(Start);
       Ends.push_back(End);
     }
@@ -1469,16 +1764,11 @@ InnerLoopVectorizer::addRuntimeCheck(LoopVectorizationLegality *Legal,
   IRBuilder<> ChkBuilder(Loc);
   // Our instructions might fold to a constant.
   Value *MemoryRuntimeCheck = 0;
-  for (unsigned i = 0; i < NumPointers; ++i) {
-    for (unsigned j = i+1; j < NumPointers; ++j) {
-      // No need to check if two readonly pointers intersect.
-      if (!PtrRtCheck->IsWritePtr[i] && !PtrRtCheck->IsWritePtr[j])
+  for (unsigned i = 0; i < NumGroups; ++i) {
+    for (unsigned j = i+1; j < NumGroups; ++j) {
+      if (!PtrRtCheck->needsChecking(Groups[i], Groups[j]))
         continue;
 
-      // Only need to check pointers between two different dependency sets.
-      if (PtrRtCheck->DependencySetId[i] == PtrRtCheck->DependencySetId[j])
-       continue;
-
       unsigned AS0 = Starts[i]->getType()->getPointerAddressSpace();
       unsigned AS1 = Starts[j]->getType()->getPointerAddressSpace();
 
@@ -2875,7 +3165,11 @@ bool LoopVectorizationLegality::canVectorize() {
   if (!TheLoop->getLoopPreheader())
     return false;
 
-  // We can only vectorize innermost loops.
+  // We can only vectorize innermost loops.  InnerLoopVectorizer widens a
+  // single-latch body and if-converts everything in it, which has no meaning
+  // for a body that contains a loop.  Inner loops with a small constant trip
+  // count are fully unrolled earlier in the pipeline, which turns their parent
+  // into an innermost loop that can be vectorized here.
   if (TheLoop->getSubLoopsVector().size())
     return false;
 
@@ -2929,6 +3223,9 @@ bool LoopVectorizationLegality::canVectorize() {
   // Collect all of the variables that remain uniform after vectorization.
   collectLoopUniforms();
 
+  if (EnableInterleavedMemAccesses)
+    analyzeInterleaving();
+
   DEBUG(dbgs() << "LV: We can vectorize this loop" <<
         (PtrRtCheck.Need ? " (with a runtime bound check)" : "")
         <<"!\n");
@@ -3273,7 +3570,7 @@ static bool hasComputableBounds(ScalarEvolution *SE, Value *Ptr) {
 /// \brief Check the stride of the pointer and ensure that it does not wrap in
 /// the address space.
 static int isStridedPtr(ScalarEvolution *SE, DataLayout *DL, Value *Ptr,
-                        const Loop *Lp);
+                        const Loop *Lp, bool CheckWrap = true);
 
 bool AccessAnalysis::canCheckPtrAtRT(
                        LoopVectorizationLegality::RuntimePointerCheck &RtCheck,
@@ -3333,7 +3630,10 @@ bool AccessAnalysis::canCheckPtrAtRT(
 
   if (IsDepCheckNeeded && CanDoRT && RunningDepId == 2)
     NumComparisons = 0; // Only one dependence set.
-  else {
+  else if (CanDoRT) {
+    RtCheck.groupChecks(SE, TheLoop);
+    NumComparisons = RtCheck.getNumberOfChecks();
+  } else {
     NumComparisons = (NumWritePtrChecks * (NumReadPtrChecks +
                                            NumWritePtrChecks - 1));
   }
@@ -3577,8 +3877,11 @@ static bool isInBoundsGep(Value *Ptr) {
 }
 
 /// \brief Check whether the access through \p Ptr has a constant stride.
+/// If CheckWrap is false, non-unit strides of inbounds or address space zero
+/// pointers are accepted even if the recurrence may wrap; the caller has to
+/// make sure that it only accesses what the scalar loop does.
 static int isStridedPtr(ScalarEvolution *SE, DataLayout *DL, Value *Ptr,
-                        const Loop *Lp) {
+                        const Loop *Lp, bool CheckWrap) {
   const Type *Ty = Ptr->getType();
   assert(Ty->isPointerTy() && "Unexpected non-ptr");
 
@@ -3649,7 +3952,7 @@ static int isStridedPtr(ScalarEvolution *SE, DataLayout *DL, Value *Ptr,
   // If the SCEV could wrap but we have an inbounds gep with a unit stride we
   // know we can't "wrap around the address space". In case of address space
   // zero we know that this won't happen without triggering undefined behavior.
-  if (!IsNoWrapAddRec && (IsInBoundsGEP || IsInAddressSpaceZero) &&
+  if (CheckWrap && !IsNoWrapAddRec && (IsInBoundsGEP || IsInAddressSpaceZero) &&
       Stride != 1 && Stride != -1)
     return 0;
 
@@ -3712,6 +4015,27 @@ bool MemoryDepChecker::isDependent(const MemAccessInfo &A, unsigned AIdx,
   int StrideAPtr = isStridedPtr(SE, DL, APtr, InnermostLoop);
   int StrideBPtr = isStridedPtr(SE, DL, BPtr, InnermostLoop);
 
+  // Accesses with the same stride whose distance is not a multiple of it, such
+  // as the members of an interleaved group, never touch the same element.
+  if (EnableInterleavedMemAccesses) {
+    int Stride = isStridedPtr(SE, DL, APtr, InnermostLoop, false);
+    const SCEVConstant *C =
+      dyn_cast<SCEVConstant>(SE->getMinusSCEV(BScev, AScev));
+    int64_t Size =
+      DL->getTypeAllocSize(APtr->getType()->getPointerElementType());
+    if ((Stride > 1 || Stride < -1) &&
+        Stride == isStridedPtr(SE, DL, BPtr, InnermostLoop, false) &&
+        C && C->getValue()->getValue().getMinSignedBits() <= 64 &&
+        Size == (int64_t)DL->getTypeAllocSize(
+                    BPtr->getType()->getPointerElementType())) {
+      int64_t Val = C->getValue()->getSExtValue();
+      if (Val % Size == 0 && (Val / Size) % Stride != 0) {
+        DEBUG(dbgs() << "LV: Strided accesses are independent\n");
+        return false;
+      }
+    }
+  }
+
   const SCEV *Src = AScev;
   const SCEV *Sink = BScev;
 
@@ -4086,6 +4410,151 @@ static bool areAllUsesIn(Instruction *I, SmallPtrSet<Instruction *, 8> &Set) {
   return true;
 }
 
+/// Return the pointer operand of the load or store I.
+static Value *getMemInstPointer(Instruction *I) {
+  if (LoadInst *LI = dyn_cast<LoadInst>(I))
+    return LI->getPointerOperand();
+  return cast<StoreInst>(I)->getPointerOperand();
+}
+
+/// Return the alignment of the load or store I, which is the ABI alignment of
+/// the accessed type if none is given.
+static unsigned getMemInstAlignment(DataLayout *DL, Instruction *I) {
+  unsigned Align = isa<LoadInst>(I) ? cast<LoadInst>(I)->getAlignment()
+                                    : cast<StoreInst>(I)->getAlignment();
+  if (!Align)
+    Align = DL->getABITypeAlignment(
+        getMemInstPointer(I)->getType()->getPointerElementType());
+  return Align;
+}
+
+void LoopVectorizationLegality::analyzeInterleaving() {
+  for (Loop::block_iterator BI = TheLoop->block_begin(),
+       BE = TheLoop->block_end(); BI != BE; ++BI) {
+    BasicBlock *BB = *BI;
+    // The members of a group are moved to a single point, which would have to
+    // be predicated as well.
+    if (blockNeedsPredication(BB))
+      continue;
+
+    // Collect the strided accesses of the block in program order.
+    SmallVector<Instruction*, 16> Accesses;
+    SmallVector<unsigned, 16> Strides;
+    for (BasicBlock::iterator I = BB->begin(), E = BB->end(); I != E; ++I) {
+      if (LoadInst *LI = dyn_cast<LoadInst>(I)) {
+        if (!LI->isSimple())
+          continue;
+      } else if (StoreInst *SI = dyn_cast<StoreInst>(I)) {
+        if (!SI->isSimple())
+          continue;
+      } else
+        continue;
+
+      Value *Ptr = getMemInstPointer(I);
+      Type *EltTy = Ptr->getType()->getPointerElementType();
+      if (EltTy->isPointerTy() || !VectorType::isValidElementType(EltTy) ||
+          DL->getTypeAllocSizeInBits(EltTy) != DL->getTypeSizeInBits(EltTy))
+        continue;
+
+      // Only complete groups are formed, so their wide accesses cannot wrap
+      // where the scalar accesses do not.
+      int Stride = isStridedPtr(SE, DL, Ptr, TheLoop, /*CheckWrap=*/false);
+      if (Stride < 2 || (unsigned)Stride > MaxInterleaveGroupFactor ||
+          cast<SCEVAddRecExpr>(SE->getSCEV(Ptr))->getLoop() != TheLoop)
+        continue;
+
+      Accesses.push_back(I);
+      Strides.push_back(Stride);
+    }
+
+    SmallPtrSet<Instruction*, 16> Grouped;
+    for (unsigned A = 0, E = Accesses.size(); A != E; ++A) {
+      Instruction *First = Accesses[A];
+      if (Grouped.count(First))
+        continue;
+
+      bool IsLoad = isa<LoadInst>(First);
+      unsigned Factor = Strides[A];
+      Type *EltTy =
+        getMemInstPointer(First)->getType()->getPointerElementType();
+      int64_t Size = DL->getTypeAllocSize(EltTy);
+      const SCEV *FirstPtr = SE->getSCEV(getMemInstPointer(First));
+
+      // Candidates by their offset, in elements, from First. Only offsets in
+      // (-Factor, Factor) can belong to the same group.
+      SmallVector<Instruction*, 8> ByOffset(2 * Factor - 1, 0);
+      ByOffset[Factor - 1] = First;
+      unsigned NumCandidates = 1;
+      Instruction *Last = First;
+      for (unsigned B = A + 1; B != E; ++B) {
+        Instruction *Other = Accesses[B];
+        if (Grouped.count(Other) || isa<LoadInst>(Other) != IsLoad ||
+            Strides[B] != Factor)
+          continue;
+        Value *OtherPtr = getMemInstPointer(Other);
+        if (OtherPtr->getType()->getPointerElementType() != EltTy)
+          continue;
+
+        const SCEVConstant *Dist = dyn_cast<SCEVConstant>(
+            SE->getMinusSCEV(SE->getSCEV(OtherPtr), FirstPtr));
+        if (!Dist || Dist->getValue()->getValue().getMinSignedBits() > 64)
+          continue;
+        int64_t Offset = Dist->getValue()->getSExtValue();
+        if (Offset % Size)
+          continue;
+        Offset /= Size;
+        if (Offset <= -(int64_t)Factor || Offset >= (int64_t)Factor)
+          continue;
+
+        // Keep the first of several accesses to the same element.
+        Instruction *&Slot = ByOffset[Offset + Factor - 1];
+        if (Slot)
+          continue;
+        Slot = Other;
+        Last = Other;
+        ++NumCandidates;
+      }
+
+      // The group must access every element of the stride exactly once, so
+      // that the wide access touches nothing the scalar loop does not.
+      if (NumCandidates != Factor)
+        continue;
+      unsigned Lo = 0;
+      while (!ByOffset[Lo])
+        ++Lo;
+      if (std::find(ByOffset.begin() + Lo, ByOffset.begin() + Lo + Factor,
+                    (Instruction*)0) != ByOffset.begin() + Lo + Factor)
+        continue;
+
+      // Loads are hoisted to the first member and stores sunk to the last.
+      // No other access that could conflict may be crossed on the way.
+      SmallPtrSet<Instruction*, 8> Members(ByOffset.begin() + Lo,
+                                           ByOffset.begin() + Lo + Factor);
+      bool Safe = true;
+      for (BasicBlock::iterator I = First, E = Last; I != E && Safe; ++I)
+        if (!Members.count(I) &&
+            (IsLoad ? I->mayWriteToMemory() : I->mayReadOrWriteMemory()))
+          Safe = false;
+      if (!Safe)
+        continue;
+
+      InterleaveGroup G;
+      G.Factor = Factor;
+      G.Members.append(ByOffset.begin() + Lo, ByOffset.begin() + Lo + Factor);
+      G.Align = getMemInstAlignment(DL, G.Members[0]);
+      G.InsertPos = IsLoad ? First : Last;
+      for (unsigned i = 0; i < Factor; ++i) {
+        Grouped.insert(G.Members[i]);
+        InterleaveGroupMap[G.Members[i]] = InterleaveGroups.size();
+      }
+      InterleaveGroups.push_back(G);
+      DEBUG(dbgs() << "LV: Found an interleaved group of " << Factor
+                   << (IsLoad ? " loads" : " stores") << " at "
+                   << *G.InsertPos << '\n');
+    }
+  }
+}
+
 bool LoopVectorizationLegality::AddReductionVar(PHINode *Phi,
                                                 ReductionKind Kind) {
   if (Phi->getNumIncomingValues() != 2)
@@ -4469,8 +4938,8 @@ LoopVectorizationCostModel::selectVectorizationFactor(bool OptForSize,
     MaxVectorSize = 1;
   }
 
-  assert(MaxVectorSize <= 32 && "Did not expect to pack so many elements"
-         " into one vector!");
+  assert(MaxVectorSize <= MaxVectorWidth && "Did not expect to pack so many "
+         "elements into one vector!");
 
   unsigned VF = MaxVectorSize;
 
@@ -4504,25 +4973,40 @@ LoopVectorizationCostModel::selectVectorizationFactor(bool OptForSize,
     return Factor;
   }
 
-  float Cost = expectedCost(1);
+  unsigned ScalarCost = expectedCost(1);
+  float Cost = ScalarCost;
   unsigned Width = 1;
+  unsigned LoopCost = ScalarCost;
   DEBUG(dbgs() << "LV: Scalar loop costs: " << (int)Cost << ".\n");
   for (unsigned i=2; i <= VF; i*=2) {
     // Notice that the vector loop needs to be executed less times, so
     // we need to divide the cost of the vector loops by the width of
     // the vector elements.
-    float VectorCost = expectedCost(i) / (float)i;
+    unsigned VectorLoopCost = expectedCost(i);
+    float VectorCost = VectorLoopCost / (float)i;
+
+    // With a short constant trip count, the TC % i iterations left to the
+    // scalar epilogue can outweigh the faster vector body, e.g. a trip count
+    // of 20 runs two iterations of an 8-wide body and four scalar ones, but
+    // five iterations of a 4-wide body and no scalar ones.  Average the cost
+    // of both loops over all TC iterations instead.  Larger trip counts are
+    // unrolled, so the remainder is not known here; its share of the cost is
+    // small anyway.
+    if (EpilogueAwareVF && TC && TC < TinyTripCountUnrollThreshold)
+      VectorCost = ((TC / i) * VectorCost * i + (TC % i) * ScalarCost) / TC;
+
     DEBUG(dbgs() << "LV: Vector loop of width " << i << " costs: " <<
           (int)VectorCost << ".\n");
     if (VectorCost < Cost) {
       Cost = VectorCost;
       Width = i;
+      LoopCost = VectorLoopCost;
     }
   }
 
   DEBUG(dbgs() << "LV: Selecting VF = : "<< Width << ".\n");
   Factor.Width = Width;
-  Factor.Cost = Width * Cost;
+  Factor.Cost = LoopCost;
   return Factor;
 }
 
@@ -4956,6 +5440,17 @@ LoopVectorizationCostModel::getInstructionCost(Instruction *I, unsigned VF) {
       return TTI.getAddressComputationCost(VectorTy) +
         TTI.getMemoryOpCost(I->getOpcode(), VectorTy, Alignment, AS);
 
+    // Interleaved groups are charged in full at their insert position.
+    if (const LoopVectorizationLegality::InterleaveGroup *Group =
+          Legal->getInterleaveGroup(I)) {
+      if (I != Group->InsertPos)
+        return 0;
+      Type *WideTy = VectorType::get(ValTy, Group->Factor * VF);
+      return TTI.getAddressComputationCost(WideTy) +
+        TTI.getInterleavedMemoryOpCost(I->getOpcode(), WideTy, Group->Factor,
+                                       Group->Align, AS);
+    }
+
     // Scalarized loads/stores.
     int ConsecutiveStride = Legal->isConsecutivePtr(Ptr);
     bool Reverse = ConsecutiveStride < 0;
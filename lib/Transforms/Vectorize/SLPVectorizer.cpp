@@ -55,6 +55,11 @@ static cl::opt<bool>
 ShouldVectorizeHor("slp-vectorize-hor", cl::init(false), cl::Hidden,
                    cl::desc("Attempt to vectorize horizontal reductions"));
 
+static cl::opt<unsigned>
+MaxVectorRegSizeOption("slp-max-reg-size", cl::init(128), cl::Hidden,
+    cl::desc("Attempt to vectorize store chains for vector registers up to "
+             "this many bits wide, if the target has them"));
+
 static cl::opt<bool> ShouldStartVectorizeHorAtStore(
     "slp-vectorize-hor-store", cl::init(false), cl::Hidden,
     cl::desc(
@@ -1770,6 +1775,10 @@ struct SLPVectorizer : public FunctionPass {
   LoopInfo *LI;
   DominatorTree *DT;
 
+  /// The widest vector register, in bits, that store chains are vectorized
+  /// for.  Never less than MinVecRegSize.
+  unsigned MaxVecRegSize;
+
   virtual bool runOnFunction(Function &F) {
     SE = &getAnalysis<ScalarEvolution>();
     DL = getAnalysisIfAvailable<DataLayout>();
@@ -1777,6 +1786,9 @@ struct SLPVectorizer : public FunctionPass {
     AA = &getAnalysis<AliasAnalysis>();
     LI = &getAnalysis<LoopInfo>();
     DT = &getAnalysis<DominatorTree>();
+    MaxVecRegSize = std::max(MinVecRegSize,
+                             std::min(unsigned(MaxVectorRegSizeOption),
+                                      TTI->getRegisterBitWidth(true)));
 
     StoreRefs.clear();
     bool Changed = false;
@@ -1863,7 +1875,7 @@ private:
   bool vectorizeChainsInBlock(BasicBlock *BB, BoUpSLP &R);
 
   bool vectorizeStoreChain(ArrayRef<Value *> Chain, int CostThreshold,
-                           BoUpSLP &R);
+                           BoUpSLP &R, unsigned VecRegSize);
 
   bool vectorizeStores(ArrayRef<StoreInst *> Stores, int costThreshold,
                        BoUpSLP &R);
@@ -1887,13 +1899,14 @@ static bool hasValueBeenRAUWed(ArrayRef<Value *> &VL,
 }
 
 bool SLPVectorizer::vectorizeStoreChain(ArrayRef<Value *> Chain,
-                                          int CostThreshold, BoUpSLP &R) {
+                                          int CostThreshold, BoUpSLP &R,
+                                          unsigned VecRegSize) {
   unsigned ChainLen = Chain.size();
   DEBUG(dbgs() << "SLP: Analyzing a store chain of length " << ChainLen
         << "\n");
   Type *StoreTy = cast<StoreInst>(Chain[0])->getValueOperand()->getType();
   unsigned Sz = DL->getTypeSizeInBits(StoreTy);
-  unsigned VF = MinVecRegSize / Sz;
+  unsigned VF = VecRegSize / Sz;
 
   if (!isPowerOf2_32(Sz) || VF < 2)
     return false;
@@ -1977,7 +1990,14 @@ bool SLPVectorizer::vectorizeStores(ArrayRef<StoreInst *> Stores,
       I = ConsecutiveChain[I];
     }
 
-    bool Vectorized = vectorizeStoreChain(Operands, costThreshold, R);
+    // Try the widest vectors first, halving the width down to MinVecRegSize
+    // until a profitable tree is found.
+    bool Vectorized = false;
+    for (unsigned Size = MaxVecRegSize; Size >= MinVecRegSize; Size /= 2)
+      if (vectorizeStoreChain(Operands, costThreshold, R, Size)) {
+        Vectorized = true;
+        break;
+      }
 
     // Mark the vectorized stores so that we don't vectorize them again.
     if (Vectorized)
@@ -0,0 +1,38 @@
+; RUN: opt < %s -cost-model -analyze -mtriple=aarch64-none-linux-gnu -mattr=+neon | FileCheck %s
+target datalayout = "e-m:e-i64:64-i128:128-n32:64-S128"
+target triple = "aarch64-none-linux-gnu"
+
+; CHECK: casts
+define void @casts() {
+  ; Each doubling or halving of the element width is one sxtl, uxtl or xtn.
+  ; CHECK: cost of 1 {{.*}} sext
+  %r0 = sext <4 x i16> undef to <4 x i32>
+  ; CHECK: cost of 1 {{.*}} zext
+  %r1 = zext <2 x i32> undef to <2 x i64>
+  ; CHECK: cost of 3 {{.*}} zext
+  %r2 = zext <8 x i8> undef to <8 x i32>
+  ; CHECK: cost of 1 {{.*}} trunc
+  %r3 = trunc <4 x i32> undef to <4 x i16>
+  ; CHECK: cost of 3 {{.*}} trunc
+  %r4 = trunc <8 x i32> undef to <8 x i8>
+
+  ; Conversions between elements of the same width are one instruction.
+  ; CHECK: cost of 1 {{.*}} sitofp
+  %r5 = sitofp <4 x i32> undef to <4 x float>
+  ; CHECK: cost of 1 {{.*}} uitofp
+  %r6 = uitofp <2 x i64> undef to <2 x double>
+  ; CHECK: cost of 1 {{.*}} fptosi
+  %r7 = fptosi <2 x double> undef to <2 x i64>
+  ; CHECK: cost of 2 {{.*}} fptoui
+  %r8 = fptoui <4 x float> undef to <4 x i16>
+  ; CHECK: cost of 1 {{.*}} fpext
+  %r9 = fpext <2 x float> undef to <2 x double>
+  ; CHECK: cost of 2 {{.*}} fptrunc
+  %r10 = fptrunc <4 x double> undef to <4 x float>
+
+  ; CHECK: cost of 1 {{.*}} sitofp
+  %r11 = sitofp i64 undef to double
+  ; CHECK: cost of 1 {{.*}} fptoui
+  %r12 = fptoui float undef to i32
+  ret void
+}
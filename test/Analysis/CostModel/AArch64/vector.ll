@@ -0,0 +1,52 @@
+; RUN: opt < %s -cost-model -analyze -mtriple=aarch64-none-linux-gnu -mattr=+neon | FileCheck %s
+target datalayout = "e-m:e-i64:64-i128:128-n32:64-S128"
+target triple = "aarch64-none-linux-gnu"
+
+; NEON has no integer division, so every lane is divided separately.
+; CHECK: divrem
+define void @divrem() {
+  ; CHECK: cost of 24 {{.*}} sdiv
+  %r0 = sdiv <4 x i32> undef, undef
+  ; CHECK: cost of 14 {{.*}} urem
+  %r1 = urem <2 x i64> undef, undef
+  ; CHECK: cost of 48 {{.*}} udiv
+  %r2 = udiv <8 x i32> undef, undef
+  ; CHECK: cost of 1 {{.*}} add
+  %r3 = add <4 x i32> undef, undef
+  ret void
+}
+
+; CHECK: lanes
+define void @lanes(<4 x float> %f, <4 x i32> %i) {
+  ; Lane 0 of a floating point vector is the scalar register.
+  ; CHECK: cost of 0 {{.*}} extractelement
+  %e0 = extractelement <4 x float> %f, i32 0
+  ; CHECK: cost of 1 {{.*}} extractelement
+  %e1 = extractelement <4 x float> %f, i32 2
+  ; CHECK: cost of 2 {{.*}} extractelement
+  %e2 = extractelement <4 x i32> %i, i32 0
+  ; CHECK: cost of 2 {{.*}} insertelement
+  %i0 = insertelement <4 x i32> %i, i32 1, i32 3
+  ret void
+}
+
+; Reversing a double word is one rev64 and a quad word is a rev64 and an ext.
+; CHECK: reverse
+define void @reverse() {
+  ; CHECK: cost of 1 {{.*}} shufflevector
+  %s0 = shufflevector <2 x i32> undef, <2 x i32> undef, <2 x i32> <i32 1, i32 0>
+  ; CHECK: cost of 2 {{.*}} shufflevector
+  %s1 = shufflevector <4 x i32> undef, <4 x i32> undef, <4 x i32> <i32 3, i32 2, i32 1, i32 0>
+  ; CHECK: cost of 4 {{.*}} shufflevector
+  %s2 = shufflevector <8 x float> undef, <8 x float> undef, <8 x i32> <i32 7, i32 6, i32 5, i32 4, i32 3, i32 2, i32 1, i32 0>
+  ret void
+}
+
+; CHECK: selects
+define void @selects() {
+  ; CHECK: cost of 1 {{.*}} select
+  %v0 = select <4 x i1> undef, <4 x i32> undef, <4 x i32> undef
+  ; CHECK: cost of 19 {{.*}} select
+  %v1 = select <4 x i1> undef, <4 x i64> undef, <4 x i64> undef
+  ret void
+}
@@ -0,0 +1,40 @@
+; RUN: opt < %s -cost-model -analyze -mtriple=nvptx64-nvidia-cuda | FileCheck %s
+target datalayout = "e-i64:64-v16:16-v32:32-n16:32:64"
+target triple = "nvptx64-nvidia-cuda"
+
+; The ALUs are 32 bits wide, so 64-bit arithmetic takes several instructions.
+; CHECK: arith
+define void @arith() {
+  ; CHECK: cost of 1 {{.*}} add i32
+  %r0 = add i32 undef, undef
+  ; CHECK: cost of 2 {{.*}} add i64
+  %r1 = add i64 undef, undef
+  ; CHECK: cost of 2 {{.*}} sub i64
+  %r2 = sub i64 undef, undef
+  ; CHECK: cost of 1 {{.*}} mul i32
+  %r3 = mul i32 undef, undef
+  ; CHECK: cost of 4 {{.*}} mul i64
+  %r4 = mul i64 undef, undef
+  ret void
+}
+
+; Integer division expands to a long subroutine, unless the divisor is a
+; constant.  The cost model only reports vector splats as constants.
+; CHECK: divrem
+define void @divrem() {
+  ; CHECK: cost of 20 {{.*}} sdiv i32
+  %r0 = sdiv i32 undef, undef
+  ; CHECK: cost of 20 {{.*}} urem i32
+  %r1 = urem i32 undef, undef
+  ; CHECK: cost of 70 {{.*}} udiv i64
+  %r2 = udiv i64 undef, undef
+  ; CHECK: cost of 70 {{.*}} srem i64
+  %r3 = srem i64 undef, undef
+  ; CHECK: cost of 40 {{.*}} sdiv <2 x i32> undef, undef
+  %r4 = sdiv <2 x i32> undef, undef
+  ; CHECK: cost of 4 {{.*}} sdiv <2 x i32> undef, <i32 7, i32 7>
+  %r5 = sdiv <2 x i32> undef, <i32 7, i32 7>
+  ; CHECK: cost of 4 {{.*}} udiv <2 x i64> undef, <i64 7, i64 7>
+  %r6 = udiv <2 x i64> undef, <i64 7, i64 7>
+  ret void
+}
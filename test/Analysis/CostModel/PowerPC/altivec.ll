@@ -0,0 +1,29 @@
+; RUN: opt < %s  -cost-model -analyze -mtriple=powerpc64-unknown-linux-gnu -mcpu=pwr7 | FileCheck %s
+target datalayout = "E-p:64:64:64-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f32:32:32-f64:64:64-f128:128:128-v128:128:128-n32:64"
+target triple = "powerpc64-unknown-linux-gnu"
+
+define <4 x i32> @loads(<4 x i32>* %p) {
+  ; CHECK: cost of 1 {{.*}} load
+  %a = load <4 x i32>* %p, align 16
+  ; lvsl, two lvx and a vperm.
+  ; CHECK: cost of 4 {{.*}} load
+  %b = load <4 x i32>* %p, align 4
+  ; CHECK: cost of 6 {{.*}} load
+  %c = load <8 x i32>* undef, align 4
+  ret <4 x i32> %b
+}
+
+define void @stores(<4 x i32> %v) {
+  ; CHECK: cost of 1 {{.*}} store
+  store <4 x i32> %v, <4 x i32>* undef, align 16
+  ; Through the stack in two doublewords.
+  ; CHECK: cost of 17 {{.*}} store
+  store <4 x i32> %v, <4 x i32>* undef, align 4
+  ret void
+}
+
+define <4 x i32> @reverse(<4 x i32> %v) {
+  ; CHECK: cost of 2 {{.*}} shufflevector
+  %r = shufflevector <4 x i32> %v, <4 x i32> undef, <4 x i32> <i32 3, i32 2, i32 1, i32 0>
+  ret <4 x i32> %r
+}
@@ -0,0 +1,43 @@
+; RUN: opt < %s -cost-model -analyze -mtriple=x86_64-apple-macosx10.8.0 -mcpu=knl | FileCheck %s
+
+target datalayout = "e-p:64:64:64-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f32:32:32-f64:64:64-v64:64:64-v128:128:128-a0:0:64-s0:64:64-f80:128:128-n8:16:32:64-S128"
+target triple = "x86_64-apple-macosx10.8.0"
+
+; CHECK-LABEL: 'arith'
+define void @arith(<16 x i32> %a, <8 x i64> %b) {
+  ; CHECK: cost of 1 {{.*}} shl
+  %A = shl <16 x i32> %a, %a
+  ; CHECK: cost of 1 {{.*}} ashr
+  %B = ashr <8 x i64> %b, %b
+  ; CHECK: cost of 1 {{.*}} mul
+  %C = mul <16 x i32> %a, %a
+  ; CHECK: cost of 320 {{.*}} sdiv
+  %D = sdiv <16 x i32> %a, %a
+  ret void
+}
+
+; CHECK-LABEL: 'cmpsel'
+define void @cmpsel(<16 x float> %a, <8 x i64> %b) {
+  ; CHECK: cost of 1 {{.*}} fcmp
+  %A = fcmp olt <16 x float> %a, %a
+  ; CHECK: cost of 1 {{.*}} select
+  %B = select <16 x i1> %A, <16 x float> %a, <16 x float> %a
+  ; CHECK: cost of 1 {{.*}} icmp
+  %C = icmp slt <8 x i64> %b, %b
+  ; CHECK: cost of 1 {{.*}} select
+  %D = select <8 x i1> %C, <8 x i64> %b, <8 x i64> %b
+  ret void
+}
+
+; CHECK-LABEL: 'casts'
+define void @casts(<16 x i32> %a, <8 x float> %b, <16 x i8> %c) {
+  ; CHECK: cost of 1 {{.*}} sitofp
+  %A = sitofp <16 x i32> %a to <16 x float>
+  ; CHECK: cost of 1 {{.*}} fpext
+  %B = fpext <8 x float> %b to <8 x double>
+  ; CHECK: cost of 1 {{.*}} trunc
+  %C = trunc <16 x i32> %a to <16 x i8>
+  ; CHECK: cost of 1 {{.*}} zext
+  %D = zext <16 x i8> %c to <16 x i32>
+  ret void
+}
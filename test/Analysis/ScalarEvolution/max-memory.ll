@@ -0,0 +1,31 @@
+; RUN: opt < %s -analyze -scalar-evolution | FileCheck %s
+; RUN: opt < %s -analyze -scalar-evolution -scalar-evolution-max-memory=1 \
+; RUN:   | FileCheck %s -check-prefix=BUDGET
+
+; Once the expression budget is spent, values are left unknown and trip
+; counts are not computed.
+
+define void @test(i32* %p) {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %gep = getelementptr i32* %p, i32 %i
+  store i32 0, i32* %gep
+  %i.next = add i32 %i, 1
+  %cond = icmp slt i32 %i.next, 100
+  br i1 %cond, label %loop, label %exit
+
+exit:
+  ret void
+}
+
+; CHECK: %i = phi
+; CHECK-NEXT: -->  {0,+,1}
+; CHECK: Loop %loop: backedge-taken count is 99
+
+; BUDGET: %i = phi
+; BUDGET-NOT: {0,+,1}
+; BUDGET: Loop %loop: Unpredictable backedge-taken count.
+; BUDGET: Loop %loop: Unpredictable max backedge-taken count.
@@ -0,0 +1,30 @@
+; RUN: llvm-as -bitcode-function-index < %s | llvm-bcanalyzer -dump | FileCheck %s -check-prefix=BC
+; RUN: llvm-as -bitcode-function-index < %s | llvm-dis | FileCheck %s
+; RUN: llvm-as -bitcode-function-index < %s > %t.bc
+; RUN: llvm-extract -func=g -S %t.bc -o - | FileCheck %s -check-prefix=EXTRACT
+
+; BC: <FNINDEX
+
+@x = global i32 0
+
+; CHECK: define i32 @f(i32 %a)
+; CHECK-NEXT: %b = add i32 %a, 1
+; CHECK-NEXT: ret i32 %b
+define i32 @f(i32 %a) {
+  %b = add i32 %a, 1
+  ret i32 %b
+}
+
+declare void @h()
+
+; CHECK: define void @g()
+; CHECK-NEXT: call void @h()
+; CHECK-NEXT: store i32 1, i32* @x
+; EXTRACT: define void @g()
+; EXTRACT-NEXT: call void @h()
+; EXTRACT-NEXT: store i32 1, i32* @x
+define void @g() {
+  call void @h()
+  store i32 1, i32* @x
+  ret void
+}
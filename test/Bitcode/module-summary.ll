@@ -0,0 +1,39 @@
+; RUN: llvm-as -bitcode-module-summary < %s | llvm-bcanalyzer -dump | FileCheck %s -check-prefix=BC
+; RUN: llvm-as -bitcode-module-summary < %s > %t.summary.bc
+; RUN: llvm-as < %s > %t.bc
+; RUN: llvm-nm %t.summary.bc | FileCheck %s
+; RUN: llvm-nm %t.bc | FileCheck %s
+; RUN: llvm-as -bitcode-module-summary < %s | llvm-dis | FileCheck %s -check-prefix=IR
+
+; BC: <MODULE_SUMMARY_BLOCK
+; BC: <SYMBOL
+; BC: <CALLS
+; BC: </MODULE_SUMMARY_BLOCK>
+
+; CHECK: U ext
+; CHECK-NEXT: T f
+; CHECK-NEXT: D g
+; CHECK-NEXT: T go
+; CHECK-NEXT: W weak
+; CHECK-NEXT: d x
+; CHECK-NOT: priv
+
+; IR: define void @f()
+
+@x = internal global i32 0
+@g = global i32 1
+@priv = private global i32 2
+@go = alias void ()* @f
+
+declare void @ext()
+
+define weak void @weak() {
+  ret void
+}
+
+define void @f() {
+  call void @ext()
+  call void @weak()
+  store i32 1, i32* @x
+  ret void
+}
@@ -0,0 +1,24 @@
+; Test that testing several candidates at a time narrows the testcase down to
+; the same function as a sequential reduction.
+;
+; RUN: bugpoint -load %llvmshlibdir/BugpointPasses%shlibext %s -output-prefix %t -bugpoint-crashcalls -silence-passes -j 3 > /dev/null
+; RUN: llvm-dis %t-reduced-function.bc -o - | FileCheck %s
+; REQUIRES: loadable_module
+
+; CHECK-NOT: define
+; CHECK: define i32 @test()
+; CHECK-NOT: define
+
+define i32 @a() { ret i32 1 }
+define i32 @b() { ret i32 2 }
+define i32 @c() { ret i32 3 }
+define i32 @d() { ret i32 4 }
+
+define i32 @test() {
+	call i32 @test()
+	ret i32 %1
+}
+
+define i32 @e() { ret i32 5 }
+define i32 @f() { ret i32 6 }
+define i32 @g() { ret i32 7 }
@@ -0,0 +1,36 @@
+; RUN: llc < %s -mtriple=thumbv7m-none-eabi -mcpu=cortex-m3 | FileCheck %s
+; RUN: llc < %s -mtriple=thumbv7m-none-eabi -mcpu=cortex-m3 \
+; RUN:   -arm-prera-ldst-use-aa=false | FileCheck %s -check-prefix=NOAA
+
+; The load from %q cannot alias the stores to %p, so the pre-RA load / store
+; optimizer sinks the first store past it and pairs the two stores.
+
+; CHECK-LABEL: sink_store_past_load:
+; CHECK: ldr [[V:r[0-9]+]], [r1]
+; CHECK: strd r2, [[V]], [r0]
+
+; NOAA-LABEL: sink_store_past_load:
+; NOAA-NOT: strd
+; NOAA: bx lr
+define void @sink_store_past_load(i32* noalias %p, i32* noalias %q, i32 %x) nounwind {
+entry:
+  store i32 %x, i32* %p, align 8
+  %v = load i32* %q, align 4
+  %p1 = getelementptr inbounds i32* %p, i32 1
+  store i32 %v, i32* %p1, align 4
+  ret void
+}
+
+; Without noalias the load may read the first store, which has to stay put.
+
+; CHECK-LABEL: may_alias:
+; CHECK-NOT: strd
+; CHECK: bx lr
+define void @may_alias(i32* %p, i32* %q, i32 %x) nounwind {
+entry:
+  store i32 %x, i32* %p, align 8
+  %v = load i32* %q, align 4
+  %p1 = getelementptr inbounds i32* %p, i32 1
+  store i32 %v, i32* %p1, align 4
+  ret void
+}
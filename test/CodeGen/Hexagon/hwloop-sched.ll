@@ -0,0 +1,44 @@
+; RUN: llc -march=hexagon -mcpu=hexagonv4 < %s \
+; RUN:   | FileCheck %s --check-prefix=CHECK --check-prefix=SCHED
+; RUN: llc -march=hexagon -mcpu=hexagonv4 -hexagon-sched-hw-loops=false < %s \
+; RUN:   | FileCheck %s --check-prefix=CHECK --check-prefix=NOSCHED
+
+; The hardware loop body is reordered before packetizing.  Nothing in the
+; body waits for the induction variable update, so the scheduler gives it the
+; lowest priority and it lands in the second packet, next to the load.
+; Without the scheduler the packetizer keeps the original order and puts it
+; in the first packet with the address computations.
+
+; CHECK: loop0(
+; CHECK: {
+; CHECK-NEXT: = add(r{{[0-9]+}}, r{{[0-9]+}})
+; CHECK-NEXT: = add(r{{[0-9]+}}, r{{[0-9]+}})
+; NOSCHED-NEXT: = add(r{{[0-9]+}}, #4)
+; CHECK-NEXT: }
+; CHECK-NEXT: {
+; CHECK-NEXT: = memw(
+; SCHED-NEXT: = add(r{{[0-9]+}}, #4)
+; CHECK-NEXT: = add(r{{[0-9]+}}, #1600)
+; CHECK-NEXT: }
+; CHECK: endloop0
+
+define void @saxpy(i32* nocapture %y, i32* nocapture readonly %x, i32 %a) nounwind {
+entry:
+  br label %for.body
+
+for.body:
+  %i = phi i32 [ 0, %entry ], [ %inc, %for.body ]
+  %px = getelementptr inbounds i32* %x, i32 %i
+  %vx = load i32* %px, align 4
+  %py = getelementptr inbounds i32* %y, i32 %i
+  %vy = load i32* %py, align 4
+  %mul = mul nsw i32 %vx, %a
+  %add = add nsw i32 %mul, %vy
+  store i32 %add, i32* %py, align 4
+  %inc = add nsw i32 %i, 1
+  %exitcond = icmp eq i32 %inc, 400
+  br i1 %exitcond, label %for.end, label %for.body
+
+for.end:
+  ret void
+}
@@ -1,9 +1,12 @@
 ; RUN: llc < %s -march=nvptx -mcpu=sm_20 | FileCheck %s
+; RUN: llc < %s -march=nvptx -mcpu=sm_20 -O0 | FileCheck %s -check-prefix=O0
 
 target datalayout = "e-p:32:32:32-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f32:32:32-f64:64:64-v16:16:16-v32:32:32-v64:64:64-v128:128:128-n16:32:64"
 target triple = "nvptx-nvidia-cuda"
 
-; Ensure global variables in address space 0 are promoted to address space 1
+; Ensure global variables in address space 0 are promoted to address space 1.
+; The generic pointers to them are converted back at -O0 only; otherwise the
+; loads address the variables in the global space directly.
 
 ; CHECK: .global .align 4 .u32 myglobal = 42;
 @myglobal = internal global i32 42, align 4
@@ -12,9 +15,13 @@ target triple = "nvptx-nvidia-cuda"
 
 
 define void @foo(i32* %a, i32* %b) {
-; CHECK: cvta.global.u32
+; O0: cvta.global.u32
+; CHECK-NOT: cvta
+; CHECK: ld.global.u32 %r{{[0-9]+}}, [myglobal]
   %ld1 = load i32* @myglobal
-; CHECK: cvta.global.u32
+; O0: cvta.global.u32
+; CHECK-NOT: cvta
+; CHECK: ld.global.u32 %r{{[0-9]+}}, [myconst]
   %ld2 = load i32* @myconst
   store i32 %ld1, i32* %a
   store i32 %ld2, i32* %b
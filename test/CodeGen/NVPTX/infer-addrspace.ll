@@ -0,0 +1,60 @@
+; RUN: llc < %s -march=nvptx64 -mcpu=sm_20 | FileCheck %s
+
+; Generic pointers derived from the address of a global variable are given
+; back the global address space, through getelementptrs, bitcasts, selects
+; and phis.
+
+@array = internal global [64 x float] zeroinitializer, align 4
+@other = internal addrspace(3) global [64 x float] zeroinitializer, align 4
+
+; CHECK: .visible .func elements
+; CHECK-NOT: cvta.global
+; CHECK: ld.global.f32
+; CHECK: st.global.u32
+define void @elements(i64 %i) {
+  %p = getelementptr [64 x float]* @array, i64 0, i64 %i
+  %v = load float* %p, align 4
+  %q = getelementptr [64 x float]* @array, i64 0, i64 3
+  %c = bitcast float* %q to i32*
+  %w = fptosi float %v to i32
+  store i32 %w, i32* %c, align 4
+  ret void
+}
+
+; CHECK: .visible .func (.param .b32 func_retval0) loop(
+; CHECK: ld.global.f32
+; CHECK: ret
+define float @loop(i64 %n) {
+entry:
+  %start = getelementptr [64 x float]* @array, i64 0, i64 0
+  br label %body
+
+body:
+  %p = phi float* [ %start, %entry ], [ %p.next, %body ]
+  %i = phi i64 [ 0, %entry ], [ %i.next, %body ]
+  %sum = phi float [ 0.0, %entry ], [ %sum.next, %body ]
+  %v = load float* %p, align 4
+  %sum.next = fadd float %sum, %v
+  %p.next = getelementptr float* %p, i64 1
+  %i.next = add i64 %i, 1
+  %done = icmp eq i64 %i.next, %n
+  br i1 %done, label %exit, label %body
+
+exit:
+  ret float %sum.next
+}
+
+; A pointer that may be in either space stays generic.
+; CHECK: .visible .func (.param .b32 func_retval0) mixed(
+; CHECK: cvta.shared
+; CHECK: ld.f32
+define float @mixed(i1 %c) {
+  %g = getelementptr [64 x float]* @array, i64 0, i64 0
+  %s = getelementptr [64 x float] addrspace(3)* @other, i64 0, i64 0
+  %s.gen = call float* @llvm.nvvm.ptr.shared.to.gen.p0f32.p3f32(float addrspace(3)* %s)
+  %p = select i1 %c, float* %g, float* %s.gen
+  %v = load float* %p, align 4
+  ret float %v
+}
+
+declare float* @llvm.nvvm.ptr.shared.to.gen.p0f32.p3f32(float addrspace(3)*)
@@ -0,0 +1,60 @@
+; RUN: llc < %s -march=nvptx64 -mcpu=sm_20 | FileCheck %s
+; RUN: llc < %s -march=nvptx64 -mcpu=sm_20 -disable-nvptx-load-store-vectorizer | FileCheck %s -check-prefix=NOVEC
+
+; Adjacent scalar accesses off the same pointer are merged into the vector
+; forms of ld and st when their alignment allows it.
+
+; CHECK: .visible .func foo
+; CHECK: ld.global.v4.f32
+; CHECK: st.global.v4.f32
+; NOVEC: .visible .func foo
+; NOVEC-NOT: .v4
+define void @foo(float addrspace(1)* %in, float addrspace(1)* noalias %out) {
+  %p1 = getelementptr float addrspace(1)* %in, i64 1
+  %p2 = getelementptr float addrspace(1)* %in, i64 2
+  %p3 = getelementptr float addrspace(1)* %in, i64 3
+  %a = load float addrspace(1)* %in, align 16
+  %b = load float addrspace(1)* %p1, align 4
+  %c = load float addrspace(1)* %p2, align 8
+  %d = load float addrspace(1)* %p3, align 4
+  %q1 = getelementptr float addrspace(1)* %out, i64 1
+  %q2 = getelementptr float addrspace(1)* %out, i64 2
+  %q3 = getelementptr float addrspace(1)* %out, i64 3
+  store float %d, float addrspace(1)* %out, align 16
+  store float %c, float addrspace(1)* %q1, align 4
+  store float %b, float addrspace(1)* %q2, align 8
+  store float %a, float addrspace(1)* %q3, align 4
+  ret void
+}
+
+; Only the pair starting at an 8 byte boundary can be merged.
+; CHECK: .visible .func pair
+; CHECK: ld.global.u32
+; CHECK: ld.global.v2.u32
+; CHECK-NOT: .v2
+; CHECK: ret
+define void @pair(i32 addrspace(1)* %in, i32 addrspace(1)* %out) {
+  %p1 = getelementptr i32 addrspace(1)* %in, i64 1
+  %p2 = getelementptr i32 addrspace(1)* %in, i64 2
+  %a = load i32 addrspace(1)* %in, align 4
+  %b = load i32 addrspace(1)* %p1, align 8
+  %c = load i32 addrspace(1)* %p2, align 4
+  %s = add i32 %a, %b
+  %t = add i32 %s, %c
+  store i32 %t, i32 addrspace(1)* %out, align 4
+  ret void
+}
+
+; A store that may alias the loaded memory keeps the loads apart.
+; CHECK: .visible .func clobber
+; CHECK-NOT: .v2
+; CHECK: ret
+define void @clobber(double addrspace(1)* %in, double addrspace(1)* %out) {
+  %p1 = getelementptr double addrspace(1)* %in, i64 1
+  %a = load double addrspace(1)* %in, align 16
+  store double 0.0, double addrspace(1)* %out, align 8
+  %b = load double addrspace(1)* %p1, align 8
+  %s = fadd double %a, %b
+  store double %s, double addrspace(1)* %out, align 8
+  ret void
+}
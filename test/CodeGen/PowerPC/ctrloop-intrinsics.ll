@@ -0,0 +1,73 @@
+; RUN: llc < %s -mcpu=pwr7 | FileCheck %s
+target datalayout = "E-p:64:64:64-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f32:32:32-f64:64:64-f128:128:128-v128:128:128-n32:64"
+target triple = "powerpc64-unknown-linux-gnu"
+
+; A short constant-length memcpy is expanded inline and does not touch CTR.
+define void @small_memcpy(i8* %dst, i8* %src) nounwind {
+entry:
+  br label %for.body
+
+for.body:
+  %i = phi i64 [ 0, %entry ], [ %inc, %for.body ]
+  %off = shl i64 %i, 4
+  %d = getelementptr inbounds i8* %dst, i64 %off
+  tail call void @llvm.memcpy.p0i8.p0i8.i64(i8* %d, i8* %src, i64 16, i32 8, i1 false)
+  %inc = add nsw i64 %i, 1
+  %exitcond = icmp eq i64 %inc, 2048
+  br i1 %exitcond, label %for.end, label %for.body
+
+for.end:
+  ret void
+}
+
+; CHECK-LABEL: @small_memcpy
+; CHECK: mtctr
+; CHECK: bdnz
+
+; A long one is a call to memcpy.
+define void @large_memcpy(i8* %dst, i8* %src) nounwind {
+entry:
+  br label %for.body
+
+for.body:
+  %i = phi i64 [ 0, %entry ], [ %inc, %for.body ]
+  %off = shl i64 %i, 10
+  %d = getelementptr inbounds i8* %dst, i64 %off
+  tail call void @llvm.memcpy.p0i8.p0i8.i64(i8* %d, i8* %src, i64 1024, i32 8, i1 false)
+  %inc = add nsw i64 %i, 1
+  %exitcond = icmp eq i64 %inc, 2048
+  br i1 %exitcond, label %for.end, label %for.body
+
+for.end:
+  ret void
+}
+
+; CHECK-LABEL: @large_memcpy
+; CHECK-NOT: mtctr
+; CHECK: blr
+
+; fma on double is an fmadd.
+define double @fma_loop(double* %a, double %x) nounwind readonly {
+entry:
+  br label %for.body
+
+for.body:
+  %i = phi i64 [ 0, %entry ], [ %inc, %for.body ]
+  %acc = phi double [ %x, %entry ], [ %f, %for.body ]
+  %p = getelementptr inbounds double* %a, i64 %i
+  %v = load double* %p, align 8
+  %f = tail call double @llvm.fma.f64(double %v, double %x, double %acc)
+  %inc = add nsw i64 %i, 1
+  %exitcond = icmp eq i64 %inc, 2048
+  br i1 %exitcond, label %for.end, label %for.body
+
+for.end:
+  ret double %f
+}
+
+; CHECK-LABEL: @fma_loop
+; CHECK: mtctr
+; CHECK: bdnz
+
+declare void @llvm.memcpy.p0i8.p0i8.i64(i8* nocapture, i8* nocapture, i64, i32, i1) nounwind
+declare double @llvm.fma.f64(double, double, double) nounwind readnone
@@ -0,0 +1,45 @@
+; RUN: llc < %s -march=r600 -mcpu=SI -verify-machineinstrs | FileCheck %s
+; RUN: llc < %s -march=r600 -mcpu=SI -misched=si -verify-machineinstrs | FileCheck %s
+
+; SI kernels are scheduled by the occupancy aware strategy, which issues the
+; loads early while the loaded values fit below the next VGPR threshold.
+
+; CHECK: @sum8
+; CHECK: BUFFER_LOAD_DWORD
+; CHECK: BUFFER_LOAD_DWORD
+; CHECK: BUFFER_LOAD_DWORD
+; CHECK: BUFFER_LOAD_DWORD
+; CHECK: BUFFER_LOAD_DWORD
+; CHECK: BUFFER_LOAD_DWORD
+; CHECK: BUFFER_LOAD_DWORD
+; CHECK: BUFFER_LOAD_DWORD
+; CHECK: V_ADD_I32
+; CHECK: BUFFER_STORE_DWORD
+; CHECK: S_ENDPGM
+; CHECK: NumVgprs: {{[0-9]$}}
+define void @sum8(i32 addrspace(1)* %out, i32 addrspace(1)* %in) {
+  %p1 = getelementptr i32 addrspace(1)* %in, i32 1
+  %p2 = getelementptr i32 addrspace(1)* %in, i32 2
+  %p3 = getelementptr i32 addrspace(1)* %in, i32 3
+  %p4 = getelementptr i32 addrspace(1)* %in, i32 4
+  %p5 = getelementptr i32 addrspace(1)* %in, i32 5
+  %p6 = getelementptr i32 addrspace(1)* %in, i32 6
+  %p7 = getelementptr i32 addrspace(1)* %in, i32 7
+  %v0 = load i32 addrspace(1)* %in
+  %v1 = load i32 addrspace(1)* %p1
+  %v2 = load i32 addrspace(1)* %p2
+  %v3 = load i32 addrspace(1)* %p3
+  %v4 = load i32 addrspace(1)* %p4
+  %v5 = load i32 addrspace(1)* %p5
+  %v6 = load i32 addrspace(1)* %p6
+  %v7 = load i32 addrspace(1)* %p7
+  %s0 = add i32 %v0, %v1
+  %s1 = add i32 %v2, %v3
+  %s2 = add i32 %v4, %v5
+  %s3 = add i32 %v6, %v7
+  %t0 = add i32 %s0, %s1
+  %t1 = add i32 %s2, %s3
+  %r = add i32 %t0, %t1
+  store i32 %r, i32 addrspace(1)* %out
+  ret void
+}
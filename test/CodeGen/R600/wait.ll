@@ -1,9 +1,18 @@
 ; RUN: llc < %s -march=r600 -mcpu=SI --verify-machineinstrs | FileCheck %s
 
+; RUN: llc < %s -march=r600 -mcpu=SI --verify-machineinstrs -misched-bench=false | FileCheck %s --check-prefix=NOSCHED
+
 ;CHECK-LABEL: @main
 ;CHECK: S_WAITCNT lgkmcnt(0)
 ;CHECK: S_WAITCNT vmcnt(0)
-;CHECK: S_WAITCNT expcnt(0) lgkmcnt(0)
+;CHECK-NEXT: EXP
+;CHECK-NOT: S_WAITCNT
+;CHECK: EXP
+
+;NOSCHED-LABEL: @main
+;NOSCHED: S_WAITCNT lgkmcnt(0)
+;NOSCHED: S_WAITCNT vmcnt(0)
+;NOSCHED: S_WAITCNT expcnt(0) lgkmcnt(0)
 
 define void @main(<16 x i8> addrspace(2)* inreg, <16 x i8> addrspace(2)* inreg, <32 x i8> addrspace(2)* inreg, <16 x i8> addrspace(2)* inreg, <16 x i8> addrspace(2)* inreg, i32 inreg, i32, i32, i32, i32) #0 {
 main_body:
@@ -0,0 +1,55 @@
+; RUN: llc < %s -mtriple=x86_64-linux -x86-align-hot-loops | FileCheck %s
+; RUN: llc < %s -mtriple=x86_64-linux | FileCheck %s -check-prefix=DEFAULT
+
+; A small loop that runs much more often than it is entered gets its first
+; block aligned to a 32-byte window.
+; CHECK-LABEL: sum:
+; CHECK: .align 32, 0x90
+; CHECK-NEXT: .LBB0_{{[0-9]+}}:
+; DEFAULT-LABEL: sum:
+; DEFAULT-NOT: .align 32
+
+define i32 @sum(i32* %p, i32 %n) nounwind {
+entry:
+  %cmp4 = icmp sgt i32 %n, 0
+  br i1 %cmp4, label %loop, label %exit
+
+loop:
+  %i = phi i32 [ %inc, %loop ], [ 0, %entry ]
+  %s = phi i32 [ %add, %loop ], [ 0, %entry ]
+  %arrayidx = getelementptr inbounds i32* %p, i32 %i
+  %v = load i32* %arrayidx, align 4
+  %add = add nsw i32 %v, %s
+  %inc = add nsw i32 %i, 1
+  %cmp = icmp slt i32 %inc, %n
+  br i1 %cmp, label %loop, label %exit
+
+exit:
+  %r = phi i32 [ 0, %entry ], [ %add, %loop ]
+  ret i32 %r
+}
+
+; Functions optimized for size are left alone.
+; CHECK-LABEL: sum_os:
+; CHECK-NOT: .align 32
+; CHECK: ret
+
+define i32 @sum_os(i32* %p, i32 %n) nounwind optsize {
+entry:
+  %cmp4 = icmp sgt i32 %n, 0
+  br i1 %cmp4, label %loop, label %exit
+
+loop:
+  %i = phi i32 [ %inc, %loop ], [ 0, %entry ]
+  %s = phi i32 [ %add, %loop ], [ 0, %entry ]
+  %arrayidx = getelementptr inbounds i32* %p, i32 %i
+  %v = load i32* %arrayidx, align 4
+  %add = add nsw i32 %v, %s
+  %inc = add nsw i32 %i, 1
+  %cmp = icmp slt i32 %inc, %n
+  br i1 %cmp, label %loop, label %exit
+
+exit:
+  %r = phi i32 [ 0, %entry ], [ %add, %loop ]
+  ret i32 %r
+}
@@ -0,0 +1,50 @@
+; RUN: llc < %s -mtriple=x86_64-apple-darwin -mcpu=knl | FileCheck %s
+
+; A select between an arithmetic result and a pass-through value folds into
+; the merge-masked form of the instruction.
+
+; CHECK-LABEL: addps_mask
+; CHECK: vcmpltps {{.*}}, %k1
+; CHECK: vaddps {{.*}} {%k1}
+; CHECK: ret
+define <16 x float> @addps_mask(<16 x float> %a, <16 x float> %b,
+                                <16 x float> %c, <16 x float> %x) nounwind {
+  %mask = fcmp olt <16 x float> %x, %c
+  %add = fadd <16 x float> %a, %b
+  %res = select <16 x i1> %mask, <16 x float> %add, <16 x float> %c
+  ret <16 x float> %res
+}
+
+; CHECK-LABEL: mulpd_mask
+; CHECK: vmulpd {{.*}} {%k1}
+; CHECK: ret
+define <8 x double> @mulpd_mask(<8 x double> %a, <8 x double> %b,
+                                <8 x double> %c, <8 x double> %x) nounwind {
+  %mask = fcmp olt <8 x double> %x, %c
+  %mul = fmul <8 x double> %a, %b
+  %res = select <8 x i1> %mask, <8 x double> %mul, <8 x double> %c
+  ret <8 x double> %res
+}
+
+; CHECK-LABEL: paddd_mask
+; CHECK: vpcmpeqd {{.*}}, %k1
+; CHECK: vpaddd {{.*}} {%k1}
+; CHECK: ret
+define <16 x i32> @paddd_mask(<16 x i32> %a, <16 x i32> %b,
+                              <16 x i32> %c, <16 x i32> %x) nounwind {
+  %mask = icmp eq <16 x i32> %x, %c
+  %add = add <16 x i32> %a, %b
+  %res = select <16 x i1> %mask, <16 x i32> %add, <16 x i32> %c
+  ret <16 x i32> %res
+}
+
+; CHECK-LABEL: psubq_mask
+; CHECK: vpsubq {{.*}} {%k1}
+; CHECK: ret
+define <8 x i64> @psubq_mask(<8 x i64> %a, <8 x i64> %b,
+                             <8 x i64> %c, <8 x i64> %x) nounwind {
+  %mask = icmp eq <8 x i64> %x, %c
+  %sub = sub <8 x i64> %a, %b
+  %res = select <8 x i1> %mask, <8 x i64> %sub, <8 x i64> %c
+  ret <8 x i64> %res
+}
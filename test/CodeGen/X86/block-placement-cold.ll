@@ -0,0 +1,47 @@
+; RUN: llc < %s -mtriple=x86_64-apple-darwin -mcpu=corei7 | FileCheck %s -check-prefix=DEFAULT
+; RUN: llc < %s -mtriple=x86_64-apple-darwin -mcpu=corei7 -block-placement-cold-percent=5 | FileCheck %s
+;
+; The unlikely error path is part of the loop, so it is normally laid out
+; with the rest of the loop.  Move it behind the rest of the function.
+
+; DEFAULT-LABEL: f:
+; DEFAULT: callq _fail
+; DEFAULT: callq _work
+; DEFAULT: callq _done
+
+; CHECK-LABEL: f:
+; CHECK: callq _work
+; CHECK: callq _done
+; CHECK: ret
+; CHECK: callq _fail
+; CHECK-NEXT: jmp
+
+declare void @work()
+declare void @fail()
+declare void @done()
+
+define void @f(i32 %n) nounwind {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %latch ]
+  call void @work()
+  %c = icmp eq i32 %i, 17
+  br i1 %c, label %error, label %latch, !prof !0
+
+error:
+  call void @fail()
+  br label %latch
+
+latch:
+  %i.next = add i32 %i, 1
+  %done = icmp eq i32 %i.next, %n
+  br i1 %done, label %exit, label %loop
+
+exit:
+  call void @done()
+  ret void
+}
+
+!0 = metadata !{metadata !"branch_weights", i32 1, i32 1000}
@@ -0,0 +1,33 @@
+; RUN: llc < %s -mtriple=x86_64-apple-darwin -join-by-frequency -join-budget=1 \
+; RUN:   -stats -o /dev/null 2>&1 | FileCheck %s --check-prefix=BUDGET
+; RUN: llc < %s -mtriple=x86_64-apple-darwin -join-by-frequency \
+; RUN:   -stats -o /dev/null 2>&1 | FileCheck %s --check-prefix=NOBUDGET
+; REQUIRES: asserts
+
+; With a budget of one join, the remaining copies are skipped.
+; BUDGET: {{[1-9][0-9]*}} regalloc - Number of copies skipped by the join budget
+; BUDGET: 1 regalloc - Number of interval joins performed
+
+; NOBUDGET-NOT: Number of copies skipped by the join budget
+; NOBUDGET: regalloc - Number of interval joins performed
+
+define i32 @sum(i32* %p, i32 %n, i32 %k) nounwind {
+entry:
+  %cmp0 = icmp sgt i32 %n, 0
+  br i1 %cmp0, label %loop, label %exit
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %acc = phi i32 [ %k, %entry ], [ %acc.next, %loop ]
+  %idx = sext i32 %i to i64
+  %addr = getelementptr i32* %p, i64 %idx
+  %v = load i32* %addr
+  %acc.next = add i32 %acc, %v
+  %i.next = add i32 %i, 1
+  %cmp = icmp slt i32 %i.next, %n
+  br i1 %cmp, label %loop, label %exit
+
+exit:
+  %r = phi i32 [ %k, %entry ], [ %acc.next, %loop ]
+  ret i32 %r
+}
@@ -0,0 +1,29 @@
+; RUN: llc < %s -mtriple=x86_64-apple-darwin -join-by-frequency -verify-coalescing | FileCheck %s
+; RUN: llc < %s -mtriple=x86_64-apple-darwin -join-by-frequency -join-budget=1 -verify-coalescing | FileCheck %s
+;
+; Ordering blocks by frequency and cutting coalescing short must still leave
+; valid code; the copies that are not joined are left for the allocator.
+
+; CHECK-LABEL: sum:
+; CHECK: ret
+
+define i32 @sum(i32* %p, i32 %n, i32 %k) nounwind {
+entry:
+  %cmp0 = icmp sgt i32 %n, 0
+  br i1 %cmp0, label %loop, label %exit
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %acc = phi i32 [ %k, %entry ], [ %acc.next, %loop ]
+  %idx = sext i32 %i to i64
+  %addr = getelementptr i32* %p, i64 %idx
+  %v = load i32* %addr
+  %acc.next = add i32 %acc, %v
+  %i.next = add i32 %i, 1
+  %cmp = icmp slt i32 %i.next, %n
+  br i1 %cmp, label %loop, label %exit
+
+exit:
+  %r = phi i32 [ %k, %entry ], [ %acc.next, %loop ]
+  ret i32 %r
+}
@@ -0,0 +1,49 @@
+; RUN: llc < %s -mtriple=x86_64-unknown-unknown -mcpu=corei7 -stats 2>&1 | FileCheck %s
+; RUN: llc < %s -mtriple=x86_64-unknown-unknown -mcpu=corei7 -cgp-addr-sink-max-freq-ratio=4 -stats 2>&1 | FileCheck %s -check-prefix=FREQ
+; REQUIRES: asserts
+
+; The address of the first access in %use is sunk into it, and the two others
+; reuse it without matching the address again.  Once the address is local, the
+; second round of the pass matches it for the first access only.  The store in
+; %loop sinks its address too, unless sinking into blocks hotter than the one
+; computing the address is limited.
+
+; CHECK-NOT: Number of addresses not sunk into hotter blocks
+; CHECK: 4 codegenprepare - Number of memory instructions whose address computations were sunk
+; CHECK: 4 codegenprepare - Number of memory instructions whose address was not matched again
+
+; FREQ: 1 codegenprepare - Number of addresses not sunk into hotter blocks
+; FREQ: 3 codegenprepare - Number of memory instructions whose address computations were sunk
+; FREQ: 4 codegenprepare - Number of memory instructions whose address was not matched again
+
+define i32 @reuse(i32* %base, i64 %i, i1 %c) {
+entry:
+  %p = getelementptr i32* %base, i64 %i
+  br i1 %c, label %use, label %exit
+
+use:
+  %a = load i32* %p
+  store i32 0, i32* %p
+  %b = load i32* %p
+  %s = add i32 %a, %b
+  ret i32 %s
+
+exit:
+  ret i32 0
+}
+
+define void @hot(i32* %base, i64 %i, i32 %n) {
+entry:
+  %p = getelementptr i32* %base, i64 %i
+  br label %loop
+
+loop:
+  %j = phi i32 [ 0, %entry ], [ %j.next, %loop ]
+  store i32 %j, i32* %p
+  %j.next = add i32 %j, 1
+  %done = icmp eq i32 %j.next, %n
+  br i1 %done, label %exit, label %loop
+
+exit:
+  ret void
+}
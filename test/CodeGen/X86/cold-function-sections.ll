@@ -0,0 +1,22 @@
+; RUN: llc < %s -mtriple=x86_64-pc-linux -cold-function-sections | FileCheck %s
+; RUN: echo "# hot functions" > %t.order
+; RUN: echo "hot" >> %t.order
+; RUN: llc < %s -mtriple=x86_64-pc-linux -function-order-file=%t.order | FileCheck %s -check-prefix=ORDER
+
+; CHECK: .section .text.unlikely,"ax",@progbits
+; CHECK-LABEL: cold:
+; CHECK: .text
+; CHECK-LABEL: hot:
+
+; ORDER-NOT: .text.unlikely
+; ORDER-LABEL: cold:
+; ORDER: .section .text.hot.hot,"ax",@progbits
+; ORDER-LABEL: hot:
+
+define void @cold() nounwind cold {
+  ret void
+}
+
+define void @hot() nounwind {
+  ret void
+}
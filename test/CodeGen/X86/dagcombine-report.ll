@@ -0,0 +1,18 @@
+; RUN: llc < %s -mtriple=x86_64-unknown-unknown | FileCheck %s
+; RUN: llc < %s -mtriple=x86_64-unknown-unknown -combiner-topological-worklist \
+; RUN:   | FileCheck %s
+; RUN: llc < %s -mtriple=x86_64-unknown-unknown -combiner-max-node-visits=1 \
+; RUN:   | FileCheck %s
+; RUN: llc < %s -mtriple=x86_64-unknown-unknown -combiner-report \
+; RUN:   -o /dev/null 2>&1 | FileCheck %s --check-prefix=REPORT
+
+; The multiply by a power of two is combined into a shift.
+; CHECK-LABEL: f:
+; CHECK-NOT: imul
+; CHECK: ret
+; REPORT: DAGCombine report for 'f' (level 0):
+; REPORT: mul: 1
+define i32 @f(i32 %x) {
+  %m = mul i32 %x, 8
+  ret i32 %m
+}
@@ -0,0 +1,63 @@
+; RUN: llc < %s -fast-isel -O0 -mcpu=core2 -mattr=-avx -asm-verbose=0 | FileCheck %s
+; RUN: llc < %s -fast-isel -O0 -mcpu=core2 -mattr=-avx -fast-isel-report \
+; RUN:   -o /dev/null 2>&1 | FileCheck %s --check-prefix=REPORT
+
+target triple = "x86_64-apple-darwin10.0.0"
+
+declare double @llvm.sqrt.f64(double)
+declare { i32, i1 } @llvm.usub.with.overflow.i32(i32, i32)
+declare { i64, i1 } @llvm.ssub.with.overflow.i64(i64, i64)
+
+; REPORT: FastISel report for 'sqrt': 1 of 1 blocks selected entirely by fast isel
+; REPORT-NOT: call
+; CHECK-LABEL: sqrt:
+; CHECK: sqrtsd
+; CHECK-NOT: call
+; CHECK: ret
+define double @sqrt(double %x) {
+  %r = call double @llvm.sqrt.f64(double %x)
+  ret double %r
+}
+
+; REPORT: FastISel report for 'usub': 1 of 1 blocks selected entirely by fast isel
+; REPORT-NOT: call
+; CHECK-LABEL: usub:
+; CHECK: subl
+; CHECK: setb
+define i32 @usub(i32 %a, i32 %b) {
+  %t = call { i32, i1 } @llvm.usub.with.overflow.i32(i32 %a, i32 %b)
+  %v = extractvalue { i32, i1 } %t, 0
+  %o = extractvalue { i32, i1 } %t, 1
+  %z = zext i1 %o to i32
+  %r = add i32 %v, %z
+  ret i32 %r
+}
+
+; REPORT: FastISel report for 'ssub': 1 of 1 blocks selected entirely by fast isel
+; REPORT-NOT: call
+; CHECK-LABEL: ssub:
+; CHECK: subq
+; CHECK: seto
+define i64 @ssub(i64 %a, i64 %b) {
+  %t = call { i64, i1 } @llvm.ssub.with.overflow.i64(i64 %a, i64 %b)
+  %v = extractvalue { i64, i1 } %t, 0
+  %o = extractvalue { i64, i1 } %t, 1
+  %z = zext i1 %o to i64
+  %r = add i64 %v, %z
+  ret i64 %r
+}
+
+; Switches are left to SelectionDAG.
+; REPORT: FastISel report for 'fallback': 3 of 4 blocks selected entirely by fast isel
+; REPORT-NEXT: switch: 1
+define i32 @fallback(i32 %x) {
+entry:
+  switch i32 %x, label %d [ i32 0, label %a
+                            i32 1, label %b ]
+a:
+  ret i32 1
+b:
+  ret i32 2
+d:
+  ret i32 0
+}
@@ -0,0 +1,17 @@
+; REQUIRES: asserts
+; RUN: llc < %s -mtriple=x86_64-unknown-unknown -O2 -stats 2>&1 | FileCheck %s
+
+; The matcher table interpreter reports how much of the table it scans and how
+; many nodes it selects, which gives the average scan length per node.
+
+; CHECK-DAG: isel {{ *}}- Number of matcher table entries scanned by dag isel
+; CHECK-DAG: isel {{ *}}- Number of nodes selected by the matcher table
+
+define i32 @f(i32 %a, i32 %b, i32* %p) {
+entry:
+  %x = load i32* %p
+  %s = add i32 %a, %x
+  %m = mul i32 %s, %b
+  %r = xor i32 %m, 7
+  ret i32 %r
+}
@@ -0,0 +1,37 @@
+; REQUIRES: asserts
+; RUN: llc < %s -mtriple=x86_64-apple-darwin -lazy-live-intervals \
+; RUN:   -verify-machineinstrs | FileCheck %s
+; RUN: llc < %s -mtriple=x86_64-apple-darwin -lazy-live-intervals -stats \
+; RUN:   -o /dev/null 2>&1 | FileCheck %s --check-prefix=STATS
+; RUN: llc < %s -mtriple=x86_64-apple-darwin -lazy-live-intervals \
+; RUN:   -verify-coalescing -verify-regalloc -o /dev/null
+
+; Intervals computed on demand must give the same correct code, and the
+; verifier must not expect an interval for a register nothing has queried.
+; CHECK-LABEL: sum:
+; CHECK: addl
+; CHECK: ret
+
+; STATS: Number of virtual register intervals computed
+; STATS: Number of virtual registers with defs or uses
+
+define i32 @sum(i32* %p, i32 %n) {
+entry:
+  %cmp = icmp sgt i32 %n, 0
+  br i1 %cmp, label %loop, label %exit
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %s = phi i32 [ 0, %entry ], [ %s.next, %loop ]
+  %idx = sext i32 %i to i64
+  %addr = getelementptr i32* %p, i64 %idx
+  %v = load i32* %addr
+  %s.next = add i32 %s, %v
+  %i.next = add i32 %i, 1
+  %done = icmp eq i32 %i.next, %n
+  br i1 %done, label %exit, label %loop
+
+exit:
+  %r = phi i32 [ 0, %entry ], [ %s.next, %loop ]
+  ret i32 %r
+}
@@ -0,0 +1,30 @@
+; RUN: llc < %s -mtriple=x86_64-apple-darwin -mcpu=corei7-avx -loop-trace-report -o /dev/null 2>&1 | FileCheck %s
+
+; CHECK: Loop trace report for BB#{{[0-9]+}} in 'sum' (depth 1, 1 blocks):
+; CHECK-NEXT: instructions: {{[0-9]+}}
+; CHECK-NEXT: critical path: {{[0-9]+}} cycles
+; CHECK-NEXT: resource length: {{[0-9]+}} cycles
+; CHECK-NEXT: bound: {{latency|resources}}
+; CHECK: SBPort{{[0-9]+}}: {{[0-9]+}} cycles
+
+define i32 @sum(i32* %p, i32 %n) nounwind {
+entry:
+  %cmp0 = icmp sgt i32 %n, 0
+  br i1 %cmp0, label %loop, label %exit
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %acc = phi i32 [ 0, %entry ], [ %acc.next, %loop ]
+  %idx = sext i32 %i to i64
+  %addr = getelementptr i32* %p, i64 %idx
+  %v = load i32* %addr
+  %m = mul i32 %v, %v
+  %acc.next = add i32 %acc, %m
+  %i.next = add i32 %i, 1
+  %cmp = icmp slt i32 %i.next, %n
+  br i1 %cmp, label %loop, label %exit
+
+exit:
+  %r = phi i32 [ 0, %entry ], [ %acc.next, %loop ]
+  ret i32 %r
+}
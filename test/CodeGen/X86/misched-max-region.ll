@@ -0,0 +1,38 @@
+; REQUIRES: asserts
+; RUN: llc < %s -march=x86-64 -mcpu=core2 -enable-misched -verify-misched \
+; RUN:   -debug-only=misched -o - 2>&1 > /dev/null \
+; RUN:   | FileCheck %s --check-prefix=DEFAULT
+; RUN: llc < %s -march=x86-64 -mcpu=core2 -enable-misched -verify-misched \
+; RUN:   -misched-max-region-instrs=4 -debug-only=misched -o - 2>&1 > /dev/null \
+; RUN:   | FileCheck %s --check-prefix=LIMIT
+;
+; Without a limit, the straight-line block below is scheduled as a single
+; region.  With a limit of four, it is cut into regions of four, four and
+; three instructions, and the instruction above each cut is left in place as
+; the boundary of the next region.
+;
+; DEFAULT: RegionInstrs: 13 Remaining: 0
+; DEFAULT-NOT: RegionInstrs:
+;
+; LIMIT: RegionInstrs: 4 Remaining: 9
+; LIMIT: RegionInstrs: 4 Remaining: 4
+; LIMIT: RegionInstrs: 3 Remaining: 0
+; LIMIT-NOT: RegionInstrs:
+
+define i64 @f(i64* %p, i64 %a) {
+  %p1 = getelementptr i64* %p, i64 1
+  %p2 = getelementptr i64* %p, i64 2
+  %p3 = getelementptr i64* %p, i64 3
+  %v0 = load i64* %p
+  %v1 = load i64* %p1
+  %v2 = load i64* %p2
+  %v3 = load i64* %p3
+  %s0 = add i64 %v0, %a
+  %s1 = mul i64 %v1, %s0
+  %s2 = xor i64 %v2, %s1
+  %s3 = sub i64 %v3, %s2
+  store i64 %s0, i64* %p
+  store i64 %s1, i64* %p1
+  store i64 %s2, i64* %p2
+  ret i64 %s3
+}
@@ -0,0 +1,62 @@
+; RUN: llc < %s -mtriple=x86_64-apple-darwin -regalloc=linearscan \
+; RUN:   -verify-machineinstrs | FileCheck %s
+
+declare void @g()
+
+; Values live across the call must end up in callee-saved registers or on
+; the stack.
+; CHECK-LABEL: across_call:
+; CHECK: callq _g
+; CHECK: ret
+define i64 @across_call(i64 %a, i64 %b, i64 %c) {
+  call void @g()
+  %s = add i64 %a, %b
+  %t = add i64 %s, %c
+  ret i64 %t
+}
+
+; More live values than registers forces spilling.
+; CHECK-LABEL: pressure:
+; CHECK: ret
+define i32 @pressure(i32* %p) {
+  %p1 = getelementptr i32* %p, i64 1
+  %p2 = getelementptr i32* %p, i64 2
+  %p3 = getelementptr i32* %p, i64 3
+  %p4 = getelementptr i32* %p, i64 4
+  %p5 = getelementptr i32* %p, i64 5
+  %p6 = getelementptr i32* %p, i64 6
+  %p7 = getelementptr i32* %p, i64 7
+  %v0 = load volatile i32* %p
+  %v1 = load volatile i32* %p1
+  %v2 = load volatile i32* %p2
+  %v3 = load volatile i32* %p3
+  %v4 = load volatile i32* %p4
+  %v5 = load volatile i32* %p5
+  %v6 = load volatile i32* %p6
+  %v7 = load volatile i32* %p7
+  %w0 = load volatile i32* %p
+  %w1 = load volatile i32* %p1
+  %w2 = load volatile i32* %p2
+  %w3 = load volatile i32* %p3
+  %w4 = load volatile i32* %p4
+  %w5 = load volatile i32* %p5
+  %w6 = load volatile i32* %p6
+  %w7 = load volatile i32* %p7
+  call void @g()
+  %a0 = add i32 %v0, %w7
+  %a1 = add i32 %v1, %w6
+  %a2 = add i32 %v2, %w5
+  %a3 = add i32 %v3, %w4
+  %a4 = add i32 %v4, %w3
+  %a5 = add i32 %v5, %w2
+  %a6 = add i32 %v6, %w1
+  %a7 = add i32 %v7, %w0
+  %b0 = mul i32 %a0, %a1
+  %b1 = mul i32 %a2, %a3
+  %b2 = mul i32 %a4, %a5
+  %b3 = mul i32 %a6, %a7
+  %c0 = xor i32 %b0, %b1
+  %c1 = xor i32 %b2, %b3
+  %r = sub i32 %c0, %c1
+  ret i32 %r
+}
@@ -0,0 +1,57 @@
+; RUN: llc < %s -mtriple=x86_64-linux-gnu -filetype=obj -o %t.elf
+; RUN: llvm-readobj -stackmap %t.elf | FileCheck %s
+; RUN: llc < %s -mtriple=x86_64-apple-darwin -filetype=obj -o %t.macho
+; RUN: llvm-readobj -stackmap %t.macho | FileCheck %s
+;
+; Check that ELF objects get a stack map section too, and that it can be read
+; back with StackMapParser.
+
+; CHECK:      StackMap {
+; CHECK-NEXT:   Constants [
+; CHECK-NEXT:     Constant: 4294967296
+; CHECK-NEXT:   ]
+; CHECK-NEXT:   Record {
+; CHECK-NEXT:     ID: 1
+; CHECK-NEXT:     InstructionOffset:
+; CHECK-NEXT:     Location {
+; CHECK-NEXT:       Kind: Constant
+; CHECK-NEXT:       Size: 8
+; CHECK-NEXT:       Value: 65535
+; CHECK-NEXT:     }
+; CHECK-NEXT:     Location {
+; CHECK-NEXT:       Kind: ConstantIndex
+; CHECK-NEXT:       Size: 8
+; CHECK-NEXT:       Value: 4294967296
+; CHECK-NEXT:     }
+; CHECK-NEXT:     Location {
+; CHECK-NEXT:       Kind: Register
+; CHECK-NEXT:       Size: 8
+; CHECK-NEXT:       DwarfRegNum: 5
+; CHECK-NEXT:     }
+; CHECK-NEXT:   }
+; CHECK-NEXT:   Record {
+; CHECK-NEXT:     ID: 2
+; CHECK-NEXT:     InstructionOffset:
+; CHECK-NEXT:     Location {
+; CHECK-NEXT:       Kind: Register
+; CHECK-NEXT:       Size: 8
+; CHECK-NEXT:       DwarfRegNum: {{[0-9]+}}
+; CHECK-NEXT:     }
+; CHECK-NEXT:   }
+; CHECK-NEXT: }
+
+define void @constants(i64 %a) {
+entry:
+  tail call void (i64, i32, ...)* @llvm.experimental.stackmap(i64 1, i32 0, i64 65535, i64 4294967296, i64 %a)
+  ret void
+}
+
+define i64 @patch(i64 %a, i64 %b) {
+entry:
+  %f = inttoptr i64 12345678 to i8*
+  %r = tail call i64 (i64, i32, i8*, i32, ...)* @llvm.experimental.patchpoint.i64(i64 2, i32 15, i8* %f, i32 1, i64 %a, i64 %b)
+  ret i64 %r
+}
+
+declare void @llvm.experimental.stackmap(i64, i32, ...)
+declare i64 @llvm.experimental.patchpoint.i64(i64, i32, i8*, i32, ...)
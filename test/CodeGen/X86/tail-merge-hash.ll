@@ -0,0 +1,53 @@
+; RUN: llc < %s -mtriple=x86_64-apple-darwin -stats 2>&1 | FileCheck %s
+; REQUIRES: asserts
+;
+; All the returning blocks end in the same instruction, but only %c and %d
+; share a long enough tail.  The other pairs are ruled out by hashing their
+; last instructions, without comparing the blocks.
+
+; CHECK-DAG: 1 branchfolding - Number of block tails merged
+; CHECK-DAG: branchfolding - Number of tail comparisons ruled out by hash
+
+@a = external global i32
+@b = external global i32
+@c = external global i32
+
+define void @f(i32 %x) nounwind {
+entry:
+  switch i32 %x, label %e [
+    i32 0, label %a
+    i32 1, label %b
+    i32 2, label %c
+    i32 3, label %d
+  ]
+
+a:
+  store volatile i32 1, i32* @a
+  store volatile i32 1, i32* @b
+  store volatile i32 1, i32* @c
+  ret void
+
+b:
+  store volatile i32 2, i32* @a
+  store volatile i32 2, i32* @b
+  store volatile i32 2, i32* @c
+  ret void
+
+c:
+  store volatile i32 3, i32* @a
+  store volatile i32 3, i32* @b
+  store volatile i32 3, i32* @c
+  ret void
+
+d:
+  store volatile i32 3, i32* @a
+  store volatile i32 3, i32* @b
+  store volatile i32 3, i32* @c
+  ret void
+
+e:
+  store volatile i32 5, i32* @a
+  store volatile i32 5, i32* @b
+  store volatile i32 5, i32* @c
+  ret void
+}
@@ -0,0 +1,31 @@
+; RUN: llc < %s -mtriple=x86_64-apple-darwin -verify-machineinstrs \
+; RUN:   -verify-machineinstrs-incremental -stats -o /dev/null 2>&1 \
+; RUN:   | FileCheck %s
+; REQUIRES: asserts
+;
+; Incremental verification skips the verifier runs after passes that left
+; the function unchanged.
+
+; CHECK: {{[1-9][0-9]*}} machine-verifier - Number of machine functions verified
+; CHECK: {{[1-9][0-9]*}} machine-verifier - Number of unchanged machine functions not verified
+
+define i32 @sum(i32* %p, i32 %n) nounwind {
+entry:
+  %cmp0 = icmp sgt i32 %n, 0
+  br i1 %cmp0, label %loop, label %exit
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %acc = phi i32 [ 0, %entry ], [ %acc.next, %loop ]
+  %idx = sext i32 %i to i64
+  %addr = getelementptr i32* %p, i64 %idx
+  %v = load i32* %addr
+  %acc.next = add i32 %acc, %v
+  %i.next = add i32 %i, 1
+  %cmp = icmp slt i32 %i.next, %n
+  br i1 %cmp, label %loop, label %exit
+
+exit:
+  %r = phi i32 [ 0, %entry ], [ %acc.next, %loop ]
+  ret i32 %r
+}
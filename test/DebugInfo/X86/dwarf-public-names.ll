@@ -42,13 +42,13 @@
 ; Skip the output to the header of the pubnames section.
 ; LINUX: debug_pubnames
 
-; Check for each name in the output.
-; LINUX: global_namespace_variable
+; Check for each name in the output, which is sorted by name.
+; LINUX: global_function
 ; LINUX: global_namespace_function
-; LINUX: static_member_function
+; LINUX: global_namespace_variable
 ; LINUX: global_variable
-; LINUX: global_function
 ; LINUX: member_function
+; LINUX: static_member_function
 
 %struct.C = type { i8 }
 
@@ -115,8 +115,8 @@
 ; CHECK-NEXT: "bar"
 ; CHECK-NEXT: unit_size = 0x0000005d
 ; CHECK-NEXT: Offset Name
-; CHECK-NEXT: "int"
 ; CHECK-NEXT: "echidna::capybara::mongoose::fluffy"
+; CHECK-NEXT: "int"
 ; CHECK-NEXT: unit_size = 0x0000003a
 ; CHECK-NEXT: Offset Name
 ; CHECK-NEXT: "wombat"
@@ -39,13 +39,13 @@
 ; CHECK: debug_pubnames
 ; CHECK: version = 0x0002
 
-; Check for each name in the output.
-; CHECK: global_namespace_variable
+; Check for each name in the output, which is sorted by name.
+; CHECK: global_function
 ; CHECK: global_namespace_function
-; CHECK: static_member_function
+; CHECK: global_namespace_variable
 ; CHECK: global_variable
-; CHECK: global_function
 ; CHECK: member_function
+; CHECK: static_member_function
 
 %struct.C = type { i8 }
 
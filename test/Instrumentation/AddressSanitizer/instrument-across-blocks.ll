@@ -0,0 +1,116 @@
+; Test that AddressSanitizer does not check a temp again when it was checked
+; on every path to an access, and checks loop invariant temps once before
+; loops without calls.
+; RUN: opt < %s -asan -S | FileCheck %s
+; RUN: opt < %s -asan -S -asan-opt-across-blocks=0 | FileCheck %s -check-prefix=NOOPT
+
+target datalayout = "e-p:64:64:64-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f32:32:32-f64:64:64-v64:64:64-v128:128:128-a0:0:64-s0:64:64-f80:128:128-n8:16:32:64"
+target triple = "x86_64-unknown-linux-gnu"
+
+declare void @f()
+
+; Both branches store to %a, so the load after the join is not checked.
+define i32 @Diamond(i32* %a, i1 %c) sanitize_address {
+entry:
+  br i1 %c, label %then, label %else
+then:
+  store i32 1, i32* %a
+  br label %join
+else:
+  store i32 2, i32* %a
+  br label %join
+join:
+  %v = load i32* %a
+  ret i32 %v
+}
+; CHECK-LABEL: @Diamond
+; CHECK: __asan_report_store4
+; CHECK: __asan_report_store4
+; CHECK-NOT: __asan_report_
+; CHECK: ret i32
+; NOOPT-LABEL: @Diamond
+; NOOPT: __asan_report_store4
+; NOOPT: __asan_report_store4
+; NOOPT: __asan_report_load4
+; NOOPT: ret i32
+
+; Only one branch stores to %a, so the load after the join is checked.
+define i32 @HalfDiamond(i32* %a, i1 %c) sanitize_address {
+entry:
+  br i1 %c, label %then, label %join
+then:
+  store i32 1, i32* %a
+  br label %join
+join:
+  %v = load i32* %a
+  ret i32 %v
+}
+; CHECK-LABEL: @HalfDiamond
+; CHECK: __asan_report_store4
+; CHECK: __asan_report_load4
+; CHECK: ret i32
+
+; A call between the accesses may free the memory.
+define i32 @CallBetween(i32* %a, i1 %c) sanitize_address {
+entry:
+  store i32 1, i32* %a
+  br i1 %c, label %then, label %join
+then:
+  call void @f()
+  br label %join
+join:
+  %v = load i32* %a
+  ret i32 %v
+}
+; CHECK-LABEL: @CallBetween
+; CHECK: __asan_report_store4
+; CHECK: __asan_report_load4
+; CHECK: ret i32
+
+; The load of %a in the loop header is checked once in the preheader, %b
+; varies in the loop and is checked on each iteration.
+define i32 @Loop(i32* %a, i32* %b, i64 %n) sanitize_address {
+entry:
+  br label %loop
+loop:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %loop ]
+  %s = phi i32 [ 0, %entry ], [ %s.next, %loop ]
+  %x = load i32* %a
+  %p = getelementptr i32* %b, i64 %i
+  %y = load i32* %p
+  %t = add i32 %x, %y
+  %s.next = add i32 %s, %t
+  %i.next = add i64 %i, 1
+  %done = icmp eq i64 %i.next, %n
+  br i1 %done, label %exit, label %loop
+exit:
+  ret i32 %s.next
+}
+; CHECK-LABEL: @Loop
+; CHECK: entry:
+; CHECK: __asan_report_load4(i64 %{{.*}})
+; CHECK: loop:
+; CHECK-NOT: __asan_report_
+; CHECK: load i32* %a
+; CHECK: __asan_report_load4
+; CHECK-NOT: __asan_report_
+; CHECK: ret i32
+
+; The call in the loop prevents hoisting.
+define i32 @LoopWithCall(i32* %a, i64 %n) sanitize_address {
+entry:
+  br label %loop
+loop:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %loop ]
+  %x = load i32* %a
+  call void @f()
+  %i.next = add i64 %i, 1
+  %done = icmp eq i64 %i.next, %n
+  br i1 %done, label %exit, label %loop
+exit:
+  ret i32 %x
+}
+; CHECK-LABEL: @LoopWithCall
+; CHECK: loop:
+; CHECK: __asan_report_load4
+; CHECK: ret i32
@@ -0,0 +1,59 @@
+; RUN: opt < %s -exec-counters -S | FileCheck %s
+
+; CHECK: @__llvm_exec_count_loop = global [2 x i64] zeroinitializer
+; CHECK: @__llvm_exec_count_critical = global [2 x i64] zeroinitializer
+; CHECK-NOT: @__llvm_exec_count_external
+
+declare void @external()
+
+define i32 @loop(i32 %n) {
+; CHECK-LABEL: define i32 @loop(
+; CHECK-NEXT: entry:
+; CHECK-NEXT: alloca
+; CHECK-NEXT: load i64* getelementptr inbounds ([2 x i64]* @__llvm_exec_count_loop, i64 0, i64 0)
+; CHECK-NEXT: add i64 %{{.*}}, 1
+; CHECK-NEXT: store i64 %{{.*}}, i64* getelementptr inbounds ([2 x i64]* @__llvm_exec_count_loop, i64 0, i64 0)
+entry:
+  %slot = alloca i32
+  br label %body
+
+; The latch has a single successor, so the count goes before its branch.
+; CHECK: latch:
+; CHECK: load i64* getelementptr inbounds ([2 x i64]* @__llvm_exec_count_loop, i64 0, i64 1)
+; CHECK: br label %body
+body:
+  %i = phi i32 [ 0, %entry ], [ %next, %latch ]
+  %next = add i32 %i, 1
+  %done = icmp eq i32 %next, %n
+  br i1 %done, label %exit, label %latch
+
+latch:
+  call void @external()
+  br label %body
+
+exit:
+  ret i32 %next
+}
+
+define void @critical(i32 %n) {
+; CHECK-LABEL: define void @critical(
+entry:
+  br label %body
+
+; The back-edge is critical and gets its own block.
+; CHECK: body:
+; CHECK: br i1 %done, label %exit, label %body.body_crit_edge
+; CHECK: body.body_crit_edge:
+; CHECK-NEXT: load i64* getelementptr inbounds ([2 x i64]* @__llvm_exec_count_critical, i64 0, i64 1)
+; CHECK-NEXT: add
+; CHECK-NEXT: store
+; CHECK-NEXT: br label %body
+body:
+  %i = phi i32 [ 0, %entry ], [ %next, %body ]
+  %next = add i32 %i, 1
+  %done = icmp eq i32 %next, %n
+  br i1 %done, label %exit, label %body
+
+exit:
+  ret void
+}
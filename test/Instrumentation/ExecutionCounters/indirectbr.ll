@@ -0,0 +1,34 @@
+; RUN: opt < %s -exec-counters -S | FileCheck %s
+
+; The back-edge out of the indirectbr is critical and cannot be split, so it
+; is left uncounted.  The function entry is still counted.
+
+; CHECK: @__llvm_exec_count_dispatch = global [2 x i64] zeroinitializer
+
+@targets = constant [2 x i8*] [i8* blockaddress(@dispatch, %body), i8* blockaddress(@dispatch, %exit)]
+
+define void @dispatch(i32 %n) {
+; CHECK-LABEL: define void @dispatch(
+; CHECK-NEXT: entry:
+; CHECK-NEXT: load i64* getelementptr inbounds ([2 x i64]* @__llvm_exec_count_dispatch, i64 0, i64 0)
+; CHECK-NEXT: add i64
+; CHECK-NEXT: store i64 %{{.*}}, i64* getelementptr inbounds ([2 x i64]* @__llvm_exec_count_dispatch, i64 0, i64 0)
+; CHECK-NOT: @__llvm_exec_count_dispatch
+; CHECK: indirectbr i8* %dest, [label %body, label %exit]
+; CHECK-NOT: @__llvm_exec_count_dispatch
+; CHECK: ret void
+entry:
+  br label %body
+
+body:
+  %i = phi i32 [ 0, %entry ], [ %next, %body ]
+  %next = add i32 %i, 1
+  %done = icmp uge i32 %next, %n
+  %idx = zext i1 %done to i64
+  %slot = getelementptr [2 x i8*]* @targets, i64 0, i64 %idx
+  %dest = load i8** %slot
+  indirectbr i8* %dest, [label %body, label %exit]
+
+exit:
+  ret void
+}
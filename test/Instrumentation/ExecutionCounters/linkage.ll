@@ -0,0 +1,26 @@
+; RUN: opt < %s -exec-counters -S | FileCheck %s
+
+; The counters of a function have the function's linkage and visibility, so
+; that modules defining the same inline function share its counters.  Those
+; of a private function are internal, to keep a name the JIT can look up.
+
+; CHECK-DAG: @__llvm_exec_count_odr = linkonce_odr hidden global [2 x i64] zeroinitializer
+; CHECK-DAG: @__llvm_exec_count_weak = weak protected global [2 x i64] zeroinitializer
+; CHECK-DAG: @__llvm_exec_count_local = internal global [2 x i64] zeroinitializer
+; CHECK-DAG: @__llvm_exec_count_priv = internal global [2 x i64] zeroinitializer
+
+define linkonce_odr hidden void @odr() {
+  ret void
+}
+
+define weak protected void @weak() {
+  ret void
+}
+
+define internal void @local() {
+  ret void
+}
+
+define private void @priv() {
+  ret void
+}
@@ -0,0 +1,58 @@
+; RUN: opt < %s -tsan -S | FileCheck %s
+; RUN: opt < %s -tsan -tsan-skip-non-captured=0 -S | FileCheck %s -check-prefix=ALL
+
+target datalayout = "e-p:64:64:64-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f32:32:32-f64:64:64-v64:64:64-v128:128:128-a0:0:64-s0:64:64-f80:128:128-n8:16:32:64-S128"
+
+declare void @escape(i32*)
+
+@sink = global i32* null, align 8
+
+define i32 @NotCaptured(i32 %x) nounwind uwtable sanitize_thread {
+entry:
+  %a = alloca i32, align 4
+  store i32 %x, i32* %a, align 4
+  %v = load i32* %a, align 4
+  ret i32 %v
+}
+; CHECK-LABEL: define i32 @NotCaptured
+; CHECK-NOT: __tsan_read
+; CHECK-NOT: __tsan_write
+; CHECK: ret i32
+; ALL-LABEL: define i32 @NotCaptured
+; ALL: __tsan_write4
+; ALL: ret i32
+
+define i32 @NotCapturedArray(i64 %i) nounwind uwtable sanitize_thread {
+entry:
+  %a = alloca [4 x i32], align 4
+  %p = getelementptr inbounds [4 x i32]* %a, i64 0, i64 %i
+  store i32 1, i32* %p, align 4
+  %v = load i32* %p, align 4
+  ret i32 %v
+}
+; CHECK-LABEL: define i32 @NotCapturedArray
+; CHECK-NOT: __tsan_read
+; CHECK-NOT: __tsan_write
+; CHECK: ret i32
+
+define i32 @CapturedByCall() nounwind uwtable sanitize_thread {
+entry:
+  %a = alloca i32, align 4
+  call void @escape(i32* %a)
+  store i32 1, i32* %a, align 4
+  ret i32 0
+}
+; CHECK-LABEL: define i32 @CapturedByCall
+; CHECK: __tsan_write4
+; CHECK: ret i32
+
+define i32 @CapturedByStore() nounwind uwtable sanitize_thread {
+entry:
+  %a = alloca i32, align 4
+  store i32* %a, i32** @sink, align 8
+  %v = load i32* %a, align 4
+  ret i32 %v
+}
+; CHECK-LABEL: define i32 @CapturedByStore
+; CHECK: __tsan_read4
+; CHECK: ret i32
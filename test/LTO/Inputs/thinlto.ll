@@ -0,0 +1,12 @@
+target triple = "x86_64-unknown-linux-gnu"
+
+define i32 @bar(i32 %x) {
+  %a = mul i32 %x, 3
+  ret i32 %a
+}
+
+define i32 @baz(i32 %x) {
+  %a = call i32 @bar(i32 %x)
+  %b = mul i32 %a, 5
+  ret i32 %b
+}
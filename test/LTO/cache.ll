@@ -0,0 +1,31 @@
+; RUN: rm -rf %t.cache
+; RUN: llvm-as < %s > %t1
+; RUN: llvm-lto -exported-symbol=foo -cache-dir=%t.cache -o %t2 %t1
+; RUN: ls %t.cache | count 1
+; RUN: llvm-lto -exported-symbol=foo -cache-dir=%t.cache -o %t3 %t1
+; RUN: ls %t.cache | count 1
+; RUN: cmp %t2 %t3
+
+; A different set of preserved symbols changes the key.
+; RUN: llvm-lto -exported-symbol=foo -exported-symbol=bar \
+; RUN:     -cache-dir=%t.cache -o %t4 %t1
+; RUN: ls %t.cache | count 2
+
+; ThinLTO caches each module separately.
+; RUN: rm -rf %t.thin
+; RUN: llvm-as < %p/Inputs/thinlto.ll > %t5
+; RUN: llvm-lto -thinlto -exported-symbol=foo -cache-dir=%t.thin -o %t6 %t1 %t5
+; RUN: ls %t.thin | count 2
+; RUN: llvm-lto -thinlto -exported-symbol=foo -cache-dir=%t.thin -o %t7 %t1 %t5
+; RUN: ls %t.thin | count 2
+; RUN: cmp %t6.0 %t7.0
+; RUN: cmp %t6.1 %t7.1
+
+target triple = "x86_64-unknown-linux-gnu"
+
+declare i32 @bar(i32)
+
+define i32 @foo(i32 %x) {
+  %a = call i32 @bar(i32 %x)
+  ret i32 %a
+}
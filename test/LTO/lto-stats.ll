@@ -0,0 +1,12 @@
+; RUN: llvm-as < %s > %t1
+; RUN: llvm-lto -exported-symbol=foo -lto-stats -o %t2 %t1 2>&1 | FileCheck %s
+
+; CHECK: lto-stats: link: resident {{[0-9.]+}} MB, peak {{[0-9.]+}} MB
+; CHECK: lto-stats: optimization: resident
+; CHECK: lto-stats: code generation: resident
+
+target triple = "x86_64-unknown-linux-gnu"
+
+define i32 @foo() {
+  ret i32 0
+}
@@ -0,0 +1,28 @@
+; RUN: llvm-as < %s > %t1
+; RUN: llvm-lto -exported-symbol=foo -disable-opt -partitions=2 -o %t2 %t1
+; RUN: llvm-nm %t2.0 | FileCheck %s -check-prefix=PART0
+; RUN: llvm-nm %t2.1 | FileCheck %s -check-prefix=PART1
+
+; foo and bar land in different partitions, so the internal bar must be
+; renamed and made visible to the other object.
+
+; PART0: U bar.lto.priv
+; PART0: T foo
+; PART1: T bar.lto.priv
+; PART1-NOT: foo
+
+target triple = "x86_64-unknown-linux-gnu"
+
+define i32 @foo(i32 %x) {
+  %a = add i32 %x, 1
+  %b = call i32 @bar(i32 %a)
+  %c = mul i32 %b, 3
+  ret i32 %c
+}
+
+define i32 @bar(i32 %x) {
+  %a = add i32 %x, 2
+  %b = mul i32 %a, 5
+  %c = sub i32 %b, 7
+  ret i32 %c
+}
@@ -0,0 +1,20 @@
+; RUN: llvm-as < %s > %t1
+; RUN: llvm-lto -exported-symbol=foo -preempted-symbol=bar -o %t2 %t1
+; RUN: llvm-nm %t2 | FileCheck %s
+
+; The linker uses a definition of bar from outside the LTO inputs, so ours is
+; dropped and foo calls the external one.
+
+; CHECK: U bar
+; CHECK: T foo
+
+target triple = "x86_64-unknown-linux-gnu"
+
+define i32 @foo() {
+  %r = call i32 @bar()
+  ret i32 %r
+}
+
+define weak i32 @bar() {
+  ret i32 1
+}
@@ -0,0 +1,26 @@
+; RUN: llvm-as < %s > %t1
+; RUN: llvm-as < %p/Inputs/thinlto.ll > %t2
+; RUN: llvm-lto -thinlto -exported-symbol=foo -o %t3 %t1 %t2
+; RUN: llvm-nm %t3.0 | FileCheck %s -check-prefix=MOD0
+; RUN: llvm-nm %t3.1 | FileCheck %s -check-prefix=MOD1
+
+; bar is small enough to be imported and inlined into foo, so this module
+; no longer refers to it.  The other module must still define bar, which this
+; module originally called, but baz is used by nobody and is internalized
+; and removed.
+
+; MOD0: T foo
+; MOD0-NOT: bar
+
+; MOD1: T bar
+; MOD1-NOT: baz
+
+target triple = "x86_64-unknown-linux-gnu"
+
+declare i32 @bar(i32)
+
+define i32 @foo(i32 %x) {
+  %a = call i32 @bar(i32 %x)
+  %b = add i32 %a, 1
+  ret i32 %b
+}
@@ -0,0 +1,18 @@
+%T = type { i32 }
+
+@g = external global %T
+@h = global %T* @g
+@w = weak global i32 1
+
+define i32 @b() {
+  %1 = call i32 @used()
+  ret i32 %1
+}
+
+define linkonce_odr i32 @used() {
+  ret i32 1
+}
+
+define linkonce_odr i32 @unused() {
+  ret i32 0
+}
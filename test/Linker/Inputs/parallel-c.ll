@@ -0,0 +1,9 @@
+@w = global i32 2
+
+define i32 @c() {
+  ret i32 2
+}
+
+define linkonce_odr i32 @used() {
+  ret i32 1
+}
@@ -0,0 +1,10 @@
+%B = type { i32, %B* }
+%C = type { i64, %C* }
+%O = type opaque
+%D = type { %O* }
+%X = type { i16 }
+
+@b = global %B zeroinitializer
+@c = global %C zeroinitializer
+@d = global %D zeroinitializer
+@x = global %X zeroinitializer
@@ -0,0 +1,34 @@
+; RUN: llvm-link %s %S/Inputs/parallel-b.ll %S/Inputs/parallel-c.ll -S \
+; RUN:   | FileCheck %s
+; RUN: llvm-link -parallel -threads=2 %s %S/Inputs/parallel-b.ll \
+; RUN:   %S/Inputs/parallel-c.ll -S | FileCheck %s
+; RUN: llvm-link -parallel -threads=3 %s %S/Inputs/parallel-b.ll \
+; RUN:   %S/Inputs/parallel-c.ll -S | FileCheck %s
+
+; Linking the inputs in concurrent shares resolves the same definitions as a
+; sequential link.  Linkonce functions may end up in a different order.
+
+%T = type { i32 }
+
+@g = global %T zeroinitializer
+
+declare i32 @b()
+declare i32 @c()
+
+define i32 @a() {
+  %1 = call i32 @b()
+  %2 = call i32 @c()
+  %3 = add i32 %1, %2
+  ret i32 %3
+}
+
+; CHECK: %T = type { i32 }
+; CHECK-NOT: type
+; CHECK: @g = global %T zeroinitializer
+; CHECK: @h = global %T* @g
+; CHECK: @w = global i32 2
+; CHECK: define i32 @a()
+; CHECK-DAG: define i32 @b()
+; CHECK-DAG: define linkonce_odr i32 @used()
+; CHECK-DAG: define i32 @c()
+; CHECK-NOT: @unused
@@ -0,0 +1,32 @@
+; RUN: llvm-link %s %S/Inputs/type-merge-shape.ll -S | FileCheck %s
+; RUN: llvm-link %s %S/Inputs/type-merge-shape.ll -S | FileCheck %s \
+; RUN:   --check-prefix=ONE
+
+; A struct type from the second module is mapped onto a type already in the
+; destination that has the same structure and the same name once the ".N"
+; suffixes are stripped, even if the destination type with that exact name has
+; a different body.  Types with different names are never merged.
+
+%A = type { i32, %A* }
+%F = type { i8 }
+%E = type { %F* }
+%X = type { i8 }
+%X.5 = type { i16 }
+
+@a = global %A zeroinitializer
+@e = global %E zeroinitializer
+@x0 = global %X zeroinitializer
+@x5 = global %X.5 zeroinitializer
+
+; CHECK-DAG: %B = type { i32, %B* }
+; CHECK-DAG: %C = type { i64, %C* }
+; CHECK-DAG: %D = type { %O* }
+; CHECK-DAG: %X.5 = type { i16 }
+
+; CHECK-DAG: @b = global %B zeroinitializer
+; CHECK-DAG: @c = global %C zeroinitializer
+; CHECK-DAG: @d = global %D zeroinitializer
+; CHECK-DAG: @x = global %X.5 zeroinitializer
+
+; ONE: = type { i16 }
+; ONE-NOT: = type { i16 }
@@ -0,0 +1,33 @@
+// RUN: llvm-mc -filetype=obj -compress-debug-sections -triple x86_64-pc-linux-gnu < %s | llvm-readobj -s -sd | FileCheck %s
+// RUN: llvm-mc -filetype=obj -compress-debug-sections -triple x86_64-pc-linux-gnu < %s | llvm-dwarfdump -debug-dump=str - | FileCheck --check-prefix=STR %s
+// RUN: llvm-mc -filetype=obj -compress-debug-sections -triple x86_64-pc-linux-gnu < %s | llvm-readobj -r | FileCheck --check-prefix=RELOC %s
+// REQUIRES: zlib
+
+// A debug section that shrinks is renamed and starts with the zlib header.
+// CHECK: Name: .zdebug_str
+// CHECK: SectionData (
+// CHECK-NEXT: 0000: 5A4C4942 00000000 00000060
+
+// A section that would grow is left alone.
+// CHECK: Name: .debug_abbrev
+// CHECK-NOT: Name: .zdebug_abbrev
+
+// The consumer sees the uncompressed strings.
+// STR: .debug_str contents:
+// STR: 0x00000000: "{{a+}}"
+
+// Relocations of a compressed section keep their uncompressed offsets.
+// RELOC: Section ({{[0-9]+}}) .rela.zdebug_info {
+// RELOC-NEXT: 0x40 R_X86_64_32 .zdebug_str 0x0
+// RELOC-NEXT: }
+
+	.section	.debug_str,"MS",@progbits,1
+.Linfo_string0:
+	.asciz	"aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa"
+	.asciz	"aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa"
+	.section	.debug_abbrev,"",@progbits
+	.byte	0
+	.section	.debug_info,"",@progbits
+	.zero	64
+	.long	.Linfo_string0
+	.zero	64
@@ -0,0 +1,21 @@
+# RUN: llvm-mc -filetype=obj -compress-debug-sections -triple mipsel-unknown-linux < %s | llvm-readobj -r | FileCheck %s
+# REQUIRES: zlib
+
+# Mips sorts the relocations of each section by looking at their fixups, so
+# those must outlive the fragments that compression replaces.
+# CHECK: Section ({{[0-9]+}}) .rel.zdebug_info {
+# CHECK-NEXT: 0x40 R_MIPS_32 .Linfo_string0 0x0
+# CHECK-NEXT: 0x84 R_MIPS_32 .Linfo_string1 0x0
+# CHECK-NEXT: }
+
+	.section	.debug_str,"MS",@progbits,1
+.Linfo_string0:
+	.asciz	"aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa"
+.Linfo_string1:
+	.asciz	"aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa"
+	.section	.debug_info,"",@progbits
+	.zero	64
+	.long	.Linfo_string0
+	.zero	64
+	.long	.Linfo_string1
+	.zero	64
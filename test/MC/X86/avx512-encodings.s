@@ -43,3 +43,35 @@ vpbroadcastd  %xmm0, %zmm1 {%k1} {z}
 // CHECK: vmovdqu64 {{.*}} {%k3}
 // CHECK: encoding: [0x62,0xf1,0xfe,0x4b,0x6f,0xc8]
 vmovdqu64 %zmm0, %zmm1 {%k3}
+
+// CHECK: vaddps {{.*}} {%k1}
+// CHECK: encoding: [0x62,0xf1,0x74,0x49,0x58,0xc2]
+vaddps %zmm2, %zmm1, %zmm0 {%k1}
+
+// CHECK: vaddpd {{.*}} {%k1}
+// CHECK: encoding: [0x62,0xf1,0xf5,0x49,0x58,0xc2]
+vaddpd %zmm2, %zmm1, %zmm0 {%k1}
+
+// CHECK: vsubps {{.*}} {%k2}
+// CHECK: encoding: [0x62,0xa1,0x74,0x42,0x5c,0xc2]
+vsubps %zmm18, %zmm17, %zmm16 {%k2}
+
+// CHECK: vmulpd {{.*}} {%k7}
+// CHECK: encoding: [0x62,0xf1,0xf5,0x4f,0x59,0xc2]
+vmulpd %zmm2, %zmm1, %zmm0 {%k7}
+
+// CHECK: vdivps {{.*}} {%k1}
+// CHECK: encoding: [0x62,0xf1,0x74,0x49,0x5e,0xc2]
+vdivps %zmm2, %zmm1, %zmm0 {%k1}
+
+// CHECK: vpaddd {{.*}} {%k1}
+// CHECK: encoding: [0x62,0xf1,0x75,0x49,0xfe,0xc2]
+vpaddd %zmm2, %zmm1, %zmm0 {%k1}
+
+// CHECK: vpsubq {{.*}} {%k1}
+// CHECK: encoding: [0x62,0xf1,0xf5,0x49,0xfb,0xc2]
+vpsubq %zmm2, %zmm1, %zmm0 {%k1}
+
+// CHECK: vpmulld {{.*}} {%k3}
+// CHECK: encoding: [0x62,0xa2,0x55,0x43,0x40,0xe6]
+vpmulld %zmm22, %zmm21, %zmm20 {%k3}
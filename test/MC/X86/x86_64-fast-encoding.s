@@ -0,0 +1,61 @@
+// RUN: llvm-mc -triple x86_64-unknown-unknown --show-encoding %s | FileCheck %s
+// RUN: llvm-mc -triple x86_64-unknown-unknown --show-encoding \
+// RUN:   -x86-fast-encoding=false %s | FileCheck %s
+
+// The table driven encoder for register and immediate forms has to produce
+// the same bytes and fixups as the general one.
+
+// CHECK: addl %ecx, %eax
+// CHECK: encoding: [0x01,0xc8]
+	addl %ecx, %eax
+
+// CHECK: addq %r8, %rax
+// CHECK: encoding: [0x4c,0x01,0xc0]
+	addq %r8, %rax
+
+// CHECK: movb %sil, %al
+// CHECK: encoding: [0x40,0x88,0xf0]
+	movb %sil, %al
+
+// CHECK: addsd %xmm8, %xmm1
+// CHECK: encoding: [0xf2,0x41,0x0f,0x58,0xc8]
+	addsd %xmm8, %xmm1
+
+// CHECK: pshufb %xmm1, %xmm2
+// CHECK: encoding: [0x66,0x0f,0x38,0x00,0xd1]
+	pshufb %xmm1, %xmm2
+
+// CHECK: pushq %r12
+// CHECK: encoding: [0x41,0x54]
+	pushq %r12
+
+// CHECK: shll $3, %r9d
+// CHECK: encoding: [0x41,0xc1,0xe1,0x03]
+	shll $3, %r9d
+
+// CHECK: addw $1000, %cx
+// CHECK: encoding: [0x66,0x81,0xc1,0xe8,0x03]
+	addw $1000, %cx
+
+// CHECK: movq $foo, %rax
+// CHECK: encoding: [0x48,0xc7,0xc0,A,A,A,A]
+// CHECK: fixup A - offset: 3, value: foo, kind: reloc_signed_4byte
+	movq $foo, %rax
+
+// CHECK: ret
+// CHECK: encoding: [0xc3]
+	retq
+
+// The x87 escape byte is part of the template too.
+
+// CHECK: fadd %st(1)
+// CHECK: encoding: [0xd8,0xc1]
+	fadd %st(1)
+
+// CHECK: fxch %st(2)
+// CHECK: encoding: [0xd9,0xca]
+	fxch %st(2)
+
+// CHECK: fucompi %st(2)
+// CHECK: encoding: [0xdf,0xea]
+	fucomip %st(2), %st
@@ -0,0 +1,12 @@
+; Output written through a memory mapping matches output written with write.
+; RUN: opt %s -o %t.mapped.bc
+; RUN: opt %s -mmap-output=false -o %t.written.bc
+; RUN: cmp %t.mapped.bc %t.written.bc
+; RUN: llvm-link %s -o %t.linked.bc
+; RUN: llvm-dis < %t.linked.bc | FileCheck %s
+
+; CHECK: define i32 @f
+
+define i32 @f(i32 %x) {
+  ret i32 %x
+}
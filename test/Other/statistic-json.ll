@@ -0,0 +1,15 @@
+; REQUIRES: asserts
+; RUN: opt < %s -disable-output -stats -stats-json -instcombine -info-output-file - | FileCheck %s
+
+; The statistics are printed as one JSON object, sorted by debug type and
+; keyed by debug type and variable name.
+
+; CHECK: {
+; CHECK: "instcombine.NumCombined": {{[0-9]+}},
+; CHECK: }
+
+define i32 @f(i32 %x) {
+  %a = add i32 %x, 1
+  %b = add i32 %a, 1
+  ret i32 %b
+}
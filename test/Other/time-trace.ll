@@ -0,0 +1,10 @@
+; RUN: opt < %s -instcombine -time-trace-file=%t.json -disable-output
+; RUN: FileCheck %s < %t.json
+
+; CHECK: "traceEvents"
+; CHECK: "ph":"X",{{.*}}"name":"Combine redundant instructions","args":{"detail":"foo"}
+
+define i32 @foo(i32 %x) {
+  %y = add i32 %x, 0
+  ret i32 %y
+}
@@ -0,0 +1,27 @@
+; RUN: opt -constmerge -S < %s | FileCheck %s
+
+; Merging @x2 into @x1 makes the initializers of @p1 and @p2 equal, and
+; merging those makes the ones of @q1 and @q2 equal: all are merged in one
+; run of the pass.
+
+; CHECK: @[[P:p[12]]] = internal unnamed_addr constant i32* @[[X:x[12]]]
+; CHECK-NEXT: @[[X]] = internal unnamed_addr constant i32 1
+; CHECK-NEXT: @[[Q:q[12]]] = internal unnamed_addr constant i32** @[[P]]
+; CHECK-NOT: {{^@}}
+; CHECK: call void @use(i32*** @[[Q]])
+; CHECK-NEXT: call void @use(i32*** @[[Q]])
+
+@x1 = internal unnamed_addr constant i32 1
+@p1 = internal unnamed_addr constant i32* @x1
+@q1 = internal unnamed_addr constant i32** @p1
+@x2 = internal unnamed_addr constant i32 1
+@p2 = internal unnamed_addr constant i32* @x2
+@q2 = internal unnamed_addr constant i32** @p2
+
+declare void @use(i32***)
+
+define void @f() {
+  call void @use(i32*** @q1)
+  call void @use(i32*** @q2)
+  ret void
+}
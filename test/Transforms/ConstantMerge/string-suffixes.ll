@@ -0,0 +1,52 @@
+; RUN: opt -constmerge -S < %s | FileCheck %s
+; RUN: opt -constmerge -constmerge-string-suffixes=false -S < %s \
+; RUN:   | FileCheck %s --check-prefix=OFF
+
+; Local unnamed_addr strings that end a longer string constant are replaced
+; with a pointer into the longest string ending with them.
+
+; CHECK-NOT: @bar =
+; CHECK-NOT: @ar =
+; CHECK: @foobar = constant [7 x i8] c"foobar\00"
+; CHECK: @obar.named = internal constant [5 x i8] c"obar\00"
+; CHECK: @xbar.aligned = internal unnamed_addr constant [5 x i8] c"xbar\00", align 4
+; CHECK: @baz = internal unnamed_addr constant [4 x i8] c"baz\00"
+; CHECK-NOT: @r =
+
+; OFF: @bar =
+; OFF: @ar =
+; OFF: @r =
+
+@bar = internal unnamed_addr constant [4 x i8] c"bar\00"
+@foobar = constant [7 x i8] c"foobar\00"
+@ar = private unnamed_addr constant [3 x i8] c"ar\00"
+; Not merged: its address may be compared.
+@obar.named = internal constant [5 x i8] c"obar\00"
+; Not merged: a pointer into @foobar is not aligned.
+@xbar.aligned = internal unnamed_addr constant [5 x i8] c"xbar\00", align 4
+@baz = internal unnamed_addr constant [4 x i8] c"baz\00"
+@r = internal unnamed_addr constant [2 x i8] c"r\00"
+
+declare void @use(i8*)
+declare void @use.array([4 x i8]*)
+
+; CHECK-LABEL: @f(
+; CHECK-NEXT: call void @use(i8* getelementptr inbounds ([7 x i8]* @foobar, i64 0, i64 3))
+; CHECK-NEXT: call void @use(i8* getelementptr inbounds ([7 x i8]* @foobar, i64 0, i64 5))
+; CHECK-NEXT: call void @use(i8* getelementptr inbounds ([5 x i8]* @obar.named, i64 0, i64 0))
+; CHECK-NEXT: call void @use(i8* getelementptr inbounds ([7 x i8]* @foobar, i64 0, i64 5))
+; CHECK-NEXT: call void @use(i8* getelementptr inbounds ([5 x i8]* @xbar.aligned, i64 0, i64 0))
+; CHECK-NEXT: call void @use(i8* getelementptr inbounds ([4 x i8]* @baz, i64 0, i64 0))
+; CHECK-NEXT: call void @use(i8* getelementptr inbounds ([7 x i8]* @foobar, i64 0, i64 4))
+; CHECK-NEXT: call void @use.array([4 x i8]* bitcast (i8* getelementptr inbounds ([7 x i8]* @foobar, i64 0, i64 3) to [4 x i8]*))
+define void @f() {
+  call void @use(i8* getelementptr inbounds ([4 x i8]* @bar, i64 0, i64 0))
+  call void @use(i8* getelementptr inbounds ([3 x i8]* @ar, i64 0, i64 1))
+  call void @use(i8* getelementptr inbounds ([5 x i8]* @obar.named, i64 0, i64 0))
+  call void @use(i8* getelementptr inbounds ([2 x i8]* @r, i64 0, i64 0))
+  call void @use(i8* getelementptr inbounds ([5 x i8]* @xbar.aligned, i64 0, i64 0))
+  call void @use(i8* getelementptr inbounds ([4 x i8]* @baz, i64 0, i64 0))
+  call void @use(i8* getelementptr ([3 x i8]* @ar, i64 0, i64 0))
+  call void @use.array([4 x i8]* @bar)
+  ret void
+}
@@ -0,0 +1,33 @@
+; RUN: opt < %s -correlated-propagation -S | FileCheck %s --check-prefix=CHECK --check-prefix=FULL
+; RUN: opt < %s -correlated-propagation -lvi-max-block-values=1 -S | FileCheck %s --check-prefix=CHECK --check-prefix=LIMIT
+
+; Once more block values than -lvi-max-block-values have been solved, LVI
+; empties its cache before the next query.  Answers can then be less precise:
+; when %c is next queried on the edge into %if.end8, its value in %entry is
+; no longer cached.  The solver leaves %c overdefined in %if.then while it
+; solves %entry, and then reuses that overdefined value.
+
+; CHECK-LABEL: @test(
+define i1 @test(i32 %c) {
+entry:
+  %cmp = icmp slt i32 %c, 5
+  br i1 %cmp, label %if.then, label %if.end
+
+if.then:
+  %cmp1 = icmp eq i32 %c, 4
+  br i1 %cmp1, label %if.end, label %if.end8
+
+if.end:
+  ret i1 true
+
+if.end8:
+  %cmp2 = icmp eq i32 %c, 3
+  %cmp3 = icmp eq i32 %c, 4
+  %cmp4 = icmp eq i32 %c, 6
+; FULL: %or = or i1 false, false
+; LIMIT: %cmp4 = icmp eq i32 %c, 6
+; LIMIT: %or = or i1 false, %cmp4
+  %or = or i1 %cmp3, %cmp4
+; CHECK: ret i1 %cmp2
+  ret i1 %cmp2
+}
@@ -0,0 +1,55 @@
+; RUN: opt < %s -S -basicaa -early-cse | FileCheck %s
+; RUN: opt < %s -S -basicaa -early-cse -earlycse-max-alias-queries=0 | FileCheck %s -check-prefix=NOAA
+
+declare void @clobber()
+
+; The store to the local %buf cannot modify *%p.
+define i32 @store_noalias(i32* %p) {
+  %buf = alloca i32
+  %a = load i32* %p
+  store i32 1, i32* %buf
+  %b = load i32* %p
+  %c = add i32 %a, %b
+  ret i32 %c
+; CHECK-LABEL: @store_noalias(
+; CHECK: %a = load i32* %p
+; CHECK-NOT: load
+; CHECK: add i32 %a, %a
+
+; NOAA-LABEL: @store_noalias(
+; NOAA: %b = load i32* %p
+}
+
+; A store through another argument may alias.
+define i32 @store_mayalias(i32* %p, i32* %q) {
+  %a = load i32* %p
+  store i32 1, i32* %q
+  %b = load i32* %p
+  %c = add i32 %a, %b
+  ret i32 %c
+; CHECK-LABEL: @store_mayalias(
+; CHECK: %b = load i32* %p
+}
+
+; An unknown call may write to the argument, but not to a local alloca
+; whose address does not escape.
+define i32 @call_local() {
+  %buf = alloca i32
+  store i32 7, i32* %buf
+  call void @clobber()
+  %v = load i32* %buf
+  ret i32 %v
+; CHECK-LABEL: @call_local(
+; CHECK-NOT: load
+; CHECK: ret i32 7
+}
+
+define i32 @call_arg(i32* %p) {
+  %a = load i32* %p
+  call void @clobber()
+  %b = load i32* %p
+  %c = add i32 %a, %b
+  ret i32 %c
+; CHECK-LABEL: @call_arg(
+; CHECK: %b = load i32* %p
+}
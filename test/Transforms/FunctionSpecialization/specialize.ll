@@ -0,0 +1,80 @@
+; RUN: opt < %s -function-specialization -ipsccp -S | FileCheck %s
+; RUN: opt < %s -function-specialization -func-spec-budget=0 -S | FileCheck %s -check-prefix=NOBUDGET
+
+; @scale is called with a constant mode from a loop, so it is cloned and the
+; clone folds down to the multiply by 4.  The cold call with mode 2 stays.
+
+define i32 @scale(i32 %x, i32 %mode) {
+entry:
+  %is.shift = icmp eq i32 %mode, 1
+  br i1 %is.shift, label %shift, label %mul
+
+shift:
+  %s = shl i32 %x, 2
+  ret i32 %s
+
+mul:
+  %m = mul i32 %x, %mode
+  ret i32 %m
+}
+
+define i32 @hot_loop(i32 %n) {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %acc = phi i32 [ 0, %entry ], [ %acc.next, %loop ]
+  %r = call i32 @scale(i32 %i, i32 1)
+  %acc.next = add i32 %acc, %r
+  %i.next = add i32 %i, 1
+  %done = icmp eq i32 %i.next, %n
+  br i1 %done, label %exit, label %loop
+
+exit:
+  %c = call i32 @scale(i32 %acc.next, i32 2)
+  ret i32 %c
+}
+
+; CHECK-LABEL: define i32 @hot_loop(
+; CHECK: call i32 @scale.spec(i32 %i, i32 1)
+; CHECK: call i32 @scale(i32 %acc.next, i32 2)
+
+; NOBUDGET-NOT: @scale.spec
+
+; A byval argument is a private copy, so passing a global to it is not a
+; constant that can be substituted.
+%struct.cfg = type { i32 }
+@cfg = global %struct.cfg { i32 7 }
+
+define i32 @read(%struct.cfg* byval %c) {
+entry:
+  %p = getelementptr %struct.cfg* %c, i32 0, i32 0
+  %v = load i32* %p
+  ret i32 %v
+}
+
+define i32 @byval_loop(i32 %n) {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %r = call i32 @read(%struct.cfg* byval @cfg)
+  %i.next = add i32 %i, %r
+  %done = icmp sge i32 %i.next, %n
+  br i1 %done, label %exit, label %loop
+
+exit:
+  ret i32 %i.next
+}
+
+; CHECK-LABEL: define i32 @byval_loop(
+; CHECK: call i32 @read(%struct.cfg* byval @cfg)
+; CHECK-NOT: @read.spec
+
+; Clones are added at the end of the module.
+; CHECK-LABEL: define internal i32 @scale.spec(
+; CHECK-NOT: icmp
+; CHECK: shl i32 %x, 2
+; CHECK-NOT: mul
@@ -0,0 +1,54 @@
+; RUN: echo '!9 = metadata !{metadata !"%T/spanning-tree.ll", metadata !0}' > %t1
+; RUN: cat %s %t1 > %t2
+; RUN: opt -insert-gcov-profiling -S < %t2 | FileCheck %s --check-prefix=ALL
+; RUN: opt -insert-gcov-profiling -gcov-spanning-tree -S < %t2 | FileCheck %s
+; RUN: rm %T/spanning-tree.gcno
+
+; Every edge has a counter by default.
+; ALL: @__llvm_gcov_ctr = internal global [5 x i64] zeroinitializer
+; ALL: select i1 %cmp, i64 2, i64 3
+
+; With a spanning tree only the loop's back edge and the return are counted,
+; and the loop branch adds its condition to the back edge's counter.
+; CHECK: @__llvm_gcov_ctr = internal global [2 x i64] zeroinitializer
+; CHECK-LABEL: define void @test(
+; CHECK-NOT: select
+; CHECK: loop:
+; CHECK: [[TAKEN:%[0-9]+]] = zext i1 %cmp to i64
+; CHECK: add i64 %{{[0-9]+}}, [[TAKEN]]
+; CHECK: br i1 %cmp, label %loop, label %exit
+; CHECK: exit:
+; CHECK: getelementptr inbounds ([2 x i64]* @__llvm_gcov_ctr, i64 0, i64 1)
+; CHECK: ret void
+
+define void @test(i32 %n) {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %inc, %loop ]
+  %inc = add i32 %i, 1
+  %cmp = icmp slt i32 %inc, %n
+  br i1 %cmp, label %loop, label %exit
+
+exit:
+  ret void, !dbg !8
+}
+
+; REQUIRES: shell
+
+!llvm.gcov = !{!9}
+!llvm.dbg.cu = !{!0}
+!llvm.module.flags = !{!12}
+
+!0 = metadata !{i32 786449, metadata !11, i32 4, metadata !"clang version 3.5", i1 false, metadata !"", i32 0, metadata !3, metadata !3, metadata !4, metadata !3, null, metadata !""} ; [ DW_TAG_compile_unit ]
+!3 = metadata !{i32 0}
+!4 = metadata !{metadata !5}
+!5 = metadata !{i32 786478, metadata !10, metadata !6, metadata !"test", metadata !"test", metadata !"", i32 1, metadata !7, i1 false, i1 true, i32 0, i32 0, null, i32 256, i1 false, void (i32)* @test, null, null, metadata !3, i32 1} ; [ DW_TAG_subprogram ] [line 1] [def] [test]
+!6 = metadata !{i32 786473, metadata !10} ; [ DW_TAG_file_type ]
+!7 = metadata !{i32 786453, i32 0, null, i32 0, i32 0, i64 0, i64 0, i64 0, i32 0, null, metadata !3, i32 0, i32 0} ; [ DW_TAG_subroutine_type ]
+!8 = metadata !{i32 1, i32 0, metadata !5, null}
+;; !9 is added through the echo line at the top.
+!10 = metadata !{metadata !"<stdin>", metadata !"."}
+!11 = metadata !{metadata !"spanning-tree", metadata !"."}
+!12 = metadata !{i32 1, metadata !"Debug Info Version", i32 1}
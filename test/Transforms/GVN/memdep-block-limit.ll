@@ -0,0 +1,31 @@
+; RUN: opt < %s -basicaa -gvn -S | FileCheck %s
+; RUN: opt < %s -basicaa -gvn -memdep-block-number-limit=1 -S \
+; RUN:   | FileCheck %s -check-prefix=LIMIT
+
+; With the default limit the second load is found to be redundant. With a
+; limit of one block, the query into %join's two predecessors gives up.
+
+define i32 @test(i1 %c, i32* %p) {
+entry:
+  %a = load i32* %p
+  br i1 %c, label %left, label %right
+
+left:
+  br label %join
+
+right:
+  br label %join
+
+join:
+  %b = load i32* %p
+  %s = add i32 %a, %b
+  ret i32 %s
+}
+
+; CHECK-LABEL: @test(
+; CHECK-NOT: %b = load
+; CHECK: %s = add i32 %a, %a
+
+; LIMIT-LABEL: @test(
+; LIMIT: %b = load i32* %p
+; LIMIT: %s = add i32 %a, %b
@@ -0,0 +1,162 @@
+; RUN: opt < %s -basicaa -gvn -enable-load-pre-multi-pred -S | FileCheck %s
+; RUN: opt < %s -basicaa -gvn -S | FileCheck %s --check-prefix=DEFAULT
+
+target datalayout = "e-p:64:64:64-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f32:32:32-f64:64:64-v64:64:64-v128:128:128-a0:0:64-s0:64:64-f80:128:128-n8:16:32:64-S128"
+
+; The load in %join is available from both hot predecessors.  Reloading in
+; the two cold ones is cheaper than loading in %join.
+
+; CHECK-LABEL: @cold_preds(
+; CHECK: cold1:
+; CHECK-NEXT: %v.pre{{[0-9]*}} = load i32* %p
+; CHECK: cold2:
+; CHECK-NEXT: %v.pre{{[0-9]*}} = load i32* %p
+; CHECK: join:
+; CHECK-NEXT: %v = phi i32
+; CHECK-NEXT: ret i32 %v
+
+; DEFAULT-LABEL: @cold_preds(
+; DEFAULT: join:
+; DEFAULT-NEXT: %v = load i32* %p
+define i32 @cold_preds(i32* %p, i32 %sel) {
+entry:
+  switch i32 %sel, label %hot1 [
+    i32 1, label %hot2
+    i32 2, label %cold1
+    i32 3, label %cold2
+  ], !prof !0
+
+hot1:
+  %a = load i32* %p
+  call void @use(i32 %a)
+  br label %join
+
+hot2:
+  %b = load i32* %p
+  call void @use(i32 %b)
+  br label %join
+
+cold1:
+  br label %join
+
+cold2:
+  br label %join
+
+join:
+  %v = load i32* %p
+  ret i32 %v
+}
+
+; Without branch weights the unavailable predecessors run as often as the
+; available ones, so the load stays.
+
+; CHECK-LABEL: @even_preds(
+; CHECK: join:
+; CHECK-NEXT: %v = load i32* %p
+define i32 @even_preds(i32* %p, i32 %sel) {
+entry:
+  switch i32 %sel, label %hot1 [
+    i32 1, label %hot2
+    i32 2, label %cold1
+    i32 3, label %cold2
+  ]
+
+hot1:
+  %a = load i32* %p
+  call void @use(i32 %a)
+  br label %join
+
+hot2:
+  %b = load i32* %p
+  call void @use(i32 %b)
+  br label %join
+
+cold1:
+  br label %join
+
+cold2:
+  br label %join
+
+join:
+  %v = load i32* %p
+  ret i32 %v
+}
+
+; The unavailable predecessors are taken exactly half as often as %join is
+; entered, which is not cheaper.
+
+; CHECK-LABEL: @half_preds(
+; CHECK: join:
+; CHECK-NEXT: %v = load i32* %p
+define i32 @half_preds(i32* %p, i32 %sel) {
+entry:
+  switch i32 %sel, label %hot1 [
+    i32 1, label %hot2
+    i32 2, label %cold1
+    i32 3, label %cold2
+  ], !prof !1
+
+hot1:
+  %a = load i32* %p
+  call void @use(i32 %a)
+  br label %join
+
+hot2:
+  %b = load i32* %p
+  call void @use(i32 %b)
+  br label %join
+
+cold1:
+  br label %join
+
+cold2:
+  br label %join
+
+join:
+  %v = load i32* %p
+  ret i32 %v
+}
+
+; Just less than half as often: 99 of every 200 entries.
+
+; CHECK-LABEL: @under_half_preds(
+; CHECK: cold1:
+; CHECK-NEXT: %v.pre{{[0-9]*}} = load i32* %p
+; CHECK: cold2:
+; CHECK-NEXT: %v.pre{{[0-9]*}} = load i32* %p
+; CHECK: join:
+; CHECK-NEXT: %v = phi i32
+define i32 @under_half_preds(i32* %p, i32 %sel) {
+entry:
+  switch i32 %sel, label %hot1 [
+    i32 1, label %hot2
+    i32 2, label %cold1
+    i32 3, label %cold2
+  ], !prof !2
+
+hot1:
+  %a = load i32* %p
+  call void @use(i32 %a)
+  br label %join
+
+hot2:
+  %b = load i32* %p
+  call void @use(i32 %b)
+  br label %join
+
+cold1:
+  br label %join
+
+cold2:
+  br label %join
+
+join:
+  %v = load i32* %p
+  ret i32 %v
+}
+
+declare void @use(i32) readnone
+
+!0 = metadata !{metadata !"branch_weights", i32 50, i32 50, i32 1, i32 1}
+!1 = metadata !{metadata !"branch_weights", i32 2, i32 2, i32 1, i32 3}
+!2 = metadata !{metadata !"branch_weights", i32 51, i32 50, i32 50, i32 49}
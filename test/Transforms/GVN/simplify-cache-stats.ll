@@ -0,0 +1,14 @@
+; RUN: opt < %s -gvn -instsimplify-cache -stats -disable-output 2>&1 | FileCheck %s
+; REQUIRES: asserts
+
+; The redundant add makes GVN go over the function a second time, where the
+; instructions that did not simplify the first time are answered by the cache.
+
+; CHECK: 3 instsimplify - Number of queries answered by simplification caches
+
+define i32 @f(i32 %a, i32 %b) {
+  %x = add i32 %a, %b
+  %y = add i32 %a, %b
+  %z = mul i32 %x, %y
+  ret i32 %z
+}
@@ -0,0 +1,15 @@
+; RUN: opt < %s -gvn -instsimplify-cache -S | FileCheck %s
+
+; The redundant add makes GVN go over the function a second time; the answers
+; from the simplification cache must not change the result.
+
+define i32 @f(i32 %a, i32 %b) {
+; CHECK-LABEL: @f(
+; CHECK-NEXT: %x = add i32 %a, %b
+; CHECK-NEXT: %z = mul i32 %x, %x
+; CHECK-NEXT: ret i32 %z
+  %x = add i32 %a, %b
+  %y = add i32 %a, %b
+  %z = mul i32 %x, %y
+  ret i32 %z
+}
@@ -0,0 +1,20 @@
+; RUN: opt < %s -globalopt -stats -disable-output 2>&1 | FileCheck %s
+; REQUIRES: asserts
+
+; Deleting @a leaves @b dead, which leaves @c and @f dead, which leaves @d dead.
+; All of them go in one step, before @e is visited.
+
+; CHECK: 1 globalopt - Number of functions deleted
+; CHECK: 4 globalopt - Number of globals deleted
+
+@a = internal global [2 x i8*]* @b
+@b = internal global [2 x i8*] [i8* bitcast (i32** @c to i8*), i8* bitcast (void ()* @f to i8*)]
+@c = internal global i32* @d
+@d = internal global i32 1
+@e = global i32* @g
+@g = global i32 0
+
+define internal void @f() {
+  store i32 2, i32* @d
+  ret void
+}
@@ -0,0 +1,28 @@
+; RUN: opt < %s -globalopt -S | FileCheck %s
+
+; Deleting @a leaves @b dead, which leaves @c and @f dead, which leaves @d dead.
+; All of them go in one step, before @e is visited.
+
+; CHECK-NOT: @a
+; CHECK-NOT: @b
+; CHECK-NOT: @c
+; CHECK-NOT: @d
+; CHECK-NOT: @f
+; CHECK: @e = global i32* @g
+; CHECK-NOT: @a
+; CHECK-NOT: @b
+; CHECK-NOT: @c
+; CHECK-NOT: @d
+; CHECK-NOT: @f
+
+@a = internal global [2 x i8*]* @b
+@b = internal global [2 x i8*] [i8* bitcast (i32** @c to i8*), i8* bitcast (void ()* @f to i8*)]
+@c = internal global i32* @d
+@d = internal global i32 1
+@e = global i32* @g
+@g = global i32 0
+
+define internal void @f() {
+  store i32 2, i32* @d
+  ret void
+}
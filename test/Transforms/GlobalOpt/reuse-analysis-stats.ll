@@ -0,0 +1,49 @@
+; RUN: opt < %s -globalopt -stats -disable-output 2>&1 | FileCheck %s
+; RUN: opt < %s -globalopt -globalopt-reuse-analysis=false -stats \
+; RUN:   -disable-output 2>&1 | FileCheck %s -check-prefix=NOREUSE
+; REQUIRES: asserts
+
+; Deleting @dead makes GlobalOpt go over the module a second time. @h has
+; enough uses to be remembered, and nothing about it changed, so the second
+; visit does not analyze it again.
+
+; CHECK: 1 globalopt - Number of functions deleted
+; CHECK: 1 globalopt - Number of unchanged globals not analyzed again
+
+; NOREUSE-NOT: Number of unchanged globals not analyzed again
+
+@h = internal global i32 0
+
+declare void @use(i32)
+
+define internal void @dead() {
+  ret void
+}
+
+define void @f(i32 %x) {
+  store i32 %x, i32* @h
+  %v0 = load i32* @h
+  call void @use(i32 %v0)
+  store i32 %x, i32* @h
+  %v1 = load i32* @h
+  call void @use(i32 %v1)
+  store i32 %x, i32* @h
+  %v2 = load i32* @h
+  call void @use(i32 %v2)
+  store i32 %x, i32* @h
+  %v3 = load i32* @h
+  call void @use(i32 %v3)
+  store i32 %x, i32* @h
+  %v4 = load i32* @h
+  call void @use(i32 %v4)
+  store i32 %x, i32* @h
+  %v5 = load i32* @h
+  call void @use(i32 %v5)
+  store i32 %x, i32* @h
+  %v6 = load i32* @h
+  call void @use(i32 %v6)
+  store i32 %x, i32* @h
+  %v7 = load i32* @h
+  call void @use(i32 %v7)
+  ret void
+}
@@ -0,0 +1,110 @@
+; RUN: opt < %s -inline -S | FileCheck %s
+; RUN: opt < %s -inline -inlinecold-threshold=225 -S | FileCheck %s -check-prefix=NOCOLD
+
+; Call sites that are cold, either because the callee is marked cold or
+; because branch weights say the call's block is rarely entered, are inlined
+; with the lower -inlinecold-threshold.
+
+@a = global i32 4
+
+; This function is smaller than the default inline threshold (225), but larger
+; than the cold threshold (75).
+define i32 @inner() {
+  %a1 = load volatile i32* @a
+  %x1 = add i32 %a1, %a1
+  %a2 = load volatile i32* @a
+  %x2 = add i32 %x1, %a2
+  %a3 = load volatile i32* @a
+  %x3 = add i32 %x2, %a3
+  %a4 = load volatile i32* @a
+  %x4 = add i32 %x3, %a4
+  %a5 = load volatile i32* @a
+  %x5 = add i32 %x4, %a5
+  %a6 = load volatile i32* @a
+  %x6 = add i32 %x5, %a6
+  %a7 = load volatile i32* @a
+  %x7 = add i32 %x6, %a7
+  %a8 = load volatile i32* @a
+  %x8 = add i32 %x7, %a8
+  %a9 = load volatile i32* @a
+  %x9 = add i32 %x8, %a9
+  %a10 = load volatile i32* @a
+  %x10 = add i32 %x9, %a10
+  %a11 = load volatile i32* @a
+  %x11 = add i32 %x10, %a11
+  %a12 = load volatile i32* @a
+  %x12 = add i32 %x11, %a12
+  ret i32 %x12
+}
+
+define i32 @cold_inner() cold {
+  %a1 = load volatile i32* @a
+  %x1 = add i32 %a1, %a1
+  %a2 = load volatile i32* @a
+  %x2 = add i32 %x1, %a2
+  %a3 = load volatile i32* @a
+  %x3 = add i32 %x2, %a3
+  %a4 = load volatile i32* @a
+  %x4 = add i32 %x3, %a4
+  %a5 = load volatile i32* @a
+  %x5 = add i32 %x4, %a5
+  %a6 = load volatile i32* @a
+  %x6 = add i32 %x5, %a6
+  %a7 = load volatile i32* @a
+  %x7 = add i32 %x6, %a7
+  %a8 = load volatile i32* @a
+  %x8 = add i32 %x7, %a8
+  %a9 = load volatile i32* @a
+  %x9 = add i32 %x8, %a9
+  %a10 = load volatile i32* @a
+  %x10 = add i32 %x9, %a10
+  %a11 = load volatile i32* @a
+  %x11 = add i32 %x10, %a11
+  %a12 = load volatile i32* @a
+  %x12 = add i32 %x11, %a12
+  ret i32 %x12
+}
+
+; CHECK-LABEL: @likely(
+; CHECK-NOT: call
+; CHECK: ret
+define i32 @likely(i1 %c) {
+entry:
+  br i1 %c, label %then, label %else, !prof !0
+
+then:
+  %r = call i32 @inner()
+  ret i32 %r
+
+else:
+  ret i32 0
+}
+
+; CHECK-LABEL: @unlikely(
+; CHECK: call i32 @inner()
+; NOCOLD-LABEL: @unlikely(
+; NOCOLD-NOT: call
+; NOCOLD: ret
+define i32 @unlikely(i1 %c) {
+entry:
+  br i1 %c, label %then, label %else, !prof !0
+
+then:
+  ret i32 0
+
+else:
+  %r = call i32 @inner()
+  ret i32 %r
+}
+
+; CHECK-LABEL: @cold_callee(
+; CHECK: call i32 @cold_inner()
+; NOCOLD-LABEL: @cold_callee(
+; NOCOLD-NOT: call
+; NOCOLD: ret
+define i32 @cold_callee() {
+  %r = call i32 @cold_inner()
+  ret i32 %r
+}
+
+!0 = metadata !{metadata !"branch_weights", i32 64, i32 4}
@@ -0,0 +1,42 @@
+; REQUIRES: asserts
+; RUN: opt < %s -inline -inline-threshold=20 -stats -disable-output 2>&1 | FileCheck %s
+
+; @a and @b form one SCC.  Inlining @small into @a makes the inliner go over
+; the SCC's call sites again; @b is unchanged, so the costs of its call
+; sites are reused.
+
+; CHECK: 1 inline      - Number of functions inlined
+; CHECK: 4 inline      - Number of inline costs reused across iterations
+; CHECK: 5 inline-cost - Number of call sites analyzed
+
+declare void @ext(i32)
+
+define internal void @small(i32 %x) {
+  call void @ext(i32 %x)
+  ret void
+}
+
+define void @big(i32 %x) {
+  call void @ext(i32 %x)
+  call void @ext(i32 %x)
+  call void @ext(i32 %x)
+  call void @ext(i32 %x)
+  call void @ext(i32 %x)
+  call void @ext(i32 %x)
+  call void @ext(i32 %x)
+  call void @ext(i32 %x)
+  ret void
+}
+
+define void @a(i32 %x) {
+  call void @small(i32 %x)
+  call void @b(i32 %x)
+  ret void
+}
+
+define void @b(i32 %x) {
+  call void @big(i32 %x)
+  call void @big(i32 %x)
+  call void @a(i32 %x)
+  ret void
+}
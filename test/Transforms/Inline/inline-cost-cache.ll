@@ -0,0 +1,47 @@
+; RUN: opt < %s -inline -inline-threshold=20 -S | FileCheck %s
+
+; @a and @b form one SCC.  Inlining @small into @a makes the inliner go over
+; the SCC's call sites again; @b is unchanged, so the costs of its call
+; sites are reused.
+
+declare void @ext(i32)
+
+; CHECK-NOT: @small
+define internal void @small(i32 %x) {
+  call void @ext(i32 %x)
+  ret void
+}
+
+define void @big(i32 %x) {
+  call void @ext(i32 %x)
+  call void @ext(i32 %x)
+  call void @ext(i32 %x)
+  call void @ext(i32 %x)
+  call void @ext(i32 %x)
+  call void @ext(i32 %x)
+  call void @ext(i32 %x)
+  call void @ext(i32 %x)
+  ret void
+}
+
+; CHECK-LABEL: define void @a(
+; CHECK-NEXT: call void @ext(i32 %x)
+; CHECK-NEXT: call void @b(i32 %x)
+; CHECK-NEXT: ret void
+define void @a(i32 %x) {
+  call void @small(i32 %x)
+  call void @b(i32 %x)
+  ret void
+}
+
+; CHECK-LABEL: define void @b(
+; CHECK-NEXT: call void @big(i32 %x)
+; CHECK-NEXT: call void @big(i32 %x)
+; CHECK-NEXT: call void @a(i32 %x)
+; CHECK-NEXT: ret void
+define void @b(i32 %x) {
+  call void @big(i32 %x)
+  call void @big(i32 %x)
+  call void @a(i32 %x)
+  ret void
+}
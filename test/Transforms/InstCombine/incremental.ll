@@ -0,0 +1,26 @@
+; RUN: opt < %s -instcombine -S | FileCheck %s
+; RUN: opt < %s -instcombine -instcombine-incremental -S | FileCheck %s
+; RUN: opt < %s -instcombine -instcombine-max-iterations=1 -S | FileCheck %s --check-prefix=CAP
+; RUN: opt < %s -instcombine -instcombine-max-iterations=2 -S | FileCheck %s
+; RUN: opt < %s -instcombine -instcombine-max-iterations=1 -instcombine-print-stats -disable-output 2>&1 | FileCheck %s --check-prefix=CAPSTATS
+; RUN: opt < %s -instcombine -instcombine-print-stats -disable-output 2>&1 | FileCheck %s --check-prefix=STATS
+; RUN: opt < %s -instcombine -instcombine-incremental -instcombine-print-stats -disable-output 2>&1 | FileCheck %s --check-prefix=STATS
+
+define i32 @chain(i32 %x) {
+; CHECK-LABEL: @chain(
+; CHECK-NEXT: ret i32 %x
+; The first iteration folds %c to %x; the second removes the dead %a, so a
+; cap of one iteration leaves it and a cap of two does not.
+; CAP-LABEL: @chain(
+; CAP-NEXT: %a = add i32 %x, 1
+; CAP-NEXT: ret i32 %x
+  %a = add i32 %x, 1
+  %b = add i32 %a, 1
+  %c = sub i32 %b, 2
+  ret i32 %c
+}
+
+; CAPSTATS: IC: chain: 1 iterations
+
+; STATS: IC: chain: 2 iterations
+; STATS-NEXT: IC:   add: {{[0-9]+}} combines
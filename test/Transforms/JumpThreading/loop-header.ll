@@ -0,0 +1,57 @@
+; RUN: opt < %s -jump-threading -S | FileCheck %s -check-prefix=DEFAULT
+; RUN: opt < %s -jump-threading -jump-threading-across-loop-headers -S | FileCheck %s
+; RUN: opt < %s -jump-threading -jump-threading-across-loop-headers -jump-threading-header-budget=0 -S | FileCheck %s -check-prefix=DEFAULT
+
+declare void @work()
+declare void @more()
+declare void @done()
+declare i1 @next()
+
+; The header dispatches on a state that each latch sets to a constant.
+; Threading %latch.done to %exit leaves the loop, and threading %latch.more
+; to %body forms a nested loop headed by %body, which dominates it.  The
+; entry edge is not threaded: it would enter the loop at %body.  Once both
+; latches are threaded, the header is only entered from %entry and folds away.
+define void @dispatch() {
+entry:
+  br label %header
+
+header:
+  %s = phi i32 [ 1, %entry ], [ 0, %latch.done ], [ 1, %latch.more ]
+  %c = icmp eq i32 %s, 0
+  br i1 %c, label %exit, label %body
+
+body:
+  call void @work()
+  %x = call i1 @next()
+  br i1 %x, label %latch.done, label %latch.more
+
+latch.done:
+  call void @done()
+  br label %header
+
+latch.more:
+  call void @more()
+  br label %header
+
+exit:
+  ret void
+}
+
+; DEFAULT-LABEL: @dispatch(
+; DEFAULT: latch.done:
+; DEFAULT-NEXT: call void @done()
+; DEFAULT-NEXT: br label %header
+; DEFAULT: latch.more:
+; DEFAULT-NEXT: call void @more()
+; DEFAULT-NEXT: br label %header
+
+; CHECK-LABEL: @dispatch(
+; CHECK: body:
+; CHECK: br i1 %x, label %[[DONE:[a-z.0-9]+]], label %[[MORE:[a-z.0-9]+]]
+; CHECK: [[MORE]]:
+; CHECK-NEXT: call void @more()
+; CHECK-NEXT: br label %body
+; CHECK: [[DONE]]:
+; CHECK-NEXT: call void @done()
+; CHECK-NEXT: ret void
@@ -0,0 +1,76 @@
+; RUN: opt < %s -basicaa -licm -S | FileCheck %s
+
+; The store to %sum is conditional, but %sum is a local that never escapes,
+; so it can be kept in a register across the loop.
+
+; CHECK-LABEL: @cond_acc(
+; CHECK: %sum.promoted = load i32* %sum
+; CHECK: if:
+; CHECK-NOT: store
+; CHECK: exit:
+; CHECK: store i32 %{{.*}}, i32* %sum
+define i32 @cond_acc(i32* %a, i32 %n) {
+entry:
+  %sum = alloca i32
+  store i32 0, i32* %sum
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %latch ]
+  %p = getelementptr i32* %a, i32 %i
+  %v = load i32* %p
+  %c = icmp sgt i32 %v, 0
+  br i1 %c, label %if, label %latch
+
+if:
+  %s = load i32* %sum
+  %s2 = add i32 %s, %v
+  store i32 %s2, i32* %sum
+  br label %latch
+
+latch:
+  %i.next = add i32 %i, 1
+  %done = icmp eq i32 %i.next, %n
+  br i1 %done, label %exit, label %loop
+
+exit:
+  %r = load i32* %sum
+  ret i32 %r
+}
+
+; Once %sum escapes, another thread may read it, so no store may be added.
+
+; CHECK-LABEL: @captured(
+; CHECK-NOT: promoted
+; CHECK: ret i32
+define i32 @captured(i32* %a, i32 %n) {
+entry:
+  %sum = alloca i32
+  store i32 0, i32* %sum
+  call void @escape(i32* %sum)
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %latch ]
+  %p = getelementptr i32* %a, i32 %i
+  %v = load i32* %p
+  %c = icmp sgt i32 %v, 0
+  br i1 %c, label %if, label %latch
+
+if:
+  %s = load i32* %sum
+  %s2 = add i32 %s, %v
+  store i32 %s2, i32* %sum
+  br label %latch
+
+latch:
+  %i.next = add i32 %i, 1
+  %done = icmp eq i32 %i.next, %n
+  br i1 %done, label %exit, label %loop
+
+exit:
+  %r = load i32* %sum
+  ret i32 %r
+}
+
+declare void @escape(i32*)
@@ -0,0 +1,55 @@
+; RUN: opt -basicaa -loop-idiom < %s -S | FileCheck %s
+target datalayout = "e-p:64:64:64-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f32:32:32-f64:64:64-v64:64:64-v128:128:128-a0:0:64-s0:64:64-f80:128:128-n8:16:32:64"
+target triple = "x86_64-apple-darwin10.0.0"
+
+%struct.rec = type { i32, i16, i16 }
+
+; for (i = 0; i < n; ++i) { p[i].a = 0; p[i].b = 0; p[i].c = 0; }
+; The three stores cover every byte of each 8-byte element.
+define void @clear_records(%struct.rec* %p, i64 %n) nounwind ssp {
+entry:
+  br label %for.body
+
+for.body:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %for.body ]
+  %a = getelementptr inbounds %struct.rec* %p, i64 %i, i32 0
+  store i32 0, i32* %a, align 4
+  %b = getelementptr inbounds %struct.rec* %p, i64 %i, i32 1
+  store i16 0, i16* %b, align 4
+  %c = getelementptr inbounds %struct.rec* %p, i64 %i, i32 2
+  store i16 0, i16* %c, align 2
+  %i.next = add nsw i64 %i, 1
+  %done = icmp eq i64 %i.next, %n
+  br i1 %done, label %for.end, label %for.body
+
+for.end:
+  ret void
+; CHECK-LABEL: @clear_records(
+; CHECK: %[[P:.*]] = bitcast %struct.rec* %p to i8*
+; CHECK: %[[N:.*]] = mul i64 %n, 8
+; CHECK: call void @llvm.memset.p0i8.i64(i8* %[[P]], i8 0, i64 %[[N]], i32 4, i1 false)
+; CHECK-NOT: store
+}
+
+; Field c is not stored, so the bytes of each element are not all written.
+define void @partial_records(%struct.rec* %p, i64 %n) nounwind ssp {
+entry:
+  br label %for.body
+
+for.body:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %for.body ]
+  %a = getelementptr inbounds %struct.rec* %p, i64 %i, i32 0
+  store i32 0, i32* %a, align 4
+  %b = getelementptr inbounds %struct.rec* %p, i64 %i, i32 1
+  store i16 0, i16* %b, align 4
+  %i.next = add nsw i64 %i, 1
+  %done = icmp eq i64 %i.next, %n
+  br i1 %done, label %for.end, label %for.body
+
+for.end:
+  ret void
+; CHECK-LABEL: @partial_records(
+; CHECK-NOT: memset
+; CHECK: store i32 0
+; CHECK: store i16 0
+}
@@ -0,0 +1,156 @@
+; RUN: opt < %s -basicaa -loop-interchange -S | FileCheck %s
+
+target datalayout = "e-p:64:64:64-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f32:32:32-f64:64:64-v64:64:64-v128:128:128-a0:0:64-s0:64:64-f80:128:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+@A = common global [200 x [100 x i32]] zeroinitializer, align 16
+@B = common global [200 x [100 x i32]] zeroinitializer, align 16
+
+; for (i = 0; i < 100; ++i)
+;   for (j = 0; j < 200; ++j)
+;     A[j][i] += k;
+; The inner loop walks a column, so the loops are interchanged.
+
+; CHECK-LABEL: @column_walk(
+; CHECK: for.outer:
+; CHECK: %i = phi i64 [ 0, %entry ], [ %i.next, %for.outer.inc ]
+; CHECK: for.inner:
+; CHECK: %j = phi i64 [ 0, %for.outer ], [ %j.next, %for.inner ]
+; CHECK: getelementptr inbounds [200 x [100 x i32]]* @A, i64 0, i64 %i, i64 %j
+; CHECK: %exitcond = icmp eq i64 %j.next, 100
+; CHECK: for.outer.inc:
+; CHECK: %exitcond2 = icmp eq i64 %i.next, 200
+define void @column_walk(i32 %k) {
+entry:
+  br label %for.outer
+
+for.outer:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %for.outer.inc ]
+  br label %for.inner
+
+for.inner:
+  %j = phi i64 [ 0, %for.outer ], [ %j.next, %for.inner ]
+  %arrayidx = getelementptr inbounds [200 x [100 x i32]]* @A, i64 0, i64 %j, i64 %i
+  %0 = load i32* %arrayidx, align 4
+  %add = add nsw i32 %0, %k
+  store i32 %add, i32* %arrayidx, align 4
+  %j.next = add nuw nsw i64 %j, 1
+  %exitcond = icmp eq i64 %j.next, 200
+  br i1 %exitcond, label %for.outer.inc, label %for.inner
+
+for.outer.inc:
+  %i.next = add nuw nsw i64 %i, 1
+  %exitcond2 = icmp eq i64 %i.next, 100
+  br i1 %exitcond2, label %for.end, label %for.outer
+
+for.end:
+  ret void
+}
+
+; A column index hoisted into the outer loop is sunk into the new inner loop.
+
+; CHECK-LABEL: @hoisted_column(
+; CHECK: for.inner:
+; CHECK-NEXT: %j = phi
+; CHECK-NEXT: %col = add nuw nsw i64 %j, 1
+; CHECK: getelementptr inbounds [200 x [100 x i32]]* @B, i64 0, i64 %i, i64 %j
+; CHECK: getelementptr inbounds [200 x [100 x i32]]* @A, i64 0, i64 %i, i64 %col
+; CHECK: %exitcond = icmp eq i64 %j.next, 99
+; CHECK: %exitcond2 = icmp eq i64 %i.next, 200
+define void @hoisted_column() {
+entry:
+  br label %for.outer
+
+for.outer:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %for.outer.inc ]
+  %col = add nuw nsw i64 %i, 1
+  br label %for.inner
+
+for.inner:
+  %j = phi i64 [ 0, %for.outer ], [ %j.next, %for.inner ]
+  %arrayidx = getelementptr inbounds [200 x [100 x i32]]* @B, i64 0, i64 %j, i64 %i
+  %0 = load i32* %arrayidx, align 4
+  %arrayidx2 = getelementptr inbounds [200 x [100 x i32]]* @A, i64 0, i64 %j, i64 %col
+  store i32 %0, i32* %arrayidx2, align 4
+  %j.next = add nuw nsw i64 %j, 1
+  %exitcond = icmp eq i64 %j.next, 200
+  br i1 %exitcond, label %for.outer.inc, label %for.inner
+
+for.outer.inc:
+  %i.next = add nuw nsw i64 %i, 1
+  %exitcond2 = icmp eq i64 %i.next, 99
+  br i1 %exitcond2, label %for.end, label %for.outer
+
+for.end:
+  ret void
+}
+
+; for (i = 0; i < 99; ++i)
+;   for (j = 0; j < 199; ++j)
+;     A[j][i + 1] = A[j + 1][i];
+; The dependence has direction (<, >), so the loops cannot be interchanged.
+
+; CHECK-LABEL: @backward_dependence(
+; CHECK: %exitcond = icmp eq i64 %j.next, 199
+; CHECK: %exitcond2 = icmp eq i64 %i.next, 99
+define void @backward_dependence() {
+entry:
+  br label %for.outer
+
+for.outer:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %for.outer.inc ]
+  %i.1 = add nuw nsw i64 %i, 1
+  br label %for.inner
+
+for.inner:
+  %j = phi i64 [ 0, %for.outer ], [ %j.next, %for.inner ]
+  %j.1 = add nuw nsw i64 %j, 1
+  %src = getelementptr inbounds [200 x [100 x i32]]* @A, i64 0, i64 %j.1, i64 %i
+  %0 = load i32* %src, align 4
+  %dst = getelementptr inbounds [200 x [100 x i32]]* @A, i64 0, i64 %j, i64 %i.1
+  store i32 %0, i32* %dst, align 4
+  %j.next = add nuw nsw i64 %j, 1
+  %exitcond = icmp eq i64 %j.next, 199
+  br i1 %exitcond, label %for.outer.inc, label %for.inner
+
+for.outer.inc:
+  %i.next = add nuw nsw i64 %i, 1
+  %exitcond2 = icmp eq i64 %i.next, 99
+  br i1 %exitcond2, label %for.end, label %for.outer
+
+for.end:
+  ret void
+}
+
+; The inner loop already walks a row.
+
+; CHECK-LABEL: @row_walk(
+; CHECK: getelementptr inbounds [200 x [100 x i32]]* @A, i64 0, i64 %i, i64 %j
+; CHECK: %exitcond = icmp eq i64 %j.next, 100
+; CHECK: %exitcond2 = icmp eq i64 %i.next, 200
+define void @row_walk(i32 %k) {
+entry:
+  br label %for.outer
+
+for.outer:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %for.outer.inc ]
+  br label %for.inner
+
+for.inner:
+  %j = phi i64 [ 0, %for.outer ], [ %j.next, %for.inner ]
+  %arrayidx = getelementptr inbounds [200 x [100 x i32]]* @A, i64 0, i64 %i, i64 %j
+  %0 = load i32* %arrayidx, align 4
+  %add = add nsw i32 %0, %k
+  store i32 %add, i32* %arrayidx, align 4
+  %j.next = add nuw nsw i64 %j, 1
+  %exitcond = icmp eq i64 %j.next, 100
+  br i1 %exitcond, label %for.outer.inc, label %for.inner
+
+for.outer.inc:
+  %i.next = add nuw nsw i64 %i, 1
+  %exitcond2 = icmp eq i64 %i.next, 200
+  br i1 %exitcond2, label %for.end, label %for.outer
+
+for.end:
+  ret void
+}
@@ -0,0 +1,28 @@
+; RUN: opt < %s -loop-reduce -lsr-max-solver-steps=1 -S | FileCheck %s
+; RUN: opt < %s -loop-reduce -lsr-max-solver-steps=1 -stats -disable-output 2>&1 | FileCheck %s --check-prefix=STATS
+; REQUIRES: asserts
+
+target datalayout = "e-p:64:64:64-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f32:32:32-f64:64:64-v64:64:64-v128:128:128-a0:0:64-s0:64:64-f80:128:128-n8:16:32:64-S128"
+
+; With almost no budget, the solver still completes a solution greedily.
+
+; CHECK-LABEL: @zero_fill(
+; CHECK: loop:
+; CHECK: store i32 0
+; CHECK: br i1
+; STATS: loop-reduce{{ *}}- Number of loops whose LSR solver ran out of budget
+define void @zero_fill(i32* %p, i64 %n) {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %loop ]
+  %a = getelementptr i32* %p, i64 %i
+  store i32 0, i32* %a
+  %i.next = add i64 %i, 1
+  %c = icmp eq i64 %i.next, %n
+  br i1 %c, label %exit, label %loop
+
+exit:
+  ret void
+}
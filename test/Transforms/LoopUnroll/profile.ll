@@ -0,0 +1,82 @@
+; RUN: opt < %s -S -loop-unroll -unroll-use-profile | FileCheck %s
+; RUN: opt < %s -S -loop-unroll | FileCheck %s -check-prefix=NOPROFILE
+
+; A hot loop with an average trip count of about 11 is runtime unrolled by 8.
+; CHECK-LABEL: @hot(
+; CHECK: unr.cmp{{.*}}:
+; CHECK: br i1 %exitcond.7, label %for.end.loopexit{{.*}}, label %for.body
+; NOPROFILE-LABEL: @hot(
+; NOPROFILE-NOT: unr.cmp
+define i32 @hot(i32* nocapture %a, i32 %n) nounwind readonly {
+entry:
+  %cmp1 = icmp eq i32 %n, 0
+  br i1 %cmp1, label %for.end, label %for.body
+
+for.body:
+  %indvars.iv = phi i64 [ %indvars.iv.next, %for.body ], [ 0, %entry ]
+  %sum.02 = phi i32 [ %add, %for.body ], [ 0, %entry ]
+  %arrayidx = getelementptr inbounds i32* %a, i64 %indvars.iv
+  %0 = load i32* %arrayidx, align 4
+  %add = add nsw i32 %0, %sum.02
+  %indvars.iv.next = add i64 %indvars.iv, 1
+  %lftr.wideiv = trunc i64 %indvars.iv.next to i32
+  %exitcond = icmp eq i32 %lftr.wideiv, %n
+  br i1 %exitcond, label %for.end, label %for.body, !prof !0
+
+for.end:
+  %sum.0.lcssa = phi i32 [ 0, %entry ], [ %add, %for.body ]
+  ret i32 %sum.0.lcssa
+}
+
+; A loop that runs about twice per entry gets a count of 2, which leaves a
+; single remainder iteration.
+; CHECK-LABEL: @short(
+; CHECK: for.body.unr:
+; CHECK: br i1 %exitcond.1, label %for.end.loopexit{{.*}}, label %for.body
+define i32 @short(i32* nocapture %a, i32 %n) nounwind readonly {
+entry:
+  %cmp1 = icmp eq i32 %n, 0
+  br i1 %cmp1, label %for.end, label %for.body
+
+for.body:
+  %indvars.iv = phi i64 [ %indvars.iv.next, %for.body ], [ 0, %entry ]
+  %sum.02 = phi i32 [ %add, %for.body ], [ 0, %entry ]
+  %arrayidx = getelementptr inbounds i32* %a, i64 %indvars.iv
+  %0 = load i32* %arrayidx, align 4
+  %add = add nsw i32 %0, %sum.02
+  %indvars.iv.next = add i64 %indvars.iv, 1
+  %lftr.wideiv = trunc i64 %indvars.iv.next to i32
+  %exitcond = icmp eq i32 %lftr.wideiv, %n
+  br i1 %exitcond, label %for.end, label %for.body, !prof !1
+
+for.end:
+  %sum.0.lcssa = phi i32 [ 0, %entry ], [ %add, %for.body ]
+  ret i32 %sum.0.lcssa
+}
+
+; A cold loop with a constant trip count is not even fully unrolled.
+; CHECK-LABEL: @cold(
+; CHECK: br i1 %exitcond, label %for.end, label %for.body, !prof
+; NOPROFILE-LABEL: @cold(
+; NOPROFILE-NOT: br i1 %exitcond
+define i32 @cold(i32* nocapture %a) nounwind readonly {
+entry:
+  br label %for.body
+
+for.body:
+  %indvars.iv = phi i64 [ %indvars.iv.next, %for.body ], [ 0, %entry ]
+  %sum.02 = phi i32 [ %add, %for.body ], [ 0, %entry ]
+  %arrayidx = getelementptr inbounds i32* %a, i64 %indvars.iv
+  %0 = load i32* %arrayidx, align 4
+  %add = add nsw i32 %0, %sum.02
+  %indvars.iv.next = add i64 %indvars.iv, 1
+  %exitcond = icmp eq i64 %indvars.iv.next, 4
+  br i1 %exitcond, label %for.end, label %for.body, !prof !2
+
+for.end:
+  ret i32 %add
+}
+
+!0 = metadata !{metadata !"branch_weights", i32 100, i32 1000}
+!1 = metadata !{metadata !"branch_weights", i32 500, i32 500}
+!2 = metadata !{metadata !"branch_weights", i32 1, i32 3}
@@ -0,0 +1,71 @@
+; RUN: opt < %s -loop-vectorize -mtriple=x86_64-unknown-linux-gnu -mcpu=knl -S | FileCheck %s --check-prefix=CHECK --check-prefix=KNL
+; RUN: opt < %s -loop-vectorize -mtriple=x86_64-unknown-linux-gnu -mcpu=core-avx2 -S | FileCheck %s --check-prefix=CHECK --check-prefix=AVX2
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+; The 512-bit registers of AVX-512 hold 64 i8 elements.  Make sure the cost
+; model can consider a vectorization factor that wide.  Without AVX-512BW
+; <64 x i8> is not legal, so both CPUs end up picking 32.
+
+; CHECK-LABEL: @add_i8(
+; CHECK: load <32 x i8>
+; CHECK: add <32 x i8>
+; CHECK: store <32 x i8>
+; CHECK: ret void
+define void @add_i8(i8* noalias nocapture %a, i8* noalias nocapture readonly %b,
+                    i8* noalias nocapture readonly %c, i64 %n) {
+entry:
+  %cmp = icmp sgt i64 %n, 0
+  br i1 %cmp, label %for.body, label %for.end
+
+for.body:
+  %i = phi i64 [ %i.next, %for.body ], [ 0, %entry ]
+  %pb = getelementptr inbounds i8* %b, i64 %i
+  %vb = load i8* %pb, align 1
+  %pc = getelementptr inbounds i8* %c, i64 %i
+  %vc = load i8* %pc, align 1
+  %sum = add i8 %vc, %vb
+  %pa = getelementptr inbounds i8* %a, i64 %i
+  store i8 %sum, i8* %pa, align 1
+  %i.next = add i64 %i, 1
+  %exitcond = icmp eq i64 %i.next, %n
+  br i1 %exitcond, label %for.end, label %for.body
+
+for.end:
+  ret void
+}
+
+; <16 x i32> is legal with AVX-512, so the loop is vectorized twice as wide
+; as with AVX2.
+
+; CHECK-LABEL: @add_i32(
+; KNL: load <16 x i32>
+; KNL: add <16 x i32>
+; KNL: store <16 x i32>
+; AVX2: load <8 x i32>
+; AVX2: add <8 x i32>
+; AVX2: store <8 x i32>
+; CHECK: ret void
+define void @add_i32(i32* noalias nocapture %a, i32* noalias nocapture readonly %b,
+                    i32* noalias nocapture readonly %c, i64 %n) {
+entry:
+  %cmp = icmp sgt i64 %n, 0
+  br i1 %cmp, label %for.body, label %for.end
+
+for.body:
+  %i = phi i64 [ %i.next, %for.body ], [ 0, %entry ]
+  %pb = getelementptr inbounds i32* %b, i64 %i
+  %vb = load i32* %pb, align 4
+  %pc = getelementptr inbounds i32* %c, i64 %i
+  %vc = load i32* %pc, align 4
+  %sum = add i32 %vc, %vb
+  %pa = getelementptr inbounds i32* %a, i64 %i
+  store i32 %sum, i32* %pa, align 4
+  %i.next = add i64 %i, 1
+  %exitcond = icmp eq i64 %i.next, %n
+  br i1 %exitcond, label %for.end, label %for.body
+
+for.end:
+  ret void
+}
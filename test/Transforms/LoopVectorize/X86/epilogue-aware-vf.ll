@@ -0,0 +1,59 @@
+; RUN: opt < %s -loop-vectorize -mtriple=x86_64-apple-macosx10.8.0 -mcpu=corei7-avx -S | FileCheck %s
+; RUN: opt < %s -loop-vectorize -mtriple=x86_64-apple-macosx10.8.0 -mcpu=corei7-avx -vectorizer-epilogue-aware-vf=0 -S | FileCheck %s -check-prefix=NOEPI
+
+target datalayout = "e-p:64:64:64-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f32:32:32-f64:64:64-v64:64:64-v128:128:128-a0:0:64-s0:64:64-f80:128:128-n8:16:32:64-S128"
+target triple = "x86_64-apple-macosx10.8.0"
+
+; With 20 iterations, an 8-wide body leaves four iterations to the scalar
+; epilogue, while a 4-wide body leaves none.
+
+;CHECK-LABEL: @trip20(
+;CHECK: load <4 x float>
+;CHECK-NOT: <8 x float>
+;CHECK: ret void
+;NOEPI-LABEL: @trip20(
+;NOEPI: load <8 x float>
+;NOEPI: ret void
+define void @trip20(float* noalias nocapture %a, float* noalias nocapture %b) nounwind uwtable ssp {
+entry:
+  br label %for.body
+
+for.body:
+  %iv = phi i64 [ 0, %entry ], [ %iv.next, %for.body ]
+  %pb = getelementptr inbounds float* %b, i64 %iv
+  %vb = load float* %pb, align 4
+  %mul = fmul float %vb, 3.000000e+00
+  %pa = getelementptr inbounds float* %a, i64 %iv
+  store float %mul, float* %pa, align 4
+  %iv.next = add i64 %iv, 1
+  %exitcond = icmp eq i64 %iv.next, 20
+  br i1 %exitcond, label %for.end, label %for.body
+
+for.end:
+  ret void
+}
+
+; With 32 iterations there is no remainder at either width, so the wider
+; body still wins.
+
+;CHECK-LABEL: @trip32(
+;CHECK: load <8 x float>
+;CHECK: ret void
+define void @trip32(float* noalias nocapture %a, float* noalias nocapture %b) nounwind uwtable ssp {
+entry:
+  br label %for.body
+
+for.body:
+  %iv = phi i64 [ 0, %entry ], [ %iv.next, %for.body ]
+  %pb = getelementptr inbounds float* %b, i64 %iv
+  %vb = load float* %pb, align 4
+  %mul = fmul float %vb, 3.000000e+00
+  %pa = getelementptr inbounds float* %a, i64 %iv
+  store float %mul, float* %pa, align 4
+  %iv.next = add i64 %iv, 1
+  %exitcond = icmp eq i64 %iv.next, 32
+  br i1 %exitcond, label %for.end, label %for.body
+
+for.end:
+  ret void
+}
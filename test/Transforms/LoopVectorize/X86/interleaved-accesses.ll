@@ -0,0 +1,106 @@
+; RUN: opt < %s -loop-vectorize -mtriple=x86_64-apple-macosx10.8.0 -mcpu=corei7-avx -force-vector-width=4 -force-vector-unroll=1 -S | FileCheck %s
+; RUN: opt < %s -loop-vectorize -mtriple=x86_64-apple-macosx10.8.0 -mcpu=corei7-avx -force-vector-width=4 -force-vector-unroll=1 -enable-interleaved-mem-accesses=0 -S | FileCheck %s -check-prefix=NOIA
+
+target datalayout = "e-p:64:64:64-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f32:32:32-f64:64:64-v64:64:64-v128:128:128-a0:0:64-s0:64:64-f80:128:128-n8:16:32:64-S128"
+target triple = "x86_64-apple-macosx10.8.0"
+
+%struct.complex = type { float, float }
+
+; for (i = 0; i < n; i++)
+;   out[i] = in[i].re * in[i].im;
+;CHECK-LABEL: @deinterleave2(
+;CHECK: %wide.vec = load <8 x float>* {{.*}}, align 4
+;CHECK: shufflevector <8 x float> %wide.vec, <8 x float> undef, <4 x i32> <i32 0, i32 2, i32 4, i32 6>
+;CHECK: shufflevector <8 x float> %wide.vec, <8 x float> undef, <4 x i32> <i32 1, i32 3, i32 5, i32 7>
+;CHECK: fmul <4 x float>
+;CHECK: ret void
+;NOIA-LABEL: @deinterleave2(
+;NOIA-NOT: load <8 x float>
+;NOIA: ret void
+define void @deinterleave2(%struct.complex* noalias nocapture %in, float* noalias nocapture %out, i64 %n) {
+entry:
+  %cmp = icmp sgt i64 %n, 0
+  br i1 %cmp, label %for.body, label %for.end
+
+for.body:
+  %iv = phi i64 [ 0, %entry ], [ %iv.next, %for.body ]
+  %re.ptr = getelementptr inbounds %struct.complex* %in, i64 %iv, i32 0
+  %re = load float* %re.ptr, align 4
+  %im.ptr = getelementptr inbounds %struct.complex* %in, i64 %iv, i32 1
+  %im = load float* %im.ptr, align 4
+  %mul = fmul float %re, %im
+  %out.ptr = getelementptr inbounds float* %out, i64 %iv
+  store float %mul, float* %out.ptr, align 4
+  %iv.next = add i64 %iv, 1
+  %exitcond = icmp eq i64 %iv.next, %n
+  br i1 %exitcond, label %for.end, label %for.body
+
+for.end:
+  ret void
+}
+
+; The members are accessed in reverse address order and the wide store goes
+; after the last one.
+; for (i = 0; i < n; i++) {
+;   b[3*i+2] = a[i] + 2; b[3*i+1] = a[i] + 1; b[3*i] = a[i];
+; }
+;CHECK-LABEL: @interleave3(
+;CHECK: %interleaved.vec = shufflevector <16 x i32> {{.*}}, <16 x i32> undef, <12 x i32> <i32 0, i32 4, i32 8, i32 1, i32 5, i32 9, i32 2, i32 6, i32 10, i32 3, i32 7, i32 11>
+;CHECK: store <12 x i32> %interleaved.vec, <12 x i32>* {{.*}}, align 4
+;CHECK: ret void
+define void @interleave3(i32* noalias nocapture %a, i32* noalias nocapture %b, i64 %n) {
+entry:
+  %cmp = icmp sgt i64 %n, 0
+  br i1 %cmp, label %for.body, label %for.end
+
+for.body:
+  %iv = phi i64 [ 0, %entry ], [ %iv.next, %for.body ]
+  %a.ptr = getelementptr inbounds i32* %a, i64 %iv
+  %v = load i32* %a.ptr, align 4
+  %idx0 = mul nsw i64 %iv, 3
+  %idx1 = add nsw i64 %idx0, 1
+  %idx2 = add nsw i64 %idx0, 2
+  %v2 = add nsw i32 %v, 2
+  %p2 = getelementptr inbounds i32* %b, i64 %idx2
+  store i32 %v2, i32* %p2, align 4
+  %v1 = add nsw i32 %v, 1
+  %p1 = getelementptr inbounds i32* %b, i64 %idx1
+  store i32 %v1, i32* %p1, align 4
+  %p0 = getelementptr inbounds i32* %b, i64 %idx0
+  store i32 %v, i32* %p0, align 4
+  %iv.next = add i64 %iv, 1
+  %exitcond = icmp eq i64 %iv.next, %n
+  br i1 %exitcond, label %for.end, label %for.body
+
+for.end:
+  ret void
+}
+
+; Only two of the three elements of each stride are read, so the wide load
+; would touch memory the loop does not.
+;CHECK-LABEL: @gap(
+;CHECK-NOT: load <12 x i32>
+;CHECK: ret void
+define void @gap(i32* noalias nocapture %a, i32* noalias nocapture %b, i64 %n) {
+entry:
+  %cmp = icmp sgt i64 %n, 0
+  br i1 %cmp, label %for.body, label %for.end
+
+for.body:
+  %iv = phi i64 [ 0, %entry ], [ %iv.next, %for.body ]
+  %idx0 = mul nsw i64 %iv, 3
+  %idx1 = add nsw i64 %idx0, 1
+  %p0 = getelementptr inbounds i32* %a, i64 %idx0
+  %v0 = load i32* %p0, align 4
+  %p1 = getelementptr inbounds i32* %a, i64 %idx1
+  %v1 = load i32* %p1, align 4
+  %sum = add nsw i32 %v0, %v1
+  %b.ptr = getelementptr inbounds i32* %b, i64 %iv
+  store i32 %sum, i32* %b.ptr, align 4
+  %iv.next = add i64 %iv, 1
+  %exitcond = icmp eq i64 %iv.next, %n
+  br i1 %exitcond, label %for.end, label %for.body
+
+for.end:
+  ret void
+}
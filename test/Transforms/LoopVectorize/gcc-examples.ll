@@ -324,14 +324,9 @@ define void @example10b(i16* noalias nocapture %sa, i16* noalias nocapture %sb,
 }
 
 ;CHECK-LABEL: @example11(
-;CHECK: load i32
-;CHECK: load i32
-;CHECK: load i32
-;CHECK: load i32
-;CHECK: insertelement
-;CHECK: insertelement
-;CHECK: insertelement
-;CHECK: insertelement
+;CHECK: %wide.vec = load <8 x i32>
+;CHECK: shufflevector <8 x i32> %wide.vec, <8 x i32> undef, <4 x i32> <i32 0, i32 2, i32 4, i32 6>
+;CHECK: shufflevector <8 x i32> %wide.vec, <8 x i32> undef, <4 x i32> <i32 1, i32 3, i32 5, i32 7>
 ;CHECK: ret void
 define void @example11() nounwind uwtable ssp {
   br label %1
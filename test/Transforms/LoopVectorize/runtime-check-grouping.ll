@@ -0,0 +1,61 @@
+; RUN: opt < %s -loop-vectorize -force-vector-unroll=1 -force-vector-width=4 -dce -instcombine -S | FileCheck %s
+
+target datalayout = "e-p:64:64:64-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f32:32:32-f64:64:64-v64:64:64-v128:128:128-a0:0:64-s0:64:64-f80:128:128-n8:16:32:64-S128"
+target triple = "x86_64-apple-macosx10.8.0"
+
+; The nine loads from %A advance by the same stride and need no checks between
+; them, so they are checked against %out as one range.  Checked one by one they
+; would need nine comparisons, more than the runtime check threshold allows.
+;CHECK-LABEL: @stencil9(
+;CHECK: vector.memcheck:
+;CHECK: <4 x i32>
+;CHECK: ret
+define void @stencil9(i32* nocapture %out, i32* nocapture readonly %A) {
+entry:
+  br label %for.body
+
+for.body:
+  %i = phi i64 [ 0, %entry ], [ %inc, %for.body ]
+  %a0 = getelementptr inbounds i32* %A, i64 %i
+  %v0 = load i32* %a0, align 4
+  %i1 = add nsw i64 %i, 1
+  %a1 = getelementptr inbounds i32* %A, i64 %i1
+  %v1 = load i32* %a1, align 4
+  %s1 = add nsw i32 %v0, %v1
+  %i2 = add nsw i64 %i, 2
+  %a2 = getelementptr inbounds i32* %A, i64 %i2
+  %v2 = load i32* %a2, align 4
+  %s2 = add nsw i32 %s1, %v2
+  %i3 = add nsw i64 %i, 3
+  %a3 = getelementptr inbounds i32* %A, i64 %i3
+  %v3 = load i32* %a3, align 4
+  %s3 = add nsw i32 %s2, %v3
+  %i4 = add nsw i64 %i, 4
+  %a4 = getelementptr inbounds i32* %A, i64 %i4
+  %v4 = load i32* %a4, align 4
+  %s4 = add nsw i32 %s3, %v4
+  %i5 = add nsw i64 %i, 5
+  %a5 = getelementptr inbounds i32* %A, i64 %i5
+  %v5 = load i32* %a5, align 4
+  %s5 = add nsw i32 %s4, %v5
+  %i6 = add nsw i64 %i, 6
+  %a6 = getelementptr inbounds i32* %A, i64 %i6
+  %v6 = load i32* %a6, align 4
+  %s6 = add nsw i32 %s5, %v6
+  %i7 = add nsw i64 %i, 7
+  %a7 = getelementptr inbounds i32* %A, i64 %i7
+  %v7 = load i32* %a7, align 4
+  %s7 = add nsw i32 %s6, %v7
+  %i8 = add nsw i64 %i, 8
+  %a8 = getelementptr inbounds i32* %A, i64 %i8
+  %v8 = load i32* %a8, align 4
+  %s8 = add nsw i32 %s7, %v8
+  %dst = getelementptr inbounds i32* %out, i64 %i
+  store i32 %s8, i32* %dst, align 4
+  %inc = add i64 %i, 1
+  %exitcond = icmp eq i64 %inc, 256
+  br i1 %exitcond, label %for.end, label %for.body
+
+for.end:
+  ret void
+}
@@ -0,0 +1,16 @@
+; RUN: opt -mergefunc -mergefunc-fold -S < %s | FileCheck %s
+
+; A thunk would be as large as these functions, but folding one into the
+; other adds no code.
+
+@ptrs = global [2 x void (i32)*] [void (i32)* @foo, void (i32)* @bar]
+; CHECK: @ptrs = global [2 x void (i32)*] [void (i32)* @foo, void (i32)* @foo]
+
+define internal void @foo(i32 %x) unnamed_addr {
+  ret void
+}
+
+; CHECK-NOT: @bar
+define internal void @bar(i32 %x) unnamed_addr {
+  ret void
+}
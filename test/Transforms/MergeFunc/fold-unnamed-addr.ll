@@ -0,0 +1,44 @@
+; RUN: opt -mergefunc -mergefunc-fold -S < %s | FileCheck %s
+; RUN: opt -mergefunc -mergefunc-fold -mergefunc-report -disable-output < %s 2>&1 | FileCheck %s -check-prefix=REPORT
+
+; @g is local and unnamed_addr, so it is removed even though its address is
+; stored.  @h's address may be compared, so it becomes a thunk.
+
+@table = global [3 x i32 (i32)*] [i32 (i32)* @f, i32 (i32)* @g, i32 (i32)* @h]
+
+; CHECK: @table = global [3 x i32 (i32)*] [i32 (i32)* @f, i32 (i32)* @f, i32 (i32)* @h]
+
+define i32 @f(i32 %x) unnamed_addr {
+  %y = add i32 %x, 3
+  %z = mul i32 %y, %x
+  ret i32 %z
+}
+
+; CHECK-NOT: define internal i32 @g
+define internal i32 @g(i32 %x) unnamed_addr {
+  %y = add i32 %x, 3
+  %z = mul i32 %y, %x
+  ret i32 %z
+}
+
+define internal i32 @h(i32 %x) {
+  %y = add i32 %x, 3
+  %z = mul i32 %y, %x
+  ret i32 %z
+}
+
+; CHECK-LABEL: define i32 @caller(
+; CHECK: call i32 @f(i32 %x)
+; CHECK: call i32 @f(i32 %a)
+define i32 @caller(i32 %x) {
+  %a = call i32 @g(i32 %x)
+  %b = call i32 @h(i32 %a)
+  ret i32 %b
+}
+
+; CHECK-LABEL: define internal i32 @h(
+; CHECK-NEXT: tail call i32 @f(i32 %0)
+
+; REPORT: mergefunc: g -> f (folded, 3 instructions)
+; REPORT: mergefunc: h -> f (3 instructions)
+; REPORT: mergefunc: 12 instructions before, 8 after
@@ -0,0 +1,54 @@
+; RUN: opt -basicaa -objc-arc -S < %s | FileCheck %s --check-prefix=CHECK --check-prefix=DEFAULT
+; RUN: opt -basicaa -objc-arc -objc-arc-provenance-max-depth=2 -S < %s | FileCheck %s --check-prefix=CHECK --check-prefix=SHALLOW
+
+target datalayout = "e-p:64:64:64"
+
+declare i8* @objc_retain(i8*)
+declare void @objc_release(i8*)
+declare void @use_pointer(i8*)
+declare void @callee()
+
+; Telling that %h is unrelated to %p takes three nested provenance queries:
+; one for %h, one for %j or %k, and one for the arguments they merge.  With
+; the depth limited to two, the query gives up and assumes that the values
+; are related.  @use_pointer then uses %p after @callee may have released it,
+; so the retain and release stay.
+
+; CHECK-LABEL: define void @test0(
+; DEFAULT-NOT: @objc_
+; SHALLOW: call i8* @objc_retain(i8* %p)
+; SHALLOW: call void @callee()
+; SHALLOW: call void @use_pointer(i8* %h)
+; SHALLOW: call void @objc_release(i8* %p)
+; CHECK: }
+define void @test0(i8* %p, i1 %u, i1 %m, i8* %z, i8* %y, i8* %x, i8* %w) {
+entry:
+  call i8* @objc_retain(i8* %p)
+  br i1 %u, label %true, label %false
+true:
+  br i1 %m, label %a, label %b
+false:
+  br i1 %m, label %c, label %d
+a:
+  br label %e
+b:
+  br label %e
+c:
+  br label %f
+d:
+  br label %f
+e:
+  %j = phi i8* [ %z, %a ], [ %y, %b ]
+  br label %g
+f:
+  %k = phi i8* [ %w, %c ], [ %x, %d ]
+  br label %g
+g:
+  %h = phi i8* [ %j, %e ], [ %k, %f ]
+  call void @callee()
+  call void @use_pointer(i8* %h)
+  call void @objc_release(i8* %p), !clang.imprecise_release !0
+  ret void
+}
+
+!0 = metadata !{}
@@ -0,0 +1,40 @@
+; RUN: opt -basicaa -objc-arc -S < %s | FileCheck %s
+
+target datalayout = "e-p:64:64:64"
+
+declare i8* @objc_retain(i8*)
+declare void @objc_release(i8*)
+declare void @use_pointer(i8*)
+declare void @callee()
+
+; Once the pair in %entry is matched, the state of %x is trivial and is
+; dropped from the per-block maps.  A pointer that is not tracked must be
+; handled like one in the trivial state, both when %a and %b are merged and
+; when the later pairs are matched.
+
+; CHECK-LABEL: define void @test0(
+; CHECK-NOT: @objc_
+; CHECK: call void @use_pointer(i8* %x)
+; CHECK-NOT: @objc_
+; CHECK: }
+define void @test0(i8* %x, i1 %c) {
+entry:
+  call i8* @objc_retain(i8* %x)
+  call void @callee()
+  call void @objc_release(i8* %x), !clang.imprecise_release !0
+  br i1 %c, label %a, label %b
+a:
+  call i8* @objc_retain(i8* %x)
+  call void @use_pointer(i8* %x)
+  call void @objc_release(i8* %x)
+  br label %join
+b:
+  br label %join
+join:
+  call i8* @objc_retain(i8* %x)
+  call void @callee()
+  call void @objc_release(i8* %x), !clang.imprecise_release !0
+  ret void
+}
+
+!0 = metadata !{}
@@ -0,0 +1,48 @@
+; RUN: opt < %s -reassociate -S | FileCheck %s
+; RUN: opt < %s -reassociate -early-cse -S | FileCheck %s -check-prefix=CSE
+; RUN: opt < %s -reassociate -reassociate-max-paired-operands=0 -S | FileCheck %s -check-prefix=OFF
+
+; Both sums combine %b and %c, so both compute that first.
+
+define void @pair(i32 %a, i32 %b, i32 %c, i32 %d, i32* %p, i32* %q) {
+; CHECK-LABEL: @pair(
+; CHECK: [[X:%[a-z0-9.]+]] = add i32 %c, %b
+; CHECK-NEXT: add i32 [[X]], %a
+; CHECK: [[Y:%[a-z0-9.]+]] = add i32 %c, %b
+; CHECK-NEXT: add i32 [[Y]], %d
+
+; CSE-LABEL: @pair(
+; CSE: [[BC:%[a-z0-9.]+]] = add i32 %c, %b
+; CSE-NEXT: add i32 [[BC]], %a
+; CSE-NEXT: add i32 [[BC]], %d
+
+; OFF-LABEL: @pair(
+; OFF: [[X:%[a-z0-9.]+]] = add i32 %b, %a
+; OFF-NEXT: add i32 [[X]], %c
+  %x1 = add i32 %a, %b
+  %x2 = add i32 %x1, %c
+  %y1 = add i32 %b, %d
+  %y2 = add i32 %y1, %c
+  store i32 %x2, i32* %p
+  store i32 %y2, i32* %q
+  ret void
+}
+
+; Pairs are only counted within a block.
+
+define void @blocks(i32 %a, i32 %b, i32 %c, i32 %d, i32* %p, i32* %q) {
+; CHECK-LABEL: @blocks(
+; CHECK: [[X:%[a-z0-9.]+]] = add i32 %b, %a
+; CHECK-NEXT: add i32 [[X]], %c
+entry:
+  %x1 = add i32 %a, %b
+  %x2 = add i32 %x1, %c
+  store i32 %x2, i32* %p
+  br label %next
+
+next:
+  %y1 = add i32 %b, %d
+  %y2 = add i32 %y1, %c
+  store i32 %y2, i32* %q
+  ret void
+}
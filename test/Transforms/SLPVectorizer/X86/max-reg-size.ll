@@ -0,0 +1,78 @@
+; RUN: opt < %s -basicaa -slp-vectorizer -dce -S -mtriple=x86_64-apple-macosx10.8.0 -mcpu=corei7-avx | FileCheck %s -check-prefix=DEFAULT
+; RUN: opt < %s -basicaa -slp-vectorizer -dce -S -mtriple=x86_64-apple-macosx10.8.0 -mcpu=corei7-avx -slp-max-reg-size=256 | FileCheck %s -check-prefix=WIDE
+; RUN: opt < %s -basicaa -slp-vectorizer -dce -S -mtriple=x86_64-apple-macosx10.8.0 -mcpu=corei7 -slp-max-reg-size=256 | FileCheck %s -check-prefix=DEFAULT
+
+target datalayout = "e-p:64:64:64-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f32:32:32-f64:64:64-v64:64:64-v128:128:128-a0:0:64-s0:64:64-f80:128:128-n8:16:32:64-S128"
+target triple = "x86_64-apple-macosx10.8.0"
+
+; A chain of eight float stores is vectorized as two 128-bit halves by default,
+; and as one 256-bit vector when -slp-max-reg-size allows it and the target
+; has 256-bit registers.
+
+; DEFAULT-LABEL: @add8(
+; DEFAULT: fadd <4 x float>
+; DEFAULT: fadd <4 x float>
+; DEFAULT-NOT: <8 x float>
+; DEFAULT: ret void
+
+; WIDE-LABEL: @add8(
+; WIDE: fadd <8 x float>
+; WIDE-NOT: <4 x float>
+; WIDE: ret void
+define void @add8(float* noalias %a, float* noalias %b, float* noalias %c) {
+entry:
+  %a0 = load float* %a, align 4
+  %b0 = load float* %b, align 4
+  %s0 = fadd float %a0, %b0
+  %pa1 = getelementptr inbounds float* %a, i64 1
+  %pb1 = getelementptr inbounds float* %b, i64 1
+  %a1 = load float* %pa1, align 4
+  %b1 = load float* %pb1, align 4
+  %s1 = fadd float %a1, %b1
+  %pa2 = getelementptr inbounds float* %a, i64 2
+  %pb2 = getelementptr inbounds float* %b, i64 2
+  %a2 = load float* %pa2, align 4
+  %b2 = load float* %pb2, align 4
+  %s2 = fadd float %a2, %b2
+  %pa3 = getelementptr inbounds float* %a, i64 3
+  %pb3 = getelementptr inbounds float* %b, i64 3
+  %a3 = load float* %pa3, align 4
+  %b3 = load float* %pb3, align 4
+  %s3 = fadd float %a3, %b3
+  %pa4 = getelementptr inbounds float* %a, i64 4
+  %pb4 = getelementptr inbounds float* %b, i64 4
+  %a4 = load float* %pa4, align 4
+  %b4 = load float* %pb4, align 4
+  %s4 = fadd float %a4, %b4
+  %pa5 = getelementptr inbounds float* %a, i64 5
+  %pb5 = getelementptr inbounds float* %b, i64 5
+  %a5 = load float* %pa5, align 4
+  %b5 = load float* %pb5, align 4
+  %s5 = fadd float %a5, %b5
+  %pa6 = getelementptr inbounds float* %a, i64 6
+  %pb6 = getelementptr inbounds float* %b, i64 6
+  %a6 = load float* %pa6, align 4
+  %b6 = load float* %pb6, align 4
+  %s6 = fadd float %a6, %b6
+  %pa7 = getelementptr inbounds float* %a, i64 7
+  %pb7 = getelementptr inbounds float* %b, i64 7
+  %a7 = load float* %pa7, align 4
+  %b7 = load float* %pb7, align 4
+  %s7 = fadd float %a7, %b7
+  store float %s0, float* %c, align 4
+  %pc1 = getelementptr inbounds float* %c, i64 1
+  store float %s1, float* %pc1, align 4
+  %pc2 = getelementptr inbounds float* %c, i64 2
+  store float %s2, float* %pc2, align 4
+  %pc3 = getelementptr inbounds float* %c, i64 3
+  store float %s3, float* %pc3, align 4
+  %pc4 = getelementptr inbounds float* %c, i64 4
+  store float %s4, float* %pc4, align 4
+  %pc5 = getelementptr inbounds float* %c, i64 5
+  store float %s5, float* %pc5, align 4
+  %pc6 = getelementptr inbounds float* %c, i64 6
+  store float %s6, float* %pc6, align 4
+  %pc7 = getelementptr inbounds float* %c, i64 7
+  store float %s7, float* %pc7, align 4
+  ret void
+}
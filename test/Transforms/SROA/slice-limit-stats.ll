@@ -0,0 +1,23 @@
+; RUN: opt < %s -sroa -sroa-max-alloca-slices=2 -stats -disable-output 2>&1 \
+; RUN:   | FileCheck %s
+; RUN: opt < %s -sroa -sroa-max-alloca-slices=4 -stats -disable-output 2>&1 \
+; RUN:   | FileCheck %s --check-prefix=ATLIMIT
+; REQUIRES: asserts
+
+target datalayout = "e-p:64:64:64-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:32:64-f32:32:32-f64:64:64-v64:64:64-v128:128:128-a0:0:64-n8:16:32:64"
+
+; CHECK: 1 sroa - Number of allocas only partly split for having too many slices
+; ATLIMIT-NOT: Number of allocas only partly split for having too many slices
+
+define i32 @three_fields(i32 %a, i32 %b, i32 %c) {
+entry:
+  %s = alloca { i32, i32, i32 }
+  %f0 = getelementptr { i32, i32, i32 }* %s, i64 0, i32 0
+  %f1 = getelementptr { i32, i32, i32 }* %s, i64 0, i32 1
+  %f2 = getelementptr { i32, i32, i32 }* %s, i64 0, i32 2
+  store i32 %a, i32* %f0
+  store i32 %b, i32* %f1
+  store i32 %c, i32* %f2
+  %v = load i32* %f1
+  ret i32 %v
+}
@@ -0,0 +1,47 @@
+; RUN: opt < %s -sroa -S | FileCheck %s
+; RUN: opt < %s -sroa -sroa-max-alloca-slices=0 -S | FileCheck %s
+; RUN: opt < %s -sroa -sroa-max-alloca-slices=4 -S | FileCheck %s
+; RUN: opt < %s -sroa -sroa-max-alloca-slices=3 -S | FileCheck %s --check-prefix=LIMIT3
+; RUN: opt < %s -sroa -sroa-max-alloca-slices=2 -S | FileCheck %s --check-prefix=LIMIT1
+; RUN: opt < %s -sroa -sroa-max-alloca-slices=1 -S | FileCheck %s --check-prefix=LIMIT1
+
+target datalayout = "e-p:64:64:64-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:32:64-f32:32:32-f64:64:64-v64:64:64-v128:128:128-a0:0:64-n8:16:32:64"
+
+; The alloca has four slices in three partitions.  With no limit, or a limit
+; of four that it is exactly at, it is split and promoted entirely.  With a
+; lower limit only the slices at the lowest offsets are built, whatever order
+; the uses are visited in.  Their partitions are still split and promoted, and
+; the rest of the alloca is left in place.  A limit of two only has room for
+; one of the two slices at offset 4, so both are left out.
+
+define i32 @three_fields(i32 %a, i32 %b, i32 %c) {
+; CHECK-LABEL: @three_fields(
+; CHECK-NOT: alloca
+; CHECK: ret i32 %b
+; LIMIT3-LABEL: @three_fields(
+; LIMIT3: %s = alloca { i32, i32, i32 }
+; LIMIT3-NOT: alloca
+; LIMIT3-NOT: store i32 %a
+; LIMIT3-NOT: store i32 %b
+; LIMIT3: store i32 %c
+; LIMIT3-NOT: load
+; LIMIT3: ret i32 %b
+; LIMIT1-LABEL: @three_fields(
+; LIMIT1: %s = alloca { i32, i32, i32 }
+; LIMIT1-NOT: alloca
+; LIMIT1-NOT: store i32 %a
+; LIMIT1: store i32 %b
+; LIMIT1: store i32 %c
+; LIMIT1: %[[V:.*]] = load i32*
+; LIMIT1: ret i32 %[[V]]
+entry:
+  %s = alloca { i32, i32, i32 }
+  %f0 = getelementptr { i32, i32, i32 }* %s, i64 0, i32 0
+  %f1 = getelementptr { i32, i32, i32 }* %s, i64 0, i32 1
+  %f2 = getelementptr { i32, i32, i32 }* %s, i64 0, i32 2
+  store i32 %a, i32* %f0
+  store i32 %b, i32* %f1
+  store i32 %c, i32* %f2
+  %v = load i32* %f1
+  ret i32 %v
+}
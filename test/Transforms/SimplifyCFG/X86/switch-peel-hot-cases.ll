@@ -0,0 +1,74 @@
+; RUN: opt < %s -simplifycfg -S -mtriple=x86_64-unknown-linux-gnu | FileCheck %s
+; RUN: opt < %s -simplifycfg -switch-peel-max-cases=0 -S -mtriple=x86_64-unknown-linux-gnu | FileCheck %s -check-prefix=NOPEEL
+
+target datalayout = "e-p:64:64:64-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f32:32:32-f64:64:64-v64:64:64-v128:128:128-a0:0:64-s0:64:64-f80:128:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+; Case 2 takes almost every hit, so it is tested before the table.
+define i32 @hot(i32 %c) {
+entry:
+  switch i32 %c, label %sw.default [
+    i32 0, label %return
+    i32 1, label %sw.bb1
+    i32 2, label %sw.bb2
+    i32 3, label %sw.bb3
+    i32 4, label %sw.bb4
+  ], !prof !0
+
+sw.bb1: br label %return
+sw.bb2: br label %return
+sw.bb3: br label %return
+sw.bb4: br label %return
+sw.default: br label %return
+
+return:
+  %x = phi i32 [ 15, %sw.default ], [ 7, %sw.bb4 ], [ 9, %sw.bb3 ], [ 42, %sw.bb2 ], [ 3, %sw.bb1 ], [ 11, %entry ]
+  ret i32 %x
+
+; CHECK-LABEL: @hot(
+; CHECK: entry:
+; CHECK-NEXT: %switch.hotcase = icmp eq i32 %c, 2
+; CHECK-NEXT: br i1 %switch.hotcase, label %return, label %switch.peel, !prof !0
+; CHECK: switch.peel:
+; CHECK-NEXT: %switch.tableidx = sub i32 %c, 0
+; CHECK: switch.lookup:
+; CHECK: return:
+; CHECK: phi i32 {{.*}}[ 42, %entry ]
+
+; NOPEEL-LABEL: @hot(
+; NOPEEL: entry:
+; NOPEEL-NEXT: %switch.tableidx = sub i32 %c, 0
+; NOPEEL-NOT: switch.hotcase
+}
+
+; Without a dominant case the table is used directly.
+define i32 @flat(i32 %c) {
+entry:
+  switch i32 %c, label %sw.default [
+    i32 0, label %return
+    i32 1, label %sw.bb1
+    i32 2, label %sw.bb2
+    i32 3, label %sw.bb3
+    i32 4, label %sw.bb4
+  ], !prof !1
+
+sw.bb1: br label %return
+sw.bb2: br label %return
+sw.bb3: br label %return
+sw.bb4: br label %return
+sw.default: br label %return
+
+return:
+  %x = phi i32 [ 15, %sw.default ], [ 7, %sw.bb4 ], [ 9, %sw.bb3 ], [ 42, %sw.bb2 ], [ 3, %sw.bb1 ], [ 11, %entry ]
+  ret i32 %x
+
+; CHECK-LABEL: @flat(
+; CHECK: entry:
+; CHECK-NEXT: %switch.tableidx = sub i32 %c, 0
+; CHECK-NOT: switch.hotcase
+}
+
+; CHECK: !0 = metadata !{metadata !"branch_weights", i32 990, i32 60}
+
+!0 = metadata !{metadata !"branch_weights", i32 10, i32 10, i32 10, i32 990, i32 10, i32 20}
+!1 = metadata !{metadata !"branch_weights", i32 10, i32 10, i32 10, i32 10, i32 10, i32 20}
@@ -0,0 +1,6 @@
+void odd(void);
+void f(int n) {
+  for (int i = 0; i < n; ++i)
+    if (i & 1)
+      odd();
+}
@@ -0,0 +1,43 @@
+declare void @odd()
+
+define void @f(i32 %n) {
+entry:
+  %cmp0 = icmp sgt i32 %n, 0, !dbg !20
+  br i1 %cmp0, label %loop, label %exit, !dbg !20
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %inc, %latch ]
+  %bit = and i32 %i, 1, !dbg !21
+  %isodd = icmp ne i32 %bit, 0, !dbg !21
+  br i1 %isodd, label %then, label %latch, !dbg !21
+
+then:
+  call void @odd(), !dbg !22
+  br label %latch, !dbg !22
+
+latch:
+  %inc = add i32 %i, 1, !dbg !20
+  %c = icmp slt i32 %inc, %n, !dbg !20
+  br i1 %c, label %loop, label %exit, !dbg !20
+
+exit:
+  ret void, !dbg !23
+}
+
+!llvm.gcov = !{!9}
+!llvm.dbg.cu = !{!0}
+!llvm.module.flags = !{!12}
+
+!0 = metadata !{i32 786449, metadata !11, i32 12, metadata !"clang version 3.5", i1 false, metadata !"", i32 0, metadata !3, metadata !3, metadata !4, metadata !3, null, metadata !""} ; [ DW_TAG_compile_unit ]
+!3 = metadata !{i32 0}
+!4 = metadata !{metadata !5}
+!5 = metadata !{i32 786478, metadata !11, metadata !6, metadata !"f", metadata !"f", metadata !"", i32 2, metadata !7, i1 false, i1 true, i32 0, i32 0, null, i32 256, i1 false, void (i32)* @f, null, null, metadata !3, i32 2} ; [ DW_TAG_subprogram ] [line 2] [def] [f]
+!6 = metadata !{i32 786473, metadata !11} ; [ DW_TAG_file_type ]
+!7 = metadata !{i32 786453, i32 0, null, i32 0, i32 0, i64 0, i64 0, i64 0, i32 0, null, metadata !3, i32 0, i32 0} ; [ DW_TAG_subroutine_type ]
+!9 = metadata !{metadata !"test_tree.gcno", metadata !0}
+!11 = metadata !{metadata !"test_tree.c", metadata !"."}
+!12 = metadata !{i32 1, metadata !"Debug Info Version", i32 1}
+!20 = metadata !{i32 3, i32 0, metadata !5, null}
+!21 = metadata !{i32 4, i32 0, metadata !5, null}
+!22 = metadata !{i32 5, i32 0, metadata !5, null}
+!23 = metadata !{i32 6, i32 0, metadata !5, null}
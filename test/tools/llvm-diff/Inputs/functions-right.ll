@@ -0,0 +1,30 @@
+define i32 @same(i32 %a, i32 %b) {
+entry:
+  %sum = add i32 %a, %b
+  %prod = mul i32 %sum, %a
+  ret i32 %prod
+}
+
+define i32 @changed(i32 %a, i32 %b) {
+entry:
+  %sum = add i32 %a, %b
+  %diff = sub i32 %sum, %b
+  %prod = mul i32 %diff, %a
+  ret i32 %prod
+}
+
+define i32 @also.same(i32 %a) {
+entry:
+  %c = icmp eq i32 %a, 0
+  br i1 %c, label %then, label %else
+
+then:
+  ret i32 1
+
+else:
+  ret i32 %a
+}
+
+define void @only.right() {
+  ret void
+}
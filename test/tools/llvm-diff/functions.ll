@@ -0,0 +1,56 @@
+; RUN: not llvm-diff %s %p/Inputs/functions-right.ll 2>&1 | FileCheck %s
+; RUN: not llvm-diff -threads=1 %s %p/Inputs/functions-right.ll 2>&1 \
+; RUN:   | FileCheck %s
+; RUN: not llvm-diff -threads=4 %s %p/Inputs/functions-right.ll 2>&1 \
+; RUN:   | FileCheck %s
+; RUN: not llvm-diff -summary %s %p/Inputs/functions-right.ll \
+; RUN:   | FileCheck %s --check-prefix=SUMMARY
+; RUN: llvm-diff -summary %s %s | FileCheck %s --check-prefix=SAME
+
+; Differences are reported in module order however many threads compare the
+; functions.
+
+; CHECK: function @only.left exists only in left module
+; CHECK-NEXT: function @only.right exists only in right module
+; CHECK-NOT: in function same
+; CHECK: in function changed:
+; CHECK-NEXT:   in block %entry:
+; CHECK-NEXT:     >   %diff = sub i32 %sum, %b
+; CHECK-NEXT:     >   %prod = mul i32 %diff, %a
+; CHECK-NEXT:     >   ret i32 %prod
+; CHECK-NEXT:     <   %prod = mul i32 %sum, %a
+; CHECK-NEXT:     <   ret i32 %prod
+; CHECK-NOT: in function
+
+; SUMMARY: 1 of 3 functions differ, 1 only in left module, 1 only in right module
+; SAME: 0 of 4 functions differ, 0 only in left module, 0 only in right module
+
+define i32 @same(i32 %a, i32 %b) {
+entry:
+  %sum = add i32 %a, %b
+  %prod = mul i32 %sum, %a
+  ret i32 %prod
+}
+
+define i32 @changed(i32 %a, i32 %b) {
+entry:
+  %sum = add i32 %a, %b
+  %prod = mul i32 %sum, %a
+  ret i32 %prod
+}
+
+define i32 @also.same(i32 %a) {
+entry:
+  %c = icmp eq i32 %a, 0
+  br i1 %c, label %then, label %else
+
+then:
+  ret i32 1
+
+else:
+  ret i32 %a
+}
+
+define void @only.left() {
+  ret void
+}
@@ -0,0 +1,73 @@
+//===- ListReducer.cpp - Test reduction candidates concurrently -----------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the -j option of bugpoint, which runs the tests of
+// several list reduction candidates at a time, each in a forked copy of
+// bugpoint.
+//
+//===----------------------------------------------------------------------===//
+
+#include "ListReducer.h"
+#include "llvm/Config/llvm-config.h"
+#include "llvm/Support/CommandLine.h"
+#ifdef LLVM_ON_UNIX
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+using namespace llvm;
+
+static cl::opt<unsigned>
+NumJobs("j", cl::init(1), cl::value_desc("N"),
+        cl::desc("Test up to N reduction candidates at a time, each in a "
+                 "child process"));
+
+unsigned llvm::getNumReductionJobs() {
+  return NumJobs;
+}
+
+bool llvm::runTestsInChildren(unsigned NumTests,
+                              int (*Test)(void *Arg, unsigned Idx), void *Arg,
+                              std::vector<int> &Results) {
+#ifdef LLVM_ON_UNIX
+  // Don't let the children write out what is buffered in the parent.
+  outs().flush();
+  errs().flush();
+
+  std::vector<pid_t> Children;
+  for (unsigned i = 0; i != NumTests; ++i) {
+    pid_t Child = fork();
+    if (Child == -1)
+      break;
+    if (Child == 0) {
+      // Only the parent reports progress: it runs the candidate it picks
+      // again, in process, so that its output and its changes to the program
+      // are kept.
+      int Null = open("/dev/null", O_WRONLY);
+      if (Null != -1) {
+        dup2(Null, 1);
+        dup2(Null, 2);
+      }
+      _exit(Test(Arg, i));
+    }
+    Children.push_back(Child);
+  }
+
+  Results.assign(NumTests, -1);
+  for (unsigned i = 0, e = Children.size(); i != e; ++i) {
+    int Status;
+    if (waitpid(Children[i], &Status, 0) == Children[i] && WIFEXITED(Status))
+      Results[i] = WEXITSTATUS(Status);
+  }
+  return Children.size() == NumTests;
+#else
+  return false;
+#endif
+}
@@ -25,6 +25,18 @@ namespace llvm {
   
   extern bool BugpointIsInterrupted;
 
+  /// getNumReductionJobs - The number of candidates reduceList may test at
+  /// once, from the -j option.
+  unsigned getNumReductionJobs();
+
+  /// runTestsInChildren - Call Test(Arg, i) for every i below NumTests, each
+  /// in a child process, and store the exit codes in Results, with -1 for a
+  /// child that didn't exit normally.  Return false if the children could not
+  /// all be created.
+  bool runTestsInChildren(unsigned NumTests,
+                          int (*Test)(void *Arg, unsigned Idx), void *Arg,
+                          std::vector<int> &Results);
+
 template<typename ElTy>
 struct ListReducer {
   enum TestResult {
@@ -45,6 +57,43 @@ struct ListReducer {
                             std::vector<ElTy> &Kept,
                             std::string &Error) = 0;
 
+private:
+  struct Candidate {
+    std::vector<ElTy> Prefix, Kept;
+  };
+
+  struct CandidateBatch {
+    ListReducer *Reducer;
+    std::vector<Candidate> *Candidates;
+  };
+
+  static int testCandidate(void *Arg, unsigned Idx) {
+    CandidateBatch *Batch = static_cast<CandidateBatch *>(Arg);
+    Candidate &C = (*Batch->Candidates)[Idx];
+    std::string Error;
+    return Batch->Reducer->doTest(C.Prefix, C.Kept, Error);
+  }
+
+  // findFirstFailing - Test the candidates concurrently in child processes and
+  // return the index of the first one whose test didn't return NoFailure, or
+  // the number of candidates if they all did.  The caller tests the chosen
+  // candidate again itself, so that doTest's output and its changes to the
+  // program are those of a sequential run, and reduces exactly as it would
+  // have without -j.  If the children can't be created, 0 is returned and the
+  // reduction simply goes on sequentially.
+  unsigned findFirstFailing(std::vector<Candidate> &Candidates) {
+    CandidateBatch Batch = { this, &Candidates };
+    std::vector<int> Results;
+    if (!runTestsInChildren(Candidates.size(), testCandidate, &Batch, Results))
+      return 0;
+    for (unsigned i = 0, e = Results.size(); i != e; ++i)
+      if (Results[i] != NoFailure)
+        return i;
+    return Candidates.size();
+  }
+
+public:
+
   // reduceList - This function attempts to reduce the length of the specified
   // list while still maintaining the "test" property.  This is the core of the
   // "work" that bugpoint does.
@@ -112,6 +161,29 @@ Backjump:
         NumOfIterationsWithoutProgress = 0;
       }
       
+      unsigned Jobs = getNumReductionJobs();
+      if (Jobs > 1) {
+        // If a split holds no failure, the next one tried splits the prefix in
+        // half again.  Test as many of those at once as can be tried before
+        // shuffling kicks in and skip the ones that hold no failure.
+        if (ShufflingEnabled)
+          Jobs = std::min(Jobs,
+                          MaxIterations + 1 - NumOfIterationsWithoutProgress);
+        std::vector<Candidate> Splits;
+        for (unsigned Top = MidTop; Top > 1 && Splits.size() < Jobs; Top /= 2) {
+          Splits.push_back(Candidate());
+          Splits.back().Prefix.assign(TheList.begin(), TheList.begin()+Top/2);
+          Splits.back().Kept.assign(TheList.begin()+Top/2, TheList.end());
+        }
+        unsigned First = findFirstFailing(Splits);
+        for (unsigned i = 0; i != First; ++i) {
+          MidTop /= 2;
+          NumOfIterationsWithoutProgress++;
+        }
+        if (First == Splits.size())
+          continue;
+      }
+
       unsigned Mid = MidTop / 2;
       std::vector<ElTy> Prefix(TheList.begin(), TheList.begin()+Mid);
       std::vector<ElTy> Suffix(TheList.begin()+Mid, TheList.end());
@@ -173,6 +245,25 @@ Backjump:
             errs() << "\n\n*** Reduction Interrupted, cleaning up...\n\n";
             return true;
           }
+
+          unsigned Jobs = getNumReductionJobs();
+          if (Jobs > 1) {
+            // Test deleting the next few elements at once and skip those that
+            // can't be deleted.
+            std::vector<Candidate> Trims;
+            for (unsigned j = i; j < TheList.size()-1 && Trims.size() < Jobs;
+                 ++j) {
+              Trims.push_back(Candidate());
+              Trims.back().Kept = TheList;
+              Trims.back().Kept.erase(Trims.back().Kept.begin()+j);
+            }
+            unsigned First = findFirstFailing(Trims);
+            i += First;
+            if (First == Trims.size()) {
+              --i;  // The loop increment moves past the last one tested.
+              continue;
+            }
+          }
           
           std::vector<ElTy> TestList(TheList);
           TestList.erase(TestList.begin()+i);
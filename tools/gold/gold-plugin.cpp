@@ -80,6 +80,8 @@ namespace options {
   static std::string extra_library_path;
   static std::string triple;
   static std::string mcpu;
+  // Directory in which to keep LTO objects for reuse by later links.
+  static std::string cache_dir;
   // Additional options to pass into the code generator.
   // Note: This array will contain all plugin options which are not claimed
   // as plugin exclusive to pass to the code generator.
@@ -97,6 +99,8 @@ namespace options {
       generate_api_file = true;
     } else if (opt.startswith("mcpu=")) {
       mcpu = opt.substr(strlen("mcpu="));
+    } else if (opt.startswith("cache-dir=")) {
+      cache_dir = opt.substr(strlen("cache-dir="));
     } else if (opt.startswith("extra-library-path=")) {
       extra_library_path = opt.substr(strlen("extra_library_path="));
     } else if (opt.startswith("mtriple=")) {
@@ -359,8 +363,9 @@ static ld_plugin_status claim_file_hook(const ld_plugin_input_file *file,
 
   if (code_gen) {
     if (lto_codegen_add_module(code_gen, M)) {
-      (*message)(LDPL_ERROR, "Error linking module: %s",
+      (*message)(LDPL_ERROR, "Error linking module %s: %s", file->name,
                  lto_get_error_message());
+      lto_module_dispose(M);
       return LDPS_ERR;
     }
   }
@@ -370,12 +375,29 @@ static ld_plugin_status claim_file_hook(const ld_plugin_input_file *file,
   return LDPS_OK;
 }
 
-static bool mustPreserve(const claimed_file &F, int i) {
-  if (F.syms[i].resolution == LDPR_PREVAILING_DEF)
+/// getResolution - Translate gold's resolution of symbol i of F.  Return
+/// false if F does not define the symbol, or its definition is preempted by
+/// one in another IR file, which then gives the resolution.
+static bool getResolution(const claimed_file &F, int i,
+                          lto_symbol_resolution &Res) {
+  switch (F.syms[i].resolution) {
+  case LDPR_PREVAILING_DEF:
+    Res = LTO_SYMBOL_RESOLUTION_PREVAILING_DEF;
     return true;
-  if (F.syms[i].resolution == LDPR_PREVAILING_DEF_IRONLY_EXP)
-    return CannotBeHidden.count(F.syms[i].name);
-  return false;
+  case LDPR_PREVAILING_DEF_IRONLY_EXP:
+    Res = CannotBeHidden.count(F.syms[i].name) ?
+      LTO_SYMBOL_RESOLUTION_PREVAILING_DEF :
+      LTO_SYMBOL_RESOLUTION_PREVAILING_DEF_IRONLY;
+    return true;
+  case LDPR_PREVAILING_DEF_IRONLY:
+    Res = LTO_SYMBOL_RESOLUTION_PREVAILING_DEF_IRONLY;
+    return true;
+  case LDPR_PREEMPTED_REG:
+    Res = LTO_SYMBOL_RESOLUTION_PREEMPTED;
+    return true;
+  default:
+    return false;
+  }
 }
 
 /// all_symbols_read_hook - gold informs us that all symbols have been read.
@@ -400,12 +422,14 @@ static ld_plugin_status all_symbols_read_hook(void) {
       continue;
     (*get_symbols)(I->handle, I->syms.size(), &I->syms[0]);
     for (unsigned i = 0, e = I->syms.size(); i != e; i++) {
-      if (mustPreserve(*I, i)) {
-        lto_codegen_add_must_preserve_symbol(code_gen, I->syms[i].name);
-
-        if (options::generate_api_file)
-          api_file << I->syms[i].name << "\n";
-      }
+      lto_symbol_resolution Res;
+      if (!getResolution(*I, i, Res))
+        continue;
+      lto_codegen_set_symbol_resolution(code_gen, I->syms[i].name, Res);
+
+      if (options::generate_api_file &&
+          Res == LTO_SYMBOL_RESOLUTION_PREVAILING_DEF)
+        api_file << I->syms[i].name << "\n";
     }
   }
 
@@ -416,6 +440,8 @@ static ld_plugin_status all_symbols_read_hook(void) {
   lto_codegen_set_debug_model(code_gen, LTO_DEBUG_MODEL_DWARF);
   if (!options::mcpu.empty())
     lto_codegen_set_cpu(code_gen, options::mcpu.c_str());
+  if (!options::cache_dir.empty())
+    lto_codegen_set_cache_dir(code_gen, options::cache_dir.c_str());
 
   // Pass through extra options to the code generator.
   if (!options::extra.empty()) {
@@ -38,6 +38,7 @@
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/TargetSelect.h"
 #include "llvm/Support/ToolOutputFile.h"
+#include "llvm/Support/raw_mmap_ostream.h"
 #include "llvm/Target/TargetLibraryInfo.h"
 #include "llvm/Target/TargetMachine.h"
 #include <memory>
@@ -97,9 +98,12 @@ GetFileNameRoot(const std::string &InputFilename) {
   return outputFilename;
 }
 
-static tool_output_file *GetOutputStream(const char *TargetName,
-                                         Triple::OSType OS,
-                                         const char *ProgName) {
+/// GetOutputStream - Open the output file in Out, or in MappedOut for an
+/// object file that can be written through a memory mapping.
+static bool GetOutputStream(const char *TargetName, Triple::OSType OS,
+                            const char *ProgName,
+                            OwningPtr<tool_output_file> &Out,
+                            OwningPtr<raw_mmap_ostream> &MappedOut) {
   // If we don't yet have an output filename, make one.
   if (OutputFilename.empty()) {
     if (InputFilename == "-")
@@ -145,18 +149,28 @@ static tool_output_file *GetOutputStream(const char *TargetName,
 
   // Open the file.
   std::string error;
+  if (FileType == TargetMachine::CGFT_ObjectFile &&
+      raw_mmap_ostream::shouldUse(OutputFilename)) {
+    MappedOut.reset(new raw_mmap_ostream(OutputFilename, error));
+    if (!error.empty()) {
+      errs() << error << '\n';
+      MappedOut.reset();
+      return false;
+    }
+    return true;
+  }
+
   sys::fs::OpenFlags OpenFlags = sys::fs::F_None;
   if (Binary)
     OpenFlags |= sys::fs::F_Binary;
-  tool_output_file *FDOut = new tool_output_file(OutputFilename.c_str(), error,
-                                                 OpenFlags);
+  Out.reset(new tool_output_file(OutputFilename.c_str(), error, OpenFlags));
   if (!error.empty()) {
     errs() << error << '\n';
-    delete FDOut;
-    return 0;
+    Out.reset();
+    return false;
   }
 
-  return FDOut;
+  return true;
 }
 
 // main - Entry point for the llc compiler.
@@ -306,9 +320,13 @@ static int compileModule(char **argv, LLVMContext &Context) {
     Target.setMCUseLoc(false);
 
   // Figure out where we are going to send the output.
-  OwningPtr<tool_output_file> Out
-    (GetOutputStream(TheTarget->getName(), TheTriple.getOS(), argv[0]));
-  if (!Out) return 1;
+  OwningPtr<tool_output_file> Out;
+  OwningPtr<raw_mmap_ostream> MappedOut;
+  if (!GetOutputStream(TheTarget->getName(), TheTriple.getOS(), argv[0], Out,
+                       MappedOut))
+    return 1;
+  raw_ostream &OutStream = MappedOut ? static_cast<raw_ostream&>(*MappedOut)
+                                     : Out->os();
 
   // Build up all of the passes that we want to do to the module.
   PassManager PM;
@@ -340,7 +358,7 @@ static int compileModule(char **argv, LLVMContext &Context) {
   }
 
   {
-    formatted_raw_ostream FOS(Out->os());
+    formatted_raw_ostream FOS(OutStream);
 
     AnalysisID StartAfterID = 0;
     AnalysisID StopAfterID = 0;
@@ -377,7 +395,10 @@ static int compileModule(char **argv, LLVMContext &Context) {
   }
 
   // Declare success.
-  Out->keep();
+  if (MappedOut)
+    MappedOut->keep();
+  else
+    Out->keep();
 
   return 0;
 }
@@ -27,6 +27,7 @@
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
 #include <cstdlib>
+#include <map>
 #include <memory>
 
 #if !defined(_MSC_VER) && !defined(__MINGW32__)
@@ -68,6 +69,11 @@ static cl::list<std::string>
 RestOfArgs(cl::Positional, cl::OneOrMore,
     cl::desc("[relpos] [count] <archive-file> [members]..."));
 
+static cl::opt<bool>
+ReuseSymbolTable("reuse-symbol-table", cl::init(false),
+    cl::desc("Take the symbols of members kept from the old archive from its "
+             "symbol table instead of rereading them"));
+
 std::string Options;
 
 // MoreHelp - Provide additional help output explaining the operations and
@@ -650,16 +656,67 @@ static void writeStringTable(raw_fd_ostream &Out,
   Out.seek(Pos);
 }
 
+typedef std::map<object::Archive::child_iterator, std::vector<StringRef> >
+    OldSymbolMapTy;
+
+// Collect the symbol names of each member from the old archive's symbol
+// table. Returns false if the table can't be used.
+static bool readOldSymbolTable(object::Archive *OldArchive,
+                               OldSymbolMapTy &OldSymbols) {
+  if (!OldArchive || !OldArchive->hasSymbolTable() ||
+      OldArchive->kind() == object::Archive::K_BSD)
+    return false;
+  for (object::Archive::symbol_iterator I = OldArchive->begin_symbols(),
+                                        E = OldArchive->end_symbols();
+       I != E; ++I) {
+    StringRef Name;
+    object::Archive::child_iterator Member;
+    if (I->getName(Name) || I->getMember(Member))
+      return false;
+    OldSymbols[Member].push_back(Name);
+  }
+  return true;
+}
+
 static void writeSymbolTable(
     raw_fd_ostream &Out, ArrayRef<NewArchiveIterator> Members,
+    object::Archive *OldArchive,
     std::vector<std::pair<unsigned, unsigned> > &MemberOffsetRefs) {
   unsigned StartOffset = 0;
   unsigned MemberNum = 0;
-  std::vector<StringRef> SymNames;
-  std::vector<object::ObjectFile *> DeleteIt;
+  unsigned NumSyms = 0;
+  // The names are copied out so that each object can be freed as soon as its
+  // symbols have been read.
+  std::string SymNames;
+
+  OldSymbolMapTy OldSymbols;
+  bool HaveOldSymbols =
+      ReuseSymbolTable && readOldSymbolTable(OldArchive, OldSymbols);
+
   for (ArrayRef<NewArchiveIterator>::iterator I = Members.begin(),
                                               E = Members.end();
        I != E; ++I, ++MemberNum) {
+    // A member that had symbols in the old table is an object file whose
+    // symbols are already known.
+    if (HaveOldSymbols && !I->isNewMember()) {
+      OldSymbolMapTy::const_iterator Old = OldSymbols.find(I->getOld());
+      if (Old != OldSymbols.end()) {
+        if (!StartOffset) {
+          printMemberHeader(Out, "", sys::TimeValue::now(), 0, 0, 0, 0);
+          StartOffset = Out.tell();
+          print32BE(Out, 0);
+        }
+        for (unsigned i = 0, e = Old->second.size(); i != e; ++i) {
+          SymNames += Old->second[i];
+          SymNames += '\0';
+          ++NumSyms;
+          MemberOffsetRefs.push_back(std::make_pair(Out.tell(), MemberNum));
+          print32BE(Out, 0);
+        }
+        continue;
+      }
+    }
+
     object::ObjectFile *Obj;
     if (I->isNewMember()) {
       const char *Filename = I->getNew();
@@ -678,7 +735,7 @@ static void writeSymbolTable(
     }
     if (!Obj)
       continue;
-    DeleteIt.push_back(Obj);
+    OwningPtr<object::ObjectFile> DeleteIt(Obj);
     if (!StartOffset) {
       printMemberHeader(Out, "", sys::TimeValue::now(), 0, 0, 0, 0);
       StartOffset = Out.tell();
@@ -699,24 +756,14 @@ static void writeSymbolTable(
         continue;
       StringRef Name;
       failIfError(I->getName(Name));
-      SymNames.push_back(Name);
+      SymNames += Name;
+      SymNames += '\0';
+      ++NumSyms;
       MemberOffsetRefs.push_back(std::make_pair(Out.tell(), MemberNum));
       print32BE(Out, 0);
     }
   }
-  for (std::vector<StringRef>::iterator I = SymNames.begin(),
-                                        E = SymNames.end();
-       I != E; ++I) {
-    Out << *I;
-    Out << '\0';
-  }
-
-  for (std::vector<object::ObjectFile *>::iterator I = DeleteIt.begin(),
-                                                   E = DeleteIt.end();
-       I != E; ++I) {
-    object::ObjectFile *O = *I;
-    delete O;
-  }
+  Out << SymNames;
 
   if (StartOffset == 0)
     return;
@@ -728,7 +775,7 @@ static void writeSymbolTable(
   Out.seek(StartOffset - 12);
   printWithSpacePadding(Out, Pos - StartOffset, 10);
   Out.seek(StartOffset);
-  print32BE(Out, SymNames.size());
+  print32BE(Out, NumSyms);
   Out.seek(Pos);
 }
 
@@ -749,7 +796,7 @@ static void performWriteOperation(ArchiveOperation Operation,
   std::vector<std::pair<unsigned, unsigned> > MemberOffsetRefs;
 
   if (Symtab) {
-    writeSymbolTable(Out, NewMembers, MemberOffsetRefs);
+    writeSymbolTable(Out, NewMembers, OldArchive, MemberOffsetRefs);
   }
 
   std::vector<unsigned> StringMapIndexes;
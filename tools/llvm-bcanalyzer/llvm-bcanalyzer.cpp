@@ -110,6 +110,7 @@ static const char *GetBlockName(unsigned BlockID,
   case bitc::METADATA_BLOCK_ID:        return "METADATA_BLOCK";
   case bitc::METADATA_ATTACHMENT_ID:   return "METADATA_ATTACHMENT_BLOCK";
   case bitc::USELIST_BLOCK_ID:         return "USELIST_BLOCK_ID";
+  case bitc::MODULE_SUMMARY_BLOCK_ID:  return "MODULE_SUMMARY_BLOCK";
   }
 }
 
@@ -157,6 +158,7 @@ static const char *GetCodeName(unsigned CodeID, unsigned BlockID,
     case bitc::MODULE_CODE_ALIAS:       return "ALIAS";
     case bitc::MODULE_CODE_PURGEVALS:   return "PURGEVALS";
     case bitc::MODULE_CODE_GCNAME:      return "GCNAME";
+    case bitc::MODULE_CODE_FNINDEX:     return "FNINDEX";
     }
   case bitc::PARAMATTR_BLOCK_ID:
     switch (CodeID) {
@@ -274,6 +276,12 @@ static const char *GetCodeName(unsigned CodeID, unsigned BlockID,
     default:return 0;
     case bitc::USELIST_CODE_ENTRY:   return "USELIST_CODE_ENTRY";
     }
+  case bitc::MODULE_SUMMARY_BLOCK_ID:
+    switch(CodeID) {
+    default:return 0;
+    case bitc::SUMMARY_CODE_SYMBOL:  return "SYMBOL";
+    case bitc::SUMMARY_CODE_CALLS:   return "CALLS";
+    }
   }
 }
 
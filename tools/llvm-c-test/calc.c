@@ -10,6 +10,8 @@
 |* This file implements the --calc command in llvm-c-test. --calc reads lines *|
 |* from stdin, parses them as a name and an expression in reverse polish      *|
 |* notation and prints a module with a function with the expression.          *|
+|* --calc-batch does the same, building the function with a single call to   *|
+|* LLVMBuildInstructions.                                                     *|
 |*                                                                            *|
 \*===----------------------------------------------------------------------===*/
 
@@ -110,6 +112,127 @@ static LLVMValueRef build_from_tokens(char **tokens, int ntokens,
   return stack[depth - 1];
 }
 
+static void add_inst(LLVMInstructionDesc *insts, unsigned *ninsts,
+                     LLVMOpcode opcode, const unsigned *operands,
+                     unsigned noperands) {
+  LLVMInstructionDesc *inst = &insts[(*ninsts)++];
+  memset(inst, 0, sizeof(*inst));
+  inst->Opcode = opcode;
+  inst->Operands = operands;
+  inst->NumOperands = noperands;
+}
+
+/* Like build_from_tokens, with a single call to LLVMBuildInstructions.  The
+ * value table holds the parameter, then the constants in token order, then
+ * the results of the instructions. */
+static LLVMValueRef build_batch_from_tokens(char **tokens, int ntokens,
+                                            LLVMBuilderRef builder,
+                                            LLVMValueRef param) {
+  LLVMInstructionDesc *insts;
+  LLVMValueRef *values;
+  unsigned *operands;
+  unsigned stack[MAX_DEPTH];
+  unsigned nvalues = 1, nconsts = 1, ninsts = 0, noperands = 0, nbuilt;
+  LLVMValueRef res = NULL;
+  int depth = 0;
+  int i;
+
+  /* Every token makes at most a constant or two instructions with two
+   * operands each, and the ret has one operand. */
+  insts = malloc(sizeof(*insts) * (2 * ntokens + 1));
+  values = malloc(sizeof(*values) * (3 * ntokens + 2));
+  operands = malloc(sizeof(*operands) * (4 * ntokens + 1));
+
+  values[0] = param;
+  for (i = 0; i < ntokens; i++) {
+    char *end;
+    long val;
+    if (tokens[i][1] == '\0' && strchr("+-*/&|^@", tokens[i][0]))
+      continue;
+    val = strtol(tokens[i], &end, 0);
+    if (end[0] != '\0') {
+      printf("error parsing number\n");
+      goto out;
+    }
+    values[nvalues++] = LLVMConstInt(LLVMInt64Type(), val, 1);
+  }
+
+  for (i = 0; i < ntokens; i++) {
+    char tok = tokens[i][0];
+    switch (tok) {
+    case '+':
+    case '-':
+    case '*':
+    case '/':
+    case '&':
+    case '|':
+    case '^':
+      if (depth < 2) {
+        printf("stack underflow\n");
+        goto out;
+      }
+
+      operands[noperands] = stack[depth - 1];
+      operands[noperands + 1] = stack[depth - 2];
+      add_inst(insts, &ninsts, op_to_opcode(tok), &operands[noperands], 2);
+      noperands += 2;
+      stack[depth - 2] = nvalues + ninsts - 1;
+      depth--;
+
+      break;
+
+    case '@':
+      if (depth < 1) {
+        printf("stack underflow\n");
+        goto out;
+      }
+
+      operands[noperands] = 0;
+      operands[noperands + 1] = stack[depth - 1];
+      add_inst(insts, &ninsts, LLVMGetElementPtr, &operands[noperands], 2);
+      noperands += 2;
+      operands[noperands] = nvalues + ninsts - 1;
+      add_inst(insts, &ninsts, LLVMLoad, &operands[noperands], 1);
+      noperands++;
+      stack[depth - 1] = nvalues + ninsts - 1;
+
+      break;
+
+    default:
+      if (depth >= MAX_DEPTH) {
+        printf("stack overflow\n");
+        goto out;
+      }
+
+      stack[depth++] = nconsts++;
+      break;
+    }
+  }
+
+  if (depth < 1) {
+    printf("stack underflow at return\n");
+    goto out;
+  }
+
+  operands[noperands] = stack[depth - 1];
+  add_inst(insts, &ninsts, LLVMRet, &operands[noperands], 1);
+
+  nbuilt = LLVMBuildInstructions(builder, insts, ninsts, values, nvalues);
+  if (nbuilt != ninsts) {
+    printf("failed to build instruction %u\n", nbuilt);
+    goto out;
+  }
+  res = values[stack[depth - 1]];
+
+out:
+  free(insts);
+  free(values);
+  free(operands);
+  return res;
+}
+
+static int use_batch;
+
 static void handle_line(char **tokens, int ntokens) {
   char *name = tokens[0];
   LLVMValueRef param;
@@ -128,7 +251,10 @@ static void handle_line(char **tokens, int ntokens) {
   LLVMGetParams(F, &param);
   LLVMSetValueName(param, "in");
 
-  res = build_from_tokens(tokens + 1, ntokens - 1, builder, param);
+  if (use_batch)
+    res = build_batch_from_tokens(tokens + 1, ntokens - 1, builder, param);
+  else
+    res = build_from_tokens(tokens + 1, ntokens - 1, builder, param);
   if (res) {
     char *irstr = LLVMPrintModuleToString(M);
     puts(irstr);
@@ -146,3 +272,8 @@ int calc(void) {
 
   return 0;
 }
+
+int calc_batch(void) {
+  use_batch = 1;
+  return calc();
+}
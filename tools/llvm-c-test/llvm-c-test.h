@@ -23,6 +23,7 @@ int module_list_globals(void);
 
 // calc.c
 int calc(void);
+int calc_batch(void);
 
 // disassemble.c
 int disassemble(void);
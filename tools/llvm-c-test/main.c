@@ -42,6 +42,9 @@ static void print_usage(void) {
   fprintf(
       stderr,
       "    Read lines of name, rpn from stdin - print generated module\n\n");
+  fprintf(stderr, "  * --calc-batch\n");
+  fprintf(stderr, "    Like --calc, building each function with one call to "
+                  "LLVMBuildInstructions\n\n");
 }
 
 int main(int argc, char **argv) {
@@ -65,6 +68,8 @@ int main(int argc, char **argv) {
     return disassemble();
   } else if (argc == 2 && !strcmp(argv[1], "--calc")) {
     return calc();
+  } else if (argc == 2 && !strcmp(argv[1], "--calc-batch")) {
+    return calc_batch();
   } else {
     print_usage();
   }
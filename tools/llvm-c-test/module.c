@@ -61,7 +61,6 @@ int module_list_functions(void) {
       printf("FunctionDeclaration: %s\n", LLVMGetValueName(f));
     } else {
       LLVMBasicBlockRef bb;
-      LLVMValueRef isn;
       unsigned nisn = 0;
       unsigned nbb = 0;
 
@@ -70,16 +69,26 @@ int module_list_functions(void) {
 
       for (bb = LLVMGetFirstBasicBlock(f); bb;
            bb = LLVMGetNextBasicBlock(bb)) {
+        unsigned n = LLVMCountInstructions(bb);
+        LLVMValueRef *isns = malloc(n * sizeof(LLVMValueRef));
+        LLVMOpcode *opcodes = malloc(n * sizeof(LLVMOpcode));
+        unsigned i;
+
         nbb++;
-        for (isn = LLVMGetFirstInstruction(bb); isn;
-             isn = LLVMGetNextInstruction(isn)) {
-          nisn++;
-          if (LLVMIsACallInst(isn)) {
-            LLVMValueRef callee =
-                LLVMGetOperand(isn, LLVMGetNumOperands(isn) - 1);
-            printf(" calls: %s\n", LLVMGetValueName(callee));
+        nisn += n;
+        LLVMGetInstructions(bb, isns);
+        LLVMGetInstructionOpcodes(bb, opcodes);
+        for (i = 0; i < n; i++) {
+          if (opcodes[i] == LLVMCall) {
+            unsigned nops = LLVMGetNumOperands(isns[i]);
+            LLVMValueRef *ops = malloc(nops * sizeof(LLVMValueRef));
+            LLVMGetOperands(isns[i], ops);
+            printf(" calls: %s\n", LLVMGetValueName(ops[nops - 1]));
+            free(ops);
           }
         }
+        free(isns);
+        free(opcodes);
       }
       printf(" #isn: %u\n", nisn);
       printf(" #bb: %u\n\n", nbb);
@@ -16,8 +16,10 @@
 #include "llvm/Support/GCOV.h"
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/MemoryObject.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/PrettyStackTrace.h"
 #include "llvm/Support/Signals.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/system_error.h"
 using namespace llvm;
 
@@ -47,6 +49,85 @@ static cl::opt<bool>
 UncondBranch("u", cl::init(false), cl::desc("display unconditional branch info \
                                              (requires -b)"));
 
+static cl::opt<std::string>
+MergeOutput("merge", cl::init(""), cl::value_desc("file"),
+            cl::desc("merge the input gcda files into <file>"));
+
+static cl::list<std::string>
+MergeInputs(cl::Positional, cl::ZeroOrMore,
+            cl::desc("<gcda files to merge (with -merge)>"));
+
+namespace {
+/// MergeGroup - A share of the files to merge, summed by a single task.  Its
+/// errors are kept in Errors and printed once every task is done, so that
+/// the output of different tasks does not interleave.
+struct MergeGroup {
+  std::vector<std::string> Files;
+  GCDAProfile Profile;
+  std::string Errors;
+  bool Failed;
+
+  MergeGroup() : Failed(false) {}
+};
+
+struct MergeFiles {
+  void operator()(MergeGroup &Group) const {
+    raw_string_ostream ErrOS(Group.Errors);
+    for (unsigned i = 0, e = Group.Files.size(); i != e && !Group.Failed; ++i) {
+      OwningPtr<MemoryBuffer> Buff;
+      if (error_code ec = MemoryBuffer::getFile(Group.Files[i], Buff)) {
+        ErrOS << Group.Files[i] << ": " << ec.message() << "\n";
+        Group.Failed = true;
+        break;
+      }
+      GCOVBuffer GB(Buff.get(), ErrOS);
+      if (!Group.Profile.read(GB)) {
+        ErrOS << Group.Files[i] << ": Invalid .gcda File!\n";
+        Group.Failed = true;
+      }
+    }
+  }
+};
+} // end anonymous namespace
+
+/// mergeGCDAFiles - Sum the counters of the input .gcda files into a single
+/// one.  The inputs are split between the pool threads, each of which sums its
+/// share, and the partial sums are then added up.
+static int mergeGCDAFiles() {
+  if (MergeInputs.empty()) {
+    errs() << "No gcda files to merge!\n";
+    return 1;
+  }
+
+  unsigned NumGroups = std::min<size_t>(MergeInputs.size(),
+                                        ThreadPool::getDefaultThreadCount());
+  std::vector<MergeGroup> Groups(NumGroups);
+  for (unsigned i = 0, e = MergeInputs.size(); i != e; ++i)
+    Groups[i * NumGroups / e].Files.push_back(MergeInputs[i]);
+  parallel_for_each(Groups.begin(), Groups.end(), MergeFiles());
+
+  for (unsigned i = 0; i != NumGroups; ++i)
+    errs() << Groups[i].Errors;
+
+  GCDAProfile &Merged = Groups[0].Profile;
+  for (unsigned i = 0; i != NumGroups; ++i) {
+    if (Groups[i].Failed || (i && !Merged.merge(Groups[i].Profile))) {
+      errs() << "Could not merge " << Groups[i].Files.size()
+             << " file(s) starting with " << Groups[i].Files[0] << ".\n";
+      return 1;
+    }
+  }
+
+  std::string ErrorInfo;
+  raw_fd_ostream OS(MergeOutput.c_str(), ErrorInfo, sys::fs::F_Binary);
+  if (!ErrorInfo.empty()) {
+    errs() << MergeOutput << ": " << ErrorInfo << "\n";
+    return 1;
+  }
+  Merged.write(OS);
+  return 0;
+}
+
 //===----------------------------------------------------------------------===//
 int main(int argc, char **argv) {
   // Print a stack trace if we signal out.
@@ -56,6 +137,9 @@ int main(int argc, char **argv) {
 
   cl::ParseCommandLineOptions(argc, argv, "llvm coverage tool\n");
 
+  if (!MergeOutput.empty())
+    return mergeGCDAFiles();
+
   GCOVFile GF;
   if (InputGCNO.empty())
     errs() << " " << argv[0] << ": No gcov input file!\n";
@@ -187,6 +187,79 @@ void DiffConsumer::logf(const LogBuilder &Log) {
   out << '\n';
 }
 
+void RecordingConsumer::replay(Consumer &C) const {
+  for (std::vector<Event>::const_iterator I = Events.begin(), E = Events.end();
+       I != E; ++I) {
+    switch (I->Kind) {
+    case EK_Enter:
+      C.enterContext(I->L, I->R);
+      break;
+    case EK_Exit:
+      C.exitContext();
+      break;
+    case EK_Log:
+      C.log(I->Text);
+      break;
+    case EK_LogF: {
+      LogBuilder Log(C, I->Text);
+      for (unsigned A = 0, AE = I->Arguments.size(); A != AE; ++A)
+        Log << I->Arguments[A];
+      break;
+    }
+    case EK_LogD: {
+      DiffLogBuilder Log(C);
+      for (unsigned L = 0, LE = I->Lines.size(); L != LE; ++L) {
+        if (!I->Lines[L].second)
+          Log.addLeft(I->Lines[L].first);
+        else if (!I->Lines[L].first)
+          Log.addRight(I->Lines[L].second);
+        else
+          Log.addMatch(I->Lines[L].first, I->Lines[L].second);
+      }
+      break;
+    }
+    }
+  }
+}
+
+void RecordingConsumer::enterContext(Value *L, Value *R) {
+  if (SummaryOnly) return;
+  Events.push_back(Event(EK_Enter));
+  Events.back().L = L;
+  Events.back().R = R;
+}
+
+void RecordingConsumer::exitContext() {
+  if (SummaryOnly) return;
+  Events.push_back(Event(EK_Exit));
+}
+
+void RecordingConsumer::log(StringRef text) {
+  Differences = true;
+  if (SummaryOnly) return;
+  Events.push_back(Event(EK_Log));
+  Events.back().Text = text;
+}
+
+void RecordingConsumer::logf(const LogBuilder &Log) {
+  Differences = true;
+  if (SummaryOnly) return;
+  Events.push_back(Event(EK_LogF));
+  Event &Ev = Events.back();
+  Ev.Text = Log.getFormat();
+  for (unsigned I = 0, E = Log.getNumArguments(); I != E; ++I)
+    Ev.Arguments.push_back(Log.getArgument(I));
+}
+
+void RecordingConsumer::logd(const DiffLogBuilder &Log) {
+  Differences = true;
+  if (SummaryOnly) return;
+  Events.push_back(Event(EK_LogD));
+  Event &Ev = Events.back();
+  for (unsigned I = 0, E = Log.getNumLines(); I != E; ++I)
+    Ev.Lines.push_back(std::make_pair(Log.getLeft(I), Log.getRight(I)));
+}
+
 void DiffConsumer::logd(const DiffLogBuilder &Log) {
   header();
 
@@ -20,8 +20,11 @@
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Casting.h"
 #include "llvm/Support/raw_ostream.h"
+#include <string>
+#include <vector>
 
 namespace llvm {
+  class Instruction;
   class Module;
   class Value;
   class Function;
@@ -48,10 +51,55 @@ namespace llvm {
     /// Record a line-by-line instruction diff.
     virtual void logd(const DiffLogBuilder &Log) = 0;
 
+    /// Whether the engine may stop comparing the current function.
+    /// Consumers that only need to know whether functions differ return
+    /// true once they have seen a difference.
+    virtual bool isDone() const { return false; }
+
   protected:
     virtual ~Consumer() {}
   };
 
+  /// A consumer that keeps the differences reported to it so that they can
+  /// be passed on to another consumer later, in the same order.  This lets
+  /// functions be compared concurrently while their differences are still
+  /// printed in module order.
+  class RecordingConsumer : public Consumer {
+    enum EventKind { EK_Enter, EK_Exit, EK_Log, EK_LogF, EK_LogD };
+
+    struct Event {
+      explicit Event(EventKind Kind) : Kind(Kind), L(0), R(0) {}
+      EventKind Kind;
+      Value *L, *R;
+      std::string Text;
+      SmallVector<Value*, 4> Arguments;
+      /// The lines of a logd: a left-only line has no right instruction
+      /// and a right-only line has no left one.
+      SmallVector<std::pair<Instruction*, Instruction*>, 8> Lines;
+    };
+
+    std::vector<Event> Events;
+    bool Differences;
+    bool SummaryOnly;
+
+  public:
+    /// With \p SummaryOnly, only whether there were differences is kept.
+    explicit RecordingConsumer(bool SummaryOnly = false)
+      : Differences(false), SummaryOnly(SummaryOnly) {}
+
+    bool hadDifferences() const { return Differences; }
+
+    /// Report the recorded events to \p C.
+    void replay(Consumer &C) const;
+
+    void enterContext(Value *L, Value *R);
+    void exitContext();
+    void log(StringRef text);
+    void logf(const LogBuilder &Log);
+    void logd(const DiffLogBuilder &Log);
+    bool isDone() const { return SummaryOnly && Differences; }
+  };
+
   class DiffConsumer : public Consumer {
   private:
     struct DiffContext {
@@ -15,6 +15,7 @@
 #include "DifferenceEngine.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/StringSet.h"
@@ -25,9 +26,13 @@
 #include "llvm/Support/CFG.h"
 #include "llvm/Support/CallSite.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/Parallel.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/type_traits.h"
+#include <algorithm>
 #include <utility>
+#include <vector>
 
 using namespace llvm;
 
@@ -183,7 +188,7 @@ class FunctionDifferenceEngine {
   }
 
   void processQueue() {
-    while (!Queue.empty()) {
+    while (!Queue.empty() && !Engine.getConsumer().isDone()) {
       BlockPair Pair = Queue.remove_min();
       diff(Pair.first, Pair.second);
     }
@@ -472,12 +477,27 @@ public:
   }
 };
 
-struct DiffEntry {
-  DiffEntry() : Cost(0) {}
-
-  unsigned Cost;
-  llvm::SmallVector<char, 8> Path; // actually of DifferenceEngine::DiffChange
-};
+/// Hash the parts of an instruction that diff() requires to be the same on
+/// both sides, so that instructions with different hashes never match.
+/// Constants and globals are only hashed by kind since they match by
+/// oracle and structure, not identity.
+static hash_code getStructuralHash(Instruction *I) {
+  hash_code Hash = hash_value(I->getOpcode());
+  if (CmpInst *CI = dyn_cast<CmpInst>(I))
+    Hash = hash_combine(Hash, CI->getPredicate());
+
+  // Phis are not compared beyond their types.
+  if (isa<PHINode>(I))
+    return Hash;
+
+  // Every other instruction needs the same operand count and operands of the
+  // same kinds, including calls, whose callee and arguments are all compared,
+  // and terminators, whose uncompared operands are blocks and case values.
+  Hash = hash_combine(Hash, I->getNumOperands());
+  for (User::op_iterator OI = I->op_begin(), OE = I->op_end(); OI != OE; ++OI)
+    Hash = hash_combine(Hash, (*OI)->getValueID());
+  return Hash;
+}
 
 bool FunctionDifferenceEngine::matchForBlockDiff(Instruction *L,
                                                  Instruction *R) {
@@ -489,13 +509,26 @@ void FunctionDifferenceEngine::runBlockDiff(BasicBlock::iterator LStart,
   BasicBlock::iterator LE = LStart->getParent()->end();
   BasicBlock::iterator RE = RStart->getParent()->end();
 
-  unsigned NL = std::distance(LStart, LE);
+  // Hash the instructions first: most pairs of instructions can then be
+  // ruled out as matches without comparing their operands.
+  SmallVector<hash_code, 20> LHashes, RHashes;
+  for (BasicBlock::iterator LI = LStart; LI != LE; ++LI)
+    LHashes.push_back(getStructuralHash(&*LI));
+  for (BasicBlock::iterator RI = RStart; RI != RE; ++RI)
+    RHashes.push_back(getStructuralHash(&*RI));
+
+  unsigned NL = LHashes.size();
+  unsigned NR = RHashes.size();
+
+  SmallVector<unsigned, 20> Costs1(NL+1);
+  SmallVector<unsigned, 20> Costs2(NL+1);
 
-  SmallVector<DiffEntry, 20> Paths1(NL+1);
-  SmallVector<DiffEntry, 20> Paths2(NL+1);
+  unsigned *Cur = Costs1.data();
+  unsigned *Next = Costs2.data();
 
-  DiffEntry *Cur = Paths1.data();
-  DiffEntry *Next = Paths2.data();
+  // The last step of the cheapest path to each cell, from which the path is
+  // recovered at the end.  Row J holds the cells after J right instructions.
+  std::vector<char> Steps((NL+1) * (NR+1));
 
   const unsigned LeftCost = 2;
   const unsigned RightCost = 2;
@@ -505,32 +538,31 @@ void FunctionDifferenceEngine::runBlockDiff(BasicBlock::iterator LStart,
 
   // Initialize the first column.
   for (unsigned I = 0; I != NL+1; ++I) {
-    Cur[I].Cost = I * LeftCost;
-    for (unsigned J = 0; J != I; ++J)
-      Cur[I].Path.push_back(DC_left);
+    Cur[I] = I * LeftCost;
+    Steps[I] = DC_left;
   }
 
-  for (BasicBlock::iterator RI = RStart; RI != RE; ++RI) {
+  unsigned J = 1;
+  for (BasicBlock::iterator RI = RStart; RI != RE; ++RI, ++J) {
+    unsigned Row = J * (NL+1);
+
     // Initialize the first row.
-    Next[0] = Cur[0];
-    Next[0].Cost += RightCost;
-    Next[0].Path.push_back(DC_right);
+    Next[0] = Cur[0] + RightCost;
+    Steps[Row] = DC_right;
 
     unsigned Index = 1;
     for (BasicBlock::iterator LI = LStart; LI != LE; ++LI, ++Index) {
-      if (matchForBlockDiff(&*LI, &*RI)) {
-        Next[Index] = Cur[Index-1];
-        Next[Index].Cost += MatchCost;
-        Next[Index].Path.push_back(DC_match);
+      if (LHashes[Index-1] == RHashes[J-1] &&
+          matchForBlockDiff(&*LI, &*RI)) {
+        Next[Index] = Cur[Index-1] + MatchCost;
+        Steps[Row + Index] = DC_match;
         TentativeValues.insert(std::make_pair(&*LI, &*RI));
-      } else if (Next[Index-1].Cost <= Cur[Index].Cost) {
-        Next[Index] = Next[Index-1];
-        Next[Index].Cost += LeftCost;
-        Next[Index].Path.push_back(DC_left);
+      } else if (Next[Index-1] <= Cur[Index]) {
+        Next[Index] = Next[Index-1] + LeftCost;
+        Steps[Row + Index] = DC_left;
       } else {
-        Next[Index] = Cur[Index];
-        Next[Index].Cost += RightCost;
-        Next[Index].Path.push_back(DC_right);
+        Next[Index] = Cur[Index] + RightCost;
+        Steps[Row + Index] = DC_right;
       }
     }
 
@@ -541,7 +573,16 @@ void FunctionDifferenceEngine::runBlockDiff(BasicBlock::iterator LStart,
   // on out should be non-tentative.
   TentativeValues.clear();
 
-  SmallVectorImpl<char> &Path = Cur[NL].Path;
+  // Walk the steps back from the last cell to recover the path.
+  SmallVector<char, 40> Path;
+  for (unsigned I = NL, J = NR; I != 0 || J != 0; ) {
+    char Step = Steps[J * (NL+1) + I];
+    Path.push_back(Step);
+    if (Step != DC_right) --I;
+    if (Step != DC_left) --J;
+  }
+  std::reverse(Path.begin(), Path.end());
+
   BasicBlock::iterator LI = LStart, RI = RStart;
 
   DiffLogBuilder Diff(Engine.getConsumer());
@@ -626,6 +667,30 @@ void FunctionDifferenceEngine::runBlockDiff(BasicBlock::iterator LStart,
   }
 }
 
+/// A pair of functions to compare, and what the comparison found.
+struct FunctionPair {
+  FunctionPair(Function *L, Function *R, bool SummaryOnly)
+    : L(L), R(R), Recorder(SummaryOnly) {}
+
+  Function *L, *R;
+  RecordingConsumer Recorder;
+};
+
+/// Compares a pair of functions with an engine of its own, so that pairs can
+/// be compared concurrently.
+struct DiffFunctionPair {
+  DifferenceEngine::Oracle *GlobalValueOracle;
+
+  explicit DiffFunctionPair(DifferenceEngine::Oracle *GlobalValueOracle)
+    : GlobalValueOracle(GlobalValueOracle) {}
+
+  void operator()(FunctionPair &Pair) const {
+    DifferenceEngine Engine(Pair.Recorder);
+    Engine.setGlobalValueOracle(GlobalValueOracle);
+    Engine.diff(Pair.L, Pair.R);
+  }
+};
+
 }
 
 void DifferenceEngine::Oracle::anchor() { }
@@ -650,27 +715,46 @@ void DifferenceEngine::diff(Function *L, Function *R) {
 
 void DifferenceEngine::diff(Module *L, Module *R) {
   StringSet<> LNames;
-  SmallVector<std::pair<Function*,Function*>, 20> Queue;
+  std::vector<FunctionPair> Queue;
+  LastSummary = Summary();
 
   for (Module::iterator I = L->begin(), E = L->end(); I != E; ++I) {
     Function *LFn = &*I;
     LNames.insert(LFn->getName());
 
-    if (Function *RFn = R->getFunction(LFn->getName()))
-      Queue.push_back(std::make_pair(LFn, RFn));
-    else
-      logf("function %l exists only in left module") << LFn;
+    if (Function *RFn = R->getFunction(LFn->getName())) {
+      Queue.push_back(FunctionPair(LFn, RFn, SummaryOnly));
+    } else {
+      ++LastSummary.OnlyLeft;
+      if (!SummaryOnly)
+        logf("function %l exists only in left module") << LFn;
+    }
   }
 
   for (Module::iterator I = R->begin(), E = R->end(); I != E; ++I) {
     Function *RFn = &*I;
-    if (!LNames.count(RFn->getName()))
-      logf("function %r exists only in right module") << RFn;
+    if (!LNames.count(RFn->getName())) {
+      ++LastSummary.OnlyRight;
+      if (!SummaryOnly)
+        logf("function %r exists only in right module") << RFn;
+    }
   }
 
-  for (SmallVectorImpl<std::pair<Function*,Function*> >::iterator
-         I = Queue.begin(), E = Queue.end(); I != E; ++I)
-    diff(I->first, I->second);
+  // The functions are compared concurrently, each recording its differences,
+  // which are then reported in module order.
+  if (Queue.size() > 1 && ThreadPool::getDefaultThreadCount() > 1)
+    llvm_start_multithreaded();
+  parallel_for_each(Queue.begin(), Queue.end(),
+                    DiffFunctionPair(globalValueOracle));
+
+  LastSummary.Compared = Queue.size();
+  for (std::vector<FunctionPair>::iterator I = Queue.begin(), E = Queue.end();
+       I != E; ++I) {
+    if (I->Recorder.hadDifferences())
+      ++LastSummary.Differing;
+    if (!SummaryOnly)
+      I->Recorder.replay(consumer);
+  }
 }
 
 bool DifferenceEngine::equivalentAsOperands(GlobalValue *L, GlobalValue *R) {
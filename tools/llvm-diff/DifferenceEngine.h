@@ -58,8 +58,17 @@ namespace llvm {
       virtual ~Oracle() {}
     };
 
+    /// The number of functions found by the last module comparison.
+    struct Summary {
+      Summary() : Compared(0), Differing(0), OnlyLeft(0), OnlyRight(0) {}
+      unsigned Compared;  ///< Functions present in both modules.
+      unsigned Differing; ///< Compared functions that differ.
+      unsigned OnlyLeft;  ///< Functions only in the left module.
+      unsigned OnlyRight; ///< Functions only in the right module.
+    };
+
     DifferenceEngine(Consumer &consumer)
-      : consumer(consumer), globalValueOracle(0) {}
+      : consumer(consumer), globalValueOracle(0), SummaryOnly(false) {}
 
     void diff(Module *L, Module *R);
     void diff(Function *L, Function *R);
@@ -74,17 +83,29 @@ namespace llvm {
     /// Installs an oracle to decide whether two global values are
     /// equivalent as operands.  Without an oracle, global values are
     /// considered equivalent as operands precisely when they have the
-    /// same name.
+    /// same name.  The oracle may be called from several threads at once
+    /// while modules are compared.
     void setGlobalValueOracle(Oracle *oracle) {
       globalValueOracle = oracle;
     }
 
+    /// Makes module comparisons only count the functions that differ,
+    /// stopping at the first difference of each, instead of reporting the
+    /// differences to the consumer.
+    void setSummaryOnly(bool summaryOnly) {
+      SummaryOnly = summaryOnly;
+    }
+
+    const Summary &getSummary() const { return LastSummary; }
+
     /// Determines whether two global values are equivalent.
     bool equivalentAsOperands(GlobalValue *L, GlobalValue *R);
 
   private:
     Consumer &consumer;
     Oracle *globalValueOracle;
+    bool SummaryOnly;
+    Summary LastSummary;
   };
 }
 
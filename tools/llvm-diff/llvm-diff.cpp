@@ -65,6 +65,9 @@ static cl::opt<std::string> RightFilename(cl::Positional,
                                           cl::Required);
 static cl::list<std::string> GlobalsToCompare(cl::Positional,
                                               cl::desc("<globals to compare>"));
+static cl::opt<bool> SummaryOnly("summary",
+                                 cl::desc("Only print how many functions "
+                                          "differ between the modules"));
 
 int main(int argc, char **argv) {
   cl::ParseCommandLineOptions(argc, argv);
@@ -85,6 +88,17 @@ int main(int argc, char **argv) {
       diffGlobal(Engine, LModule, RModule, GlobalsToCompare[I]);
 
   // Otherwise, diff everything in the module.
+  } else if (SummaryOnly) {
+    Engine.setSummaryOnly(true);
+    Engine.diff(LModule, RModule);
+
+    const DifferenceEngine::Summary &S = Engine.getSummary();
+    outs() << S.Differing << " of " << S.Compared << " functions differ, "
+           << S.OnlyLeft << " only in left module, "
+           << S.OnlyRight << " only in right module\n";
+    delete LModule;
+    delete RModule;
+    return S.Differing || S.OnlyLeft || S.OnlyRight;
   } else {
     Engine.diff(LModule, RModule);
   }
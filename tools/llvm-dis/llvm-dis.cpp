@@ -125,9 +125,11 @@ int main(int argc, char **argv) {
   std::string ErrorMessage;
   OwningPtr<Module> M;
 
-  // Use the bitcode streaming interface
+  // Use the bitcode streaming interface, reading the input while it is being
+  // parsed.
   DataStreamer *streamer = getDataFileStreamer(InputFilename, &ErrorMessage);
   if (streamer) {
+    streamer = getReadAheadDataStreamer(streamer);
     std::string DisplayFilename;
     if (InputFilename == "-")
       DisplayFilename = "<stdin>";
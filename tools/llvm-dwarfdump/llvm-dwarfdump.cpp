@@ -52,6 +52,16 @@ static cl::opt<bool>
 PrintInlining("inlining", cl::init(false),
               cl::desc("Print all inlined frames for a given address"));
 
+static cl::opt<bool>
+PrintCFA("cfa", cl::init(false),
+         cl::desc("Print the rule for the canonical frame address at a given "
+                  "address instead of line information"));
+
+static cl::opt<bool>
+PrintStatistics("statistics", cl::init(false),
+                cl::desc("Print a summary of debug info sizes instead of "
+                         "dumping it"));
+
 static cl::opt<DIDumpType>
 DumpType("debug-dump", cl::init(DIDT_All),
   cl::desc("Dump of debug sections:"),
@@ -100,11 +110,24 @@ static void DumpInput(const StringRef &Filename) {
 
   OwningPtr<DIContext> DICtx(DIContext::getDWARFContext(Obj.get()));
 
-  if (Address == -1ULL) {
+  if (PrintStatistics) {
+    outs() << Filename
+           << ":\tfile format " << Obj->getFileFormatName() << "\n\n";
+    DICtx->dumpStatistics(outs());
+  } else if (Address == -1ULL) {
     outs() << Filename
            << ":\tfile format " << Obj->getFileFormatName() << "\n\n";
     // Dump the complete DWARF structure.
     DICtx->dump(outs(), DumpType);
+  } else if (PrintCFA) {
+    // Print the CFA rule .debug_frame gives for the specified address.
+    uint64_t Register;
+    int64_t Offset;
+    if (DICtx->getCFARuleForAddress(Address, Register, Offset))
+      outs() << "CFA=reg" << Register << (Offset < 0 ? "" : "+") << Offset
+             << '\n';
+    else
+      outs() << "CFA=<unknown>\n";
   } else {
     // Print line info for the specified address.
     int SpecFlags = DILineInfoSpecifier::FileLineInfo |
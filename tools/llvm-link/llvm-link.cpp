@@ -20,12 +20,18 @@
 #include "llvm/IRReader/IRReader.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/PrettyStackTrace.h"
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/SystemUtils.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/ToolOutputFile.h"
+#include "llvm/Support/raw_mmap_ostream.h"
+#include <algorithm>
 #include <memory>
 using namespace llvm;
 
@@ -50,63 +56,177 @@ Verbose("v", cl::desc("Print information about actions taken"));
 static cl::opt<bool>
 DumpAsm("d", cl::desc("Print assembly as linked"), cl::Hidden);
 
+static cl::opt<bool>
+Parallel("parallel",
+         cl::desc("Link shares of the inputs concurrently, each in its own "
+                  "context, with up to -threads threads"));
+
 // LoadFile - Read the specified bitcode file in and return it.  This routine
 // searches the link path for the specified file to try to find it...
 //
+// Unless Lazy is false, function bodies are only read when the Linker needs
+// them, so linkonce functions that nothing references are never read.
 static inline Module *LoadFile(const char *argv0, const std::string &FN,
-                               LLVMContext& Context) {
+                               LLVMContext& Context, bool Lazy,
+                               raw_ostream &OS) {
   SMDiagnostic Err;
-  if (Verbose) errs() << "Loading '" << FN << "'\n";
+  if (Verbose) OS << "Loading '" << FN << "'\n";
   Module* Result = 0;
 
-  Result = ParseIRFile(FN, Err, Context);
+  Result = Lazy ? getLazyIRFileModule(FN, Err, Context)
+                : ParseIRFile(FN, Err, Context);
   if (Result) return Result;   // Load successful!
 
-  Err.print(argv0, errs());
+  Err.print(argv0, OS);
   return NULL;
 }
 
-int main(int argc, char **argv) {
-  // Print a stack trace if we signal out.
-  sys::PrintStackTraceOnErrorSignal();
-  PrettyStackTraceProgram X(argc, argv);
-
-  LLVMContext &Context = getGlobalContext();
-  llvm_shutdown_obj Y;  // Call llvm_shutdown() on exit.
-  cl::ParseCommandLineOptions(argc, argv, "llvm linker\n");
-
-  unsigned BaseArg = 0;
-  std::string ErrorMessage;
-
-  OwningPtr<Module> Composite(LoadFile(argv[0],
-                                       InputFilenames[BaseArg], Context));
+// LinkFiles - Link the specified files, in order, into a new module of
+// Context.  Messages are written to OS.
+static Module *LinkFiles(const char *argv0, ArrayRef<std::string> Files,
+                         LLVMContext &Context, raw_ostream &OS) {
+  OwningPtr<Module> Composite(LoadFile(argv0, Files[0], Context, false, OS));
   if (Composite.get() == 0) {
-    errs() << argv[0] << ": error loading file '"
-           << InputFilenames[BaseArg] << "'\n";
-    return 1;
+    OS << argv0 << ": error loading file '" << Files[0] << "'\n";
+    return 0;
   }
 
   Linker L(Composite.get());
-  for (unsigned i = BaseArg+1; i < InputFilenames.size(); ++i) {
-    OwningPtr<Module> M(LoadFile(argv[0], InputFilenames[i], Context));
+  std::string ErrorMessage;
+  for (unsigned i = 1; i < Files.size(); ++i) {
+    OwningPtr<Module> M(LoadFile(argv0, Files[i], Context, true, OS));
     if (M.get() == 0) {
-      errs() << argv[0] << ": error loading file '" <<InputFilenames[i]<< "'\n";
-      return 1;
+      OS << argv0 << ": error loading file '" << Files[i] << "'\n";
+      return 0;
     }
 
-    if (Verbose) errs() << "Linking in '" << InputFilenames[i] << "'\n";
+    if (Verbose) OS << "Linking in '" << Files[i] << "'\n";
 
     if (L.linkInModule(M.get(), &ErrorMessage)) {
-      errs() << argv[0] << ": link error in '" << InputFilenames[i]
-             << "': " << ErrorMessage << "\n";
-      return 1;
+      OS << argv0 << ": link error in '" << Files[i] << "': " << ErrorMessage
+         << "\n";
+      return 0;
+    }
+  }
+  return Composite.take();
+}
+
+namespace {
+/// LinkGroup - A share of the inputs, linked in its own context by a single
+/// task and handed back as bitcode.
+struct LinkGroup {
+  const char *argv0;
+  ArrayRef<std::string> Files;
+  std::string Bitcode;
+  std::string Messages;
+  bool Failed;
+
+  LinkGroup() : argv0(0), Failed(false) {}
+};
+
+struct LinkGroupFiles {
+  void operator()(LinkGroup &Group) const {
+    LLVMContext Context;
+    raw_string_ostream OS(Group.Messages);
+    OwningPtr<Module> M(LinkFiles(Group.argv0, Group.Files, Context, OS));
+    if (M.get() == 0) {
+      Group.Failed = true;
+      return;
     }
+    raw_string_ostream BitcodeOS(Group.Bitcode);
+    WriteBitcodeToFile(M.get(), BitcodeOS);
   }
+};
+} // end anonymous namespace
+
+// LinkFilesInParallel - Link the inputs like LinkFiles, but split them into
+// contiguous shares that are linked concurrently in separate contexts.  The
+// linked shares are then read back lazily into Context and linked in order.
+// Definitions are resolved as in a sequential link; only the names given to
+// clashing local symbols and the order of linkonce functions can differ.
+static Module *LinkFilesInParallel(const char *argv0,
+                                   ArrayRef<std::string> Files,
+                                   LLVMContext &Context) {
+  unsigned NumGroups = std::min<size_t>(Files.size(),
+                                        ThreadPool::getDefaultThreadCount());
+  if (NumGroups < 2)
+    return LinkFiles(argv0, Files, Context, errs());
+
+  llvm_start_multithreaded();
+  OwningArrayPtr<LinkGroup> Groups(new LinkGroup[NumGroups]);
+  for (unsigned i = 0; i != NumGroups; ++i) {
+    unsigned Begin = i * Files.size() / NumGroups;
+    unsigned End = (i + 1) * Files.size() / NumGroups;
+    Groups[i].argv0 = argv0;
+    Groups[i].Files = Files.slice(Begin, End - Begin);
+  }
+  parallel_for_each(&Groups[0], &Groups[0] + NumGroups, LinkGroupFiles());
+
+  OwningPtr<Module> Composite;
+  OwningPtr<Linker> L;
+  for (unsigned i = 0; i != NumGroups; ++i) {
+    errs() << Groups[i].Messages;
+    if (Groups[i].Failed)
+      return 0;
+
+    std::string ErrorMessage;
+    MemoryBuffer *Buffer = MemoryBuffer::getMemBuffer(Groups[i].Bitcode,
+                                                      Groups[i].Files[0],
+                                                      false);
+    if (i == 0) {
+      Composite.reset(ParseBitcodeFile(Buffer, Context, &ErrorMessage));
+      delete Buffer;
+      if (Composite.get() == 0) {
+        errs() << argv0 << ": error reading linked inputs: " << ErrorMessage
+               << "\n";
+        return 0;
+      }
+      L.reset(new Linker(Composite.get()));
+      continue;
+    }
+
+    OwningPtr<Module> M(getLazyBitcodeModule(Buffer, Context, &ErrorMessage));
+    if (M.get() == 0) {
+      delete Buffer;
+      errs() << argv0 << ": error reading linked inputs: " << ErrorMessage
+             << "\n";
+      return 0;
+    }
+    if (L->linkInModule(M.get(), &ErrorMessage)) {
+      errs() << argv0 << ": link error in '" << Groups[i].Files[0] << "' or "
+             << "the files after it: " << ErrorMessage << "\n";
+      return 0;
+    }
+  }
+  return Composite.take();
+}
+
+int main(int argc, char **argv) {
+  // Print a stack trace if we signal out.
+  sys::PrintStackTraceOnErrorSignal();
+  PrettyStackTraceProgram X(argc, argv);
+
+  LLVMContext &Context = getGlobalContext();
+  llvm_shutdown_obj Y;  // Call llvm_shutdown() on exit.
+  cl::ParseCommandLineOptions(argc, argv, "llvm linker\n");
+
+  OwningPtr<Module> Composite(
+      Parallel ? LinkFilesInParallel(argv[0], InputFilenames, Context)
+               : LinkFiles(argv[0], InputFilenames, Context, errs()));
+  if (Composite.get() == 0)
+    return 1;
 
   if (DumpAsm) errs() << "Here's the assembly:\n" << *Composite;
 
+  // Bitcode written to a regular file goes through a memory mapping.
   std::string ErrorInfo;
-  tool_output_file Out(OutputFilename.c_str(), ErrorInfo, sys::fs::F_Binary);
+  OwningPtr<tool_output_file> Out;
+  OwningPtr<raw_mmap_ostream> MappedOut;
+  if (!OutputAssembly && raw_mmap_ostream::shouldUse(OutputFilename))
+    MappedOut.reset(new raw_mmap_ostream(OutputFilename, ErrorInfo));
+  else
+    Out.reset(new tool_output_file(OutputFilename.c_str(), ErrorInfo,
+                                   sys::fs::F_Binary));
   if (!ErrorInfo.empty()) {
     errs() << ErrorInfo << '\n';
     return 1;
@@ -118,13 +238,18 @@ int main(int argc, char **argv) {
   }
 
   if (Verbose) errs() << "Writing bitcode...\n";
+  if (MappedOut) {
+    WriteBitcodeToFile(Composite.get(), *MappedOut);
+    MappedOut->keep();
+    return 0;
+  }
   if (OutputAssembly) {
-    Out.os() << *Composite;
-  } else if (Force || !CheckBitcodeOutputToConsole(Out.os(), true))
-    WriteBitcodeToFile(Composite.get(), Out.os());
+    Out->os() << *Composite;
+  } else if (Force || !CheckBitcodeOutputToConsole(Out->os(), true))
+    WriteBitcodeToFile(Composite.get(), Out->os());
 
   // Declare success.
-  Out.keep();
+  Out->keep();
 
   return 0;
 }
@@ -12,16 +12,21 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/StringSet.h"
 #include "llvm/CodeGen/CommandFlags.h"
 #include "llvm/LTO/LTOCodeGenerator.h"
 #include "llvm/LTO/LTOModule.h"
+#include "llvm/LTO/ThinLTOCodeGenerator.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/PrettyStackTrace.h"
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/system_error.h"
 
 using namespace llvm;
 
@@ -37,6 +42,21 @@ static cl::opt<bool>
 DisableGVNLoadPRE("disable-gvn-loadpre", cl::init(false),
   cl::desc("Do not run the GVN load PRE pass"));
 
+static cl::opt<unsigned>
+Partitions("partitions", cl::init(1),
+  cl::desc("Split code generation into this many objects, generated in "
+           "parallel; with -o, object i is written to <filename>.i"));
+
+static cl::opt<bool>
+ThinLTO("thinlto", cl::init(false),
+  cl::desc("Optimize and compile each module separately, importing functions "
+           "from the others; with -o, object i is written to <filename>.i"));
+
+static cl::opt<std::string>
+CacheDir("cache-dir", cl::init(""),
+  cl::desc("Reuse native objects from, and add them to, this directory"),
+  cl::value_desc("directory"));
+
 static cl::list<std::string>
 InputFilenames(cl::Positional, cl::OneOrMore,
   cl::desc("<input bitcode files>"));
@@ -51,11 +71,80 @@ ExportedSymbols("exported-symbol",
   cl::desc("Symbol to export from the resulting object file"),
   cl::ZeroOrMore);
 
+static cl::list<std::string>
+PreemptedSymbols("preempted-symbol",
+  cl::desc("Symbol whose definition comes from outside the input files"),
+  cl::ZeroOrMore);
+
 static cl::list<std::string>
 DSOSymbols("dso-symbol",
   cl::desc("Symbol to put in the symtab in the resulting dso"),
   cl::ZeroOrMore);
 
+/// writeObjects - Move the objects in Names to <OutputFilename>.<i>, or just
+/// report them if no output file was given.
+static bool writeObjects(const char *ProgName, const char **Names,
+                         unsigned Count) {
+  for (unsigned i = 0; i != Count; ++i) {
+    if (OutputFilename.empty()) {
+      outs() << "Wrote native object file '" << Names[i] << "'\n";
+      continue;
+    }
+
+    std::string PartName = OutputFilename + "." + utostr(i);
+    OwningPtr<MemoryBuffer> Obj;
+    if (error_code EC = MemoryBuffer::getFile(Names[i], Obj)) {
+      errs() << ProgName << ": error reading the file '" << Names[i]
+             << "': " << EC.message() << "\n";
+      return false;
+    }
+    std::string ErrorInfo;
+    raw_fd_ostream FileStream(PartName.c_str(), ErrorInfo, sys::fs::F_Binary);
+    if (!ErrorInfo.empty()) {
+      errs() << ProgName << ": error opening the file '" << PartName
+             << "': " << ErrorInfo << "\n";
+      return false;
+    }
+    FileStream.write(Obj->getBufferStart(), Obj->getBufferSize());
+    sys::fs::remove(Names[i]);
+  }
+  return true;
+}
+
+/// runThinLTO - Compile the inputs with ThinLTOCodeGenerator.
+static int runThinLTO(const char *ProgName, const TargetOptions &Options) {
+  ThinLTOCodeGenerator CodeGen;
+  CodeGen.setTargetOptions(Options);
+  CodeGen.setCacheDir(CacheDir.c_str());
+
+  for (unsigned i = 0; i < InputFilenames.size(); ++i) {
+    OwningPtr<MemoryBuffer> Buffer;
+    std::string error;
+    if (error_code EC = MemoryBuffer::getFile(InputFilenames[i], Buffer))
+      error = EC.message();
+    else
+      CodeGen.addModule(InputFilenames[i].c_str(), Buffer->getBufferStart(),
+                        Buffer->getBufferSize(), error);
+    if (!error.empty()) {
+      errs() << ProgName << ": error loading file '" << InputFilenames[i]
+             << "': " << error << "\n";
+      return 1;
+    }
+  }
+
+  for (unsigned i = 0; i < ExportedSymbols.size(); ++i)
+    CodeGen.addMustPreserveSymbol(ExportedSymbols[i].c_str());
+
+  std::string ErrorInfo;
+  const char **Names = NULL;
+  unsigned Count = 0;
+  if (!CodeGen.compile_to_files(&Names, &Count, DisableOpt, ErrorInfo)) {
+    errs() << ProgName << ": error compiling the code: " << ErrorInfo << "\n";
+    return 1;
+  }
+  return writeObjects(ProgName, Names, Count) ? 0 : 1;
+}
+
 namespace {
 struct ModuleInfo {
   std::vector<bool> CanBeHidden;
@@ -98,6 +187,9 @@ int main(int argc, char **argv) {
   Options.EnableSegmentedStacks = SegmentedStacks;
   Options.UseInitArray = UseInitArray;
 
+  if (ThinLTO)
+    return runThinLTO(argv[0], Options);
+
   unsigned BaseArg = 0;
 
   LTOCodeGenerator CodeGen;
@@ -105,6 +197,7 @@ int main(int argc, char **argv) {
   CodeGen.setCodePICModel(LTO_CODEGEN_PIC_MODEL_DYNAMIC);
   CodeGen.setDebugInfo(LTO_DEBUG_MODEL_DWARF);
   CodeGen.setTargetOptions(Options);
+  CodeGen.setCacheDir(CacheDir.c_str());
 
   llvm::StringSet<llvm::MallocAllocator> DSOSymbolsSet;
   for (unsigned i = 0; i < DSOSymbols.size(); ++i)
@@ -149,7 +242,25 @@ int main(int argc, char **argv) {
   for (unsigned i = 0; i < KeptDSOSyms.size(); ++i)
     CodeGen.addMustPreserveSymbol(KeptDSOSyms[i].c_str());
 
-  if (!OutputFilename.empty()) {
+  for (unsigned i = 0; i < PreemptedSymbols.size(); ++i)
+    CodeGen.setSymbolResolution(PreemptedSymbols[i].c_str(),
+                                LTO_SYMBOL_RESOLUTION_PREEMPTED);
+
+  if (Partitions > 1) {
+    std::string ErrorInfo;
+    const char **Names = NULL;
+    unsigned Count = 0;
+    if (!CodeGen.compile_to_files(&Names, &Count, Partitions, DisableOpt,
+                                  DisableInline, DisableGVNLoadPRE,
+                                  ErrorInfo)) {
+      errs() << argv[0]
+             << ": error compiling the code: " << ErrorInfo << "\n";
+      return 1;
+    }
+
+    if (!writeObjects(argv[0], Names, Count))
+      return 1;
+  } else if (!OutputFilename.empty()) {
     size_t len = 0;
     std::string ErrorInfo;
     const void *Code = CodeGen.compile(&len, DisableOpt, DisableInline,
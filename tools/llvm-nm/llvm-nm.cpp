@@ -17,6 +17,8 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/IR/LLVMContext.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/Bitcode/ModuleSummary.h"
 #include "llvm/Bitcode/ReaderWriter.h"
 #include "llvm/IR/Module.h"
 #include "llvm/Object/Archive.h"
@@ -306,6 +308,62 @@ static void DumpSymbolNamesFromModule(Module *M) {
   SortAndPrintSymbolList();
 }
 
+static char TypeCharForSummarySymbol(const BitcodeSummarySymbol &Sym) {
+  typedef BitcodeSummarySymbol BSS;
+  if (!Sym.IsDefinition)                                   return 'U';
+  if (GlobalValue::isLinkOnceLinkage(Sym.Linkage))         return 'C';
+  if (GlobalValue::isCommonLinkage(Sym.Linkage))           return 'C';
+  if (GlobalValue::isWeakLinkage(Sym.Linkage))             return 'W';
+  bool IsInternal = GlobalValue::isInternalLinkage(Sym.Linkage);
+  if (Sym.Kind == BSS::Function && IsInternal)             return 't';
+  if (Sym.Kind == BSS::Function)                           return 'T';
+  if (Sym.Kind == BSS::Variable && IsInternal)             return 'd';
+  if (Sym.Kind == BSS::Variable)                           return 'D';
+  if (Sym.Kind == BSS::Alias) {
+    if (Sym.AliaseeKind == BSS::Function)                  return 'T';
+    if (Sym.AliaseeKind == BSS::Variable)                  return 'D';
+  }
+                                                           return '?';
+}
+
+/// DumpSymbolNamesFromSummary - Like DumpSymbolNamesFromModule, but working
+/// from a bitcode module summary so that no IR has to be read.
+static void DumpSymbolNamesFromSummary(StringRef Filename,
+                                 const std::vector<BitcodeSummarySymbol> &Syms) {
+  typedef BitcodeSummarySymbol BSS;
+  CurrentFilename = Filename;
+
+  // Visit functions, then variables, then aliases, as for a Module.
+  const BSS::SymbolKind Kinds[] = { BSS::Function, BSS::Variable, BSS::Alias };
+  for (unsigned K = 0; K != array_lengthof(Kinds); ++K) {
+    if (Kinds[K] == BSS::Alias && WithoutAliases)
+      continue;
+    for (unsigned i = 0, e = Syms.size(); i != e; ++i) {
+      const BSS &Sym = Syms[i];
+      if (Sym.Kind != Kinds[K])
+        continue;
+      // Private linkage and available_externally linkage don't exist in
+      // symtab.
+      if (GlobalValue::isPrivateLinkage(Sym.Linkage) ||
+          GlobalValue::isLinkerPrivateLinkage(Sym.Linkage) ||
+          GlobalValue::isLinkerPrivateWeakLinkage(Sym.Linkage) ||
+          GlobalValue::isAvailableExternallyLinkage(Sym.Linkage))
+        continue;
+      if (GlobalValue::isLocalLinkage(Sym.Linkage) && ExternalOnly)
+        continue;
+
+      NMSymbol s;
+      s.Address = object::UnknownAddressOrSize;
+      s.Size = object::UnknownAddressOrSize;
+      s.TypeChar = TypeCharForSummarySymbol(Sym);
+      s.Name     = Sym.Name;
+      SymbolList.push_back(s);
+    }
+  }
+
+  SortAndPrintSymbolList();
+}
+
 template <class ELFT>
 error_code getSymbolNMTypeChar(ELFObjectFile<ELFT> &Obj, symbol_iterator I,
                                char &Result) {
@@ -558,13 +616,14 @@ static void DumpSymbolNamesFromObject(ObjectFile *obj) {
 }
 
 static void DumpSymbolNamesFromFile(std::string &Filename) {
-  if (Filename != "-" && !sys::fs::exists(Filename)) {
+  // Opening the file tells us whether it exists; don't stat it separately.
+  OwningPtr<MemoryBuffer> Buffer;
+  error_code EC = MemoryBuffer::getFileOrSTDIN(Filename, Buffer);
+  if (EC == errc::no_such_file_or_directory) {
     errs() << ToolName << ": '" << Filename << "': " << "No such file\n";
     return;
   }
-
-  OwningPtr<MemoryBuffer> Buffer;
-  if (error(MemoryBuffer::getFileOrSTDIN(Filename, Buffer), Filename))
+  if (error(EC, Filename))
     return;
 
   sys::fs::file_magic magic = sys::fs::identify_magic(Buffer->getBuffer());
@@ -572,6 +631,13 @@ static void DumpSymbolNamesFromFile(std::string &Filename) {
   LLVMContext &Context = getGlobalContext();
   std::string ErrorMessage;
   if (magic == sys::fs::file_magic::bitcode) {
+    // If the module carries a summary, there is no need to read the IR.
+    std::vector<BitcodeSummarySymbol> Summary;
+    if (!readBitcodeModuleSummary(Buffer.get(), Summary)) {
+      DumpSymbolNamesFromSummary(Buffer->getBufferIdentifier(), Summary);
+      return;
+    }
+
     Module *Result = 0;
     Result = ParseBitcodeFile(Buffer.get(), Context, &ErrorMessage);
     if (Result) {
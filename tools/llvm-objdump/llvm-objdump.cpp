@@ -672,7 +672,7 @@ static void PrintCOFFSymbolTable(const COFFObjectFile *coff) {
              << "(ty " << format("%3x", unsigned(symbol->Type)) << ")"
              << "(scl " << format("%3x", unsigned(symbol->StorageClass)) << ") "
              << "(nx " << unsigned(symbol->NumberOfAuxSymbols) << ") "
-             << "0x" << format("%08x", unsigned(symbol->Value)) << " "
+             << format_hex(symbol->Value, 10) << " "
              << name << "\n";
       aux_count = symbol->NumberOfAuxSymbols;
     }
@@ -750,7 +750,7 @@ static void PrintSymbolTable(const ObjectFile *o) {
         outs() << SectionName;
       }
       outs() << '\t'
-             << format("%08" PRIx64 " ", Size)
+             << format_hex_no_prefix(Size, 8) << " "
              << Name
              << '\n';
     }
@@ -16,9 +16,11 @@
 
 #include "Error.h"
 #include "StreamWriter.h"
+#include "llvm-readobj.h"
 
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Object/ObjectFile.h"
+#include "llvm/Object/StackMapParser.h"
 #include "llvm/Support/raw_ostream.h"
 
 namespace llvm {
@@ -30,4 +32,53 @@ ObjDumper::ObjDumper(StreamWriter& Writer)
 ObjDumper::~ObjDumper() {
 }
 
+void ObjDumper::printStackMap(const object::ObjectFile *Obj) {
+  StringRef Data;
+  if (error(object::StackMapParser::findStackMapSection(*Obj, Data)))
+    return;
+
+  DictScope D(W, "StackMap");
+  if (Data.empty())
+    return;
+  object::StackMapParser SM;
+  if (error(SM.parse(Data, Obj->isLittleEndian())))
+    return;
+
+  {
+    ListScope L(W, "Constants");
+    for (unsigned i = 0, e = SM.getConstants().size(); i != e; ++i)
+      W.printNumber("Constant", SM.getConstants()[i]);
+  }
+
+  static const char *const KindNames[] = {
+    "", "Register", "Direct", "Indirect", "Constant", "ConstantIndex"
+  };
+  ArrayRef<object::StackMapParser::Record> Records = SM.getRecords();
+  for (unsigned i = 0, e = Records.size(); i != e; ++i) {
+    const object::StackMapParser::Record &R = Records[i];
+    DictScope RS(W, "Record");
+    W.printNumber("ID", R.ID);
+    W.printHex("InstructionOffset", R.InstructionOffset);
+    for (unsigned j = 0, je = R.Locations.size(); j != je; ++j) {
+      const object::StackMapParser::Location &Loc = R.Locations[j];
+      DictScope LS(W, "Location");
+      W.printString("Kind", StringRef(KindNames[Loc.Kind]));
+      W.printNumber("Size", Loc.Size);
+      if (Loc.Kind == object::StackMapParser::Location::Constant ||
+          Loc.Kind == object::StackMapParser::Location::ConstantIndex) {
+        W.printNumber("Value", SM.getConstantValue(Loc));
+        continue;
+      }
+      W.printNumber("DwarfRegNum", Loc.DwarfRegNum);
+      if (Loc.Kind != object::StackMapParser::Location::Register)
+        W.printNumber("Offset", Loc.Offset);
+    }
+    for (unsigned j = 0, je = R.LiveOuts.size(); j != je; ++j) {
+      DictScope LS(W, "LiveOut");
+      W.printNumber("DwarfRegNum", R.LiveOuts[j].DwarfRegNum);
+      W.printNumber("Size", R.LiveOuts[j].Size);
+    }
+  }
+}
+
 } // namespace llvm
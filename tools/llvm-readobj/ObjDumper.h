@@ -40,6 +40,9 @@ public:
   virtual void printNeededLibraries() { }
   virtual void printProgramHeaders() { }
 
+  // Format independent.
+  void printStackMap(const object::ObjectFile *Obj);
+
 protected:
   StreamWriter& W;
 };
@@ -129,6 +129,10 @@ namespace opts {
   cl::opt<bool> ExpandRelocs("expand-relocs",
     cl::desc("Expand each shown relocation to multiple lines"));
 
+  // -stackmap
+  cl::opt<bool> StackMap("stackmap",
+    cl::desc("Display the contents of the stack map section"));
+
   // -codeview-linetables
   cl::opt<bool> CodeViewLineTables("codeview-linetables",
     cl::desc("Display CodeView line table information"));
@@ -230,6 +234,8 @@ static void dumpObject(const ObjectFile *Obj) {
     Dumper->printNeededLibraries();
   if (opts::ProgramHeaders)
     Dumper->printProgramHeaders();
+  if (opts::StackMap)
+    Dumper->printStackMap(Obj);
 }
 
 
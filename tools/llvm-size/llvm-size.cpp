@@ -234,18 +234,14 @@ static void PrintObjectSectionSizes(ObjectFile *o) {
 /// @brief Print the section sizes for @p file. If @p file is an archive, print
 ///        the section sizes for each archive member.
 static void PrintFileSectionSizes(StringRef file) {
-  // If file is not stdin, check that it exists.
-  if (file != "-") {
-    bool exists;
-    if (sys::fs::exists(file, exists) || !exists) {
+  // Attempt to open the binary. Opening it tells us whether it exists, so it
+  // isn't checked separately.
+  OwningPtr<Binary> binary;
+  if (error_code ec = createBinary(file, binary)) {
+    if (ec == errc::no_such_file_or_directory) {
       errs() << ToolName << ": '" << file << "': " << "No such file\n";
       return;
     }
-  }
-
-  // Attempt to open the binary.
-  OwningPtr<Binary> binary;
-  if (error_code ec = createBinary(file, binary)) {
     errs() << ToolName << ": " << file << ": " << ec.message() << ".\n";
     return;
   }
@@ -206,6 +206,8 @@ std::string LLVMSymbolizer::symbolizeData(const std::string &ModuleName,
 
 void LLVMSymbolizer::flush() {
   DeleteContainerSeconds(Modules);
+  ModuleUseOrder.clear();
+  ModuleUsePos.clear();
   DeleteContainerPointers(ParsedBinariesAndObjects);
   BinaryForPath.clear();
   ObjectFileForArch.clear();
@@ -366,8 +368,10 @@ LLVMSymbolizer::getObjectFileFromBinary(Binary *Bin, const std::string &ArchName
 ModuleInfo *
 LLVMSymbolizer::getOrCreateModuleInfo(const std::string &ModuleName) {
   ModuleMapTy::iterator I = Modules.find(ModuleName);
-  if (I != Modules.end())
+  if (I != Modules.end()) {
+    touchModule(ModuleName);
     return I->second;
+  }
   std::string BinaryName = ModuleName;
   std::string ArchName = Opts.DefaultArch;
   size_t ColonPos = ModuleName.find_last_of(':');
@@ -392,9 +396,33 @@ LLVMSymbolizer::getOrCreateModuleInfo(const std::string &ModuleName) {
   assert(Context);
   ModuleInfo *Info = new ModuleInfo(Obj, Context);
   Modules.insert(make_pair(ModuleName, Info));
+  touchModule(ModuleName);
   return Info;
 }
 
+void LLVMSymbolizer::touchModule(const std::string &ModuleName) {
+  if (Opts.MaxCachedModules == 0)
+    return;
+  std::map<std::string, ModuleUseOrderTy::iterator>::iterator Pos =
+      ModuleUsePos.find(ModuleName);
+  if (Pos == ModuleUsePos.end()) {
+    ModuleUseOrder.push_front(ModuleName);
+    ModuleUsePos[ModuleName] = ModuleUseOrder.begin();
+  } else {
+    ModuleUseOrder.splice(ModuleUseOrder.begin(), ModuleUseOrder, Pos->second);
+  }
+  // Dropping a module frees its parsed debug info and symbol tables. The
+  // binary stays mapped so the module can be reopened cheaply.
+  while (ModuleUsePos.size() > Opts.MaxCachedModules) {
+    ModuleMapTy::iterator I = Modules.find(ModuleUseOrder.back());
+    assert(I != Modules.end());
+    delete I->second;
+    Modules.erase(I);
+    ModuleUsePos.erase(ModuleUseOrder.back());
+    ModuleUseOrder.pop_back();
+  }
+}
+
 std::string LLVMSymbolizer::printDILineInfo(DILineInfo LineInfo) const {
   // By default, DILineInfo contains "<invalid>" for function/filename it
   // cannot fetch. We replace it to "??" to make our output closer to addr2line.
@@ -19,6 +19,7 @@
 #include "llvm/Object/MachOUniversal.h"
 #include "llvm/Object/ObjectFile.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include <list>
 #include <map>
 #include <string>
 
@@ -38,12 +39,15 @@ public:
     bool PrintInlining : 1;
     bool Demangle : 1;
     std::string DefaultArch;
+    // Maximum number of modules whose debug info is kept parsed at once, or
+    // 0 for no limit. The least recently used module is dropped first.
+    unsigned MaxCachedModules;
     Options(bool UseSymbolTable = true, bool PrintFunctions = true,
             bool PrintInlining = true, bool Demangle = true,
-            std::string DefaultArch = "")
+            std::string DefaultArch = "", unsigned MaxCachedModules = 0)
         : UseSymbolTable(UseSymbolTable), PrintFunctions(PrintFunctions),
           PrintInlining(PrintInlining), Demangle(Demangle),
-          DefaultArch(DefaultArch) {
+          DefaultArch(DefaultArch), MaxCachedModules(MaxCachedModules) {
     }
   };
 
@@ -64,6 +68,9 @@ private:
   typedef std::pair<Binary*, Binary*> BinaryPair;
 
   ModuleInfo *getOrCreateModuleInfo(const std::string &ModuleName);
+  /// \brief Marks a module as most recently used, and drops the least
+  /// recently used modules if there are more than Opts.MaxCachedModules.
+  void touchModule(const std::string &ModuleName);
   /// \brief Returns pair of pointers to binary and debug binary.
   BinaryPair getOrCreateBinary(const std::string &Path);
   /// \brief Returns a parsed object file for a given architecture in a
@@ -78,6 +85,11 @@ private:
   // Owns module info objects.
   typedef std::map<std::string, ModuleInfo *> ModuleMapTy;
   ModuleMapTy Modules;
+  // Module names, most recently used first, and the position of each name in
+  // that list. Only kept if the number of cached modules is limited.
+  typedef std::list<std::string> ModuleUseOrderTy;
+  ModuleUseOrderTy ModuleUseOrder;
+  std::map<std::string, ModuleUseOrderTy::iterator> ModuleUsePos;
   typedef std::map<std::string, BinaryPair> BinaryMapTy;
   BinaryMapTy BinaryForPath;
   typedef std::map<std::pair<MachOUniversalBinary *, std::string>, ObjectFile *>
@@ -51,6 +51,11 @@ static cl::opt<std::string> ClDefaultArch("default-arch", cl::init(""),
                                           cl::desc("Default architecture "
                                                    "(for multi-arch objects)"));
 
+static cl::opt<unsigned>
+ClMaxCachedModules("max-cached-modules", cl::init(0),
+                   cl::desc("Maximum number of modules to keep debug info "
+                            "for at once (0 for no limit)"));
+
 static cl::opt<std::string>
 ClBinaryName("obj", cl::init(""),
              cl::desc("Path to object file to be symbolized (if not provided, "
@@ -113,7 +118,8 @@ int main(int argc, char **argv) {
 
   cl::ParseCommandLineOptions(argc, argv, "llvm-symbolizer\n");
   LLVMSymbolizer::Options Opts(ClUseSymbolTable, ClPrintFunctions,
-                               ClPrintInlining, ClDemangle, ClDefaultArch);
+                               ClPrintInlining, ClDemangle, ClDefaultArch,
+                               ClMaxCachedModules);
   LLVMSymbolizer Symbolizer(Opts);
 
   bool IsData = false;
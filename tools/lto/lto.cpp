@@ -240,6 +240,12 @@ void lto_codegen_set_cpu(lto_code_gen_t cg, const char *cpu) {
   return cg->setCpu(cpu);
 }
 
+/// lto_codegen_set_cache_dir - Sets the directory in which to cache generated
+/// native objects, or disables the cache if dir is NULL or empty.
+void lto_codegen_set_cache_dir(lto_code_gen_t cg, const char *dir) {
+  cg->setCacheDir(dir ? dir : "");
+}
+
 /// lto_codegen_set_assembler_path - Sets the path to the assembler tool.
 void lto_codegen_set_assembler_path(lto_code_gen_t cg, const char *path) {
   // In here only for backwards compatibility. We use MC now.
@@ -260,6 +266,13 @@ void lto_codegen_add_must_preserve_symbol(lto_code_gen_t cg,
   cg->addMustPreserveSymbol(symbol);
 }
 
+/// lto_codegen_set_symbol_resolution - Records how the linker resolved a
+/// symbol defined by the added modules.
+void lto_codegen_set_symbol_resolution(lto_code_gen_t cg, const char *symbol,
+                                       lto_symbol_resolution resolution) {
+  cg->setSymbolResolution(symbol, resolution);
+}
+
 /// lto_codegen_write_merged_modules - Writes a new file at the specified path
 /// that contains the merged contents of all modules added so far. Returns true
 /// on error (check lto_get_error_message() for details).
@@ -298,6 +311,20 @@ bool lto_codegen_compile_to_file(lto_code_gen_t cg, const char **name) {
                               sLastErrorString);
 }
 
+/// lto_codegen_compile_to_files - Generates code for all added modules into at
+/// most parallelism native object files, in parallel. The names of the files
+/// are written to names and their number to count. Returns true on error.
+bool lto_codegen_compile_to_files(lto_code_gen_t cg, unsigned parallelism,
+                                  const char ***names, unsigned *count) {
+  if (!parsedOptions) {
+    cg->parseCodeGenDebugOptions();
+    parsedOptions = true;
+  }
+  return !cg->compile_to_files(names, count, parallelism, DisableOpt,
+                               DisableInline, DisableGVNLoadPRE,
+                               sLastErrorString);
+}
+
 /// lto_codegen_debug_options - Used to pass extra options to the code
 /// generator.
 void lto_codegen_debug_options(lto_code_gen_t cg, const char *opt) {
@@ -42,6 +42,7 @@
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/TargetSelect.h"
 #include "llvm/Support/ToolOutputFile.h"
+#include "llvm/Support/raw_mmap_ostream.h"
 #include "llvm/Target/TargetLibraryInfo.h"
 #include "llvm/Target/TargetMachine.h"
 #include "llvm/Transforms/IPO/PassManagerBuilder.h"
@@ -635,6 +636,7 @@ int main(int argc, char **argv) {
 
   // Figure out what stream we are supposed to write to...
   OwningPtr<tool_output_file> Out;
+  OwningPtr<raw_mmap_ostream> MappedOut;
   if (NoOutput) {
     if (!OutputFilename.empty())
       errs() << "WARNING: The -o (output filename) option is ignored when\n"
@@ -644,9 +646,14 @@ int main(int argc, char **argv) {
     if (OutputFilename.empty())
       OutputFilename = "-";
 
+    // Bitcode written to a regular file goes through a memory mapping.
     std::string ErrorInfo;
-    Out.reset(new tool_output_file(OutputFilename.c_str(), ErrorInfo,
-                                   sys::fs::F_Binary));
+    if (!AnalyzeOnly && !OutputAssembly &&
+        raw_mmap_ostream::shouldUse(OutputFilename))
+      MappedOut.reset(new raw_mmap_ostream(OutputFilename, ErrorInfo));
+    else
+      Out.reset(new tool_output_file(OutputFilename.c_str(), ErrorInfo,
+                                     sys::fs::F_Binary));
     if (!ErrorInfo.empty()) {
       errs() << ErrorInfo << '\n';
       return 1;
@@ -656,7 +663,7 @@ int main(int argc, char **argv) {
   // If the output is set to be emitted to standard out, and standard out is a
   // console, print out a warning message and refuse to do it.  We don't
   // impress anyone by spewing tons of binary goo to a terminal.
-  if (!Force && !NoOutput && !AnalyzeOnly && !OutputAssembly)
+  if (!Force && !NoOutput && !AnalyzeOnly && !OutputAssembly && !MappedOut)
     if (CheckBitcodeOutputToConsole(Out->os(), !Quiet))
       NoOutput = true;
 
@@ -706,7 +713,7 @@ int main(int argc, char **argv) {
 
   if (PrintBreakpoints) {
     // Default to standard output.
-    if (!Out) {
+    if (!Out && !MappedOut) {
       if (OutputFilename.empty())
         OutputFilename = "-";
 
@@ -718,7 +725,10 @@ int main(int argc, char **argv) {
         return 1;
       }
     }
-    Passes.add(new BreakpointPrinter(Out->os()));
+    if (MappedOut)
+      Passes.add(new BreakpointPrinter(*MappedOut));
+    else
+      Passes.add(new BreakpointPrinter(Out->os()));
     NoOutput = true;
   }
 
@@ -848,6 +858,8 @@ int main(int argc, char **argv) {
   if (!NoOutput && !AnalyzeOnly) {
     if (OutputAssembly)
       Passes.add(createPrintModulePass(&Out->os()));
+    else if (MappedOut)
+      Passes.add(createBitcodeWriterPass(*MappedOut));
     else
       Passes.add(createBitcodeWriterPass(Out->os()));
   }
@@ -859,8 +871,12 @@ int main(int argc, char **argv) {
   Passes.run(*M.get());
 
   // Declare success.
-  if (!NoOutput || PrintBreakpoints)
-    Out->keep();
+  if (!NoOutput || PrintBreakpoints) {
+    if (MappedOut)
+      MappedOut->keep();
+    else
+      Out->keep();
+  }
 
   return 0;
 }
@@ -659,4 +659,70 @@ TEST(APIntTest, nearestLogBase2) {
   EXPECT_EQ(A6.nearestLogBase2(), A6.ceilLogBase2());
 }
 
+// Values of up to 128 bits are stored inline; copying, assigning and moving
+// them between each other and heap-allocated values must keep every word.
+TEST(APIntTest, InlineStorage) {
+  const uint64_t Words[] = { 0x0123456789abcdefULL, 0xfedcba9876543210ULL,
+                             0x1122334455667788ULL };
+  APInt A(128, Words);
+  APInt B(A);
+  EXPECT_EQ(A, B);
+  EXPECT_FALSE(B.needsCleanup());
+  EXPECT_EQ(Words[1], B.getRawData()[1]);
+
+  // Assign between inline, heap and single-word values.
+  APInt Wide(192, Words);
+  EXPECT_TRUE(Wide.needsCleanup());
+  B = Wide;
+  EXPECT_EQ(Wide, B);
+  B = A;
+  EXPECT_EQ(A, B);
+  EXPECT_FALSE(B.needsCleanup());
+  B = APInt(32, 7);
+  EXPECT_EQ(7u, B.getZExtValue());
+  B = A;
+  EXPECT_EQ(A, B);
+
+#if LLVM_HAS_RVALUE_REFERENCES
+  APInt Moved(std::move(B));
+  EXPECT_EQ(A, Moved);
+  Wide = std::move(Moved);
+  EXPECT_EQ(A, Wide);
+  EXPECT_FALSE(Wide.needsCleanup());
+#endif
+
+  APInt C = A, D = APInt(128, 42);
+  std::swap(C, D);
+  EXPECT_EQ(42u, C.getZExtValue());
+  EXPECT_EQ(A, D);
+}
+
+TEST(APIntTest, i128_Arithmetic) {
+  APInt Max = APInt::getMaxValue(128);
+  APInt One(128, 1);
+  EXPECT_EQ(0u, (Max + One).getZExtValue());
+  EXPECT_EQ(Max, APInt(128, 0) - One);
+  APInt Two64 = One.shl(64);
+  EXPECT_EQ(64u, Two64.countTrailingZeros());
+  EXPECT_EQ(Two64, APInt(128, ~0ULL) + One);
+  EXPECT_EQ(One.shl(127), (Two64 * Two64.lshr(1)));
+  EXPECT_TRUE(One.ult(Two64));
+  EXPECT_TRUE(Max.slt(One));
+  EXPECT_EQ(APInt(128, 3), (Two64 * APInt(128, 3)).udiv(Two64));
+
+  APInt X = Two64;
+  --X;
+  EXPECT_EQ(APInt(128, ~0ULL), X);
+  ++X;
+  X += Two64;
+  X -= One;
+  X.setBit(127);
+  EXPECT_TRUE(X.isNegative());
+  X.clearBit(127);
+  EXPECT_EQ(Two64 * APInt(128, 2) - One, X);
+  EXPECT_EQ(APInt(64, ~0ULL), X.trunc(64));
+  EXPECT_EQ(APInt(192, 1).shl(128) - APInt(192, 1), Max.zext(192));
+  EXPECT_TRUE(APInt(96, -1ULL, true).sext(128).isAllOnesValue());
+}
+
 }
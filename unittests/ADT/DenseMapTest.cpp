@@ -9,6 +9,7 @@
 
 #include "gtest/gtest.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SwissDenseMap.h"
 #include <map>
 #include <set>
 
@@ -103,6 +104,10 @@ typedef ::testing::Types<DenseMap<uint32_t, uint32_t>,
                          SmallDenseMap<uint32_t, uint32_t>,
                          SmallDenseMap<uint32_t *, uint32_t *>,
                          SmallDenseMap<CtorTester, CtorTester, 4,
+                                       CtorTesterMapInfo>,
+                         SwissDenseMap<uint32_t, uint32_t>,
+                         SwissDenseMap<uint32_t *, uint32_t *>,
+                         SwissDenseMap<CtorTester, CtorTester,
                                        CtorTesterMapInfo>
                          > DenseMapTestTypes;
 TYPED_TEST_CASE(DenseMapTest, DenseMapTestTypes);
@@ -363,4 +368,75 @@ TEST(DenseMapCustomTest, SmallDenseMapGrowTest) {
   EXPECT_TRUE(map.find(32) == map.end());
 }
 
+// Every key hashes to the same value, so lookups have to probe past full
+// groups of control bytes.
+struct CollidingMapInfo {
+  static inline unsigned getEmptyKey() { return ~0U; }
+  static inline unsigned getTombstoneKey() { return ~0U - 1; }
+  static unsigned getHashValue(const unsigned&) { return 0; }
+  static bool isEqual(const unsigned& LHS, const unsigned& RHS) {
+    return LHS == RHS;
+  }
+};
+
+TEST(DenseMapCustomTest, SwissDenseMapCollisionTest) {
+  SwissDenseMap<unsigned, unsigned, CollidingMapInfo> map;
+  for (unsigned i = 0; i < 100; ++i)
+    map[i] = i + 1;
+  EXPECT_EQ(100u, map.size());
+  for (unsigned i = 0; i < 100; ++i)
+    EXPECT_EQ(i + 1, map.lookup(i));
+  EXPECT_TRUE(map.find(100) == map.end());
+
+  for (unsigned i = 0; i < 100; i += 2)
+    EXPECT_TRUE(map.erase(i));
+  for (unsigned i = 0; i < 100; ++i)
+    EXPECT_EQ(i % 2 == 1, map.count(i));
+}
+
+// Inserting and erasing keys keeps a map of constant size full of deleted
+// buckets, which must be reclaimed without growing the table forever.
+TEST(DenseMapCustomTest, SwissDenseMapChurnTest) {
+  SwissDenseMap<unsigned, unsigned> map;
+  for (unsigned i = 0; i < 10000; ++i) {
+    map[i] = i;
+    if (i >= 8)
+      EXPECT_TRUE(map.erase(i - 8));
+  }
+  EXPECT_EQ(8u, map.size());
+  EXPECT_TRUE(map.getMemorySize() < 1024 * sizeof(std::pair<unsigned,
+                                                            unsigned>));
+  EXPECT_TRUE(map.find(0) == map.end());
+  EXPECT_EQ(9999u, map.lookup(9999));
+}
+
+// Compare a SwissDenseMap against std::map over a mix of operations.
+TEST(DenseMapCustomTest, SwissDenseMapRandomTest) {
+  SwissDenseMap<unsigned, unsigned> map;
+  std::map<unsigned, unsigned> ref;
+  unsigned Seed = 1;
+  for (unsigned i = 0; i < 20000; ++i) {
+    Seed = Seed * 1103515245 + 12345;
+    unsigned Key = (Seed >> 8) % 2048;
+    if (Seed & 0x10000) {
+      map[Key] = i;
+      ref[Key] = i;
+    } else {
+      EXPECT_EQ(ref.erase(Key) != 0, map.erase(Key));
+    }
+  }
+
+  EXPECT_EQ(ref.size(), map.size());
+  for (std::map<unsigned, unsigned>::iterator I = ref.begin(), E = ref.end();
+       I != E; ++I)
+    EXPECT_EQ(I->second, map.lookup(I->first));
+  unsigned Visited = 0;
+  for (SwissDenseMap<unsigned, unsigned>::iterator I = map.begin(),
+       E = map.end(); I != E; ++I) {
+    EXPECT_EQ(ref[I->first], I->second);
+    ++Visited;
+  }
+  EXPECT_EQ(ref.size(), Visited);
+}
+
 }
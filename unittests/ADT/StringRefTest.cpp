@@ -323,6 +323,31 @@ TEST(StringRefTest, Find) {
   EXPECT_EQ(StringRef::npos, Str.find_last_not_of("helo"));
 }
 
+// Check the vectorized search at every alignment against std::string.
+TEST(StringRefTest, FindLong) {
+  std::string Haystack;
+  for (unsigned i = 0; i != 200; ++i)
+    Haystack += char('a' + (i * 7) % 5);
+  const char *Needles[] = { "ab", "aca", "cbedbe", "zz", "eadcbeadcbeadcbeadcb",
+                            "eadcbeadcbeadcbeadcbx" };
+  for (unsigned n = 0; n != array_lengthof(Needles); ++n) {
+    for (unsigned From = 0; From != 40; ++From) {
+      std::string::size_type Expected = Haystack.find(Needles[n], From);
+      size_t Found = StringRef(Haystack).find(Needles[n], From);
+      if (Expected == std::string::npos)
+        EXPECT_EQ(StringRef::npos, Found);
+      else
+        EXPECT_EQ(Expected, Found);
+    }
+  }
+  std::string Tail = Haystack + "xyzzy";
+  for (unsigned Start = 0; Start != 20; ++Start)
+    EXPECT_EQ(Tail.size() - 5 - Start,
+              StringRef(Tail).substr(Start).find("xyzzy"));
+  EXPECT_EQ(StringRef::npos, StringRef(Tail).find("xyzzy", 300));
+  EXPECT_EQ(Tail.size() - 1, StringRef(Tail).find('y', Tail.size() - 2));
+}
+
 TEST(StringRefTest, Count) {
   StringRef Str("hello");
   EXPECT_EQ(2U, Str.count('l'));
@@ -0,0 +1,138 @@
+//===- AliasAnalysisTest.cpp - AliasAnalysis tests ------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Analysis/AliasAnalysis.h"
+#include "llvm/ADT/OwningPtr.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/Analysis/Passes.h"
+#include "llvm/Assembly/Parser.h"
+#include "llvm/IR/DataLayout.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/ValueSymbolTable.h"
+#include "llvm/InitializePasses.h"
+#include "llvm/Pass.h"
+#include "llvm/PassManager.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/SourceMgr.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+
+namespace {
+
+static char ID;
+
+// Checks aliasMany against one alias query per location, and against the
+// answers expected for the locations of @test.
+class AliasManyTestPass : public FunctionPass {
+public:
+  AliasManyTestPass() : FunctionPass(ID) {}
+
+  static int initialize() {
+    PassInfo *PI = new PassInfo("aliasMany testing pass", "", &ID, 0, true,
+                                true);
+    PassRegistry::getPassRegistry()->registerPass(*PI, false);
+    initializeAnalysis(*PassRegistry::getPassRegistry());
+    initializeTarget(*PassRegistry::getPassRegistry());
+    return 0;
+  }
+
+  void getAnalysisUsage(AnalysisUsage &AU) const {
+    AU.setPreservesAll();
+    AU.addRequired<AliasAnalysis>();
+  }
+
+  Value *get(Function &F, StringRef Name) {
+    Value *V = F.getValueSymbolTable().lookup(Name);
+    if (V == NULL)
+      report_fatal_error("@test is missing a value");
+    return V;
+  }
+
+  bool runOnFunction(Function &F) {
+    typedef AliasAnalysis::Location Location;
+    AliasAnalysis &AA = getAnalysis<AliasAnalysis>();
+
+    Location LocA(get(F, "a1"), 4);
+    Location LocBs[] = {
+      Location(get(F, "a0"), 4),
+      // Same base and offset as %a1, different pointer.
+      Location(get(F, "a1.cast"), 4),
+      // Same base, offset and pointer as the first location, but larger.
+      Location(get(F, "a0"), 8),
+      Location(get(F, "a0"), 4),
+      Location(get(F, "ai"), 4),
+      // A different identified object.
+      Location(get(F, "b0"), 4)
+    };
+    AliasAnalysis::AliasResult Expected[] = {
+      AliasAnalysis::NoAlias,
+      AliasAnalysis::MustAlias,
+      AliasAnalysis::PartialAlias,
+      AliasAnalysis::NoAlias,
+      AliasAnalysis::MayAlias,
+      AliasAnalysis::NoAlias
+    };
+
+    SmallVector<AliasAnalysis::AliasResult, 8> Results;
+    AA.aliasMany(LocA, LocBs, Results);
+    EXPECT_EQ(array_lengthof(LocBs), Results.size());
+    for (unsigned i = 0, e = Results.size(); i != e; ++i) {
+      EXPECT_EQ(Expected[i], Results[i]) << "location " << i;
+      EXPECT_EQ(AA.alias(LocA, LocBs[i]), Results[i]) << "location " << i;
+    }
+    return false;
+  }
+};
+
+TEST(AliasAnalysisTest, AliasMany) {
+  static int initialize = AliasManyTestPass::initialize();
+  (void)initialize;
+
+  const char *Assembly =
+      "target datalayout = \"e-p:64:64:64-i32:32:32-i64:64:64\"\n"
+      "define void @test(i64 %i) {\n"
+      "  %a = alloca [4 x i32]\n"
+      "  %b = alloca [4 x i32]\n"
+      "  %a0 = getelementptr [4 x i32]* %a, i64 0, i64 0\n"
+      "  %a1 = getelementptr [4 x i32]* %a, i64 0, i64 1\n"
+      "  %a1.i8 = bitcast [4 x i32]* %a to i8*\n"
+      "  %a1.gep = getelementptr i8* %a1.i8, i64 4\n"
+      "  %a1.cast = bitcast i8* %a1.gep to i32*\n"
+      "  %ai = getelementptr [4 x i32]* %a, i64 0, i64 %i\n"
+      "  %b0 = getelementptr [4 x i32]* %b, i64 0, i64 0\n"
+      "  store i32 0, i32* %a0\n"
+      "  store i32 0, i32* %a1\n"
+      "  store i32 0, i32* %a1.cast\n"
+      "  store i32 0, i32* %ai\n"
+      "  store i32 0, i32* %b0\n"
+      "  ret void\n"
+      "}\n";
+
+  OwningPtr<Module> M(new Module("Module", getGlobalContext()));
+  SMDiagnostic Error;
+  if (ParseAssemblyString(Assembly, M.get(), Error, M->getContext()) !=
+      M.get()) {
+    std::string ErrMsg;
+    raw_string_ostream OS(ErrMsg);
+    Error.print("", OS);
+    // A failure here means that the test itself is buggy.
+    report_fatal_error(OS.str().c_str());
+  }
+
+  PassManager PM;
+  PM.add(new DataLayout(M.get()));
+  PM.add(createBasicAliasAnalysisPass());
+  PM.add(new AliasManyTestPass());
+  PM.run(*M);
+}
+
+} // end anonymous namespace
@@ -0,0 +1,122 @@
+//===- llvm/unittest/AsmParser/AsmParserTest.cpp - .ll parser tests -------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Assembly/Parser.h"
+#include "llvm/ADT/OwningPtr.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/SourceMgr.h"
+#include "gtest/gtest.h"
+#include <string>
+#include <vector>
+using namespace llvm;
+
+namespace {
+
+/// RecordingListener - Remember each reported function, along with how many
+/// functions the module contained when it was reported.
+class RecordingListener : public ParsedFunctionListener {
+public:
+  std::vector<std::string> Names;
+  std::vector<unsigned> ModuleSizes;
+  std::vector<bool> NoUnwind;
+
+  virtual void functionParsed(Function &F) LLVM_OVERRIDE {
+    Names.push_back(F.getName());
+    ModuleSizes.push_back(F.getParent()->size());
+    NoUnwind.push_back(F.hasFnAttribute(Attribute::NoUnwind));
+  }
+};
+
+Module *parse(const char *Assembly, LLVMContext &C,
+              ParsedFunctionListener &Listener) {
+  SMDiagnostic Err;
+  MemoryBuffer *Buffer = MemoryBuffer::getMemBuffer(Assembly, "<string>");
+  return ParseAssembly(Buffer, 0, Err, C, &Listener);
+}
+
+TEST(AsmParserTest, ReportsFunctionsIncrementally) {
+  LLVMContext C;
+  RecordingListener Listener;
+  OwningPtr<Module> M(parse("define void @a() {\n"
+                            "  ret void\n"
+                            "}\n"
+                            "define void @b() {\n"
+                            "  call void @a()\n"
+                            "  ret void\n"
+                            "}\n"
+                            "define void @c() {\n"
+                            "  call void @d()\n"
+                            "  ret void\n"
+                            "}\n"
+                            "define void @d() {\n"
+                            "  ret void\n"
+                            "}\n", C, Listener));
+  ASSERT_TRUE(M.get() != 0);
+
+  ASSERT_EQ(4u, Listener.Names.size());
+  EXPECT_EQ("a", Listener.Names[0]);
+  EXPECT_EQ(1u, Listener.ModuleSizes[0]);
+  EXPECT_EQ("b", Listener.Names[1]);
+  EXPECT_EQ(2u, Listener.ModuleSizes[1]);
+  // @c refers to @d, so it has to wait until @d is defined.
+  EXPECT_EQ("c", Listener.Names[2]);
+  EXPECT_EQ(4u, Listener.ModuleSizes[2]);
+  EXPECT_EQ("d", Listener.Names[3]);
+  EXPECT_EQ(4u, Listener.ModuleSizes[3]);
+}
+
+TEST(AsmParserTest, ReportsFunctionsWithAttributeGroups) {
+  LLVMContext C;
+  RecordingListener Before;
+  OwningPtr<Module> M1(parse("attributes #0 = { nounwind }\n"
+                             "define void @a() #0 {\n"
+                             "  ret void\n"
+                             "}\n"
+                             "define void @b() #0 {\n"
+                             "  ret void\n"
+                             "}\n", C, Before));
+  ASSERT_TRUE(M1.get() != 0);
+  ASSERT_EQ(2u, Before.Names.size());
+  EXPECT_EQ(1u, Before.ModuleSizes[0]);
+  EXPECT_TRUE(Before.NoUnwind[0]);
+  EXPECT_EQ(2u, Before.ModuleSizes[1]);
+  EXPECT_TRUE(Before.NoUnwind[1]);
+
+  // Groups defined after their users hold the functions back to the end.
+  RecordingListener After;
+  OwningPtr<Module> M2(parse("define void @a() #0 {\n"
+                             "  ret void\n"
+                             "}\n"
+                             "define void @b() {\n"
+                             "  ret void\n"
+                             "}\n"
+                             "attributes #0 = { nounwind }\n", C, After));
+  ASSERT_TRUE(M2.get() != 0);
+  ASSERT_EQ(2u, After.Names.size());
+  EXPECT_EQ(2u, After.ModuleSizes[0]);
+  EXPECT_TRUE(After.NoUnwind[0]);
+  EXPECT_EQ(2u, After.ModuleSizes[1]);
+  EXPECT_FALSE(After.NoUnwind[1]);
+}
+
+TEST(AsmParserTest, NoReportsOnError) {
+  LLVMContext C;
+  RecordingListener Listener;
+  OwningPtr<Module> M(parse("define void @a() {\n"
+                            "  call void @missing()\n"
+                            "  ret void\n"
+                            "}\n", C, Listener));
+  EXPECT_TRUE(M.get() == 0);
+  EXPECT_TRUE(Listener.Names.empty());
+}
+
+} // end anonymous namespace
@@ -117,6 +117,44 @@ TEST(MCJITMemoryManagerTest, ManyAllocations) {
   EXPECT_FALSE(MemMgr->finalizeMemory(&Error));
 }
 
+TEST(MCJITMemoryManagerTest, SlabAllocations) {
+  const uintptr_t SlabSize = 0x100000;
+  OwningPtr<SectionMemoryManager> MemMgr(new SectionMemoryManager(SlabSize));
+
+  // Small sections should all be carved out of the first slab.
+  uint8_t *First = MemMgr->allocateCodeSection(256, 0, 0, "");
+  EXPECT_NE((uint8_t*)0, First);
+  for (unsigned i = 1; i < 100; ++i) {
+    uint8_t *Code = MemMgr->allocateCodeSection(256, 0, i, "");
+    EXPECT_NE((uint8_t*)0, Code);
+    EXPECT_TRUE(Code > First && Code + 256 <= First + SlabSize);
+  }
+
+  std::string Error;
+  EXPECT_FALSE(MemMgr->finalizeMemory(&Error));
+
+  // After finalization new code still comes from the first slab, from the
+  // pages past the protected ones, which are still writable.
+  uint8_t *Later = MemMgr->allocateCodeSection(256, 0, 100, "");
+  EXPECT_NE((uint8_t*)0, Later);
+  EXPECT_TRUE(Later >= First + 100 * 256 && Later + 256 <= First + SlabSize);
+  Later[0] = 1;
+  EXPECT_FALSE(MemMgr->finalizeMemory(&Error));
+
+  // The same holds for read-only data, and read-write data keeps using the
+  // rest of its block without skipping to a new page.
+  uint8_t *ROData = MemMgr->allocateDataSection(256, 0, 101, "", true);
+  uint8_t *RWData = MemMgr->allocateDataSection(256, 0, 102, "", false);
+  EXPECT_FALSE(MemMgr->finalizeMemory(&Error));
+  uint8_t *LaterROData = MemMgr->allocateDataSection(256, 0, 103, "", true);
+  uint8_t *LaterRWData = MemMgr->allocateDataSection(256, 0, 104, "", false);
+  EXPECT_TRUE(LaterROData > ROData && LaterROData + 256 <= ROData + SlabSize);
+  EXPECT_TRUE(LaterRWData > RWData && LaterRWData < RWData + 2 * 256);
+  LaterROData[0] = 1;
+  LaterRWData[0] = 1;
+  EXPECT_FALSE(MemMgr->finalizeMemory(&Error));
+}
+
 TEST(MCJITMemoryManagerTest, ManyVariedAllocations) {
   OwningPtr<SectionMemoryManager> MemMgr(new SectionMemoryManager());
 
@@ -104,6 +104,33 @@ TEST_F(MCJITMultipleModuleTest, two_module_case) {
   checkAdd(ptr);
 }
 
+// Module A { Function FA },
+// Module B { Function FB },
+// execute FB, remove B, then execute FA and the retained FB
+TEST_F(MCJITMultipleModuleTest, two_module_remove_case) {
+  SKIP_UNSUPPORTED_PLATFORM;
+
+  OwningPtr<Module> A, B;
+  Function *FA, *FB;
+  createTwoModuleCase(A, FA, B, FB);
+
+  Module *BPtr = B.get();
+  createJIT(A.take());
+  TheJIT->addModule(B.take());
+
+  uint64_t FBPtr = TheJIT->getFunctionAddress(FB->getName().str());
+  TheJIT->finalizeObject();
+  checkAdd(FBPtr);
+
+  // Removing the module hands it back to us; its code stays usable.
+  EXPECT_TRUE(TheJIT->removeModule(BPtr));
+  B.reset(BPtr);
+  EXPECT_FALSE(TheJIT->removeModule(BPtr));
+
+  checkAdd(TheJIT->getFunctionAddress(FA->getName().str()));
+  checkAdd(FBPtr);
+}
+
 // Module A { Function FA },
 // Module B { Function FB },
 // execute FB then FA
@@ -125,6 +152,29 @@ TEST_F(MCJITMultipleModuleTest, two_module_reverse_case) {
   checkAdd(ptr);
 }
 
+// Module A { Function FA },
+// Module B { Extern FA, Function FB which calls FA },
+// load B, remove it before its relocations are resolved, then execute FB
+TEST_F(MCJITMultipleModuleTest, two_module_remove_unresolved_case) {
+  SKIP_UNSUPPORTED_PLATFORM;
+
+  OwningPtr<Module> A, B;
+  Function *FA, *FB;
+  createTwoModuleExternCase(A, FA, B, FB);
+
+  Module *BPtr = B.get();
+  createJIT(A.take());
+  TheJIT->addModule(B.take());
+
+  TheJIT->generateCodeForModule(BPtr);
+  EXPECT_TRUE(TheJIT->removeModule(BPtr));
+  B.reset(BPtr);
+
+  // Resolving B's relocations still reads its object image.
+  TheJIT->finalizeObject();
+  checkAdd(TheJIT->getFunctionAddress(FB->getName().str()));
+}
+
 // Module A { Function FA },
 // Module B { Extern FA, Function FB which calls FA },
 // execute FB then FA
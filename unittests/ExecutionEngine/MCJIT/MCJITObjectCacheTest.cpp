@@ -11,10 +11,12 @@
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringSet.h"
+#include "llvm/ExecutionEngine/DirectoryObjectCache.h"
 #include "llvm/ExecutionEngine/JIT.h"
 #include "llvm/ExecutionEngine/MCJIT.h"
 #include "llvm/ExecutionEngine/ObjectCache.h"
 #include "llvm/ExecutionEngine/SectionMemoryManager.h"
+#include "llvm/Support/FileSystem.h"
 #include "MCJITTestBase.h"
 #include "gtest/gtest.h"
 
@@ -238,5 +240,45 @@ TEST_F(MCJITObjectCacheTest, VerifyNonLoadFromCache) {
   EXPECT_FALSE(Cache->wereDuplicatesInserted());
 }
 
+
+TEST_F(MCJITObjectCacheTest, VerifyDirectoryCacheReload) {
+  SKIP_UNSUPPORTED_PLATFORM;
+
+  SmallString<128> CacheDir;
+  ASSERT_FALSE(sys::fs::createUniqueDirectory("mcjit-object-cache", CacheDir));
+
+  // Compile this module and let the cache write it out.
+  {
+    DirectoryObjectCache Cache(CacheDir, "test-configuration");
+    createJIT(M.take());
+    TheJIT->setObjectCache(&Cache);
+    compileAndRun();
+    TheJIT.reset();
+  }
+
+  // Build the same IR again under a different module name.  A fresh cache
+  // on the same directory must find the object by content.
+  MM = new SectionMemoryManager;
+  M.reset(createEmptyModule("<reloaded>"));
+  Main = insertMainFunction(M.get(), OriginalRC);
+  {
+    DirectoryObjectCache Cache(CacheDir, "test-configuration");
+    OwningPtr<MemoryBuffer> Obj(Cache.getObject(M.get()));
+    EXPECT_TRUE(0 != Obj.get());
+
+    // A different configuration must not see the object.
+    DirectoryObjectCache OtherCache(CacheDir, "other-configuration");
+    Obj.reset(OtherCache.getObject(M.get()));
+    EXPECT_EQ(0, Obj.get());
+
+    createJIT(M.take());
+    TheJIT->setObjectCache(&Cache);
+    compileAndRun();
+    TheJIT.reset();
+  }
+
+  sys::fs::remove_all(CacheDir.str());
+}
+
 } // Namespace
 
@@ -14,6 +14,7 @@
 
 #include "llvm/ExecutionEngine/MCJIT.h"
 #include "MCJITTestBase.h"
+#include "llvm/Object/StackMapParser.h"
 #include "gtest/gtest.h"
 
 using namespace llvm;
@@ -187,4 +188,42 @@ TEST_F(MCJITTest, multiple_functions) {
 
 #endif /*!defined(__arm__)*/
 
+// Stack maps are only implemented for x86-64.
+#if defined(__x86_64__) || defined(_M_X64)
+
+TEST_F(MCJITTest, stack_map_section) {
+  SKIP_UNSUPPORTED_PLATFORM;
+
+  Module *Mod = M.get();
+  Function *F = startFunction<int32_t(void)>(Mod, "with_stackmap");
+  Value *Args[] = {
+    ConstantInt::get(Type::getInt64Ty(Context), 42), // ID
+    ConstantInt::get(Type::getInt32Ty(Context), 0),  // Shadow bytes
+    ConstantInt::get(Type::getInt64Ty(Context), 7)   // Recorded value
+  };
+  Type *ParamTys[] = { Type::getInt64Ty(Context), Type::getInt32Ty(Context) };
+  Constant *StackMap = Mod->getOrInsertFunction(
+      "llvm.experimental.stackmap",
+      FunctionType::get(Type::getVoidTy(Context), ParamTys, true));
+  Builder.CreateCall(StackMap, Args);
+  endFunctionWithRet(F, ConstantInt::get(Context, APInt(32, 0)));
+
+  createJIT(M.take());
+  EXPECT_TRUE(TheJIT->getStackMapSection(Mod).empty())
+    << "Stack maps reported before the module was compiled";
+  EXPECT_NE(0U, TheJIT->getFunctionAddress("with_stackmap"));
+
+  StringRef Data = TheJIT->getStackMapSection(Mod);
+  ASSERT_FALSE(Data.empty());
+  object::StackMapParser SM;
+  ASSERT_FALSE(SM.parse(Data, true));
+  const object::StackMapParser::Record *R = SM.findRecord(42);
+  ASSERT_TRUE(R != 0);
+  ASSERT_EQ(1U, R->Locations.size());
+  EXPECT_EQ(object::StackMapParser::Location::Constant, R->Locations[0].Kind);
+  EXPECT_EQ(7, SM.getConstantValue(R->Locations[0]));
+}
+
+#endif
+
 }
@@ -0,0 +1,262 @@
+//===- llvm/unittest/IR/CAPITest.cpp - C API tests ------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm-c/Core.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/Analysis/Verifier.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/Metadata.h"
+#include "llvm/IR/Module.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+
+namespace {
+
+// Builds into @f(i32 %a, i32 %b, i1 %c), whose arguments are the first
+// entries of the value table, followed by its blocks %entry, %then and %join.
+class BuildInstructionsTest : public testing::Test {
+protected:
+  enum { ArgA, ArgB, ArgC, Entry, Then, Join, NumFixedValues };
+
+  virtual void SetUp() {
+    Ctx = LLVMContextCreate();
+    M = LLVMModuleCreateWithNameInContext("CAPITest", Ctx);
+    Int32 = LLVMInt32TypeInContext(Ctx);
+    LLVMTypeRef Params[] = { Int32, Int32, LLVMInt1TypeInContext(Ctx) };
+    FnTy = LLVMFunctionType(Int32, Params, 3, false);
+    F = LLVMAddFunction(M, "f", FnTy);
+    B = LLVMCreateBuilderInContext(Ctx);
+
+    for (unsigned i = 0; i != 3; ++i)
+      Values[i] = LLVMGetParam(F, i);
+    const char *BlockNames[] = { "entry", "then", "join" };
+    for (unsigned i = 0; i != 3; ++i) {
+      Blocks[i] = LLVMAppendBasicBlockInContext(Ctx, F, BlockNames[i]);
+      Values[Entry + i] = LLVMBasicBlockAsValue(Blocks[i]);
+    }
+    LLVMPositionBuilderAtEnd(B, Blocks[0]);
+  }
+
+  virtual void TearDown() {
+    LLVMDisposeBuilder(B);
+    LLVMDisposeModule(M);
+    LLVMContextDispose(Ctx);
+  }
+
+  static LLVMInstructionDesc desc(LLVMOpcode Opcode, const unsigned *Ops,
+                                  unsigned NumOps, unsigned Flags = 0,
+                                  LLVMTypeRef Type = 0, int Predicate = 0) {
+    LLVMInstructionDesc D;
+    D.Opcode = Opcode;
+    D.Predicate = Predicate;
+    D.Type = Type;
+    D.Flags = Flags;
+    D.Operands = Ops;
+    D.NumOperands = NumOps;
+    D.Name = 0;
+    return D;
+  }
+
+  // Build Insts after the fixed values and return how many were built.
+  unsigned build(const LLVMInstructionDesc *Insts, unsigned NumInsts) {
+    return LLVMBuildInstructions(B, Insts, NumInsts, Values, NumFixedValues);
+  }
+
+  Value *result(unsigned i) { return unwrap(Values[NumFixedValues + i]); }
+
+  void finishWithRet(unsigned Idx) {
+    LLVMBuildRet(B, Values[Idx]);
+  }
+
+  bool verify() {
+    return !verifyModule(*unwrap(M), ReturnStatusAction);
+  }
+
+  LLVMContextRef Ctx;
+  LLVMModuleRef M;
+  LLVMTypeRef Int32;
+  LLVMTypeRef FnTy;
+  LLVMValueRef F;
+  LLVMBuilderRef B;
+  LLVMBasicBlockRef Blocks[3];
+  LLVMValueRef Values[NumFixedValues + 16];
+};
+
+TEST_F(BuildInstructionsTest, BinaryOperatorFlags) {
+  unsigned AB[] = { ArgA, ArgB };
+  LLVMInstructionDesc Insts[] = {
+    desc(LLVMAdd, AB, 2, LLVMInstNoSignedWrap | LLVMInstNoUnsignedWrap),
+    desc(LLVMSub, AB, 2),
+    desc(LLVMUDiv, AB, 2, LLVMInstExact),
+    desc(LLVMSDiv, AB, 2)
+  };
+  EXPECT_EQ(4u, build(Insts, 4));
+
+  BinaryOperator *Add = cast<BinaryOperator>(result(0));
+  EXPECT_EQ(Instruction::Add, Add->getOpcode());
+  EXPECT_TRUE(Add->hasNoSignedWrap());
+  EXPECT_TRUE(Add->hasNoUnsignedWrap());
+  BinaryOperator *Sub = cast<BinaryOperator>(result(1));
+  EXPECT_FALSE(Sub->hasNoSignedWrap());
+  EXPECT_FALSE(Sub->hasNoUnsignedWrap());
+  EXPECT_TRUE(cast<BinaryOperator>(result(2))->isExact());
+  EXPECT_FALSE(cast<BinaryOperator>(result(3))->isExact());
+
+  finishWithRet(NumFixedValues + 3);
+  LLVMPositionBuilderAtEnd(B, Blocks[1]);
+  LLVMBuildUnreachable(B);
+  LLVMPositionBuilderAtEnd(B, Blocks[2]);
+  LLVMBuildUnreachable(B);
+  EXPECT_TRUE(verify());
+}
+
+TEST_F(BuildInstructionsTest, CompareAndSelect) {
+  unsigned AB[] = { ArgA, ArgB };
+  unsigned Fs[] = { NumFixedValues + 2, NumFixedValues + 2 };
+  unsigned Sel[] = { NumFixedValues, ArgA, ArgB };
+  LLVMInstructionDesc Insts[] = {
+    desc(LLVMICmp, AB, 2, 0, 0, LLVMIntSLT),
+    desc(LLVMSelect, Sel, 3),
+    desc(LLVMSIToFP, AB, 1, 0, LLVMFloatTypeInContext(Ctx)),
+    desc(LLVMFCmp, Fs, 2, 0, 0, LLVMRealUNO)
+  };
+  EXPECT_EQ(4u, build(Insts, 4));
+
+  ICmpInst *ICmp = cast<ICmpInst>(result(0));
+  EXPECT_EQ(CmpInst::ICMP_SLT, ICmp->getPredicate());
+  SelectInst *Select = cast<SelectInst>(result(1));
+  EXPECT_EQ(ICmp, Select->getCondition());
+  EXPECT_EQ(unwrap(Values[ArgA]), Select->getTrueValue());
+  EXPECT_EQ(unwrap(Values[ArgB]), Select->getFalseValue());
+  EXPECT_TRUE(isa<SIToFPInst>(result(2)));
+  EXPECT_EQ(CmpInst::FCMP_UNO, cast<FCmpInst>(result(3))->getPredicate());
+}
+
+TEST_F(BuildInstructionsTest, Memory) {
+  unsigned None[] = { 0 };
+  unsigned StoreOps[] = { ArgA, NumFixedValues };
+  unsigned LoadOps[] = { NumFixedValues };
+  unsigned ArrayOps[] = { ArgB };
+  unsigned GEPOps[] = { NumFixedValues + 3, ArgA };
+  LLVMInstructionDesc Insts[] = {
+    desc(LLVMAlloca, None, 0, 0, Int32),
+    desc(LLVMStore, StoreOps, 2, LLVMInstVolatile),
+    desc(LLVMLoad, LoadOps, 1),
+    desc(LLVMAlloca, ArrayOps, 1, 0, Int32),
+    desc(LLVMGetElementPtr, GEPOps, 2, LLVMInstInBounds),
+    desc(LLVMGetElementPtr, GEPOps, 2)
+  };
+  EXPECT_EQ(6u, build(Insts, 6));
+
+  AllocaInst *Alloca = cast<AllocaInst>(result(0));
+  EXPECT_EQ(unwrap(Int32), Alloca->getAllocatedType());
+  EXPECT_FALSE(Alloca->isArrayAllocation());
+  StoreInst *Store = cast<StoreInst>(result(1));
+  EXPECT_TRUE(Store->isVolatile());
+  EXPECT_EQ(unwrap(Values[ArgA]), Store->getValueOperand());
+  EXPECT_EQ(Alloca, Store->getPointerOperand());
+  LoadInst *Load = cast<LoadInst>(result(2));
+  EXPECT_FALSE(Load->isVolatile());
+  EXPECT_EQ(Alloca, Load->getPointerOperand());
+  AllocaInst *Array = cast<AllocaInst>(result(3));
+  EXPECT_EQ(unwrap(Values[ArgB]), Array->getArraySize());
+  EXPECT_TRUE(cast<GetElementPtrInst>(result(4))->isInBounds());
+  EXPECT_FALSE(cast<GetElementPtrInst>(result(5))->isInBounds());
+}
+
+TEST_F(BuildInstructionsTest, ControlFlowAndCall) {
+  unsigned CondBr[] = { ArgC, Then, Join };
+  LLVMInstructionDesc EntryInsts[] = { desc(LLVMBr, CondBr, 3) };
+  EXPECT_EQ(1u, build(EntryInsts, 1));
+  BranchInst *Br = cast<BranchInst>(result(0));
+  EXPECT_TRUE(Br->isConditional());
+  EXPECT_EQ(unwrap(Blocks[1]), Br->getSuccessor(0));
+  EXPECT_EQ(unwrap(Blocks[2]), Br->getSuccessor(1));
+
+  unsigned Jump[] = { Join };
+  LLVMPositionBuilderAtEnd(B, Blocks[1]);
+  LLVMInstructionDesc ThenInsts[] = { desc(LLVMBr, Jump, 1) };
+  EXPECT_EQ(1u, build(ThenInsts, 1));
+  EXPECT_TRUE(cast<BranchInst>(result(0))->isUnconditional());
+
+  Values[NumFixedValues] = F;
+  unsigned PhiOps[] = { ArgA, Entry, ArgB, Then };
+  unsigned CallOps[] = { NumFixedValues, NumFixedValues + 1, ArgB, ArgC };
+  unsigned RetOps[] = { NumFixedValues + 2 };
+  LLVMPositionBuilderAtEnd(B, Blocks[2]);
+  LLVMInstructionDesc JoinInsts[] = {
+    desc(LLVMPHI, PhiOps, 4, 0, Int32),
+    desc(LLVMCall, CallOps, 4),
+    desc(LLVMRet, RetOps, 1)
+  };
+  EXPECT_EQ(3u, LLVMBuildInstructions(B, JoinInsts, 3, Values,
+                                      NumFixedValues + 1));
+  PHINode *PN = cast<PHINode>(unwrap(Values[NumFixedValues + 1]));
+  EXPECT_EQ(2u, PN->getNumIncomingValues());
+  EXPECT_EQ(unwrap(Values[ArgA]), PN->getIncomingValueForBlock(
+                                      unwrap(Blocks[0])));
+  EXPECT_EQ(unwrap(Values[ArgB]), PN->getIncomingValueForBlock(
+                                      unwrap(Blocks[1])));
+  CallInst *Call = cast<CallInst>(unwrap(Values[NumFixedValues + 2]));
+  EXPECT_EQ(unwrap(F), Call->getCalledValue());
+  EXPECT_EQ(3u, Call->getNumArgOperands());
+  EXPECT_EQ(PN, Call->getArgOperand(0));
+  EXPECT_TRUE(isa<ReturnInst>(unwrap(Values[NumFixedValues + 3])));
+  EXPECT_TRUE(verify());
+
+  LLVMOpcode Opcodes[3];
+  ASSERT_EQ(3u, LLVMCountInstructions(Blocks[2]));
+  LLVMGetInstructionOpcodes(Blocks[2], Opcodes);
+  EXPECT_EQ(LLVMPHI, Opcodes[0]);
+  EXPECT_EQ(LLVMCall, Opcodes[1]);
+  EXPECT_EQ(LLVMRet, Opcodes[2]);
+}
+
+TEST_F(BuildInstructionsTest, Errors) {
+  unsigned AB[] = { ArgA, ArgB };
+  unsigned OutOfRange[] = { ArgA, NumFixedValues + 1 };
+  unsigned NotABlock[] = { ArgA, ArgB };
+  LLVMInstructionDesc Valid = desc(LLVMAdd, AB, 2);
+
+  // Each invalid description stops the batch after the valid one before it.
+  LLVMInstructionDesc Invalid[] = {
+    // No LLVMOpcode has the value 61.
+    desc(LLVMOpcode(61), AB, 2),
+    desc(LLVMSwitch, AB, 2),
+    desc(LLVMAdd, AB, 1),
+    desc(LLVMMul, OutOfRange, 2),
+    desc(LLVMPHI, NotABlock, 2, 0, Int32),
+    desc(LLVMTrunc, AB, 1)
+  };
+  for (unsigned i = 0; i != array_lengthof(Invalid); ++i) {
+    LLVMInstructionDesc Insts[] = { Valid, Invalid[i], Valid };
+    EXPECT_EQ(1u, build(Insts, 3)) << "description " << i;
+  }
+  EXPECT_EQ(array_lengthof(Invalid), LLVMCountInstructions(Blocks[0]));
+}
+
+TEST(CAPITest, GetOperandsOfMDNode) {
+  LLVMContextRef Ctx = LLVMContextCreate();
+  LLVMValueRef Elts[] = {
+    LLVMMDStringInContext(Ctx, "name", 4),
+    LLVMConstInt(LLVMInt32TypeInContext(Ctx), 7, false)
+  };
+  LLVMValueRef Node = LLVMMDNodeInContext(Ctx, Elts, 2);
+
+  ASSERT_EQ(2, LLVMGetNumOperands(Node));
+  LLVMValueRef Operands[2];
+  LLVMGetOperands(Node, Operands);
+  EXPECT_EQ(Elts[0], Operands[0]);
+  EXPECT_EQ(Elts[1], Operands[1]);
+  LLVMContextDispose(Ctx);
+}
+
+} // end anonymous namespace
@@ -256,5 +256,52 @@ TEST(ConstantsTest, AsInstructionsTest) {
 
 #undef CHECK
 
+TEST(ConstantsTest, ExprUniquing) {
+  LLVMContext Context;
+  Module M("ExprUniquing", Context);
+  Type *Int64Ty = Type::getInt64Ty(Context);
+  Constant *G = new GlobalVariable(M, Int64Ty, false,
+                                   GlobalValue::ExternalLinkage, 0, "g");
+  Constant *One = ConstantInt::get(Int64Ty, 1);
+  std::vector<Constant*> V;
+  V.push_back(One);
+
+  Constant *Cast = ConstantExpr::getPtrToInt(G, Int64Ty);
+  EXPECT_EQ(Cast, ConstantExpr::getPtrToInt(G, Int64Ty));
+  Constant *Add = ConstantExpr::getAdd(Cast, One);
+  EXPECT_EQ(Add, ConstantExpr::getAdd(Cast, One));
+  EXPECT_NE(Add, ConstantExpr::getAdd(Cast, One, /*HasNUW=*/true));
+  Constant *GEP = ConstantExpr::getGetElementPtr(G, V);
+  EXPECT_EQ(GEP, ConstantExpr::getGetElementPtr(G, V));
+  V[0] = ConstantInt::get(Int64Ty, 2);
+  EXPECT_NE(GEP, ConstantExpr::getGetElementPtr(G, V));
+  EXPECT_NE(ConstantExpr::getICmp(CmpInst::ICMP_EQ, Cast, One),
+            ConstantExpr::getICmp(CmpInst::ICMP_NE, Cast, One));
+}
+
+TEST(ConstantsTest, RemoveDeadConstantExprs) {
+  LLVMContext Context;
+  Module M("RemoveDeadConstantExprs", Context);
+  Type *Int64Ty = Type::getInt64Ty(Context);
+  Constant *G = new GlobalVariable(M, Int64Ty, false,
+                                   GlobalValue::ExternalLinkage, 0, "g");
+  Constant *One = ConstantInt::get(Int64Ty, 1);
+
+  // The add and the cast it uses are dead; the sub keeps its own cast alive.
+  Constant *Cast = ConstantExpr::getPtrToInt(G, Int64Ty);
+  ConstantExpr::getAdd(Cast, One);
+  Constant *Sub = ConstantExpr::getSub(
+    ConstantExpr::getPtrToInt(G, Type::getInt32Ty(Context)),
+    ConstantInt::get(Type::getInt32Ty(Context), 1));
+  new GlobalVariable(M, Sub->getType(), true, GlobalValue::ExternalLinkage,
+                     Sub, "h");
+
+  EXPECT_EQ(2U, Context.removeDeadConstantExprs());
+  EXPECT_EQ(0U, Context.removeDeadConstantExprs());
+  EXPECT_EQ(Sub, ConstantExpr::getSub(
+    ConstantExpr::getPtrToInt(G, Type::getInt32Ty(Context)),
+    ConstantInt::get(Type::getInt32Ty(Context), 1)));
+}
+
 }  // end anonymous namespace
 }  // end namespace llvm
@@ -222,6 +222,83 @@ namespace llvm {
       Passes.add(P);
       Passes.run(*M);
     }
+
+    void expectMatchesRecalculated(DominatorTreeBase<BasicBlock> &DT,
+                                   Function &F) {
+      DominatorTreeBase<BasicBlock> Fresh(false);
+      Fresh.recalculate(F);
+      EXPECT_FALSE(DT.compare(Fresh));
+    }
+
+    TEST(DominatorTree, IncrementalUpdates) {
+      const char *ModuleString =
+        "define void @f(i1 %x) {\n"
+        "entry:\n"
+        "  br i1 %x, label %a, label %b\n"
+        "a:\n"
+        "  br label %c\n"
+        "b:\n"
+        "  br label %c\n"
+        "c:\n"
+        "  br i1 %x, label %d, label %exit\n"
+        "d:\n"
+        "  br label %c\n"
+        "exit:\n"
+        "  ret void\n"
+        "}\n";
+      SMDiagnostic Err;
+      OwningPtr<Module> M(ParseAssemblyString(ModuleString, NULL, Err,
+                                              getGlobalContext()));
+      ASSERT_TRUE(M.get() != 0);
+      Function *F = M->getFunction("f");
+      Function::iterator FI = F->begin();
+      BasicBlock *Entry = FI++;
+      BasicBlock *A = FI++;
+      BasicBlock *B = FI++;
+      BasicBlock *C = FI++;
+      BasicBlock *D = FI++;
+      Value *X = F->arg_begin();
+
+      DominatorTreeBase<BasicBlock> DT(false);
+      DT.recalculate(*F);
+      EXPECT_EQ(C, DT.getNode(D)->getIDom()->getBlock());
+
+      // Add the edge a->d, which makes entry the immediate dominator of d.
+      A->getTerminator()->eraseFromParent();
+      BranchInst::Create(C, D, X, A);
+      DT.insertEdge(A, D);
+      EXPECT_EQ(Entry, DT.getNode(D)->getIDom()->getBlock());
+      expectMatchesRecalculated(DT, *F);
+
+      // And remove it again.
+      A->getTerminator()->eraseFromParent();
+      BranchInst::Create(C, A);
+      DT.deleteEdge(A, D);
+      EXPECT_EQ(C, DT.getNode(D)->getIDom()->getBlock());
+      expectMatchesRecalculated(DT, *F);
+
+      // Removing a back edge changes nothing.
+      D->getTerminator()->eraseFromParent();
+      new UnreachableInst(getGlobalContext(), D);
+      DT.deleteEdge(D, C);
+      expectMatchesRecalculated(DT, *F);
+
+      // Removing entry->b makes b unreachable and a the idom of c.
+      Entry->getTerminator()->eraseFromParent();
+      BranchInst::Create(A, Entry);
+      DT.deleteEdge(Entry, B);
+      EXPECT_TRUE(DT.getNode(B) == 0);
+      EXPECT_EQ(A, DT.getNode(C)->getIDom()->getBlock());
+      expectMatchesRecalculated(DT, *F);
+
+      // Restoring it brings b back into the tree.
+      Entry->getTerminator()->eraseFromParent();
+      BranchInst::Create(A, B, X, Entry);
+      DT.insertEdge(Entry, B);
+      EXPECT_EQ(Entry, DT.getNode(B)->getIDom()->getBlock());
+      EXPECT_EQ(Entry, DT.getNode(C)->getIDom()->getBlock());
+      expectMatchesRecalculated(DT, *F);
+    }
   }
 }
 
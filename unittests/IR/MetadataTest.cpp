@@ -127,6 +127,30 @@ TEST_F(MDNodeTest, Delete) {
   delete I;
 }
 
+TEST_F(MDNodeTest, ReplaceOperand) {
+  MDString *a = MDString::get(Context, "a");
+  MDString *b = MDString::get(Context, "b");
+  MDString *c = MDString::get(Context, "c");
+  Value *AB[] = { a, b };
+  Value *AC[] = { a, c };
+  Value *CB[] = { c, b };
+  MDNode *n1 = MDNode::get(Context, AB);
+  MDNode *n2 = MDNode::get(Context, AC);
+
+  // Changing an operand moves the node to its new operands in the uniquing
+  // table.
+  n1->replaceOperandWith(0, c);
+  EXPECT_EQ(n1, MDNode::getIfExists(Context, CB));
+  EXPECT_EQ((Value*)0, MDNode::getIfExists(Context, AB));
+
+  // A node that becomes a duplicate is replaced by the existing node.
+  WeakVH wvh = n2;
+  n2->replaceOperandWith(0, c);
+  n2->replaceOperandWith(1, b);
+  EXPECT_EQ(n1, wvh);
+  EXPECT_EQ(n1, MDNode::get(Context, CB));
+}
+
 TEST(NamedMDNodeTest, Search) {
   LLVMContext Context;
   Constant *C = ConstantInt::get(Type::getInt32Ty(Context), 1);
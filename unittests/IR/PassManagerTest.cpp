@@ -13,6 +13,7 @@
 #include "llvm/IR/Module.h"
 #include "llvm/IR/PassManager.h"
 #include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/raw_ostream.h"
 #include "gtest/gtest.h"
 
 using namespace llvm;
@@ -115,6 +116,8 @@ struct TestFunctionPass {
         AnalyzedFunctionCount(AnalyzedFunctionCount),
         OnlyUseCachedResults(OnlyUseCachedResults) {}
 
+  static StringRef name() { return "TestFunctionPass"; }
+
   PreservedAnalyses run(Function *F, FunctionAnalysisManager *AM) {
     ++RunCount;
 
@@ -282,4 +285,73 @@ TEST_F(PassManagerTest, Basic) {
 
   EXPECT_EQ(1, ModuleAnalysisRuns);
 }
+
+TEST_F(PassManagerTest, Instrumentation) {
+  PassInstrumentation PI;
+
+  FunctionAnalysisManager FAM;
+  int FunctionAnalysisRuns = 0;
+  FAM.registerPass(TestFunctionAnalysis(FunctionAnalysisRuns));
+  FAM.setInstrumentation(&PI);
+
+  ModuleAnalysisManager MAM;
+  int ModuleAnalysisRuns = 0;
+  MAM.registerPass(TestModuleAnalysis(ModuleAnalysisRuns));
+  MAM.registerPass(FunctionAnalysisManagerModuleProxy(FAM));
+  FAM.registerPass(ModuleAnalysisManagerFunctionProxy(MAM));
+
+  // Two passes which each query the same two function analyses, so the first
+  // misses and the second hits for every function.
+  FunctionPassManager FPM;
+  int FunctionPassRunCount = 0;
+  int AnalyzedInstrCount = 0;
+  int AnalyzedFunctionCount = 0;
+  FPM.addPass(TestFunctionPass(FunctionPassRunCount, AnalyzedInstrCount,
+                               AnalyzedFunctionCount));
+  FPM.addPass(TestFunctionPass(FunctionPassRunCount, AnalyzedInstrCount,
+                               AnalyzedFunctionCount));
+  FPM.setInstrumentation(&PI);
+
+  ModulePassManager MPM;
+  MPM.addPass(createModuleToFunctionPassAdaptor(FPM));
+  int ModulePassRunCount = 0;
+  MPM.addPass(TestModulePass(ModulePassRunCount));
+  MPM.setInstrumentation(&PI);
+
+  MPM.run(M.get(), &MAM);
+
+  const std::vector<PassInstrumentation::Record> &Records = PI.records();
+  ASSERT_EQ(8u, Records.size());
+
+  static const char *const FunctionNames[] = { "f", "g", "h" };
+  for (unsigned Idx = 0; Idx != 3; ++Idx) {
+    const PassInstrumentation::Record &First = Records[2 * Idx];
+    const PassInstrumentation::Record &Second = Records[2 * Idx + 1];
+    EXPECT_EQ("TestFunctionPass", First.PassName);
+    EXPECT_EQ(FunctionNames[Idx], First.IRName);
+    EXPECT_EQ(1u, First.Depth);
+    EXPECT_EQ(0u, First.AnalysisHits);
+    EXPECT_EQ(2u, First.AnalysisMisses);
+    EXPECT_EQ(FunctionNames[Idx], Second.IRName);
+    EXPECT_EQ(2u, Second.AnalysisHits);
+    EXPECT_EQ(0u, Second.AnalysisMisses);
+  }
+
+  const PassInstrumentation::Record &Adaptor = Records[6];
+  EXPECT_EQ("ModuleToFunctionPassAdaptor", Adaptor.PassName);
+  EXPECT_EQ(0u, Adaptor.Depth);
+  EXPECT_EQ(6u, Adaptor.AnalysisHits);
+  EXPECT_EQ(6u, Adaptor.AnalysisMisses);
+  EXPECT_EQ("<unnamed pass>", Records[7].PassName);
+  EXPECT_EQ(0u, Records[7].AnalysisHits + Records[7].AnalysisMisses);
+
+  std::string JSON;
+  raw_string_ostream OS(JSON);
+  PI.printJSON(OS);
+  OS.flush();
+  EXPECT_EQ(0u, JSON.find("{\"passes\":["));
+  EXPECT_NE(std::string::npos, JSON.find("{\"pass\":\"TestFunctionPass\","
+                                         "\"ir\":\"g\",\"depth\":1,"));
+  EXPECT_NE(std::string::npos, JSON.find("\"pass\":\"<unnamed pass>\""));
+}
 }
@@ -8,11 +8,14 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/Assembly/Parser.h"
+#include "llvm/Assembly/Writer.h"
 #include "llvm/IR/Function.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Module.h"
+#include "llvm/IR/User.h"
 #include "llvm/IR/Value.h"
 #include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/raw_ostream.h"
 #include "gtest/gtest.h"
 using namespace llvm;
 
@@ -43,6 +46,59 @@ TEST(ValueTest, UsedInBasicBlock) {
   EXPECT_TRUE(F->arg_begin()->isUsedInBasicBlock(F->begin()));
 }
 
+TEST(ValueTest, PrintWithModuleSlotTracker) {
+  LLVMContext C;
+
+  const char *ModuleString = "@0 = global i32 0\n"
+                             "define void @f(i32) {\n"
+                             "  %2 = add i32 %0, 1\n"
+                             "  br label %3\n"
+                             "; <label>:3\n"
+                             "  store i32 %2, i32* @0\n"
+                             "  ret void\n"
+                             "}\n"
+                             "define void @g(i32) {\n"
+                             "  %2 = mul i32 %0, 2\n"
+                             "  ret void\n"
+                             "}\n";
+  SMDiagnostic Err;
+  OwningPtr<Module> M(ParseAssemblyString(ModuleString, NULL, Err, C));
+  ASSERT_TRUE(M.get() != 0);
+
+  // Printing through a shared tracker gives the same text as printing each
+  // value on its own, also when moving between functions.
+  ModuleSlotTracker MST(M.get());
+  for (Module::iterator F = M->begin(), FE = M->end(); F != FE; ++F)
+    for (Function::iterator BB = F->begin(), BE = F->end(); BB != BE; ++BB) {
+      std::string Expected, Actual;
+      raw_string_ostream ExpectedOS(Expected), ActualOS(Actual);
+      BB->print(ExpectedOS);
+      BB->print(ActualOS, MST);
+      EXPECT_EQ(ExpectedOS.str(), ActualOS.str());
+
+      for (BasicBlock::iterator I = BB->begin(), IE = BB->end(); I != IE;
+           ++I) {
+        std::string Expected, Actual;
+        raw_string_ostream ExpectedOS(Expected), ActualOS(Actual);
+        I->print(ExpectedOS);
+        I->print(ActualOS, MST);
+        EXPECT_EQ(ExpectedOS.str(), ActualOS.str());
+      }
+    }
+
+  std::string Global;
+  raw_string_ostream GlobalOS(Global);
+  M->global_begin()->print(GlobalOS, MST);
+  EXPECT_EQ("@0 = global i32 0", GlobalOS.str());
+}
+
+TEST(ValueTest, UserLayout) {
+  // The operand count lives in Value, so a User only adds its operand list
+  // pointer.  This keeps every instruction and constant a word smaller on
+  // 64-bit hosts.
+  EXPECT_EQ(sizeof(Value) + sizeof(Use *), sizeof(User));
+}
+
 TEST(GlobalTest, CreateAddressSpace) {
   LLVMContext &Ctx = getGlobalContext();
   OwningPtr<Module> M(new Module("TestModule", Ctx));
@@ -203,3 +203,33 @@ TEST(Option, Slurp) {
   EXPECT_EQ(AL->getAllArgValues(OPT_Slurp)[1], "--");
   EXPECT_EQ(AL->getAllArgValues(OPT_Slurp)[2], "foo");
 }
+
+TEST(Option, LongestNameFirst) {
+  TestOptTable T;
+  unsigned MAI, MAC;
+
+  const char *MyArgs[] = { "-C=foo", "-Joo", "-Jx", "-Bar" };
+  OwningPtr<InputArgList> AL(T.ParseArgs(MyArgs, array_endof(MyArgs), MAI, MAC));
+  EXPECT_EQ(AL->size(), 4U);
+  EXPECT_EQ(AL->getLastArgValue(OPT_C), "foo");
+  EXPECT_EQ(AL->getAllArgValues(OPT_B).size(), 2U);
+  EXPECT_EQ(AL->getAllArgValues(OPT_B)[0], "bar");
+  EXPECT_EQ(AL->getAllArgValues(OPT_B)[1], "ar");
+  EXPECT_TRUE(AL->hasArg(OPT_UNKNOWN));
+}
+
+TEST(Option, DashDash) {
+  TestOptTable T;
+  unsigned MAI, MAC;
+
+  const char *MyArgs[] = { "-A", "--", "-B", "--" };
+  OwningPtr<InputArgList> AL(T.ParseArgs(MyArgs, array_endof(MyArgs), MAI, MAC));
+  EXPECT_EQ(AL->size(), 2U);
+  EXPECT_TRUE(AL->hasArg(OPT_A));
+  EXPECT_FALSE(AL->hasArg(OPT_B));
+  EXPECT_FALSE(AL->hasArg(OPT_UNKNOWN));
+  EXPECT_TRUE(AL->hasArg(OPT_DashDash));
+  EXPECT_EQ(AL->getAllArgValues(OPT_DashDash).size(), 2U);
+  EXPECT_EQ(AL->getAllArgValues(OPT_DashDash)[0], "-B");
+  EXPECT_EQ(AL->getAllArgValues(OPT_DashDash)[1], "--");
+}
@@ -81,6 +81,34 @@ TEST(CommandLineTest, ModifyExisitingOption) {
   ASSERT_EQ(cl::Hidden, TestOption.getOptionHiddenFlag()) <<
     "Failed to modify option's hidden flag.";
 }
+
+cl::opt<bool> LookupFlag("lookup-flag");
+cl::opt<std::string> LookupValue("lookup-value");
+cl::opt<std::string> LookupPrefix("lookup-prefix-", cl::Prefix);
+cl::opt<bool> LookupGroupA("A", cl::Grouping);
+cl::opt<bool> LookupGroupB("B", cl::Grouping);
+cl::list<int> LookupList("lookup-list", cl::ZeroOrMore);
+TEST(CommandLineTest, LookupOptions) {
+  // A few options are found without mapping every option name.
+  const char *ShortArgs[] = { "prog", "-lookup-flag", "--lookup-value=x" };
+  cl::ParseCommandLineOptions(array_lengthof(ShortArgs), ShortArgs);
+  EXPECT_TRUE(LookupFlag);
+  EXPECT_EQ("x", LookupValue);
+
+  // Enough lookups for the map to be built part way through.
+  const char *LongArgs[] = {
+    "prog", "-lookup-prefix-y", "-AB", "-lookup-list=1", "-lookup-list=2",
+    "-lookup-list=3", "-lookup-list=4", "-lookup-list=5", "-lookup-list=6",
+    "-lookup-list=7", "-lookup-list=8", "-lookup-list=9", "-lookup-list=10"
+  };
+  cl::ParseCommandLineOptions(array_lengthof(LongArgs), LongArgs);
+  EXPECT_EQ("y", LookupPrefix);
+  EXPECT_TRUE(LookupGroupA);
+  EXPECT_TRUE(LookupGroupB);
+  ASSERT_EQ(10u, LookupList.size());
+  EXPECT_EQ(10, LookupList[9]);
+}
+
 #ifndef SKIP_ENVIRONMENT_TESTS
 
 const char test_env_var[] = "LLVM_TEST_COMMAND_LINE_FLAGS";
@@ -0,0 +1,77 @@
+//===- llvm/unittest/Support/DataStreamTest.cpp - DataStreamer tests ------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/DataStream.h"
+#include "llvm/ADT/OwningPtr.h"
+#include "llvm/Support/StreamableMemoryObject.h"
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <vector>
+
+using namespace llvm;
+
+namespace {
+
+// Streams the bytes 0, 1, 2, ... (mod 251) in short reads of varying size,
+// like a pipe or a socket would.
+class CountingStreamer : public DataStreamer {
+  size_t Pos, End;
+public:
+  explicit CountingStreamer(size_t End) : Pos(0), End(End) {}
+  virtual size_t GetBytes(unsigned char *buf, size_t len) {
+    size_t N = std::min(std::min(len, End - Pos), Pos % 1000 + 1);
+    for (size_t i = 0; i != N; ++i)
+      buf[i] = (unsigned char)((Pos + i) % 251);
+    Pos += N;
+    return N;
+  }
+};
+
+TEST(DataStreamTest, ReadAheadReturnsAllBytes) {
+  const size_t Total = 100000;
+  // A buffer smaller than the data, and not a multiple of the request size.
+  OwningPtr<DataStreamer> S(
+      getReadAheadDataStreamer(new CountingStreamer(Total), 4099));
+
+  std::vector<unsigned char> Buf(3000);
+  size_t Pos = 0;
+  for (;;) {
+    size_t N = S->GetBytes(&Buf[0], Buf.size());
+    for (size_t i = 0; i != N; ++i)
+      ASSERT_EQ((Pos + i) % 251, Buf[i]);
+    Pos += N;
+    if (N < Buf.size())
+      break;
+  }
+  EXPECT_EQ(Total, Pos);
+  EXPECT_EQ(0u, S->GetBytes(&Buf[0], Buf.size()));
+}
+
+TEST(DataStreamTest, ReadAheadStreamingMemoryObject) {
+  // StreamingMemoryObject takes a short read for the end of the stream.
+  const size_t Total = 50000;
+  StreamingMemoryObject Obj(
+      getReadAheadDataStreamer(new CountingStreamer(Total), 1000));
+  EXPECT_TRUE(Obj.isValidAddress(Total - 1));
+  EXPECT_FALSE(Obj.isValidAddress(Total));
+  uint8_t Byte;
+  EXPECT_EQ(0, Obj.readByte(Total - 1, &Byte));
+  EXPECT_EQ((Total - 1) % 251, Byte);
+}
+
+TEST(DataStreamTest, ReadAheadDestroyedEarly) {
+  // Destroying the streamer stops its reader while the buffer is full.
+  OwningPtr<DataStreamer> S(
+      getReadAheadDataStreamer(new CountingStreamer(1 << 20), 100));
+  unsigned char Buf[10];
+  EXPECT_EQ(10u, S->GetBytes(Buf, 10));
+  EXPECT_EQ(9u, Buf[9]);
+}
+
+}
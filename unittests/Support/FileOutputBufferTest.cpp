@@ -9,9 +9,12 @@
 
 #include "llvm/Support/FileOutputBuffer.h"
 #include "llvm/ADT/OwningPtr.h"
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/raw_mmap_ostream.h"
 #include "llvm/Support/raw_ostream.h"
 #include "gtest/gtest.h"
 
@@ -113,8 +116,81 @@ TEST(FileOutputBuffer, Test) {
   bool IsExecutable = (Status.permissions() & fs::owner_exe);
   EXPECT_TRUE(IsExecutable);
 
+  // TEST 5: Verify extending the buffer keeps its contents.
+  SmallString<128> File5(TestDirectory);
+  File5.append("/file5");
+  {
+    OwningPtr<FileOutputBuffer> Buffer;
+    ASSERT_NO_ERROR(FileOutputBuffer::create(File5, 8192, Buffer));
+    memcpy(Buffer->getBufferStart(), "AABBCCDDEEFFGGHHIIJJ", 20);
+    ASSERT_NO_ERROR(Buffer->extend(20000));
+    ASSERT_EQ(20000U, Buffer->getBufferSize());
+    memcpy(Buffer->getBufferEnd() - 20, "AABBCCDDEEFFGGHHIIJJ", 20);
+    ASSERT_NO_ERROR(Buffer->commit());
+  }
+  bool MagicMatches5 = false;
+  ASSERT_NO_ERROR(fs::has_magic(Twine(File5), Twine("AABBCCDDEEFFGGHHIIJJ"),
+                                MagicMatches5));
+  EXPECT_TRUE(MagicMatches5);
+  uint64_t File5Size;
+  ASSERT_NO_ERROR(fs::file_size(Twine(File5), File5Size));
+  ASSERT_EQ(File5Size, 20000ULL);
+
   // Clean up.
   uint32_t RemovedCount;
   ASSERT_NO_ERROR(fs::remove_all(TestDirectory.str(), RemovedCount));
 }
+
+TEST(FileOutputBuffer, MappedStream) {
+  SmallString<128> TestDirectory;
+  {
+    ASSERT_NO_ERROR(
+        fs::createUniqueDirectory("FileOutputBuffer-test", TestDirectory));
+  }
+
+  // Write enough, in small and large pieces, for the file to be extended.
+  std::string Expected;
+  std::string Chunk(100000, 'x');
+  SmallString<128> File1(TestDirectory);
+  File1.append("/file1");
+  {
+    std::string ErrorInfo;
+    raw_mmap_ostream OS(File1, ErrorInfo);
+    ASSERT_TRUE(ErrorInfo.empty());
+    for (unsigned i = 0; i != 30; ++i) {
+      for (unsigned j = 0; j != 1000; ++j) {
+        OS << 'a' << j;
+        Expected += 'a';
+        Expected += utostr(j);
+      }
+      OS << Chunk;
+      Expected += Chunk;
+    }
+    EXPECT_EQ(Expected.size(), OS.tell());
+    OS.keep();
+  }
+  OwningPtr<MemoryBuffer> Contents;
+  ASSERT_NO_ERROR(MemoryBuffer::getFile(File1.str(), Contents));
+  EXPECT_EQ(Expected, Contents->getBuffer().str());
+
+  // Verify the file is not created if the stream is not kept.
+  SmallString<128> File2(TestDirectory);
+  File2.append("/file2");
+  {
+    std::string ErrorInfo;
+    raw_mmap_ostream OS(File2, ErrorInfo);
+    ASSERT_TRUE(ErrorInfo.empty());
+    OS << "AABBCCDDEEFFGGHHIIJJ";
+  }
+  bool Exists = false;
+  ASSERT_NO_ERROR(fs::exists(Twine(File2), Exists));
+  EXPECT_FALSE(Exists);
+
+  EXPECT_FALSE(raw_mmap_ostream::shouldUse("-"));
+  EXPECT_TRUE(raw_mmap_ostream::shouldUse(File2));
+  EXPECT_FALSE(raw_mmap_ostream::shouldUse(TestDirectory));
+
+  uint32_t RemovedCount;
+  ASSERT_NO_ERROR(fs::remove_all(TestDirectory.str(), RemovedCount));
+}
 } // anonymous namespace
@@ -11,6 +11,7 @@
 #include "llvm/Support/Process.h"
 #include "gtest/gtest.h"
 #include <cstdlib>
+#include <cstring>
 
 using namespace llvm;
 using namespace sys;
@@ -339,6 +340,28 @@ TEST_P(MappedMemoryTest, UnalignedNear) {
   EXPECT_FALSE(Memory::releaseMappedMemory(M1));
 }
 
+TEST(MemoryTest, PatchCode) {
+  size_t PageSize = process::get_self()->page_size();
+  error_code EC;
+  MemoryBlock M = Memory::allocateMappedMemory(2 * PageSize, 0,
+                                               Memory::MF_READ |
+                                               Memory::MF_WRITE, EC);
+  ASSERT_EQ(error_code::success(), EC);
+  memset(M.base(), 0x90, M.size());
+  EXPECT_FALSE(Memory::protectMappedMemory(M, Memory::MF_READ |
+                                              Memory::MF_EXEC));
+
+  // Patch across the page boundary, which leaves the pages executable.
+  const unsigned char Code[] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+  unsigned char *Addr = (unsigned char *)M.base() + PageSize - 4;
+  EXPECT_FALSE(Memory::patchCode(Addr, Code, sizeof(Code)));
+  EXPECT_EQ(0, memcmp(Addr, Code, sizeof(Code)));
+  EXPECT_EQ(0x90, Addr[-1]);
+  EXPECT_EQ(0x90, Addr[sizeof(Code)]);
+
+  EXPECT_FALSE(Memory::releaseMappedMemory(M));
+}
+
 // Note that Memory::MF_WRITE is not supported exclusively across
 // operating systems and architectures and can imply MF_READ|MF_WRITE
 unsigned MemoryFlags[] = {
@@ -172,3 +172,22 @@ TEST_F(SourceMgrTest, FixitForTab) {
             Output);
 }
 
+
+TEST_F(SourceMgrTest, LineAndColumn) {
+  setMainBuffer("aaa\nbb\n\nc", "file.in");
+  SM.AddNewSourceBuffer(MemoryBuffer::getMemBuffer("x\ny", "other.in"),
+                        SMLoc());
+
+  // Queries in any order, on either buffer, give the same answers.
+  EXPECT_EQ(std::make_pair(4U, 1U), SM.getLineAndColumn(getLoc(8)));
+  EXPECT_EQ(std::make_pair(1U, 1U), SM.getLineAndColumn(getLoc(0)));
+  EXPECT_EQ(std::make_pair(1U, 4U), SM.getLineAndColumn(getLoc(3)));
+  EXPECT_EQ(std::make_pair(3U, 1U), SM.getLineAndColumn(getLoc(7)));
+  EXPECT_EQ(std::make_pair(2U, 2U), SM.getLineAndColumn(getLoc(5)));
+  EXPECT_EQ(std::make_pair(4U, 2U), SM.getLineAndColumn(getLoc(9)));
+
+  const char *Other = SM.getMemoryBuffer(1)->getBufferStart();
+  EXPECT_EQ(std::make_pair(2U, 1U),
+            SM.getLineAndColumn(SMLoc::getFromPointer(Other + 2)));
+  EXPECT_EQ(2U, SM.FindLineNumber(getLoc(4), MainBufferID));
+}
@@ -0,0 +1,77 @@
+//===- unittests/Support/StatisticTest.cpp - Statistic tests --------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "unittest"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
+#include "llvm/Support/raw_ostream.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+
+namespace {
+
+#if !defined(NDEBUG) || defined(LLVM_ENABLE_STATS)
+STATISTIC(Counter, "Counts things");
+STATISTIC(Adder, "Adds things");
+STATISTIC(Named, "Has a name");
+
+TEST(StatisticTest, Count) {
+  Counter = 0;
+  ++Counter;
+  Counter += 5;
+  --Counter;
+  EXPECT_EQ(5u, Counter.getValue());
+  Counter *= 3;
+  EXPECT_EQ(15u, (unsigned)Counter);
+}
+
+void bump(void *) {
+  for (unsigned i = 0; i != 10000; ++i) {
+    ++Counter;
+    Adder += 2;
+  }
+}
+
+// Increments made concurrently on pool threads are all counted.
+TEST(StatisticTest, Threads) {
+  Counter = 0;
+  Adder = 0;
+  llvm_start_multithreaded();
+  {
+    ThreadPool Pool(4);
+    for (unsigned i = 0; i != 4; ++i)
+      Pool.async(bump, 0);
+    Pool.wait();
+    EXPECT_EQ(40000u, Counter.getValue());
+    EXPECT_EQ(80000u, Adder.getValue());
+  }
+
+  ++Counter;
+  Counter = 7;
+  EXPECT_EQ(7u, Counter.getValue());
+  llvm_stop_multithreaded();
+}
+
+TEST(StatisticTest, JSON) {
+  EnableStatistics();
+  Named = 0;
+  Named += 3;
+
+  std::string Output;
+  raw_string_ostream OS(Output);
+  PrintStatisticsJSON(OS);
+  OS.flush();
+  EXPECT_EQ('{', Output[0]);
+  EXPECT_NE(std::string::npos, Output.find("\t\"unittest.Named\": 3"));
+}
+#endif
+
+} // end anonymous namespace
@@ -0,0 +1,169 @@
+//===- llvm/unittest/Support/ThreadLocalAllocatorTest.cpp -----------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/ThreadLocalAllocator.h"
+#include "llvm/Config/config.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+
+namespace {
+
+// A slab is reused for a request it fits if less than half of it would be
+// left unused.
+TEST(ThreadLocalAllocatorTest, RecyclingSlabSizes) {
+  RecyclingSlabAllocator Slabs;
+  MemSlab *Slab = Slabs.Allocate(1000);
+  EXPECT_EQ(1000U, Slab->Size);
+  Slabs.Deallocate(Slab);
+  EXPECT_EQ(1U, Slabs.getNumFreeSlabs());
+
+  // Too small.
+  MemSlab *Bigger = Slabs.Allocate(1001);
+  EXPECT_NE(Slab, Bigger);
+  EXPECT_EQ(1U, Slabs.getNumFreeSlabs());
+  // Exactly half of the slab would be unused.
+  MemSlab *Half = Slabs.Allocate(500);
+  EXPECT_NE(Slab, Half);
+  EXPECT_EQ(1U, Slabs.getNumFreeSlabs());
+  // Just under half of it would be unused.
+  EXPECT_EQ(Slab, Slabs.Allocate(501));
+  EXPECT_EQ(0U, Slabs.getNumFreeSlabs());
+
+  Slabs.Deallocate(Slab);
+  Slabs.Deallocate(Bigger);
+  Slabs.Deallocate(Half);
+  EXPECT_EQ(3U, Slabs.getNumFreeSlabs());
+  Slabs.releaseMemory();
+  EXPECT_EQ(0U, Slabs.getNumFreeSlabs());
+}
+
+// Slabs freed by one bump allocator are handed out to the next.
+TEST(ThreadLocalAllocatorTest, RecyclingSlabs) {
+  RecyclingSlabAllocator Slabs;
+  {
+    BumpPtrAllocator Alloc(4096, 4096, Slabs);
+    Alloc.Allocate(3000, 0);
+    Alloc.Allocate(3000, 0);
+    EXPECT_EQ(2U, Alloc.GetNumSlabs());
+  }
+  EXPECT_EQ(2U, Slabs.getNumFreeSlabs());
+
+  {
+    BumpPtrAllocator Alloc(4096, 4096, Slabs);
+    Alloc.Allocate(3000, 0);
+    EXPECT_EQ(1U, Slabs.getNumFreeSlabs());
+    // The slab left is too small for a separately allocated object.
+    Alloc.Allocate(10000, 0);
+    EXPECT_EQ(1U, Slabs.getNumFreeSlabs());
+  }
+  EXPECT_EQ(3U, Slabs.getNumFreeSlabs());
+
+  {
+    // The two default-sized slabs are reused, but the big one is not: more
+    // than half of it would be wasted.
+    BumpPtrAllocator Alloc(4096, 4096, Slabs);
+    Alloc.Allocate(3000, 0);
+    Alloc.Allocate(3000, 0);
+    EXPECT_EQ(1U, Slabs.getNumFreeSlabs());
+    Alloc.Allocate(3000, 0);
+    EXPECT_EQ(1U, Slabs.getNumFreeSlabs());
+    EXPECT_EQ(3U, Alloc.GetNumSlabs());
+  }
+  EXPECT_EQ(4U, Slabs.getNumFreeSlabs());
+
+  Slabs.releaseMemory();
+  EXPECT_EQ(0U, Slabs.getNumFreeSlabs());
+}
+
+TEST(ThreadLocalAllocatorTest, SingleThread) {
+  ThreadLocalBumpPtrAllocator Alloc(4096, 4096);
+  int *a = Alloc.Allocate<int>();
+  int *b = Alloc.Allocate<int>(10);
+  *a = 1;
+  b[9] = 2;
+  EXPECT_EQ(1, *a);
+  EXPECT_EQ(2, b[9]);
+  EXPECT_EQ(1U, Alloc.GetNumSlabs());
+  EXPECT_EQ(11 * sizeof(int), Alloc.getBytesAllocated());
+
+  Alloc.Allocate(3000, 0);
+  Alloc.Allocate(3000, 0);
+  EXPECT_EQ(2U, Alloc.GetNumSlabs());
+  Alloc.Reset();
+  EXPECT_EQ(1U, Alloc.GetNumSlabs());
+  EXPECT_EQ(0U, Alloc.getBytesAllocated());
+}
+
+#if LLVM_ENABLE_THREADS != 0
+struct Allocation {
+  ThreadLocalBumpPtrAllocator *Alloc;
+  unsigned Value;
+  unsigned *Ptr;
+};
+
+void allocate(void *Arg) {
+  Allocation *A = static_cast<Allocation*>(Arg);
+  A->Ptr = A->Alloc->Allocate<unsigned>(64);
+  for (unsigned i = 0; i != 64; ++i)
+    A->Ptr[i] = A->Value;
+}
+
+// Each thread allocates from an arena of its own.
+TEST(ThreadLocalAllocatorTest, OtherThread) {
+  ThreadLocalBumpPtrAllocator Alloc(4096, 4096);
+  Allocation Here = { &Alloc, 1, 0 };
+  Allocation There = { &Alloc, 2, 0 };
+  allocate(&Here);
+  llvm_execute_on_thread(allocate, &There);
+
+  EXPECT_EQ(2U, Alloc.GetNumSlabs());
+  EXPECT_EQ(2 * 64 * sizeof(unsigned), Alloc.getBytesAllocated());
+  EXPECT_TRUE(There.Ptr + 64 <= Here.Ptr || Here.Ptr + 64 <= There.Ptr);
+  for (unsigned i = 0; i != 64; ++i) {
+    EXPECT_EQ(1U, Here.Ptr[i]);
+    EXPECT_EQ(2U, There.Ptr[i]);
+  }
+
+  // Reset covers both threads, each of which keeps one slab.
+  Alloc.Reset();
+  EXPECT_EQ(0U, Alloc.getBytesAllocated());
+  EXPECT_EQ(2U, Alloc.GetNumSlabs());
+  Allocation Third = { &Alloc, 3, 0 };
+  llvm_execute_on_thread(allocate, &Third);
+  EXPECT_EQ(3U, Alloc.GetNumSlabs());
+  EXPECT_EQ(3U, Third.Ptr[63]);
+}
+
+// Threads allocating at the same time do not hand out the same memory.
+TEST(ThreadLocalAllocatorTest, ConcurrentThreads) {
+  ThreadLocalBumpPtrAllocator Alloc(4096, 4096);
+  const unsigned NumAllocations = 256;
+  Allocation Allocations[NumAllocations];
+  {
+    ThreadPool Pool(4);
+    for (unsigned i = 0; i != NumAllocations; ++i) {
+      Allocation A = { &Alloc, i, 0 };
+      Allocations[i] = A;
+      Pool.async(allocate, &Allocations[i]);
+    }
+    Pool.wait();
+  }
+
+  EXPECT_EQ(NumAllocations * 64 * sizeof(unsigned),
+            Alloc.getBytesAllocated());
+  for (unsigned i = 0; i != NumAllocations; ++i)
+    for (unsigned j = 0; j != 64; ++j)
+      ASSERT_EQ(i, Allocations[i].Ptr[j]) << "allocation " << i;
+}
+#endif
+
+} // end anonymous namespace
@@ -0,0 +1,128 @@
+//===- unittests/Support/ThreadPoolTest.cpp - ThreadPool tests ------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Parallel.h"
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+using namespace llvm;
+
+namespace {
+
+void increment(void *Arg) {
+  sys::AtomicIncrement(static_cast<volatile sys::cas_flag*>(Arg));
+}
+
+TEST(ThreadPoolTest, AsyncAndWait) {
+  ThreadPool Pool(4);
+  EXPECT_EQ(4u, Pool.getThreadCount());
+
+  volatile sys::cas_flag Count = 0;
+  for (unsigned i = 0; i != 1000; ++i)
+    Pool.async(increment, const_cast<sys::cas_flag*>(&Count));
+  Pool.wait();
+  EXPECT_EQ(1000u, Count);
+}
+
+TEST(ThreadPoolTest, SingleThread) {
+  ThreadPool Pool(1);
+  volatile sys::cas_flag Count = 0;
+  TaskGroup Group(Pool);
+  for (unsigned i = 0; i != 10; ++i)
+    Group.async(increment, const_cast<sys::cas_flag*>(&Count));
+  Group.wait();
+  EXPECT_EQ(10u, Count);
+}
+
+TEST(ThreadPoolTest, TaskGroups) {
+  ThreadPool Pool(4);
+  volatile sys::cas_flag First = 0, Second = 0;
+  {
+    TaskGroup A(Pool), B(Pool);
+    for (unsigned i = 0; i != 100; ++i) {
+      A.async(increment, const_cast<sys::cas_flag*>(&First));
+      B.async(increment, const_cast<sys::cas_flag*>(&Second));
+    }
+    A.wait();
+    EXPECT_EQ(100u, First);
+  }
+  // B waited for its tasks when it was destroyed.
+  EXPECT_EQ(100u, Second);
+}
+
+struct NestedArg {
+  ThreadPool *Pool;
+  volatile sys::cas_flag *Count;
+};
+
+void spawnAndWait(void *Arg) {
+  NestedArg *N = static_cast<NestedArg*>(Arg);
+  TaskGroup Group(*N->Pool);
+  for (unsigned i = 0; i != 10; ++i)
+    Group.async(increment, const_cast<sys::cas_flag*>(N->Count));
+  Group.wait();
+}
+
+// Every thread of the pool waits for tasks of its own; the waits must run
+// the queued tasks rather than block the pool.
+TEST(ThreadPoolTest, NestedWait) {
+  ThreadPool Pool(2);
+  volatile sys::cas_flag Count = 0;
+  NestedArg Arg = { &Pool, &Count };
+  TaskGroup Group(Pool);
+  for (unsigned i = 0; i != 20; ++i)
+    Group.async(spawnAndWait, &Arg);
+  Group.wait();
+  EXPECT_EQ(200u, Count);
+}
+
+struct AddOne {
+  void operator()(unsigned &X) const { ++X; }
+};
+
+TEST(ThreadPoolTest, ParallelForEach) {
+  std::vector<unsigned> V(10000);
+  for (unsigned i = 0, e = V.size(); i != e; ++i)
+    V[i] = i;
+  parallel_for_each(V.begin(), V.end(), AddOne());
+  for (unsigned i = 0, e = V.size(); i != e; ++i)
+    EXPECT_EQ(i + 1, V[i]);
+}
+
+TEST(ThreadPoolTest, ParallelSort) {
+  std::vector<unsigned> V;
+  unsigned Seed = 1;
+  for (unsigned i = 0; i != 100000; ++i) {
+    Seed = Seed * 1103515245 + 12345;
+    V.push_back(Seed >> 8);
+  }
+  std::vector<unsigned> Expected(V);
+  std::sort(Expected.begin(), Expected.end());
+  std::vector<unsigned> Reversed(Expected.rbegin(), Expected.rend());
+
+  std::vector<unsigned> W(V);
+  parallel_sort(W.begin(), W.end());
+  EXPECT_TRUE(W == Expected);
+
+  parallel_sort(V.begin(), V.end(), std::greater<unsigned>());
+  EXPECT_TRUE(V == Reversed);
+}
+
+TEST(ThreadPoolTest, ParallelSortSmall) {
+  unsigned A[] = { 3, 1, 2 };
+  parallel_sort(A, A + 3);
+  EXPECT_EQ(1u, A[0]);
+  EXPECT_EQ(2u, A[1]);
+  EXPECT_EQ(3u, A[2]);
+}
+
+} // end anonymous namespace
@@ -143,4 +143,55 @@ TEST(raw_ostreamTest, WriteEscaped) {
   EXPECT_EQ("\\001\\010\\200", Str);
 }
 
+TEST(raw_ostreamTest, Integers) {
+  // Every digit pair, and the lengths around each power of ten.
+  for (unsigned i = 0; i != 1000; ++i) {
+    char Expected[16];
+    snprintf(Expected, sizeof(Expected), "%u", i);
+    EXPECT_EQ(Expected, printToString(i));
+  }
+  uint64_t N = 1;
+  for (unsigned i = 0; i != 19; ++i, N *= 10) {
+    char Expected[32];
+    snprintf(Expected, sizeof(Expected), "%" PRIu64, N - 1);
+    EXPECT_EQ(Expected, printToString(N - 1));
+    snprintf(Expected, sizeof(Expected), "%" PRIu64, N);
+    EXPECT_EQ(Expected, printToString(N));
+  }
+}
+
+TEST(raw_ostreamTest, WriteHex) {
+  std::string Str;
+  raw_string_ostream(Str).write_hex(0);
+  EXPECT_EQ("0", Str);
+  Str.clear();
+  raw_string_ostream(Str).write_hex(0xbeef);
+  EXPECT_EQ("beef", Str);
+  Str.clear();
+  raw_string_ostream(Str).write_hex(UINT64_MAX);
+  EXPECT_EQ("ffffffffffffffff", Str);
+}
+
+TEST(raw_ostreamTest, FormattedNumber) {
+  EXPECT_EQ("0x0", printToString(format_hex(0, 1)));
+  EXPECT_EQ("0x00ff", printToString(format_hex(255, 6)));
+  EXPECT_EQ("0x00FF", printToString(format_hex(255, 6, true)));
+  EXPECT_EQ("0xdeadbeef", printToString(format_hex(0xdeadbeef, 4)));
+  EXPECT_EQ("0x00000000000000000001", printToString(format_hex(1, 22)));
+  EXPECT_EQ("ffffffffffffffff",
+            printToString(format_hex_no_prefix(UINT64_MAX, 16)));
+  EXPECT_EQ("00ab", printToString(format_hex_no_prefix(0xab, 4)));
+
+  EXPECT_EQ("0", printToString(format_decimal(0, 0)));
+  EXPECT_EQ("   42", printToString(format_decimal(42, 5)));
+  EXPECT_EQ("  -42", printToString(format_decimal(-42, 5)));
+  EXPECT_EQ("123456", printToString(format_decimal(123456, 3)));
+  EXPECT_EQ("-9223372036854775808",
+            printToString(format_decimal(INT64_MIN, 1)));
+
+  // The same through a buffer too small to hold the number.
+  EXPECT_EQ("0x00ff", printToString(format_hex(255, 6), 1));
+  EXPECT_EQ("  -42", printToString(format_decimal(-42, 5), 2));
+}
+
 }
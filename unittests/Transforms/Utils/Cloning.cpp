@@ -11,11 +11,14 @@
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/IR/Argument.h"
 #include "llvm/IR/Constant.h"
+#include "llvm/IR/Constants.h"
 #include "llvm/IR/Function.h"
 #include "llvm/IR/Instructions.h"
 #include "llvm/IR/IRBuilder.h"
 #include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
 #include "llvm/Transforms/Utils/Cloning.h"
+#include "llvm/Transforms/Utils/ValueMapper.h"
 #include "gtest/gtest.h"
 
 using namespace llvm;
@@ -173,4 +176,68 @@ TEST_F(CloneInstruction, Attributes) {
   delete F2;
 }
 
+TEST_F(CloneInstruction, ConstantOperands) {
+  Type *ArgTy1[] = { Type::getInt32Ty(context) };
+  FunctionType *FT1 = FunctionType::get(Type::getInt32Ty(context), ArgTy1,
+                                        false);
+
+  Function *F1 = Function::Create(FT1, Function::ExternalLinkage);
+  BasicBlock *BB = BasicBlock::Create(context, "", F1);
+  IRBuilder<> Builder(BB);
+  Constant *C = Builder.getInt32(42);
+  Value *Add = Builder.CreateAdd(F1->arg_begin(), C);
+  Builder.CreateRet(Add);
+
+  Function *F2 = Function::Create(FT1, Function::ExternalLinkage);
+
+  SmallVector<ReturnInst*, 4> Returns;
+  ValueToValueMapTy VMap;
+  VMap[F1->arg_begin()] = F2->arg_begin();
+  CloneFunctionInto(F2, F1, VMap, false, Returns);
+
+  // Constants without operands are used as they are, without being added to
+  // the map.
+  BinaryOperator *NewAdd = cast<BinaryOperator>(VMap[Add]);
+  EXPECT_EQ(F2->arg_begin(), NewAdd->getOperand(0));
+  EXPECT_EQ(C, NewAdd->getOperand(1));
+  EXPECT_EQ(0u, VMap.count(C));
+
+  delete F1;
+  delete F2;
+}
+
+TEST(ValueMapper, ConstantExprOperands) {
+  LLVMContext Context;
+  Module M("ValueMapper", Context);
+  Type *Int32Ty = Type::getInt32Ty(Context);
+  Type *Int64Ty = Type::getInt64Ty(Context);
+  GlobalVariable *A = new GlobalVariable(M, Int32Ty, false,
+                                         GlobalValue::ExternalLinkage, 0, "a");
+  GlobalVariable *G1 = new GlobalVariable(M, Int32Ty, false,
+                                          GlobalValue::ExternalLinkage, 0,
+                                          "g1");
+  GlobalVariable *G2 = new GlobalVariable(M, Int32Ty, false,
+                                          GlobalValue::ExternalLinkage, 0,
+                                          "g2");
+  Constant *AInt = ConstantExpr::getPtrToInt(A, Int64Ty);
+  // Two expressions that differ only in their second operand.
+  Constant *E1 = ConstantExpr::getAdd(AInt,
+                                      ConstantExpr::getPtrToInt(G1, Int64Ty));
+  Constant *E2 = ConstantExpr::getAdd(AInt,
+                                      ConstantExpr::getPtrToInt(G2, Int64Ty));
+  ASSERT_NE(E1, E2);
+
+  ValueToValueMapTy VM;
+  // An expression whose operands all map to themselves is used as it is.
+  EXPECT_EQ(E1, MapValue(E1, VM));
+  EXPECT_EQ(AInt, VM[AInt]);
+
+  VM.clear();
+  VM[G1] = G2;
+  EXPECT_EQ(E2, MapValue(E1, VM));
+  EXPECT_EQ(E2, VM[E1]);
+  // The first operand was unchanged.
+  EXPECT_EQ(AInt, VM[AInt]);
+}
+
 }
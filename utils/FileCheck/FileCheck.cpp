@@ -16,6 +16,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "llvm/ADT/IntrusiveRefCntPtr.h"
 #include "llvm/ADT/OwningPtr.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringExtras.h"
@@ -72,6 +73,13 @@ namespace Check {
   };
 }
 
+/// CompiledRegex - A regex compiled once and shared by the copies of the
+/// pattern it belongs to.
+struct CompiledRegex : public RefCountedBase<CompiledRegex> {
+  Regex R;
+  CompiledRegex(StringRef RegExStr) : R(RegExStr, Regex::Newline) {}
+};
+
 class Pattern {
   SMLoc PatternLoc;
 
@@ -84,6 +92,13 @@ class Pattern {
   /// RegEx - If non-empty, this is a regex pattern.
   std::string RegExStr;
 
+  /// RegExPrefix - The fixed string a regex pattern starts with, if any.  The
+  /// regex is only run from the line of its first occurrence.
+  StringRef RegExPrefix;
+
+  /// CompiledRegEx - RegExStr compiled, if it uses no variables.
+  IntrusiveRefCntPtr<CompiledRegex> CompiledRegEx;
+
   /// \brief Contains the number of line this pattern is in.
   unsigned LineNumber;
 
@@ -136,6 +151,10 @@ public:
   Check::CheckType getCheckTy() const { return CheckTy; }
 
 private:
+  size_t recordMatch(StringRef Buffer,
+                     const SmallVectorImpl<StringRef> &MatchInfo,
+                     size_t &MatchLen,
+                     StringMap<StringRef> &VariableTable) const;
   bool AddRegExToRegEx(StringRef RS, unsigned &CurParen, SourceMgr &SM);
   void AddBackrefToRegEx(unsigned BackrefNum);
 
@@ -186,6 +205,9 @@ bool Pattern::ParsePattern(StringRef PatternStr,
     return false;
   }
 
+  RegExPrefix = PatternStr.substr(0, std::min(PatternStr.find("{{"),
+                                               PatternStr.find("[[")));
+
   // Paren value #0 is for the fully matched string.  Any new parenthesized
   // values add from there.
   unsigned CurParen = 1;
@@ -317,6 +339,8 @@ bool Pattern::ParsePattern(StringRef PatternStr,
     PatternStr = PatternStr.substr(FixedMatchEnd);
   }
 
+  if (VariableUses.empty())
+    CompiledRegEx = new CompiledRegex(RegExStr);
   return false;
 }
 
@@ -379,6 +403,25 @@ size_t Pattern::Match(StringRef Buffer, size_t &MatchLen,
 
   // Regex match.
 
+  // Every match starts with RegExPrefix, so there is none before its first
+  // occurrence.  Start matching from the beginning of that line rather than
+  // from the occurrence, so that '^' still means what it did.
+  size_t Start = 0;
+  if (!RegExPrefix.empty()) {
+    size_t PrefixLoc = Buffer.find(RegExPrefix);
+    if (PrefixLoc == StringRef::npos)
+      return StringRef::npos;
+    Start = Buffer.rfind('\n', PrefixLoc);
+    Start = Start == StringRef::npos ? 0 : Start + 1;
+  }
+
+  SmallVector<StringRef, 4> MatchInfo;
+  if (CompiledRegEx) {
+    if (!CompiledRegEx->R.match(Buffer.substr(Start), &MatchInfo))
+      return StringRef::npos;
+    return recordMatch(Buffer, MatchInfo, MatchLen, VariableTable);
+  }
+
   // If there are variable uses, we need to create a temporary string with the
   // actual value.
   StringRef RegExToMatch = RegExStr;
@@ -415,11 +458,18 @@ size_t Pattern::Match(StringRef Buffer, size_t &MatchLen,
   }
 
 
-  SmallVector<StringRef, 4> MatchInfo;
-  if (!Regex(RegExToMatch, Regex::Newline).match(Buffer, &MatchInfo))
+  if (!Regex(RegExToMatch, Regex::Newline).match(Buffer.substr(Start),
+                                                 &MatchInfo))
     return StringRef::npos;
+  return recordMatch(Buffer, MatchInfo, MatchLen, VariableTable);
+}
 
-  // Successful regex match.
+/// recordMatch - Define the variables of the pattern from a successful regex
+/// match and return its position in Buffer.
+size_t Pattern::recordMatch(StringRef Buffer,
+                            const SmallVectorImpl<StringRef> &MatchInfo,
+                            size_t &MatchLen,
+                            StringMap<StringRef> &VariableTable) const {
   assert(!MatchInfo.empty() && "Didn't get any match");
   StringRef FullMatch = MatchInfo[0];
 
@@ -627,6 +677,11 @@ struct CheckString {
 /// characters to a single space.
 static MemoryBuffer *CanonicalizeInputFile(MemoryBuffer *MB,
                                            bool PreserveHorizontal) {
+  // Without any whitespace to canonicalize, keep the original (possibly
+  // mmap'd) buffer rather than copying it.
+  if (PreserveHorizontal && MB->getBuffer().find("\r\n") == StringRef::npos)
+    return MB;
+
   SmallString<128> NewFile;
   NewFile.reserve(MB->getBufferSize());
 
@@ -109,6 +109,7 @@
 #include "llvm/TableGen/Error.h"
 #include "llvm/TableGen/Record.h"
 #include "llvm/TableGen/StringMatcher.h"
+#include "llvm/TableGen/StringPerfectHash.h"
 #include "llvm/TableGen/StringToOffsetTable.h"
 #include "llvm/TableGen/TableGenBackend.h"
 #include <cassert>
@@ -2820,21 +2821,7 @@ void AsmMatcherEmitter::run(raw_ostream &OS) {
   OS << "      return StringRef(MnemonicTable + Mnemonic + 1,\n";
   OS << "                       MnemonicTable[Mnemonic]);\n";
   OS << "    }\n";
-  OS << "  };\n\n";
-
-  OS << "  // Predicate for searching for an opcode.\n";
-  OS << "  struct LessOpcode {\n";
-  OS << "    bool operator()(const MatchEntry &LHS, StringRef RHS) {\n";
-  OS << "      return LHS.getMnemonic() < RHS;\n";
-  OS << "    }\n";
-  OS << "    bool operator()(StringRef LHS, const MatchEntry &RHS) {\n";
-  OS << "      return LHS < RHS.getMnemonic();\n";
-  OS << "    }\n";
-  OS << "    bool operator()(const MatchEntry &LHS, const MatchEntry &RHS) {\n";
-  OS << "      return LHS.getMnemonic() < RHS.getMnemonic();\n";
-  OS << "    }\n";
   OS << "  };\n";
-
   OS << "} // end anonymous namespace.\n\n";
 
   unsigned VariantCount = Target.getAsmParserVariantCount();
@@ -2844,6 +2831,10 @@ void AsmMatcherEmitter::run(raw_ostream &OS) {
 
     OS << "static const MatchEntry MatchTable" << VC << "[] = {\n";
 
+    // The entries for each mnemonic form a range of the sorted table.
+    std::vector<std::string> Mnemonics;
+    std::vector<std::pair<unsigned, unsigned> > MnemonicRanges;
+    unsigned NumEntries = 0;
     for (std::vector<MatchableInfo*>::const_iterator it =
          Info.Matchables.begin(), ie = Info.Matchables.end();
          it != ie; ++it) {
@@ -2851,6 +2842,12 @@ void AsmMatcherEmitter::run(raw_ostream &OS) {
       if (II.AsmVariantID != AsmVariantNo)
         continue;
 
+      if (Mnemonics.empty() || Mnemonics.back() != II.Mnemonic) {
+        Mnemonics.push_back(II.Mnemonic);
+        MnemonicRanges.push_back(std::make_pair(NumEntries, NumEntries));
+      }
+      MnemonicRanges.back().second = ++NumEntries;
+
       // Store a pascal-style length byte in the mnemonic.
       std::string LenMnemonic = char(II.Mnemonic.size()) + II.Mnemonic.str();
       OS << "  { " << StringTable.GetOrAddStringOffset(LenMnemonic, false)
@@ -2879,25 +2876,56 @@ void AsmMatcherEmitter::run(raw_ostream &OS) {
     }
 
     OS << "};\n\n";
+
+    // Look mnemonics up with a perfect hash rather than a binary search.
+    StringPerfectHash Hash(Mnemonics);
+    std::string HashName = "MnemonicHash" + utostr(VC);
+    Hash.emit(OS, HashName);
+    std::string RangeType = getMinimalTypeForRange(NumEntries);
+    OS << "static const struct {\n";
+    OS << "  " << RangeType << " Begin, End;\n";
+    OS << "} MnemonicRanges" << VC << "[] = {\n";
+    for (unsigned Slot = 0, e = Hash.getNumSlots(); Slot != e; ++Slot) {
+      int Idx = Hash.getKeyInSlot(Slot);
+      OS << "  { ";
+      if (Idx == -1)
+        OS << "0, 0 },\n";
+      else
+        OS << MnemonicRanges[Idx].first << ", " << MnemonicRanges[Idx].second
+           << " },\t// " << Mnemonics[Idx] << "\n";
+    }
+    OS << "};\n\n";
   }
 
-  // A method to determine if a mnemonic is in the list.
-  OS << "bool " << Target.getName() << ClassName << "::\n"
-     << "mnemonicIsValid(StringRef Mnemonic, unsigned VariantID) {\n";
-  OS << "  // Find the appropriate table for this asm variant.\n";
-  OS << "  const MatchEntry *Start, *End;\n";
+  // A helper to find the table entries for a mnemonic.
+  OS << "static std::pair<const MatchEntry*, const MatchEntry*>\n"
+     << "findMnemonicRange(StringRef Mnemonic, unsigned VariantID) {\n";
+  OS << "  const MatchEntry *Table;\n";
+  OS << "  int Slot;\n";
+  OS << "  unsigned Begin = 0, End = 0;\n";
   OS << "  switch (VariantID) {\n";
   OS << "  default: // unreachable\n";
   for (unsigned VC = 0; VC != VariantCount; ++VC) {
     Record *AsmVariant = Target.getAsmParserVariant(VC);
     int AsmVariantNo = AsmVariant->getValueAsInt("Variant");
-    OS << "  case " << AsmVariantNo << ": Start = MatchTable" << VC
-       << "; End = array_endof(MatchTable" << VC << "); break;\n";
+    OS << "  case " << AsmVariantNo << ":\n";
+    OS << "    Table = MatchTable" << VC << ";\n";
+    OS << "    Slot = MnemonicHash" << VC << "::lookup(Mnemonic);\n";
+    OS << "    if (Slot != -1) {\n";
+    OS << "      Begin = MnemonicRanges" << VC << "[Slot].Begin;\n";
+    OS << "      End = MnemonicRanges" << VC << "[Slot].End;\n";
+    OS << "    }\n";
+    OS << "    break;\n";
   }
   OS << "  }\n";
-  OS << "  // Search the table.\n";
+  OS << "  return std::make_pair(Table + Begin, Table + End);\n";
+  OS << "}\n\n";
+
+  // A method to determine if a mnemonic is in the list.
+  OS << "bool " << Target.getName() << ClassName << "::\n"
+     << "mnemonicIsValid(StringRef Mnemonic, unsigned VariantID) {\n";
   OS << "  std::pair<const MatchEntry*, const MatchEntry*> MnemonicRange =\n";
-  OS << "    std::equal_range(Start, End, Mnemonic, LessOpcode());\n";
+  OS << "    findMnemonicRange(Mnemonic, VariantID);\n";
   OS << "  return MnemonicRange.first != MnemonicRange.second;\n";
   OS << "}\n\n";
 
@@ -2939,20 +2967,9 @@ void AsmMatcherEmitter::run(raw_ostream &OS) {
   OS << "  ErrorInfo = ~0U;\n";
 
   // Emit code to search the table.
-  OS << "  // Find the appropriate table for this asm variant.\n";
-  OS << "  const MatchEntry *Start, *End;\n";
-  OS << "  switch (VariantID) {\n";
-  OS << "  default: // unreachable\n";
-  for (unsigned VC = 0; VC != VariantCount; ++VC) {
-    Record *AsmVariant = Target.getAsmParserVariant(VC);
-    int AsmVariantNo = AsmVariant->getValueAsInt("Variant");
-    OS << "  case " << AsmVariantNo << ": Start = MatchTable" << VC
-       << "; End = array_endof(MatchTable" << VC << "); break;\n";
-  }
-  OS << "  }\n";
-  OS << "  // Search the table.\n";
+  OS << "  // Find the entries for this mnemonic in the asm variant's table.\n";
   OS << "  std::pair<const MatchEntry*, const MatchEntry*> MnemonicRange =\n";
-  OS << "    std::equal_range(Start, End, Mnemonic, LessOpcode());\n\n";
+  OS << "    findMnemonicRange(Mnemonic, VariantID);\n\n";
 
   OS << "  // Return a more specific error code if no mnemonics match.\n";
   OS << "  if (MnemonicRange.first == MnemonicRange.second)\n";
@@ -2962,7 +2979,7 @@ void AsmMatcherEmitter::run(raw_ostream &OS) {
      << "*ie = MnemonicRange.second;\n";
   OS << "       it != ie; ++it) {\n";
 
-  OS << "    // equal_range guarantees that instruction mnemonic matches.\n";
+  OS << "    // The lookup guarantees that the instruction mnemonic matches.\n";
   OS << "    assert(Mnemonic == it->getMnemonic());\n";
 
   // Emit check that the subclasses match.
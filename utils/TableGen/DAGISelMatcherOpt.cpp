@@ -236,6 +236,112 @@ static Matcher *FindNodeWithKind(Matcher *M, Matcher::KindTy Kind) {
   return 0;
 }
 
+/// FindSwitchableTypeCheck - Return the CheckType for result #0 of an option
+/// if it can be hoisted to the front of the option and used as a SwitchType
+/// case, otherwise return null.
+static CheckTypeMatcher *FindSwitchableTypeCheck(Matcher *M) {
+  CheckTypeMatcher *CTM =
+    cast_or_null<CheckTypeMatcher>(FindNodeWithKind(M, Matcher::CheckType));
+  if (CTM == 0 ||
+      // iPTR checks could alias any other case without us knowing, don't
+      // bother with them.
+      CTM->getType() == MVT::iPTR ||
+      // SwitchType only works for result #0.
+      CTM->getResNo() != 0 ||
+      // If the CheckType isn't at the start of the list, see if we can move
+      // it there.
+      !CTM->canMoveBefore(M))
+    return 0;
+  return CTM;
+}
+
+/// BuildTypeSwitch - Turn a list of options that all have a switchable type
+/// check into a SwitchType, or into a single CheckType if they all check the
+/// same type.
+static Matcher *BuildTypeSwitch(Matcher *const *Options, unsigned NumOptions) {
+  DenseMap<unsigned, unsigned> TypeEntry;
+  SmallVector<std::pair<MVT::SimpleValueType, Matcher*>, 8> Cases;
+  for (unsigned i = 0; i != NumOptions; ++i) {
+    CheckTypeMatcher *CTM = FindSwitchableTypeCheck(Options[i]);
+    Matcher *MatcherWithoutCTM = Options[i]->unlinkNode(CTM);
+    MVT::SimpleValueType CTMTy = CTM->getType();
+    delete CTM;
+    
+    unsigned &Entry = TypeEntry[CTMTy];
+    if (Entry != 0) {
+      // If we have unfactored duplicate types, then we should factor them.
+      Matcher *PrevMatcher = Cases[Entry-1].second;
+      if (ScopeMatcher *SM = dyn_cast<ScopeMatcher>(PrevMatcher)) {
+        SM->setNumChildren(SM->getNumChildren()+1);
+        SM->resetChild(SM->getNumChildren()-1, MatcherWithoutCTM);
+        continue;
+      }
+      
+      Matcher *Entries[2] = { PrevMatcher, MatcherWithoutCTM };
+      Cases[Entry-1].second = new ScopeMatcher(Entries, 2);
+      continue;
+    }
+    
+    Entry = Cases.size()+1;
+    Cases.push_back(std::make_pair(CTMTy, MatcherWithoutCTM));
+  }
+  
+  if (Cases.size() != 1)
+    return new SwitchTypeMatcher(&Cases[0], Cases.size());
+
+  // If we factored and ended up with one case, create it now.
+  Matcher *Result = new CheckTypeMatcher(Cases[0].first, 0);
+  Result->setNext(Cases[0].second);
+  return Result;
+}
+
+/// FormSwitchRuns - When only some of the options of a scope start with an
+/// opcode check, or have a type check that can be hoisted, turn each run of
+/// adjacent such options into a SwitchOpcode or SwitchType child of the scope.
+/// Different opcodes or types in a run are mutually exclusive, so switching on
+/// them keeps the order in which the scope tries its children, while saving
+/// the interpreter a linear scan through every failing case.
+static void FormSwitchRuns(SmallVectorImpl<Matcher*> &Options) {
+  // Runs shorter than this are cheaper to leave as scope entries.
+  const unsigned MinRunLength = 3;
+
+  SmallVector<Matcher*, 32> NewOptions;
+  for (unsigned i = 0, e = Options.size(); i != e; ) {
+    // Opcodes in a run must be distinct; duplicates were factored already
+    // unless something in between kept them apart.
+    StringSet<> Opcodes;
+    unsigned OpcodeEnd = i;
+    while (OpcodeEnd != e && isa<CheckOpcodeMatcher>(Options[OpcodeEnd]) &&
+           Opcodes.insert(cast<CheckOpcodeMatcher>(Options[OpcodeEnd])
+                            ->getOpcode().getEnumName()))
+      ++OpcodeEnd;
+
+    if (OpcodeEnd - i >= MinRunLength) {
+      SmallVector<std::pair<const SDNodeInfo*, Matcher*>, 8> Cases;
+      for (; i != OpcodeEnd; ++i) {
+        CheckOpcodeMatcher *COM = cast<CheckOpcodeMatcher>(Options[i]);
+        Cases.push_back(std::make_pair(&COM->getOpcode(), COM->takeNext()));
+        delete COM;
+      }
+      NewOptions.push_back(new SwitchOpcodeMatcher(&Cases[0], Cases.size()));
+      continue;
+    }
+
+    unsigned TypeEnd = i;
+    while (TypeEnd != e && FindSwitchableTypeCheck(Options[TypeEnd]))
+      ++TypeEnd;
+
+    if (TypeEnd - i >= MinRunLength) {
+      NewOptions.push_back(BuildTypeSwitch(&Options[i], TypeEnd - i));
+      i = TypeEnd;
+      continue;
+    }
+
+    NewOptions.push_back(Options[i++]);
+  }
+
+  Options.swap(NewOptions);
+}
 
 /// FactorNodes - Turn matches like this:
 ///   Scope
@@ -420,27 +526,14 @@ static void FactorNodes(OwningPtr<Matcher> &MatcherPtr) {
     }
 
     // Check to see if this breaks a series of CheckTypeMatcher's.
-    if (AllTypeChecks) {
-      CheckTypeMatcher *CTM =
-        cast_or_null<CheckTypeMatcher>(FindNodeWithKind(NewOptionsToMatch[i],
-                                                        Matcher::CheckType));
-      if (CTM == 0 ||
-          // iPTR checks could alias any other case without us knowing, don't
-          // bother with them.
-          CTM->getType() == MVT::iPTR ||
-          // SwitchType only works for result #0.
-          CTM->getResNo() != 0 ||
-          // If the CheckType isn't at the start of the list, see if we can move
-          // it there.
-          !CTM->canMoveBefore(NewOptionsToMatch[i])) {
+    if (AllTypeChecks && !FindSwitchableTypeCheck(NewOptionsToMatch[i])) {
 #if 0
-        if (i > 3 && AllTypeChecks) {
-          errs() << "FAILING TYPE #" << i << "\n";
-          NewOptionsToMatch[i]->dump();
-        }
-#endif
-        AllTypeChecks = false;
+      if (i > 3) {
+        errs() << "FAILING TYPE #" << i << "\n";
+        NewOptionsToMatch[i]->dump();
       }
+#endif
+      AllTypeChecks = false;
     }
   }
   
@@ -461,45 +554,13 @@ static void FactorNodes(OwningPtr<Matcher> &MatcherPtr) {
   
   // If all the options are CheckType's, we can form the SwitchType, woot.
   if (AllTypeChecks) {
-    DenseMap<unsigned, unsigned> TypeEntry;
-    SmallVector<std::pair<MVT::SimpleValueType, Matcher*>, 8> Cases;
-    for (unsigned i = 0, e = NewOptionsToMatch.size(); i != e; ++i) {
-      CheckTypeMatcher *CTM =
-        cast_or_null<CheckTypeMatcher>(FindNodeWithKind(NewOptionsToMatch[i],
-                                                        Matcher::CheckType));
-      Matcher *MatcherWithoutCTM = NewOptionsToMatch[i]->unlinkNode(CTM);
-      MVT::SimpleValueType CTMTy = CTM->getType();
-      delete CTM;
-      
-      unsigned &Entry = TypeEntry[CTMTy];
-      if (Entry != 0) {
-        // If we have unfactored duplicate types, then we should factor them.
-        Matcher *PrevMatcher = Cases[Entry-1].second;
-        if (ScopeMatcher *SM = dyn_cast<ScopeMatcher>(PrevMatcher)) {
-          SM->setNumChildren(SM->getNumChildren()+1);
-          SM->resetChild(SM->getNumChildren()-1, MatcherWithoutCTM);
-          continue;
-        }
-        
-        Matcher *Entries[2] = { PrevMatcher, MatcherWithoutCTM };
-        Cases[Entry-1].second = new ScopeMatcher(Entries, 2);
-        continue;
-      }
-      
-      Entry = Cases.size()+1;
-      Cases.push_back(std::make_pair(CTMTy, MatcherWithoutCTM));
-    }
-    
-    if (Cases.size() != 1) {
-      MatcherPtr.reset(new SwitchTypeMatcher(&Cases[0], Cases.size()));
-    } else {
-      // If we factored and ended up with one case, create it now.
-      MatcherPtr.reset(new CheckTypeMatcher(Cases[0].first, 0));
-      MatcherPtr->setNext(Cases[0].second);
-    }
+    MatcherPtr.reset(BuildTypeSwitch(&NewOptionsToMatch[0],
+                                     NewOptionsToMatch.size()));
     return;
   }
-  
+
+  // Otherwise, switch within the runs of options that check an opcode or type.
+  FormSwitchRuns(NewOptionsToMatch);
 
   // Reassemble the Scope node with the adjusted children.
   Scope->setNumChildren(NewOptionsToMatch.size());
@@ -18,8 +18,10 @@
 #include "llvm/TableGen/Error.h"
 #include "llvm/TableGen/Record.h"
 #include "llvm/TableGen/StringMatcher.h"
+#include "llvm/TableGen/StringPerfectHash.h"
 #include "llvm/TableGen/TableGenBackend.h"
 #include <algorithm>
+#include <map>
 using namespace llvm;
 
 namespace {
@@ -131,69 +133,89 @@ void IntrinsicEmitter::EmitEnumInfo(const std::vector<CodeGenIntrinsic> &Ints,
   OS << "#endif\n\n";
 }
 
-struct IntrinsicNameSorter {
-  IntrinsicNameSorter(const std::vector<CodeGenIntrinsic> &I)
-  : Ints(I) {}
-
-  // Sort in reverse order of intrinsic name so "abc.def" appears after
-  // "abd.def.ghi" in the overridden name matcher
-  bool operator()(unsigned i, unsigned j) {
-    return Ints[i].Name > Ints[j].Name;
-  }
-
-private:
-  const std::vector<CodeGenIntrinsic> &Ints;
-};
-
 void IntrinsicEmitter::
 EmitFnNameRecognizer(const std::vector<CodeGenIntrinsic> &Ints,
                      raw_ostream &OS) {
-  // Build a 'first character of function name' -> intrinsic # mapping.
-  std::map<char, std::vector<unsigned> > IntMapping;
-  for (unsigned i = 0, e = Ints.size(); i != e; ++i)
-    IntMapping[Ints[i].Name[5]].push_back(i);
+  // Hash the names without the 'llvm.' prefix.  Overloaded intrinsics are
+  // hashed by the name their overloads start with.
+  std::vector<std::string> Names;
+  std::map<std::string, unsigned> Overloaded;
+  unsigned MaxDots = 0;
+  for (unsigned i = 0, e = Ints.size(); i != e; ++i) {
+    Names.push_back(Ints[i].Name.substr(5));
+    if (!Ints[i].isOverloaded)
+      continue;
+    Overloaded[Names.back()] = i;
+    MaxDots = std::max(MaxDots, (unsigned)std::count(Names.back().begin(),
+                                                     Names.back().end(), '.'));
+  }
+  StringPerfectHash Hash(Names);
 
-  OS << "// Function name -> enum value recognizer code.\n";
-  OS << "#ifdef GET_FUNCTION_RECOGNIZER\n";
-  OS << "  StringRef NameR(Name+6, Len-6);   // Skip over 'llvm.'\n";
-  OS << "  switch (Name[5]) {                  // Dispatch on first letter.\n";
-  OS << "  default: break;\n";
-  IntrinsicNameSorter Sorter(Ints);
-  // Emit the intrinsic matching stuff by first letter.
-  for (std::map<char, std::vector<unsigned> >::iterator I = IntMapping.begin(),
-       E = IntMapping.end(); I != E; ++I) {
-    OS << "  case '" << I->first << "':\n";
-    std::vector<unsigned> &IntList = I->second;
-
-    // Sort intrinsics in reverse order of their names
-    std::sort(IntList.begin(), IntList.end(), Sorter);
-
-    // Emit all the overloaded intrinsics first, build a table of the
-    // non-overloaded ones.
-    std::vector<StringMatcher::StringPair> MatchTable;
-
-    for (unsigned i = 0, e = IntList.size(); i != e; ++i) {
-      unsigned IntNo = IntList[i];
-      std::string Result = "return " + TargetPrefix + "Intrinsic::" +
-        Ints[IntNo].EnumName + ";";
-
-      if (!Ints[IntNo].isOverloaded) {
-        MatchTable.push_back(std::make_pair(Ints[IntNo].Name.substr(6),Result));
-        continue;
+  // The exact name of an intrinsic that is not overloaded is looked up first,
+  // so if it also starts with the name of an overloaded intrinsic followed by
+  // a '.', record the longest such intrinsic as its result.
+  std::vector<unsigned> ExactID(Ints.size());
+  for (unsigned i = 0, e = Ints.size(); i != e; ++i) {
+    ExactID[i] = i;
+    if (Ints[i].isOverloaded)
+      continue;
+    for (size_t Dot = Names[i].rfind('.'); Dot != std::string::npos;
+         Dot = Dot ? Names[i].rfind('.', Dot - 1) : std::string::npos) {
+      std::map<std::string, unsigned>::iterator I =
+        Overloaded.find(Names[i].substr(0, Dot));
+      if (I != Overloaded.end()) {
+        ExactID[i] = I->second;
+        break;
       }
-
-      // For overloaded intrinsics, only the prefix needs to match
-      std::string TheStr = Ints[IntNo].Name.substr(6);
-      TheStr += '.';  // Require "bswap." instead of bswap.
-      OS << "    if (NameR.startswith(\"" << TheStr << "\")) "
-         << Result << '\n';
     }
-
-    // Emit the matcher logic for the fixed length strings.
-    StringMatcher("NameR", MatchTable, OS).Emit(1);
-    OS << "    break;  // end of '" << I->first << "' case.\n";
   }
 
+  OS << "// Function name -> enum value recognizer code.\n";
+  OS << "#ifdef GET_FUNCTION_RECOGNIZER\n";
+  OS << "  StringRef NameR(Name+5, Len-5);   // Skip over 'llvm.'\n";
+  Hash.emit(OS, "IntrinsicNameHash", 1);
+  OS << "  static const struct {\n";
+  OS << "    unsigned ID;\n";
+  OS << "    bool Overloaded;\n";
+  OS << "  } IntrinsicNameInfo[] = {\n";
+  for (unsigned Slot = 0, e = Hash.getNumSlots(); Slot != e; ++Slot) {
+    int Idx = Hash.getKeyInSlot(Slot);
+    if (Idx == -1) {
+      OS << "    { 0, false },\n";
+      continue;
+    }
+    OS << "    { " << TargetPrefix << "Intrinsic::"
+       << Ints[ExactID[Idx]].EnumName << ", "
+       << (Ints[Idx].isOverloaded ? "true" : "false") << " },\n";
+  }
+  OS << "  };\n";
+
+  // Hash the whole name in one pass, remembering the hash of the prefix before
+  // each of the first dots, which is as many as an overloaded intrinsic name
+  // can be followed by.
+  OS << "  static const unsigned MaxDots = " << MaxDots + 1 << ";\n";
+  OS << "  size_t DotPos[MaxDots];\n";
+  OS << "  uint64_t DotHash[MaxDots];\n";
+  OS << "  unsigned NumDots = 0;\n";
+  OS << "  uint64_t H = IntrinsicNameHash::hashInit();\n";
+  OS << "  for (size_t i = 0, e = NameR.size(); i != e; ++i) {\n";
+  OS << "    if (NameR[i] == '.' && NumDots != MaxDots) {\n";
+  OS << "      DotPos[NumDots] = i;\n";
+  OS << "      DotHash[NumDots++] = H;\n";
+  OS << "    }\n";
+  OS << "    H = IntrinsicNameHash::hashStep(H, NameR[i]);\n";
+  OS << "  }\n";
+  OS << "  int Slot = IntrinsicNameHash::lookup(NameR, H);\n";
+  OS << "  if (Slot != -1 && !IntrinsicNameInfo[Slot].Overloaded)\n";
+  OS << "    return IntrinsicNameInfo[Slot].ID;\n";
+  // An overloaded intrinsic matches any name that continues with a '.' after
+  // its own, try the longest candidate first.
+  OS << "  while (NumDots--) {\n";
+  OS << "    Slot = IntrinsicNameHash::lookup(NameR.substr(0, DotPos[NumDots]),"
+        "\n";
+  OS << "                                     DotHash[NumDots]);\n";
+  OS << "    if (Slot != -1 && IntrinsicNameInfo[Slot].Overloaded)\n";
+  OS << "      return IntrinsicNameInfo[Slot].ID;\n";
   OS << "  }\n";
   OS << "#endif\n\n";
 }
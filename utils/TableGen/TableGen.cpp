@@ -19,6 +19,7 @@
 #include "llvm/TableGen/Error.h"
 #include "llvm/TableGen/Main.h"
 #include "llvm/TableGen/Record.h"
+#include <algorithm>
 
 using namespace llvm;
 
@@ -41,12 +42,15 @@ enum ActionType {
   PrintEnums,
   PrintSets,
   GenOptParserDefs,
-  GenCTags
+  GenCTags,
+  GenX86Encoding
 };
 
 namespace {
-  cl::opt<ActionType>
-  Action(cl::desc("Action to perform:"),
+  // Several actions may be given, each with its own -o, to share the parsed
+  // records between them.
+  cl::list<ActionType>
+  Actions(cl::desc("Action to perform:"),
          cl::values(clEnumValN(PrintRecords, "print-records",
                                "Print all records to stdout (default)"),
                     clEnumValN(GenEmitter, "gen-emitter",
@@ -85,13 +89,15 @@ namespace {
                                "Generate option definitions"),
                     clEnumValN(GenCTags, "gen-ctags",
                                "Generate ctags-compatible index"),
+                    clEnumValN(GenX86Encoding, "gen-x86-encoding",
+                               "Generate X86 fast encoding tables"),
                     clEnumValEnd));
 
   cl::opt<std::string>
   Class("class", cl::desc("Print Enum list for this class"),
           cl::value_desc("class name"));
 
-bool LLVMTableGenMain(raw_ostream &OS, RecordKeeper &Records) {
+bool runAction(ActionType Action, raw_ostream &OS, RecordKeeper &Records) {
   switch (Action) {
   case PrintRecords:
     OS << Records;           // No argument, dump all contents
@@ -167,10 +173,17 @@ bool LLVMTableGenMain(raw_ostream &OS, RecordKeeper &Records) {
   case GenCTags:
     EmitCTags(Records, OS);
     break;
+  case GenX86Encoding:
+    EmitX86Encoding(Records, OS);
+    break;
   }
 
   return false;
 }
+
+bool LLVMTableGenMain(raw_ostream &OS, RecordKeeper &Records, unsigned Idx) {
+  return runAction(Actions.empty() ? PrintRecords : Actions[Idx], OS, Records);
+}
 }
 
 int main(int argc, char **argv) {
@@ -178,5 +191,6 @@ int main(int argc, char **argv) {
   PrettyStackTraceProgram X(argc, argv);
   cl::ParseCommandLineOptions(argc, argv);
 
-  return TableGenMain(argv[0], &LLVMTableGenMain);
+  return TableGenMain(argv[0], &LLVMTableGenMain,
+                      std::max<unsigned>(Actions.size(), 1));
 }
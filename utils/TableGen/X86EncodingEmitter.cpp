@@ -0,0 +1,202 @@
+//===- X86EncodingEmitter.cpp - Generate X86 fast encoding tables ---------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This tablegen backend emits, for every X86 instruction, a precomputed
+// template of the prefix and opcode bytes for the common legacy register and
+// immediate forms.  The MC code emitter uses it to encode those instructions
+// without decoding TSFlags or looking for memory operands, and falls back to
+// the general path for everything the table does not describe.
+//
+//===----------------------------------------------------------------------===//
+
+#include "CodeGenInstruction.h"
+#include "CodeGenTarget.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/TableGen/Error.h"
+#include "llvm/TableGen/Record.h"
+#include "llvm/TableGen/TableGenBackend.h"
+#include <vector>
+using namespace llvm;
+
+namespace {
+
+// These mirror the encodings in X86InstrFormats.td and X86BaseInfo.h.
+enum {
+  FormPseudo = 0, FormRawFrm = 1, FormAddRegFrm = 2, FormMRMDestReg = 3,
+  FormMRMSrcReg = 5, FormMRM0r = 16, FormMRM7r = 23
+};
+
+enum {
+  PrefixNone = 0, PrefixTB = 1, PrefixREP = 2, PrefixD8 = 3, PrefixDF = 10,
+  PrefixXD = 11, PrefixXS = 12, PrefixT8 = 13, PrefixTA = 14, PrefixA6 = 15,
+  PrefixA7 = 16, PrefixT8XD = 17, PrefixT8XS = 18, PrefixTAXD = 19
+};
+
+// Keep in sync with the flags in X86MCCodeEmitter.cpp.
+enum {
+  FastLock = 1 << 0, FastRep = 1 << 1, FastOpSize = 1 << 2,
+  FastOpSize16 = 1 << 3
+};
+
+struct FastEncoding {
+  unsigned Form;
+  unsigned Flags;
+  unsigned ImmSize;
+  unsigned Prefix;
+  unsigned NumEscapeBytes;
+  unsigned EscapeBytes[2];
+  unsigned BaseOpcode;
+
+  FastEncoding() : Form(FormPseudo), Flags(0), ImmSize(0), Prefix(0),
+                   NumEscapeBytes(0), BaseOpcode(0) {
+    EscapeBytes[0] = EscapeBytes[1] = 0;
+  }
+};
+
+class X86EncodingEmitter {
+  RecordKeeper &Records;
+public:
+  X86EncodingEmitter(RecordKeeper &R) : Records(R) {}
+
+  void run(raw_ostream &OS);
+};
+
+} // End anonymous namespace
+
+/// getBitsValue - Return the value of a bits<n> field of a record.
+static unsigned getBitsValue(const Record *R, StringRef Name) {
+  BitsInit *Bits = R->getValueAsBitsInit(Name);
+  unsigned Value = 0;
+  for (unsigned i = 0, e = Bits->getNumBits(); i != e; ++i) {
+    BitInit *Bit = dyn_cast<BitInit>(Bits->getBit(i));
+    if (!Bit)
+      PrintFatalError(R->getLoc(), "Field '" + Name.str() +
+                      "' of '" + R->getName() + "' is not fully initialized");
+    if (Bit->getValue())
+      Value |= 1U << i;
+  }
+  return Value;
+}
+
+/// getImmSize - Return the size in bytes of the immediate described by ImmT.
+static unsigned getImmSize(unsigned ImmT) {
+  switch (ImmT) {
+  default: return 0;
+  case 1: case 2: return 1;  // Imm8, Imm8PCRel
+  case 3: case 4: return 2;  // Imm16, Imm16PCRel
+  case 5: case 6: return 4;  // Imm32, Imm32PCRel
+  case 7: return 8;          // Imm64
+  }
+}
+
+/// computeFastEncoding - Fill in the encoding template for an instruction.
+/// Returns false, leaving the form as Pseudo, if the instruction needs the
+/// general encoder.
+static bool computeFastEncoding(const Record *R, FastEncoding &FE) {
+  if (!R->isSubClassOf("X86Inst"))
+    return false;
+
+  // VEX, EVEX and XOP prefixes, the 3DNow! suffix opcode, and address size
+  // overrides are left to the general encoder.
+  if (R->getValueAsBit("hasVEXPrefix") || R->getValueAsBit("hasEVEXPrefix") ||
+      R->getValueAsBit("hasXOP_Prefix") ||
+      R->getValueAsBit("has3DNow0F0FOpcode") ||
+      R->getValueAsBit("hasMemOp4Prefix") ||
+      R->getValueAsBit("hasAdSizePrefix"))
+    return false;
+
+  unsigned Form = getBitsValue(R, "FormBits");
+  if (Form != FormRawFrm && Form != FormAddRegFrm && Form != FormMRMDestReg &&
+      Form != FormMRMSrcReg && (Form < FormMRM0r || Form > FormMRM7r))
+    return false;
+
+  unsigned Prefix = getBitsValue(R, "Prefix");
+  switch (Prefix) {
+  default:
+    // The x87 escapes D8-DF come before any REX prefix, like F2 and F3.
+    if (Prefix < PrefixD8 || Prefix > PrefixDF)
+      return false;
+    FE.Prefix = 0xD8 + (Prefix - PrefixD8);
+    break;
+  case PrefixNone:
+    break;
+  case PrefixREP:
+    FE.Flags |= FastRep;
+    break;
+  case PrefixTB:
+    FE.EscapeBytes[FE.NumEscapeBytes++] = 0x0F;
+    break;
+  case PrefixXD: case PrefixXS:
+    FE.Prefix = Prefix == PrefixXD ? 0xF2 : 0xF3;
+    FE.EscapeBytes[FE.NumEscapeBytes++] = 0x0F;
+    break;
+  case PrefixT8: case PrefixT8XD: case PrefixT8XS:
+    if (Prefix != PrefixT8)
+      FE.Prefix = Prefix == PrefixT8XD ? 0xF2 : 0xF3;
+    FE.EscapeBytes[FE.NumEscapeBytes++] = 0x0F;
+    FE.EscapeBytes[FE.NumEscapeBytes++] = 0x38;
+    break;
+  case PrefixTA: case PrefixTAXD:
+    if (Prefix == PrefixTAXD)
+      FE.Prefix = 0xF2;
+    FE.EscapeBytes[FE.NumEscapeBytes++] = 0x0F;
+    FE.EscapeBytes[FE.NumEscapeBytes++] = 0x3A;
+    break;
+  case PrefixA6: case PrefixA7:
+    FE.EscapeBytes[FE.NumEscapeBytes++] = 0x0F;
+    FE.EscapeBytes[FE.NumEscapeBytes++] = Prefix == PrefixA6 ? 0xA6 : 0xA7;
+    break;
+  }
+  if (R->getValueAsBit("hasLockPrefix"))
+    FE.Flags |= FastLock;
+  if (R->getValueAsBit("hasOpSizePrefix"))
+    FE.Flags |= FastOpSize;
+  if (R->getValueAsBit("hasOpSize16Prefix"))
+    FE.Flags |= FastOpSize16;
+
+  FE.Form = Form;
+  FE.ImmSize = getImmSize(getBitsValue(R->getValueAsDef("ImmT"), "Value"));
+  FE.BaseOpcode = getBitsValue(R, "Opcode");
+  return true;
+}
+
+void X86EncodingEmitter::run(raw_ostream &OS) {
+  emitSourceFileHeader("X86 fast instruction encoding tables", OS);
+
+  CodeGenTarget Target(Records);
+  const std::vector<const CodeGenInstruction*> &Insts =
+    Target.getInstructionsByEnumValue();
+
+  unsigned NumFast = 0;
+  OS << "static const X86FastEncoding X86FastEncodings[] = {\n";
+  for (unsigned i = 0, e = Insts.size(); i != e; ++i) {
+    const Record *R = Insts[i]->TheDef;
+    FastEncoding FE;
+    if (computeFastEncoding(R, FE))
+      ++NumFast;
+
+    OS << "  { " << FE.Form << ", " << FE.Flags << ", " << FE.ImmSize << ", "
+       << "0x" << utohexstr(FE.Prefix) << ", " << FE.NumEscapeBytes << ", { "
+       << "0x" << utohexstr(FE.EscapeBytes[0]) << ", "
+       << "0x" << utohexstr(FE.EscapeBytes[1]) << " }, "
+       << "0x" << utohexstr(FE.BaseOpcode) << " },\t// " << R->getName()
+       << '\n';
+  }
+  OS << "};\n\n";
+  OS << "// " << NumFast << " of " << Insts.size()
+     << " instructions have a fast encoding.\n";
+}
+
+namespace llvm {
+
+void EmitX86Encoding(RecordKeeper &RK, raw_ostream &OS) {
+  X86EncodingEmitter(RK).run(OS);
+}
+
+} // End llvm namespace
@@ -0,0 +1,197 @@
+#!/usr/bin/env python
+
+"""Measure the compile time of opt and llc over a corpus of IR files.
+
+Every .ll and .bc file found under the given paths is run through the
+selected pipelines, by default 'opt -O2' and 'llc -O2' on the optimized
+output.  Each run records its wall time, the peak resident memory of the
+tool, and the inclusive time of every pass and code generation phase taken
+from the trace written with -time-trace-file.  Runs are repeated and the
+fastest one is kept, which is how noisy wall times are usually tamed.  Wall
+times include starting the tool, so small inputs mostly measure that.
+
+The results are written as JSON.  Given a baseline written by an earlier
+run, the script also reports every file and phase that got slower than the
+threshold and exits with status 1 if any did.
+"""
+
+import json
+import optparse
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+# Phases shorter than this, in microseconds, are left out of the comparison;
+# their timings are mostly noise.
+MIN_COMPARED_PHASE_TIME = 10000
+
+def find_inputs(paths):
+  """Return the IR files under the given files and directories, sorted, as
+  (name, path) pairs where name is relative to the directory given."""
+  inputs = []
+  for path in paths:
+    if os.path.isfile(path):
+      inputs.append((os.path.basename(path), path))
+      continue
+    for dirpath, dirnames, filenames in os.walk(path):
+      for name in filenames:
+        if os.path.splitext(name)[1] in ('.ll', '.bc'):
+          file = os.path.join(dirpath, name)
+          inputs.append((os.path.relpath(file, path), file))
+  return sorted(inputs)
+
+def read_trace(path):
+  """Sum the durations of the trace events by name, in microseconds."""
+  with open(path) as f:
+    trace = json.load(f)
+  phases = {}
+  for event in trace.get('traceEvents', []):
+    name = event['name']
+    phases[name] = phases.get(name, 0) + event['dur']
+  return phases
+
+def measure(args, trace_path):
+  """Run args and return the wall time, peak memory and per-phase times."""
+  # Run the tool under a child Python so that its peak memory can be read
+  # from that child's RUSAGE_CHILDREN without the maximum of earlier runs.
+  helper = ('import resource, subprocess, sys\n'
+            'status = subprocess.call(sys.argv[1:])\n'
+            'usage = resource.getrusage(resource.RUSAGE_CHILDREN)\n'
+            'sys.stderr.write("maxrss=%d\\n" % usage.ru_maxrss)\n'
+            'sys.exit(status)\n')
+  start = time.time()
+  p = subprocess.Popen([sys.executable, '-c', helper] + args +
+                       ['-time-trace-file=' + trace_path],
+                       stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+  out, err = p.communicate()
+  wall = time.time() - start
+  err = err.decode('utf-8', 'replace')
+  if p.returncode != 0:
+    raise RuntimeError('%s failed:\n%s' % (' '.join(args), err))
+  maxrss = 0
+  for line in err.splitlines():
+    if line.startswith('maxrss='):
+      maxrss = int(line[len('maxrss='):])
+  return {'wall': wall, 'maxrss_kb': maxrss, 'phases': read_trace(trace_path)}
+
+def best_of(runs):
+  """Keep the fastest run, and the smallest peak memory, of several."""
+  best = min(runs, key=lambda r: r['wall'])
+  best = dict(best)
+  best['maxrss_kb'] = min(r['maxrss_kb'] for r in runs)
+  return best
+
+def bench_file(path, opts, tmpdir):
+  """Run the pipelines over one file and return their measurements."""
+  opt = os.path.join(opts.tools_dir, 'opt')
+  llc = os.path.join(opts.tools_dir, 'llc')
+  optimized = os.path.join(tmpdir, 'optimized.bc')
+  trace = os.path.join(tmpdir, 'trace.json')
+  result = {}
+
+  opt_args = [opt, opts.opt_level, path, '-o', optimized]
+  result['opt'] = best_of([measure(opt_args, trace)
+                           for i in range(opts.repeat)])
+
+  if not opts.no_llc:
+    llc_args = [llc, opts.opt_level, '-filetype=obj', optimized,
+                '-o', os.path.join(tmpdir, 'out.o')]
+    result['llc'] = best_of([measure(llc_args, trace)
+                             for i in range(opts.repeat)])
+  return result
+
+def compare(results, baseline, threshold):
+  """Print the regressions against baseline and return how many there are."""
+  regressions = 0
+
+  def check(what, old, new):
+    if old <= 0 or new <= old * (1 + threshold / 100.0):
+      return 0
+    print('%s: %.3f -> %.3f (+%.1f%%)' % (what, old, new,
+                                          (new / old - 1) * 100))
+    return 1
+
+  for name in sorted(results):
+    if name not in baseline:
+      continue
+    for tool in sorted(results[name]):
+      if tool not in baseline[name]:
+        continue
+      new, old = results[name][tool], baseline[name][tool]
+      prefix = '%s: %s' % (name, tool)
+      regressions += check(prefix + ' wall time (s)', old['wall'], new['wall'])
+      regressions += check(prefix + ' peak memory (KiB)', old['maxrss_kb'],
+                           new['maxrss_kb'])
+      for phase in sorted(new['phases']):
+        old_time = old['phases'].get(phase, 0)
+        if old_time < MIN_COMPARED_PHASE_TIME:
+          continue
+        regressions += check('%s \'%s\' (ms)' % (prefix, phase),
+                             old_time / 1000.0,
+                             new['phases'][phase] / 1000.0)
+  return regressions
+
+def main():
+  parser = optparse.OptionParser(usage='%prog [options] <IR files or dirs>')
+  parser.add_option('--tools-dir', default='',
+                    help='directory containing opt and llc')
+  parser.add_option('--opt-level', default='-O2',
+                    help='optimization level for both tools [%default]')
+  parser.add_option('--no-llc', action='store_true', default=False,
+                    help='only measure opt')
+  parser.add_option('--repeat', type='int', default=3,
+                    help='runs per measurement, the fastest is kept '
+                         '[%default]')
+  parser.add_option('-o', '--output', default='',
+                    help='write the results as JSON to this file')
+  parser.add_option('--baseline', default='',
+                    help='JSON results to compare against')
+  parser.add_option('--threshold', type='float', default=5.0,
+                    help='percentage above the baseline reported as a '
+                         'regression [%default]')
+  opts, args = parser.parse_args()
+  if not args:
+    parser.error('no IR files given')
+
+  inputs = find_inputs(args)
+  if not inputs:
+    parser.error('no .ll or .bc files found')
+
+  tmpdir = tempfile.mkdtemp(prefix='compile-time-bench')
+  results = {}
+  failed = False
+  try:
+    for name, path in inputs:
+      try:
+        results[name] = bench_file(path, opts, tmpdir)
+      except RuntimeError as e:
+        sys.stderr.write('%s\n' % e)
+        failed = True
+        continue
+      r = results[name]
+      line = '%s: opt %.3fs %dKiB' % (name, r['opt']['wall'],
+                                      r['opt']['maxrss_kb'])
+      if 'llc' in r:
+        line += ', llc %.3fs %dKiB' % (r['llc']['wall'], r['llc']['maxrss_kb'])
+      print(line)
+  finally:
+    shutil.rmtree(tmpdir)
+
+  if opts.output:
+    with open(opts.output, 'w') as f:
+      json.dump(results, f, indent=2, sort_keys=True)
+
+  if opts.baseline:
+    with open(opts.baseline) as f:
+      baseline = json.load(f)
+    regressions = compare(results, baseline, opts.threshold)
+    print('%d regression(s) above %.1f%%' % (regressions, opts.threshold))
+    if regressions:
+      return 1
+  return 1 if failed else 0
+
+if __name__ == '__main__':
+  sys.exit(main())